@@ -3,24 +3,42 @@ SOURCES += \
     generator/i2cgenerator.cpp \
     device/devicemanager.cpp \
     device/capturedevice.cpp \
+    device/analoglevelsearch.cpp \
     analyzer/uianalyzer.cpp \
+    analyzer/analyzerjob.cpp \
+    analyzer/analyzerannotations.cpp \
+    analyzer/analyzerlayer.cpp \
+    analyzer/uistackedanalyzer.cpp \
+    analyzer/uistackedanalyzerconfig.cpp \
     analyzer/analyzermanager.cpp \
     device/labtool/labtooldevicetransfer.cpp \
     device/labtool/labtooldevicecommthread.cpp \
     device/labtool/labtooldevicecomm.cpp \
     device/simulator/uisimulatorconfigdialog.cpp \
     device/labtool/uilabtooltriggerconfig.cpp \
+    device/labtool/uilabtooldiagnostics.cpp \
     analyzer/uart/uiuartanalyzer.cpp \
+    analyzer/uart/uartdecoder.cpp \
     generator/uartgenerator.cpp \
     analyzer/uianalyzerconfig.cpp \
     analyzer/uart/uiuartanalyzerconfig.cpp \
     common/inputhelper.cpp \
     common/types.cpp \
     generator/spigenerator.cpp \
+    generator/digitaledgelist.cpp \
     analyzer/i2c/uii2canalyzerconfig.cpp \
     analyzer/i2c/uii2canalyzer.cpp \
+    analyzer/i2c/i2cdecoder.cpp \
+    analyzer/i2c/i2cregisterdecoder.cpp \
+    analyzer/i2c/uii2cregisteranalyzer.cpp \
     analyzer/spi/uispianalyzer.cpp \
+    analyzer/spi/spidecoder.cpp \
+    analyzer/spi/spiflashdecoder.cpp \
+    analyzer/spi/uispiflashanalyzer.cpp \
     analyzer/spi/uispianalyzerconfig.cpp \
+    analyzer/bus/busdecoder.cpp \
+    analyzer/bus/uibusanalyzer.cpp \
+    analyzer/bus/uibusanalyzerconfig.cpp \
     device/device.cpp \
     device/generatordevice.cpp \
     device/simulator/simulatorcapturedevice.cpp \
@@ -30,6 +48,7 @@ SOURCES += \
     generator/uidigitalgenerator.cpp \
     generator/uianaloggenerator.cpp \
     device/simulator/simulatorgeneratordevice.cpp \
+    device/simulator/simulatorrandom.cpp \
     device/labtool/labtoolgeneratordevice.cpp \
     generator/uigeneratorarea.cpp \
     generator/generatorapp.cpp \
@@ -50,6 +69,7 @@ SOURCES += \
     capture/uigrid.cpp \
     capture/uidigitaltrigger.cpp \
     capture/uidigitalsignal.cpp \
+    capture/digitalrasterizer.cpp \
     capture/uidigitalgroup.cpp \
     capture/uicursorgroup.cpp \
     capture/uicursor.cpp \
@@ -63,14 +83,34 @@ SOURCES += \
     capture/cursormanager.cpp \
     capture/captureapp.cpp \
     common/configuration.cpp \
+    common/instrumentation.cpp \
+    common/backgroundjob.cpp \
+    common/sampletime.cpp \
+    common/uiinstrumentationdock.cpp \
     device/analogsignal.cpp \
     capture/uicaptureexporter.cpp \
+    capture/digitalstatistics.cpp \
+    capture/uidigitalstatisticsdialog.cpp \
+    capture/fft.cpp \
+    capture/analogspectrum.cpp \
+    capture/uispectrumplot.cpp \
+    capture/uispectrumdialog.cpp \
+    capture/mathexpression.cpp \
+    capture/mathchannel.cpp \
+    capture/uimathsignal.cpp \
+    capture/uimathsignalconfig.cpp \
     device/labtool/labtoolcalibrationwizard.cpp \
     device/labtool/labtoolcalibrationwizardintropage.cpp \
     device/labtool/labtoolcalibrationwizardconclusionpage.cpp \
     device/labtool/labtoolcalibrationwizardanalogout.cpp \
     device/labtool/labtoolcalibrationwizardanalogin.cpp \
     device/labtool/labtoolcalibrationdata.cpp \
+    device/labtool/labtooldactable.cpp \
+    device/labtool/labtooltransport.cpp \
+    device/labtool/labtoolusbtransport.cpp \
+    device/labtool/labtoolvirtualtransport.cpp \
+    ../fw/program/source/generator_pattern.c \
+    ../fw/program/source/capture_vadc_pack.c \
     device/digitalsignal.cpp \
     device/reconfigurelistener.cpp
 
@@ -79,22 +119,41 @@ HEADERS += \
     libusbx/include/libusbx-1.0/libusb.h \
     device/devicemanager.h \
     device/capturedevice.h \
+    device/analoglevelsearch.h \
     analyzer/uianalyzer.h \
+    analyzer/analyzerdecoder.h \
+    analyzer/analyzerjob.h \
+    analyzer/analyzerannotations.h \
+    analyzer/analyzerlayer.h \
+    analyzer/uistackedanalyzer.h \
+    analyzer/uistackedanalyzerconfig.h \
     device/labtool/labtooldevicetransfer.h \
     device/labtool/labtooldevicecommthread.h \
     device/labtool/labtooldevicecomm.h \
     device/simulator/uisimulatorconfigdialog.h \
     device/labtool/uilabtooltriggerconfig.h \
+    device/labtool/uilabtooldiagnostics.h \
     analyzer/uart/uiuartanalyzer.h \
+    analyzer/uart/uartdecoder.h \
     generator/uartgenerator.h \
     analyzer/uianalyzerconfig.h \
     analyzer/uart/uiuartanalyzerconfig.h \
     common/types.h \
     generator/spigenerator.h \
+    generator/digitaledgelist.h \
     analyzer/i2c/uii2canalyzerconfig.h \
     analyzer/i2c/uii2canalyzer.h \
+    analyzer/i2c/i2cdecoder.h \
+    analyzer/i2c/i2cregisterdecoder.h \
+    analyzer/i2c/uii2cregisteranalyzer.h \
     analyzer/spi/uispianalyzer.h \
+    analyzer/spi/spidecoder.h \
+    analyzer/spi/spiflashdecoder.h \
+    analyzer/spi/uispiflashanalyzer.h \
     analyzer/spi/uispianalyzerconfig.h \
+    analyzer/bus/busdecoder.h \
+    analyzer/bus/uibusanalyzer.h \
+    analyzer/bus/uibusanalyzerconfig.h \
     device/device.h \
     device/generatordevice.h \
     device/simulator/simulatorcapturedevice.h \
@@ -104,6 +163,7 @@ HEADERS += \
     generator/uidigitalgenerator.h \
     generator/uianaloggenerator.h \
     device/simulator/simulatorgeneratordevice.h \
+    device/simulator/simulatorrandom.h \
     device/labtool/labtoolgeneratordevice.h \
     generator/uigeneratorarea.h \
     generator/generatorapp.h \
@@ -124,6 +184,7 @@ HEADERS += \
     capture/uigrid.h \
     capture/uidigitaltrigger.h \
     capture/uidigitalsignal.h \
+    capture/digitalrasterizer.h \
     capture/uidigitalgroup.h \
     capture/uicursorgroup.h \
     capture/uicursor.h \
@@ -139,14 +200,36 @@ HEADERS += \
     common/configuration.h \
     capture/cursormanager.h \
     common/inputhelper.h \
+    common/spscqueue.h \
+    common/atomichelper.h \
+    common/instrumentation.h \
+    common/backgroundjob.h \
+    common/sampletime.h \
+    common/uiinstrumentationdock.h \
     device/analogsignal.h \
     capture/uicaptureexporter.h \
+    capture/digitalstatistics.h \
+    capture/uidigitalstatisticsdialog.h \
+    capture/fft.h \
+    capture/analogspectrum.h \
+    capture/uispectrumplot.h \
+    capture/uispectrumdialog.h \
+    capture/mathexpression.h \
+    capture/mathchannel.h \
+    capture/uimathsignal.h \
+    capture/uimathsignalconfig.h \
     device/labtool/labtoolcalibrationwizard.h \
     device/labtool/labtoolcalibrationwizardintropage.h \
     device/labtool/labtoolcalibrationwizardconclusionpage.h \
     device/labtool/labtoolcalibrationwizardanalogout.h \
     device/labtool/labtoolcalibrationwizardanalogin.h \
     device/labtool/labtoolcalibrationdata.h \
+    device/labtool/labtooldactable.h \
+    device/labtool/labtooltransport.h \
+    device/labtool/labtoolusbtransport.h \
+    device/labtool/labtoolvirtualtransport.h \
+    ../fw/program/include/generator_pattern.h \
+    ../fw/program/include/capture_vadc_pack.h \
     device/digitalsignal.h \
     device/reconfigurelistener.h
 
@@ -156,6 +239,9 @@ RESOURCES += \
 RC_FILE = icon.rc
 
 INCLUDEPATH += .
+
+# Code shared with the firmware
+INCLUDEPATH += $$PWD/../fw/program/include
 win32:CONFIG(release, debug|release): LIBS += -L$$PWD/libusbx/MinGW32/dll/ -lusb-1.0
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/libusbx/MinGW32/dll/ -lusb-1.0
 else:unix:!symbian: LIBS += -L$$PWD/libusbx/Linux/ -lusb-1.0 -ludev
@@ -0,0 +1,233 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analyzerannotations.h"
+
+#include <algorithm>
+
+/*!
+    \class AnalyzerAnnotations
+    \brief Stores the items found by a protocol decoder.
+
+    \ingroup Analyzer
+
+    Each annotation has a start and stop sample index, a type defined by
+    the decoder, a value and a row. The stop index is -1 for annotations
+    that mark a single point in time, e.g. an I2C START condition. Analyzers
+    that show more than one line of data, e.g. MOSI and MISO for SPI, add
+    one annotation per row. An annotation can also have a text instead of a
+    value for protocols where a number is not enough.
+
+    The annotations are stored as one vector per column instead of one
+    vector of structs. A capture can give millions of annotations and most
+    of the work, e.g. finding the first visible annotation, only needs the
+    start indexes. The type and row use one byte each and the text column
+    is not allocated until the first text is added.
+
+    The annotations must be added in order of their start index so that
+    \ref lowerBound can do a binary search.
+*/
+
+/*!
+    Constructs an empty store.
+*/
+AnalyzerAnnotations::AnalyzerAnnotations()
+{
+}
+
+/*!
+    Adds an annotation from \a startIdx to \a stopIdx with the given
+    \a type, \a value and \a row.
+*/
+void AnalyzerAnnotations::append(SampleIndex startIdx, SampleIndex stopIdx, int type, int value, int row)
+{
+    mStartIdx.append(startIdx);
+    mStopIdx.append(stopIdx);
+    mType.append((quint8)type);
+    mValue.append(value);
+    mRow.append((quint8)row);
+
+    if (!mTextIdx.isEmpty()) {
+        mTextIdx.append(-1);
+    }
+}
+
+/*!
+    Adds an annotation from \a startIdx to \a stopIdx with the given
+    \a type, \a text and \a row.
+*/
+void AnalyzerAnnotations::append(SampleIndex startIdx, SampleIndex stopIdx, int type, const QString &text, int row)
+{
+    if (mTextIdx.isEmpty()) {
+        mTextIdx.fill(-1, mStartIdx.size());
+    }
+
+    append(startIdx, stopIdx, type, 0, row);
+
+    mTextIdx.last() = mTexts.size();
+    mTexts.append(text);
+}
+
+/*!
+    Adds all annotations in \a other.
+*/
+void AnalyzerAnnotations::append(const AnalyzerAnnotations &other)
+{
+    appendTexts(other, 0);
+
+    mStartIdx += other.mStartIdx;
+    mStopIdx += other.mStopIdx;
+    mType += other.mType;
+    mValue += other.mValue;
+    mRow += other.mRow;
+}
+
+/*!
+    Returns the annotations from position \a pos to the end.
+*/
+AnalyzerAnnotations AnalyzerAnnotations::mid(int pos) const
+{
+    AnalyzerAnnotations a;
+    a.appendTexts(*this, pos);
+    a.mStartIdx = mStartIdx.mid(pos);
+    a.mStopIdx = mStopIdx.mid(pos);
+    a.mType = mType.mid(pos);
+    a.mValue = mValue.mid(pos);
+    a.mRow = mRow.mid(pos);
+
+    return a;
+}
+
+/*!
+    Adds the text column for the annotations in \a other from position
+    \a from to the end. Only the texts used by those annotations are
+    copied so that repeatedly splitting and joining decoded chunks doesn't
+    make the text list grow. Must be called before the other columns are
+    added.
+*/
+void AnalyzerAnnotations::appendTexts(const AnalyzerAnnotations &other, int from)
+{
+    int count = other.size() - from;
+
+    if (other.mTextIdx.isEmpty()) {
+        if (!mTextIdx.isEmpty()) {
+            mTextIdx.insert(mTextIdx.size(), count, -1);
+        }
+        return;
+    }
+
+    if (mTextIdx.isEmpty()) {
+        mTextIdx.fill(-1, mStartIdx.size());
+    }
+
+    mTextIdx.reserve(mTextIdx.size() + count);
+    for (int i = from; i < other.size(); i++) {
+        int idx = other.mTextIdx.at(i);
+        if (idx == -1) {
+            mTextIdx.append(-1);
+        }
+        else {
+            mTextIdx.append(mTexts.size());
+            mTexts.append(other.mTexts.at(idx));
+        }
+    }
+}
+
+/*!
+    Removes all annotations.
+*/
+void AnalyzerAnnotations::clear()
+{
+    *this = AnalyzerAnnotations();
+}
+
+/*!
+    Returns the text of annotation \a i, or a null string if it has a value
+    instead.
+*/
+QString AnalyzerAnnotations::text(int i) const
+{
+    if (mTextIdx.isEmpty() || mTextIdx.at(i) == -1) return QString();
+
+    return mTexts.at(mTextIdx.at(i));
+}
+
+/*!
+    Returns the position of the first annotation that starts at or after
+    the sample with index \a sampleIdx, or size() if there is none.
+*/
+int AnalyzerAnnotations::lowerBound(SampleIndex sampleIdx) const
+{
+    return std::lower_bound(mStartIdx.constBegin(), mStartIdx.constEnd(), sampleIdx)
+            - mStartIdx.constBegin();
+}
+
+/*!
+    Searches for an annotation with the given \a type and \a value starting
+    at position \a from. A \a type or \a value of -1 matches any. The search
+    is towards the end if \a forward is true, otherwise towards the start.
+    Returns the position of the annotation or -1 if there is none.
+*/
+int AnalyzerAnnotations::find(int from, int type, int value, bool forward) const
+{
+    int step = forward ? 1 : -1;
+    for (int i = from; i >= 0 && i < size(); i += step) {
+        if ((type == -1 || mType.at(i) == type)
+                && (value == -1 || mValue.at(i) == value)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    Searches for an annotation whose text contains \a text (case
+    insensitive) starting at position \a from. The search is towards the
+    end if \a forward is true, otherwise towards the start. Returns the
+    position of the annotation or -1 if there is none.
+*/
+int AnalyzerAnnotations::find(int from, const QString &text, bool forward) const
+{
+    if (mTextIdx.isEmpty()) return -1;
+
+    int step = forward ? 1 : -1;
+    for (int i = from; i >= 0 && i < size(); i += step) {
+        int idx = mTextIdx.at(i);
+        if (idx != -1 && mTexts.at(idx).contains(text, Qt::CaseInsensitive)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    Returns true if this store contains the same annotations as \a other.
+*/
+bool AnalyzerAnnotations::operator==(const AnalyzerAnnotations &other) const
+{
+    if (mStartIdx != other.mStartIdx || mStopIdx != other.mStopIdx
+            || mType != other.mType || mValue != other.mValue
+            || mRow != other.mRow) {
+        return false;
+    }
+
+    for (int i = 0; i < size(); i++) {
+        if (text(i) != other.text(i)) return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALYZERANNOTATIONS_H
+#define ANALYZERANNOTATIONS_H
+
+#include <QVector>
+#include <QStringList>
+
+#include "common/sampletime.h"
+
+class AnalyzerAnnotations
+{
+public:
+    AnalyzerAnnotations();
+
+    void append(SampleIndex startIdx, SampleIndex stopIdx, int type, int value, int row = 0);
+    void append(SampleIndex startIdx, SampleIndex stopIdx, int type, const QString &text, int row = 0);
+    void append(const AnalyzerAnnotations &other);
+    AnalyzerAnnotations mid(int pos) const;
+    void clear();
+
+    int size() const {return mStartIdx.size();}
+    bool isEmpty() const {return mStartIdx.isEmpty();}
+
+    SampleIndex startIdx(int i) const {return mStartIdx.at(i);}
+    SampleIndex stopIdx(int i) const {return mStopIdx.at(i);}
+    int type(int i) const {return mType.at(i);}
+    int value(int i) const {return mValue.at(i);}
+    int row(int i) const {return mRow.at(i);}
+    QString text(int i) const;
+
+    int lowerBound(SampleIndex sampleIdx) const;
+    int find(int from, int type, int value, bool forward = true) const;
+    int find(int from, const QString &text, bool forward = true) const;
+
+    AnalyzerAnnotations &operator+=(const AnalyzerAnnotations &other) {
+        append(other);
+        return *this;
+    }
+    bool operator==(const AnalyzerAnnotations &other) const;
+
+private:
+    void appendTexts(const AnalyzerAnnotations &other, int from);
+
+    QVector<SampleIndex> mStartIdx;
+    QVector<SampleIndex> mStopIdx;
+    QVector<int> mValue;
+    QVector<quint8> mType;
+    QVector<quint8> mRow;
+
+    // index in mTexts, only allocated when the first text is added
+    QVector<int> mTextIdx;
+    QStringList mTexts;
+};
+
+#endif // ANALYZERANNOTATIONS_H
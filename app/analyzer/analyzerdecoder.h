@@ -0,0 +1,213 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALYZERDECODER_H
+#define ANALYZERDECODER_H
+
+#include <QMap>
+
+#include "analyzerannotations.h"
+
+/*!
+    \class AnalyzerDecoder
+    \brief Keeps the decoded annotations and resumable decoder states of an analyzer.
+
+    \ingroup Analyzer
+
+    The AnalyzerDecoder class drives a protocol decoder in steps and saves a
+    copy of the decoder's \a State each time it passes a multiple of
+    CheckpointInterval samples. The \a State must have an \a pos member with
+    the index of the next sample to decode and an \a operator==. All other
+    variables that the decoder carries from one sample to the next must also
+    be part of the \a State, so that a decoding that is stopped and started
+    again gives the same result as one that runs without stopping.
+
+    When a new decoding is started (e.g. because the sync cursor has moved)
+    the previous result can be kept. The new decoding then runs until it
+    passes a checkpoint where its state is equal to the state of the previous
+    decoding. From that point the two decodings would produce the same items,
+    so the rest of the previous result is reused instead of decoded again.
+
+    A long capture can also be decoded in parts, each part by its own
+    AnalyzerDecoder on its own thread, and the parts joined with \ref splice.
+
+    The decoder is an object with a member function
+
+    \code
+    bool decodeSamples(State &state, AnalyzerAnnotations &items, int endIdx);
+    \endcode
+
+    that decodes until \a state.pos is at or after \a endIdx and returns
+    true if there is nothing more to decode.
+*/
+template <typename State>
+class AnalyzerDecoder
+{
+public:
+    enum Constants {
+        CheckpointInterval = 16384
+    };
+
+    /*!
+        Returns the items to show. While a new decoding has not yet reached
+        the start of the previous one the previous items are returned.
+    */
+    const AnalyzerAnnotations& items() const
+    {
+        if (!mCurrent.finished && !mPrevious.items.isEmpty()
+                && mCurrent.state.pos < mPrevious.startIdx) {
+            return mPrevious.items;
+        }
+        return mCurrent.items;
+    }
+
+    /*!
+        Returns the index of the next sample the current decoding will look at.
+    */
+    int position() const {return mCurrent.state.pos;}
+
+    /*!
+        Removes all items and checkpoints.
+    */
+    void clear()
+    {
+        mCurrent = Run();
+        mPrevious = Run();
+    }
+
+    /*!
+        Starts a new decoding from the \a initial state. If \a keepPrevious
+        is true the current result is kept to be reused by the new decoding.
+    */
+    void start(const State &initial, bool keepPrevious)
+    {
+        if (!keepPrevious) {
+            mPrevious = Run();
+        } else if (!mCurrent.items.isEmpty() || !mCurrent.checkpoints.isEmpty()) {
+            mPrevious = mCurrent;
+        }
+
+        mCurrent = Run();
+        mCurrent.startIdx = initial.pos;
+        mCurrent.initial = initial;
+        mCurrent.state = initial;
+    }
+
+    /*!
+        Appends the result of \a next, a decoding of the samples that follow
+        the current one, if the current decoding stopped in exactly the state
+        that \a next was started from. Returns false if it didn't, in which
+        case nothing is changed.
+    */
+    bool splice(const AnalyzerDecoder &next)
+    {
+        if (mCurrent.finished || !(mCurrent.state == next.mCurrent.initial)) {
+            return false;
+        }
+
+        int offset = mCurrent.items.size();
+        mCurrent.items += next.mCurrent.items;
+
+        typename QMap<int, Checkpoint>::const_iterator it;
+        for (it = next.mCurrent.checkpoints.constBegin(); it != next.mCurrent.checkpoints.constEnd(); ++it) {
+            Checkpoint cp = it.value();
+            cp.itemCount += offset;
+            mCurrent.checkpoints.insert(it.key(), cp);
+        }
+
+        mCurrent.state = next.mCurrent.state;
+        mCurrent.finished = next.mCurrent.finished;
+
+        return true;
+    }
+
+    /*!
+        Continues the current decoding with the \a decoder until the sample
+        at \a endIdx has been reached. Returns true if there is nothing more
+        to decode.
+    */
+    template <typename Decoder>
+    bool decode(Decoder* decoder, int endIdx)
+    {
+        while (!mCurrent.finished && mCurrent.state.pos < endIdx) {
+            int checkpoint = mCurrent.state.pos / CheckpointInterval + 1;
+            int stopIdx = qMin(endIdx, checkpoint * CheckpointInterval);
+
+            mCurrent.finished = decoder->decodeSamples(mCurrent.state, mCurrent.items, stopIdx);
+
+            if (!mCurrent.finished && mCurrent.state.pos >= checkpoint * CheckpointInterval) {
+                Checkpoint cp;
+                cp.state = mCurrent.state;
+                cp.itemCount = mCurrent.items.size();
+                mCurrent.checkpoints.insert(checkpoint, cp);
+
+                reusePrevious(checkpoint);
+            }
+        }
+
+        return mCurrent.finished;
+    }
+
+private:
+
+    struct Checkpoint
+    {
+        State state;
+        int itemCount;
+    };
+
+    struct Run
+    {
+        Run() : startIdx(0), finished(false) {}
+
+        int startIdx;
+        State initial;
+        State state;
+        AnalyzerAnnotations items;
+        QMap<int, Checkpoint> checkpoints;
+        bool finished;
+    };
+
+    Run mCurrent;
+    Run mPrevious;
+
+    /*!
+        If the previous decoding had the same state at \a checkpoint then
+        its items and checkpoints after that point are moved to the current
+        decoding, which then continues where the previous one ended.
+    */
+    void reusePrevious(int checkpoint)
+    {
+        typename QMap<int, Checkpoint>::const_iterator it = mPrevious.checkpoints.constFind(checkpoint);
+        if (it == mPrevious.checkpoints.constEnd() || !(it.value().state == mCurrent.state)) {
+            return;
+        }
+
+        int offset = mCurrent.items.size() - it.value().itemCount;
+        mCurrent.items += mPrevious.items.mid(it.value().itemCount);
+
+        for (++it; it != mPrevious.checkpoints.constEnd(); ++it) {
+            Checkpoint cp = it.value();
+            cp.itemCount += offset;
+            mCurrent.checkpoints.insert(it.key(), cp);
+        }
+
+        mCurrent.state = mPrevious.state;
+        mCurrent.finished = mPrevious.finished;
+        mPrevious = Run();
+    }
+};
+
+#endif // ANALYZERDECODER_H
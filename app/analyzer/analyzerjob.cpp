@@ -0,0 +1,311 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analyzerjob.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include "common/atomichelper.h"
+#include "common/instrumentation.h"
+
+/*!
+    \class AnalyzerJob
+    \brief A decoding that runs on a thread in the global QThreadPool.
+
+    \ingroup Analyzer
+
+    An AnalyzerJob is shared between the analyzer that created it and the
+    AnalyzerTask that runs it. The analyzer can cancel the job at any time,
+    e.g. when a new capture arrives, and can wait for it to stop before its
+    result is reused. A job that is cancelled before it has started will
+    never run, so waiting for it does not depend on the other jobs in
+    the pool.
+
+    See AnalyzerDecoderJob for the actual decoding.
+*/
+
+/*!
+    Constructs a new job.
+*/
+AnalyzerJob::AnalyzerJob()
+{
+    mCancelled = 0;
+    mProgress = 0;
+    mStarted = false;
+    mDone = false;
+    mCapture = Instrumentation::instance().currentCapture();
+}
+
+/*!
+    Deletes the job.
+*/
+AnalyzerJob::~AnalyzerJob()
+{
+}
+
+/*!
+    Runs the job unless it has been cancelled. Called by AnalyzerTask on
+    one of the pool's threads.
+*/
+void AnalyzerJob::run()
+{
+    mMutex.lock();
+    if (AtomicHelper::load(mCancelled) != 0) {
+        mMutex.unlock();
+        return;
+    }
+    mStarted = true;
+    mMutex.unlock();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    execute();
+
+    // a cancelled decoding is replaced by a new one and isn't measured
+    if (!mName.isEmpty() && !isCancelled()) {
+        Instrumentation::instance().addTime("Decode " + mName, timer.nsecsElapsed(), mCapture);
+    }
+
+    QMutexLocker locker(&mMutex);
+    mDone = true;
+    mDoneCondition.wakeAll();
+}
+
+/*!
+    Sets the \a name used when measuring the time of the job, see
+    Instrumentation. The time is added to the capture that was current
+    when the job was created.
+*/
+void AnalyzerJob::setName(const QString &name)
+{
+    mName = name;
+}
+
+/*!
+    Asks the job to stop as soon as possible. Can be called from any thread.
+*/
+void AnalyzerJob::cancel()
+{
+    QMutexLocker locker(&mMutex);
+    mCancelled = 1;
+    if (!mStarted) {
+        mDone = true;
+    }
+}
+
+/*!
+    Blocks until the job has finished or stopped after being cancelled.
+*/
+void AnalyzerJob::waitForDone()
+{
+    QMutexLocker locker(&mMutex);
+    while (!mDone) {
+        mDoneCondition.wait(&mMutex);
+    }
+}
+
+/*!
+    Returns true if the job has finished or stopped after being cancelled.
+*/
+bool AnalyzerJob::isDone()
+{
+    QMutexLocker locker(&mMutex);
+    return mDone;
+}
+
+/*!
+    Returns how much of the signal data has been decoded, in percent.
+*/
+int AnalyzerJob::progress() const
+{
+    return AtomicHelper::load(mProgress);
+}
+
+/*!
+    Returns the annotations found so far. Can be called from any thread.
+*/
+AnalyzerAnnotations AnalyzerJob::results()
+{
+    QMutexLocker locker(&mMutex);
+    return mResults;
+}
+
+/*!
+    \fn virtual void AnalyzerJob::execute() = 0
+
+    Does the actual work. Should check \ref isCancelled regularly and
+    return when it is true.
+*/
+
+/*!
+    Returns true if the job has been cancelled.
+*/
+bool AnalyzerJob::isCancelled() const
+{
+    return AtomicHelper::load(mCancelled) != 0;
+}
+
+/*!
+    Sets the \a progress in percent.
+*/
+void AnalyzerJob::setProgress(int progress)
+{
+    mProgress = progress;
+}
+
+
+/*!
+    Makes \a results the annotations returned by \ref results.
+*/
+void AnalyzerJob::setResults(const AnalyzerAnnotations &results)
+{
+    QMutexLocker locker(&mMutex);
+    mResults = results;
+}
+
+
+/*!
+    \class AnalyzerTask
+    \brief Runs an AnalyzerJob in a QThreadPool.
+
+    \ingroup Analyzer
+
+    The task is deleted by the pool when it has run. It holds a reference
+    to the job so the job stays alive even if the analyzer is deleted
+    first.
+*/
+
+/*!
+    Constructs a task running \a job.
+*/
+AnalyzerTask::AnalyzerTask(QSharedPointer<AnalyzerJob> job)
+{
+    mJob = job;
+    setAutoDelete(true);
+}
+
+/*!
+    Runs the job.
+*/
+void AnalyzerTask::run()
+{
+    mJob->run();
+}
+
+
+/*!
+    \class AnalyzerWork
+    \brief A number of independent work items processed on several threads.
+
+    \ingroup Analyzer
+
+    The thread calling \ref run processes work items itself while helper
+    tasks in the global QThreadPool take the others. Each item is processed
+    exactly once. Helpers that start after all items have been taken
+    return at once, so \ref run never waits for a helper that is still
+    queued behind other jobs in the pool.
+*/
+
+/*!
+    Constructs work with \a count items.
+*/
+AnalyzerWork::AnalyzerWork(int count)
+{
+    mCount = count;
+    mNext = 0;
+    mNumDone = 0;
+}
+
+/*!
+    Deletes the work.
+*/
+AnalyzerWork::~AnalyzerWork()
+{
+}
+
+/*!
+    Processes all items of \a work, using as many threads as the pool
+    allows, and returns when all items have been processed.
+*/
+void AnalyzerWork::run(QSharedPointer<AnalyzerWork> work)
+{
+    int numHelpers = qMin(work->mCount, QThreadPool::globalInstance()->maxThreadCount()) - 1;
+    for (int i = 0; i < numHelpers; i++) {
+        QThreadPool::globalInstance()->start(new AnalyzerWorkTask(work));
+    }
+
+    work->processItems();
+
+    QMutexLocker locker(&work->mMutex);
+    while (work->mNumDone < work->mCount) {
+        work->mDoneCondition.wait(&work->mMutex);
+    }
+}
+
+/*!
+    \fn virtual void AnalyzerWork::process(int index) = 0
+
+    Processes the item with the given \a index. Called once for each item,
+    on any of the threads.
+*/
+
+/*!
+    Takes items that no other thread has taken and processes them until
+    there are no more.
+*/
+void AnalyzerWork::processItems()
+{
+    for (;;) {
+        int index = mNext.fetchAndAddOrdered(1);
+        if (index >= mCount) {
+            break;
+        }
+
+        process(index);
+
+        QMutexLocker locker(&mMutex);
+        mNumDone++;
+        mDoneCondition.wakeAll();
+    }
+}
+
+
+/*!
+    \class AnalyzerWorkTask
+    \brief Helps processing an AnalyzerWork in a QThreadPool.
+
+    \ingroup Analyzer
+
+    The task is deleted by the pool when it has run.
+*/
+
+/*!
+    Constructs a task helping with \a work.
+*/
+AnalyzerWorkTask::AnalyzerWorkTask(QSharedPointer<AnalyzerWork> work)
+{
+    mWork = work;
+    setAutoDelete(true);
+}
+
+/*!
+    Processes items until there are no more.
+*/
+void AnalyzerWorkTask::run()
+{
+    mWork->processItems();
+}
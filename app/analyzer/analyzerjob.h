@@ -0,0 +1,408 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALYZERJOB_H
+#define ANALYZERJOB_H
+
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QThreadPool>
+#include <QString>
+
+#include "analyzerdecoder.h"
+#include "analyzerannotations.h"
+
+class AnalyzerJob
+{
+public:
+    AnalyzerJob();
+    virtual ~AnalyzerJob();
+
+    void run();
+    void setName(const QString &name);
+    void cancel();
+    void waitForDone();
+    bool isDone();
+    int progress() const;
+    AnalyzerAnnotations results();
+
+protected:
+    enum Constants {
+        DecodeChunkSize = 262144,
+        ParallelChunkSize = 1048576,
+        PublishInterval = 100
+    };
+
+    virtual void execute() = 0;
+    bool isCancelled() const;
+    void setProgress(int progress);
+    void setResults(const AnalyzerAnnotations &results);
+
+private:
+    QMutex mMutex;
+    QWaitCondition mDoneCondition;
+    QAtomicInt mCancelled;
+    QAtomicInt mProgress;
+    bool mStarted;
+    bool mDone;
+    AnalyzerAnnotations mResults;
+    QString mName;
+    int mCapture;
+};
+
+class AnalyzerTask : public QRunnable
+{
+public:
+    explicit AnalyzerTask(QSharedPointer<AnalyzerJob> job);
+
+    void run();
+
+private:
+    QSharedPointer<AnalyzerJob> mJob;
+};
+
+class AnalyzerWork
+{
+public:
+    explicit AnalyzerWork(int count);
+    virtual ~AnalyzerWork();
+
+    static void run(QSharedPointer<AnalyzerWork> work);
+
+protected:
+    virtual void process(int index) = 0;
+
+private:
+    friend class AnalyzerWorkTask;
+
+    int mCount;
+    QAtomicInt mNext;
+    QMutex mMutex;
+    QWaitCondition mDoneCondition;
+    int mNumDone;
+
+    void processItems();
+};
+
+class AnalyzerWorkTask : public QRunnable
+{
+public:
+    explicit AnalyzerWorkTask(QSharedPointer<AnalyzerWork> work);
+
+    void run();
+
+private:
+    QSharedPointer<AnalyzerWork> mWork;
+};
+
+/*!
+    \class AnalyzerDecoderJob
+    \brief Runs a protocol decoder core in an AnalyzerJob.
+
+    \ingroup Analyzer
+
+    The \a Core is a copy of the decoder with its settings and the signal
+    data, so the job never touches the analyzer widget or the capture
+    device. It must define the \a State type, an
+    \a initialState(int startIdx) function, a \a numSamples() function and
+    the \a decodeSamples function described in AnalyzerDecoder. It must also
+    have a function
+
+    \code
+    bool resyncState(int startIdx, int fromIdx, int toIdx, State* s) const;
+    \endcode
+
+    that finds a sample between \a fromIdx and \a toIdx where the signals
+    are idle, e.g. where the chip select is off, and stores the state a
+    decoding started at \a startIdx would have there in \a s.
+
+    The visible part of the signal is decoded first, then the signal from
+    the start index to the end. The items found so far are published every
+    PublishInterval ms and can be read with \ref results from the UI thread.
+
+    A long capture is split into parts at such idle samples and the parts
+    are decoded at the same time on different threads. A part is only used
+    if the decoding of the part before it ended in the state the part was
+    started from, otherwise it is decoded again after the part before it.
+    The result is therefore always the same as for a serial decoding, which
+    the analyzerparallel unit test checks with traffic from the signal
+    generators.
+*/
+template <typename Core>
+class AnalyzerDecoderJob : public AnalyzerJob
+{
+public:
+    typedef typename Core::State State;
+
+    /*!
+        Constructs a job decoding with \a core from \a startIdx. The samples
+        from \a visibleFrom to \a visibleTo are decoded first.
+    */
+    AnalyzerDecoderJob(const Core &core, int startIdx, int visibleFrom, int visibleTo) :
+        mCore(core),
+        mStartIdx(startIdx),
+        mVisibleFrom(visibleFrom),
+        mVisibleTo(visibleTo),
+        mKeepPrevious(false),
+        mParallelStartIdx(0),
+        mParallelNumSamples(0)
+    {
+    }
+
+    /*!
+        Lets this job reuse the result of the \a previous job, which must be
+        done. See AnalyzerDecoder.
+    */
+    void keepPrevious(AnalyzerDecoderJob<Core>* previous)
+    {
+        mDecoder = previous->mDecoder;
+        mKeepPrevious = true;
+    }
+
+protected:
+    void execute()
+    {
+        int numSamples = mCore.numSamples();
+        bool keepPrevious = mKeepPrevious;
+        int startIdx = mStartIdx;
+
+        if (startIdx < 0 || startIdx >= numSamples) {
+            startIdx = 0;
+        }
+
+        if (!keepPrevious && mVisibleFrom > startIdx && mVisibleFrom < numSamples) {
+            mDecoder.start(mCore.initialState(mVisibleFrom), false);
+            if (!decodeTo(qMin(mVisibleTo, numSamples), mVisibleFrom, numSamples)) {
+                return;
+            }
+            keepPrevious = true;
+        }
+
+        mDecoder.start(mCore.initialState(startIdx), keepPrevious);
+
+        bool completed;
+        if (mKeepPrevious) {
+            completed = decodeTo(numSamples, startIdx, numSamples);
+        }
+        else {
+            completed = decodeParallel(startIdx, numSamples);
+        }
+
+        if (completed) {
+            publish();
+            setProgress(100);
+        }
+    }
+
+private:
+
+    /*
+        A part of the signal data decoded on its own thread
+    */
+    struct Chunk {
+        bool valid;
+        State start;
+        int fromIdx;
+        int toIdx;
+        int endIdx;
+        AnalyzerDecoder<State> decoder;
+    };
+
+    class ChunkWork : public AnalyzerWork
+    {
+    public:
+        ChunkWork(AnalyzerDecoderJob* job, Chunk* chunks, int count, bool findStart) :
+            AnalyzerWork(count),
+            mJob(job),
+            mChunks(chunks),
+            mFindStart(findStart)
+        {
+        }
+
+    protected:
+        void process(int index)
+        {
+            if (mFindStart) {
+                mJob->findChunkStart(mChunks, index);
+            }
+            else {
+                mJob->decodeChunk(mChunks, index);
+            }
+        }
+
+    private:
+        AnalyzerDecoderJob* mJob;
+        Chunk* mChunks;
+        bool mFindStart;
+    };
+
+    Core mCore;
+    AnalyzerDecoder<State> mDecoder;
+    int mStartIdx;
+    int mVisibleFrom;
+    int mVisibleTo;
+    bool mKeepPrevious;
+    int mParallelStartIdx;
+    int mParallelNumSamples;
+    QAtomicInt mParallelDecoded;
+
+    /*!
+        Decodes in chunks up to \a endIdx, publishing the result now and
+        then. Progress is reported relative to \a fromIdx and \a numSamples.
+        Returns false if the job was cancelled.
+    */
+    bool decodeTo(int endIdx, int fromIdx, int numSamples)
+    {
+        QElapsedTimer lastPublish;
+        lastPublish.start();
+
+        int idx = mDecoder.position();
+        while (idx < endIdx) {
+            if (isCancelled()) {
+                return false;
+            }
+
+            idx = qMin(endIdx, idx + DecodeChunkSize);
+            if (mDecoder.decode(&mCore, idx)) {
+                break;
+            }
+            idx = qMax(idx, mDecoder.position());
+
+            if (numSamples > fromIdx) {
+                setProgress((int)(((qint64)(idx - fromIdx) * 100) / (numSamples - fromIdx)));
+            }
+            if (lastPublish.elapsed() >= PublishInterval) {
+                publish();
+                lastPublish.restart();
+            }
+        }
+
+        publish();
+        return true;
+    }
+
+    /*!
+        Decodes from \a startIdx to the end of the \a numSamples samples in
+        parts on several threads. Returns false if the job was cancelled.
+    */
+    bool decodeParallel(int startIdx, int numSamples)
+    {
+        int numChunks = qMin(QThreadPool::globalInstance()->maxThreadCount(),
+                             (numSamples - startIdx) / ParallelChunkSize);
+        if (numChunks < 2) {
+            return decodeTo(numSamples, startIdx, numSamples);
+        }
+
+        QVector<Chunk> chunks(numChunks);
+        int length = (numSamples - startIdx) / numChunks;
+        for (int i = 0; i < numChunks; i++) {
+            chunks[i].valid = false;
+            chunks[i].fromIdx = startIdx + i * length;
+            chunks[i].toIdx = (i == numChunks-1) ? numSamples : chunks[i].fromIdx + length;
+        }
+
+        mParallelStartIdx = startIdx;
+        mParallelNumSamples = numSamples;
+        mParallelDecoded = 0;
+
+        // find where each part can start ...
+        Chunk* data = chunks.data();
+        AnalyzerWork::run(QSharedPointer<AnalyzerWork>(new ChunkWork(this, data, numChunks, true)));
+
+        // ... and let it end where the next one starts
+        int endIdx = numSamples;
+        for (int i = numChunks-1; i >= 0; i--) {
+            if (!data[i].valid) continue;
+            data[i].endIdx = endIdx;
+            endIdx = data[i].start.pos;
+        }
+
+        AnalyzerWork::run(QSharedPointer<AnalyzerWork>(new ChunkWork(this, data, numChunks, false)));
+        if (isCancelled()) {
+            return false;
+        }
+
+        for (int i = 1; i < numChunks; i++) {
+            if (!data[i].valid) continue;
+
+            if (!mDecoder.splice(data[i].decoder)) {
+                // the part started in the wrong state -> decode it again
+                if (!decodeTo(data[i].endIdx, startIdx, numSamples)) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /*!
+        Finds the state the part with the given \a index of the \a chunks
+        starts in. The first part starts where the job starts.
+    */
+    void findChunkStart(Chunk* chunks, int index)
+    {
+        Chunk &chunk = chunks[index];
+        if (index == 0) {
+            chunk.start.pos = mParallelStartIdx;
+            chunk.valid = true;
+        }
+        else {
+            chunk.valid = mCore.resyncState(mParallelStartIdx, chunk.fromIdx, chunk.toIdx, &chunk.start);
+        }
+    }
+
+    /*!
+        Decodes the part with the given \a index of the \a chunks. The first
+        part is decoded by the job's own decoder.
+    */
+    void decodeChunk(Chunk* chunks, int index)
+    {
+        Chunk &chunk = chunks[index];
+        if (!chunk.valid) return;
+
+        AnalyzerDecoder<State>* decoder = &mDecoder;
+        if (index != 0) {
+            decoder = &chunk.decoder;
+            decoder->start(chunk.start, false);
+        }
+
+        int idx = decoder->position();
+        while (idx < chunk.endIdx && !isCancelled()) {
+            int next = qMin(chunk.endIdx, idx + DecodeChunkSize);
+            if (decoder->decode(&mCore, next)) {
+                break;
+            }
+            next = qMax(next, decoder->position());
+
+            int decoded = mParallelDecoded.fetchAndAddOrdered(next - idx) + (next - idx);
+            setProgress((int)(((qint64)decoded * 100) / (mParallelNumSamples - mParallelStartIdx)));
+            idx = next;
+        }
+    }
+
+    void publish()
+    {
+        setResults(mDecoder.items());
+    }
+};
+
+#endif // ANALYZERJOB_H
@@ -0,0 +1,67 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analyzerlayer.h"
+
+/*!
+    \class AnalyzerLayer
+    \brief Base class for decoders of another decoder's annotations.
+
+    \ingroup Analyzer
+
+    A protocol layered on top of another, e.g. the register accesses of an
+    I2C sensor or the commands of an SPI flash, is decoded from the
+    annotations of the lower protocol instead of from signal data. The
+    annotations are split into messages (e.g. an I2C transfer from START
+    to STOP) that can be decoded on their own, so only the messages in the
+    visible part of the capture need to be decoded, see \ref decodeRange.
+
+    A subclass holds the settings of the layer and knows nothing about the
+    UI. It is used by a UiStackedAnalyzer.
+*/
+
+/*!
+    \fn virtual int AnalyzerLayer::messageStart(const AnalyzerAnnotations &input, int item) const = 0
+
+    Returns the index of the first annotation of the message in \a input
+    that \a item belongs to.
+*/
+
+/*!
+    \fn virtual int AnalyzerLayer::decodeMessage(const AnalyzerAnnotations &input, int item, AnalyzerAnnotations &output) const = 0
+
+    Decodes the message in \a input starting at annotation \a item and
+    adds the found annotations to \a output. Returns the index of the
+    first annotation after the message.
+*/
+
+/*!
+    Decodes the messages in \a input overlapping the samples \a fromIdx to
+    \a toIdx and adds the found annotations to \a output.
+*/
+void AnalyzerLayer::decodeRange(const AnalyzerAnnotations &input, SampleIndex fromIdx, SampleIndex toIdx,
+                                AnalyzerAnnotations &output) const
+{
+    int item = input.lowerBound(fromIdx);
+
+    // the message of the last annotation before the range can reach into it
+    if (item > 0) {
+        item = messageStart(input, item-1);
+    }
+
+    while (item < input.size() && input.startIdx(item) <= toIdx) {
+        item = qMax(decodeMessage(input, item, output), item+1);
+    }
+}
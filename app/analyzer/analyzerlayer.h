@@ -0,0 +1,34 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALYZERLAYER_H
+#define ANALYZERLAYER_H
+
+#include "analyzerannotations.h"
+
+class AnalyzerLayer
+{
+public:
+    virtual ~AnalyzerLayer() {}
+
+    virtual int messageStart(const AnalyzerAnnotations &input, int item) const = 0;
+    virtual int decodeMessage(const AnalyzerAnnotations &input, int item,
+                              AnalyzerAnnotations &output) const = 0;
+
+    void decodeRange(const AnalyzerAnnotations &input, SampleIndex fromIdx, SampleIndex toIdx,
+                     AnalyzerAnnotations &output) const;
+};
+
+#endif // ANALYZERLAYER_H
@@ -16,7 +16,10 @@
 #include "analyzermanager.h"
 #include "i2c/uii2canalyzer.h"
 #include "uart/uiuartanalyzer.h"
+#include "bus/uibusanalyzer.h"
 #include "spi/uispianalyzer.h"
+#include "i2c/uii2cregisteranalyzer.h"
+#include "spi/uispiflashanalyzer.h"
 
 /*!
     \class AnalyzerManager
@@ -24,6 +27,15 @@
 
     \ingroup Analyzer
 
+    Analyzers are registered with a name, a function creating a new
+    analyzer and a function creating an analyzer from its settings string
+    (see \ref analyzerFromString). The name is shown to the user and is
+    also the first field of the settings string. The built-in analyzers
+    are registered the first time the list is used. A new analyzer only
+    needs a decoder core (see AnalyzerDecoder), a UiAnalyzer subclass
+    describing its annotations and a call to \ref registerAnalyzer. The
+    painting, searching and saving of the settings is then the same as for
+    the built-in analyzers.
 */
 
 
@@ -32,12 +44,12 @@
 */
 QList<QString> AnalyzerManager::analyzers()
 {
-    // return supported analyzers
+    QList<QString> names;
+    foreach(const Plugin &plugin, plugins()) {
+        names << plugin.name;
+    }
 
-    return QList<QString>()
-            << UiI2CAnalyzer::signalName
-            << UiUartAnalyzer::name
-            << UiSpiAnalyzer::signalName;
+    return names;
 }
 
 /*!
@@ -45,23 +57,81 @@ QList<QString> AnalyzerManager::analyzers()
 */
 UiAnalyzer* AnalyzerManager::createAnalyzer(const QString name)
 {
-    UiAnalyzer* analyzer = NULL;
+    const Plugin* plugin = findPlugin(name);
+    if (plugin == NULL) return NULL;
+
+    // Deallocation: caller is responsible for deallocation
+    return plugin->create();
+}
 
-    if (name == UiI2CAnalyzer::signalName) {
-        // Deallocation: caller is responsible for deallocation
-        analyzer = new UiI2CAnalyzer();
+/*!
+    Registers an analyzer with the given \a name. New analyzers are created
+    with \a create and loaded from persistent storage with \a fromString.
+    An analyzer registered with the name of an existing one replaces it.
+*/
+void AnalyzerManager::registerAnalyzer(const QString &name, CreateFunction create,
+                                       FromStringFunction fromString)
+{
+    QList<Plugin> &list = plugins();
+
+    Plugin plugin;
+    plugin.name = name;
+    plugin.create = create;
+    plugin.fromString = fromString;
+
+    for (int i = 0; i < list.size(); i++) {
+        if (list.at(i).name == name) {
+            list[i] = plugin;
+            return;
+        }
     }
-    else if (name == UiUartAnalyzer::name) {
-        // Deallocation: caller is responsible for deallocation
-        analyzer = new UiUartAnalyzer();
+
+    list.append(plugin);
+}
+
+/*!
+    \fn template <typename T> void AnalyzerManager::registerAnalyzer(const QString &name)
+
+    Registers the analyzer class \a T with the given \a name. \a T must
+    have a default constructor and a static fromSettingsString function.
+*/
+
+/*!
+    Returns the list of registered analyzers. The built-in analyzers are
+    added the first time.
+*/
+QList<AnalyzerManager::Plugin> &AnalyzerManager::plugins()
+{
+    static QList<Plugin> list;
+    static bool builtIn = false;
+
+    if (!builtIn) {
+        builtIn = true;
+        registerAnalyzer<UiI2CAnalyzer>(UiI2CAnalyzer::signalName);
+        registerAnalyzer<UiUartAnalyzer>(UiUartAnalyzer::name);
+        registerAnalyzer<UiSpiAnalyzer>(UiSpiAnalyzer::signalName);
+        registerAnalyzer<UiI2CRegisterAnalyzer>(UiI2CRegisterAnalyzer::signalName);
+        registerAnalyzer<UiSpiFlashAnalyzer>(UiSpiFlashAnalyzer::signalName);
+        registerAnalyzer<UiBusAnalyzer>(UiBusAnalyzer::name);
     }
 
-    else if (name == UiSpiAnalyzer::signalName) {
-        // Deallocation: caller is responsible for deallocation
-        analyzer = new UiSpiAnalyzer();
+    return list;
+}
+
+/*!
+    Returns the registered analyzer with the given \a name or NULL if there
+    is none.
+*/
+const AnalyzerManager::Plugin* AnalyzerManager::findPlugin(const QString &name)
+{
+    const QList<Plugin> &list = plugins();
+    for (int i = 0; i < list.size(); i++) {
+        if (list.at(i).name == name) {
+            return &list.at(i);
+        }
     }
 
-    return analyzer;
+    return NULL;
 }
 
 /*!
@@ -88,15 +158,9 @@ UiAnalyzer* AnalyzerManager::analyzerFromString(const QString &s)
     QStringList list = s.split(';');
     if (list.size() < 1) return NULL;
 
-    QString type = list.at(0);
-    if (type ==  UiI2CAnalyzer::signalName) {
-        analyzer = UiI2CAnalyzer::fromSettingsString(s);
-    }
-    else if (type == UiUartAnalyzer::name) {
-        analyzer = UiUartAnalyzer::fromSettingsString(s);
-    }
-    else if (type == UiSpiAnalyzer::signalName) {
-        analyzer = UiSpiAnalyzer::fromSettingsString(s);
+    const Plugin* plugin = findPlugin(list.at(0));
+    if (plugin != NULL) {
+        analyzer = plugin->fromString(s);
     }
 
     return analyzer;
@@ -24,16 +24,48 @@ class AnalyzerManager
 
 public:
 
+    typedef UiAnalyzer* (*CreateFunction)();
+    typedef UiAnalyzer* (*FromStringFunction)(const QString &s);
+
     static QList<QString> analyzers();
     static UiAnalyzer* createAnalyzer(const QString name);
     static QString analyzerToString(const UiAnalyzer* analyzer);
     static UiAnalyzer* analyzerFromString(const QString &s);
 
+    static void registerAnalyzer(const QString &name, CreateFunction create,
+                                 FromStringFunction fromString);
+
+    template <typename T>
+    static void registerAnalyzer(const QString &name)
+    {
+        registerAnalyzer(name, &createAnalyzerOf<T>, &analyzerFromStringOf<T>);
+    }
+
 
 private:
     explicit AnalyzerManager() {}
 
+    struct Plugin {
+        QString name;
+        CreateFunction create;
+        FromStringFunction fromString;
+    };
+
+    static QList<Plugin> &plugins();
+    static const Plugin* findPlugin(const QString &name);
+
+    template <typename T>
+    static UiAnalyzer* createAnalyzerOf()
+    {
+        // Deallocation: caller is responsible for deallocation
+        return new T();
+    }
 
+    template <typename T>
+    static UiAnalyzer* analyzerFromStringOf(const QString &s)
+    {
+        return T::fromSettingsString(s);
+    }
 };
 
 #endif // ANALYZERMANAGER_H
@@ -0,0 +1,232 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "busdecoder.h"
+
+/*!
+    \class BusDecoder
+    \brief Combines a group of digital signals into a stream of bus values.
+
+    \ingroup Analyzer
+
+    The BusDecoder class holds a copy of the data of each signal in the bus
+    and, optionally, of a clock (or strobe) signal. The first signal added
+    with addSignal() is bit 0 of the value. The copies share their data with
+    the capture device in the same way as for UartDecoder.
+
+    The signals are decoded one block of samples at a time. For each block
+    the samples of all signals are first transposed into one word per
+    sample, with the clock in the bit above the bus value. The loops doing
+    this run over one signal at a time and are easy for the compiler to
+    vectorize. The words are then scanned for events, which is a single
+    compare per sample however wide the bus is.
+
+    Without a clock an event is a change of the bus value. With a clock an
+    event is an active edge of the clock, where the bus value is sampled.
+    Each value is stored as one TYPE_DATA annotation from the event to the
+    next event, so a bus that rarely changes gives a short list that can be
+    searched like the items of any other analyzer.
+
+    UiBusAnalyzer decodes with it through an AnalyzerDecoderJob.
+*/
+
+/*!
+    Constructs a decoder without signals.
+*/
+BusDecoder::BusDecoder()
+{
+    mHasClock = false;
+    mClockEdge = Types::BusClockRising;
+    mNumSamples = 0;
+}
+
+/*!
+    Adds the signal \a data as the next, more significant, bit of the bus.
+*/
+void BusDecoder::addSignal(const QVector<int> &data)
+{
+    if (mSignals.isEmpty() || data.size() < mNumSamples) {
+        mNumSamples = data.size();
+    }
+    mSignals.append(data);
+}
+
+/*!
+    Samples the bus on the given \a edge of the clock signal \a data
+    instead of every time the value changes.
+*/
+void BusDecoder::setClock(const QVector<int> &data, Types::BusClockEdge edge)
+{
+    mClock = data;
+    mClockEdge = edge;
+    mHasClock = true;
+}
+
+/*!
+    Returns true if there is data to decode with the current settings.
+*/
+bool BusDecoder::isValid() const
+{
+    if (mSignals.isEmpty() || mSignals.size() > MaxWidth) return false;
+    if (mNumSamples == 0) return false;
+    if (mHasClock && mClock.size() < mNumSamples) return false;
+
+    return true;
+}
+
+/*!
+    Returns the decoder state for a new decoding starting at the sample
+    with index \a startIdx.
+*/
+BusDecoder::State BusDecoder::initialState(int startIdx) const
+{
+    State s;
+    s.pos = startIdx;
+    s.prev = -1;
+    s.runStart = -1;
+    s.value = 0;
+
+    return s;
+}
+
+/*!
+    Finds the first event in the range \a fromIdx to \a toIdx. A decoding
+    started at \a startIdx has then just started a new value at the event,
+    and the state it would have at the sample after the event is stored in
+    \a s. Returns false if there is no event in the range.
+*/
+bool BusDecoder::resyncState(int startIdx, int fromIdx, int toIdx, State* s) const
+{
+    fromIdx = qMax(fromIdx, startIdx + 1);
+    toIdx = qMin(toIdx, mNumSamples);
+
+    int words[BlockSize];
+
+    for (int idx = fromIdx - 1; idx < toIdx; idx += BlockSize - 1) {
+        int num = qMin((int)BlockSize, toIdx - idx);
+        if (num < 2) break;
+
+        packSamples(idx, num, words);
+
+        for (int i = 1; i < num; i++) {
+            if (isEvent(words[i-1], words[i])) {
+                s->pos = idx + i + 1;
+                s->prev = words[i];
+                s->runStart = idx + i;
+                s->value = words[i] & ((1 << mSignals.size()) - 1);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/*!
+    Decodes the signal data from the decoder state \a s until the sample with
+    index \a endIdx has been reached. Found items are added to \a items.
+    Returns true if the end of the signal data has been reached.
+*/
+bool BusDecoder::decodeSamples(State &s, AnalyzerAnnotations &items, int endIdx) const
+{
+    const int valueMask = (1 << mSignals.size()) - 1;
+    int words[BlockSize];
+
+    endIdx = qMin(endIdx, mNumSamples);
+
+    while (s.pos < endIdx) {
+        int num = qMin((int)BlockSize, endIdx - s.pos);
+        packSamples(s.pos, num, words);
+
+        for (int i = 0; i < num; i++) {
+            int word = words[i];
+
+            if (s.prev == -1) {
+                // first sample; without a clock it starts the first value
+                if (!mHasClock) {
+                    s.runStart = s.pos + i;
+                    s.value = word & valueMask;
+                }
+            }
+            else if (isEvent(s.prev, word)) {
+                if (s.runStart != -1) {
+                    items.append(s.runStart, s.pos + i, TYPE_DATA, s.value);
+                }
+                s.runStart = s.pos + i;
+                s.value = word & valueMask;
+            }
+
+            s.prev = word;
+        }
+
+        s.pos += num;
+    }
+
+    if (s.pos >= mNumSamples) {
+        if (s.runStart != -1) {
+            items.append(s.runStart, mNumSamples - 1, TYPE_DATA, s.value);
+            s.runStart = -1;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+    Transposes the \a num samples from \a fromIdx of all signals into
+    \a words, one word per sample.
+*/
+void BusDecoder::packSamples(int fromIdx, int num, int* words) const
+{
+    const int* clock = (mHasClock ? mClock.constData() + fromIdx : NULL);
+    const int clockBit = mSignals.size();
+
+    for (int i = 0; i < num; i++) {
+        words[i] = 0;
+    }
+
+    for (int bit = 0; bit < mSignals.size(); bit++) {
+        const int* data = mSignals.at(bit).constData() + fromIdx;
+        for (int i = 0; i < num; i++) {
+            words[i] |= (data[i] & 1) << bit;
+        }
+    }
+
+    if (clock != NULL) {
+        for (int i = 0; i < num; i++) {
+            words[i] |= (clock[i] & 1) << clockBit;
+        }
+    }
+}
+
+/*!
+    Returns true if going from the word \a prev to \a word is an event: an
+    active clock edge when there is a clock, otherwise a new bus value.
+*/
+bool BusDecoder::isEvent(int prev, int word) const
+{
+    if (!mHasClock) {
+        return prev != word;
+    }
+
+    int clockBit = 1 << mSignals.size();
+    if (((prev ^ word) & clockBit) == 0) {
+        return false;
+    }
+
+    bool high = ((word & clockBit) != 0);
+    return (mClockEdge == Types::BusClockRising ? high : !high);
+}
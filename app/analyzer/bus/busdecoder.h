@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef BUSDECODER_H
+#define BUSDECODER_H
+
+#include <QVector>
+#include <QList>
+
+#include "analyzer/analyzerannotations.h"
+
+#include "common/types.h"
+
+class BusDecoder
+{
+public:
+
+    /*!
+        Parallel bus item type
+    */
+    enum ItemType {
+        TYPE_DATA
+    };
+
+    /*!
+        Everything the decoder carries from one sample to the next. See
+        AnalyzerDecoder.
+    */
+    struct State {
+        int pos;
+        int prev;
+        int runStart;
+        int value;
+
+        bool operator==(const State &other) const {
+            return pos == other.pos && prev == other.prev
+                    && runStart == other.runStart && value == other.value;
+        }
+    };
+
+    BusDecoder();
+
+    void addSignal(const QVector<int> &data);
+    void setClock(const QVector<int> &data, Types::BusClockEdge edge);
+
+    bool isValid() const;
+    int numSamples() const {return mNumSamples;}
+    State initialState(int startIdx) const;
+    bool resyncState(int startIdx, int fromIdx, int toIdx, State* s) const;
+    bool decodeSamples(State &s, AnalyzerAnnotations &items, int endIdx) const;
+
+private:
+
+    enum Constants {
+        BlockSize = 1024,
+        MaxWidth = 30
+    };
+
+    QList<QVector<int> > mSignals;
+    QVector<int> mClock;
+    bool mHasClock;
+    Types::BusClockEdge mClockEdge;
+    int mNumSamples;
+
+    void packSamples(int fromIdx, int num, int* words) const;
+    bool isEvent(int prev, int word) const;
+};
+
+#endif // BUSDECODER_H
@@ -0,0 +1,370 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uibusanalyzer.h"
+
+#include <QDebug>
+
+#include "uibusanalyzerconfig.h"
+#include "device/devicemanager.h"
+
+/*!
+    Counter used when creating the editable name.
+*/
+int UiBusAnalyzer::busAnalyzerCounter = 0;
+
+/*!
+    Name of this analyzer.
+*/
+const QString UiBusAnalyzer::name = "Parallel Bus Analyzer";
+
+/*!
+    \class UiBusAnalyzer
+    \brief This class shows a group of digital signals as a parallel bus.
+
+    \ingroup Analyzer
+
+    The class combines a number of consecutive digital signals into one
+    value, either every time the value changes or on the edges of a clock
+    (strobe) signal, and shows the values in the selected data format.
+    Decoding is done by BusDecoder.
+*/
+
+
+/*!
+    Constructs the UiBusAnalyzer with the given \a parent.
+*/
+UiBusAnalyzer::UiBusAnalyzer(QWidget *parent) :
+    UiAnalyzer(parent)
+{
+    mFirstSignal = -1;
+    mWidth = 8;
+    mClockSignal = -1;
+    mClockEdge = Types::BusClockRising;
+    mFormat = Types::DataFormatHex;
+    mSyncCursor = UiCursor::NoCursor;
+
+    mIdLbl->setText("BUS");
+    mNameLbl->setText(QString("Bus %1").arg(busAnalyzerCounter++));
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSignalLbl = new QLabel(this);
+
+    QPalette palette= mSignalLbl->palette();
+    palette.setColor(QPalette::Text, Qt::gray);
+    mSignalLbl->setPalette(palette);
+
+    setFixedHeight(50);
+}
+
+/*!
+    Set the bus to the \a width signals starting with \a firstSignal, which
+    is the least significant bit. \a clockSignal is the signal the bus is
+    sampled with or -1 if the bus isn't clocked.
+*/
+void UiBusAnalyzer::setSignals(int firstSignal, int width, int clockSignal)
+{
+    mFirstSignal = firstSignal;
+    mWidth = width;
+    mClockSignal = clockSignal;
+
+    QString txt;
+    if (width == 1) {
+        txt = QString("Signal: D%1").arg(firstSignal);
+    }
+    else {
+        txt = QString("Signals: D%1-D%2").arg(firstSignal).arg(firstSignal+width-1);
+    }
+    if (clockSignal != -1) {
+        txt.append(QString(", clock D%1").arg(clockSignal));
+    }
+    mSignalLbl->setText(txt);
+}
+
+/*!
+    \fn int UiBusAnalyzer::firstSignal() const
+
+    Returns the ID of the signal used as the least significant bit.
+*/
+
+/*!
+    \fn int UiBusAnalyzer::width() const
+
+    Returns the number of signals in the bus.
+*/
+
+/*!
+    \fn int UiBusAnalyzer::clockSignal() const
+
+    Returns the ID of the clock signal or -1 if the bus isn't clocked.
+*/
+
+/*!
+    \fn void UiBusAnalyzer::setClockEdge(Types::BusClockEdge edge)
+
+    Set the clock edge the bus is sampled on.
+*/
+
+/*!
+    \fn Types::BusClockEdge UiBusAnalyzer::clockEdge() const
+
+    Returns the clock edge the bus is sampled on.
+*/
+
+/*!
+    \fn void UiBusAnalyzer::setDataFormat(Types::DataFormat format)
+
+    Set data format to \a format.
+*/
+
+/*!
+    \fn Types::DataFormat UiBusAnalyzer::dataFormat() const
+
+    Returns the data format.
+*/
+
+/*!
+    \fn void UiBusAnalyzer::setSyncCursor(UiCursor::CursorId id)
+
+    Set the cursor to use for synchronization.
+*/
+
+/*!
+    \fn UiCursor::CursorId UiBusAnalyzer::syncCursor() const
+
+    Returns the cursor used for synchronization.
+*/
+
+
+/*!
+    Creates a job decoding the signal data with the current settings. See
+    UiAnalyzer::createJob() for \a startIdx, \a visibleFrom, \a visibleTo
+    and \a keepPrevious.
+*/
+QSharedPointer<AnalyzerJob> UiBusAnalyzer::createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious)
+{
+    QSharedPointer<AnalyzerDecoderJob<BusDecoder> > previous = mJob;
+    mJob.clear();
+
+    if (mFirstSignal == -1) return mJob;
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+
+    BusDecoder decoder;
+    for (int i = 0; i < mWidth; i++) {
+        QVector<int>* data = device->digitalData(mFirstSignal + i);
+        if (data == NULL) return mJob;
+
+        decoder.addSignal(*data);
+    }
+
+    if (mClockSignal != -1) {
+        QVector<int>* clockData = device->digitalData(mClockSignal);
+        if (clockData == NULL) return mJob;
+
+        decoder.setClock(*clockData, mClockEdge);
+    }
+
+    if (!decoder.isValid()) return mJob;
+
+    mJob = QSharedPointer<AnalyzerDecoderJob<BusDecoder> >(
+                new AnalyzerDecoderJob<BusDecoder>(decoder, startIdx, visibleFrom, visibleTo));
+    if (keepPrevious && !previous.isNull()) {
+        mJob->keepPrevious(previous.data());
+    }
+
+    return mJob;
+}
+
+/*!
+    Configure the analyzer.
+*/
+void UiBusAnalyzer::configure(QWidget *parent)
+{
+    UiBusAnalyzerConfig dialog(parent);
+    dialog.setFirstSignal(mFirstSignal);
+    dialog.setWidth(mWidth);
+    dialog.setClockSignal(mClockSignal);
+    dialog.setClockEdge(mClockEdge);
+    dialog.setDataFormat(mFormat);
+    dialog.setSyncCursor(mSyncCursor);
+    dialog.exec();
+
+    setSignals(dialog.firstSignal(), dialog.width(), dialog.clockSignal());
+    setClockEdge(dialog.clockEdge());
+    setDataFormat(dialog.dataFormat());
+    setSyncCursor(dialog.syncCursor());
+
+
+    analyze();
+    update();
+}
+
+/*!
+    Returns a string representation of this analyzer.
+*/
+QString UiBusAnalyzer::toSettingsString() const
+{
+    // type;name;FirstSignal;Width;Clock;ClockEdge;Format;Sync
+
+    QString str;
+    str.append(UiBusAnalyzer::name);str.append(";");
+    str.append(getName());str.append(";");
+    str.append(QString("%1;").arg(firstSignal()));
+    str.append(QString("%1;").arg(width()));
+    str.append(QString("%1;").arg(clockSignal()));
+    str.append(QString("%1;").arg(clockEdge()));
+    str.append(QString("%1;").arg(dataFormat()));
+    str.append(QString("%1").arg(syncCursor()));
+
+    return str;
+}
+
+/*!
+    Create a parallel bus analyzer from the string representation \a s.
+
+    \sa toSettingsString
+*/
+UiBusAnalyzer* UiBusAnalyzer::fromSettingsString(const QString &s)
+{
+    UiBusAnalyzer* analyzer = NULL;
+    QString name;
+
+    bool ok = false;
+
+    do {
+        // type;name;FirstSignal;Width;Clock;ClockEdge;Format;Sync
+        QStringList list = s.split(';');
+        if (list.size() != 8) break;
+
+        // --- type
+        if (list.at(0) != UiBusAnalyzer::name) break;
+
+        // --- name
+        name = list.at(1);
+        if (name.isNull()) break;
+
+        // --- first signal
+        int firstSignal = list.at(2).toInt(&ok);
+        if (!ok) break;
+
+        // --- width
+        int width = list.at(3).toInt(&ok);
+        if (!ok) break;
+        if (width < 1) break;
+
+        // --- clock signal
+        int clockSignal = list.at(4).toInt(&ok);
+        if (!ok) break;
+
+        // --- clock edge
+        int e = list.at(5).toInt(&ok);
+        if (!ok) break;
+        if (e < 0 || e >= Types::BusClockNum) break;
+        Types::BusClockEdge edge = (Types::BusClockEdge)e;
+
+        // --- data format
+        int f = list.at(6).toInt(&ok);
+        if (!ok) break;
+        if (f < 0 || f >= Types::DataFormatNum) break;
+        Types::DataFormat format = (Types::DataFormat)f;
+
+        // --- sync cursor
+        int sc = list.at(7).toInt(&ok);
+        if (sc < 0 || sc > UiCursor::NumCursors) break;
+        UiCursor::CursorId syncCursor = (UiCursor::CursorId)sc;
+
+        // Deallocation: The caller of this function is responsible for
+        //               deallocation
+        analyzer = new UiBusAnalyzer();
+        if (analyzer == NULL) break;
+
+        analyzer->setSignalName(name);
+        analyzer->setSignals(firstSignal, width, clockSignal);
+        analyzer->setClockEdge(edge);
+        analyzer->setDataFormat(format);
+        analyzer->setSyncCursor(syncCursor);
+
+    } while (false);
+
+    return analyzer;
+}
+
+/*!
+    Event handler called when this widget is being shown
+*/
+void UiBusAnalyzer::showEvent(QShowEvent* event)
+{
+    (void) event;
+    doLayout();
+    setMinimumInfoWidth(calcMinimumWidth());
+}
+
+/*!
+    Called when the info width has changed for this widget.
+*/
+void UiBusAnalyzer::infoWidthChanged()
+{
+    doLayout();
+}
+
+/*!
+    Position the child widgets.
+*/
+void UiBusAnalyzer::doLayout()
+{
+    UiSimpleAbstractSignal::doLayout();
+
+    QRect r = infoContentRect();
+    int y = r.top();
+
+    mIdLbl->move(r.left(), y);
+
+    int x = mIdLbl->pos().x()+mIdLbl->width() + SignalIdMarginRight;
+    mNameLbl->move(x, y);
+    mEditName->move(x, y);
+
+    mSignalLbl->move(r.left(), r.bottom()-mSignalLbl->height());
+
+}
+
+/*!
+    Calculate and return the minimum width for this widget.
+*/
+int UiBusAnalyzer::calcMinimumWidth()
+{
+    int w = mNameLbl->pos().x() + mNameLbl->minimumSizeHint().width();
+    if (mEditName->isVisible()) {
+        w = mEditName->pos().x() + mEditName->width();
+    }
+
+    int w2 = mSignalLbl->pos().x()+mSignalLbl->width();
+    if (w2 > w) w = w2;
+
+    return w+infoContentMargin().right();
+}
+
+/*!
+    Sets \a shortTxt and \a longTxt to the short and long text for
+    annotation \a i in \a annotations.
+*/
+void UiBusAnalyzer::annotationText(const AnalyzerAnnotations &annotations, int i,
+                                   QString &shortTxt, QString &longTxt)
+{
+    if (annotations.type(i) == BusDecoder::TYPE_DATA) {
+        shortTxt = formatValue(mFormat, annotations.value(i));
+        longTxt = shortTxt;
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIBUSANALYZER_H
+#define UIBUSANALYZER_H
+
+#include <QWidget>
+
+#include "analyzer/uianalyzer.h"
+#include "analyzer/analyzerjob.h"
+#include "capture/uicursor.h"
+#include "busdecoder.h"
+
+class UiBusAnalyzer : public UiAnalyzer
+{
+    Q_OBJECT
+public:
+    static const QString name;
+
+
+    explicit UiBusAnalyzer(QWidget *parent = 0);
+
+    void setSignals(int firstSignal, int width, int clockSignal);
+    int firstSignal() const {return mFirstSignal;}
+    int width() const {return mWidth;}
+    int clockSignal() const {return mClockSignal;}
+
+    void setClockEdge(Types::BusClockEdge edge) {mClockEdge = edge;}
+    Types::BusClockEdge clockEdge() const {return mClockEdge;}
+
+    void setDataFormat(Types::DataFormat format) {mFormat = format;}
+    Types::DataFormat dataFormat() const {return mFormat;}
+
+    void setSyncCursor(UiCursor::CursorId id) {mSyncCursor = id;}
+    UiCursor::CursorId syncCursor() const {return mSyncCursor;}
+
+    void configure(QWidget* parent);
+
+    QString toSettingsString() const;
+    static UiBusAnalyzer* fromSettingsString(const QString &settings);
+
+signals:
+
+public slots:
+
+protected:
+    void showEvent(QShowEvent* event);
+
+    QSharedPointer<AnalyzerJob> createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious);
+    void annotationText(const AnalyzerAnnotations &annotations, int i,
+                        QString &shortTxt, QString &longTxt);
+
+private:
+
+    enum {
+        SignalIdMarginRight = 10
+    };
+
+    static int busAnalyzerCounter;
+    int mFirstSignal;
+    int mWidth;
+    int mClockSignal;
+    Types::BusClockEdge mClockEdge;
+    Types::DataFormat mFormat;
+    UiCursor::CursorId mSyncCursor;
+
+    QLabel* mSignalLbl;
+
+    QSharedPointer<AnalyzerDecoderJob<BusDecoder> > mJob;
+
+    void infoWidthChanged();
+    void doLayout();
+    int calcMinimumWidth();
+
+};
+
+#endif // UIBUSANALYZER_H
@@ -0,0 +1,181 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uibusanalyzerconfig.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+
+#include "common/inputhelper.h"
+
+/*!
+    \class UiBusAnalyzerConfig
+    \brief Dialog window used to configure the parallel bus analyzer.
+
+    \ingroup Analyzer
+
+*/
+
+
+/*!
+    Constructs the UiBusAnalyzerConfig with the given \a parent.
+*/
+UiBusAnalyzerConfig::UiBusAnalyzerConfig(QWidget *parent) :
+    UiAnalyzerConfig(parent)
+{
+    setWindowTitle(tr("Parallel Bus Analyzer"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* formLayout = new QFormLayout;
+
+    mFirstSignalBox = InputHelper::createSignalBox(this, 0);
+    formLayout->addRow(tr("First signal (LSB): "), mFirstSignalBox);
+
+    mWidthBox = InputHelper::createBusWidthBox(this, 8);
+    formLayout->addRow(tr("Number of signals: "), mWidthBox);
+
+    mClockBox = InputHelper::createBusClockBox(this, -1);
+    formLayout->addRow(tr("Clock signal: "), mClockBox);
+
+    mClockEdgeBox = InputHelper::createBusClockEdgeBox(this, Types::BusClockRising);
+    formLayout->addRow(tr("Clock edge: "), mClockEdgeBox);
+
+    mFormatBox = InputHelper::createFormatBox(this, Types::DataFormatHex);
+    formLayout->addRow(tr("Data format: "), mFormatBox);
+
+    mCursorBox = InputHelper::createActiveCursorsBox(this, UiCursor::NoCursor);
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QLabel* cursorLbl = new QLabel(tr("Synchronize: "), this);
+    cursorLbl->setToolTip(tr("Start to analyze from a cursor position"));
+    formLayout->addRow(cursorLbl, mCursorBox);
+
+
+    // Deallocation: Ownership changed when calling setLayout
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Ok,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(accepted()), this, SLOT(accept()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(bottonBox);
+
+
+    setLayout(verticalLayout);
+}
+
+/*!
+    Returns the ID of the selected first (least significant) signal.
+*/
+int UiBusAnalyzerConfig::firstSignal()
+{
+    return InputHelper::intValue(mFirstSignalBox);
+}
+
+/*!
+    Set the first (least significant) signal to \a id.
+*/
+void UiBusAnalyzerConfig::setFirstSignal(int id)
+{
+    InputHelper::setInt(mFirstSignalBox, id);
+}
+
+/*!
+    Returns the selected number of signals in the bus.
+*/
+int UiBusAnalyzerConfig::width()
+{
+    return InputHelper::intValue(mWidthBox);
+}
+
+/*!
+    Set the number of signals in the bus to \a width.
+*/
+void UiBusAnalyzerConfig::setWidth(int width)
+{
+    InputHelper::setInt(mWidthBox, width);
+}
+
+/*!
+    Returns the ID of the selected clock signal or -1 if none is selected.
+*/
+int UiBusAnalyzerConfig::clockSignal()
+{
+    return InputHelper::intValue(mClockBox);
+}
+
+/*!
+    Set the clock signal to \a id, or to none if \a id is -1.
+*/
+void UiBusAnalyzerConfig::setClockSignal(int id)
+{
+    InputHelper::setInt(mClockBox, id);
+}
+
+/*!
+    Returns the selected clock edge.
+*/
+Types::BusClockEdge UiBusAnalyzerConfig::clockEdge()
+{
+    return (Types::BusClockEdge)InputHelper::intValue(mClockEdgeBox);
+}
+
+/*!
+    Set the clock edge to \a edge.
+*/
+void UiBusAnalyzerConfig::setClockEdge(Types::BusClockEdge edge)
+{
+    InputHelper::setInt(mClockEdgeBox, (int)edge);
+}
+
+/*!
+    Set the data format to \a format.
+*/
+void UiBusAnalyzerConfig::setDataFormat(Types::DataFormat format)
+{
+    InputHelper::setInt(mFormatBox, (int)format);
+}
+
+/*!
+    Returns the data format.
+*/
+Types::DataFormat UiBusAnalyzerConfig::dataFormat()
+{
+    int f = InputHelper::intValue(mFormatBox);
+    return (Types::DataFormat)f;
+}
+
+/*!
+    Returns the cursor used for synchronization.
+*/
+UiCursor::CursorId UiBusAnalyzerConfig::syncCursor()
+{
+    return (UiCursor::CursorId)InputHelper::intValue(mCursorBox);
+}
+
+/*!
+    Sets the cursor used for synchronization.
+*/
+void UiBusAnalyzerConfig::setSyncCursor(UiCursor::CursorId id)
+{
+    InputHelper::setInt(mCursorBox, id);
+}
@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIBUSANALYZERCONFIG_H
+#define UIBUSANALYZERCONFIG_H
+
+#include <QWidget>
+
+#include "uibusanalyzer.h"
+#include "analyzer/uianalyzerconfig.h"
+#include "capture/uicursor.h"
+
+
+class UiBusAnalyzerConfig : public UiAnalyzerConfig
+{
+    Q_OBJECT
+public:
+    explicit UiBusAnalyzerConfig(QWidget *parent = 0);
+
+    int firstSignal();
+    void setFirstSignal(int id);
+
+    int width();
+    void setWidth(int width);
+
+    int clockSignal();
+    void setClockSignal(int id);
+
+    Types::BusClockEdge clockEdge();
+    void setClockEdge(Types::BusClockEdge edge);
+
+    Types::DataFormat dataFormat();
+    void setDataFormat(Types::DataFormat format);
+
+    UiCursor::CursorId syncCursor();
+    void setSyncCursor(UiCursor::CursorId id);
+
+signals:
+
+public slots:
+
+private:
+
+    QComboBox* mFirstSignalBox;
+    QComboBox* mWidthBox;
+    QComboBox* mClockBox;
+    QComboBox* mClockEdgeBox;
+    QComboBox* mFormatBox;
+    QComboBox* mCursorBox;
+
+};
+
+#endif // UIBUSANALYZERCONFIG_H
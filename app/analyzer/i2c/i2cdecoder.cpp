@@ -0,0 +1,366 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "i2cdecoder.h"
+
+#include <QDebug>
+
+/*!
+    \class I2CDecoder
+    \brief Decodes I2C data from two digital signals.
+
+    \ingroup Analyzer
+
+    The I2CDecoder class holds copies of the signal data and knows nothing
+    about the UI, so it can decode on another thread. See UartDecoder.
+*/
+
+/*!
+    Sets the signal data to decode: \a scl and \a sda.
+*/
+void I2CDecoder::setData(const QVector<int> &scl, const QVector<int> &sda)
+{
+    mSclData = scl;
+    mSdaData = sda;
+}
+
+/*!
+    Returns true if there is data to decode.
+*/
+bool I2CDecoder::isValid() const
+{
+    if (mSclData.size() == 0 || mSdaData.size() == 0
+            || mSclData.size() != mSdaData.size()) return false;
+
+    return true;
+}
+
+/*!
+    Returns the decoder state for a new decoding starting at the sample
+    with index \a startIdx.
+*/
+I2CDecoder::State I2CDecoder::initialState(int startIdx) const
+{
+    State s;
+    s.pos = startIdx;
+    s.prevSda = mSdaData.at(startIdx);
+    s.prevScl = mSclData.at(startIdx);
+    s.sclHLIdx = -1;
+    s.data = 0;
+    s.dataBitCnt = 8;
+    s.startIdx = -1;
+    s.findAddress = false;
+    s.tenBit = false;
+    s.address = 0;
+    s.dir = 0;
+    s.numErrors = 0;
+    s.startFound = false;
+
+    return s;
+}
+
+/*!
+    Finds the first sample in the range \a fromIdx to \a toIdx that
+    follows a STOP condition while the bus is still idle. A decoding started
+    at \a startIdx is then waiting for a START condition, and the state it
+    would have at that sample is stored in \a s. Returns false if there is
+    no such sample in the range.
+*/
+bool I2CDecoder::resyncState(int startIdx, int fromIdx, int toIdx, State* s) const
+{
+    toIdx = qMin(toIdx, mSclData.size());
+    for (int i = qMax(fromIdx, startIdx + 2); i < toIdx; i++) {
+        // STOP: SDA goes high while SCL is high. Both must still be high
+        // at the sample after it.
+        if (mSdaData.at(i-2) != 0 || mSdaData.at(i-1) != 1 || mSdaData.at(i) != 1
+                || mSclData.at(i-2) != 1 || mSclData.at(i-1) != 1 || mSclData.at(i) != 1) {
+            continue;
+        }
+
+        *s = initialState(i);
+        s->startFound = true;
+
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+    Decodes the signal data from the decoder state \a s until the sample with
+    index \a endIdx has been reached. Found items are added to \a items.
+    Returns true if the end of the signal data has been reached or if there
+    were too many bus errors.
+*/
+bool I2CDecoder::decodeSamples(State &s, AnalyzerAnnotations &items, int endIdx) const
+{
+    /*
+        Specification details
+
+        1. SDA line can only change when SCL line is LOW for data
+        2. START = HIGH to LOW on SDA line while SCL line is HIGH
+        3. STOP  = LOW to HIGH on SDA line while SCL line is HIGH
+        4. Each byte put on the SDA line must be 8 bits long
+        5. Each byte is followed by an Acknowledge bit (ACK or NACK)
+        6. ACK  = SDA line LOW during ninth clock pulse
+        7. NACK = SDA line HIGH during ninth clock pulse
+        8. 7-bit Address:
+              7 bits + 1 bit which indicate R/W ( Read (1) or Write (0) )
+        9. 10-bit Address:
+              - The 7 first bits of the first byte are the combination 1111 0XX
+                of which the last two bits are the two most-significant bits of
+                the 10-bit address; the eight bit of the first byte is the R/W
+                bit.
+              - As always a byte is followed by an Acknowledge bit
+              - The second byte is the 8 least-significant bits of the 10-bit
+                address.
+
+     */
+
+    const QVector<int>* sclData = &mSclData;
+    const QVector<int>* sdaData = &mSdaData;
+
+    int sda = 0;
+    int scl = 0;
+    bool errorFound = false;
+
+    // start to analyze when start condition has been detected
+    bool detectStart = true;
+
+    while (s.pos < endIdx) {
+
+        if (s.pos >= sclData->size()) return true;
+
+        sda = sdaData->at(s.pos);
+        scl = sclData->at(s.pos);
+
+        //
+        // HIGH -> LOW transition for SCL starts a bit transaction. A transition
+        // on SDA is only allowed to occur when SCL is low (except for START/STOP)
+        //
+        if (s.prevScl > scl) {
+
+            do {
+
+                if (detectStart && !s.startFound) break;
+
+                // record the HIGH-LOW transition index for SCL.
+                s.sclHLIdx = s.pos;
+
+                // record start index for a data byte
+                if (s.dataBitCnt == 8) {
+                    s.startIdx = s.pos;
+                    break;
+                }
+
+                // nothing to do until dataBitCnt = 0
+                if (s.dataBitCnt != 0) {
+                    break;
+                }
+
+                // ---
+                // at this point a complete byte has been received
+                // ---
+
+                if (s.findAddress) {
+                    ItemType i2cType = I2C_7_ADDRESS_WRITE;
+
+                    // 10-bit address: See Spec 9.
+                    if ((s.data & 0xF8) == 0xF0) {
+                        s.tenBit = true;
+                        s.address = ((s.data & 0x06) << 7);
+
+                        // direction (R/W) is defined by bit 0 in the first byte
+                        s.dir = (s.data & 0x01);
+
+                        if (s.dir) {
+                            i2cType = I2C_10_ADDRESS_READ;
+                        }
+                        else {
+                            i2cType = I2C_10_ADDRESS_WRITE;
+                        }
+                    }
+
+                    // 7-bit address or second byte for 10-bit address
+                    else {
+
+                        if (s.tenBit) {
+                            s.address |= (s.data & 0xFF);
+                        }
+
+                        // 7-bit address
+                        else {
+
+                            s.address = ((s.data >> 1) & 0xFF);
+
+                            // direction (R/W) is defined by bit 0 in the address byte
+                            s.dir = (s.data & 0x01);
+
+                            if (s.dir) {
+                                i2cType = I2C_7_ADDRESS_READ;
+                            }
+                            else {
+                                i2cType = I2C_7_ADDRESS_WRITE;
+                            }
+
+                        }
+
+
+                        items.append(s.startIdx, s.pos, i2cType, s.address);
+
+
+                        s.tenBit = false;
+                        s.findAddress = false;
+                    }
+
+                }
+
+                // DATA
+                else {
+
+                    items.append(s.startIdx, s.pos, I2C_DATA, s.data);
+                }
+
+
+
+           } while (0);
+
+        }
+
+
+        //
+        // LOW -> HIGH transition for SCL. SDA should remain stable when SCL
+        // is high to detect a correct bit value.
+        //
+        else if (s.prevScl < scl){
+
+            do {
+
+                if (detectStart && !s.startFound) break;
+
+                // SDA must not change when SCL is high (See Spec 1.)
+                if (s.prevSda != sda) {
+
+                    errorFound = true;
+                    items.append(s.pos, -1, I2C_ERROR, -1);
+
+                    s.numErrors++;
+                    break;
+                }
+
+                // read data
+                if (s.dataBitCnt > 0) {
+                    // the left-shift is a bit index (0-7)
+                    // -> decrease dataBitCnt before shifting
+                    s.data |= (sda << (--s.dataBitCnt));
+                }
+
+                // check acknowledge bit
+                else {
+
+                    // ACK
+                    if (sda == 0) {
+
+                        // using the last HIGH-LOW transition for SCL as start index
+                        items.append(s.sclHLIdx, -1, I2C_ACK, -1);
+                    }
+
+                    // NACK
+                    else {
+
+                        // using the last HIGH-LOW transition for SCL as start index
+                        items.append(s.sclHLIdx, -1, I2C_NACK, -1);
+                    }
+
+
+                    // ready to read a new byte
+                    s.dataBitCnt = 8;
+                    s.data = 0;
+                }
+
+
+
+           } while (0);
+
+        }
+
+
+        //
+        // Detect Start and Stop conditions. Transition while SCL is HIGH
+        //
+        if (!errorFound && scl == 1 && sda != s.prevSda) {
+
+            do {
+
+                // This should not occur while reading a data byte
+                // If it does it is a bus error (See Spec 1.)
+                if (s.dataBitCnt > 0 && s.dataBitCnt < 7) {
+
+                    // reset reading data
+                    s.dataBitCnt = 8;
+
+                    items.append(s.pos, -1, I2C_ERROR, -1);
+
+                    s.numErrors++;
+                    break;
+                }
+
+                // HIGH -> LOW = Start
+                if (s.prevSda > sda) {
+
+                    items.append(s.pos, -1, I2C_START, -1);
+
+                    s.findAddress = true;
+                    s.startFound = true;
+                }
+
+                // LOW -> HIGH = Stop
+                else {
+
+                    if (!detectStart || (detectStart&&s.startFound)) {
+                        items.append(s.pos, -1, I2C_STOP, -1);
+                    }
+
+                    // nothing from the transfer is needed after a STOP
+                    // except an unfinished 10-bit address
+                    s.sclHLIdx = -1;
+                    s.startIdx = -1;
+                    s.dir = 0;
+                    if (!s.tenBit) {
+                        s.address = 0;
+                    }
+                }
+
+                s.data = 0;
+                s.dataBitCnt = 8;
+
+            } while (0);
+        }
+
+
+        s.prevSda = sda;
+        s.prevScl = scl;
+        errorFound = false;
+        s.pos++;
+
+        if (s.numErrors > MaxNumBusErrors) {
+            qDebug() << "Too many bus errors "<<s.numErrors<<" > " << MaxNumBusErrors;
+            return true;
+        }
+
+    }
+
+    return false;
+}
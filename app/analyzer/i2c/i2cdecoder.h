@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef I2CDECODER_H
+#define I2CDECODER_H
+
+#include <QVector>
+
+#include "analyzer/analyzerannotations.h"
+
+class I2CDecoder
+{
+public:
+
+    /*!
+        I2C item type
+    */
+    enum ItemType {
+        I2C_START,
+        I2C_STOP,
+        I2C_ACK,
+        I2C_NACK,
+        I2C_DATA,
+        I2C_7_ADDRESS_WRITE,
+        I2C_7_ADDRESS_READ,
+        I2C_10_ADDRESS_WRITE,
+        I2C_10_ADDRESS_READ,
+        I2C_ERROR
+    };
+
+    /*!
+        Everything the decoder carries from one sample to the next. See
+        AnalyzerDecoder.
+    */
+    struct State {
+        int pos;
+        int prevSda;
+        int prevScl;
+        int sclHLIdx;
+        int data;
+        int dataBitCnt;
+        int startIdx;
+        bool findAddress;
+        bool tenBit;
+        int address;
+        int dir;
+        int numErrors;
+        bool startFound;
+
+        bool operator==(const State &other) const {
+            return pos == other.pos && prevSda == other.prevSda
+                    && prevScl == other.prevScl
+                    && sclHLIdx == other.sclHLIdx && data == other.data
+                    && dataBitCnt == other.dataBitCnt
+                    && startIdx == other.startIdx
+                    && findAddress == other.findAddress
+                    && tenBit == other.tenBit && address == other.address
+                    && dir == other.dir && numErrors == other.numErrors
+                    && startFound == other.startFound;
+        }
+    };
+
+    void setData(const QVector<int> &scl, const QVector<int> &sda);
+
+    bool isValid() const;
+    int numSamples() const {return mSclData.size();}
+    State initialState(int startIdx) const;
+    bool resyncState(int startIdx, int fromIdx, int toIdx, State* s) const;
+    bool decodeSamples(State &s, AnalyzerAnnotations &items, int endIdx) const;
+
+private:
+
+    enum {
+        MaxNumBusErrors = 5
+    };
+
+    QVector<int> mSclData;
+    QVector<int> mSdaData;
+};
+
+#endif // I2CDECODER_H
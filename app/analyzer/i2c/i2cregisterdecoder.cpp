@@ -0,0 +1,153 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "i2cregisterdecoder.h"
+
+#include "i2cdecoder.h"
+
+/*!
+    \class I2CRegisterDecoder
+    \brief Decodes register accesses from the items of an I2CDecoder.
+
+    \ingroup Analyzer
+
+    Most I2C EEPROMs and sensors are accessed as a set of registers. A
+    write transfer starts with the register address (one or two bytes,
+    see \ref setAddressBytes) followed by the data to write. A read
+    transfer writes the register address, sends a repeated START and then
+    reads the data. The register address is incremented after each data
+    byte.
+
+    A message is an I2C transfer from a START that follows a STOP (or a
+    bus error) up to and including the next STOP. For each transfer a
+    TYPE_REGISTER item with the register address is added, followed by one
+    TYPE_WRITE or TYPE_READ item per data byte with the value
+    (register << 8) | data. A read that doesn't write the register address
+    first reads from the device's current address, which can't be known
+    without decoding everything before it, and gives TYPE_READ_CURRENT
+    items with only the data as value.
+*/
+
+/*!
+    Constructs a decoder for one byte register addresses.
+*/
+I2CRegisterDecoder::I2CRegisterDecoder()
+{
+    mAddressBytes = 1;
+}
+
+/*!
+    \fn void I2CRegisterDecoder::setAddressBytes(int bytes)
+
+    Set the number of \a bytes in a register address.
+*/
+
+/*!
+    Returns the index of the START beginning the transfer that \a item in
+    the I2C items \a input belongs to. A repeated START doesn't begin a
+    transfer.
+*/
+int I2CRegisterDecoder::messageStart(const AnalyzerAnnotations &input, int item) const
+{
+    for (int i = item; i > 0; i--) {
+        if (input.type(i) != I2CDecoder::I2C_START) continue;
+
+        int prev = input.type(i-1);
+        if (prev == I2CDecoder::I2C_STOP || prev == I2CDecoder::I2C_ERROR) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+    Decodes the transfer starting at \a item in the I2C items \a input and
+    adds the register accesses to \a output. Returns the index of the item
+    after the transfer.
+*/
+int I2CRegisterDecoder::decodeMessage(const AnalyzerAnnotations &input, int item,
+                                      AnalyzerAnnotations &output) const
+{
+    if (input.type(item) != I2CDecoder::I2C_START) return item+1;
+
+    int regMask = (1 << (8*mAddressBytes)) - 1;
+    int reg = -1;
+    int regBytes = 0;
+    SampleIndex regStartIdx = -1;
+    bool addressed = false;
+    bool read = false;
+
+    int i = item+1;
+    for (; i < input.size(); i++) {
+        int value = input.value(i);
+
+        switch (input.type(i)) {
+        case I2CDecoder::I2C_STOP:
+        case I2CDecoder::I2C_ERROR:
+            return i+1;
+
+        case I2CDecoder::I2C_START:
+            // repeated start
+            addressed = false;
+            break;
+
+        case I2CDecoder::I2C_7_ADDRESS_WRITE:
+        case I2CDecoder::I2C_10_ADDRESS_WRITE:
+            addressed = true;
+            read = false;
+            reg = -1;
+            regBytes = 0;
+            break;
+
+        case I2CDecoder::I2C_7_ADDRESS_READ:
+        case I2CDecoder::I2C_10_ADDRESS_READ:
+            addressed = true;
+            read = true;
+            break;
+
+        case I2CDecoder::I2C_DATA:
+            if (!addressed) break;
+
+            // the first bytes written are the register address
+            if (!read && regBytes < mAddressBytes) {
+                if (regBytes == 0) {
+                    regStartIdx = input.startIdx(i);
+                    reg = 0;
+                }
+                reg = (reg << 8) | value;
+                regBytes++;
+
+                if (regBytes == mAddressBytes) {
+                    output.append(regStartIdx, input.stopIdx(i), TYPE_REGISTER, reg);
+                }
+            }
+            else if (reg == -1 || regBytes < mAddressBytes) {
+                output.append(input.startIdx(i), input.stopIdx(i), TYPE_READ_CURRENT, value);
+            }
+            else {
+                output.append(input.startIdx(i), input.stopIdx(i),
+                              read ? TYPE_READ : TYPE_WRITE, (reg << 8) | value);
+                reg = (reg + 1) & regMask;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return i;
+}
@@ -0,0 +1,47 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef I2CREGISTERDECODER_H
+#define I2CREGISTERDECODER_H
+
+#include "analyzer/analyzerlayer.h"
+
+class I2CRegisterDecoder : public AnalyzerLayer
+{
+public:
+
+    /*!
+        Register access item type
+    */
+    enum ItemType {
+        TYPE_REGISTER,
+        TYPE_WRITE,
+        TYPE_READ,
+        TYPE_READ_CURRENT
+    };
+
+    I2CRegisterDecoder();
+
+    void setAddressBytes(int bytes) {mAddressBytes = bytes;}
+
+    int messageStart(const AnalyzerAnnotations &input, int item) const;
+    int decodeMessage(const AnalyzerAnnotations &input, int item,
+                      AnalyzerAnnotations &output) const;
+
+private:
+    int mAddressBytes;
+};
+
+#endif // I2CREGISTERDECODER_H
@@ -15,15 +15,11 @@
  */
 #include "uii2canalyzer.h"
 
-#include <QDebug>
-#include <QPainter>
 #include <QEvent>
 #include <QHelpEvent>
 #include <QToolTip>
 
 #include "uii2canalyzerconfig.h"
-#include "common/configuration.h"
-#include "capture/cursormanager.h"
 #include "device/devicemanager.h"
 
 /*!
@@ -132,43 +128,23 @@ void UiI2CAnalyzer::setDataFormat(Types::DataFormat format)
 */
 
 /*!
-    \fn UiCursor::CursorId UiI2CAnalyzer::syncCursor()
+    \fn UiCursor::CursorId UiI2CAnalyzer::syncCursor() const
 
     Returns the cursor used for synchronization.
 */
 
 
 /*!
-    Start to analyze the signal data.
+    Creates a job decoding the signal data with the current settings. See
+    UiAnalyzer::createJob() for \a startIdx, \a visibleFrom, \a visibleTo
+    and \a keepPrevious.
 */
-void UiI2CAnalyzer::analyze()
+QSharedPointer<AnalyzerJob> UiI2CAnalyzer::createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious)
 {
-    /*
-        Specification details
-
-        1. SDA line can only change when SCL line is LOW for data
-        2. START = HIGH to LOW on SDA line while SCL line is HIGH
-        3. STOP  = LOW to HIGH on SDA line while SCL line is HIGH
-        4. Each byte put on the SDA line must be 8 bits long
-        5. Each byte is followed by an Acknowledge bit (ACK or NACK)
-        6. ACK  = SDA line LOW during ninth clock pulse
-        7. NACK = SDA line HIGH during ninth clock pulse
-        8. 7-bit Address:
-              7 bits + 1 bit which indicate R/W ( Read (1) or Write (0) )
-        9. 10-bit Address:
-              - The 7 first bits of the first byte are the combination 1111 0XX
-                of which the last two bits are the two most-significant bits of
-                the 10-bit address; the eight bit of the first byte is the R/W
-                bit.
-              - As always a byte is followed by an Acknowledge bit
-              - The second byte is the 8 least-significant bits of the 10-bit
-                address.
-
-     */
-
-    mI2cItems.clear();
-
-    if (mSclSignalId == -1 || mSdaSignalId == -1) return;
+    QSharedPointer<AnalyzerDecoderJob<I2CDecoder> > previous = mJob;
+    mJob.clear();
+
+    if (mSclSignalId == -1 || mSdaSignalId == -1) return mJob;
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
@@ -176,263 +152,20 @@ void UiI2CAnalyzer::analyze()
     QVector<int>* sclData = device->digitalData(mSclSignalId);
     QVector<int>* sdaData = device->digitalData(mSdaSignalId);
 
-    if (sclData == NULL || sdaData == NULL) return;
-    if (sclData->size() == 0 || sdaData->size() == 0
-            || sclData->size() != sdaData->size()) return;
-
-    int sda = 0;
-    int scl = 0;
-    int prevSda = sdaData->at(0);
-    int prevScl = sclData->at(0);
-    int sclHLIdx = -1;
-
-    int data = 0;
-    int dataBitCnt = 8;
-    int startIdx = -1;
-
-    bool findAddress = false;
-    bool tenBit = false;
-    int address = 0;
-    int dir = 0;
-
-    int numErrors = 0;
-    bool errorFound = false;
-
-    // start to analyze when start condition has been detected
-    bool detectStart = true;
-    bool startFound = false;
-
-    int pos = 0;
-    if (mSyncCursor != UiCursor::NoCursor) {
-        double t = CursorManager::instance().cursorPosition(mSyncCursor);
-        if (t > 0 && CursorManager::instance().isCursorOn(mSyncCursor)) {
-            pos = device->usedSampleRate()*t;
-        }
-        if (pos >= sclData->size()) {
-            pos = 0;
-        }
-    }
-
-    for (int i = pos; i < sclData->size(); i++) {
-
-        sda = sdaData->at(i);
-        scl = sclData->at(i);
-
-        //
-        // HIGH -> LOW transition for SCL starts a bit transaction. A transition
-        // on SDA is only allowed to occur when SCL is low (except for START/STOP)
-        //
-        if (prevScl > scl) {
-
-            do {
-
-                if (detectStart && !startFound) break;
-
-                // record the HIGH-LOW transition index for SCL.
-                sclHLIdx = i;
-
-                // record start index for a data byte
-                if (dataBitCnt == 8) {
-                    startIdx = i;
-                    break;
-                }
-
-                // nothing to do until dataBitCnt = 0
-                if (dataBitCnt != 0) {
-                    break;
-                }
-
-                // ---
-                // at this point a complete byte has been received
-                // ---
-
-                if (findAddress) {
-                    I2CItem::I2CType i2cType = I2CItem::I2C_7_ADDRESS_WRITE;
-
-                    // 10-bit address: See Spec 9.
-                    if ((data & 0xF8) == 0xF0) {
-                        tenBit = true;
-                        address = ((data & 0x06) << 7);
-
-                        // direction (R/W) is defined by bit 0 in the first byte
-                        dir = (data & 0x01);
-
-                        if (dir) {
-                            i2cType = I2CItem::I2C_10_ADDRESS_READ;
-                        }
-                        else {
-                            i2cType = I2CItem::I2C_10_ADDRESS_WRITE;
-                        }
-                    }
-
-                    // 7-bit address or second byte for 10-bit address
-                    else {
-
-                        if (tenBit) {
-                            address |= (data & 0xFF);
-                        }
-
-                        // 7-bit address
-                        else {
-
-                            address = ((data >> 1) & 0xFF);
-
-                            // direction (R/W) is defined by bit 0 in the address byte
-                            dir = (data & 0x01);
-
-                            if (dir) {
-                                i2cType = I2CItem::I2C_7_ADDRESS_READ;
-                            }
-                            else {
-                                i2cType = I2CItem::I2C_7_ADDRESS_WRITE;
-                            }
-
-                        }
-
-
-                        I2CItem item(i2cType, address, startIdx, i);
-                        mI2cItems.append(item);
-
-
-                        tenBit = false;
-                        findAddress = false;
-                    }
-
-                }
-
-                // DATA
-                else {
-
-                    I2CItem item(I2CItem::I2C_DATA, data, startIdx, i);
-                    mI2cItems.append(item);
-                }
-
-
-
-           } while (0);
-
-        }
-
-
-        //
-        // LOW -> HIGH transition for SCL. SDA should remain stable when SCL
-        // is high to detect a correct bit value.
-        //
-        else if (prevScl < scl){
-
-            do {
-
-                if (detectStart && !startFound) break;
-
-                // SDA must not change when SCL is high (See Spec 1.)
-                if (prevSda != sda) {
-
-                    errorFound = true;
-                    I2CItem item(I2CItem::I2C_ERROR, -1, i, -1);
-                    mI2cItems.append(item);
-
-                    numErrors++;
-                    break;
-                }
-
-                // read data
-                if (dataBitCnt > 0) {
-                    // the left-shift is a bit index (0-7)
-                    // -> decrease dataBitCnt before shifting
-                    data |= (sda << (--dataBitCnt));
-                }
-
-                // check acknowledge bit
-                else {
-
-                    // ACK
-                    if (sda == 0) {
-
-                        // using the last HIGH-LOW transition for SCL as start index
-                        I2CItem item(I2CItem::I2C_ACK, -1, sclHLIdx, -1);
-                        mI2cItems.append(item);
-                    }
-
-                    // NACK
-                    else {
-
-                        // using the last HIGH-LOW transition for SCL as start index
-                        I2CItem item(I2CItem::I2C_NACK, -1, sclHLIdx, -1);
-                        mI2cItems.append(item);
-                    }
-
-
-                    // ready to read a new byte
-                    dataBitCnt = 8;
-                    data = 0;
-                }
-
-
-
-           } while (0);
-
-        }
-
-
-        //
-        // Detect Start and Stop conditions. Transition while SCL is HIGH
-        //
-        if (!errorFound && scl == 1 && sda != prevSda) {
-
-            do {
-
-                // This should not occur while reading a data byte
-                // If it does it is a bus error (See Spec 1.)
-                if (dataBitCnt > 0 && dataBitCnt < 7) {
-
-                    // reset reading data
-                    dataBitCnt = 8;
-
-                    I2CItem item(I2CItem::I2C_ERROR, -1, i, -1);
-                    mI2cItems.append(item);
-
-                    numErrors++;
-                    break;
-                }
-
-                // HIGH -> LOW = Start
-                if (prevSda > sda) {
-
-                    I2CItem item(I2CItem::I2C_START, -1, i, -1);
-                    mI2cItems.append(item);
+    if (sclData == NULL || sdaData == NULL) return mJob;
 
-                    findAddress = true;
-                    startFound = true;
-                }
+    I2CDecoder decoder;
+    decoder.setData(*sclData, *sdaData);
 
-                // LOW -> HIGH = Stop
-                else {
-
-                    if (!detectStart || (detectStart&&startFound)) {
-                        I2CItem item(I2CItem::I2C_STOP, -1, i, -1);
-                        mI2cItems.append(item);
-                    }
-
-                }
-
-                data = 0;
-                dataBitCnt = 8;
-
-            } while (0);
-        }
-
-
-        prevSda = sda;
-        prevScl = scl;
-        errorFound = false;
-
-        if (numErrors > MaxNumBusErrors) {
-            qDebug() << "Too many bus errors "<<numErrors<<" > " << MaxNumBusErrors;
-            break;
-        }
+    if (!decoder.isValid()) return mJob;
 
+    mJob = QSharedPointer<AnalyzerDecoderJob<I2CDecoder> >(
+                new AnalyzerDecoderJob<I2CDecoder>(decoder, startIdx, visibleFrom, visibleTo));
+    if (keepPrevious && !previous.isNull()) {
+        mJob->keepPrevious(previous.data());
     }
 
+    return mJob;
 }
 
 /*!
@@ -534,123 +267,6 @@ UiI2CAnalyzer* UiI2CAnalyzer::fromSettingsString(const QString &s)
     return analyzer;
 }
 
-/*!
-    Paint event handler responsible for painting this widget.
-*/
-void UiI2CAnalyzer::paintEvent(QPaintEvent *event)
-{
-    (void)event;
-    QPainter painter(this);
-
-    int textMargin = 3;
-
-    // -----------------
-    // draw background
-    // -----------------
-    paintBackground(&painter);
-
-
-    painter.setClipRect(plotX(), 0, width()-infoWidth(), height());
-    painter.translate(0, height()/2);
-
-    CaptureDevice* device = DeviceManager::instance().activeDevice()
-            ->captureDevice();
-    int sampleRate = device->usedSampleRate();
-
-
-    double from = 0;
-    double to = 0;
-    int fromIdx = 0;
-    int toIdx = 0;
-
-    int h = height()/4;
-
-    QString shortTxt;
-    QString longTxt;
-
-    QPen pen = painter.pen();
-    pen.setColor(Configuration::instance().analyzerColor());
-    painter.setPen(pen);
-
-    for (int i = 0; i < mI2cItems.size(); i++) {
-        I2CItem item = mI2cItems.at(i);
-
-        fromIdx = item.startIdx;
-        toIdx = item.stopIdx;
-
-
-        typeAndValueAsString(item.type, item.value, shortTxt, longTxt);
-
-        int shortTextWidth = painter.fontMetrics().width(shortTxt);
-        int longTextWidth = painter.fontMetrics().width(longTxt);
-
-
-        from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
-
-        // no need to draw when signal is out of plot area
-        if (from > width()) break;
-
-        if (toIdx != -1) {
-            to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
-        }
-        else  {
-
-            // see if the long text version fits
-            to = from + longTextWidth+textMargin*2;
-
-            if (i+1 < mI2cItems.size()) {
-
-                // get position for the start of the next item
-                double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mI2cItems.at(i+1).startIdx/sampleRate);
-
-
-                // if 'to' overlaps check if short text fits
-                if (to > tmp) {
-
-                    to = from + shortTextWidth+textMargin*2;
-
-                    // 'to' overlaps next item -> limit to start of next item
-                    if (to > tmp) {
-                        to = tmp;
-                    }
-
-                }
-
-
-            }
-        }
-
-
-        if (to-from > 4) {
-            painter.drawLine(from, 0, from+2, -h);
-            painter.drawLine(from, 0, from+2, h);
-
-            painter.drawLine(from+2, -h, to-2, -h);
-            painter.drawLine(from+2, h, to-2, h);
-
-            painter.drawLine(to, 0, to-2, -h);
-            painter.drawLine(to, 0, to-2, h);
-        }
-
-        // drawing a vertical line when the allowed width is too small
-        else {
-            painter.drawLine(from, -h, from, h);
-        }
-
-        // only draw the text if it fits between 'from' and 'to'
-        QRectF textRect(from+1, -h, (to-from), 2*h);
-        if (longTextWidth < (to-from)) {
-            painter.drawText(textRect, Qt::AlignCenter, longTxt);
-        }
-        else if (shortTextWidth < (to-from)) {
-            painter.drawText(textRect, Qt::AlignCenter, shortTxt);
-        }
-
-    }
-
-}
-
 /*!
     Event handler called when this widget is being shown
 */
@@ -662,57 +278,56 @@ void UiI2CAnalyzer::showEvent(QShowEvent* event)
 }
 
 /*!
-    Convert I2C \a type and data \a value to string representation. A short
-    and long representation is returned in \a shortTxt and \a longTxt.
+    Sets \a shortTxt and \a longTxt to the short and long text for
+    annotation \a i in \a annotations.
 */
-void UiI2CAnalyzer::typeAndValueAsString(I2CItem::I2CType type,
-                                         int value,
-                                         QString &shortTxt,
-                                         QString &longTxt)
+void UiI2CAnalyzer::annotationText(const AnalyzerAnnotations &annotations, int i,
+                                   QString &shortTxt, QString &longTxt)
 {
+    int value = annotations.value(i);
     QLatin1Char fillChar('0');
 
-    switch(type) {
-    case I2CItem::I2C_START:
+    switch(annotations.type(i)) {
+    case I2CDecoder::I2C_START:
         shortTxt = "S";
         longTxt = "Start";
         break;
-    case I2CItem::I2C_STOP:
+    case I2CDecoder::I2C_STOP:
         shortTxt = "P";
         longTxt = "Stop";
         break;
-    case I2CItem::I2C_ACK:
+    case I2CDecoder::I2C_ACK:
         shortTxt = "A";
         longTxt = "Ack";
         break;
-    case I2CItem::I2C_NACK:
+    case I2CDecoder::I2C_NACK:
         shortTxt = "N";
         longTxt = "Nack";
         break;
-    case I2CItem::I2C_DATA:
+    case I2CDecoder::I2C_DATA:
         shortTxt = formatValue(mFormat, value);
         longTxt = "Data = " + formatValue(mFormat, value);
         break;
-    case I2CItem::I2C_7_ADDRESS_WRITE:
+    case I2CDecoder::I2C_7_ADDRESS_WRITE:
         shortTxt = QString("W:0x%1").arg(value, 2, 16, fillChar);
         longTxt = QString("Write to 0x%1").arg(value, 2, 16, fillChar);
 
         break;
-    case I2CItem::I2C_7_ADDRESS_READ:
+    case I2CDecoder::I2C_7_ADDRESS_READ:
         shortTxt = QString("R:0x%1").arg(value, 2, 16, fillChar);
         longTxt = QString("Read from 0x%1").arg(value, 2, 16, fillChar);
         break;
-    case I2CItem::I2C_10_ADDRESS_WRITE:
+    case I2CDecoder::I2C_10_ADDRESS_WRITE:
         shortTxt = QString("W:0x%1").arg(value, 2, 16, fillChar);
         longTxt = QString("Write to 0x%1").arg(value, 2, 16, fillChar);
 
         break;
-    case I2CItem::I2C_10_ADDRESS_READ:
+    case I2CDecoder::I2C_10_ADDRESS_READ:
         shortTxt = QString("R:0x%1").arg(value, 2, 16, fillChar);
         longTxt = QString("Read from 0x%1").arg(value, 2, 16, fillChar);
 
         break;
-    case I2CItem::I2C_ERROR:
+    case I2CDecoder::I2C_ERROR:
         shortTxt = "Err";
         longTxt = "Bus Error";
         break;
@@ -765,7 +380,12 @@ int UiI2CAnalyzer::calcMinimumWidth()
     return w+infoContentMargin().right();
 }
 
-
-
-
-
+/*!
+    Returns true if annotation \a i in \a annotations has the \a value
+    searched for by the find actions. Only the data bytes are compared,
+    not the addresses.
+*/
+bool UiI2CAnalyzer::findMatches(const AnalyzerAnnotations &annotations, int i, int value) const
+{
+    return annotations.type(i) == I2CDecoder::I2C_DATA && annotations.value(i) == value;
+}
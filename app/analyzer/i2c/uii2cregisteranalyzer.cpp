@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uii2cregisteranalyzer.h"
+
+#include "uii2canalyzer.h"
+
+/*!
+    Counter used when creating the editable name.
+*/
+int UiI2CRegisterAnalyzer::i2cRegisterAnalyzerCounter = 0;
+
+/*!
+    Name of this analyzer.
+*/
+const QString UiI2CRegisterAnalyzer::signalName = "I2C Register Analyzer";
+
+/*!
+    \class UiI2CRegisterAnalyzer
+    \brief This class shows the register accesses of an I2C device.
+
+    \ingroup Analyzer
+
+    The class decodes the output of an I2C analyzer with an
+    I2CRegisterDecoder and shows which registers of e.g. an EEPROM or a
+    sensor are written and read.
+*/
+
+
+/*!
+    Constructs the UiI2CRegisterAnalyzer with the given \a parent.
+*/
+UiI2CRegisterAnalyzer::UiI2CRegisterAnalyzer(QWidget *parent) :
+    UiStackedAnalyzer(parent)
+{
+    mIdLbl->setText("REG");
+    mNameLbl->setText(QString("I2C Registers %1").arg(i2cRegisterAnalyzerCounter++));
+}
+
+/*!
+    Create an I2C register analyzer from the string representation \a s.
+
+    \sa toSettingsString
+*/
+UiI2CRegisterAnalyzer* UiI2CRegisterAnalyzer::fromSettingsString(const QString &s)
+{
+    QStringList list = s.split(';');
+    if (list.size() < 1 || list.at(0) != UiI2CRegisterAnalyzer::signalName) return NULL;
+
+    // Deallocation: Caller of this function is responsible for deallocation
+    UiI2CRegisterAnalyzer* analyzer = new UiI2CRegisterAnalyzer();
+    if (!analyzer->setSettings(list)) {
+        delete analyzer;
+        analyzer = NULL;
+    }
+
+    return analyzer;
+}
+
+/*!
+    Returns the register decoder with the current settings.
+*/
+AnalyzerLayer* UiI2CRegisterAnalyzer::layer()
+{
+    mDecoder.setAddressBytes(addressBytes());
+    return &mDecoder;
+}
+
+/*!
+    Returns true if \a analyzer is an I2C analyzer.
+*/
+bool UiI2CRegisterAnalyzer::acceptsSource(UiAnalyzer* analyzer) const
+{
+    return qobject_cast<UiI2CAnalyzer*>(analyzer) != NULL;
+}
+
+/*!
+    Returns the supported register address lengths: one or two bytes.
+*/
+QList<int> UiI2CRegisterAnalyzer::supportedAddressBytes() const
+{
+    return QList<int>() << 1 << 2;
+}
+
+/*!
+    Sets \a shortTxt and \a longTxt to the short and long text for
+    annotation \a i in \a annotations.
+*/
+void UiI2CRegisterAnalyzer::annotationText(const AnalyzerAnnotations &annotations, int i,
+                                           QString &shortTxt, QString &longTxt)
+{
+    int value = annotations.value(i);
+    QLatin1Char fillChar('0');
+    QString reg = QString("0x%1").arg(value >> 8, 2*addressBytes(), 16, fillChar);
+    QString data = formatValue(dataFormat(), value & 0xff);
+
+    switch(annotations.type(i)) {
+    case I2CRegisterDecoder::TYPE_REGISTER:
+        reg = QString("0x%1").arg(value, 2*addressBytes(), 16, fillChar);
+        shortTxt = "R:" + reg;
+        longTxt = "Register " + reg;
+        break;
+    case I2CRegisterDecoder::TYPE_WRITE:
+        shortTxt = data;
+        longTxt = QString("Write %1: %2").arg(reg).arg(data);
+        break;
+    case I2CRegisterDecoder::TYPE_READ:
+        shortTxt = data;
+        longTxt = QString("Read %1: %2").arg(reg).arg(data);
+        break;
+    case I2CRegisterDecoder::TYPE_READ_CURRENT:
+        shortTxt = data;
+        longTxt = "Read: " + data;
+        break;
+    }
+
+}
+
+/*!
+    Returns true if annotation \a i in \a annotations has the \a value
+    searched for by the find actions. A register access is compared with
+    its register address, a read or write with its data byte.
+*/
+bool UiI2CRegisterAnalyzer::findMatches(const AnalyzerAnnotations &annotations, int i, int value) const
+{
+    switch(annotations.type(i)) {
+    case I2CRegisterDecoder::TYPE_WRITE:
+    case I2CRegisterDecoder::TYPE_READ:
+        return (annotations.value(i) & 0xff) == value;
+    default:
+        return annotations.value(i) == value;
+    }
+}
@@ -0,0 +1,246 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "spidecoder.h"
+
+/*!
+    \class SpiDecoder
+    \brief Decodes SPI data from four digital signals.
+
+    \ingroup Analyzer
+
+    The SpiDecoder class holds the settings and copies of the signal data
+    and knows nothing about the UI, so it can decode on another thread. See
+    UartDecoder.
+*/
+
+/*!
+    Constructs a decoder with the default settings and no data.
+*/
+SpiDecoder::SpiDecoder()
+{
+    mDataBits = 8;
+    mMode = Types::SpiMode_0;
+    mEnableMode = Types::SpiEnableLow;
+}
+
+/*!
+    Sets the signal data to decode: \a sck, \a mosi, \a miso and \a enable.
+*/
+void SpiDecoder::setData(const QVector<int> &sck, const QVector<int> &mosi,
+                         const QVector<int> &miso, const QVector<int> &enable)
+{
+    mSckData = sck;
+    mMosiData = mosi;
+    mMisoData = miso;
+    mEnableData = enable;
+}
+
+/*!
+    Returns true if there is data to decode.
+*/
+bool SpiDecoder::isValid() const
+{
+    if (mSckData.size() == 0 || mMosiData.size() == 0
+            || mMisoData.size() == 0 || mEnableData.size() == 0) return false;
+
+    return true;
+}
+
+/*!
+    Returns the decoder state for a new decoding starting at the sample
+    with index \a startIdx.
+*/
+SpiDecoder::State SpiDecoder::initialState(int startIdx) const
+{
+    State s;
+    s.pos = startIdx;
+    s.prevCs = mEnableData.at(startIdx);
+    s.prevSck = mSckData.at(startIdx);
+    s.sckChangeNum = 0;
+    s.findCsOn = true;
+    s.mosiValue = 0;
+    s.misoValue = 0;
+    s.dataBitCnt = mDataBits;
+    s.startIdx = -1;
+
+    return s;
+}
+
+/*!
+    Finds the first sample in the range \a fromIdx to \a toIdx where the
+    enable signal is off and SCK is stable. A decoding started at
+    \a startIdx is then waiting for enable, and the state it would have at
+    that sample is stored in \a s. Returns false if there is no such sample
+    in the range.
+*/
+bool SpiDecoder::resyncState(int startIdx, int fromIdx, int toIdx, State* s) const
+{
+    int csOff = (mEnableMode == Types::SpiEnableLow) ? 1 : 0;
+
+    toIdx = qMin(toIdx, mEnableData.size());
+    for (int i = qMax(fromIdx, startIdx + 1); i < toIdx; i++) {
+        if (mEnableData.at(i) != csOff || mEnableData.at(i-1) != csOff
+                || mSckData.at(i) != mSckData.at(i-1)) {
+            continue;
+        }
+
+        *s = initialState(i);
+
+        // SCK changes are counted from the start of the decoding
+        if (mSckData.at(i) != mSckData.at(startIdx)) {
+            s->sckChangeNum = 1;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+    Decodes the signal data from the decoder state \a s until the sample with
+    index \a endIdx has been reached. Found items are added to \a items,
+    one in row 0 for MOSI and one in row 1 for MISO. The end of each
+    transfer, when enable is turned off, is marked with a TYPE_END item in
+    EndRow. It isn't shown by UiSpiAnalyzer but tells analyzers decoding
+    the SPI data (e.g. UiSpiFlashAnalyzer) where a command ends.
+    Returns true if the end of the signal data has been reached or if the
+    decoding had to stop because of a frame error.
+*/
+bool SpiDecoder::decodeSamples(State &s, AnalyzerAnnotations &items, int endIdx) const
+{
+    const QVector<int>* sckData = &mSckData;
+    const QVector<int>* mosiData = &mMosiData;
+    const QVector<int>* misoData = &mMisoData;
+    const QVector<int>* enableData = &mEnableData;
+
+    bool done = false;
+
+    int currCs = 0;
+    bool csChanged = false;
+    bool csOff = false;
+
+    int currSck = 0;
+    bool sckChanged = false;
+
+    int mosi = 0;
+    int miso = 0;
+
+    // CPHA = 0 -> capture data on first clock transition (otherwise second)
+    bool captureOnFirst = (mMode == Types::SpiMode_0
+                           || mMode == Types::SpiMode_2);
+
+
+
+    while (s.pos < endIdx) {
+
+        // reached end of data
+        if (s.pos >= sckData->size()) return true;
+
+        currCs  = enableData->at(s.pos);
+        csChanged = (s.prevCs != currCs);
+
+        currSck = sckData->at(s.pos);
+        sckChanged = (s.prevSck != currSck);
+        if (sckChanged) {
+            s.sckChangeNum = (s.sckChangeNum + 1) % 2;
+        }
+
+        mosi = mosiData->at(s.pos);
+        miso = misoData->at(s.pos);
+
+
+        do {
+
+            /*
+             * Look for Enable on
+             */
+
+            if (s.findCsOn) {
+
+                if (csChanged &&
+                        ( ((currCs == 0 && mEnableMode == Types::SpiEnableLow) ||
+                          (currCs == 1 && mEnableMode == Types::SpiEnableHigh))))
+                {
+                    s.findCsOn = false;
+                }
+
+                else {
+                    // we've not found enable yet -> get next sample
+                    break;
+                }
+            }
+
+            /*
+             * Check if Enable is set to off
+             */
+
+            csOff = (csChanged && ((currCs == 1 && mEnableMode == Types::SpiEnableLow)
+                                   || (currCs == 0 && mEnableMode == Types::SpiEnableHigh)));
+
+            if (csOff) {
+                s.findCsOn = true;
+
+
+                // enable signal has been set to off, but we haven't received a complete value
+                if (s.dataBitCnt > 0 && s.dataBitCnt < 8) {
+                    done = true;
+
+                    items.append(s.startIdx, -1, TYPE_FRAME_ERROR, 0, 0);
+                    items.append(s.startIdx, -1, TYPE_FRAME_ERROR, 0, 1);
+                }
+
+                items.append(s.pos, -1, TYPE_END, 0, EndRow);
+
+
+            }
+
+            // capture data when SCK changes
+            if (sckChanged && ((captureOnFirst && s.sckChangeNum != 0)
+                    || (!captureOnFirst && s.sckChangeNum == 0))) {
+
+                if (s.startIdx == -1) {
+                    s.startIdx = s.pos;
+                }
+
+                s.mosiValue |= (mosi << (--s.dataBitCnt));
+                s.misoValue |= (miso << (s.dataBitCnt));
+
+
+
+                // captured a complete value
+                if (s.dataBitCnt == 0) {
+                    items.append(s.startIdx, s.pos, TYPE_DATA, s.mosiValue, 0);
+                    items.append(s.startIdx, s.pos, TYPE_DATA, s.misoValue, 1);
+
+                    s.startIdx = -1;
+                    s.mosiValue = 0;
+                    s.misoValue = 0;
+                    s.dataBitCnt = mDataBits;
+                }
+            }
+
+        } while (false);
+
+        s.pos++;
+        s.prevCs = currCs;
+        s.prevSck = currSck;
+
+        if (done) return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SPIDECODER_H
+#define SPIDECODER_H
+
+#include <QVector>
+
+#include "analyzer/analyzerannotations.h"
+
+#include "common/types.h"
+
+class SpiDecoder
+{
+public:
+
+    /*!
+        SPI item type
+    */
+    enum ItemType {
+        TYPE_DATA,
+        TYPE_FRAME_ERROR,
+        TYPE_END
+    };
+
+    /*!
+        Row of the TYPE_END items
+    */
+    enum {
+        EndRow = 2
+    };
+
+    /*!
+        Everything the decoder carries from one sample to the next. See
+        AnalyzerDecoder. Only the parity of the number of SCK changes
+        matters so sckChangeNum is kept as 0 or 1.
+    */
+    struct State {
+        int pos;
+        int prevCs;
+        int prevSck;
+        int sckChangeNum;
+        bool findCsOn;
+        int mosiValue;
+        int misoValue;
+        int dataBitCnt;
+        int startIdx;
+
+        bool operator==(const State &other) const {
+            return pos == other.pos && prevCs == other.prevCs
+                    && prevSck == other.prevSck
+                    && sckChangeNum == other.sckChangeNum
+                    && findCsOn == other.findCsOn
+                    && mosiValue == other.mosiValue
+                    && misoValue == other.misoValue
+                    && dataBitCnt == other.dataBitCnt
+                    && startIdx == other.startIdx;
+        }
+    };
+
+    SpiDecoder();
+
+    void setData(const QVector<int> &sck, const QVector<int> &mosi,
+                 const QVector<int> &miso, const QVector<int> &enable);
+    void setDataBits(int bits) {mDataBits = bits;}
+    void setMode(Types::SpiMode mode) {mMode = mode;}
+    void setEnableMode(Types::SpiEnable mode) {mEnableMode = mode;}
+
+    bool isValid() const;
+    int numSamples() const {return mSckData.size();}
+    State initialState(int startIdx) const;
+    bool resyncState(int startIdx, int fromIdx, int toIdx, State* s) const;
+    bool decodeSamples(State &s, AnalyzerAnnotations &items, int endIdx) const;
+
+private:
+    QVector<int> mSckData;
+    QVector<int> mMosiData;
+    QVector<int> mMisoData;
+    QVector<int> mEnableData;
+    int mDataBits;
+    Types::SpiMode mMode;
+    Types::SpiEnable mEnableMode;
+};
+
+#endif // SPIDECODER_H
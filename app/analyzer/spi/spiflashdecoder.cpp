@@ -0,0 +1,197 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "spiflashdecoder.h"
+
+#include <QVector>
+
+#include "spidecoder.h"
+
+/*!
+    \class SpiFlashDecoder
+    \brief Decodes serial flash commands from the items of a SpiDecoder.
+
+    \ingroup Analyzer
+
+    A serial (NOR) flash gets one command per transfer, i.e. while the
+    chip select is on. The first byte on MOSI is the opcode, followed by
+    an address (three or four bytes, see \ref setAddressBytes), dummy bytes
+    and data, depending on the command. Only the commands common to most
+    flash devices are known, see \ref commandName. For other opcodes only
+    the command is shown.
+
+    A message is the items between two SpiDecoder::TYPE_END items. For
+    each transfer a TYPE_COMMAND item with the opcode is added, a
+    TYPE_ADDRESS item with the address (if any) and one TYPE_WRITE (MOSI)
+    or TYPE_READ (MISO) item per data byte. The SPI analyzer must use 8
+    data bits.
+*/
+
+/*!
+    The known commands.
+*/
+const SpiFlashDecoder::Command SpiFlashDecoder::commands[] = {
+    {0x01, "WRSR",  "Write Status",           false, 0, DataWrite},
+    {0x02, "PP",    "Page Program",           true,  0, DataWrite},
+    {0x03, "READ",  "Read Data",              true,  0, DataRead},
+    {0x04, "WRDI",  "Write Disable",          false, 0, DataNone},
+    {0x05, "RDSR",  "Read Status",            false, 0, DataRead},
+    {0x06, "WREN",  "Write Enable",           false, 0, DataNone},
+    {0x0B, "FREAD", "Fast Read",              true,  1, DataRead},
+    {0x20, "SE",    "Sector Erase",           true,  0, DataNone},
+    {0x35, "RDSR2", "Read Status 2",          false, 0, DataRead},
+    {0x4B, "RUID",  "Read Unique ID",         false, 4, DataRead},
+    {0x52, "BE32",  "Block Erase 32KB",       true,  0, DataNone},
+    {0x5A, "SFDP",  "Read SFDP",              true,  1, DataRead},
+    {0x60, "CE",    "Chip Erase",             false, 0, DataNone},
+    {0x90, "REMS",  "Read Manufacturer ID",   true,  0, DataRead},
+    {0x9F, "RDID",  "Read JEDEC ID",          false, 0, DataRead},
+    {0xAB, "RES",   "Release Power-down",     false, 3, DataRead},
+    {0xB9, "DP",    "Power-down",             false, 0, DataNone},
+    {0xC7, "CE",    "Chip Erase",             false, 0, DataNone},
+    {0xD8, "BE",    "Block Erase",            true,  0, DataNone}
+};
+
+/*!
+    Number of known commands.
+*/
+const int SpiFlashDecoder::numCommands = sizeof(commands)/sizeof(commands[0]);
+
+/*!
+    Constructs a decoder for three byte addresses.
+*/
+SpiFlashDecoder::SpiFlashDecoder()
+{
+    mAddressBytes = 3;
+}
+
+/*!
+    \fn void SpiFlashDecoder::setAddressBytes(int bytes)
+
+    Set the number of \a bytes in an address.
+*/
+
+/*!
+    Returns the index of the first item of the transfer that \a item in
+    the SPI items \a input belongs to.
+*/
+int SpiFlashDecoder::messageStart(const AnalyzerAnnotations &input, int item) const
+{
+    for (int i = item; i > 0; i--) {
+        if (input.type(i-1) == SpiDecoder::TYPE_END) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+/*!
+    Decodes the transfer starting at \a item in the SPI items \a input and
+    adds the command to \a output. Returns the index of the item after the
+    transfer.
+*/
+int SpiFlashDecoder::decodeMessage(const AnalyzerAnnotations &input, int item,
+                                   AnalyzerAnnotations &output) const
+{
+    QVector<int> mosi;
+    QVector<int> miso;
+
+    int i = item;
+    for (; i < input.size(); i++) {
+        int type = input.type(i);
+        if (type == SpiDecoder::TYPE_END) {
+            i++;
+            break;
+        }
+        if (type != SpiDecoder::TYPE_DATA) continue;
+
+        if (input.row(i) == 0) {
+            mosi.append(i);
+        }
+        else {
+            miso.append(i);
+        }
+    }
+
+    if (mosi.isEmpty()) return i;
+
+    int opcode = input.value(mosi.at(0));
+    output.append(input.startIdx(mosi.at(0)), input.stopIdx(mosi.at(0)),
+                  TYPE_COMMAND, opcode);
+
+    const Command* cmd = findCommand(opcode);
+    if (cmd == NULL) return i;
+
+    int pos = 1;
+    if (cmd->address) {
+        if (mosi.size() < 1 + mAddressBytes) return i;
+
+        int address = 0;
+        for (int j = 1; j <= mAddressBytes; j++) {
+            address = (address << 8) | input.value(mosi.at(j));
+        }
+        output.append(input.startIdx(mosi.at(1)), input.stopIdx(mosi.at(mAddressBytes)),
+                      TYPE_ADDRESS, address);
+
+        pos += mAddressBytes;
+    }
+    pos += cmd->dummyBytes;
+
+    if (cmd->data == DataWrite) {
+        for (int j = pos; j < mosi.size(); j++) {
+            output.append(input.startIdx(mosi.at(j)), input.stopIdx(mosi.at(j)),
+                          TYPE_WRITE, input.value(mosi.at(j)));
+        }
+    }
+    else if (cmd->data == DataRead) {
+        for (int j = pos; j < miso.size(); j++) {
+            output.append(input.startIdx(miso.at(j)), input.stopIdx(miso.at(j)),
+                          TYPE_READ, input.value(miso.at(j)));
+        }
+    }
+
+    return i;
+}
+
+/*!
+    Returns the name of the command with the given \a opcode, the long
+    name if \a longName is true. Unknown opcodes are returned as hex.
+*/
+QString SpiFlashDecoder::commandName(int opcode, bool longName)
+{
+    const Command* cmd = findCommand(opcode);
+    if (cmd == NULL) {
+        QString hex = QString("0x%1").arg(opcode, 2, 16, QLatin1Char('0'));
+        return longName ? "Command " + hex : hex;
+    }
+
+    return longName ? cmd->longName : cmd->shortName;
+}
+
+/*!
+    Returns the known command with the given \a opcode or NULL if there is
+    none.
+*/
+const SpiFlashDecoder::Command* SpiFlashDecoder::findCommand(int opcode)
+{
+    for (int i = 0; i < numCommands; i++) {
+        if (commands[i].opcode == opcode) {
+            return &commands[i];
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SPIFLASHDECODER_H
+#define SPIFLASHDECODER_H
+
+#include <QString>
+
+#include "analyzer/analyzerlayer.h"
+
+class SpiFlashDecoder : public AnalyzerLayer
+{
+public:
+
+    /*!
+        Flash command item type
+    */
+    enum ItemType {
+        TYPE_COMMAND,
+        TYPE_ADDRESS,
+        TYPE_WRITE,
+        TYPE_READ
+    };
+
+    SpiFlashDecoder();
+
+    void setAddressBytes(int bytes) {mAddressBytes = bytes;}
+
+    int messageStart(const AnalyzerAnnotations &input, int item) const;
+    int decodeMessage(const AnalyzerAnnotations &input, int item,
+                      AnalyzerAnnotations &output) const;
+
+    static QString commandName(int opcode, bool longName);
+
+private:
+
+    enum DataDirection {
+        DataNone,
+        DataWrite,
+        DataRead
+    };
+
+    struct Command {
+        int opcode;
+        const char* shortName;
+        const char* longName;
+        bool address;
+        int dummyBytes;
+        DataDirection data;
+    };
+
+    static const Command commands[];
+    static const int numCommands;
+
+    int mAddressBytes;
+
+    static const Command* findCommand(int opcode);
+};
+
+#endif // SPIFLASHDECODER_H
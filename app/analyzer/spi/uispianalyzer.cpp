@@ -15,11 +15,8 @@
  */
 #include "uispianalyzer.h"
 
-#include <QPainter>
 
 #include "uispianalyzerconfig.h"
-#include "common/configuration.h"
-#include "capture/cursormanager.h"
 #include "device/devicemanager.h"
 
 /*!
@@ -226,14 +223,17 @@ void UiSpiAnalyzer::setEnableSignal(int id)
 
 
 /*!
-    Start to analyze the signal data.
+    Creates a job decoding the signal data with the current settings. See
+    UiAnalyzer::createJob() for \a startIdx, \a visibleFrom, \a visibleTo
+    and \a keepPrevious.
 */
-void UiSpiAnalyzer::analyze()
+QSharedPointer<AnalyzerJob> UiSpiAnalyzer::createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious)
 {
-    mSpiItems.clear();
+    QSharedPointer<AnalyzerDecoderJob<SpiDecoder> > previous = mJob;
+    mJob.clear();
 
     if (mSckSignalId == -1 || mMosiSignalId == -1
-            ||  mMisoSignalId == -1 ||  mEnableSignalId == -1) return;
+            ||  mMisoSignalId == -1 ||  mEnableSignalId == -1) return mJob;
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
@@ -244,154 +244,23 @@ void UiSpiAnalyzer::analyze()
     QVector<int>* enableData = device->digitalData(mEnableSignalId);
 
     if (sckData == NULL || mosiData == NULL
-            || misoData == NULL || enableData == NULL) return;
-    if (sckData->size() == 0 || mosiData->size() == 0
-            || misoData->size() == 0 || misoData->size() == 0) return;
+            || misoData == NULL || enableData == NULL) return mJob;
 
+    SpiDecoder decoder;
+    decoder.setData(*sckData, *mosiData, *misoData, *enableData);
+    decoder.setDataBits(mDataBits);
+    decoder.setMode(mMode);
+    decoder.setEnableMode(mEnableMode);
 
-    bool done = false;
-    bool findCsOn = true;
-    int pos = 0;
-
-    if (mSyncCursor != UiCursor::NoCursor) {
-        double t = CursorManager::instance().cursorPosition(mSyncCursor);
-        if (t > 0 && CursorManager::instance().isCursorOn(mSyncCursor)) {
-            pos = device->usedSampleRate()*t;
-        }
-
-        if (pos >= sckData->size()) {
-            pos = 0;
-        }
+    if (!decoder.isValid()) return mJob;
 
+    mJob = QSharedPointer<AnalyzerDecoderJob<SpiDecoder> >(
+                new AnalyzerDecoderJob<SpiDecoder>(decoder, startIdx, visibleFrom, visibleTo));
+    if (keepPrevious && !previous.isNull()) {
+        mJob->keepPrevious(previous.data());
     }
 
-
-    int prevCs = enableData->at(pos);
-    int currCs = 0;
-    bool csChanged = false;
-    bool csOff = false;
-
-
-    int prevSck = sckData->at(pos);
-    int currSck = 0;
-    bool sckChanged = false;
-    int sckChangeNum = 0;
-
-    int mosi = 0;
-    int miso = 0;
-    int mosiValue = 0;
-    int misoValue = 0;
-    int dataBitCnt = mDataBits;
-
-    int startIdx = -1;
-
-    // CPHA = 0 -> capture data on first clock transition (otherwise second)
-    bool captureOnFirst = (mMode == Types::SpiMode_0
-                           || mMode == Types::SpiMode_2);
-
-
-
-    while (!done) {
-
-        // reached end of data
-        if (pos >= sckData->size()) break;
-
-        currCs  = enableData->at(pos);
-        csChanged = (prevCs != currCs);
-
-        currSck = sckData->at(pos);
-        sckChanged = (prevSck != currSck);
-        if (sckChanged) {
-            sckChangeNum++;
-        }
-
-        mosi = mosiData->at(pos);
-        miso = misoData->at(pos);
-
-
-        do {
-
-            /*
-             * Look for Enable on
-             */
-
-            if (findCsOn) {
-
-                if (csChanged &&
-                        ( ((currCs == 0 && mEnableMode == Types::SpiEnableLow) ||
-                          (currCs == 1 && mEnableMode == Types::SpiEnableHigh))))
-                {
-                    findCsOn = false;
-                }
-
-                else {
-                    // we've not found enable yet -> get next sample
-                    break;
-                }
-            }
-
-            /*
-             * Check if Enable is set to off
-             */
-
-            csOff = (csChanged && ((currCs == 1 && mEnableMode == Types::SpiEnableLow)
-                                   || (currCs == 0 && mEnableMode == Types::SpiEnableHigh)));
-
-            if (csOff) {
-                findCsOn = true;
-
-
-                // enable signal has been set to off, but we haven't received a complete value
-                if (dataBitCnt > 0 && dataBitCnt < 8) {
-                    done = true;
-
-                    SpiItem item(SpiItem::TYPE_FRAME_ERROR, 0, 0, startIdx, -1);
-                    mSpiItems.append(item);
-                }
-
-
-            }
-
-            // capture data when SCK changes
-            if (sckChanged && ((captureOnFirst && (sckChangeNum % 2) != 0)
-                    || (!captureOnFirst && (sckChangeNum % 2) == 0))) {
-
-                if (startIdx == -1) {
-                    startIdx = pos;
-                }
-
-                mosiValue |= (mosi << (--dataBitCnt));
-                misoValue |= (miso << (dataBitCnt));
-
-
-
-                // captured a complete value
-                if (dataBitCnt == 0) {
-                    SpiItem item(SpiItem::TYPE_DATA, mosiValue, misoValue,
-                                 startIdx, pos);
-                    mSpiItems.append(item);
-
-                    startIdx = -1;
-                    mosiValue = 0;
-                    misoValue = 0;
-                    dataBitCnt = mDataBits;
-                }
-
-
-
-                //sckChangeNum = 0;
-            }
-
-
-
-
-        } while (false);
-
-        pos++;
-        prevCs = currCs;
-        prevSck = currSck;
-    }
-
+    return mJob;
 }
 
 /*!
@@ -537,122 +406,6 @@ UiSpiAnalyzer* UiSpiAnalyzer::fromSettingsString(const QString &s)
     return analyzer;
 }
 
-/*!
-    Paint event handler responsible for painting this widget.
-*/
-void UiSpiAnalyzer::paintEvent(QPaintEvent *event)
-{
-    (void)event;
-    QPainter painter(this);
-
-    int textMargin = 3;
-
-    // -----------------
-    // draw background
-    // -----------------
-    paintBackground(&painter);
-
-    painter.setClipRect(plotX(), 0, width()-infoWidth(), height());
-
-    CaptureDevice* device = DeviceManager::instance().activeDevice()
-            ->captureDevice();
-    int sampleRate = device->usedSampleRate();
-
-
-    double from = 0;
-    double to = 0;
-    int fromIdx = 0;
-    int toIdx = 0;
-
-    int h = height() / 6;
-
-    QString mosiShortTxt;
-    QString mosiLongTxt;
-    QString misoShortTxt;
-    QString misoLongTxt;
-
-    if (mSelected) {
-        QPen pen = painter.pen();
-        pen.setColor(Qt::gray);
-        painter.setPen(pen);
-        QRectF mosiRect(plotX()+4, height()/4-h, 100, 2*h);
-        painter.drawText(mosiRect, Qt::AlignLeft|Qt::AlignVCenter, "MOSI");
-        QRectF misoRect(plotX()+4, 3*height()/4-h, 100, 2*h);
-        painter.drawText(misoRect, Qt::AlignLeft|Qt::AlignVCenter, "MISO");
-    }
-
-
-    QPen pen = painter.pen();
-    pen.setColor(Configuration::instance().analyzerColor());
-    painter.setPen(pen);
-
-    for (int i = 0; i < mSpiItems.size(); i++) {
-        SpiItem item = mSpiItems.at(i);
-
-        fromIdx = item.startIdx;
-        toIdx = item.stopIdx;
-
-
-        typeAndValueAsString(item.type, item.mosiValue, mosiShortTxt,
-                             mosiLongTxt);
-        typeAndValueAsString(item.type, item.misoValue, misoShortTxt,
-                             misoLongTxt);
-
-        int shortTextWidth = painter.fontMetrics().width(mosiShortTxt);
-        int longTextWidth = painter.fontMetrics().width(mosiLongTxt);
-
-
-        from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
-
-        // no need to draw when signal is out of plot area
-        if (from > width()) break;
-
-        if (toIdx != -1) {
-            to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
-        }
-        else  {
-
-            // see if the long text version fits
-            to = from + longTextWidth+textMargin*2;
-
-            if (i+1 < mSpiItems.size()) {
-
-                // get position for the start of the next item
-                double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mSpiItems.at(i+1).startIdx/sampleRate);
-
-
-                // if 'to' overlaps check if short text fits
-                if (to > tmp) {
-
-                    to = from + shortTextWidth+textMargin*2;
-
-                    // 'to' overlaps next item -> limit to start of next item
-                    if (to > tmp) {
-                        to = tmp;
-                    }
-
-                }
-
-
-            }
-        }
-
-
-        painter.save();
-        painter.translate(0, height()/4);
-        paintSignal(&painter, from, to, h, mosiShortTxt, mosiLongTxt);
-        painter.restore();
-
-        painter.save();
-        painter.translate(0, 3*height()/4);
-        paintSignal(&painter, from, to, h, misoShortTxt, misoLongTxt);
-        painter.restore();
-
-    }
-
-}
-
 /*!
     Event handler called when this widget is being shown
 */
@@ -720,22 +473,20 @@ int UiSpiAnalyzer::calcMinimumWidth()
 }
 
 /*!
-    Convert SPI \a type and data \a value to string representation. A short
-    and long representation is returned in \a shortTxt and \a longTxt.
+    Sets \a shortTxt and \a longTxt to the short and long text for
+    annotation \a i in \a annotations.
 */
-void UiSpiAnalyzer::typeAndValueAsString(SpiItem::ItemType type,
-                                         int value,
-                                         QString &shortTxt,
-                                         QString &longTxt)
+void UiSpiAnalyzer::annotationText(const AnalyzerAnnotations &annotations, int i,
+                                   QString &shortTxt, QString &longTxt)
 {
+    int value = annotations.value(i);
 
-
-    switch(type) {
-    case SpiItem::TYPE_DATA:
+    switch(annotations.type(i)) {
+    case SpiDecoder::TYPE_DATA:
         shortTxt = formatValue(mFormat, value);
         longTxt = formatValue(mFormat, value);
         break;
-    case SpiItem::TYPE_FRAME_ERROR:
+    case SpiDecoder::TYPE_FRAME_ERROR:
         shortTxt = "FE";
         longTxt = "Frame Error";
         break;
@@ -744,38 +495,22 @@ void UiSpiAnalyzer::typeAndValueAsString(SpiItem::ItemType type,
 }
 
 /*!
-    Paint signal data.
+    Returns the name of \a row: MOSI or MISO.
 */
-void UiSpiAnalyzer::paintSignal(QPainter* painter, double from, double to,
-                                int h, QString &shortTxt, QString &longTxt)
+QString UiSpiAnalyzer::rowName(int row) const
 {
-
-    int shortTextWidth = painter->fontMetrics().width(shortTxt);
-    int longTextWidth = painter->fontMetrics().width(longTxt);
-
-    if (to-from > 4) {
-        painter->drawLine(from, 0, from+2, -h);
-        painter->drawLine(from, 0, from+2, h);
-
-        painter->drawLine(from+2, -h, to-2, -h);
-        painter->drawLine(from+2, h, to-2, h);
-
-        painter->drawLine(to, 0, to-2, -h);
-        painter->drawLine(to, 0, to-2, h);
-    }
-
-    // drawing a vertical line when the allowed width is too small
-    else {
-        painter->drawLine(from, -h, from, h);
-    }
-
-    // only draw the text if it fits between 'from' and 'to'
-    QRectF textRect(from+1, -h, (to-from), 2*h);
-    if (longTextWidth < (to-from)) {
-        painter->drawText(textRect, Qt::AlignCenter, longTxt);
-    }
-    else if (shortTextWidth < (to-from)) {
-        painter->drawText(textRect, Qt::AlignCenter, shortTxt);
+    if (row == 0) {
+        return "MOSI";
     }
+    return "MISO";
+}
 
+/*!
+    Returns true if annotation \a i in \a annotations has the \a value
+    searched for by the find actions. Only the data on MOSI and MISO is
+    compared.
+*/
+bool UiSpiAnalyzer::findMatches(const AnalyzerAnnotations &annotations, int i, int value) const
+{
+    return annotations.type(i) == SpiDecoder::TYPE_DATA && annotations.value(i) == value;
 }
@@ -19,53 +19,9 @@
 #include <QWidget>
 
 #include "analyzer/uianalyzer.h"
+#include "analyzer/analyzerjob.h"
 #include "capture/uicursor.h"
-
-/*!
-    \class SpiItem
-    \brief Container class for SPi items.
-
-    \ingroup Analyzer
-
-    \internal
-
-*/
-class SpiItem {
-public:
-
-    /*!
-        SPI item type
-    */
-    enum ItemType {
-        TYPE_DATA,
-        TYPE_FRAME_ERROR
-    };
-
-    // default constructor needed in order to add this to QVector
-    /*! Default constructor */
-    SpiItem() {
-    }
-
-    /*! Constructs a new container */
-    SpiItem(ItemType type, int mosiValue, int misoValue, int startIdx, int stopIdx) {
-        this->type = type;
-        this->mosiValue = mosiValue;
-        this->misoValue = misoValue;
-        this->startIdx = startIdx;
-        this->stopIdx = stopIdx;
-    }
-
-    /*! type */
-    ItemType type;
-    /*! mosi value */
-    int mosiValue;
-    /*! miso value */
-    int misoValue;
-    /*! item start index */
-    int startIdx;
-    /*! item stop index */
-    int stopIdx;
-};
+#include "spidecoder.h"
 
 class UiSpiAnalyzer : public UiAnalyzer
 {
@@ -106,7 +62,6 @@ public:
     void setSyncCursor(UiCursor::CursorId id) {mSyncCursor = id;}
     UiCursor::CursorId syncCursor() const {return mSyncCursor;}
 
-    void analyze();
     void configure(QWidget* parent);
 
     QString toSettingsString() const;
@@ -117,9 +72,14 @@ signals:
 public slots:
 
 protected:
-    void paintEvent(QPaintEvent *event);
     void showEvent(QShowEvent* event);
-    
+
+    QSharedPointer<AnalyzerJob> createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious);
+    void annotationText(const AnalyzerAnnotations &annotations, int i,
+                        QString &shortTxt, QString &longTxt);
+    bool findMatches(const AnalyzerAnnotations &annotations, int i, int value) const;
+    int numRows() const {return 2;}
+    QString rowName(int row) const;
 
 private:
 
@@ -145,21 +105,13 @@ private:
     QLabel* mMisoLbl;
     QLabel* mEnableLbl;
 
-    QVector<SpiItem> mSpiItems;
+    QSharedPointer<AnalyzerDecoderJob<SpiDecoder> > mJob;
 
     static int spiAnalyzerCounter;
 
     void infoWidthChanged();
     void doLayout();
     int calcMinimumWidth();
-
-    void typeAndValueAsString(SpiItem::ItemType type,
-                                 int value,
-                                 QString &shortTxt,
-                                 QString &longTxt);
-
-    void paintSignal(QPainter* painter, double from, double to,
-                     int h, QString &shortTxt, QString &longTxt);
 };
 
 #endif // UISPIANALYZER_H
@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uispiflashanalyzer.h"
+
+#include "uispianalyzer.h"
+
+/*!
+    Counter used when creating the editable name.
+*/
+int UiSpiFlashAnalyzer::spiFlashAnalyzerCounter = 0;
+
+/*!
+    Name of this analyzer.
+*/
+const QString UiSpiFlashAnalyzer::signalName = "SPI Flash Analyzer";
+
+/*!
+    \class UiSpiFlashAnalyzer
+    \brief This class shows the commands sent to a serial flash.
+
+    \ingroup Analyzer
+
+    The class decodes the output of an SPI analyzer with a SpiFlashDecoder
+    and shows the commands, addresses and data of the transfers to and
+    from a serial flash.
+*/
+
+
+/*!
+    Constructs the UiSpiFlashAnalyzer with the given \a parent.
+*/
+UiSpiFlashAnalyzer::UiSpiFlashAnalyzer(QWidget *parent) :
+    UiStackedAnalyzer(parent)
+{
+    setAddressBytes(3);
+
+    mIdLbl->setText("FLASH");
+    mNameLbl->setText(QString("SPI Flash %1").arg(spiFlashAnalyzerCounter++));
+}
+
+/*!
+    Create an SPI flash analyzer from the string representation \a s.
+
+    \sa toSettingsString
+*/
+UiSpiFlashAnalyzer* UiSpiFlashAnalyzer::fromSettingsString(const QString &s)
+{
+    QStringList list = s.split(';');
+    if (list.size() < 1 || list.at(0) != UiSpiFlashAnalyzer::signalName) return NULL;
+
+    // Deallocation: Caller of this function is responsible for deallocation
+    UiSpiFlashAnalyzer* analyzer = new UiSpiFlashAnalyzer();
+    if (!analyzer->setSettings(list)) {
+        delete analyzer;
+        analyzer = NULL;
+    }
+
+    return analyzer;
+}
+
+/*!
+    Returns the flash command decoder with the current settings.
+*/
+AnalyzerLayer* UiSpiFlashAnalyzer::layer()
+{
+    mDecoder.setAddressBytes(addressBytes());
+    return &mDecoder;
+}
+
+/*!
+    Returns true if \a analyzer is an SPI analyzer.
+*/
+bool UiSpiFlashAnalyzer::acceptsSource(UiAnalyzer* analyzer) const
+{
+    return qobject_cast<UiSpiAnalyzer*>(analyzer) != NULL;
+}
+
+/*!
+    Returns the supported address lengths: three or four bytes.
+*/
+QList<int> UiSpiFlashAnalyzer::supportedAddressBytes() const
+{
+    return QList<int>() << 3 << 4;
+}
+
+/*!
+    Sets \a shortTxt and \a longTxt to the short and long text for
+    annotation \a i in \a annotations.
+*/
+void UiSpiFlashAnalyzer::annotationText(const AnalyzerAnnotations &annotations, int i,
+                                        QString &shortTxt, QString &longTxt)
+{
+    int value = annotations.value(i);
+    QLatin1Char fillChar('0');
+
+    switch(annotations.type(i)) {
+    case SpiFlashDecoder::TYPE_COMMAND:
+        shortTxt = SpiFlashDecoder::commandName(value, false);
+        longTxt = SpiFlashDecoder::commandName(value, true);
+        break;
+    case SpiFlashDecoder::TYPE_ADDRESS:
+        shortTxt = QString("0x%1").arg((uint)value, 2*addressBytes(), 16, fillChar);
+        longTxt = "Address " + shortTxt;
+        break;
+    case SpiFlashDecoder::TYPE_WRITE:
+        shortTxt = formatValue(dataFormat(), value);
+        longTxt = "Write " + shortTxt;
+        break;
+    case SpiFlashDecoder::TYPE_READ:
+        shortTxt = formatValue(dataFormat(), value);
+        longTxt = "Read " + shortTxt;
+        break;
+    }
+
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UISPIFLASHANALYZER_H
+#define UISPIFLASHANALYZER_H
+
+#include "analyzer/uistackedanalyzer.h"
+
+#include "spiflashdecoder.h"
+
+class UiSpiFlashAnalyzer : public UiStackedAnalyzer
+{
+    Q_OBJECT
+public:
+
+    static const QString signalName;
+
+    explicit UiSpiFlashAnalyzer(QWidget *parent = 0);
+
+    static UiSpiFlashAnalyzer* fromSettingsString(const QString &settings);
+
+signals:
+
+public slots:
+
+protected:
+    QString layerName() const {return signalName;}
+    AnalyzerLayer* layer();
+    bool acceptsSource(UiAnalyzer* analyzer) const;
+    QList<int> supportedAddressBytes() const;
+
+    void annotationText(const AnalyzerAnnotations &annotations, int i,
+                        QString &shortTxt, QString &longTxt);
+
+private:
+
+    SpiFlashDecoder mDecoder;
+
+    static int spiFlashAnalyzerCounter;
+
+};
+
+#endif // UISPIFLASHANALYZER_H
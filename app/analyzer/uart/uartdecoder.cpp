@@ -0,0 +1,310 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uartdecoder.h"
+
+/*!
+    \class UartDecoder
+    \brief Decodes UART data from a digital signal.
+
+    \ingroup Analyzer
+
+    The UartDecoder class holds the settings and a copy of the signal data
+    and knows nothing about the UI. The copy shares its data with the
+    capture device (implicit sharing) so it is cheap to make, and as it is
+    never modified it can be decoded on another thread while the device
+    replaces its own data with a new capture.
+
+    UiUartAnalyzer decodes with it through an AnalyzerDecoderJob.
+*/
+
+/*!
+    Constructs a decoder with the default settings and no data.
+*/
+UartDecoder::UartDecoder()
+{
+    mSampleRate = 0;
+    mBaudRate = 115200;
+    mDataBits = 8;
+    mStopBits = 1;
+    mParity = Types::ParityNone;
+}
+
+/*!
+    Sets the signal \a data to decode, sampled at \a sampleRate.
+*/
+void UartDecoder::setData(const QVector<int> &data, int sampleRate)
+{
+    mData = data;
+    mSampleRate = sampleRate;
+}
+
+/*!
+    Returns true if there is data to decode with the current settings.
+*/
+bool UartDecoder::isValid() const
+{
+    if (mData.size() == 0 || mBaudRate <= 0) return false;
+
+    int numSamplesPerBit = mSampleRate / mBaudRate;
+    // if there aren't enough samples per bit the decoding isn't reliable
+    if (numSamplesPerBit < 3) return false;
+
+    return true;
+}
+
+/*!
+    Returns the decoder state for a new decoding starting at the sample
+    with index \a startIdx.
+*/
+UartDecoder::State UartDecoder::initialState(int startIdx) const
+{
+    State s;
+    s.pos = startIdx;
+    s.prev = mData.at(startIdx);
+    s.state = STATE_START;
+    s.findTransition = true;
+    s.startFound = false;
+    s.startIdx = 0;
+    s.value = 0;
+    s.numDataBits = 0;
+    s.numStopBits = 0;
+    s.onesInValue = 0;
+    s.parityError = false;
+
+    return s;
+}
+
+/*!
+    Finds the first sample in the range \a fromIdx to \a toIdx where the
+    line has been idle for longer than a frame. A decoding started at
+    \a startIdx is then waiting for a start bit, and the state it would
+    have at that sample is stored in \a s. Returns false if the line is
+    never idle for that long in the range.
+*/
+bool UartDecoder::resyncState(int startIdx, int fromIdx, int toIdx, State* s) const
+{
+    Q_UNUSED(startIdx);
+
+    int numSamplesPerBit = mSampleRate / mBaudRate;
+    int numFrameBits = 1 + mDataBits + mStopBits + 1;
+    if (mParity != Types::ParityNone) {
+        numFrameBits++;
+    }
+
+    int idleLength = numFrameBits * numSamplesPerBit;
+    int numIdle = 0;
+
+    toIdx = qMin(toIdx, mData.size());
+    for (int i = fromIdx; i < toIdx; i++) {
+        if (mData.at(i) != 1) {
+            numIdle = 0;
+        }
+        else if (++numIdle > idleLength) {
+            *s = initialState(i);
+            s->startFound = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    Decodes the signal data from the decoder state \a s until the sample with
+    index \a endIdx has been reached. Found items are added to \a items.
+    Returns true if the end of the signal data has been reached or if the
+    decoding had to stop because of a frame error.
+*/
+bool UartDecoder::decodeSamples(State &s, AnalyzerAnnotations &items, int endIdx) const
+{
+    const QVector<int>* uartData = &mData;
+
+    int numSamplesPerBit = mSampleRate / mBaudRate;
+    if (numSamplesPerBit < 3) return true;
+
+    int onesInBit = 0;
+    int bitValue = 0;
+    int bitStart = 0;
+
+    while(s.pos < endIdx) {
+        if (s.pos + numSamplesPerBit >= uartData->size()) return true;
+
+        if (s.findTransition) {
+            if (uartData->at(s.pos) != s.prev) {
+               s.findTransition = false;
+            }
+            else {
+                s.prev = uartData->at(s.pos);
+                s.pos++;
+
+                continue;
+            }
+        }
+
+        // check value of the bit
+        onesInBit = 0;
+        bitStart = s.pos;
+
+        for(int i = 0; i < numSamplesPerBit; i++) {
+
+            if (s.pos > 0 && uartData->at(s.pos-1) != uartData->at(s.pos)) {
+
+                // resyncing if a transition occurs when at least half
+                // the bit time has elapsed
+                if (i >= numSamplesPerBit/2) {
+                    break;
+                }
+            }
+
+            if (uartData->at(s.pos++) == 1) {
+                onesInBit++;
+            }
+        }
+        // value determined by state during at least half the bit time
+        bitValue = (((double)onesInBit/numSamplesPerBit) >= 0.5) ? 1 : 0;
+
+        switch(s.state) {
+
+        case STATE_START:
+            if (bitValue == 0) {
+                s.startFound = true;
+                s.startIdx = bitStart;
+                s.numDataBits = 0;
+                s.numStopBits = 0;
+                s.onesInValue = 0;
+                s.value = 0;
+                s.parityError = false;
+
+                s.state = STATE_DATA;
+            }
+
+            // it was not a start bit
+            else {
+
+                // restart if the start bit has never been seen
+                if (!s.startFound) {
+                    s.findTransition = true;
+                }
+
+                // frame error if start bit has been seen at least once
+                else {
+                    items.append(bitStart, -1, TYPE_FRAME_ERROR, 0);
+                    return true;
+                }
+
+            }
+            break;
+
+
+        case STATE_DATA:
+            // TODO: also support MSB first
+            s.value |= (bitValue << s.numDataBits);
+            s.numDataBits++;
+
+            if (bitValue == 1) {
+                s.onesInValue++;
+            }
+
+            if (s.numDataBits == mDataBits) {
+                if (mParity != Types::ParityNone) {
+                    s.state = STATE_PARITY;
+                }
+                else {
+                    s.state = STATE_STOP;
+                }
+            }
+            break;
+        case STATE_PARITY:
+
+            s.parityError = false;
+            switch(mParity) {
+            case Types::ParityNone:
+                break;
+            case Types::ParityOdd:
+                if ( (((s.onesInValue%2) == 0) && bitValue == 0) ||
+                     (((s.onesInValue%2) != 0 && bitValue == 1)))
+                {
+                    s.parityError = true;
+                }
+
+                break;
+            case Types::ParityEven:
+
+                if ( (((s.onesInValue%2) != 0) && bitValue == 0) ||
+                     (((s.onesInValue%2) == 0 && bitValue == 1)))
+                {
+                    s.parityError = true;
+                }
+
+                break;
+            case Types::ParityMark:
+                s.parityError = (bitValue == 0);
+                break;
+            case Types::ParitySpace:
+                s.parityError = (bitValue == 1);
+                break;
+            default:
+                break;
+            }
+
+            s.state = STATE_STOP;
+
+            break;
+        case STATE_STOP:
+            if (bitValue == 1) {
+                s.numStopBits++;
+
+                if (s.numStopBits == mStopBits) {
+
+                    if (!s.parityError) {
+                        items.append(s.startIdx, s.pos, TYPE_DATA, s.value);
+                    }
+                    else {
+                        items.append(s.startIdx, s.pos, TYPE_PARITY_ERROR, 0);
+                    }
+
+                    // clear what is left of the frame so that the state
+                    // is the same whatever the frame contained
+                    s.state = STATE_START;
+                    s.startIdx = 0;
+                    s.value = 0;
+                    s.numDataBits = 0;
+                    s.numStopBits = 0;
+                    s.onesInValue = 0;
+                    s.parityError = false;
+                    s.prev = uartData->at(s.pos-1);
+
+                    if (s.prev == 1) {
+                        // resync by finding transition
+                        s.findTransition = true;
+                    }
+
+
+                }
+            }
+
+            // no stop bit -> frame error
+            else {
+                items.append(s.startIdx, -1, TYPE_FRAME_ERROR, 0);
+                return true;
+            }
+            break;
+        }
+
+    }
+
+    return false;
+}
@@ -0,0 +1,98 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UARTDECODER_H
+#define UARTDECODER_H
+
+#include <QVector>
+
+#include "analyzer/analyzerannotations.h"
+
+#include "common/types.h"
+
+class UartDecoder
+{
+public:
+
+    /*!
+        UART item type
+    */
+    enum ItemType {
+        TYPE_DATA,
+        TYPE_FRAME_ERROR,
+        TYPE_PARITY_ERROR
+    };
+
+    enum UartState {
+        STATE_START,
+        STATE_DATA,
+        STATE_PARITY,
+        STATE_STOP
+    };
+
+    /*!
+        Everything the decoder carries from one sample to the next. See
+        AnalyzerDecoder.
+    */
+    struct State {
+        int pos;
+        int prev;
+        UartState state;
+        bool findTransition;
+        bool startFound;
+        int startIdx;
+        int value;
+        int numDataBits;
+        int numStopBits;
+        int onesInValue;
+        bool parityError;
+
+        bool operator==(const State &other) const {
+            return pos == other.pos && prev == other.prev
+                    && state == other.state
+                    && findTransition == other.findTransition
+                    && startFound == other.startFound
+                    && startIdx == other.startIdx && value == other.value
+                    && numDataBits == other.numDataBits
+                    && numStopBits == other.numStopBits
+                    && onesInValue == other.onesInValue
+                    && parityError == other.parityError;
+        }
+    };
+
+    UartDecoder();
+
+    void setData(const QVector<int> &data, int sampleRate);
+    void setBaudRate(int rate) {mBaudRate = rate;}
+    void setDataBits(int bits) {mDataBits = bits;}
+    void setStopBits(int bits) {mStopBits = bits;}
+    void setParity(Types::UartParity parity) {mParity = parity;}
+
+    bool isValid() const;
+    int numSamples() const {return mData.size();}
+    State initialState(int startIdx) const;
+    bool resyncState(int startIdx, int fromIdx, int toIdx, State* s) const;
+    bool decodeSamples(State &s, AnalyzerAnnotations &items, int endIdx) const;
+
+private:
+    QVector<int> mData;
+    int mSampleRate;
+    int mBaudRate;
+    int mDataBits;
+    int mStopBits;
+    Types::UartParity mParity;
+};
+
+#endif // UARTDECODER_H
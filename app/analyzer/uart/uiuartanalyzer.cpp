@@ -19,8 +19,6 @@
 
 #include "uiuartanalyzerconfig.h"
 #include "device/devicemanager.h"
-#include "common/configuration.h"
-#include "capture/cursormanager.h"
 
 /*!
     Counter used when creating the editable name.
@@ -164,217 +162,38 @@ void UiUartAnalyzer::setDataFormat(Types::DataFormat format)
 
 
 /*!
-    Start to analyze the signal data.
+    Creates a job decoding the signal data with the current settings. See
+    UiAnalyzer::createJob() for \a startIdx, \a visibleFrom, \a visibleTo
+    and \a keepPrevious.
 */
-void UiUartAnalyzer::analyze()
+QSharedPointer<AnalyzerJob> UiUartAnalyzer::createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious)
 {
-    mUartItems.clear();
+    QSharedPointer<AnalyzerDecoderJob<UartDecoder> > previous = mJob;
+    mJob.clear();
 
-    if (mSignalId == -1) return;
+    if (mSignalId == -1) return mJob;
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
-    int sampleRate = device->usedSampleRate();
     QVector<int>* uartData = device->digitalData(mSignalId);
 
-    if (uartData == NULL || uartData->size() == 0) return;
-
-    int numSamplesPerBit = sampleRate / mBaudRate;
-    // if there aren't enough samples per bit the decoding isn't reliable
-    if (numSamplesPerBit < 3) return;
-
-    int startIdx = 0;
-    int value = 0;
-    int numDataBits = 0;
-    int numStopBits = 0;
-    int pos = 0;
-    int onesInBit = 0;
-    int onesInValue = 0;
-    int bitValue = 0;
-    int bitStart = 0;
-
-
-    bool startFound = false;
-    bool findTransition = true;
-    bool parityError = false;
-    bool done = false;
-
-    if (mSyncCursor != UiCursor::NoCursor) {
-        double t = CursorManager::instance().cursorPosition(mSyncCursor);
-        if (t > 0 && CursorManager::instance().isCursorOn(mSyncCursor)) {
-            pos = sampleRate*t;
-        }
-        if (pos >= uartData->size()) {
-            pos = 0;
-        }
-    }
+    if (uartData == NULL) return mJob;
+
+    UartDecoder decoder;
+    decoder.setData(*uartData, device->usedSampleRate());
+    decoder.setBaudRate(mBaudRate);
+    decoder.setDataBits(mDataBits);
+    decoder.setStopBits(mStopBits);
+    decoder.setParity(mParity);
 
-    UartState state = STATE_START;
-
-    int prev = uartData->at(pos);
-
-    while(!done) {
-        if (pos + numSamplesPerBit >= uartData->size()) break;
-
-        if (findTransition) {
-            if (uartData->at(pos) != prev) {
-               findTransition = false;
-            }
-            else {
-                prev = uartData->at(pos);
-                pos++;
-
-                continue;
-            }
-        }
-
-        // check value of the bit
-        onesInBit = 0;
-        bitStart = pos;
-
-        for(int i = 0; i < numSamplesPerBit; i++) {
-
-            if (pos > 0 && uartData->at(pos-1) != uartData->at(pos)) {
-
-                // resyncing if a transition occurs when at least half
-                // the bit time has elapsed
-                if (i >= numSamplesPerBit/2) {
-                    break;
-                }
-            }
-
-            if (uartData->at(pos++) == 1) {
-                onesInBit++;
-            }
-        }
-        // value determined by state during at least half the bit time
-        bitValue = (((double)onesInBit/numSamplesPerBit) >= 0.5) ? 1 : 0;
-
-        switch(state) {
-
-        case STATE_START:
-            if (bitValue == 0) {
-                startFound = true;
-                startIdx = bitStart;
-                numDataBits = 0;
-                numStopBits = 0;
-                onesInValue = 0;
-                value = 0;
-                parityError = false;
-
-                state = STATE_DATA;
-            }
-
-            // it was not a start bit
-            else {
-
-                // restart if the start bit has never been seen
-                if (!startFound) {
-                    findTransition = true;
-                }
-
-                // frame error if start bit has been seen at least once
-                else {
-                    UartItem item(UartItem::TYPE_FRAME_ERROR, 0, bitStart, -1);
-                    mUartItems.append(item);
-                    done = true;
-                }
-
-            }
-            break;
-
-
-        case STATE_DATA:
-            // TODO: also support MSB first
-            value |= (bitValue << numDataBits);
-            numDataBits++;
-
-            if (bitValue == 1) {
-                onesInValue++;
-            }
-
-            if (numDataBits == mDataBits) {
-                if (mParity != Types::ParityNone) {
-                    state = STATE_PARITY;
-                }
-                else {
-                    state = STATE_STOP;
-                }
-            }
-            break;
-        case STATE_PARITY:
-
-            parityError = false;
-            switch(mParity) {
-            case Types::ParityNone:
-                break;
-            case Types::ParityOdd:
-                if ( (((onesInValue%2) == 0) && bitValue == 0) ||
-                     (((onesInValue%2) != 0 && bitValue == 1)))
-                {
-                    parityError = true;
-                }
-
-                break;
-            case Types::ParityEven:
-
-                if ( (((onesInValue%2) != 0) && bitValue == 0) ||
-                     (((onesInValue%2) == 0 && bitValue == 1)))
-                {
-                    parityError = true;
-                }
-
-                break;
-            case Types::ParityMark:
-                parityError = (bitValue == 0);
-                break;
-            case Types::ParitySpace:
-                parityError = (bitValue == 1);
-                break;
-            default:
-                break;
-            }
-
-            state = STATE_STOP;
-
-            break;
-        case STATE_STOP:
-            if (bitValue == 1) {
-                numStopBits++;
-
-                if (numStopBits == mStopBits) {
-
-                    if (!parityError) {
-                        UartItem item(UartItem::TYPE_DATA, value, startIdx, pos);
-                        mUartItems.append(item);
-                    }
-                    else {
-                        UartItem item(UartItem::TYPE_PARITY_ERROR, 0, startIdx, pos);
-                        mUartItems.append(item);
-                    }
-
-                    state = STATE_START;
-                    prev = uartData->at(pos-1);
-
-                    if (prev == 1) {
-                        // resync by finding transition
-                        findTransition = true;
-                    }
-
-
-                }
-            }
-
-            // no stop bit -> frame error
-            else {
-                UartItem item(UartItem::TYPE_FRAME_ERROR, 0, startIdx, -1);
-                mUartItems.append(item);
-                done = true;
-            }
-            break;
-        }
+    if (!decoder.isValid()) return mJob;
 
+    mJob = QSharedPointer<AnalyzerDecoderJob<UartDecoder> >(
+                new AnalyzerDecoderJob<UartDecoder>(decoder, startIdx, visibleFrom, visibleTo));
+    if (keepPrevious && !previous.isNull()) {
+        mJob->keepPrevious(previous.data());
     }
 
+    return mJob;
 }
 
 /*!
@@ -503,122 +322,6 @@ UiUartAnalyzer* UiUartAnalyzer::fromSettingsString(const QString &s)
     return analyzer;
 }
 
-/*!
-    Paint event handler responsible for painting this widget.
-*/
-void UiUartAnalyzer::paintEvent(QPaintEvent *event)
-{
-    (void)event;
-    QPainter painter(this);
-
-    int textMargin = 3;
-
-    // -----------------
-    // draw background
-    // -----------------
-    paintBackground(&painter);
-
-
-    painter.setClipRect(plotX(), 0, width()-infoWidth(), height());
-    painter.translate(0, height()/2);
-
-    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
-    int sampleRate = device->usedSampleRate();
-
-
-    double from = 0;
-    double to = 0;
-    int fromIdx = 0;
-    int toIdx = 0;
-
-    int h = height()/4;
-
-    QString shortTxt;
-    QString longTxt;
-
-    QPen pen = painter.pen();
-    pen.setColor(Configuration::instance().analyzerColor());
-    painter.setPen(pen);
-
-    for (int i = 0; i < mUartItems.size(); i++) {
-        UartItem item = mUartItems.at(i);
-
-        fromIdx = item.startIdx;
-        toIdx = item.stopIdx;
-
-
-        typeAndValueAsString(item.type, item.value, shortTxt, longTxt);
-
-        int shortTextWidth = painter.fontMetrics().width(shortTxt);
-        int longTextWidth = painter.fontMetrics().width(longTxt);
-
-
-        from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
-
-        // no need to draw when signal is out of plot area
-        if (from > width()) break;
-
-        if (toIdx != -1) {
-            to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
-        }
-        else  {
-
-            // see if the long text version fits
-            to = from + longTextWidth+textMargin*2;
-
-            if (i+1 < mUartItems.size()) {
-
-                // get position for the start of the next item
-                double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mUartItems.at(i+1).startIdx/sampleRate);
-
-
-                // if 'to' overlaps check if short text fits
-                if (to > tmp) {
-
-                    to = from + shortTextWidth+textMargin*2;
-
-                    // 'to' overlaps next item -> limit to start of next item
-                    if (to > tmp) {
-                        to = tmp;
-                    }
-
-                }
-
-
-            }
-        }
-
-
-        if (to-from > 4) {
-            painter.drawLine(from, 0, from+2, -h);
-            painter.drawLine(from, 0, from+2, h);
-
-            painter.drawLine(from+2, -h, to-2, -h);
-            painter.drawLine(from+2, h, to-2, h);
-
-            painter.drawLine(to, 0, to-2, -h);
-            painter.drawLine(to, 0, to-2, h);
-        }
-
-        // drawing a vertical line when the allowed width is too small
-        else {
-            painter.drawLine(from, -h, from, h);
-        }
-
-        // only draw the text if it fits between 'from' and 'to'
-        QRectF textRect(from+1, -h, (to-from), 2*h);
-        if (longTextWidth < (to-from)) {
-            painter.drawText(textRect, Qt::AlignCenter, longTxt);
-        }
-        else if (shortTextWidth < (to-from)) {
-            painter.drawText(textRect, Qt::AlignCenter, shortTxt);
-        }
-
-    }
-
-}
-
 /*!
     Event handler called when this widget is being shown
 */
@@ -674,29 +377,37 @@ int UiUartAnalyzer::calcMinimumWidth()
 }
 
 /*!
-    Convert UART \a type and data \a value to string representation. A short
-    and long representation is returned in \a shortTxt and \a longTxt.
+    Sets \a shortTxt and \a longTxt to the short and long text for
+    annotation \a i in \a annotations.
 */
-void UiUartAnalyzer::typeAndValueAsString(UartItem::ItemType type,
-                                          int value,
-                                          QString &shortTxt,
-                                          QString &longTxt)
+void UiUartAnalyzer::annotationText(const AnalyzerAnnotations &annotations, int i,
+                                    QString &shortTxt, QString &longTxt)
 {
+    int value = annotations.value(i);
 
-
-    switch(type) {
-    case UartItem::TYPE_DATA:
+    switch(annotations.type(i)) {
+    case UartDecoder::TYPE_DATA:
         shortTxt = formatValue(mFormat, value);
         longTxt = formatValue(mFormat, value);
         break;
-    case UartItem::TYPE_PARITY_ERROR:
+    case UartDecoder::TYPE_PARITY_ERROR:
         shortTxt = "PE";
         longTxt = "Parity Error";
         break;
-    case UartItem::TYPE_FRAME_ERROR:
+    case UartDecoder::TYPE_FRAME_ERROR:
         shortTxt = "FE";
         longTxt = "Frame Error";
         break;
     }
 
 }
+
+/*!
+    Returns true if annotation \a i in \a annotations has the \a value
+    searched for by the find actions. Only the received characters are
+    compared, not the errors.
+*/
+bool UiUartAnalyzer::findMatches(const AnalyzerAnnotations &annotations, int i, int value) const
+{
+    return annotations.type(i) == UartDecoder::TYPE_DATA && annotations.value(i) == value;
+}
@@ -19,52 +19,9 @@
 #include <QWidget>
 
 #include "analyzer/uianalyzer.h"
+#include "analyzer/analyzerjob.h"
 #include "capture/uicursor.h"
-
-/*!
-    \class UartItem
-    \brief Container class for UART items.
-
-    \ingroup Analyzer
-
-    \internal
-
-*/
-class UartItem {
-public:
-
-    /*!
-        UART item type
-    */
-    enum ItemType {
-        TYPE_DATA,
-        TYPE_FRAME_ERROR,
-        TYPE_PARITY_ERROR
-    };
-
-    // default constructor needed in order to add this to QVector
-    /*! Default constructor */
-    UartItem() {
-    }
-
-    /*! Constructs a new container */
-    UartItem(ItemType type, int value, int startIdx, int stopIdx) {
-        this->type = type;
-        this->value = value;
-        this->startIdx = startIdx;
-        this->stopIdx = stopIdx;
-    }
-
-    /*! type */
-    ItemType type;
-    /*! value */
-    int value;
-    /*! item start index */
-    int startIdx;
-    /*! item stop index */
-    int stopIdx;    
-
-};
+#include "uartdecoder.h"
 
 class UiUartAnalyzer : public UiAnalyzer
 {
@@ -96,7 +53,6 @@ public:
     void setSyncCursor(UiCursor::CursorId id) {mSyncCursor = id;}
     UiCursor::CursorId syncCursor() const {return mSyncCursor;}
 
-    void analyze();
     void configure(QWidget* parent);
 
     QString toSettingsString() const;
@@ -107,22 +63,19 @@ signals:
 public slots:
 
 protected:
-    void paintEvent(QPaintEvent *event);
     void showEvent(QShowEvent* event);
 
+    QSharedPointer<AnalyzerJob> createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious);
+    void annotationText(const AnalyzerAnnotations &annotations, int i,
+                        QString &shortTxt, QString &longTxt);
+    bool findMatches(const AnalyzerAnnotations &annotations, int i, int value) const;
+
 private:
 
     enum {
         SignalIdMarginRight = 10
     };
 
-    enum UartState {
-        STATE_START,
-        STATE_DATA,
-        STATE_PARITY,
-        STATE_STOP
-    };
-
     static int uartAnalyzerCounter;
     int mSignalId;
     int mBaudRate;
@@ -134,16 +87,12 @@ private:
 
     QLabel* mSignalLbl;
 
-    QVector<UartItem> mUartItems;
+    QSharedPointer<AnalyzerDecoderJob<UartDecoder> > mJob;
 
     void infoWidthChanged();
     void doLayout();
     int calcMinimumWidth();
 
-    void typeAndValueAsString(UartItem::ItemType type,
-                                 int value,
-                                 QString &shortTxt,
-                                 QString &longTxt);
     
 };
 
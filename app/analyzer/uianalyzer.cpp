@@ -15,13 +15,64 @@
  */
 #include "uianalyzer.h"
 
+#include <QThreadPool>
+#include <QPainter>
+#include <QMenu>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QContextMenuEvent>
+
+#include "device/devicemanager.h"
+#include "capture/cursormanager.h"
+#include "common/configuration.h"
+#include "common/instrumentation.h"
+
 /*!
     \class UiAnalyzer
     \brief This is a base class for all analyzers.
 
     \ingroup Analyzer
 
+    The protocol decoding itself is done by a decoder core without any UI
+    (e.g. UartDecoder) in an AnalyzerJob on the global QThreadPool, so that
+    a slow decoding never blocks painting and several analyzers decode the
+    same capture in parallel. A subclass creates the job in \ref createJob
+    and describes the annotations the job finds in \ref annotationText.
+    This class decides when to decode:
+
+    - When the settings or the signal data have changed the running job is
+      cancelled and a new one is started. It decodes the visible part of
+      the signal first so that it can be shown at once, then the signal
+      from the start (or the sync cursor) and reuses the visible part when
+      it gets there.
+
+    - When the sync cursor moves the previous result is kept. The new
+      decoding only runs until it is in step with the previous one.
+
+    While a job is running the analyzer is repainted every
+    ProgressInterval ms and shows the progress.
+
+    The annotations are painted by this class, one line per row (see
+    \ref numRows), so an analyzer for a new protocol only has to provide
+    the decoder core, the texts and the settings. Analyzers are made
+    available to the user by registering them with AnalyzerManager.
+
+    An analyzer can also decode the annotations of another analyzer
+    instead of signal data, see UiStackedAnalyzer. Such an analyzer asks
+    for the annotations of the visible part only, through \ref annotations,
+    and is told with annotationsChanged() when the analyzer below it has
+    found more.
+
+    The context menu has actions to search the annotations for a value
+    (see \ref findMatches). A match moves the first enabled cursor that
+    isn't the sync cursor (Cursor 1 if none is enabled) to the start of
+    the annotation.
+*/
+
+/*!
+    All analyzers that currently exist, in the order they were created.
 */
+QList<UiAnalyzer*> UiAnalyzer::liveAnalyzers;
 
 
 /*!
@@ -31,14 +82,38 @@ UiAnalyzer::UiAnalyzer(QWidget *parent) :
     UiSimpleAbstractSignal(parent)
 {
     setConfigurable();
-}
 
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mProgressTimer = new QTimer(this);
+    mProgressTimer->setInterval(ProgressInterval);
+    connect(mProgressTimer, SIGNAL(timeout()), this, SLOT(checkProgress()));
+
+    mFindValue = -1;
+
+    liveAnalyzers.append(this);
+}
 
 /*!
-    \fn virtual void UiAnalyzer::analyze() = 0
+    Cancels the running decoding (if any). The job itself is deleted when
+    the thread pool is done with it.
+*/
+UiAnalyzer::~UiAnalyzer()
+{
+    liveAnalyzers.removeAll(this);
 
-    Call to start to analyze the signal(s)
+    if (!mJob.isNull()) {
+        mJob->cancel();
+    }
+}
+
+/*!
+    Start to analyze the signal data. Any previous result is thrown away.
 */
+void UiAnalyzer::analyze()
+{
+    restartAnalysis(false);
+}
+
 
 /*!
     \fn virtual QString UiAnalyzer::toSettingsString() const = 0
@@ -55,6 +130,401 @@ void UiAnalyzer::handleSignalDataChanged()
     analyze();
 }
 
+/*!
+    Called when the cursor \a id has been moved or turned on/off. If it is
+    the analyzer's sync cursor the signal is decoded again from the new
+    position, reusing the previous result where possible.
+*/
+void UiAnalyzer::handleCursorChanged(UiCursor::CursorId id)
+{
+    if (id != UiCursor::NoCursor && id == syncCursor()) {
+        restartAnalysis(true);
+    }
+}
+
+/*!
+    Returns the annotations found so far by the running or last decoding.
+    The result contains at least all annotations overlapping the samples
+    \a fromIdx to \a toIdx but may contain more, sorted by start index.
+    This implementation always returns all of them.
+*/
+AnalyzerAnnotations UiAnalyzer::annotations(SampleIndex fromIdx, SampleIndex toIdx)
+{
+    (void)fromIdx;
+    (void)toIdx;
+
+    if (mJob.isNull()) return AnalyzerAnnotations();
+
+    return mJob->results();
+}
+
+/*!
+    Asks for a value and moves a cursor to the next annotation with that
+    value. A value starting with 0x is read as hex and a single character
+    that isn't a digit as its character code.
+*/
+void UiAnalyzer::findValue()
+{
+    bool ok = false;
+    QString txt = QInputDialog::getText(this, tr("Find value"),
+                                        tr("Value (0x prefix for hex):"),
+                                        QLineEdit::Normal, mFindText, &ok);
+    if (!ok || txt.isEmpty()) return;
+
+    int value = txt.toInt(&ok, 0);
+    if (!ok && txt.size() == 1) {
+        value = txt.at(0).unicode();
+        ok = true;
+    }
+    if (!ok || value < 0) {
+        QMessageBox::warning(this, tr("Find value"),
+                             tr("%1 is not a valid value").arg(txt));
+        return;
+    }
+
+    mFindValue = value;
+    mFindText = txt;
+    findAnnotation(true);
+}
+
+/*!
+    Moves the cursor to the next annotation with the value given to
+    \ref findValue.
+*/
+void UiAnalyzer::findNext()
+{
+    findAnnotation(true);
+}
+
+/*!
+    Moves the cursor to the previous annotation with the value given to
+    \ref findValue.
+*/
+void UiAnalyzer::findPrevious()
+{
+    findAnnotation(false);
+}
+
+/*!
+    \fn static QList<UiAnalyzer*> UiAnalyzer::analyzers()
+
+    Returns all analyzers that currently exist.
+*/
+
+/*!
+    Returns the analyzer with the given \a name or NULL if there is none.
+*/
+UiAnalyzer* UiAnalyzer::findAnalyzer(const QString &name)
+{
+    foreach(UiAnalyzer* analyzer, liveAnalyzers) {
+        if (analyzer->getName() == name) {
+            return analyzer;
+        }
+    }
+
+    return NULL;
+}
+
+/*!
+    \fn virtual UiCursor::CursorId UiAnalyzer::syncCursor() const = 0
+
+    Returns the cursor used for synchronization.
+*/
+
+/*!
+    \fn virtual QSharedPointer<AnalyzerJob> UiAnalyzer::createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious) = 0
+
+    Creates a job decoding the signal data from the sample with index
+    \a startIdx, starting with the samples from \a visibleFrom to
+    \a visibleTo. If \a keepPrevious is true the job should reuse the
+    result of the previous job, which has stopped. Returns a null pointer if
+    there is nothing to decode.
+*/
+
+/*!
+    Cancels the running decoding (if any) and starts a new one from the
+    sync cursor. If \a keepPrevious is true the result of the previous
+    decoding is reused where possible.
+*/
+void UiAnalyzer::restartAnalysis(bool keepPrevious)
+{
+    if (!mJob.isNull()) {
+        mJob->cancel();
+
+        // the previous result can only be reused when the job has stopped
+        if (keepPrevious) {
+            mJob->waitForDone();
+        }
+    }
+
+    int visibleFrom = -1;
+    int visibleTo = -1;
+    if (mTimeAxis != NULL) {
+        int sampleRate = DeviceManager::instance().activeDevice()
+                ->captureDevice()->usedSampleRate();
+        visibleFrom = decoderIndex(SampleTime::fromSeconds(mTimeAxis->rangeLower(), sampleRate));
+        visibleTo = decoderIndex(SampleTime::fromSeconds(mTimeAxis->rangeUpper(), sampleRate));
+    }
+
+    mJob = createJob(decoderIndex(syncPosition()), visibleFrom, visibleTo, keepPrevious);
+    if (!mJob.isNull()) {
+        mJob->setName(getName());
+
+        // Deallocation: the thread pool deletes the task when it has run
+        QThreadPool::globalInstance()->start(new AnalyzerTask(mJob));
+        mProgressTimer->start();
+    }
+
+    emit annotationsChanged();
+    update();
+}
+
+/*!
+    \fn virtual void UiAnalyzer::annotationText(const AnalyzerAnnotations &annotations, int i, QString &shortTxt, QString &longTxt) = 0
+
+    Sets \a shortTxt and \a longTxt to the texts describing annotation
+    \a i in \a annotations. The long text is shown when there is room for
+    it, otherwise the short text.
+*/
+
+/*!
+    \fn virtual int UiAnalyzer::numRows() const
+
+    Returns the number of rows the annotations are painted in. See
+    AnalyzerAnnotations::row().
+*/
+
+/*!
+    \fn virtual QString UiAnalyzer::rowName(int row) const
+
+    Returns the name of \a row, shown when the analyzer is selected and
+    has more than one row.
+*/
+
+/*!
+    Paint event handler responsible for painting this widget.
+*/
+void UiAnalyzer::paintEvent(QPaintEvent *event)
+{
+    (void)event;
+    InstrumentationTimer timer("Paint " + getName());
+    QPainter painter(this);
+
+    // -----------------
+    // draw background
+    // -----------------
+    paintBackground(&painter);
+
+    painter.setClipRect(plotX(), 0, width()-infoWidth(), height());
+
+    int rows = numRows();
+    int rowHeight = height()/rows;
+    int h = height()/(2*rows+2);
+
+    if (mSelected && rows > 1) {
+        QPen pen = painter.pen();
+        pen.setColor(Qt::gray);
+        painter.setPen(pen);
+
+        for (int row = 0; row < rows; row++) {
+            QRectF rowRect(plotX()+4, row*rowHeight+rowHeight/2-h, 100, 2*h);
+            painter.drawText(rowRect, Qt::AlignLeft|Qt::AlignVCenter, rowName(row));
+        }
+    }
+
+    QPen pen = painter.pen();
+    pen.setColor(Configuration::instance().analyzerColor());
+    painter.setPen(pen);
+
+    int sampleRate = DeviceManager::instance().activeDevice()
+            ->captureDevice()->usedSampleRate();
+    if (sampleRate > 0) {
+        SampleIndex fromIdx = qMax((SampleIndex)0,
+                mTimeAxis->pixelToSampleRelativeRef(plotX(), sampleRate));
+        SampleIndex toIdx = qMax((SampleIndex)0,
+                mTimeAxis->pixelToSampleRelativeRef(width(), sampleRate));
+
+        paintAnnotations(&painter, annotations(fromIdx, toIdx), fromIdx,
+                         sampleRate, rowHeight, h);
+    }
+
+    paintProgress(&painter);
+}
+
+/*!
+    Paints the visible \a annotations using \a painter, starting with the
+    ones around the sample \a fromIdx at the left edge of the plot area.
+    Each row is \a rowHeight high and an annotation is \a h high above and
+    below the middle of its row.
+*/
+void UiAnalyzer::paintAnnotations(QPainter* painter, const AnalyzerAnnotations &annotations,
+                                  SampleIndex fromIdx, int sampleRate, int rowHeight, int h)
+{
+    if (annotations.isEmpty()) return;
+
+    int rows = numRows();
+
+    // the annotations starting before the plot area can reach into it
+    int first = annotations.lowerBound(fromIdx);
+    if (first > 0) {
+        first = annotations.lowerBound(annotations.startIdx(first-1));
+    }
+
+    QString shortTxt;
+    QString longTxt;
+
+    for (int i = first; i < annotations.size(); i++) {
+        int row = annotations.row(i);
+        if (row >= rows) continue;
+
+        annotationText(annotations, i, shortTxt, longTxt);
+
+        double from = mTimeAxis->sampleToPixelRelativeRef(
+                    annotations.startIdx(i), sampleRate);
+
+        // no need to draw when signal is out of plot area
+        if (from > width()) break;
+
+        double to = 0;
+        if (annotations.stopIdx(i) != -1) {
+            to = mTimeAxis->sampleToPixelRelativeRef(
+                        annotations.stopIdx(i), sampleRate);
+        }
+        else  {
+
+            // see if the long text version fits
+            to = from + painter->fontMetrics().width(longTxt)+TextMargin*2;
+
+            // find the next annotation in the same row
+            int next = i+1;
+            while (next < annotations.size() && next <= i+rows
+                   && annotations.row(next) != row) {
+                next++;
+            }
+
+            if (next < annotations.size() && annotations.row(next) == row) {
+
+                // get position for the start of the next item
+                double tmp = mTimeAxis->sampleToPixelRelativeRef(
+                            annotations.startIdx(next), sampleRate);
+
+                // if 'to' overlaps check if short text fits
+                if (to > tmp) {
+
+                    to = from + painter->fontMetrics().width(shortTxt)+TextMargin*2;
+
+                    // 'to' overlaps next item -> limit to start of next item
+                    if (to > tmp) {
+                        to = tmp;
+                    }
+                }
+            }
+        }
+
+        paintAnnotation(painter, from, to, row*rowHeight+rowHeight/2, h,
+                        shortTxt, longTxt);
+    }
+}
+
+/*!
+    Paints one annotation from \a from to \a to around \a y with the
+    height 2*\a h using \a painter. The \a longTxt is drawn if it fits,
+    otherwise the \a shortTxt.
+*/
+void UiAnalyzer::paintAnnotation(QPainter* painter, double from, double to, int y, int h,
+                                 const QString &shortTxt, const QString &longTxt)
+{
+    int shortTextWidth = painter->fontMetrics().width(shortTxt);
+    int longTextWidth = painter->fontMetrics().width(longTxt);
+
+    if (to-from > 4) {
+        painter->drawLine(from, y, from+2, y-h);
+        painter->drawLine(from, y, from+2, y+h);
+
+        painter->drawLine(from+2, y-h, to-2, y-h);
+        painter->drawLine(from+2, y+h, to-2, y+h);
+
+        painter->drawLine(to, y, to-2, y-h);
+        painter->drawLine(to, y, to-2, y+h);
+    }
+
+    // drawing a vertical line when the allowed width is too small
+    else {
+        painter->drawLine(from, y-h, from, y+h);
+    }
+
+    // only draw the text if it fits between 'from' and 'to'
+    QRectF textRect(from+1, y-h, (to-from), 2*h);
+    if (longTextWidth < (to-from)) {
+        painter->drawText(textRect, Qt::AlignCenter, longTxt);
+    }
+    else if (shortTextWidth < (to-from)) {
+        painter->drawText(textRect, Qt::AlignCenter, shortTxt);
+    }
+}
+
+/*!
+    Called regularly while a job is running to show the items found so far.
+*/
+void UiAnalyzer::checkProgress()
+{
+    if (mJob.isNull() || mJob->isDone()) {
+        mProgressTimer->stop();
+    }
+    emit annotationsChanged();
+    update();
+}
+
+/*!
+    Paints the progress of the running job (if any) as a line at the
+    bottom of the plot area using \a painter.
+*/
+void UiAnalyzer::paintProgress(QPainter* painter)
+{
+    if (mJob.isNull() || mJob->isDone()) return;
+
+    int w = ((width()-plotX())*mJob->progress())/100;
+
+    painter->save();
+    painter->resetTransform();
+    painter->setClipping(false);
+    painter->fillRect(plotX(), height()-2, w, 2,
+                      Configuration::instance().analyzerColor());
+    painter->restore();
+}
+
+/*!
+    Returns the index of the sample where the decoding should start. This
+    is the position of the sync cursor if it has been set and is on. The
+    job starts from 0 instead if the position is outside the signal data.
+*/
+SampleIndex UiAnalyzer::syncPosition()
+{
+    SampleIndex pos = 0;
+    UiCursor::CursorId id = syncCursor();
+
+    if (id != UiCursor::NoCursor) {
+        double t = CursorManager::instance().cursorPosition(id);
+        if (t > 0 && CursorManager::instance().isCursorOn(id)) {
+            pos = SampleTime::fromSeconds(t, DeviceManager::instance().activeDevice()
+                                          ->captureDevice()->usedSampleRate());
+        }
+    }
+
+    return pos;
+}
+
+/*!
+    Returns the sample index \a idx limited to what a decoder can handle.
+    The decoders work on the signal data of the capture, which is held in
+    memory and indexed with an int, while the annotations they produce and
+    the rest of the view use 64-bit sample indices.
+*/
+int UiAnalyzer::decoderIndex(SampleIndex idx)
+{
+    return (int)qBound((SampleIndex)0, idx, (SampleIndex)2147483647);
+}
+
 
 /*!
     \fn virtual void UiAnalyzer::configure(QWidget* parent) = 0
@@ -64,6 +534,34 @@ void UiAnalyzer::handleSignalDataChanged()
 */
 
 
+/*!
+    Returns true if annotation \a i in \a annotations matches the \a value
+    searched for by the find actions. This implementation compares the
+    value of any type of annotation. Analyzers whose annotations also
+    carry e.g. addresses or error codes should only compare the data.
+*/
+bool UiAnalyzer::findMatches(const AnalyzerAnnotations &annotations, int i, int value) const
+{
+    return annotations.value(i) == value;
+}
+
+/*!
+    Event handler called when the context menu is requested for this
+    widget.
+*/
+void UiAnalyzer::contextMenuEvent(QContextMenuEvent* event)
+{
+    QMenu menu(this);
+    menu.addAction(tr("Find value..."), this, SLOT(findValue()));
+
+    QAction* next = menu.addAction(tr("Find next"), this, SLOT(findNext()));
+    QAction* previous = menu.addAction(tr("Find previous"), this, SLOT(findPrevious()));
+    next->setEnabled(mFindValue != -1);
+    previous->setEnabled(mFindValue != -1);
+
+    menu.exec(event->globalPos());
+}
+
 /*!
     Helper function to convert the value \a value to a string according
     to \a format.
@@ -89,3 +587,58 @@ QString UiAnalyzer::formatValue(Types::DataFormat format, int value)
 
     return s;
 }
+
+/*!
+    Searches the annotations for mFindValue towards the end if \a forward
+    is true, otherwise towards the start. The search starts next to the
+    position of the cursor returned by \ref findCursor, or at the start or
+    end of the capture if that cursor is disabled.
+*/
+void UiAnalyzer::findAnnotation(bool forward)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+    if (mFindValue == -1 || device == NULL) return;
+
+    AnalyzerAnnotations items = annotations(0, device->lastSampleIndex());
+    UiCursor::CursorId id = findCursor();
+
+    int i = forward ? 0 : items.size()-1;
+    if (CursorManager::instance().isCursorOn(id)) {
+        SampleIndex pos = SampleTime::nearestSample(
+                    CursorManager::instance().cursorPosition(id),
+                    device->usedSampleRate());
+        i = forward ? items.lowerBound(pos+1) : items.lowerBound(pos)-1;
+    }
+
+    int step = forward ? 1 : -1;
+    for (; i >= 0 && i < items.size(); i += step) {
+        if (findMatches(items, i, mFindValue)) break;
+    }
+    if (i < 0 || i >= items.size()) {
+        QMessageBox::information(this, tr("Find value"),
+                                 tr("No more %1 found").arg(mFindText));
+        return;
+    }
+
+    CursorManager::instance().setCursorPosition(
+                id, device->sampleTime(items.startIdx(i)).toSeconds());
+    CursorManager::instance().enableCursor(id, true);
+}
+
+/*!
+    Returns the cursor moved by the find actions. It is the first enabled
+    cursor that isn't the sync cursor, as moving that one would restart
+    the decoding, or Cursor 1 if no such cursor is enabled.
+*/
+UiCursor::CursorId UiAnalyzer::findCursor() const
+{
+    UiCursor::CursorId sync = syncCursor();
+    for (int i = UiCursor::Cursor1; i <= UiCursor::Cursor4; i++) {
+        UiCursor::CursorId id = (UiCursor::CursorId)i;
+        if (id != sync && CursorManager::instance().isCursorOn(id)) {
+            return id;
+        }
+    }
+
+    return sync == UiCursor::Cursor1 ? UiCursor::Cursor2 : UiCursor::Cursor1;
+}
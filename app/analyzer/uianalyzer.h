@@ -18,9 +18,14 @@
 
 #include <QObject>
 #include <QWidget>
+#include <QTimer>
+#include <QSharedPointer>
 
 #include "common/types.h"
 #include "capture/uisimpleabstractsignal.h"
+#include "capture/uicursor.h"
+#include "analyzerjob.h"
+#include "analyzerannotations.h"
 
 
 class UiAnalyzer : public UiSimpleAbstractSignal
@@ -30,23 +35,70 @@ public:
 
 
     explicit UiAnalyzer(QWidget *parent = 0);
+    ~UiAnalyzer();
 
-    virtual void analyze() = 0;
+    void analyze();
     virtual QString toSettingsString() const = 0;
+    virtual UiCursor::CursorId syncCursor() const = 0;
     void handleSignalDataChanged();
+    void handleCursorChanged(UiCursor::CursorId id);
+    virtual AnalyzerAnnotations annotations(SampleIndex fromIdx, SampleIndex toIdx);
+
+    static QList<UiAnalyzer*> analyzers() {return liveAnalyzers;}
+    static UiAnalyzer* findAnalyzer(const QString &name);
 
-    
 signals:
-    
+    void annotationsChanged();
+
 public slots:
     virtual void configure(QWidget* parent) = 0;
+    void findValue();
+    void findNext();
+    void findPrevious();
 
 
 protected:
     QString formatValue(Types::DataFormat format, int value);
 
+    virtual QSharedPointer<AnalyzerJob> createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious) = 0;
+    virtual void annotationText(const AnalyzerAnnotations &annotations, int i,
+                                QString &shortTxt, QString &longTxt) = 0;
+    virtual int numRows() const {return 1;}
+    virtual QString rowName(int row) const {(void)row; return QString();}
+    virtual bool findMatches(const AnalyzerAnnotations &annotations, int i, int value) const;
+
+    void paintEvent(QPaintEvent *event);
+    void contextMenuEvent(QContextMenuEvent* event);
+
+private slots:
+    void checkProgress();
+
+private:
+
+    enum {
+        ProgressInterval = 100,
+        TextMargin = 3
+    };
+
+    QSharedPointer<AnalyzerJob> mJob;
+    QTimer* mProgressTimer;
+    int mFindValue;
+    QString mFindText;
+
+    static QList<UiAnalyzer*> liveAnalyzers;
+
+    void restartAnalysis(bool keepPrevious);
+    SampleIndex syncPosition();
+    static int decoderIndex(SampleIndex idx);
+    void findAnnotation(bool forward);
+    UiCursor::CursorId findCursor() const;
+
+    void paintAnnotations(QPainter* painter, const AnalyzerAnnotations &annotations,
+                          SampleIndex fromIdx, int sampleRate, int rowHeight, int h);
+    void paintAnnotation(QPainter* painter, double from, double to, int y, int h,
+                         const QString &shortTxt, const QString &longTxt);
+    void paintProgress(QPainter* painter);
 
-    
 };
 
 #endif // UIANALYZER_H
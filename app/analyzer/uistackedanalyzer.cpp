@@ -0,0 +1,360 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uistackedanalyzer.h"
+
+#include "uistackedanalyzerconfig.h"
+
+/*!
+    \class UiStackedAnalyzer
+    \brief Base class for analyzers decoding the annotations of another
+    analyzer.
+
+    \ingroup Analyzer
+
+    A stacked analyzer has no signals of its own. It decodes a higher
+    protocol layer, e.g. the register accesses of an I2C EEPROM, from the
+    annotations of its source analyzer with an AnalyzerLayer. Stacked
+    analyzers can in turn be the source of other stacked analyzers.
+
+    The decoding is lazy. Only the messages in the visible part of the
+    capture (plus half a screen on each side) are decoded, when the
+    analyzer is painted, and the source is only asked for its annotations
+    in that part. The result is kept until the view moves outside of it or
+    the source reports with UiAnalyzer::annotationsChanged() that it has
+    found more, so the layers follow a running decoding of the source.
+
+    The find actions of UiAnalyzer search the whole capture. They go
+    through \ref annotations as well, which then decodes all messages the
+    source has found so far.
+
+    The source is kept by name, so it can be loaded after this analyzer,
+    and is looked up the first time it is needed. A subclass provides the
+    layer, the texts of its annotations and which analyzers it can decode.
+*/
+
+
+/*!
+    Constructs the UiStackedAnalyzer with the given \a parent.
+*/
+UiStackedAnalyzer::UiStackedAnalyzer(QWidget *parent) :
+    UiAnalyzer(parent)
+{
+    mAddressBytes = 1;
+    mFormat = Types::DataFormatHex;
+    mCacheValid = false;
+    mCacheFrom = 0;
+    mCacheTo = 0;
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSourceLbl = new QLabel(this);
+
+    QPalette palette= mSourceLbl->palette();
+    palette.setColor(QPalette::Text, Qt::gray);
+    mSourceLbl->setPalette(palette);
+
+    setFixedHeight(50);
+}
+
+/*!
+    Set the name of the analyzer to decode to \a name.
+*/
+void UiStackedAnalyzer::setSourceName(const QString &name)
+{
+    if (!mSource.isNull()) {
+        disconnect(mSource, 0, this, 0);
+        mSource.clear();
+    }
+
+    mSourceName = name;
+    mSourceLbl->setText(QString("Source: %1").arg(name));
+    mCacheValid = false;
+}
+
+/*!
+    Returns the name of the analyzer to decode.
+*/
+QString UiStackedAnalyzer::sourceName() const
+{
+    // the source may have been renamed
+    if (!mSource.isNull()) {
+        return mSource->getName();
+    }
+
+    return mSourceName;
+}
+
+/*!
+    \fn void UiStackedAnalyzer::setAddressBytes(int bytes)
+
+    Set the number of address \a bytes, e.g. of a register address.
+*/
+
+/*!
+    \fn int UiStackedAnalyzer::addressBytes() const
+
+    Returns the number of address bytes.
+*/
+
+/*!
+    \fn void UiStackedAnalyzer::setDataFormat(Types::DataFormat format)
+
+    Set the \a format to use when showing data.
+*/
+
+/*!
+    \fn Types::DataFormat UiStackedAnalyzer::dataFormat() const
+
+    Returns the format used when showing data.
+*/
+
+/*!
+    \fn UiCursor::CursorId UiStackedAnalyzer::syncCursor() const
+
+    Returns UiCursor::NoCursor. The source decides where to start.
+*/
+
+/*!
+    Decodes the messages of the source analyzer overlapping the samples
+    \a fromIdx to \a toIdx (if not already done) and returns the result.
+*/
+AnalyzerAnnotations UiStackedAnalyzer::annotations(SampleIndex fromIdx, SampleIndex toIdx)
+{
+    UiAnalyzer* analyzer = source();
+    if (analyzer == NULL) return AnalyzerAnnotations();
+
+    if (!mCacheValid || fromIdx < mCacheFrom || toIdx > mCacheTo) {
+
+        // decode a bit more so that scrolling a little reuses the result
+        SampleIndex margin = (toIdx - fromIdx)/2;
+        mCacheFrom = qMax((SampleIndex)0, fromIdx - margin);
+        mCacheTo = toIdx + margin;
+
+        mCache.clear();
+        layer()->decodeRange(analyzer->annotations(mCacheFrom, mCacheTo),
+                             mCacheFrom, mCacheTo, mCache);
+        mCacheValid = true;
+    }
+
+    return mCache;
+}
+
+/*!
+    Configure the analyzer.
+*/
+void UiStackedAnalyzer::configure(QWidget *parent)
+{
+    QStringList names;
+    foreach(UiAnalyzer* analyzer, UiAnalyzer::analyzers()) {
+        if (analyzer != this && acceptsSource(analyzer)) {
+            names << analyzer->getName();
+        }
+    }
+
+    UiStackedAnalyzerConfig dialog(parent);
+    dialog.setWindowTitle(layerName());
+    dialog.setSources(names, sourceName());
+    dialog.setAddressBytes(supportedAddressBytes(), mAddressBytes);
+    dialog.setDataFormat(mFormat);
+    dialog.exec();
+
+    setSourceName(dialog.sourceName());
+    setAddressBytes(dialog.addressBytes());
+    setDataFormat(dialog.dataFormat());
+
+    analyze();
+    update();
+}
+
+/*!
+    Returns a string representation of this analyzer.
+*/
+QString UiStackedAnalyzer::toSettingsString() const
+{
+    // type;name;Source;AddressBytes;Format
+
+    QString str;
+    str.append(layerName());str.append(";");
+    str.append(getName());str.append(";");
+    str.append(sourceName());str.append(";");
+    str.append(QString("%1;").arg(mAddressBytes));
+    str.append(QString("%1").arg(mFormat));
+
+    return str;
+}
+
+/*!
+    \fn virtual QString UiStackedAnalyzer::layerName() const = 0
+
+    Returns the name the analyzer is registered with in AnalyzerManager.
+*/
+
+/*!
+    \fn virtual AnalyzerLayer* UiStackedAnalyzer::layer() = 0
+
+    Returns the layer decoding the source's annotations with the current
+    settings.
+*/
+
+/*!
+    \fn virtual bool UiStackedAnalyzer::acceptsSource(UiAnalyzer* analyzer) const = 0
+
+    Returns true if \a analyzer produces annotations the layer can decode.
+*/
+
+/*!
+    \fn virtual QList<int> UiStackedAnalyzer::supportedAddressBytes() const = 0
+
+    Returns the number of address bytes the user can choose from.
+*/
+
+/*!
+    Sets the name, source, address bytes and data format from the split
+    settings string \a list (see \ref toSettingsString). Returns false if
+    any of them is invalid.
+*/
+bool UiStackedAnalyzer::setSettings(const QStringList &list)
+{
+    bool ok = false;
+
+    if (list.size() != 5) return false;
+    if (list.at(0) != layerName()) return false;
+
+    // --- name
+    if (list.at(1).isNull()) return false;
+
+    // --- address bytes
+    int bytes = list.at(3).toInt(&ok);
+    if (!ok || !supportedAddressBytes().contains(bytes)) return false;
+
+    // --- format
+    int f = list.at(4).toInt(&ok);
+    if (!ok || f < 0 || f >= Types::DataFormatNum) return false;
+
+    setSignalName(list.at(1));
+    setSourceName(list.at(2));
+    setAddressBytes(bytes);
+    setDataFormat((Types::DataFormat)f);
+
+    return true;
+}
+
+/*!
+    Event handler called when this widget is being shown
+*/
+void UiStackedAnalyzer::showEvent(QShowEvent* event)
+{
+    (void)event;
+    doLayout();
+    setMinimumInfoWidth(calcMinimumWidth());
+}
+
+/*!
+    Nothing is decoded in advance, see \ref annotations. The previous
+    result is thrown away and a null job is returned.
+*/
+QSharedPointer<AnalyzerJob> UiStackedAnalyzer::createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious)
+{
+    (void)startIdx;
+    (void)visibleFrom;
+    (void)visibleTo;
+    (void)keepPrevious;
+
+    mCacheValid = false;
+
+    return QSharedPointer<AnalyzerJob>();
+}
+
+/*!
+    Called when the source has found more annotations, has been restarted
+    or has been deleted.
+*/
+void UiStackedAnalyzer::handleSourceChanged()
+{
+    mCacheValid = false;
+
+    if (!mSource.isNull()) {
+        mSourceLbl->setText(QString("Source: %1").arg(mSource->getName()));
+    }
+
+    emit annotationsChanged();
+    update();
+}
+
+/*!
+    Returns the source analyzer or NULL if there isn't one with the
+    source name.
+*/
+UiAnalyzer* UiStackedAnalyzer::source()
+{
+    if (mSource.isNull() && !mSourceName.isEmpty()) {
+        UiAnalyzer* analyzer = UiAnalyzer::findAnalyzer(mSourceName);
+
+        if (analyzer != NULL && analyzer != this && acceptsSource(analyzer)) {
+            mSource = analyzer;
+            mCacheValid = false;
+
+            connect(analyzer, SIGNAL(annotationsChanged()),
+                    this, SLOT(handleSourceChanged()));
+            connect(analyzer, SIGNAL(destroyed()),
+                    this, SLOT(handleSourceChanged()));
+        }
+    }
+
+    return mSource.data();
+}
+
+/*!
+    Called when the info width has changed for this widget.
+*/
+void UiStackedAnalyzer::infoWidthChanged()
+{
+    doLayout();
+}
+
+/*!
+    Position the child widgets.
+*/
+void UiStackedAnalyzer::doLayout()
+{
+    UiSimpleAbstractSignal::doLayout();
+
+    QRect r = infoContentRect();
+    int y = r.top();
+
+    mIdLbl->move(r.left(), y);
+
+    int x = mIdLbl->pos().x()+mIdLbl->width() + SignalIdMarginRight;
+    mNameLbl->move(x, y);
+    mEditName->move(x, y);
+
+    mSourceLbl->move(r.left(), r.bottom()-mSourceLbl->height());
+}
+
+/*!
+    Calculate and return the minimum width for this widget.
+*/
+int UiStackedAnalyzer::calcMinimumWidth()
+{
+    int w = mNameLbl->pos().x() + mNameLbl->minimumSizeHint().width();
+    if (mEditName->isVisible()) {
+        w = mEditName->pos().x() + mEditName->width();
+    }
+
+    int w2 = mSourceLbl->pos().x()+mSourceLbl->width();
+    if (w2 > w) w = w2;
+
+    return w+infoContentMargin().right();
+}
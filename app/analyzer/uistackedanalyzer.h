@@ -0,0 +1,91 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UISTACKEDANALYZER_H
+#define UISTACKEDANALYZER_H
+
+#include "uianalyzer.h"
+
+#include <QLabel>
+#include <QPointer>
+#include <QStringList>
+
+#include "analyzerlayer.h"
+
+class UiStackedAnalyzer : public UiAnalyzer
+{
+    Q_OBJECT
+public:
+    explicit UiStackedAnalyzer(QWidget *parent = 0);
+
+    void setSourceName(const QString &name);
+    QString sourceName() const;
+    void setAddressBytes(int bytes) {mAddressBytes = bytes;}
+    int addressBytes() const {return mAddressBytes;}
+    void setDataFormat(Types::DataFormat format) {mFormat = format;}
+    Types::DataFormat dataFormat() const {return mFormat;}
+
+    UiCursor::CursorId syncCursor() const {return UiCursor::NoCursor;}
+    AnalyzerAnnotations annotations(SampleIndex fromIdx, SampleIndex toIdx);
+
+    void configure(QWidget* parent);
+
+    QString toSettingsString() const;
+
+signals:
+
+public slots:
+
+protected:
+    virtual QString layerName() const = 0;
+    virtual AnalyzerLayer* layer() = 0;
+    virtual bool acceptsSource(UiAnalyzer* analyzer) const = 0;
+    virtual QList<int> supportedAddressBytes() const = 0;
+
+    bool setSettings(const QStringList &list);
+
+    void showEvent(QShowEvent* event);
+
+    QSharedPointer<AnalyzerJob> createJob(int startIdx, int visibleFrom, int visibleTo, bool keepPrevious);
+
+private slots:
+    void handleSourceChanged();
+
+private:
+
+    enum {
+        SignalIdMarginRight = 10
+    };
+
+    QString mSourceName;
+    QPointer<UiAnalyzer> mSource;
+    int mAddressBytes;
+    Types::DataFormat mFormat;
+
+    QLabel* mSourceLbl;
+
+    bool mCacheValid;
+    SampleIndex mCacheFrom;
+    SampleIndex mCacheTo;
+    AnalyzerAnnotations mCache;
+
+    UiAnalyzer* source();
+
+    void infoWidthChanged();
+    void doLayout();
+    int calcMinimumWidth();
+};
+
+#endif // UISTACKEDANALYZER_H
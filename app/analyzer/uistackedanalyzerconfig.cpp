@@ -0,0 +1,139 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uistackedanalyzerconfig.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QLabel>
+
+#include "common/inputhelper.h"
+
+/*!
+    \class UiStackedAnalyzerConfig
+    \brief Dialog window used to configure a stacked analyzer.
+
+    \ingroup Analyzer
+
+    The dialog is shared by all UiStackedAnalyzer subclasses. The source
+    is chosen among the existing analyzers the layer can decode.
+*/
+
+
+/*!
+    Constructs the UiStackedAnalyzerConfig with the given \a parent.
+*/
+UiStackedAnalyzerConfig::UiStackedAnalyzerConfig(QWidget *parent) :
+    UiAnalyzerConfig(parent)
+{
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* formLayout = new QFormLayout;
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSourceBox = new QComboBox(this);
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QLabel* sourceLbl = new QLabel(tr("Decode: "), this);
+    sourceLbl->setToolTip(tr("The analyzer whose data is decoded"));
+    formLayout->addRow(sourceLbl, mSourceBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mAddressBox = new QComboBox(this);
+    formLayout->addRow(tr("Address bytes: "), mAddressBox);
+
+    mFormatBox = InputHelper::createFormatBox(this, Types::DataFormatHex);
+    formLayout->addRow(tr("Data format: "), mFormatBox);
+
+    // Deallocation: Ownership changed when calling setLayout
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Ok,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(accepted()), this, SLOT(accept()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(bottonBox);
+
+
+    setLayout(verticalLayout);
+}
+
+/*!
+    Returns the name of the analyzer to decode.
+*/
+QString UiStackedAnalyzerConfig::sourceName()
+{
+    return mSourceBox->currentText();
+}
+
+/*!
+    Returns the number of address bytes.
+*/
+int UiStackedAnalyzerConfig::addressBytes()
+{
+    return InputHelper::intValue(mAddressBox);
+}
+
+/*!
+    Returns the data format.
+*/
+Types::DataFormat UiStackedAnalyzerConfig::dataFormat()
+{
+    int f = InputHelper::intValue(mFormatBox);
+    return (Types::DataFormat)f;
+}
+
+/*!
+    Set the analyzers that can be decoded to \a names with \a selected
+    chosen.
+*/
+void UiStackedAnalyzerConfig::setSources(const QStringList &names, const QString &selected)
+{
+    mSourceBox->clear();
+    mSourceBox->addItems(names);
+
+    int idx = names.indexOf(selected);
+    if (idx >= 0) {
+        mSourceBox->setCurrentIndex(idx);
+    }
+}
+
+/*!
+    Set the \a supported number of address bytes with \a selected chosen.
+*/
+void UiStackedAnalyzerConfig::setAddressBytes(const QList<int> &supported, int selected)
+{
+    mAddressBox->clear();
+    foreach(int bytes, supported) {
+        mAddressBox->addItem(QString::number(bytes), QVariant(bytes));
+    }
+
+    InputHelper::setInt(mAddressBox, selected);
+}
+
+/*!
+    Set the data format to \a format.
+*/
+void UiStackedAnalyzerConfig::setDataFormat(Types::DataFormat format)
+{
+    InputHelper::setInt(mFormatBox, (int)format);
+}
@@ -0,0 +1,49 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UISTACKEDANALYZERCONFIG_H
+#define UISTACKEDANALYZERCONFIG_H
+
+#include <QWidget>
+#include <QDialog>
+#include <QComboBox>
+#include <QStringList>
+
+#include "uianalyzerconfig.h"
+
+class UiStackedAnalyzerConfig : public UiAnalyzerConfig
+{
+    Q_OBJECT
+public:
+    explicit UiStackedAnalyzerConfig(QWidget *parent = 0);
+    QString sourceName();
+    int addressBytes();
+    Types::DataFormat dataFormat();
+    void setSources(const QStringList &names, const QString &selected);
+    void setAddressBytes(const QList<int> &supported, int selected);
+    void setDataFormat(Types::DataFormat format);
+
+signals:
+
+public slots:
+
+private:
+    QComboBox* mSourceBox;
+    QComboBox* mAddressBox;
+    QComboBox* mFormatBox;
+
+};
+
+#endif // UISTACKEDANALYZERCONFIG_H
@@ -0,0 +1,364 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analogspectrum.h"
+
+#include <qmath.h>
+
+#include "common/instrumentation.h"
+
+/*!
+    \class AnalogSpectrum
+    \brief The power spectrum of (a part of) an analog signal.
+
+    \ingroup Capture
+
+    The AnalogSpectrum class estimates the spectrum of an analog signal
+    with Welch's method: the samples are split into segments of fftSize()
+    samples that overlap by half, each segment is multiplied with a window
+    function and transformed with RealFft, and the power of the segments is
+    averaged.
+
+    The segments are transformed in parallel with an AnalogSpectrumWork.
+    The default segment size, DefaultFftSize, keeps the samples and the
+    scratch buffers of one transform within the level 2 cache of a core.
+
+    The power of each bin is scaled so that a sine wave with the frequency
+    of the bin has its RMS value squared (V^2) in the bin, which makes
+    decibels() the level in dBV.
+*/
+
+/*!
+    Constructs an empty (invalid) spectrum.
+*/
+AnalogSpectrum::AnalogSpectrum()
+{
+    mFftSize = 0;
+    mNumSegments = 0;
+    mBinWidth = 0;
+}
+
+/*!
+    Computes the spectrum of the samples from \a fromIdx to \a toIdx
+    (inclusive) in \a data, sampled at \a sampleRate, using the given
+    \a window and segments of at most \a fftSize samples. The spectrum is
+    invalid if there are less than MinFftSize samples.
+*/
+void AnalogSpectrum::compute(const QVector<double> &data, SampleIndex fromIdx, SampleIndex toIdx,
+                             int sampleRate, Types::FftWindow window, int fftSize)
+{
+    *this = AnalogSpectrum();
+
+    fromIdx = qMax(fromIdx, (SampleIndex)0);
+    toIdx = qMin(toIdx, (SampleIndex)data.size()-1);
+    if (sampleRate <= 0 || toIdx < fromIdx) return;
+
+    SampleIndex numSamples = toIdx - fromIdx + 1;
+    int size = fftSizeFor(numSamples, fftSize);
+    if (size == 0) return;
+
+    int hop = size/2;
+    int numSegments = (int)((numSamples - size) / hop) + 1;
+
+    QVector<double> coeffs;
+    windowCoefficients(window, size, coeffs);
+
+    RealFft fft(size);
+
+    // a few work items per thread evens out the load
+    int count = qMin(numSegments, QThread::idealThreadCount()*4);
+
+    QSharedPointer<AnalyzerWork> work(new AnalogSpectrumWork(
+            data.constData() + fromIdx, numSegments, fft, coeffs, count));
+    AnalyzerWork::run(work);
+
+    const AnalogSpectrumWork* spectrumWork = static_cast<const AnalogSpectrumWork*>(work.data());
+
+    mPower.fill(0, size/2+1);
+    for (int i = 0; i < count; i++) {
+        const QVector<double> &sum = spectrumWork->sum(i);
+        for (int k = 0; k < mPower.size(); k++) {
+            mPower[k] += sum.at(k);
+        }
+    }
+
+    // the window reduces the amplitude by its coherent gain (the sum of
+    // the coefficients); the bins between DC and Nyquist hold half of the
+    // power of a real signal
+    double gain = 0;
+    for (int i = 0; i < size; i++) {
+        gain += coeffs.at(i);
+    }
+    double scale = 1/(gain*gain*numSegments);
+
+    for (int k = 0; k < mPower.size(); k++) {
+        mPower[k] *= scale;
+        if (k != 0 && k != mPower.size()-1) {
+            mPower[k] *= 2;
+        }
+    }
+
+    mFftSize = size;
+    mNumSegments = numSegments;
+    mBinWidth = (double)sampleRate/size;
+}
+
+/*!
+    Returns the average of the \a spectra, which must all be compatible
+    (see isCompatible()). Spectra that aren't compatible with the last one
+    are ignored.
+*/
+AnalogSpectrum AnalogSpectrum::average(const QList<AnalogSpectrum> &spectra)
+{
+    if (spectra.isEmpty()) return AnalogSpectrum();
+
+    AnalogSpectrum result = spectra.last();
+    int num = 1;
+
+    for (int i = 0; i < spectra.size()-1; i++) {
+        const AnalogSpectrum &s = spectra.at(i);
+        if (!s.isCompatible(result)) continue;
+
+        for (int k = 0; k < result.mPower.size(); k++) {
+            result.mPower[k] += s.mPower.at(k);
+        }
+        num++;
+    }
+
+    for (int k = 0; k < result.mPower.size(); k++) {
+        result.mPower[k] /= num;
+    }
+
+    return result;
+}
+
+/*!
+    \fn bool AnalogSpectrum::isValid() const
+
+    Returns true if the spectrum has been computed.
+*/
+
+/*!
+    \fn int AnalogSpectrum::fftSize() const
+
+    Returns the number of samples in each transformed segment.
+*/
+
+/*!
+    \fn int AnalogSpectrum::numSegments() const
+
+    Returns the number of segments the power has been averaged over.
+*/
+
+/*!
+    \fn double AnalogSpectrum::binWidth() const
+
+    Returns the frequency difference, in Hz, between two bins.
+*/
+
+/*!
+    \fn int AnalogSpectrum::numBins() const
+
+    Returns the number of bins, from DC to half the sample rate.
+*/
+
+/*!
+    \fn const QVector<double> &AnalogSpectrum::power() const
+
+    Returns the power of each bin in V^2.
+*/
+
+/*!
+    Returns the level of \a bin in dBV.
+*/
+double AnalogSpectrum::decibels(int bin) const
+{
+    // limit to -300 dB instead of returning -infinity for silent bins
+    return 10*log10(qMax(mPower.at(bin), 1e-30));
+}
+
+/*!
+    Returns true if this spectrum has the same bins as \a other so that
+    they can be averaged.
+*/
+bool AnalogSpectrum::isCompatible(const AnalogSpectrum &other) const
+{
+    return mFftSize == other.mFftSize && mBinWidth == other.mBinWidth;
+}
+
+/*!
+    Returns the FFT size to use for \a numSamples samples: the largest
+    power of two that is at most \a maxSize and at most \a numSamples, or
+    0 if that would be less than MinFftSize.
+*/
+int AnalogSpectrum::fftSizeFor(SampleIndex numSamples, int maxSize)
+{
+    int size = MinFftSize;
+    if (numSamples < size) return 0;
+
+    while (size*2 <= maxSize && size*2 <= MaxFftSize && size*2 <= numSamples) {
+        size *= 2;
+    }
+
+    return size;
+}
+
+/*!
+    Fills \a coeffs with the \a size coefficients of \a window.
+*/
+void AnalogSpectrum::windowCoefficients(Types::FftWindow window, int size, QVector<double> &coeffs)
+{
+    coeffs.resize(size);
+
+    // sum of cosines, a0 - a1*cos(x) + a2*cos(2x) - a3*cos(3x) + a4*cos(4x)
+    double a[5] = {1, 0, 0, 0, 0};
+
+    switch (window) {
+    case Types::FftWindowHann:
+        a[0] = 0.5;
+        a[1] = 0.5;
+        break;
+    case Types::FftWindowBlackman:
+        a[0] = 0.42;
+        a[1] = 0.5;
+        a[2] = 0.08;
+        break;
+    case Types::FftWindowFlatTop:
+        a[0] = 0.21557895;
+        a[1] = 0.41663158;
+        a[2] = 0.277263158;
+        a[3] = 0.083578947;
+        a[4] = 0.006947368;
+        break;
+    default:
+        break;
+    }
+
+    for (int i = 0; i < size; i++) {
+        double x = 2*M_PI*i/size;
+        coeffs[i] = a[0] - a[1]*qCos(x) + a[2]*qCos(2*x) - a[3]*qCos(3*x) + a[4]*qCos(4*x);
+    }
+}
+
+
+/*!
+    \class AnalogSpectrumWork
+    \brief Transforms the segments of an AnalogSpectrum on several threads.
+
+    \ingroup Capture
+
+    The segments are divided into a number of work items of consecutive
+    segments. Each item sums the power of its segments into its own
+    vector, so the threads never write to the same memory.
+*/
+
+/*!
+    Constructs work transforming \a numSegments segments, overlapping by
+    half, of the samples starting at \a data with \a fft and \a window.
+    The segments are divided into \a count work items.
+*/
+AnalogSpectrumWork::AnalogSpectrumWork(const double* data, int numSegments,
+                                       const RealFft &fft, const QVector<double> &window,
+                                       int count) :
+    AnalyzerWork(count),
+    mFft(fft),
+    mWindow(window)
+{
+    mData = data;
+    mNumSegments = numSegments;
+    mSums.resize(count);
+}
+
+/*!
+    \fn const QVector<double> &AnalogSpectrumWork::sum(int index) const
+
+    Returns the summed power of the segments of work item \a index.
+*/
+
+/*!
+    Transforms the segments of work item \a index.
+*/
+void AnalogSpectrumWork::process(int index)
+{
+    int size = mFft.size();
+    int hop = size/2;
+    int count = mSums.size();
+    int first = (int)(((qint64)mNumSegments * index) / count);
+    int last = (int)(((qint64)mNumSegments * (index+1)) / count);
+
+    QVector<double> samples(size);
+    QVector<double> power(size/2+1);
+    QVector<double> &sum = mSums[index];
+    sum.fill(0, size/2+1);
+
+    for (int s = first; s < last; s++) {
+        const double* in = mData + (qint64)s*hop;
+        for (int i = 0; i < size; i++) {
+            samples[i] = in[i]*mWindow.at(i);
+        }
+
+        mFft.powerSpectrum(samples.constData(), power.data());
+
+        for (int k = 0; k < power.size(); k++) {
+            sum[k] += power.at(k);
+        }
+    }
+}
+
+
+/*!
+    \class AnalogSpectrumJob
+    \brief Computes an AnalogSpectrum on a worker thread.
+
+    \ingroup Capture
+
+    The job is a BackgroundJob and emits finished() when the spectrum is
+    available. It works on a copy of the signal data, which
+    shares its data with the capture device (implicit sharing) and
+    therefore stays valid while the job runs.
+*/
+
+/*!
+    Constructs a job computing the spectrum of \a data from \a fromIdx to
+    \a toIdx. See AnalogSpectrum::compute() for \a sampleRate, \a window
+    and \a fftSize.
+*/
+AnalogSpectrumJob::AnalogSpectrumJob(const QVector<double> &data, SampleIndex fromIdx,
+                                     SampleIndex toIdx, int sampleRate,
+                                     Types::FftWindow window, int fftSize)
+{
+    mData = data;
+    mFromIdx = fromIdx;
+    mToIdx = toIdx;
+    mSampleRate = sampleRate;
+    mWindow = window;
+    mFftSize = fftSize;
+}
+
+/*!
+    Computes the spectrum.
+*/
+void AnalogSpectrumJob::execute()
+{
+    InstrumentationTimer timer("Spectrum");
+    mSpectrum.compute(mData, mFromIdx, mToIdx, mSampleRate, mWindow, mFftSize);
+    mData.clear();
+}
+
+/*!
+    \fn const AnalogSpectrum &AnalogSpectrumJob::spectrum() const
+
+    Returns the spectrum. Only valid after finished() has been emitted.
+*/
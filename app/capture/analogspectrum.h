@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALOGSPECTRUM_H
+#define ANALOGSPECTRUM_H
+
+#include <QVector>
+#include <QList>
+
+#include "fft.h"
+#include "analyzer/analyzerjob.h"
+#include "common/backgroundjob.h"
+#include "common/sampletime.h"
+#include "common/types.h"
+
+class AnalogSpectrum
+{
+public:
+
+    enum Constants {
+        MinFftSize = 16,
+        DefaultFftSize = 4096,
+        MaxFftSize = 65536
+    };
+
+    AnalogSpectrum();
+
+    bool isValid() const {return !mPower.isEmpty();}
+
+    void compute(const QVector<double> &data, SampleIndex fromIdx, SampleIndex toIdx,
+                 int sampleRate, Types::FftWindow window, int fftSize);
+    static AnalogSpectrum average(const QList<AnalogSpectrum> &spectra);
+
+    int fftSize() const {return mFftSize;}
+    int numSegments() const {return mNumSegments;}
+    double binWidth() const {return mBinWidth;}
+    int numBins() const {return mPower.size();}
+    const QVector<double> &power() const {return mPower;}
+    double decibels(int bin) const;
+    bool isCompatible(const AnalogSpectrum &other) const;
+
+    static int fftSizeFor(SampleIndex numSamples, int maxSize);
+    static void windowCoefficients(Types::FftWindow window, int size, QVector<double> &coeffs);
+
+private:
+    int mFftSize;
+    int mNumSegments;
+    double mBinWidth;
+    QVector<double> mPower;
+};
+
+class AnalogSpectrumWork : public AnalyzerWork
+{
+public:
+    AnalogSpectrumWork(const double* data, int numSegments, const RealFft &fft,
+                       const QVector<double> &window, int count);
+
+    const QVector<double> &sum(int index) const {return mSums.at(index);}
+
+protected:
+    void process(int index);
+
+private:
+    const double* mData;
+    int mNumSegments;
+    const RealFft &mFft;
+    const QVector<double> &mWindow;
+    QVector<QVector<double> > mSums;
+};
+
+class AnalogSpectrumJob : public BackgroundJob
+{
+    Q_OBJECT
+public:
+    AnalogSpectrumJob(const QVector<double> &data, SampleIndex fromIdx, SampleIndex toIdx,
+                      int sampleRate, Types::FftWindow window, int fftSize);
+
+    const AnalogSpectrum &spectrum() const {return mSpectrum;}
+
+protected:
+    void execute();
+
+private:
+    QVector<double> mData;
+    SampleIndex mFromIdx;
+    SampleIndex mToIdx;
+    int mSampleRate;
+    Types::FftWindow mWindow;
+    int mFftSize;
+    AnalogSpectrum mSpectrum;
+};
+
+#endif // ANALOGSPECTRUM_H
@@ -22,11 +22,13 @@
 #include "uiselectsignaldialog.h"
 #include "cursormanager.h"
 #include "uicaptureexporter.h"
+#include "uimathsignal.h"
 
 #include "device/devicemanager.h"
 #include "analyzer/analyzermanager.h"
 #include "common/configuration.h"
 #include "common/stringutil.h"
+#include "common/instrumentation.h"
 
 /*!
     \class CaptureApp
@@ -60,6 +62,8 @@ CaptureApp::CaptureApp(QWidget* uiContext, QObject *parent) :
     mArea = new UiCaptureArea(mSignalManager, uiContext);
 
     mMenu = NULL;
+    mStatisticsDialog = NULL;
+    mSpectrumDialog = NULL;
 
     createToolBar();
     createMenu();
@@ -151,7 +155,7 @@ void CaptureApp::openProject(QSettings &project)
         project.beginGroup("capture");
 
         int sampleRate = project.value("sampleRate", 1).toInt();
-        int digTrigger = project.value("digitalTrigger", 0).toInt();
+        SampleIndex digTrigger = project.value("digitalTrigger", 0).toLongLong();
 
         captureDevice->setUsedSampleRate(sampleRate);
         setSampleRate(sampleRate);
@@ -167,6 +171,14 @@ void CaptureApp::openProject(QSettings &project)
 
         mSignalManager->loadSignalsFromSettings(project, in);
 
+        // analog signals that don't start at the same time as the
+        // digital signals
+        foreach(AnalogSignal* s, captureDevice->analogSignals()) {
+            QString key = QString("analogTimeOffset%1").arg(s->id());
+            captureDevice->setAnalogTimeOffset(s->id(),
+                                               project.value(key, 0.0).toDouble());
+        }
+
         // cursor positions
 
         int numCursors = project.beginReadArray("cursors");
@@ -247,6 +259,14 @@ void CaptureApp::saveProject(QSettings &project)
                          captureDevice->digitalTriggerIndex());
         mSignalManager->saveSignalSettings(project, out);
 
+        foreach(AnalogSignal* s, captureDevice->analogSignals()) {
+            double offset = captureDevice->analogTimeOffset(s->id());
+            if (offset != 0.0) {
+                project.setValue(QString("analogTimeOffset%1").arg(s->id()),
+                                 offset);
+            }
+        }
+
         // save cursor positions
         project.beginWriteArray("cursors");
         int idx = 0;
@@ -441,6 +461,17 @@ void CaptureApp::createMenu()
     connect(action, SIGNAL(triggered()), this, SLOT(calibrationSettings()));
     mMenu->addAction(action);
 
+    //
+    //    Diagnostics
+    //
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Hardware Diagnostics"), this);
+    action->setData("Hardware Diagnostics");
+    action->setToolTip("Show performance counters for the last capture");
+    connect(action, SIGNAL(triggered()), this, SLOT(diagnostics()));
+    mMenu->addAction(action);
+
     //
     //    Export Data
     //
@@ -454,6 +485,28 @@ void CaptureApp::createMenu()
     connect(action, SIGNAL(triggered()), this, SLOT(exportData()));
     mMenu->addAction(action);
 
+    //
+    //    Digital Statistics
+    //
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Digital Statistics"), this);
+    action->setData("Digital Statistics");
+    action->setToolTip("Pulse width and period statistics of a digital signal");
+    connect(action, SIGNAL(triggered()), this, SLOT(digitalStatistics()));
+    mMenu->addAction(action);
+
+    //
+    //    Spectrum
+    //
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Spectrum"), this);
+    action->setData("Spectrum");
+    action->setToolTip("Frequency spectrum of an analog signal");
+    connect(action, SIGNAL(triggered()), this, SLOT(spectrum()));
+    mMenu->addAction(action);
+
 }
 
 /*!
@@ -486,14 +539,18 @@ void CaptureApp::changeCaptureActions(bool captureActive) {
 
 /*!
     Request the capture device to start a capture based on the current
-    configuration.
+    configuration. The device is asked to configure itself first if
+    \a configure is true, which is only needed once for each continuous
+    capture.
 */
-void CaptureApp::doStart()
+void CaptureApp::doStart(bool configure)
 {
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
 
-    device->configureBeforeStart(mUiContext);
+    if (configure) {
+        device->configureBeforeStart(mUiContext);
+    }
     int rate = mRateBox->itemData(mRateBox->currentIndex()).toInt();
     device->start(rate);
 }
@@ -573,6 +630,7 @@ void CaptureApp::startContinuous()
         mContinuous = true;
         changeCaptureActions(true);
 
+        device->captureDevice()->setContinuous(true);
         doStart();
     }
     else {
@@ -596,6 +654,7 @@ void CaptureApp::stop()
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
     if (device != NULL) {
+        device->setContinuous(false);
         device->stop();
     }
 }
@@ -617,15 +676,21 @@ void CaptureApp::handleCaptureFinished(bool successful, QString  msg)
     if (device != NULL) {
 
         if (successful) {
-            mArea->handleSignalDataChanged();
+            {
+                InstrumentationTimer timer("Update capture area");
+                mArea->handleSignalDataChanged();
+            }
 
-            if (mContinuous && device->supportsContinuousCapture()) {
-                doStart();
+            // a pipelined device has already started the next capture
+            if (mContinuous && device->supportsContinuousCapture()
+                    && !device->supportsPipelinedCapture()) {
+                doStart(false);
             }
         }
         else {
             // always make sure continuous mode is reset if capture fails.
             mContinuous = false;
+            device->setContinuous(false);
 
             QMessageBox::warning(mUiContext,
                                  tr("Capture Failed"),
@@ -663,6 +728,19 @@ void CaptureApp::calibrationSettings()
     }
 }
 
+/*!
+    Called when the user selects to show the hardware diagnostics.
+*/
+void CaptureApp::diagnostics()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+
+    if (device != NULL) {
+        device->showDiagnostics(mUiContext);
+    }
+}
+
 /*!
     Called when the user selects to enable more signals.
 */
@@ -683,6 +761,19 @@ void CaptureApp::selectSignalsToAdd()
             mSignalManager->addAnalyzer(analyzer);
         }
 
+        if (dialog.mathSignalSelected()) {
+            // Deallocation: Deleted below if it isn't configured; otherwise
+            //   by SignalManager when it is closed
+            UiMathSignal* signal = new UiMathSignal();
+            signal->configure(mUiContext);
+            if (signal->isValid()) {
+                mSignalManager->addMathSignal(signal);
+            }
+            else {
+                delete signal;
+            }
+        }
+
         QList<int> digitalIds = dialog.selectedDigitalSignals();
         foreach(int id, digitalIds) {
             mSignalManager->addDigitalSignal(id);
@@ -747,6 +838,36 @@ void CaptureApp::exportData()
 
 }
 
+/*!
+    Show the digital statistics dialog.
+*/
+void CaptureApp::digitalStatistics()
+{
+    if (mStatisticsDialog == NULL) {
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        mStatisticsDialog = new UiDigitalStatisticsDialog(mUiContext);
+    }
+
+    mStatisticsDialog->show();
+    mStatisticsDialog->raise();
+    mStatisticsDialog->activateWindow();
+}
+
+/*!
+    Show the spectrum dialog.
+*/
+void CaptureApp::spectrum()
+{
+    if (mSpectrumDialog == NULL) {
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        mSpectrumDialog = new UiSpectrumDialog(mUiContext);
+    }
+
+    mSpectrumDialog->show();
+    mSpectrumDialog->raise();
+    mSpectrumDialog->activateWindow();
+}
+
 /*!
     Called when the sample rate has changed.
 */
@@ -24,6 +24,8 @@
 #include <QSettings>
 
 #include "uicapturearea.h"
+#include "uidigitalstatisticsdialog.h"
+#include "uispectrumdialog.h"
 #include "device/device.h"
 
 class CaptureApp : public QObject
@@ -67,13 +69,15 @@ private:
     QAction* mTbStopAction;
 
     QComboBox* mRateBox;
+    UiDigitalStatisticsDialog* mStatisticsDialog;
+    UiSpectrumDialog* mSpectrumDialog;
 
     bool mCaptureActive;
 
     void createToolBar();
     void createMenu();
     void changeCaptureActions(bool captureActive);
-    void doStart();
+    void doStart(bool configure = true);
     void setupRates(CaptureDevice* device);
     void setSampleRate(int rate);
 
@@ -85,8 +89,11 @@ private slots:
     void handleCaptureFinished(bool successful, QString msg);
     void triggerSettings();
     void calibrationSettings();
+    void diagnostics();
     void selectSignalsToAdd();
     void exportData();
+    void digitalStatistics();
+    void spectrum();
     void sampleRateChanged(int rateIndex);
 
     
@@ -110,3 +110,19 @@ void CursorManager::enableCursor(UiCursor::CursorId id, bool enable)
 
     mUiCursor->enableCursor(id, enable);
 }
+
+/*!
+    Returns the index of the sample nearest to cursor \a id in a signal
+    sampled at \a sampleRate whose first sample is at \a timeOffset, see
+    CaptureDevice::analogTimeOffset(). \a defaultIdx is returned if \a id
+    is UiCursor::NoCursor or the cursor isn't enabled.
+*/
+SampleIndex CursorManager::cursorSampleIndex(UiCursor::CursorId id, int sampleRate,
+                                             double timeOffset, SampleIndex defaultIdx)
+{
+    if (id == UiCursor::NoCursor || !isCursorOn(id)) return defaultIdx;
+
+    double t = cursorPosition(id) - timeOffset;
+
+    return qMax((SampleIndex)0, SampleTime::nearestSample(t, sampleRate));
+}
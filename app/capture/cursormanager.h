@@ -18,6 +18,7 @@
 
 #include <QObject>
 #include "uicursor.h"
+#include "common/sampletime.h"
 
 class CursorManager
 {
@@ -36,6 +37,8 @@ public:
     void setCursorPosition(UiCursor::CursorId id, double pos);
     bool isCursorOn(UiCursor::CursorId id);
     void enableCursor(UiCursor::CursorId id, bool enable);
+    SampleIndex cursorSampleIndex(UiCursor::CursorId id, int sampleRate,
+                                  double timeOffset, SampleIndex defaultIdx);
     
 signals:
 
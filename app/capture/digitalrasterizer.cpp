@@ -0,0 +1,203 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "digitalrasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*!
+    \class DigitalRasterizer
+    \brief Draws a digital signal into an image one pixel column at a time.
+
+    \ingroup Capture
+
+    Drawing a line per transition with QPainter gets slow when a signal has
+    many more transitions than there are pixels, e.g. a fast clock in a
+    zoomed out view, and most of the lines end up on top of each other. The
+    DigitalRasterizer instead finds the state of each pixel column in one
+    pass over the columns:
+
+    - ColumnLow or ColumnHigh when the signal doesn't change in the column
+    - ColumnEdge when it changes once, drawn as a vertical line
+    - ColumnBusy when it changes more than once, drawn as a filled bar the
+      way logic analyzers usually show a signal that is too fast to see
+
+    The transitions in a column are counted with a binary search from the
+    end of the previous column, so the cost depends on the width of the
+    view and hardly at all on the number of transitions. The image is then
+    drawn row by row where each row is a number of spans filled with one
+    value.
+
+    The image is kept between calls to avoid an allocation per paint.
+*/
+
+/*!
+    Constructs a rasterizer without any columns.
+*/
+DigitalRasterizer::DigitalRasterizer()
+{
+}
+
+/*!
+    Finds the state of \a numColumns pixel columns from the \a transitions
+    of a signal sampled at \a sampleRate. The first column starts at
+    \a startTime and each column is \a columnTime seconds wide.
+
+    The \a transitions are in the format of
+    CaptureDevice::digitalTransitions(): the level of the first sample,
+    the indices of the samples where the signal changes and the index of
+    the last sample.
+*/
+void DigitalRasterizer::resolve(const QVector<SampleIndex> &transitions, int sampleRate,
+                                double startTime, double columnTime, int numColumns)
+{
+    mStates.fill(ColumnEmpty, qMax(0, numColumns));
+
+    if (transitions.size() < 2 || sampleRate <= 0 || columnTime <= 0) return;
+
+    int firstLevel = (int)transitions.at(0);
+    SampleIndex lastSample = transitions.last();
+
+    // the transitions are between the first and last entries
+    QVector<SampleIndex>::const_iterator begin = transitions.constBegin() + 1;
+    QVector<SampleIndex>::const_iterator end = transitions.constEnd() - 1;
+    QVector<SampleIndex>::const_iterator it = begin;
+
+    SampleIndex from = firstSampleAt(startTime, sampleRate);
+
+    for (int col = 0; col < numColumns; col++) {
+        SampleIndex to = firstSampleAt(startTime + (col+1)*columnTime, sampleRate);
+
+        // the column is outside of the signal data
+        if (to <= 0) {
+            from = to;
+            continue;
+        }
+        if (from > lastSample) break;
+
+        // transitions before the column
+        it = std::lower_bound(it, end, from);
+        QVector<SampleIndex>::const_iterator next = std::lower_bound(it, end, to);
+
+        int edges = next - it;
+        if (edges == 0) {
+            int level = firstLevel ^ ((it - begin) & 1);
+            mStates[col] = (level != 0) ? ColumnHigh : ColumnLow;
+        }
+        else {
+            mStates[col] = (edges == 1) ? ColumnEdge : ColumnBusy;
+        }
+
+        it = next;
+        from = to;
+    }
+}
+
+/*!
+    \fn ColumnState DigitalRasterizer::state(int column) const
+
+    Returns the state of \a column found by \ref resolve.
+*/
+
+/*!
+    Draws the columns found by \ref resolve into an image of the given
+    \a height and returns it. The high level is drawn at \a yHigh and the
+    low level at \a yLow, both with \a color. Busy columns are filled with
+    a lighter version of \a color between the two levels.
+*/
+const QImage &DigitalRasterizer::render(int height, int yHigh, int yLow, const QColor &color)
+{
+    int width = mStates.size();
+
+    if (mImage.width() != width || mImage.height() != height) {
+        mImage = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+    }
+    mImage.fill(0);
+
+    if (width == 0) return mImage;
+
+    QRgb solid = premultiplied(color, 255);
+    QRgb light = premultiplied(color, 96);
+
+    // the value of each column state in the three kinds of rows
+    const QRgb highRow[NumColumnStates] = {0, 0, solid, solid, solid};
+    const QRgb lowRow[NumColumnStates] = {0, solid, 0, solid, solid};
+    const QRgb middleRow[NumColumnStates] = {0, 0, 0, solid, light};
+
+    yHigh = qBound(0, yHigh, height-1);
+    yLow = qBound(0, yLow, height-1);
+
+    for (int y = yHigh; y <= yLow; y++) {
+        if (y == yHigh) {
+            fillRow(y, highRow);
+        }
+        else if (y == yLow) {
+            fillRow(y, lowRow);
+        }
+        else {
+            fillRow(y, middleRow);
+        }
+    }
+
+    return mImage;
+}
+
+/*!
+    Returns the index of the first sample at or after the time \a seconds
+    when sampling at \a sampleRate Hz. A transition at that sample belongs
+    to the pixel column starting at \a seconds.
+*/
+SampleIndex DigitalRasterizer::firstSampleAt(double seconds, int sampleRate)
+{
+    return -SampleTime::fromSeconds(-seconds, sampleRate);
+}
+
+/*!
+    Returns \a color with the given \a alpha as a premultiplied pixel value.
+*/
+QRgb DigitalRasterizer::premultiplied(const QColor &color, int alpha)
+{
+    return qRgba(color.red()*alpha/255,
+                 color.green()*alpha/255,
+                 color.blue()*alpha/255,
+                 alpha);
+}
+
+/*!
+    Fills row \a y of the image with spans of the same value, where
+    \a values gives the value of each column state.
+*/
+void DigitalRasterizer::fillRow(int y, const QRgb* values)
+{
+    QRgb* line = (QRgb*)mImage.scanLine(y);
+    int width = mStates.size();
+
+    int start = 0;
+    while (start < width) {
+        QRgb value = values[mStates.at(start)];
+
+        int stop = start + 1;
+        while (stop < width && values[mStates.at(stop)] == value) {
+            stop++;
+        }
+
+        // the image is already cleared
+        if (value != 0) {
+            std::fill(line + start, line + stop, value);
+        }
+        start = stop;
+    }
+}
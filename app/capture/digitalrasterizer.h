@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DIGITALRASTERIZER_H
+#define DIGITALRASTERIZER_H
+
+#include <QVector>
+#include <QImage>
+#include <QColor>
+
+#include "common/sampletime.h"
+
+class DigitalRasterizer
+{
+public:
+
+    enum ColumnState {
+        ColumnEmpty,
+        ColumnLow,
+        ColumnHigh,
+        ColumnEdge,
+        ColumnBusy,
+        NumColumnStates // must be last
+    };
+
+    DigitalRasterizer();
+
+    void resolve(const QVector<SampleIndex> &transitions, int sampleRate,
+                 double startTime, double columnTime, int numColumns);
+    ColumnState state(int column) const {return (ColumnState)mStates.at(column);}
+    const QImage &render(int height, int yHigh, int yLow, const QColor &color);
+
+private:
+    QVector<quint8> mStates;
+    QImage mImage;
+
+    static SampleIndex firstSampleAt(double seconds, int sampleRate);
+    static QRgb premultiplied(const QColor &color, int alpha);
+    void fillRow(int y, const QRgb* values);
+};
+
+#endif // DIGITALRASTERIZER_H
@@ -0,0 +1,380 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "digitalstatistics.h"
+
+#include <qmath.h>
+
+#include "device/capturedevice.h"
+#include "common/instrumentation.h"
+
+/*!
+    \class DigitalStatistics
+    \brief Pulse width and period statistics of a digital signal.
+
+    \ingroup Capture
+
+    The DigitalStatistics class summarizes a digital signal from its list
+    of transitions (see CaptureDevice::digitalTransitions()) between two
+    sample indexes. A high pulse is measured from a rising edge to the
+    next falling edge, a low pulse from a falling edge to the next rising
+    edge and a period from a rising edge to the next rising edge. Only
+    pulses and periods that start and end within the range are counted.
+
+    The edges in the range are visited once to find the number of edges
+    and the minimum, maximum, mean and standard deviation of the widths.
+    The standard deviation of the period is the (RMS) period jitter. A
+    second visit sorts the pulse widths into a histogram of
+    NumHistogramBins bins from the shortest to the longest pulse.
+
+    All widths are in samples.
+*/
+
+/*!
+    \struct DigitalStatistics::Summary
+    \brief Number, minimum, maximum, mean and standard deviation of a set
+    of widths.
+*/
+
+/*!
+    Constructs an empty (invalid) statistics object.
+*/
+DigitalStatistics::DigitalStatistics()
+{
+    mValid = false;
+    mFromIdx = 0;
+    mToIdx = 0;
+    mNumRising = 0;
+    mNumFalling = 0;
+    clearSummary(mHigh);
+    clearSummary(mLow);
+    clearSummary(mPeriod);
+    mHistogramStart = 0;
+    mHistogramBinWidth = 1;
+}
+
+/*!
+    Computes the statistics of the signal with the given \a transitions for
+    the samples from \a fromIdx to \a toIdx (inclusive).
+*/
+void DigitalStatistics::compute(const QVector<SampleIndex> &transitions,
+                                SampleIndex fromIdx, SampleIndex toIdx)
+{
+    *this = DigitalStatistics();
+    mFromIdx = fromIdx;
+    mToIdx = toIdx;
+
+    // [0] = start level, [1..size-2] = transitions, [size-1] = last index
+    if (transitions.size() < 2) return;
+
+    int first = firstEdge(transitions, fromIdx);
+    int end = transitions.size()-1;
+    int startLevel = (int)transitions.at(0);
+
+    double highSquares = 0;
+    double lowSquares = 0;
+    double periodSquares = 0;
+    SampleIndex prevEdge = -1;
+    SampleIndex prevRising = -1;
+
+    for (int i = first; i < end; i++) {
+        SampleIndex edge = transitions.at(i);
+        if (edge > toIdx) break;
+
+        // the level after transition i
+        bool rising = (((startLevel ^ i) & 1) != 0);
+
+        if (rising) {
+            mNumRising++;
+            if (prevEdge != -1) {
+                addToSummary(mLow, lowSquares, edge - prevEdge);
+            }
+            if (prevRising != -1) {
+                addToSummary(mPeriod, periodSquares, edge - prevRising);
+            }
+            prevRising = edge;
+        }
+        else {
+            mNumFalling++;
+            if (prevEdge != -1) {
+                addToSummary(mHigh, highSquares, edge - prevEdge);
+            }
+        }
+
+        prevEdge = edge;
+    }
+
+    finishSummary(mHigh, highSquares);
+    finishSummary(mLow, lowSquares);
+    finishSummary(mPeriod, periodSquares);
+
+    mValid = true;
+
+    //
+    //  histogram of the pulse widths
+    //
+
+    if (mHigh.count == 0 && mLow.count == 0) return;
+
+    SampleIndex minWidth = mHigh.min;
+    SampleIndex maxWidth = mHigh.max;
+    if (mHigh.count == 0 || (mLow.count > 0 && mLow.min < minWidth)) {
+        minWidth = mLow.min;
+    }
+    if (mHigh.count == 0 || (mLow.count > 0 && mLow.max > maxWidth)) {
+        maxWidth = mLow.max;
+    }
+
+    mHistogramStart = minWidth;
+    mHistogramBinWidth = (maxWidth - minWidth) / NumHistogramBins + 1;
+    mHighHistogram.fill(0, NumHistogramBins);
+    mLowHistogram.fill(0, NumHistogramBins);
+
+    prevEdge = -1;
+    for (int i = first; i < end; i++) {
+        SampleIndex edge = transitions.at(i);
+        if (edge > toIdx) break;
+
+        if (prevEdge != -1) {
+            int bin = (int)((edge - prevEdge - mHistogramStart) / mHistogramBinWidth);
+            bool rising = (((startLevel ^ i) & 1) != 0);
+            if (rising) {
+                mLowHistogram[bin]++;
+            }
+            else {
+                mHighHistogram[bin]++;
+            }
+        }
+
+        prevEdge = edge;
+    }
+}
+
+/*!
+    \fn bool DigitalStatistics::isValid() const
+
+    Returns true if the statistics have been computed.
+*/
+
+/*!
+    \fn SampleIndex DigitalStatistics::fromIdx() const
+
+    Returns the first sample of the range the statistics cover.
+*/
+
+/*!
+    \fn SampleIndex DigitalStatistics::toIdx() const
+
+    Returns the last sample of the range the statistics cover.
+*/
+
+/*!
+    \fn int DigitalStatistics::numRisingEdges() const
+
+    Returns the number of rising edges in the range.
+*/
+
+/*!
+    \fn int DigitalStatistics::numFallingEdges() const
+
+    Returns the number of falling edges in the range.
+*/
+
+/*!
+    \fn const Summary &DigitalStatistics::highWidth() const
+
+    Returns the summary of the widths of the high pulses.
+*/
+
+/*!
+    \fn const Summary &DigitalStatistics::lowWidth() const
+
+    Returns the summary of the widths of the low pulses.
+*/
+
+/*!
+    \fn const Summary &DigitalStatistics::period() const
+
+    Returns the summary of the periods (rising edge to rising edge).
+*/
+
+/*!
+    Returns the mean duty cycle in percent, calculated from the mean widths
+    of the high and low pulses, or -1 if there are no complete high and low
+    pulses.
+*/
+double DigitalStatistics::dutyCycle() const
+{
+    if (mHigh.count == 0 || mLow.count == 0) return -1;
+
+    return mHigh.mean * 100 / (mHigh.mean + mLow.mean);
+}
+
+/*!
+    \fn SampleIndex DigitalStatistics::histogramStart() const
+
+    Returns the width of the shortest pulse, which is where the first bin
+    of the histograms starts.
+*/
+
+/*!
+    \fn SampleIndex DigitalStatistics::histogramBinWidth() const
+
+    Returns the width, in samples, of a bin in the histograms.
+*/
+
+/*!
+    \fn const QVector<int> &DigitalStatistics::highHistogram() const
+
+    Returns the number of high pulses in each histogram bin. The vector is
+    empty if there are no complete pulses.
+*/
+
+/*!
+    \fn const QVector<int> &DigitalStatistics::lowHistogram() const
+
+    Returns the number of low pulses in each histogram bin. The vector is
+    empty if there are no complete pulses.
+*/
+
+/*!
+    Resets the summary \a s.
+*/
+void DigitalStatistics::clearSummary(Summary &s)
+{
+    s.count = 0;
+    s.min = 0;
+    s.max = 0;
+    s.mean = 0;
+    s.deviation = 0;
+}
+
+/*!
+    Adds \a width to the summary \a s. The mean is updated incrementally
+    (Welford's method) and the sum of squared differences from the mean
+    is accumulated in \a sumSquares, which keeps the deviation accurate
+    also for long captures with many nearly equal widths.
+*/
+void DigitalStatistics::addToSummary(Summary &s, double &sumSquares, SampleIndex width)
+{
+    if (s.count == 0 || width < s.min) s.min = width;
+    if (s.count == 0 || width > s.max) s.max = width;
+
+    s.count++;
+    double delta = width - s.mean;
+    s.mean += delta / s.count;
+    sumSquares += delta * (width - s.mean);
+}
+
+/*!
+    Calculates the standard deviation of the summary \a s from the sum of
+    squared differences \a sumSquares.
+*/
+void DigitalStatistics::finishSummary(Summary &s, double sumSquares)
+{
+    if (s.count > 0) {
+        s.deviation = qSqrt(sumSquares / s.count);
+    }
+}
+
+/*!
+    Returns the position in \a transitions of the first transition at or
+    after \a fromIdx.
+*/
+int DigitalStatistics::firstEdge(const QVector<SampleIndex> &transitions, SampleIndex fromIdx)
+{
+    // binary search among the transitions at positions 1..size-2
+    int lo = 1;
+    int hi = transitions.size()-1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (transitions.at(mid) < fromIdx) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+
+/*!
+    \class DigitalStatisticsJob
+    \brief Computes DigitalStatistics on a worker thread.
+
+    \ingroup Capture
+
+    The job is a BackgroundJob and emits finished() when the statistics
+    are available. If it is given a transition list it is
+    used as it is, otherwise the list is first created from a copy of the
+    signal data, which shares its data with the capture device (implicit
+    sharing) and therefore stays valid while the job runs. The list is
+    kept by the job so that it can be reused for another range of the same
+    capture.
+*/
+
+/*!
+    Constructs a job computing the statistics of the digital signal
+    \a signalId from \a fromIdx to \a toIdx. The signal is given as its
+    \a transitions or, if that list is empty, as its sample \a data.
+*/
+DigitalStatisticsJob::DigitalStatisticsJob(int signalId, const QVector<int> &data,
+                                           const QVector<SampleIndex> &transitions,
+                                           SampleIndex fromIdx, SampleIndex toIdx)
+{
+    mSignalId = signalId;
+    mTransitions = transitions;
+    if (mTransitions.isEmpty()) {
+        mData = data;
+    }
+    mFromIdx = fromIdx;
+    mToIdx = toIdx;
+}
+
+/*!
+    Computes the statistics.
+*/
+void DigitalStatisticsJob::execute()
+{
+    InstrumentationTimer timer("Digital statistics");
+
+    if (mTransitions.isEmpty()) {
+        CaptureDevice::transitions(mData, mTransitions);
+        mData.clear();
+    }
+
+    mStatistics.compute(mTransitions, mFromIdx, mToIdx);
+}
+
+/*!
+    \fn int DigitalStatisticsJob::signalId() const
+
+    Returns the ID of the signal.
+*/
+
+/*!
+    \fn const QVector<SampleIndex> &DigitalStatisticsJob::transitions() const
+
+    Returns the transitions of the signal. Only valid after finished()
+    has been emitted.
+*/
+
+/*!
+    \fn const DigitalStatistics &DigitalStatisticsJob::statistics() const
+
+    Returns the statistics. Only valid after finished() has been emitted.
+*/
@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DIGITALSTATISTICS_H
+#define DIGITALSTATISTICS_H
+
+#include <QVector>
+
+#include "common/backgroundjob.h"
+#include "common/sampletime.h"
+
+class DigitalStatistics
+{
+public:
+
+    /*!
+        Minimum, maximum and mean of a set of widths, in samples.
+    */
+    struct Summary {
+        int count;
+        SampleIndex min;
+        SampleIndex max;
+        double mean;
+        double deviation;
+    };
+
+    enum Constants {
+        NumHistogramBins = 32
+    };
+
+    DigitalStatistics();
+
+    bool isValid() const {return mValid;}
+
+    void compute(const QVector<SampleIndex> &transitions, SampleIndex fromIdx, SampleIndex toIdx);
+
+    SampleIndex fromIdx() const {return mFromIdx;}
+    SampleIndex toIdx() const {return mToIdx;}
+    int numRisingEdges() const {return mNumRising;}
+    int numFallingEdges() const {return mNumFalling;}
+    const Summary &highWidth() const {return mHigh;}
+    const Summary &lowWidth() const {return mLow;}
+    const Summary &period() const {return mPeriod;}
+    double dutyCycle() const;
+
+    SampleIndex histogramStart() const {return mHistogramStart;}
+    SampleIndex histogramBinWidth() const {return mHistogramBinWidth;}
+    const QVector<int> &highHistogram() const {return mHighHistogram;}
+    const QVector<int> &lowHistogram() const {return mLowHistogram;}
+
+private:
+    bool mValid;
+    SampleIndex mFromIdx;
+    SampleIndex mToIdx;
+    int mNumRising;
+    int mNumFalling;
+    Summary mHigh;
+    Summary mLow;
+    Summary mPeriod;
+
+    SampleIndex mHistogramStart;
+    SampleIndex mHistogramBinWidth;
+    QVector<int> mHighHistogram;
+    QVector<int> mLowHistogram;
+
+    static void clearSummary(Summary &s);
+    static void addToSummary(Summary &s, double &sumSquares, SampleIndex width);
+    static void finishSummary(Summary &s, double sumSquares);
+    static int firstEdge(const QVector<SampleIndex> &transitions, SampleIndex fromIdx);
+};
+
+class DigitalStatisticsJob : public BackgroundJob
+{
+    Q_OBJECT
+public:
+    DigitalStatisticsJob(int signalId, const QVector<int> &data,
+                         const QVector<SampleIndex> &transitions,
+                         SampleIndex fromIdx, SampleIndex toIdx);
+
+    int signalId() const {return mSignalId;}
+    const QVector<SampleIndex> &transitions() const {return mTransitions;}
+    const DigitalStatistics &statistics() const {return mStatistics;}
+
+protected:
+    void execute();
+
+private:
+    int mSignalId;
+    QVector<int> mData;
+    QVector<SampleIndex> mTransitions;
+    SampleIndex mFromIdx;
+    SampleIndex mToIdx;
+    DigitalStatistics mStatistics;
+};
+
+#endif // DIGITALSTATISTICS_H
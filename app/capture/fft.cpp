@@ -0,0 +1,158 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "fft.h"
+
+#include <qmath.h>
+
+/*!
+    \class RealFft
+    \brief Fast Fourier transform of real valued data.
+
+    \ingroup Capture
+
+    The RealFft class computes the power spectrum of a block of real
+    samples whose size is a power of two. The real input of size N is
+    packed into a complex sequence of size N/2 (even samples as the real
+    part and odd samples as the imaginary part), which is transformed with
+    an iterative radix-2 FFT and then split into the spectrum of the real
+    input. This does half the work of a complex FFT of size N.
+
+    The bit reversal table and the twiddle factors are computed when the
+    object is constructed and never modified, so one object can be used by
+    several threads at the same time.
+*/
+
+/*!
+    Constructs an FFT for blocks of \a size samples. The size must be a
+    power of two and at least 4, see isValidSize().
+*/
+RealFft::RealFft(int size)
+{
+    mSize = size;
+
+    int n = size/2;
+    int bits = 0;
+    while ((1 << bits) < n) bits++;
+
+    mBitReverse.resize(n);
+    for (int i = 0; i < n; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) {
+                r |= 1 << (bits-1-b);
+            }
+        }
+        mBitReverse[i] = r;
+    }
+
+    // twiddle factors e^(-2*pi*i*k/size) for k < size/2. The complex FFT
+    // of size n uses every second of them.
+    mCos.resize(n);
+    mSin.resize(n);
+    for (int k = 0; k < n; k++) {
+        double a = -2*M_PI*k/size;
+        mCos[k] = qCos(a);
+        mSin[k] = qSin(a);
+    }
+}
+
+/*!
+    \fn int RealFft::size() const
+
+    Returns the number of samples in a block.
+*/
+
+/*!
+    Returns true if \a size can be used with this class.
+*/
+bool RealFft::isValidSize(int size)
+{
+    return size >= 4 && (size & (size-1)) == 0;
+}
+
+/*!
+    Transforms the size() samples in \a input and stores the squared
+    magnitude of the size()/2+1 frequency bins from DC to the Nyquist
+    frequency in \a power. The result is not scaled.
+*/
+void RealFft::powerSpectrum(const double* input, double* power) const
+{
+    const int n = mSize/2;
+    QVector<double> re(n);
+    QVector<double> im(n);
+
+    for (int i = 0; i < n; i++) {
+        int r = mBitReverse.at(i);
+        re[r] = input[2*i];
+        im[r] = input[2*i+1];
+    }
+
+    // iterative radix-2 decimation in time
+    for (int len = 2; len <= n; len *= 2) {
+        int half = len/2;
+        int step = mSize/len;
+
+        for (int start = 0; start < n; start += len) {
+            for (int j = 0; j < half; j++) {
+                double wr = mCos.at(j*step);
+                double wi = mSin.at(j*step);
+
+                int a = start+j;
+                int b = a+half;
+
+                double tr = re[b]*wr - im[b]*wi;
+                double ti = re[b]*wi + im[b]*wr;
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+
+    //
+    //  Split the transform Z of the packed input into the transform X of
+    //  the real input:
+    //  X[k] = (Z[k] + conj(Z[n-k]))/2 - i*W^k*(Z[k] - conj(Z[n-k]))/2
+    //
+
+    power[0] = (re[0]+im[0])*(re[0]+im[0]);
+    power[n] = (re[0]-im[0])*(re[0]-im[0]);
+
+    for (int k = 1; k < n; k++) {
+        double zr = re[k];
+        double zi = im[k];
+        double cr = re[n-k];
+        double ci = -im[n-k];
+
+        double er = (zr + cr)/2;
+        double ei = (zi + ci)/2;
+        double dr = (zr - cr)/2;
+        double di = (zi - ci)/2;
+
+        // -i*W^k*d
+        double wr = mCos.at(k);
+        double wi = mSin.at(k);
+        double ore = wr*di + wi*dr;
+        double oim = -(wr*dr - wi*di);
+
+        double xr = er + ore;
+        double xi = ei + oim;
+
+        power[k] = xr*xr + xi*xi;
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef FFT_H
+#define FFT_H
+
+#include <QVector>
+
+class RealFft
+{
+public:
+    explicit RealFft(int size);
+
+    int size() const {return mSize;}
+    static bool isValidSize(int size);
+
+    void powerSpectrum(const double* input, double* power) const;
+
+private:
+    int mSize;
+    QVector<int> mBitReverse;
+    QVector<double> mCos;
+    QVector<double> mSin;
+};
+
+#endif // FFT_H
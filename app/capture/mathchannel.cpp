@@ -0,0 +1,348 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "mathchannel.h"
+
+#include "common/instrumentation.h"
+
+/*!
+    \class MathChannel
+    \brief A signal calculated from the analog signals of a capture.
+
+    \ingroup Capture
+
+    The MathChannel class evaluates a MathExpression for the samples that
+    are asked for, in chunks of ChunkSize samples. A chunk is only
+    calculated the first time one of its samples is needed, so only the
+    parts of a capture that are shown are ever calculated, and it is then
+    cached until the capture changes (see clear()).
+
+    At most MaxCachedChunks chunks are kept. The minimum and maximum value
+    of every RangeBlockSize samples of a calculated chunk are kept as well.
+    When a pixel covers at least RangeBlockSize samples \ref range uses
+    these block ranges instead of the samples, so a zoomed out capture
+    doesn't need more chunks than the cache can hold. The chunks without
+    block ranges are not calculated by \ref range, which would block the
+    GUI thread for a long capture. They are collected instead and can be
+    calculated by a MathRangeJob, see \ref takeMissingChunks and
+    \ref addRanges.
+*/
+
+/*!
+    Constructs an empty MathChannel.
+*/
+MathChannel::MathChannel()
+{
+    mSampleRate = 0;
+    mNumSamples = 0;
+    mGeneration = 0;
+}
+
+/*!
+    Parses the expression \a text. Returns false if it isn't valid; see
+    MathExpression::errorString() for the reason.
+*/
+bool MathChannel::setExpression(const QString &text)
+{
+    mExpression = MathExpression();
+    bool ok = mExpression.parse(text);
+
+    mExpression.setSampleRate(mSampleRate);
+    QMap<int, QVector<double> >::const_iterator it;
+    for (it = mInputs.constBegin(); it != mInputs.constEnd(); ++it) {
+        mExpression.setInput(it.key(), it.value());
+    }
+
+    clear();
+
+    return ok;
+}
+
+/*!
+    \fn const MathExpression &MathChannel::expression() const
+
+    Returns the expression of this channel.
+*/
+
+/*!
+    Sets the \a data of the analog signal with ID \a id. Call clear() when
+    the data of a new capture has been set.
+*/
+void MathChannel::setInput(int id, const QVector<double> &data)
+{
+    mInputs.insert(id, data);
+    mExpression.setInput(id, data);
+}
+
+/*!
+    Sets the sample \a rate of the analog signals.
+*/
+void MathChannel::setSampleRate(int rate)
+{
+    mSampleRate = rate;
+    mExpression.setSampleRate(rate);
+}
+
+/*!
+    Drops all calculated samples. Must be called when the inputs have
+    changed.
+*/
+void MathChannel::clear()
+{
+    mChunks.clear();
+    mBlockRanges.clear();
+    mMissingChunks.clear();
+    mNumSamples = mExpression.numSamples();
+    mGeneration++;
+}
+
+/*!
+    \fn int MathChannel::generation() const
+
+    Returns a number that changes every time the calculated samples are
+    dropped by \ref clear.
+*/
+
+/*!
+    \fn SampleIndex MathChannel::numSamples() const
+
+    Returns the number of samples of the channel.
+*/
+
+/*!
+    Returns the value of the sample \a idx, which must be a valid sample
+    index.
+*/
+double MathChannel::value(SampleIndex idx)
+{
+    return chunk((int)(idx / ChunkSize)).at((int)(idx % ChunkSize));
+}
+
+/*!
+    Sets \a min and \a max to the minimum and maximum value of the samples
+    from \a fromIdx up to, but not including, \a toIdx. Returns false if
+    there aren't any samples in the range or none of them have been
+    calculated yet.
+
+    A range of at least RangeBlockSize samples is decimated: the block
+    ranges of all blocks that overlap the range are used, so the result can
+    include up to one block outside each end of the range. The chunks that
+    have no block ranges are skipped and remembered for
+    \ref takeMissingChunks.
+*/
+bool MathChannel::range(SampleIndex fromIdx, SampleIndex toIdx, double &min, double &max)
+{
+    fromIdx = qMax(fromIdx, (SampleIndex)0);
+    toIdx = qMin(toIdx, mNumSamples);
+    if (fromIdx >= toIdx) return false;
+
+    bool decimated = (toIdx - fromIdx >= RangeBlockSize);
+    bool found = false;
+
+    for (int c = (int)(fromIdx / ChunkSize); (SampleIndex)c*ChunkSize < toIdx; c++) {
+        SampleIndex chunkStart = (SampleIndex)c*ChunkSize;
+        SampleIndex chunkEnd = qMin(chunkStart + ChunkSize, mNumSamples);
+        int from = (int)(qMax(fromIdx, chunkStart) - chunkStart);
+        int to = (int)(qMin(toIdx, chunkEnd) - chunkStart);
+
+        double cmin;
+        double cmax;
+
+        if (decimated) {
+            QMap<int, BlockRanges>::const_iterator it = mBlockRanges.constFind(c);
+            if (it == mBlockRanges.constEnd()) {
+                if (!mMissingChunks.contains(c)) {
+                    mMissingChunks.append(c);
+                }
+                continue;
+            }
+
+            const BlockRanges &blocks = it.value();
+            if (blocks.isEmpty()) continue;
+
+            int lastBlock = (to - 1) / RangeBlockSize;
+
+            cmin = blocks.at(from / RangeBlockSize).first;
+            cmax = blocks.at(from / RangeBlockSize).second;
+            for (int b = from / RangeBlockSize + 1; b <= lastBlock; b++) {
+                if (blocks.at(b).first < cmin) cmin = blocks.at(b).first;
+                if (blocks.at(b).second > cmax) cmax = blocks.at(b).second;
+            }
+        }
+        else {
+            const QVector<double> &data = chunk(c);
+
+            cmin = data.at(from);
+            cmax = cmin;
+            for (int i = from+1; i < to; i++) {
+                double v = data.at(i);
+                if (v < cmin) cmin = v;
+                if (v > cmax) cmax = v;
+            }
+        }
+
+        if (!found || cmin < min) min = cmin;
+        if (!found || cmax > max) max = cmax;
+        found = true;
+    }
+
+    return found;
+}
+
+/*!
+    Returns the chunks that \ref range needed block ranges for but which
+    haven't been calculated, and forgets them.
+*/
+QList<int> MathChannel::takeMissingChunks()
+{
+    QList<int> chunks = mMissingChunks;
+    mMissingChunks.clear();
+    return chunks;
+}
+
+/*!
+    Adds the block \a ranges calculated by a MathRangeJob. They are
+    ignored if the samples have been dropped since the job was created,
+    i.e. if \a generation isn't the current \ref generation.
+*/
+void MathChannel::addRanges(int generation, const QMap<int, BlockRanges> &ranges)
+{
+    if (generation != mGeneration) return;
+
+    QMap<int, BlockRanges>::const_iterator it;
+    for (it = ranges.constBegin(); it != ranges.constEnd(); ++it) {
+        mBlockRanges.insert(it.key(), it.value());
+        mMissingChunks.removeAll(it.key());
+    }
+}
+
+/*!
+    Calculates the samples of chunk \a c of \a expression, which has
+    \a numSamples samples, into \a data and their block ranges into
+    \a ranges. This doesn't use any cache and can be called from any
+    thread.
+*/
+void MathChannel::evaluateChunk(const MathExpression &expression, SampleIndex numSamples,
+                                int c, QVector<double> &data, BlockRanges &ranges)
+{
+    SampleIndex fromIdx = (SampleIndex)c*ChunkSize;
+    SampleIndex toIdx = qMin(fromIdx + ChunkSize, numSamples);
+
+    expression.evaluate(fromIdx, toIdx, data);
+
+    ranges.clear();
+    ranges.reserve((data.size() + RangeBlockSize - 1) / RangeBlockSize);
+
+    const double* d = data.constData();
+    for (int block = 0; block < data.size(); block += RangeBlockSize) {
+        int end = qMin(block + RangeBlockSize, data.size());
+        double min = d[block];
+        double max = min;
+        for (int i = block+1; i < end; i++) {
+            if (d[i] < min) min = d[i];
+            if (d[i] > max) max = d[i];
+        }
+        ranges.append(qMakePair(min, max));
+    }
+}
+
+/*!
+    Returns the samples of chunk \a c, calculating them if they aren't
+    cached. When the cache is full the chunk furthest away from \a c is
+    dropped, since that is the one least likely to be needed when the user
+    scrolls.
+*/
+const QVector<double> &MathChannel::chunk(int c)
+{
+    QMap<int, QVector<double> >::iterator it = mChunks.find(c);
+    if (it != mChunks.end()) return it.value();
+
+    if (mChunks.size() >= MaxCachedChunks) {
+        int first = mChunks.begin().key();
+        int last = (mChunks.end()-1).key();
+        mChunks.remove(qAbs(first - c) > qAbs(last - c) ? first : last);
+    }
+
+    QVector<double> data;
+    BlockRanges ranges;
+    evaluateChunk(mExpression, mNumSamples, c, data, ranges);
+    mBlockRanges.insert(c, ranges);
+
+    return mChunks.insert(c, data).value();
+}
+
+
+/*!
+    \class MathRangeJob
+    \brief Calculates the block ranges of a MathChannel on a worker thread.
+
+    \ingroup Capture
+
+    The job is a BackgroundJob and emits finished() when the block ranges
+    of all its chunks are available, see MathChannel::addRanges(). It works on a copy of the expression, which
+    shares the syntax tree and the signal data with the channel (implicit
+    sharing), so the channel can be changed while the job runs. Only the
+    block ranges are kept, not the samples.
+*/
+
+/*!
+    Constructs a job calculating the block ranges of the given \a chunks
+    of \a channel.
+*/
+MathRangeJob::MathRangeJob(const MathChannel &channel, const QList<int> &chunks)
+{
+    mExpression = channel.expression();
+    mNumSamples = channel.numSamples();
+    mGeneration = channel.generation();
+    mChunks = chunks;
+}
+
+/*!
+    Calculates the block ranges. Stops after the chunk it is calculating
+    if the job has been released.
+*/
+void MathRangeJob::execute()
+{
+    InstrumentationTimer timer("Math ranges");
+
+    QVector<double> data;
+    foreach(int c, mChunks) {
+        if (isCancelled()) break;
+
+        MathChannel::BlockRanges ranges;
+        MathChannel::evaluateChunk(mExpression, mNumSamples, c, data, ranges);
+        mRanges.insert(c, ranges);
+    }
+}
+
+/*!
+    \fn int MathRangeJob::generation() const
+
+    Returns the MathChannel::generation() of the channel when the job was
+    created.
+*/
+
+/*!
+    \fn const QMap<int, MathChannel::BlockRanges> &MathRangeJob::ranges() const
+
+    Returns the block ranges per chunk. Only valid after finished() has
+    been emitted.
+*/
+
+/*!
+    \fn void MathRangeJob::finished()
+
+    This signal is emitted from the worker thread when the job is done.
+*/
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef MATHCHANNEL_H
+#define MATHCHANNEL_H
+
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QVector>
+
+#include "mathexpression.h"
+#include "common/backgroundjob.h"
+
+class MathChannel
+{
+public:
+    // minimum and maximum value of each RangeBlockSize samples of a chunk
+    typedef QVector<QPair<double, double> > BlockRanges;
+
+    MathChannel();
+
+    bool setExpression(const QString &text);
+    const MathExpression &expression() const {return mExpression;}
+
+    void setInput(int id, const QVector<double> &data);
+    void setSampleRate(int rate);
+    void clear();
+    int generation() const {return mGeneration;}
+
+    SampleIndex numSamples() const {return mNumSamples;}
+    double value(SampleIndex idx);
+    bool range(SampleIndex fromIdx, SampleIndex toIdx, double &min, double &max);
+
+    QList<int> takeMissingChunks();
+    void addRanges(int generation, const QMap<int, BlockRanges> &ranges);
+
+    static void evaluateChunk(const MathExpression &expression, SampleIndex numSamples,
+                              int c, QVector<double> &data, BlockRanges &ranges);
+
+private:
+
+    enum Constants {
+        ChunkSize = 65536,
+        RangeBlockSize = 1024,
+        MaxCachedChunks = 64
+    };
+
+    MathExpression mExpression;
+    QMap<int, QVector<double> > mInputs;
+    int mSampleRate;
+    SampleIndex mNumSamples;
+    int mGeneration;
+
+    QMap<int, QVector<double> > mChunks;
+    QMap<int, BlockRanges> mBlockRanges;
+    QList<int> mMissingChunks;
+
+    const QVector<double> &chunk(int c);
+};
+
+class MathRangeJob : public BackgroundJob
+{
+    Q_OBJECT
+public:
+    MathRangeJob(const MathChannel &channel, const QList<int> &chunks);
+
+    int generation() const {return mGeneration;}
+    const QMap<int, MathChannel::BlockRanges> &ranges() const {return mRanges;}
+
+protected:
+    void execute();
+
+private:
+    MathExpression mExpression;
+    SampleIndex mNumSamples;
+    int mGeneration;
+    QList<int> mChunks;
+    QMap<int, MathChannel::BlockRanges> mRanges;
+};
+
+#endif // MATHCHANNEL_H
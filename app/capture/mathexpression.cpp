@@ -0,0 +1,751 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "mathexpression.h"
+
+#include <qmath.h>
+
+/*!
+    \class MathNode
+    \brief A node in the syntax tree of a MathExpression.
+
+    \ingroup Capture
+
+    A node is an operator or function applied to its \a children, an
+    analog input (\a value is the signal ID) or a constant (\a value).
+    For the filters \a value is the cut-off frequency and \a length the
+    number of samples (moving average) or taps (FIR). A node owns its
+    children.
+*/
+
+/*!
+    Constructs a node of the given \a type without children.
+*/
+MathNode::MathNode(NodeType type)
+{
+    this->type = type;
+    value = 0;
+    length = 0;
+}
+
+/*!
+    Deletes the node and its children.
+*/
+MathNode::~MathNode()
+{
+    qDeleteAll(children);
+}
+
+/*!
+    Returns the number of samples of its input before a sample that this
+    node needs to calculate its value at that sample when the signals are
+    sampled at \a sampleRate.
+
+    The low-pass filter depends on all earlier samples. It is started this
+    many samples early, which is long enough for the start value to have
+    decayed below one millionth, but never more than 2^20 samples early.
+    For a cut-off frequency below about sample rate / 470000 the start
+    value has therefore not decayed and the output jumps slightly where
+    MathChannel starts a new chunk.
+*/
+SampleIndex MathNode::history(int sampleRate) const
+{
+    switch (type) {
+    case TypeMovingAverage:
+    case TypeFir:
+        return length - 1;
+    case TypeDerivative:
+        return 1;
+    case TypeLowPass:
+        if (sampleRate > 0 && value > 0) {
+            // e^-14 < 1e-6
+            double tau = sampleRate / (2*M_PI*value);
+            return (SampleIndex)qMin(qCeil(14*tau), 1 << 20);
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+/*!
+    \class MathExpression
+    \brief An expression calculating a signal from the analog signals.
+
+    \ingroup Capture
+
+    The MathExpression class parses and evaluates expressions such as
+
+    \code
+    A0 - A1
+    avg(A0*A1, 16)
+    lowpass(A0, 2M)
+    fir(deriv(A1), 500k, 63)
+    \endcode
+
+    Inputs are written A0, A1, ... and numbers may have one of the suffixes
+    p, n, u, m, k, M and G. The operators are +, -, *, / and unary minus
+    with the usual precedence. The functions are:
+
+    \list
+    \o abs(x) - absolute value
+    \o avg(x, n) - moving average of the last \a n samples
+    \o lowpass(x, fc) - first order IIR low-pass filter with cut-off
+       frequency \a fc, which should be above sample rate / 470000 (see
+       MathNode::history())
+    \o fir(x, fc) or fir(x, fc, taps) - FIR low-pass filter (Hamming
+       windowed sinc) with cut-off frequency \a fc and \a taps taps
+       (default 31)
+    \o deriv(x) - derivative, in units per second
+    \endlist
+
+    All filters are causal, like the filter of an instrument, so the FIR
+    filter and the moving average delay the signal by half their length.
+
+    An expression is evaluated for a range of samples at a time, one node
+    after the other over the whole range, so that each operator is a
+    simple loop over a block of samples. A range can be evaluated without
+    evaluating the samples before it; the nodes that need earlier samples
+    (see MathNode::history()) evaluate their inputs that much earlier.
+    This is what makes it possible for MathChannel to only evaluate the
+    parts of a capture that are shown.
+
+    A parsed expression is never modified and copies share the syntax
+    tree.
+*/
+
+/*!
+    Constructs an empty (invalid) expression.
+*/
+MathExpression::MathExpression()
+{
+    mSampleRate = 0;
+    mPos = 0;
+}
+
+/*!
+    Parses \a text. Returns false and sets errorString() if it isn't a
+    valid expression.
+*/
+bool MathExpression::parse(const QString &text)
+{
+    mText = text;
+    mError = QString();
+    mRoot.clear();
+
+    mSource = text;
+    mPos = 0;
+
+    MathNode* root = parseSum();
+    if (root != NULL) {
+        skipSpace();
+        if (mPos < mSource.size()) {
+            root = fail(QString("Unexpected '%1'").arg(mSource.at(mPos)), root);
+        }
+    }
+
+    if (root == NULL) return false;
+
+    mRoot = QSharedPointer<MathNode>(root);
+    return true;
+}
+
+/*!
+    \fn QString MathExpression::text() const
+
+    Returns the text of the expression.
+*/
+
+/*!
+    \fn QString MathExpression::errorString() const
+
+    Returns a description of the error if the expression couldn't be
+    parsed.
+*/
+
+/*!
+    \fn bool MathExpression::isValid() const
+
+    Returns true if a valid expression has been parsed.
+*/
+
+/*!
+    Returns the IDs of the analog signals used in the expression.
+*/
+QList<int> MathExpression::inputs() const
+{
+    QList<int> list;
+    if (!mRoot.isNull()) {
+        collectInputs(mRoot.data(), list);
+    }
+    return list;
+}
+
+/*!
+    Sets the \a data of the analog signal with ID \a id. The data is
+    implicitly shared, so this is cheap.
+*/
+void MathExpression::setInput(int id, const QVector<double> &data)
+{
+    mInputs.insert(id, data);
+}
+
+/*!
+    \fn void MathExpression::setSampleRate(int rate)
+
+    Sets the sample \a rate of the inputs, which is needed by the filters.
+*/
+
+/*!
+    Returns the number of samples that can be evaluated, i.e., the size of
+    the shortest input.
+*/
+SampleIndex MathExpression::numSamples() const
+{
+    QList<int> ids = inputs();
+    if (ids.isEmpty()) return 0;
+
+    SampleIndex n = -1;
+    foreach(int id, ids) {
+        SampleIndex size = mInputs.value(id).size();
+        if (n == -1 || size < n) n = size;
+    }
+
+    return n;
+}
+
+/*!
+    Evaluates the expression for the samples from \a fromIdx up to, but
+    not including, \a toIdx and stores the result in \a out.
+*/
+void MathExpression::evaluate(SampleIndex fromIdx, SampleIndex toIdx, QVector<double> &out) const
+{
+    if (mRoot.isNull() || toIdx <= fromIdx) {
+        out.clear();
+        return;
+    }
+
+    evaluateNode(mRoot.data(), fromIdx, toIdx, out);
+}
+
+/*!
+    Parses terms separated by + and -.
+*/
+MathNode* MathExpression::parseSum()
+{
+    MathNode* left = parseProduct();
+
+    while (left != NULL) {
+        MathNode::NodeType type;
+        if (accept('+')) {
+            type = MathNode::TypeAdd;
+        }
+        else if (accept('-')) {
+            type = MathNode::TypeSubtract;
+        }
+        else {
+            break;
+        }
+
+        MathNode* right = parseProduct();
+        if (right == NULL) {
+            delete left;
+            return NULL;
+        }
+
+        MathNode* node = new MathNode(type);
+        node->children.append(left);
+        node->children.append(right);
+        left = node;
+    }
+
+    return left;
+}
+
+/*!
+    Parses factors separated by * and /.
+*/
+MathNode* MathExpression::parseProduct()
+{
+    MathNode* left = parseUnary();
+
+    while (left != NULL) {
+        MathNode::NodeType type;
+        if (accept('*')) {
+            type = MathNode::TypeMultiply;
+        }
+        else if (accept('/')) {
+            type = MathNode::TypeDivide;
+        }
+        else {
+            break;
+        }
+
+        MathNode* right = parseUnary();
+        if (right == NULL) {
+            delete left;
+            return NULL;
+        }
+
+        MathNode* node = new MathNode(type);
+        node->children.append(left);
+        node->children.append(right);
+        left = node;
+    }
+
+    return left;
+}
+
+/*!
+    Parses a factor with an optional unary minus.
+*/
+MathNode* MathExpression::parseUnary()
+{
+    if (accept('-')) {
+        MathNode* child = parseUnary();
+        if (child == NULL) return NULL;
+
+        MathNode* node = new MathNode(MathNode::TypeNegate);
+        node->children.append(child);
+        return node;
+    }
+
+    return parsePrimary();
+}
+
+/*!
+    Parses a number, an input, a function call or an expression within
+    parentheses.
+*/
+MathNode* MathExpression::parsePrimary()
+{
+    skipSpace();
+    if (mPos >= mSource.size()) {
+        return fail("Unexpected end of expression");
+    }
+
+    if (accept('(')) {
+        MathNode* node = parseSum();
+        if (node == NULL) return NULL;
+        if (!accept(')')) return fail("Expected ')'", node);
+        return node;
+    }
+
+    QChar c = mSource.at(mPos);
+    if (c.isDigit() || c == '.') {
+        MathNode* node = new MathNode(MathNode::TypeConstant);
+        if (!parseNumber(node->value)) return fail("Invalid number", node);
+        return node;
+    }
+
+    if (c.isLetter()) {
+        QString name = parseName();
+
+        // analog input, e.g. A0
+        if (name.size() > 1 && name.at(0).toUpper() == 'A') {
+            bool ok = false;
+            int id = name.mid(1).toInt(&ok);
+            if (ok) {
+                MathNode* node = new MathNode(MathNode::TypeInput);
+                node->value = id;
+                return node;
+            }
+        }
+
+        return parseFunction(name.toLower());
+    }
+
+    return fail(QString("Unexpected '%1'").arg(c));
+}
+
+/*!
+    Parses the arguments of the function \a name.
+*/
+MathNode* MathExpression::parseFunction(const QString &name)
+{
+    MathNode* node = NULL;
+    int numConstants = 0;
+    int numOptional = 0;
+
+    if (name == "abs") {
+        node = new MathNode(MathNode::TypeAbs);
+    }
+    else if (name == "avg") {
+        node = new MathNode(MathNode::TypeMovingAverage);
+        numConstants = 1;
+    }
+    else if (name == "lowpass") {
+        node = new MathNode(MathNode::TypeLowPass);
+        numConstants = 1;
+    }
+    else if (name == "fir") {
+        node = new MathNode(MathNode::TypeFir);
+        node->length = DefaultFirTaps;
+        numConstants = 1;
+        numOptional = 1;
+    }
+    else if (name == "deriv") {
+        node = new MathNode(MathNode::TypeDerivative);
+    }
+    else {
+        return fail(QString("Unknown function '%1'").arg(name));
+    }
+
+    if (!accept('(')) return fail("Expected '('", node);
+
+    MathNode* child = parseSum();
+    if (child == NULL) {
+        delete node;
+        return NULL;
+    }
+    node->children.append(child);
+
+    double constants[2] = {0, 0};
+    int n = 0;
+    while (accept(',')) {
+        if (n >= numConstants + numOptional) {
+            return fail(QString("Too many arguments to '%1'").arg(name), node);
+        }
+        skipSpace();
+        if (!parseNumber(constants[n])) return fail("Expected a number", node);
+        n++;
+    }
+
+    if (n < numConstants) return fail(QString("Too few arguments to '%1'").arg(name), node);
+    if (!accept(')')) return fail("Expected ')'", node);
+
+    switch (node->type) {
+    case MathNode::TypeMovingAverage:
+        node->length = (int)constants[0];
+        if (node->length < 1 || node->length > MaxAverageLength) {
+            return fail("Invalid number of samples to average", node);
+        }
+        break;
+    case MathNode::TypeLowPass:
+        node->value = constants[0];
+        if (node->value <= 0) return fail("Invalid cut-off frequency", node);
+        break;
+    case MathNode::TypeFir:
+        node->value = constants[0];
+        if (node->value <= 0) return fail("Invalid cut-off frequency", node);
+        if (n > 1) {
+            node->length = (int)constants[1];
+            if (node->length < 1 || node->length > MaxFirTaps) {
+                return fail("Invalid number of taps", node);
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    return node;
+}
+
+/*!
+    Parses a number with an optional SI suffix and stores it in \a value.
+    Returns false if there is no valid number at the current position.
+*/
+bool MathExpression::parseNumber(double &value)
+{
+    int start = mPos;
+
+    while (mPos < mSource.size()
+           && (mSource.at(mPos).isDigit() || mSource.at(mPos) == '.')) {
+        mPos++;
+    }
+
+    // exponent
+    if (mPos+1 < mSource.size() && mSource.at(mPos).toLower() == 'e'
+            && (mSource.at(mPos+1).isDigit() || mSource.at(mPos+1) == '-'
+                || mSource.at(mPos+1) == '+')) {
+        mPos += 2;
+        while (mPos < mSource.size() && mSource.at(mPos).isDigit()) {
+            mPos++;
+        }
+    }
+
+    bool ok = false;
+    value = mSource.mid(start, mPos-start).toDouble(&ok);
+    if (!ok) return false;
+
+    // suffix, if it isn't the start of a name
+    if (mPos < mSource.size()
+            && (mPos+1 >= mSource.size() || !mSource.at(mPos+1).isLetterOrNumber())) {
+        const QString suffixes = "pnumkMG";
+        const double factors[] = {1e-12, 1e-9, 1e-6, 1e-3, 1e3, 1e6, 1e9};
+
+        int s = suffixes.indexOf(mSource.at(mPos));
+        if (s != -1) {
+            value *= factors[s];
+            mPos++;
+        }
+    }
+
+    return true;
+}
+
+/*!
+    Parses a name (letters and digits starting with a letter).
+*/
+QString MathExpression::parseName()
+{
+    int start = mPos;
+    while (mPos < mSource.size() && mSource.at(mPos).isLetterOrNumber()) {
+        mPos++;
+    }
+    return mSource.mid(start, mPos-start);
+}
+
+/*!
+    Skips white space.
+*/
+void MathExpression::skipSpace()
+{
+    while (mPos < mSource.size() && mSource.at(mPos).isSpace()) {
+        mPos++;
+    }
+}
+
+/*!
+    Skips white space and the character \a c if it is next. Returns true if
+    \a c was found.
+*/
+bool MathExpression::accept(QChar c)
+{
+    skipSpace();
+    if (mPos < mSource.size() && mSource.at(mPos) == c) {
+        mPos++;
+        return true;
+    }
+    return false;
+}
+
+/*!
+    Sets the parse \a error, deletes \a node and returns NULL.
+*/
+MathNode* MathExpression::fail(const QString &error, MathNode* node)
+{
+    if (mError.isNull()) {
+        mError = QString("%1 at position %2").arg(error).arg(mPos+1);
+    }
+    delete node;
+    return NULL;
+}
+
+/*!
+    Adds the IDs of the inputs used by \a node to \a list.
+*/
+void MathExpression::collectInputs(const MathNode* node, QList<int> &list) const
+{
+    if (node->type == MathNode::TypeInput && !list.contains((int)node->value)) {
+        list.append((int)node->value);
+    }
+
+    foreach(const MathNode* child, node->children) {
+        collectInputs(child, list);
+    }
+}
+
+/*!
+    Evaluates \a node for the samples from \a fromIdx up to, but not
+    including, \a toIdx and stores the result in \a out.
+*/
+void MathExpression::evaluateNode(const MathNode* node, SampleIndex fromIdx, SampleIndex toIdx,
+                                  QVector<double> &out) const
+{
+    const int n = (int)(toIdx - fromIdx);
+    out.resize(n);
+    double* o = out.data();
+
+    QVector<double> a;
+    QVector<double> b;
+
+    switch (node->type) {
+    case MathNode::TypeConstant:
+        out.fill(node->value);
+        break;
+
+    case MathNode::TypeInput:
+    {
+        const QVector<double> &data = mInputs.value((int)node->value);
+        for (int i = 0; i < n; i++) {
+            SampleIndex idx = fromIdx + i;
+            o[i] = (idx < data.size() ? data.at((int)idx) : 0);
+        }
+        break;
+    }
+
+    case MathNode::TypeNegate:
+    case MathNode::TypeAbs:
+    {
+        evaluateNode(node->children.at(0), fromIdx, toIdx, a);
+        const double* x = a.constData();
+        if (node->type == MathNode::TypeNegate) {
+            for (int i = 0; i < n; i++) o[i] = -x[i];
+        }
+        else {
+            for (int i = 0; i < n; i++) o[i] = qAbs(x[i]);
+        }
+        break;
+    }
+
+    case MathNode::TypeAdd:
+    case MathNode::TypeSubtract:
+    case MathNode::TypeMultiply:
+    case MathNode::TypeDivide:
+    {
+        evaluateNode(node->children.at(0), fromIdx, toIdx, a);
+        evaluateNode(node->children.at(1), fromIdx, toIdx, b);
+        const double* x = a.constData();
+        const double* y = b.constData();
+
+        switch (node->type) {
+        case MathNode::TypeAdd:
+            for (int i = 0; i < n; i++) o[i] = x[i] + y[i];
+            break;
+        case MathNode::TypeSubtract:
+            for (int i = 0; i < n; i++) o[i] = x[i] - y[i];
+            break;
+        case MathNode::TypeMultiply:
+            for (int i = 0; i < n; i++) o[i] = x[i] * y[i];
+            break;
+        default:
+            for (int i = 0; i < n; i++) o[i] = (y[i] != 0 ? x[i] / y[i] : 0);
+            break;
+        }
+        break;
+    }
+
+    case MathNode::TypeMovingAverage:
+    {
+        // the input starts 'offset' samples before fromIdx
+        SampleIndex start = qMax((SampleIndex)0, fromIdx - node->history(mSampleRate));
+        int offset = (int)(fromIdx - start);
+        evaluateNode(node->children.at(0), start, toIdx, a);
+        const double* x = a.constData();
+
+        double sum = 0;
+        int count = 0;
+        for (int j = 0; j < offset; j++) {
+            sum += x[j];
+            count++;
+        }
+        for (int i = 0; i < n; i++) {
+            int j = offset + i;
+            sum += x[j];
+            if (++count > node->length) {
+                sum -= x[j - node->length];
+                count--;
+            }
+            o[i] = sum / count;
+        }
+        break;
+    }
+
+    case MathNode::TypeLowPass:
+    {
+        SampleIndex start = qMax((SampleIndex)0, fromIdx - node->history(mSampleRate));
+        int offset = (int)(fromIdx - start);
+        evaluateNode(node->children.at(0), start, toIdx, a);
+        const double* x = a.constData();
+
+        double alpha = 1;
+        if (mSampleRate > 0) {
+            alpha = 1 - qExp(-2*M_PI*node->value/mSampleRate);
+        }
+
+        double y = x[0];
+        for (int j = 1; j < offset; j++) {
+            y += alpha*(x[j] - y);
+        }
+        for (int i = 0; i < n; i++) {
+            int j = offset + i;
+            if (j > 0) {
+                y += alpha*(x[j] - y);
+            }
+            o[i] = y;
+        }
+        break;
+    }
+
+    case MathNode::TypeFir:
+    {
+        QVector<double> coeffs;
+        firCoefficients(node->value, node->length, coeffs);
+        const double* c = coeffs.constData();
+        const int taps = coeffs.size();
+
+        // input padded with the first sample where it starts before the
+        // first sample of the capture
+        SampleIndex start = qMax((SampleIndex)0, fromIdx - (taps-1));
+        evaluateNode(node->children.at(0), start, toIdx, a);
+        int pad = (int)(start - (fromIdx - (taps-1)));
+        if (pad > 0) {
+            a.insert(0, pad, a.at(0));
+        }
+        const double* x = a.constData() + taps - 1;
+
+        for (int i = 0; i < n; i++) {
+            double sum = 0;
+            for (int k = 0; k < taps; k++) {
+                sum += c[k]*x[i-k];
+            }
+            o[i] = sum;
+        }
+        break;
+    }
+
+    case MathNode::TypeDerivative:
+    {
+        SampleIndex start = qMax((SampleIndex)0, fromIdx - node->history(mSampleRate));
+        int offset = (int)(fromIdx - start);
+        evaluateNode(node->children.at(0), start, toIdx, a);
+        const double* x = a.constData();
+
+        for (int i = 0; i < n; i++) {
+            int j = offset + i;
+            o[i] = (j > 0 ? (x[j] - x[j-1])*mSampleRate : 0);
+        }
+        break;
+    }
+    }
+}
+
+/*!
+    Calculates the \a taps coefficients of a low-pass FIR filter with the
+    \a cutoff frequency (Hamming windowed sinc, unity gain at DC) and
+    stores them in \a coeffs.
+*/
+void MathExpression::firCoefficients(double cutoff, int taps, QVector<double> &coeffs) const
+{
+    coeffs.resize(taps);
+
+    double fc = (mSampleRate > 0 ? qMin(cutoff/mSampleRate, 0.5) : 0.5);
+    double mid = (taps-1)/2.0;
+    double sum = 0;
+
+    for (int k = 0; k < taps; k++) {
+        double x = k - mid;
+        double sinc = (x == 0 ? 2*fc : qSin(2*M_PI*fc*x)/(M_PI*x));
+        double window = (taps > 1 ? 0.54 - 0.46*qCos(2*M_PI*k/(taps-1)) : 1);
+        coeffs[k] = sinc*window;
+        sum += coeffs[k];
+    }
+
+    for (int k = 0; k < taps; k++) {
+        coeffs[k] /= sum;
+    }
+}
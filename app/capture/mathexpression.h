@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef MATHEXPRESSION_H
+#define MATHEXPRESSION_H
+
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QVector>
+#include <QSharedPointer>
+
+#include "common/sampletime.h"
+
+class MathNode
+{
+public:
+
+    enum NodeType {
+        TypeConstant,
+        TypeInput,
+        TypeNegate,
+        TypeAdd,
+        TypeSubtract,
+        TypeMultiply,
+        TypeDivide,
+        TypeAbs,
+        TypeMovingAverage,
+        TypeLowPass,
+        TypeFir,
+        TypeDerivative
+    };
+
+    explicit MathNode(NodeType type);
+    ~MathNode();
+
+    NodeType type;
+    double value;
+    int length;
+    QList<MathNode*> children;
+
+    SampleIndex history(int sampleRate) const;
+
+private:
+    MathNode(const MathNode &other);
+    MathNode &operator=(const MathNode &other);
+};
+
+class MathExpression
+{
+public:
+    MathExpression();
+
+    bool parse(const QString &text);
+    QString text() const {return mText;}
+    QString errorString() const {return mError;}
+    bool isValid() const {return !mRoot.isNull();}
+    QList<int> inputs() const;
+
+    void setInput(int id, const QVector<double> &data);
+    void setSampleRate(int rate) {mSampleRate = rate;}
+    SampleIndex numSamples() const;
+
+    void evaluate(SampleIndex fromIdx, SampleIndex toIdx, QVector<double> &out) const;
+
+private:
+
+    enum Constants {
+        DefaultFirTaps = 31,
+        MaxFirTaps = 1023,
+        MaxAverageLength = 1048576
+    };
+
+    QString mText;
+    QString mError;
+    QSharedPointer<MathNode> mRoot;
+    QMap<int, QVector<double> > mInputs;
+    int mSampleRate;
+
+    // parser
+    int mPos;
+    QString mSource;
+
+    MathNode* parseSum();
+    MathNode* parseProduct();
+    MathNode* parseUnary();
+    MathNode* parsePrimary();
+    MathNode* parseFunction(const QString &name);
+    bool parseNumber(double &value);
+    QString parseName();
+    void skipSpace();
+    bool accept(QChar c);
+    MathNode* fail(const QString &error, MathNode* node = 0);
+    void collectInputs(const MathNode* node, QList<int> &list) const;
+
+    // evaluation
+    void evaluateNode(const MathNode* node, SampleIndex fromIdx, SampleIndex toIdx,
+                      QVector<double> &out) const;
+    void firCoefficients(double cutoff, int taps, QVector<double> &coeffs) const;
+};
+
+#endif // MATHEXPRESSION_H
@@ -111,7 +111,15 @@ void SignalManager::saveSignalSettings(QSettings &settings, QDataStream &out)
             continue;
         }
 
-        // not digital or analog, must be an analyzer
+        UiMathSignal* ms = qobject_cast<UiMathSignal*>(s);
+        if (ms != NULL) {
+            settings.setArrayIndex(idx++);
+            settings.setValue("meta", ms->toSettingsString());
+
+            continue;
+        }
+
+        // not digital, analog or math, must be an analyzer
         QString metaStr = AnalyzerManager::analyzerToString(qobject_cast<UiAnalyzer*>(s));
         if (!metaStr.isNull()) {
             settings.setArrayIndex(idx++);
@@ -139,7 +147,13 @@ void SignalManager::loadSignalsFromSettings(QSettings &settings, QDataStream &in
         settings.setArrayIndex(i);
         QString meta = settings.value("meta").toString();
 
-        if (meta.contains("Digital;")) {
+        if (meta.startsWith(UiMathSignal::name + ";")) {
+            UiMathSignal* signal = UiMathSignal::fromSettingsString(meta);
+            if (signal != NULL) {
+                addMathSignal(signal);
+            }
+        }
+        else if (meta.contains("Digital;")) {
             DigitalSignal tmp = DigitalSignal::fromSettingsString(meta);
 
             do {
@@ -293,6 +307,21 @@ void SignalManager::addAnalyzer(UiAnalyzer* analyzer)
     emit signalsAdded();
 }
 
+/*!
+    Add the math signal given by \a signal to the list of signal
+    widgets.
+*/
+void SignalManager::addMathSignal(UiMathSignal* signal)
+{
+    if (signal == NULL) return;
+
+    connect(signal, SIGNAL(closed(UiAbstractSignal*)),
+            this, SLOT(closeSignal(UiAbstractSignal*)));
+
+    mSignalList.append(signal);
+    emit signalsAdded();
+}
+
 /*!
     Closes all signal widgets and removes the signal containers if
     \a removeDeviceSignals is true.
@@ -440,17 +469,17 @@ double SignalManager::getClosestDigitalTransitionForSignal(double t, int signalI
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
 
-    QList<int> data;
+    QVector<SampleIndex> data;
     device->digitalTransitions(signalId, data);
 
 
-    double period = (double)1/device->usedSampleRate();
+    int rate = device->usedSampleRate();
 
     if (data.size() > 0) {
 
-        int startIdx = (int)(t/period);
-        int beforeIdx = startIdx;
-        int afterIdx = startIdx;
+        SampleIndex startIdx = SampleTime::fromSeconds(t, rate);
+        SampleIndex beforeIdx = startIdx;
+        SampleIndex afterIdx = startIdx;
 
         for (int i = 1; i < data.size()-1; i++) {
             if (startIdx > data.at(i)) {
@@ -465,10 +494,10 @@ double SignalManager::getClosestDigitalTransitionForSignal(double t, int signalI
         }
 
         if (startIdx - beforeIdx < afterIdx - startIdx) {
-            time = (beforeIdx+1)*period;
+            time = SampleTime::toSeconds(beforeIdx+1, rate);
         }
         else {
-            time = afterIdx*period;
+            time = SampleTime::toSeconds(afterIdx, rate);
         }
 
     }
@@ -25,6 +25,7 @@
 #include "uiabstractsignal.h"
 #include "uidigitalsignal.h"
 #include "uianalogsignal.h"
+#include "uimathsignal.h"
 
 #include "analyzer/uianalyzer.h"
 
@@ -42,6 +43,7 @@ public:
     void addDigitalSignal(int id);
     void addAnalogSignal(int id);
     void addAnalyzer(UiAnalyzer* analyzer);
+    void addMathSignal(UiMathSignal* signal);
 
     void closeAllSignals(bool removeDeviceSignals);
     void reloadSignalsFromDevice();
@@ -20,16 +20,23 @@
 #include <QDoubleSpinBox>
 #include <QRadioButton>
 #include <QButtonGroup>
+#include <QMenu>
+#include <QMessageBox>
+#include <QContextMenuEvent>
 
 #include "common/configuration.h"
 #include "uianalogtrigger.h"
+#include "cursormanager.h"
 #include "device/devicemanager.h"
+#include "common/instrumentation.h"
 
 #include "uilistspinbox.h"
 
 
 const double UiAnalogSignal::MaxVPerDiv = 4.99;
 const double UiAnalogSignal::MinVPerDiv = 0.11;
+// hysteresis, in divisions, around the level of a crossing search
+const double UiAnalogSignal::CrossingHysteresis = 0.1;
 
 
 // ###########################################################################
@@ -404,6 +411,12 @@ int UiAnalogSignalPrivate::minimumHeight()
     signal is painted within the same widget. The reason is to get a similar
     behaviour as with oscilloscopes where the signals can moved relative to
     each other.
+
+    The context menu of the plot area moves a cursor to the next or
+    previous rising or falling crossing of a signal, see
+    CaptureDevice::analogLevelSearch(). The level is the trigger level if
+    the signal has a trigger, otherwise the level where the menu was
+    opened.
 */
 
 /*!
@@ -504,6 +517,7 @@ void UiAnalogSignal::clearTriggers()
 void UiAnalogSignal::paintEvent(QPaintEvent *event)
 {
     (void)event;
+    InstrumentationTimer timer("Paint analog");
     QPainter painter(this);
 #if QT_VERSION >= 0x050000
     painter.setRenderHint(QPainter::Qt4CompatiblePainting);
@@ -659,6 +673,50 @@ void UiAnalogSignal::leaveEvent(QEvent* event)
     emit measurmentChanged(QList<double>(), QList<double>(), false);
 }
 
+/*!
+    Event handler called when the context menu is requested for this
+    widget. The menu has crossing searches for each signal when it is
+    opened in the plot area.
+*/
+void UiAnalogSignal::contextMenuEvent(QContextMenuEvent* event)
+{
+    if (mTimeAxis == NULL || mSignals.size() == 0 || event->pos().x() < infoWidth()) {
+        QWidget::contextMenuEvent(event);
+        return;
+    }
+
+    // action data: signal index * 4 + 1 for falling + 2 for previous
+    QMenu menu(this);
+    for (int i = 0; i < mSignals.size(); i++) {
+        QMenu* m = &menu;
+        if (mSignals.size() > 1) {
+            m = menu.addMenu(mSignals.at(i)->mSignal->name());
+        }
+
+        m->addAction(tr("Next rising crossing"))->setData(QVariant(i*4));
+        m->addAction(tr("Next falling crossing"))->setData(QVariant(i*4 + 1));
+        m->addAction(tr("Previous rising crossing"))->setData(QVariant(i*4 + 2));
+        m->addAction(tr("Previous falling crossing"))->setData(QVariant(i*4 + 3));
+    }
+
+    QAction* selected = menu.exec(event->globalPos());
+    if (selected == NULL) return;
+
+    int n = selected->data().toInt();
+    UiAnalogSignalPrivate* p = mSignals.at(n / 4);
+    AnalogLevelSearch::Edge edge = ((n & 1) != 0 ? AnalogLevelSearch::FallingEdge
+                                                 : AnalogLevelSearch::RisingEdge);
+
+    double level = (p->mGndPos - event->pos().y())*p->mSignal->vPerDiv()/mNumPxPerDiv;
+    if (p->mAnalogTrigger != NULL
+            && p->mAnalogTrigger->state() != AnalogSignal::AnalogTriggerNone) {
+        level = p->mAnalogTrigger->level();
+    }
+
+    moveCursorToCrossing(p, edge, (n & 2) == 0, level,
+                         mTimeAxis->pixelToTimeRelativeRef(event->pos().x()));
+}
+
 /*!
     Called when the signal name has been edited.
 */
@@ -866,7 +924,8 @@ void UiAnalogSignal::findIntersect(UiAnalogSignalPrivate* signal, double time,
             ->captureDevice();
     int rate = device->usedSampleRate();
 
-    double t = time*rate;
+    double offset = device->analogTimeOffset(signal->mSignal->id());
+    double t = (time-offset)*rate;
     int idx = (int)t;
     QLineF sigPart;
 
@@ -887,11 +946,73 @@ void UiAnalogSignal::findIntersect(UiAnalogSignalPrivate* signal, double time,
         sigPart.intersect(QLineF(t, 0, t, 5), intersect);
 
         // convert x back to absolute time
-        intersect->setX(intersect->x()/rate);
+        intersect->setX(intersect->x()/rate + offset);
     }
 
 }
 
+/*!
+    Moves a cursor to the next crossing (or previous if \a forward is
+    false) of \a level with the given \a edge for \a signal. The search
+    starts at the cursor returned by \ref crossingCursor if it is enabled,
+    otherwise at \a time.
+*/
+void UiAnalogSignal::moveCursorToCrossing(UiAnalogSignalPrivate* signal,
+                                          AnalogLevelSearch::Edge edge,
+                                          bool forward, double level, double time)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    int rate = device->usedSampleRate();
+    if (rate <= 0) return;
+
+    int id = signal->mSignal->id();
+    AnalogLevelSearch search;
+    device->analogLevelSearch(id, search);
+
+    UiCursor::CursorId cursor = crossingCursor();
+    if (CursorManager::instance().isCursorOn(cursor)) {
+        time = CursorManager::instance().cursorPosition(cursor);
+    }
+
+    double offset = device->analogTimeOffset(id);
+    SampleIndex idx = SampleTime::nearestSample(time - offset, rate);
+    double h = signal->mSignal->vPerDiv()*CrossingHysteresis;
+
+    SampleIndex found;
+    if (forward) {
+        found = search.next(edge, level - h, level + h, idx + 1);
+    }
+    else {
+        found = search.previous(edge, level - h, level + h, idx - 1);
+    }
+
+    if (found == -1) {
+        QMessageBox::information(this, tr("Find crossing"),
+                                 tr("No more crossings of %1 V found").arg(level, 0, 'f', 2));
+        return;
+    }
+
+    CursorManager::instance().setCursorPosition(
+                cursor, device->sampleTime(found).toSeconds() + offset);
+    CursorManager::instance().enableCursor(cursor, true);
+}
+
+/*!
+    Returns the cursor moved by the crossing searches, which is the first
+    enabled cursor or Cursor 1 if none is enabled.
+*/
+UiCursor::CursorId UiAnalogSignal::crossingCursor() const
+{
+    for (int i = UiCursor::Cursor1; i <= UiCursor::Cursor4; i++) {
+        if (CursorManager::instance().isCursorOn((UiCursor::CursorId)i)) {
+            return (UiCursor::CursorId)i;
+        }
+    }
+
+    return UiCursor::Cursor1;
+}
+
 /*!
     Find the signal closest to the pixel point \a pxPoint. NULL is returned
     if a signal wasn't found.
@@ -1057,7 +1178,10 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
         if (data == NULL) continue;
 
         int rate = device->usedSampleRate();
-        int fromIdx = (int)(mTimeAxis->rangeLower()*rate);
+
+        // time of the first sample relative to the digital signals
+        double offset = device->analogTimeOffset(id);
+        int fromIdx = (int)((mTimeAxis->rangeLower()-offset)*rate);
 
         if (fromIdx >= data->size()) continue;
         if (fromIdx < 0) fromIdx = 0;
@@ -1092,8 +1216,8 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
 
             if ((double)(j-fromIdx)/rate < tOnePixel) continue;
 
-            from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/rate);
-            to = mTimeAxis->timeToPixelRelativeRef((double)j/rate);
+            from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/rate + offset);
+            to = mTimeAxis->timeToPixelRelativeRef((double)j/rate + offset);
 
             // no need to draw when signal is out of plot area
             if (to < 0) continue;
@@ -27,6 +27,8 @@
 #include "uiabstractsignal.h"
 
 #include "device/analogsignal.h"
+#include "device/analoglevelsearch.h"
+#include "uicursor.h"
 
 class UiAnalogSignalPrivate;
 
@@ -60,6 +62,7 @@ protected:
     void mouseMoveEvent(QMouseEvent *event);
     void showEvent(QShowEvent* event);
     void leaveEvent(QEvent* event);
+    void contextMenuEvent(QContextMenuEvent* event);
 
 private slots:
     void nameEdited();
@@ -93,6 +96,7 @@ private:
 
     static const double MaxVPerDiv;
     static const double MinVPerDiv;
+    static const double CrossingHysteresis;
     int mNumPxPerDiv;
 
     void setName(QString &name, UiAnalogSignalPrivate *signal);
@@ -101,6 +105,9 @@ private:
 
     UiAnalogSignalPrivate *findSignal(QPoint pxPoint);
     void findIntersect(UiAnalogSignalPrivate* signal, double time, QPointF* intersect);
+    void moveCursorToCrossing(UiAnalogSignalPrivate* signal, AnalogLevelSearch::Edge edge,
+                              bool forward, double level, double time);
+    UiCursor::CursorId crossingCursor() const;
 
 
     void paintDivLines(QPainter* painter);
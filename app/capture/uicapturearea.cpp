@@ -79,6 +79,11 @@ UiCaptureArea::UiCaptureArea(SignalManager *signalManager, QWidget *parent) :
             cg,
             SLOT(setCursorData(UiCursor::CursorId, bool, double)));
 
+    connect((mPlot),
+            SIGNAL(cursorChanged(UiCursor::CursorId, bool, double)),
+            this,
+            SLOT(handleCursorChanged(UiCursor::CursorId, bool, double)));
+
 
     // Deallocation: measureArea takes ownership of digital group
     UiDigitalGroup* dg = new UiDigitalGroup();
@@ -106,15 +111,29 @@ UiCaptureArea::UiCaptureArea(SignalManager *signalManager, QWidget *parent) :
 */
 void UiCaptureArea::handleSignalDataChanged()
 {
-    // make sure analyzers are updated
+    // make sure analyzers and math signals are updated
+    foreach(UiAbstractSignal* s, mSignalManager->signalList()) {
+        s->handleSignalDataChanged();
+    }
+
+    mPlot->handleSignalDataChanged();
+}
+
+/*!
+    Called when the cursor \a id has been moved or turned on/off. Analyzers
+    using it as sync cursor decode the signal again.
+*/
+void UiCaptureArea::handleCursorChanged(UiCursor::CursorId id, bool on, double time)
+{
+    (void)on;
+    (void)time;
+
     foreach(UiAbstractSignal* s, mSignalManager->signalList()) {
         UiAnalyzer* as = qobject_cast<UiAnalyzer*>(s);
         if (as != NULL) {
-            as->analyze();
+            as->handleCursorChanged(id);
         }
     }
-
-    mPlot->handleSignalDataChanged();
 }
 
 /*!
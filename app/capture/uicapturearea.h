@@ -36,6 +36,9 @@ public slots:
     void zoomOut();
     void zoomAll();
 
+private slots:
+    void handleCursorChanged(UiCursor::CursorId id, bool on, double time);
+
 private:
     SignalManager* mSignalManager;
     UiPlot* mPlot;
@@ -219,7 +219,9 @@ void UiCaptureExporter::exportToCsv(QWidget* w)
 
         QList<QVector<int>*> digitalData;
         QList<QVector<double>*> analogData;
+        QList<int> analogShift;
 
+        int firstSample = 0;
         int numSamples = -1;
         int sampleRate = mCaptureDevice->usedSampleRate();
 
@@ -245,12 +247,24 @@ void UiCaptureExporter::exportToCsv(QWidget* w)
 
             out << delim << QString("A%1").arg(s->id());
 
+            // the analog data is exported at the closest digital sample
+            int shift = qRound(mCaptureDevice->analogTimeOffset(s->id())*sampleRate);
+
             analogData.append(data);
-            if (numSamples == -1 || data->size() < numSamples) {
-                numSamples = data->size();
+            analogShift.append(shift);
+            if (shift > firstSample) {
+                firstSample = shift;
+            }
+            if (numSamples == -1 || data->size()+shift < numSamples) {
+                numSamples = data->size()+shift;
             }
         }
 
+        // only export samples where all signals have data
+        if (firstSample > numSamples) {
+            firstSample = numSamples;
+        }
+
         out << '\n';
 
         //  <<< Header <<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -262,7 +276,7 @@ void UiCaptureExporter::exportToCsv(QWidget* w)
         progress.setWindowModality(Qt::WindowModal);
 
         QString lastSampleRow;
-        for (int i = 0; i < numSamples; i++) {
+        for (int i = firstSample; i < numSamples; i++) {
 
             // do not call progress or wasCanceled for each sample
             // since this greatly slows down the export
@@ -286,9 +300,9 @@ void UiCaptureExporter::exportToCsv(QWidget* w)
 
             }
 
-            foreach(QVector<double>* d, analogData) {
+            for (int j = 0; j < analogData.size(); j++) {
                 sampleRow.append(delim);
-                sampleRow.append(QString("%1").arg(d->at(i)));
+                sampleRow.append(QString("%1").arg(analogData.at(j)->at(i-analogShift.at(j))));
                 //out << delim << d->at(i);
             }
 
@@ -25,6 +25,7 @@
 #include "uidigitaltrigger.h"
 #include "common/configuration.h"
 #include "device/devicemanager.h"
+#include "common/instrumentation.h"
 
 
 /*!
@@ -123,6 +124,7 @@ void UiDigitalSignal::setTriggerState(DigitalSignal::DigitalTriggerState state)
 void UiDigitalSignal::paintEvent(QPaintEvent *event)
 {
     (void)event;
+    InstrumentationTimer timer("Paint " + getName());
     QPainter painter(this);
 
 
@@ -142,7 +144,7 @@ void UiDigitalSignal::paintEvent(QPaintEvent *event)
     // -----------------
     // draw signal
     // -----------------
-    QList<int> trans;
+    QVector<SampleIndex> trans;
 
     device->digitalTransitions(mSignal->id(), trans);
 
@@ -171,16 +173,16 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
     QVector<int>* data = device->digitalData(mSignal->id());
-    QList<int> trans;
+    QVector<SampleIndex> trans;
 
     device->digitalTransitions(mSignal->id(), trans);
 
     if (data != NULL && event->pos().x() >= plotX()) {
-        double xTime = mTimeAxis->pixelToTimeRelativeRef(
-                    event->pos().x());
+        int rate = device->usedSampleRate();
 
         // find first sample
-        int idx = (int)(xTime*device->usedSampleRate());
+        SampleIndex idx = mTimeAxis->pixelToSampleRelativeRef(
+                    event->pos().x(), rate);
 
         do {
 
@@ -207,7 +209,7 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
             */
 
             // find first transition left of index
-            int leftTransitionIdx = -1;
+            SampleIndex leftTransitionIdx = -1;
             for (int i = 1; i < trans.size(); i++) {
                 if (trans.at(i) > idx && i > 1) {
                     leftTransitionIdx = trans.at(i-1);
@@ -223,7 +225,7 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
             // no transition
             if (idx > trans.size()-1) break;
 
-            int right1TransitionIdx = trans.at(idx);
+            SampleIndex right1TransitionIdx = trans.at(idx);
             // record logic level at first transition right of point
             if ((idx % 2) != 0) {
                 level = ((level + 1) % 2);
@@ -233,7 +235,7 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
             // no transition
             if (idx > trans.size()-1) break;
 
-            int right2TransitionIdx = trans.at(idx);
+            SampleIndex right2TransitionIdx = trans.at(idx);
 
 
             bool highLow = true;
@@ -241,10 +243,9 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
                 highLow = false;
             }
 
-            int rate = device->usedSampleRate();
-            double t1 = (double)(leftTransitionIdx)/rate;
-            double t2 = (double)(right1TransitionIdx)/rate;
-            double t3 = (double)(right2TransitionIdx)/rate;
+            double t1 = SampleTime::toSeconds(leftTransitionIdx, rate);
+            double t2 = SampleTime::toSeconds(right1TransitionIdx, rate);
+            double t3 = SampleTime::toSeconds(right2TransitionIdx, rate);
 
             // check if this is a new measurement
             if (t1 != mTransitionTimes[0] ||
@@ -299,82 +300,27 @@ void UiDigitalSignal::showEvent(QShowEvent* event)
 }
 
 /*!
-    Paint the signal data.
+    Paint the signal data. The state of each pixel column is found by the
+    DigitalRasterizer, so the time it takes depends on the width of the
+    widget and not on the number of transitions in \a data.
 */
-void UiDigitalSignal::paintSignal(QPainter* painter, QList<int> *data,
+void UiDigitalSignal::paintSignal(QPainter* painter, QVector<SampleIndex> *data,
                                   int sampleRate)
 {
 
     int yFactor = height()/2;
 
-    int fromIdx = (int)(mTimeAxis->rangeLower()*sampleRate);
-
-    if (fromIdx < 0) fromIdx = 0;
-
-    int toIdx = 0;
-    int level = data->at(0);
-
-    double from = 0;
-    double to = 0;
-//    double lastTransitionPx = -1;
-
-    painter->save();
-    painter->setClipRect(infoWidth(), 0, plotWidth(), height());
-
     // vertical: position signal at center
-    painter->translate(0, height()-(height()-yFactor)/2);
-
-    int start = 1;
-    for (start = 1; start < data->size(); start++) {
-        if (data->at(start) > fromIdx) break;
-    }
-
-    if ((start % 2) == 0) {
-        level = ((level + 1) % 2);
-    }
+    int yLow = height()-(height()-yFactor)/2;
+    int yHigh = yLow - yFactor;
 
-    for (int i = start; i < data->size(); i++) {
+    double startTime = mTimeAxis->pixelToTimeRelativeRef(plotX());
+    double columnTime = mTimeAxis->pixelToTimeRelativeRef(plotX()+1) - startTime;
 
-        toIdx = data->at(i);
-
-        from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
-        to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
-
-        // no need to draw when signal is out of plot area
-        if (from > width()) {
-            break;
-        }
-
-        // optimize: don't draw anything if we have already
-        // drawn transition at this position
-        double diff = to - from;
-        if (diff < 0) diff = -diff;
-        if (diff < 1) {
-            level = ((level + 1) % 2);
-            continue;
-        }
-
-        painter->drawLine(from, -level*yFactor,
-                          to, -level*yFactor);
-
-
-        // the last index of the transition list contains the
-        // last index of the signal data independent of any
-        // transition
-        if (i < data->size()-1) {
-            // transition: draw vertical line
-            painter->drawLine(to, -level*yFactor,
-                              to, -((level + 1)%2)*yFactor);
-//            lastTransitionPx = to;
-        }
-
-
-        level = ((level + 1) % 2);
-        fromIdx = toIdx;
-
-    }
+    mRasterizer.resolve(*data, sampleRate, startTime, columnTime, plotWidth());
 
-    painter->restore();
+    painter->drawImage(plotX(), 0, mRasterizer.render(height(), yHigh, yLow,
+                                                      painter->pen().color()));
 }
 
 /*!
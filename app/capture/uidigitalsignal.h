@@ -23,6 +23,7 @@
 
 #include "uisimpleabstractsignal.h"
 #include "uidigitaltrigger.h"
+#include "digitalrasterizer.h"
 
 #include "device/digitalsignal.h"
 
@@ -60,12 +61,14 @@ private:
     double mTransitionTimes[3];
     double mMouseOverValid;
 
+    DigitalRasterizer mRasterizer;
+
 
     enum Constants {
         SignalIdMarginRight = 10
     };
 
-    void paintSignal(QPainter* painter, QList<int>* data, int sampleRate);
+    void paintSignal(QPainter* painter, QVector<SampleIndex>* data, int sampleRate);
     void paintArrows(QPainter* painter);
 
     void infoWidthChanged();
@@ -0,0 +1,322 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uidigitalstatisticsdialog.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+
+#include "cursormanager.h"
+#include "device/devicemanager.h"
+#include "common/inputhelper.h"
+#include "common/stringutil.h"
+
+/*!
+    \class UiDigitalStatisticsDialog
+    \brief Dialog window showing pulse width and period statistics of a
+    digital signal.
+
+    \ingroup Capture
+
+    The statistics are computed for the whole capture or for the part
+    between two cursors by a DigitalStatisticsJob on a worker thread. The
+    transition list of each signal and the statistics of each range are
+    cached until the next capture has finished, so moving between signals
+    and ranges that have already been computed is immediate.
+*/
+
+
+/*!
+    Constructs the UiDigitalStatisticsDialog with the given \a parent.
+*/
+UiDigitalStatisticsDialog::UiDigitalStatisticsDialog(QWidget *parent) :
+    QDialog(parent)
+{
+    mJob = NULL;
+
+    setWindowTitle(tr("Digital Statistics"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* formLayout = new QFormLayout;
+
+    mSignalBox = InputHelper::createSignalBox(this, 0);
+    formLayout->addRow(tr("Signal: "), mSignalBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mFromBox = new QComboBox(this);
+    formLayout->addRow(tr("From: "), mFromBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mToBox = new QComboBox(this);
+    formLayout->addRow(tr("To: "), mToBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mCalculateButton = new QPushButton(tr("Calculate"), this);
+    mStatusLbl = new QLabel(this);
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QHBoxLayout* calculateLayout = new QHBoxLayout();
+    calculateLayout->addWidget(mCalculateButton);
+    calculateLayout->addWidget(mStatusLbl);
+    calculateLayout->addStretch();
+    formLayout->addRow(calculateLayout);
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* resultLayout = new QFormLayout;
+
+    for (int i = 0; i < NumResults; i++) {
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        mResult[i] = new QLabel(this);
+        mResult[i]->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    }
+    resultLayout->addRow(tr("Rising edges: "), mResult[ResultRisingEdges]);
+    resultLayout->addRow(tr("Falling edges: "), mResult[ResultFallingEdges]);
+    resultLayout->addRow(tr("High width (min/mean/max): "), mResult[ResultHighWidth]);
+    resultLayout->addRow(tr("Low width (min/mean/max): "), mResult[ResultLowWidth]);
+    resultLayout->addRow(tr("Period (min/mean/max): "), mResult[ResultPeriod]);
+    resultLayout->addRow(tr("Period jitter (RMS): "), mResult[ResultJitter]);
+    resultLayout->addRow(tr("Frequency (mean): "), mResult[ResultFrequency]);
+    resultLayout->addRow(tr("Duty cycle (mean): "), mResult[ResultDutyCycle]);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mHistogram = new QTableWidget(0, 3, this);
+    mHistogram->setHorizontalHeaderLabels(QStringList()
+                                          << tr("Pulse width")
+                                          << tr("High pulses")
+                                          << tr("Low pulses"));
+    mHistogram->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    mHistogram->setSelectionMode(QAbstractItemView::NoSelection);
+    mHistogram->verticalHeader()->setVisible(false);
+    mHistogram->horizontalHeader()->setStretchLastSection(true);
+
+
+    // Deallocation: Ownership changed when calling setLayout
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Close,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(rejected()), this, SLOT(reject()));
+    connect(mCalculateButton, SIGNAL(clicked()), this, SLOT(calculate()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addLayout(resultLayout);
+    verticalLayout->addWidget(mHistogram);
+    verticalLayout->addWidget(bottonBox);
+
+
+    setLayout(verticalLayout);
+
+    QList<Device*> devices = DeviceManager::instance().devices();
+    for (int i = 0; i < devices.size(); i++) {
+        Device* device = devices.at(i);
+
+        if (device->captureDevice() != NULL) {
+            connect(device->captureDevice(),
+                    SIGNAL(captureFinished(bool,QString)),
+                    this, SLOT(clearCache()));
+        }
+    }
+}
+
+/*!
+    Releases a running job, it deletes itself when it has stopped.
+*/
+UiDigitalStatisticsDialog::~UiDigitalStatisticsDialog()
+{
+    if (mJob != NULL) {
+        mJob->release();
+    }
+}
+
+/*!
+    Removes all cached statistics, e.g. because there is a new capture.
+*/
+void UiDigitalStatisticsDialog::clearCache()
+{
+    mTransitionCache.clear();
+    mStatisticsCache.clear();
+
+    showStatistics(DigitalStatistics());
+
+    // a job still running computes statistics for the old capture
+    if (mJob != NULL) {
+        mJob->release();
+        mJob = NULL;
+        calculate();
+    }
+}
+
+/*!
+    Event handler called when this widget is being shown. The cursor boxes
+    are updated since cursors may have been enabled or disabled.
+*/
+void UiDigitalStatisticsDialog::showEvent(QShowEvent* event)
+{
+    (void) event;
+    InputHelper::fillActiveCursorsBox(mFromBox, tr("Start of capture"));
+    InputHelper::fillActiveCursorsBox(mToBox, tr("End of capture"));
+}
+
+/*!
+    Shows the statistics for the selected signal and range. They are taken
+    from the cache if available, otherwise a job is started to compute them.
+*/
+void UiDigitalStatisticsDialog::calculate()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+
+    int signalId = InputHelper::intValue(mSignalBox);
+    QVector<int>* data = device->digitalData(signalId);
+    if (data == NULL || data->size() == 0) {
+        mStatusLbl->setText(tr("No data"));
+        showStatistics(DigitalStatistics());
+        return;
+    }
+
+    // the cursors are relative to the digital signals
+    int rate = device->usedSampleRate();
+    SampleIndex lastIdx = data->size()-1;
+    SampleIndex fromIdx = CursorManager::instance().cursorSampleIndex(
+                (UiCursor::CursorId)InputHelper::intValue(mFromBox), rate, 0, 0);
+    SampleIndex toIdx = CursorManager::instance().cursorSampleIndex(
+                (UiCursor::CursorId)InputHelper::intValue(mToBox), rate, 0, lastIdx);
+    toIdx = qMin(toIdx, lastIdx);
+    if (fromIdx > toIdx) {
+        qSwap(fromIdx, toIdx);
+    }
+
+    CacheKey key(signalId, qMakePair(fromIdx, toIdx));
+    if (mStatisticsCache.contains(key)) {
+        mStatusLbl->setText("");
+        showStatistics(mStatisticsCache.value(key));
+        return;
+    }
+
+    // only the selected signal and range is of interest
+    if (mJob != NULL) {
+        mJob->release();
+        mJob = NULL;
+    }
+
+    mStatusLbl->setText(tr("Calculating..."));
+
+    mJob = new DigitalStatisticsJob(signalId, *data, mTransitionCache.value(signalId),
+                                    fromIdx, toIdx);
+    connect(mJob, SIGNAL(finished()), this, SLOT(handleJobFinished()));
+    mJob->start();
+}
+
+/*!
+    Called when the statistics job has finished.
+*/
+void UiDigitalStatisticsDialog::handleJobFinished()
+{
+    if (mJob == NULL || sender() != mJob) return;
+
+    const DigitalStatistics &s = mJob->statistics();
+    mTransitionCache.insert(mJob->signalId(), mJob->transitions());
+    mStatisticsCache.insert(CacheKey(mJob->signalId(), qMakePair(s.fromIdx(), s.toIdx())), s);
+
+    mJob->release();
+    mJob = NULL;
+
+    calculate();
+}
+
+/*!
+    Shows \a statistics in the dialog. Invalid statistics clear the dialog.
+*/
+void UiDigitalStatisticsDialog::showStatistics(const DigitalStatistics &statistics)
+{
+    for (int i = 0; i < NumResults; i++) {
+        mResult[i]->setText("");
+    }
+    mHistogram->setRowCount(0);
+
+    if (!statistics.isValid()) return;
+
+    int rate = DeviceManager::instance().activeDevice()->captureDevice()->usedSampleRate();
+    if (rate <= 0) return;
+
+    mResult[ResultRisingEdges]->setText(QString::number(statistics.numRisingEdges()));
+    mResult[ResultFallingEdges]->setText(QString::number(statistics.numFallingEdges()));
+    mResult[ResultHighWidth]->setText(summaryToString(statistics.highWidth(), rate));
+    mResult[ResultLowWidth]->setText(summaryToString(statistics.lowWidth(), rate));
+    mResult[ResultPeriod]->setText(summaryToString(statistics.period(), rate));
+
+    const DigitalStatistics::Summary &period = statistics.period();
+    if (period.count > 0) {
+        mResult[ResultJitter]->setText(StringUtil::timeInSecToString(period.deviation / rate));
+        mResult[ResultFrequency]->setText(StringUtil::frequencyToString(rate / period.mean));
+    }
+
+    double duty = statistics.dutyCycle();
+    if (duty >= 0) {
+        mResult[ResultDutyCycle]->setText(QString("%1 %").arg(duty, 0, 'f', 2));
+    }
+
+    const QVector<int> &high = statistics.highHistogram();
+    const QVector<int> &low = statistics.lowHistogram();
+
+    mHistogram->setRowCount(high.size());
+    for (int i = 0; i < high.size(); i++) {
+        SampleIndex start = statistics.histogramStart() + i*statistics.histogramBinWidth();
+        SampleIndex end = start + statistics.histogramBinWidth();
+
+        setCell(i, 0, QString("%1 - %2")
+                .arg(StringUtil::timeInSecToString(SampleTime::toSeconds(start, rate)))
+                .arg(StringUtil::timeInSecToString(SampleTime::toSeconds(end, rate))));
+        setCell(i, 1, QString::number(high.at(i)));
+        setCell(i, 2, QString::number(low.at(i)));
+    }
+}
+
+/*!
+    Returns the minimum, mean and maximum of \a s, which is in samples at
+    the sample \a rate, as a string.
+*/
+QString UiDigitalStatisticsDialog::summaryToString(const DigitalStatistics::Summary &s, int rate)
+{
+    if (s.count == 0) return tr("-");
+
+    return QString("%1 / %2 / %3 (%4)")
+            .arg(StringUtil::timeInSecToString(SampleTime::toSeconds(s.min, rate)))
+            .arg(StringUtil::timeInSecToString(s.mean / rate))
+            .arg(StringUtil::timeInSecToString(SampleTime::toSeconds(s.max, rate)))
+            .arg(s.count);
+}
+
+/*!
+    Sets the \a text of the histogram cell at \a row and \a column.
+*/
+void UiDigitalStatisticsDialog::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem* item = mHistogram->item(row, column);
+    if (item == NULL) {
+        // Deallocation: the table takes ownership of the item
+        item = new QTableWidgetItem();
+        mHistogram->setItem(row, column, item);
+    }
+    item->setText(text);
+}
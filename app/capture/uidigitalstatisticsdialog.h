@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIDIGITALSTATISTICSDIALOG_H
+#define UIDIGITALSTATISTICSDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QMap>
+#include <QPair>
+
+#include "digitalstatistics.h"
+
+class UiDigitalStatisticsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiDigitalStatisticsDialog(QWidget *parent = 0);
+    ~UiDigitalStatisticsDialog();
+
+signals:
+
+public slots:
+    void clearCache();
+
+protected:
+    void showEvent(QShowEvent* event);
+
+private slots:
+    void calculate();
+    void handleJobFinished();
+
+private:
+
+    enum ResultIndexes {
+        ResultRisingEdges = 0,
+        ResultFallingEdges,
+        ResultHighWidth,
+        ResultLowWidth,
+        ResultPeriod,
+        ResultJitter,
+        ResultFrequency,
+        ResultDutyCycle,
+        NumResults // Must be last
+    };
+
+    // signal ID and range
+    typedef QPair<int, QPair<SampleIndex, SampleIndex> > CacheKey;
+
+    QComboBox* mSignalBox;
+    QComboBox* mFromBox;
+    QComboBox* mToBox;
+    QPushButton* mCalculateButton;
+    QLabel* mStatusLbl;
+    QLabel* mResult[NumResults];
+    QTableWidget* mHistogram;
+
+    DigitalStatisticsJob* mJob;
+    QMap<int, QVector<SampleIndex> > mTransitionCache;
+    QMap<CacheKey, DigitalStatistics> mStatisticsCache;
+
+    void showStatistics(const DigitalStatistics &statistics);
+    QString summaryToString(const DigitalStatistics::Summary &s, int rate);
+    void setCell(int row, int column, const QString &text);
+};
+
+#endif // UIDIGITALSTATISTICSDIALOG_H
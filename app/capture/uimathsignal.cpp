@@ -0,0 +1,415 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uimathsignal.h"
+
+#include <QDebug>
+#include <QPainter>
+#include <QStringList>
+
+#include "uimathsignalconfig.h"
+#include "common/configuration.h"
+#include "common/instrumentation.h"
+#include "device/devicemanager.h"
+
+/*!
+    Counter used when creating the editable name.
+*/
+int UiMathSignal::mathSignalCounter = 0;
+
+/*!
+    Type name of math signals in the settings string.
+*/
+const QString UiMathSignal::name = "Math";
+
+/*!
+    \class UiMathSignal
+    \brief UI widget that shows a signal calculated from the analog
+    signals.
+
+    \ingroup Capture
+
+    The signal is defined by an expression, see MathExpression, and is
+    calculated by a MathChannel. Only the samples within the visible part
+    of the plot are calculated, and they are cached until the next
+    capture. The signal is drawn with its zero level in the middle of the
+    widget and with scale() units per division.
+
+    When the signal is zoomed out the parts that haven't been calculated
+    are calculated by a MathRangeJob on a worker thread instead of in
+    paintEvent(). The widget is repainted when the job has finished.
+*/
+
+
+/*!
+    Constructs the UiMathSignal with the given \a parent.
+*/
+UiMathSignal::UiMathSignal(QWidget *parent) :
+    UiSimpleAbstractSignal(parent)
+{
+    mRangeJob = NULL;
+    mScale = 1;
+    mOffset = 0;
+
+    mIdLbl->setText("MATH");
+    mNameLbl->setText(QString("Math %1").arg(mathSignalCounter++));
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mExpressionLbl = new QLabel(this);
+
+    QPalette palette= mExpressionLbl->palette();
+    palette.setColor(QPalette::Text, Qt::gray);
+    mExpressionLbl->setPalette(palette);
+
+    setConfigurable();
+    setFixedHeight(100);
+}
+
+/*!
+    Releases a running range job, it deletes itself when it has stopped.
+*/
+UiMathSignal::~UiMathSignal()
+{
+    if (mRangeJob != NULL) {
+        mRangeJob->release();
+    }
+}
+
+/*!
+    Set the expression to \a text. Returns false if it isn't a valid
+    expression.
+*/
+bool UiMathSignal::setExpression(const QString &text)
+{
+    bool ok = mChannel.setExpression(text);
+    updateLabel();
+    return ok;
+}
+
+/*!
+    \fn QString UiMathSignal::expression() const
+
+    Returns the expression.
+*/
+
+/*!
+    \fn bool UiMathSignal::isValid() const
+
+    Returns true if the expression is valid.
+*/
+
+/*!
+    Set the vertical scale to \a unitsPerDiv units per division.
+*/
+void UiMathSignal::setScale(double unitsPerDiv)
+{
+    if (unitsPerDiv <= 0) return;
+
+    mScale = unitsPerDiv;
+    updateLabel();
+}
+
+/*!
+    \fn double UiMathSignal::scale() const
+
+    Returns the vertical scale in units per division.
+*/
+
+/*!
+    Called when signal data has changed. Drops the samples calculated for
+    the previous capture.
+*/
+void UiMathSignal::handleSignalDataChanged()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+
+    mChannel.setSampleRate(device->usedSampleRate());
+
+    QList<int> inputs = mChannel.expression().inputs();
+    foreach(int id, inputs) {
+        QVector<double>* data = device->analogData(id);
+        mChannel.setInput(id, (data != NULL ? *data : QVector<double>()));
+    }
+
+    // the analog signals are sampled together, use the time offset of
+    // the first one
+    mOffset = 0;
+    if (!inputs.isEmpty() && device->usedSampleRate() > 0) {
+        mOffset = SampleTime::nearestSample(device->analogTimeOffset(inputs.at(0)),
+                                            device->usedSampleRate());
+    }
+
+    mChannel.clear();
+    if (mRangeJob != NULL) {
+        // its result is no longer wanted as the channel has been cleared
+        mRangeJob->release();
+        mRangeJob = NULL;
+    }
+    update();
+}
+
+/*!
+    Configure the signal.
+*/
+void UiMathSignal::configure(QWidget *parent)
+{
+    UiMathSignalConfig dialog(parent);
+    dialog.setExpression(expression());
+    dialog.setScale(mScale);
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    setExpression(dialog.expression());
+    setScale(dialog.scale());
+
+    handleSignalDataChanged();
+}
+
+/*!
+    Returns a string representation of this signal.
+*/
+QString UiMathSignal::toSettingsString() const
+{
+    // type;name;Scale;Expression
+
+    QString str;
+    str.append(UiMathSignal::name);str.append(";");
+    str.append(getName());str.append(";");
+    str.append(QString("%1;").arg(mScale));
+    str.append(expression());
+
+    return str;
+}
+
+/*!
+    Create a math signal from the string representation \a s.
+
+    \sa toSettingsString
+*/
+UiMathSignal* UiMathSignal::fromSettingsString(const QString &s)
+{
+    UiMathSignal* signal = NULL;
+    QString name;
+
+    bool ok = false;
+
+    do {
+        // type;name;Scale;Expression
+        QStringList list = s.split(';');
+        if (list.size() != 4) break;
+
+        // --- type
+        if (list.at(0) != UiMathSignal::name) break;
+
+        // --- name
+        name = list.at(1);
+        if (name.isNull()) break;
+
+        // --- scale
+        double scale = list.at(2).toDouble(&ok);
+        if (!ok) break;
+
+        // Deallocation: The caller of this function is responsible for
+        //               deallocation
+        signal = new UiMathSignal();
+        if (signal == NULL) break;
+
+        signal->setSignalName(name);
+        signal->setScale(scale);
+        signal->setExpression(list.at(3));
+
+    } while (false);
+
+    return signal;
+}
+
+/*!
+    Paint event handler responsible for painting this widget.
+*/
+void UiMathSignal::paintEvent(QPaintEvent *event)
+{
+    (void)event;
+    InstrumentationTimer timer("Paint " + getName());
+    QPainter painter(this);
+
+    // -----------------
+    // draw background
+    // -----------------
+    paintBackground(&painter);
+
+    if (mTimeAxis == NULL) return;
+
+    int rate = DeviceManager::instance().activeDevice()
+            ->captureDevice()->usedSampleRate();
+    if (rate <= 0 || mChannel.numSamples() == 0) return;
+
+    painter.setClipRect(plotX(), 0, width()-plotX(), height());
+
+    // zero level
+    QPen pen = painter.pen();
+    pen.setColor(Configuration::instance().gridColor());
+    pen.setStyle(Qt::DashLine);
+    painter.setPen(pen);
+    painter.drawLine(plotX(), height()/2, width(), height()/2);
+
+    pen.setColor(Configuration::instance().analyzerColor());
+    pen.setStyle(Qt::SolidLine);
+    painter.setPen(pen);
+
+    paintSignal(&painter, rate);
+}
+
+/*!
+    Event handler called when this widget is being shown
+*/
+void UiMathSignal::showEvent(QShowEvent* event)
+{
+    (void) event;
+    doLayout();
+    setMinimumInfoWidth(calcMinimumWidth());
+}
+
+/*!
+    Update the label showing the expression and scale.
+*/
+void UiMathSignal::updateLabel()
+{
+    mExpressionLbl->setText(QString("%1, %2/div").arg(expression()).arg(mScale));
+    mExpressionLbl->adjustSize();
+}
+
+/*!
+    Paints the visible part of the signal using \a painter. The signal is
+    sampled at \a sampleRate Hz.
+
+    When a pixel column covers several samples a vertical line is drawn
+    between the minimum and maximum value in the column, including the
+    last sample of the previous column so that the columns are connected.
+    Otherwise the samples are connected with lines.
+*/
+void UiMathSignal::paintSignal(QPainter* painter, int sampleRate)
+{
+    double pxPerUnit = (double)height()/(NumDivs*mScale);
+    double y0 = height()/2.0;
+
+    SampleIndex first = mTimeAxis->pixelToSampleRelativeRef(plotX(), sampleRate) - mOffset;
+    SampleIndex last = mTimeAxis->pixelToSampleRelativeRef(width(), sampleRate) - mOffset + 1;
+    first = qMax(first, (SampleIndex)0);
+    last = qMin(last, mChannel.numSamples()-1);
+    if (first > last) return;
+
+    if (last - first < plotWidth()) {
+        QPolygonF line;
+        for (SampleIndex idx = first; idx <= last; idx++) {
+            double x = mTimeAxis->sampleToPixelRelativeRef(idx + mOffset, sampleRate);
+            line.append(QPointF(x, y0 - mChannel.value(idx)*pxPerUnit));
+        }
+        painter->drawPolyline(line);
+        return;
+    }
+
+    SampleIndex fromIdx = first;
+    for (int x = plotX(); x < width() && fromIdx <= last; x++) {
+        SampleIndex toIdx = mTimeAxis->pixelToSampleRelativeRef(x+1, sampleRate) - mOffset;
+        if (toIdx <= fromIdx) continue;
+
+        double min;
+        double max;
+        if (mChannel.range(qMax(fromIdx-1, (SampleIndex)0), toIdx, min, max)) {
+            painter->drawLine(QPointF(x, y0 - min*pxPerUnit),
+                              QPointF(x, y0 - max*pxPerUnit));
+        }
+
+        fromIdx = toIdx;
+    }
+
+    startRangeJob();
+}
+
+/*!
+    Starts a job calculating the chunks that were skipped when the signal
+    was painted, unless a job is already running.
+*/
+void UiMathSignal::startRangeJob()
+{
+    if (mRangeJob != NULL) return;
+
+    QList<int> chunks = mChannel.takeMissingChunks();
+    if (chunks.isEmpty()) return;
+
+    mRangeJob = new MathRangeJob(mChannel, chunks);
+    connect(mRangeJob, SIGNAL(finished()), this, SLOT(handleRangeJobFinished()));
+    mRangeJob->start();
+}
+
+/*!
+    Called when the range job has finished. Adds its result to the channel
+    and repaints the signal, which starts a new job if there are chunks
+    left to calculate.
+*/
+void UiMathSignal::handleRangeJobFinished()
+{
+    if (mRangeJob == NULL || sender() != mRangeJob) return;
+
+    mChannel.addRanges(mRangeJob->generation(), mRangeJob->ranges());
+
+    mRangeJob->release();
+    mRangeJob = NULL;
+
+    update();
+}
+
+/*!
+    Called when the info width has changed for this widget.
+*/
+void UiMathSignal::infoWidthChanged()
+{
+    doLayout();
+}
+
+/*!
+    Position the child widgets.
+*/
+void UiMathSignal::doLayout()
+{
+    UiSimpleAbstractSignal::doLayout();
+
+    QRect r = infoContentRect();
+    int y = r.top();
+
+    mIdLbl->move(r.left(), y);
+
+    int x = mIdLbl->pos().x()+mIdLbl->width() + SignalIdMarginRight;
+    mNameLbl->move(x, y);
+    mEditName->move(x, y);
+
+    mExpressionLbl->move(r.left(), r.bottom()-mExpressionLbl->height());
+}
+
+/*!
+    Calculate and return the minimum width for this widget.
+*/
+int UiMathSignal::calcMinimumWidth()
+{
+    int w = mNameLbl->pos().x() + mNameLbl->minimumSizeHint().width();
+    if (mEditName->isVisible()) {
+        w = mEditName->pos().x() + mEditName->width();
+    }
+
+    int w2 = mExpressionLbl->pos().x()+mExpressionLbl->width();
+    if (w2 > w) w = w2;
+
+    return w+infoContentMargin().right();
+}
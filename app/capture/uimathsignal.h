@@ -0,0 +1,85 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIMATHSIGNAL_H
+#define UIMATHSIGNAL_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QShowEvent>
+
+#include "uisimpleabstractsignal.h"
+#include "mathchannel.h"
+
+class UiMathSignal : public UiSimpleAbstractSignal
+{
+    Q_OBJECT
+public:
+    explicit UiMathSignal(QWidget *parent = 0);
+    ~UiMathSignal();
+
+    bool setExpression(const QString &text);
+    QString expression() const {return mChannel.expression().text();}
+    bool isValid() const {return mChannel.expression().isValid();}
+
+    void setScale(double unitsPerDiv);
+    double scale() const {return mScale;}
+
+    void handleSignalDataChanged();
+
+    QString toSettingsString() const;
+    static UiMathSignal* fromSettingsString(const QString &s);
+
+    static const QString name;
+
+signals:
+
+public slots:
+    void configure(QWidget* parent);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void showEvent(QShowEvent* event);
+
+private slots:
+    void handleRangeJobFinished();
+
+private:
+
+    enum Constants {
+        SignalIdMarginRight = 10,
+        NumDivs = 4
+    };
+
+    static int mathSignalCounter;
+
+    MathChannel mChannel;
+    MathRangeJob* mRangeJob;
+    double mScale;
+    SampleIndex mOffset;
+
+    QLabel* mExpressionLbl;
+
+    void updateLabel();
+    void paintSignal(QPainter* painter, int sampleRate);
+    void startRangeJob();
+
+    void infoWidthChanged();
+    void doLayout();
+    int calcMinimumWidth();
+
+};
+
+#endif // UIMATHSIGNAL_H
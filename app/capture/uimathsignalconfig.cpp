@@ -0,0 +1,153 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uimathsignalconfig.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QDoubleValidator>
+
+#include "mathexpression.h"
+
+/*!
+    \class UiMathSignalConfig
+    \brief Dialog window used to configure a math signal.
+
+    \ingroup Capture
+
+    The expression is validated when the dialog is accepted and the dialog
+    stays open, showing the error, until it is valid.
+*/
+
+
+/*!
+    Constructs the UiMathSignalConfig with the given \a parent.
+*/
+UiMathSignalConfig::UiMathSignalConfig(QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle(tr("Math Signal"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* formLayout = new QFormLayout;
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mExpressionEdit = new QLineEdit(this);
+    mExpressionEdit->setMinimumWidth(250);
+    mExpressionEdit->setToolTip(tr("Inputs: A0, A1, ...\n"
+                                   "Operators: + - * /\n"
+                                   "Functions: abs(x), avg(x, n), lowpass(x, fc),\n"
+                                   "fir(x, fc), fir(x, fc, taps), deriv(x)\n"
+                                   "lowpass() needs fc > sample rate / 470000"));
+    formLayout->addRow(tr("Expression: "), mExpressionEdit);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mScaleEdit = new QLineEdit(this);
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDoubleValidator* validator = new QDoubleValidator(this);
+    validator->setBottom(0);
+    mScaleEdit->setValidator(validator);
+    formLayout->addRow(tr("Units per division: "), mScaleEdit);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mErrorLbl = new QLabel(this);
+    QPalette palette = mErrorLbl->palette();
+    palette.setColor(QPalette::WindowText, Qt::red);
+    mErrorLbl->setPalette(palette);
+    mErrorLbl->hide();
+
+
+    // Deallocation: Ownership changed when calling setLayout
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Ok|QDialogButtonBox::Cancel,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(bottonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(mErrorLbl);
+    verticalLayout->addWidget(bottonBox);
+
+
+    setLayout(verticalLayout);
+}
+
+/*!
+    Returns the expression.
+*/
+QString UiMathSignalConfig::expression()
+{
+    return mExpressionEdit->text().trimmed();
+}
+
+/*!
+    Set the expression to \a text.
+*/
+void UiMathSignalConfig::setExpression(const QString &text)
+{
+    mExpressionEdit->setText(text);
+}
+
+/*!
+    Returns the vertical scale in units per division.
+*/
+double UiMathSignalConfig::scale()
+{
+    return mScaleEdit->text().toDouble();
+}
+
+/*!
+    Set the vertical scale to \a unitsPerDiv units per division.
+*/
+void UiMathSignalConfig::setScale(double unitsPerDiv)
+{
+    mScaleEdit->setText(QString::number(unitsPerDiv));
+}
+
+/*!
+    Called when the user clicks OK. Closes the dialog if the expression
+    and scale are valid; otherwise the error is shown.
+*/
+void UiMathSignalConfig::accept()
+{
+    MathExpression e;
+    QString error;
+
+    if (!e.parse(expression())) {
+        error = e.errorString();
+    }
+    else if (e.inputs().isEmpty()) {
+        error = tr("The expression must use at least one analog signal");
+    }
+    else if (scale() <= 0) {
+        error = tr("Invalid number of units per division");
+    }
+
+    if (!error.isNull()) {
+        mErrorLbl->setText(error);
+        mErrorLbl->show();
+        return;
+    }
+
+    QDialog::accept();
+}
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIMATHSIGNALCONFIG_H
+#define UIMATHSIGNALCONFIG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+
+class UiMathSignalConfig : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiMathSignalConfig(QWidget *parent = 0);
+
+    QString expression();
+    void setExpression(const QString &text);
+
+    double scale();
+    void setScale(double unitsPerDiv);
+
+signals:
+
+public slots:
+    void accept();
+
+private:
+
+    QLineEdit* mExpressionEdit;
+    QLineEdit* mScaleEdit;
+    QLabel* mErrorLbl;
+
+};
+
+#endif // UIMATHSIGNALCONFIG_H
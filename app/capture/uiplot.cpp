@@ -135,14 +135,13 @@ void UiPlot::handleSignalDataChanged()
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
-    int idx = device->digitalTriggerIndex();
 
     // We need the trigger position (pixel position) to remain the
     // same between captures. If not, the user experience will be bad since
     // the trigger will move along the x-axis...
     double currRef = mTimeAxis->reference();
     double currTrig = mCursor->cursorPosition(UiCursor::Trigger);
-    double newTrig = (double)idx/device->usedSampleRate();
+    double newTrig = device->triggerTime().toSeconds();
     double newRef = currRef-currTrig+newTrig;
 
     // cursor times should be relative to the trigger
@@ -576,7 +575,7 @@ QPoint UiPlot::mapToCursor(const QPoint &pos) const
 double UiPlot::getEndTime()
 {
     CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
-    return (double)device->lastSampleIndex() / device->usedSampleRate();
+    return device->sampleTime(device->lastSampleIndex()).toSeconds();
 }
 
 /*!
@@ -49,6 +49,7 @@ UiSelectSignalDialog::UiSelectSignalDialog(QWidget *parent) :
     mAnalogSignalsMap()
 {
     mAnalyzersBox = NULL;
+    mMathSignalBox = NULL;
 
     setWindowTitle(tr("Add Signal or Analyzer"));
     setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
@@ -76,6 +77,13 @@ UiSelectSignalDialog::UiSelectSignalDialog(QWidget *parent) :
         formLayout->addRow(tr("Analog signals: "), createAnalogSignalBox(s));
     }
 
+    // math signal calculated from the analog signals
+    if (device->maxNumAnalogSignals() > 0) {
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        mMathSignalBox = new QCheckBox(this);
+        formLayout->addRow(tr("Math signal: "), mMathSignalBox);
+    }
+
     // analyzers
     mAnalyzersBox = createAnalyzerBox();
     formLayout->addRow(tr("Analyzers: "), mAnalyzersBox);
@@ -145,6 +153,14 @@ QString UiSelectSignalDialog::selectedAnalyzer()
     return mAnalyzersBox->itemText(mAnalyzersBox->currentIndex());
 }
 
+/*!
+    Returns true if a math signal should be added.
+*/
+bool UiSelectSignalDialog::mathSignalSelected()
+{
+    return (mMathSignalBox != NULL && mMathSignalBox->isChecked());
+}
+
 /*!
    Create a signal box widget for the \a list of digital signals.
 */
@@ -33,6 +33,7 @@ public:
     QList<int> selectedDigitalSignals();
     QList<int> selectedAnalogSignals();
     QString selectedAnalyzer();
+    bool mathSignalSelected();
 
 signals:
     
@@ -43,6 +44,7 @@ private:
     QMap<int, QCheckBox*> mDigitalSignalsMap;
     QMap<int, QCheckBox*> mAnalogSignalsMap;
     QComboBox* mAnalyzersBox;
+    QCheckBox* mMathSignalBox;
 
     QWidget *createDigitalSignalBox(QList<int> &list);
     QWidget *createAnalogSignalBox(QList<int> &list);
@@ -0,0 +1,273 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uispectrumdialog.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QDialogButtonBox>
+
+#include "cursormanager.h"
+#include "device/devicemanager.h"
+#include "common/inputhelper.h"
+#include "common/stringutil.h"
+
+/*!
+    \class UiSpectrumDialog
+    \brief Dialog window showing the spectrum of an analog signal.
+
+    \ingroup Capture
+
+    The spectrum is computed for the whole capture or for the part between
+    two cursors by an AnalogSpectrumJob. While the dialog is open the
+    spectrum is computed again for every new capture, and the spectra of
+    the last captures (see the Average setting) are averaged, which lowers
+    the noise floor for continuous captures. Changing a setting starts a
+    new average.
+*/
+
+
+/*!
+    Constructs the UiSpectrumDialog with the given \a parent.
+*/
+UiSpectrumDialog::UiSpectrumDialog(QWidget *parent) :
+    QDialog(parent)
+{
+    mJob = NULL;
+    mJobSignalId = 0;
+    mPending = false;
+
+    setWindowTitle(tr("Spectrum"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* formLayout = new QFormLayout;
+
+    mSignalBox = InputHelper::createAnalogSignalBox(this, 0);
+    formLayout->addRow(tr("Signal: "), mSignalBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mFromBox = new QComboBox(this);
+    formLayout->addRow(tr("From: "), mFromBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mToBox = new QComboBox(this);
+    formLayout->addRow(tr("To: "), mToBox);
+
+    mWindowBox = InputHelper::createFftWindowBox(this, Types::FftWindowHann);
+    formLayout->addRow(tr("Window: "), mWindowBox);
+
+    mSizeBox = InputHelper::createFftSizeBox(this, AnalogSpectrum::DefaultFftSize);
+    mSizeBox->setToolTip(tr("Samples per transform. Larger sizes give a finer "
+                            "frequency resolution but less averaging."));
+    formLayout->addRow(tr("FFT size: "), mSizeBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mAverageBox = new QComboBox(this);
+    for (int n = 1; n <= 32; n *= 2) {
+        mAverageBox->addItem(n == 1 ? tr("Off") : tr("%1 captures").arg(n), QVariant(n));
+    }
+    formLayout->addRow(tr("Average: "), mAverageBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mCalculateButton = new QPushButton(tr("Calculate"), this);
+    mStatusLbl = new QLabel(this);
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QHBoxLayout* calculateLayout = new QHBoxLayout();
+    calculateLayout->addWidget(mCalculateButton);
+    calculateLayout->addWidget(mStatusLbl);
+    calculateLayout->addStretch();
+    formLayout->addRow(calculateLayout);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mPlot = new UiSpectrumPlot(this);
+
+
+    // Deallocation: Ownership changed when calling setLayout
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Close,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(rejected()), this, SLOT(reject()));
+    connect(mCalculateButton, SIGNAL(clicked()), this, SLOT(calculate()));
+    connect(mSignalBox, SIGNAL(currentIndexChanged(int)), this, SLOT(settingsChanged()));
+    connect(mFromBox, SIGNAL(currentIndexChanged(int)), this, SLOT(settingsChanged()));
+    connect(mToBox, SIGNAL(currentIndexChanged(int)), this, SLOT(settingsChanged()));
+    connect(mWindowBox, SIGNAL(currentIndexChanged(int)), this, SLOT(settingsChanged()));
+    connect(mSizeBox, SIGNAL(currentIndexChanged(int)), this, SLOT(settingsChanged()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(mPlot, 1);
+    verticalLayout->addWidget(bottonBox);
+
+
+    setLayout(verticalLayout);
+
+    QList<Device*> devices = DeviceManager::instance().devices();
+    for (int i = 0; i < devices.size(); i++) {
+        Device* device = devices.at(i);
+
+        if (device->captureDevice() != NULL) {
+            connect(device->captureDevice(),
+                    SIGNAL(captureFinished(bool,QString)),
+                    this, SLOT(handleCaptureFinished(bool,QString)));
+        }
+    }
+}
+
+/*!
+    Releases a running job, it deletes itself when it has stopped.
+*/
+UiSpectrumDialog::~UiSpectrumDialog()
+{
+    if (mJob != NULL) {
+        mJob->release();
+    }
+}
+
+/*!
+    Event handler called when this widget is being shown. The cursor boxes
+    are updated since cursors may have been enabled or disabled.
+*/
+void UiSpectrumDialog::showEvent(QShowEvent* event)
+{
+    (void) event;
+    InputHelper::fillActiveCursorsBox(mFromBox, tr("Start of capture"));
+    InputHelper::fillActiveCursorsBox(mToBox, tr("End of capture"));
+}
+
+/*!
+    Starts computing the spectrum with the current settings.
+*/
+void UiSpectrumDialog::calculate()
+{
+    // only one job at a time; calculate again when the running one is done
+    if (mJob != NULL) {
+        mPending = true;
+        return;
+    }
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+
+    int signalId = InputHelper::intValue(mSignalBox);
+    QVector<double>* data = device->analogData(signalId);
+    if (data == NULL || data->size() == 0) {
+        mStatusLbl->setText(tr("No data"));
+        return;
+    }
+
+    int rate = device->usedSampleRate();
+    double offset = device->analogTimeOffset(signalId);
+    SampleIndex lastIdx = data->size()-1;
+    SampleIndex fromIdx = CursorManager::instance().cursorSampleIndex(
+                (UiCursor::CursorId)InputHelper::intValue(mFromBox), rate, offset, 0);
+    SampleIndex toIdx = CursorManager::instance().cursorSampleIndex(
+                (UiCursor::CursorId)InputHelper::intValue(mToBox), rate, offset, lastIdx);
+    toIdx = qMin(toIdx, lastIdx);
+    if (fromIdx > toIdx) {
+        qSwap(fromIdx, toIdx);
+    }
+
+    mStatusLbl->setText(tr("Calculating..."));
+
+    mJobSignalId = signalId;
+    mJob = new AnalogSpectrumJob(*data, fromIdx, toIdx, device->usedSampleRate(),
+                                 (Types::FftWindow)InputHelper::intValue(mWindowBox),
+                                 InputHelper::intValue(mSizeBox));
+    connect(mJob, SIGNAL(finished()), this, SLOT(handleJobFinished()));
+    mJob->start();
+}
+
+/*!
+    Called when a setting that changes the spectrum has changed. The
+    spectra computed with the old settings are no longer averaged and a
+    job started with the old settings is released.
+*/
+void UiSpectrumDialog::settingsChanged()
+{
+    mHistory.clear();
+
+    if (mJob != NULL) {
+        mJob->release();
+        mJob = NULL;
+        mStatusLbl->setText(tr("Settings changed"));
+
+        if (mPending) {
+            mPending = false;
+            calculate();
+        }
+    }
+}
+
+/*!
+    Called when a capture has finished. The spectrum of the new capture is
+    computed if the dialog is open.
+*/
+void UiSpectrumDialog::handleCaptureFinished(bool successful, QString msg)
+{
+    (void)msg;
+
+    if (successful && isVisible()) {
+        calculate();
+    }
+}
+
+/*!
+    Called when the spectrum job has finished.
+*/
+void UiSpectrumDialog::handleJobFinished()
+{
+    if (mJob == NULL || sender() != mJob) return;
+
+    AnalogSpectrum spectrum = mJob->spectrum();
+
+    mJob->release();
+    mJob = NULL;
+
+    if (!spectrum.isValid()) {
+        mStatusLbl->setText(tr("Too few samples"));
+    }
+    else {
+        int numAverage = InputHelper::intValue(mAverageBox);
+
+        mHistory.append(spectrum);
+        while (mHistory.size() > numAverage) {
+            mHistory.removeFirst();
+        }
+
+        AnalogSpectrum average = AnalogSpectrum::average(mHistory);
+        mPlot->setSpectrum(average, mJobSignalId);
+
+        QString status = tr("Resolution %1, %2 segments")
+                .arg(StringUtil::frequencyToString(average.binWidth()))
+                .arg(average.numSegments());
+        if (mHistory.size() > 1) {
+            status.append(tr(", %1 captures").arg(mHistory.size()));
+        }
+        mStatusLbl->setText(status);
+    }
+
+    if (mPending) {
+        mPending = false;
+        calculate();
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UISPECTRUMDIALOG_H
+#define UISPECTRUMDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QList>
+
+#include "analogspectrum.h"
+#include "uispectrumplot.h"
+
+class UiSpectrumDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiSpectrumDialog(QWidget *parent = 0);
+    ~UiSpectrumDialog();
+
+signals:
+
+public slots:
+
+protected:
+    void showEvent(QShowEvent* event);
+
+private slots:
+    void calculate();
+    void settingsChanged();
+    void handleCaptureFinished(bool successful, QString msg);
+    void handleJobFinished();
+
+private:
+
+    QComboBox* mSignalBox;
+    QComboBox* mFromBox;
+    QComboBox* mToBox;
+    QComboBox* mWindowBox;
+    QComboBox* mSizeBox;
+    QComboBox* mAverageBox;
+    QPushButton* mCalculateButton;
+    QLabel* mStatusLbl;
+    UiSpectrumPlot* mPlot;
+
+    AnalogSpectrumJob* mJob;
+    int mJobSignalId;
+    bool mPending;
+    QList<AnalogSpectrum> mHistory;
+};
+
+#endif // UISPECTRUMDIALOG_H
@@ -0,0 +1,222 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uispectrumplot.h"
+
+#include <QPainter>
+#include <QMouseEvent>
+#include <qmath.h>
+
+#include "common/configuration.h"
+#include "common/stringutil.h"
+
+/*!
+    \class UiSpectrumPlot
+    \brief UI widget that draws the spectrum of an analog signal.
+
+    \ingroup Capture
+
+    The spectrum is drawn in dBV on a linear frequency axis from DC to half
+    the sample rate. When there are more bins than pixels the highest bin
+    in each column is drawn, so narrow peaks never disappear. The
+    frequency and level at the mouse position are shown in the upper right
+    corner.
+*/
+
+
+/*!
+    Constructs an UiSpectrumPlot with the given \a parent.
+*/
+UiSpectrumPlot::UiSpectrumPlot(QWidget *parent) :
+    QWidget(parent)
+{
+    mSignalId = 0;
+    mTopDb = 0;
+    mBottomDb = -100;
+    mMouseX = -1;
+
+    setMouseTracking(true);
+}
+
+/*!
+    Sets the \a spectrum of the analog signal \a signalId to draw.
+*/
+void UiSpectrumPlot::setSpectrum(const AnalogSpectrum &spectrum, int signalId)
+{
+    mSpectrum = spectrum;
+    mSignalId = signalId;
+
+    if (mSpectrum.isValid()) {
+        // the top of the plot is the strongest bin rounded up to a division
+        double maxDb = mSpectrum.decibels(0);
+        for (int i = 1; i < mSpectrum.numBins(); i++) {
+            maxDb = qMax(maxDb, mSpectrum.decibels(i));
+        }
+        mTopDb = qCeil(maxDb / DecibelsPerDivision) * DecibelsPerDivision;
+        mBottomDb = mTopDb - 12*DecibelsPerDivision;
+    }
+
+    update();
+}
+
+/*!
+    Paints the spectrum.
+*/
+void UiSpectrumPlot::paintEvent(QPaintEvent* event)
+{
+    (void)event;
+
+    QPainter painter(this);
+    painter.fillRect(rect(), Configuration::instance().outsidePlotColor());
+
+    QRect r = plotRect();
+    painter.fillRect(r, Configuration::instance().plotBackgroundColor());
+
+    if (!mSpectrum.isValid()) return;
+
+    double maxFreq = mSpectrum.binWidth()*(mSpectrum.numBins()-1);
+
+    //
+    //    grid and labels
+    //
+
+    QPen pen = painter.pen();
+    for (double db = mTopDb; db >= mBottomDb; db -= DecibelsPerDivision) {
+        int y = (int)dbToY(db);
+        pen.setColor(Configuration::instance().gridColor());
+        painter.setPen(pen);
+        painter.drawLine(r.left(), y, r.right(), y);
+
+        pen.setColor(Configuration::instance().textColor());
+        painter.setPen(pen);
+        painter.drawText(0, y-10, MarginLeft-5, 20, Qt::AlignRight|Qt::AlignVCenter,
+                         QString("%1 dB").arg(db));
+    }
+
+    for (int i = 0; i <= NumFrequencyDivisions; i++) {
+        int x = r.left() + (r.width()*i)/NumFrequencyDivisions;
+        pen.setColor(Configuration::instance().gridColor());
+        painter.setPen(pen);
+        painter.drawLine(x, r.top(), x, r.bottom());
+
+        if (i % 2 == 0) {
+            pen.setColor(Configuration::instance().textColor());
+            painter.setPen(pen);
+            painter.drawText(x-40, r.bottom()+5, 80, 15, Qt::AlignCenter,
+                             StringUtil::frequencyToString(maxFreq*i/NumFrequencyDivisions));
+        }
+    }
+
+    //
+    //    spectrum, the strongest bin of each column
+    //
+
+    pen.setColor(Configuration::instance().analogSignalColor(mSignalId));
+    painter.setPen(pen);
+    painter.setClipRect(r);
+
+    double binsPerPixel = (double)(mSpectrum.numBins()-1)/qMax(r.width(), 1);
+    QPolygonF line;
+
+    if (binsPerPixel > 1) {
+        for (int x = 0; x < r.width(); x++) {
+            int first = (int)(x*binsPerPixel);
+            int last = qMin((int)((x+1)*binsPerPixel), mSpectrum.numBins()-1);
+
+            double db = mSpectrum.decibels(first);
+            for (int i = first+1; i <= last; i++) {
+                db = qMax(db, mSpectrum.decibels(i));
+            }
+            line.append(QPointF(r.left()+x, dbToY(db)));
+        }
+    }
+    else {
+        for (int i = 0; i < mSpectrum.numBins(); i++) {
+            line.append(QPointF(binToX(i), dbToY(mSpectrum.decibels(i))));
+        }
+    }
+
+    painter.drawPolyline(line);
+    painter.setClipping(false);
+
+    //
+    //    readout at the mouse position
+    //
+
+    if (mMouseX >= r.left() && mMouseX <= r.right()) {
+        int b = qBound(0, (int)((mMouseX - r.left())*binsPerPixel + 0.5), mSpectrum.numBins()-1);
+
+        pen.setColor(Configuration::instance().textColor());
+        painter.setPen(pen);
+        painter.drawText(r.adjusted(5, 5, -5, -5), Qt::AlignRight|Qt::AlignTop,
+                         QString("%1, %2 dBV")
+                         .arg(StringUtil::frequencyToString(b*mSpectrum.binWidth()))
+                         .arg(mSpectrum.decibels(b), 0, 'f', 1));
+    }
+}
+
+/*!
+    Keeps track of the mouse position for the readout.
+*/
+void UiSpectrumPlot::mouseMoveEvent(QMouseEvent* event)
+{
+    mMouseX = event->pos().x();
+    update();
+}
+
+/*!
+    Removes the readout when the mouse leaves the widget.
+*/
+void UiSpectrumPlot::leaveEvent(QEvent* event)
+{
+    (void)event;
+    mMouseX = -1;
+    update();
+}
+
+/*!
+    Returns the minimum size of this widget.
+*/
+QSize UiSpectrumPlot::minimumSizeHint() const
+{
+    return QSize(400, 250);
+}
+
+/*!
+    Returns the area within the margins where the spectrum is drawn.
+*/
+QRect UiSpectrumPlot::plotRect() const
+{
+    return rect().adjusted(MarginLeft, MarginTop, -MarginRight, -MarginBottom);
+}
+
+/*!
+    Returns the x coordinate of \a bin.
+*/
+double UiSpectrumPlot::binToX(double bin) const
+{
+    QRect r = plotRect();
+    return r.left() + bin*r.width()/qMax(mSpectrum.numBins()-1, 1);
+}
+
+/*!
+    Returns the y coordinate of the level \a db.
+*/
+double UiSpectrumPlot::dbToY(double db) const
+{
+    QRect r = plotRect();
+    db = qBound(mBottomDb, db, mTopDb);
+    return r.top() + (mTopDb - db)*r.height()/(mTopDb - mBottomDb);
+}
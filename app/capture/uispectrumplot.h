@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UISPECTRUMPLOT_H
+#define UISPECTRUMPLOT_H
+
+#include <QWidget>
+
+#include "analogspectrum.h"
+
+class UiSpectrumPlot : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit UiSpectrumPlot(QWidget *parent = 0);
+
+    void setSpectrum(const AnalogSpectrum &spectrum, int signalId);
+
+signals:
+
+public slots:
+
+protected:
+    void paintEvent(QPaintEvent* event);
+    void mouseMoveEvent(QMouseEvent* event);
+    void leaveEvent(QEvent* event);
+
+    QSize minimumSizeHint() const;
+
+private:
+
+    enum PrivConstants {
+        MarginTop = 10,
+        MarginRight = 10,
+        MarginBottom = 25,
+        MarginLeft = 50,
+        DecibelsPerDivision = 10,
+        NumFrequencyDivisions = 10
+    };
+
+    AnalogSpectrum mSpectrum;
+    int mSignalId;
+    double mTopDb;
+    double mBottomDb;
+    int mMouseX;
+
+    QRect plotRect() const;
+    double binToX(double bin) const;
+    double dbToY(double db) const;
+};
+
+#endif // UISPECTRUMPLOT_H
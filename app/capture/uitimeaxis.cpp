@@ -162,6 +162,24 @@ double UiTimeAxis::pixelToTimeRelativeRef(double xcoord)
     return (xcoord*mMajorStepTime) / (MajorStepPixelWidth) + mRangeLower;
 }
 
+/*!
+    Returns the pixel position relative to the reference position for the
+    sample with index \a idx when sampling at \a sampleRate Hz.
+*/
+double UiTimeAxis::sampleToPixelRelativeRef(SampleIndex idx, int sampleRate)
+{
+    return timeToPixelRelativeRef(SampleTime::toSeconds(idx, sampleRate));
+}
+
+/*!
+    Returns the index of the sample at or before the pixel position
+    (x-coordinate) \a xcoord when sampling at \a sampleRate Hz.
+*/
+SampleIndex UiTimeAxis::pixelToSampleRelativeRef(double xcoord, int sampleRate)
+{
+    return SampleTime::fromSeconds(pixelToTimeRelativeRef(xcoord), sampleRate);
+}
+
 /*!
     Zoom by specified number of \a steps centered around the given
     x coordinate \a xCenter.
@@ -324,8 +342,7 @@ QString UiTimeAxis::getTimeLabelForStep(int majorStep)
     // get time relative to trigger
     CaptureDevice * device = DeviceManager::instance().activeDevice()
             ->captureDevice();
-    double triggerTime = (double)device->digitalTriggerIndex()
-            / device->usedSampleRate();
+    double triggerTime = device->triggerTime().toSeconds();
     t -= (triggerTime-mRefTime);
 
     QString result = StringUtil::timeInSecToString(t);
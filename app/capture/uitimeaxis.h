@@ -19,6 +19,7 @@
 #include <QWidget>
 
 #include "uiabstractplotitem.h"
+#include "common/sampletime.h"
 
 class UiTimeAxis : public UiAbstractPlotItem
 {
@@ -30,6 +31,8 @@ public:
     double pixelToTimeRelativeRef(double xcoord);
     double timeToPixel(double value);
     double pixelToTime(double value);
+    double sampleToPixelRelativeRef(SampleIndex idx, int sampleRate);
+    SampleIndex pixelToSampleRelativeRef(double xcoord, int sampleRate);
 
     double rangeUpper();
     double rangeLower();
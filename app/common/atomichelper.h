@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ATOMICHELPER_H
+#define ATOMICHELPER_H
+
+#include <QtGlobal>
+#include <QAtomicInt>
+
+/*!
+    \class AtomicHelper
+    \brief Reads and writes QAtomicInt values with both Qt 4 and Qt 5.
+
+    \ingroup Common
+
+    The load() and store() functions of QAtomicInt were added in Qt 5 and
+    the implicit conversion to int that Qt 4 uses is deprecated in Qt 5.
+    These helpers use whichever is available.
+*/
+class AtomicHelper
+{
+public:
+
+    /*!
+        Returns the value of \a v without any memory ordering.
+    */
+    static int load(const QAtomicInt &v)
+    {
+#if QT_VERSION >= 0x050000
+        return v.load();
+#else
+        return v;
+#endif
+    }
+
+    /*!
+        Returns the value of \a v. Memory accesses after this call are not
+        moved before it.
+    */
+    static int loadAcquire(const QAtomicInt &v)
+    {
+#if QT_VERSION >= 0x050000
+        return v.loadAcquire();
+#else
+        return const_cast<QAtomicInt&>(v).fetchAndAddAcquire(0);
+#endif
+    }
+
+    /*!
+        Sets \a v to \a value. Memory accesses before this call are not
+        moved after it.
+    */
+    static void storeRelease(QAtomicInt &v, int value)
+    {
+#if QT_VERSION >= 0x050000
+        v.storeRelease(value);
+#else
+        v.fetchAndStoreRelease(value);
+#endif
+    }
+
+private:
+    AtomicHelper() {}
+};
+
+#endif // ATOMICHELPER_H
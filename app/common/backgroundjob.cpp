@@ -0,0 +1,127 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "backgroundjob.h"
+
+#include <QThreadPool>
+#include <QMutexLocker>
+
+#include "common/atomichelper.h"
+
+/*!
+    \class BackgroundJob
+    \brief A calculation for a widget or dialog that runs on a thread in
+    the global QThreadPool.
+
+    \ingroup Common
+
+    A subclass does the work in \ref execute and keeps the result until the
+    owner, which is told with finished(), has taken it. The owner never
+    waits for the job. When it no longer wants the result, e.g. because it
+    is being deleted or the settings have changed, it calls \ref release
+    and forgets the job. A released job is cancelled and deletes itself
+    once it is no longer running, so closing a dialog is never held up by
+    a slow calculation or by the other jobs in the pool.
+
+    The owner also calls \ref release after it has taken the result. A
+    finished() that was emitted just before the owner released the job can
+    still be delivered, so the owner should ignore it unless sender() is
+    its current job.
+*/
+
+/*!
+    Constructs a new job. It is started with \ref start.
+*/
+BackgroundJob::BackgroundJob() :
+    QObject(0)
+{
+    mCancelled = 0;
+    mDone = false;
+    mReleased = false;
+
+    setAutoDelete(false);
+}
+
+/*!
+    Queues the job on the global QThreadPool.
+*/
+void BackgroundJob::start()
+{
+    QThreadPool::globalInstance()->start(this);
+}
+
+/*!
+    Tells the job that its owner no longer wants the result. The job is
+    cancelled and is deleted as soon as it is no longer running, no
+    finished() signal is emitted after this call. Must be called from the
+    thread the job was created in.
+*/
+void BackgroundJob::release()
+{
+    disconnect(this, SIGNAL(finished()), 0, 0);
+
+    QMutexLocker locker(&mMutex);
+    mCancelled = 1;
+    mReleased = true;
+    if (mDone) {
+        deleteLater();
+    }
+}
+
+/*!
+    Runs the job unless it has been cancelled and emits finished(). Called
+    on one of the pool's threads.
+*/
+void BackgroundJob::run()
+{
+    if (!isCancelled()) {
+        execute();
+    }
+
+    mMutex.lock();
+    mDone = true;
+    bool released = mReleased;
+    if (!released) {
+        emit finished();
+    }
+    mMutex.unlock();
+
+    // nothing may touch the job after this
+    if (released) {
+        deleteLater();
+    }
+}
+
+/*!
+    \fn virtual void BackgroundJob::execute() = 0
+
+    Does the work of the job on one of the pool's threads. A long
+    calculation should return early when \ref isCancelled is true.
+*/
+
+/*!
+    Returns true if the job has been released by its owner. Can be called
+    from any thread.
+*/
+bool BackgroundJob::isCancelled() const
+{
+    return AtomicHelper::load(mCancelled) != 0;
+}
+
+/*!
+    \fn void BackgroundJob::finished()
+
+    This signal is emitted from the worker thread when the job is done.
+*/
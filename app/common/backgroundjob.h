@@ -0,0 +1,49 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef BACKGROUNDJOB_H
+#define BACKGROUNDJOB_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QMutex>
+#include <QAtomicInt>
+
+class BackgroundJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    BackgroundJob();
+
+    void start();
+    void release();
+
+    void run();
+
+signals:
+    void finished();
+
+protected:
+    virtual void execute() = 0;
+    bool isCancelled() const;
+
+private:
+    QMutex mMutex;
+    QAtomicInt mCancelled;
+    bool mDone;
+    bool mReleased;
+};
+
+#endif // BACKGROUNDJOB_H
@@ -60,6 +60,29 @@ QComboBox* InputHelper::createSignalBox(QWidget* parent, int selected)
     return box;
 }
 
+/*!
+    Create an input box for selecting an analog signal.
+*/
+QComboBox* InputHelper::createAnalogSignalBox(QWidget* parent, int selected)
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QComboBox* box = new QComboBox(parent);
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+
+    if (device != NULL) {
+
+        for (int i = 0; i < device->maxNumAnalogSignals(); i++) {
+            box->addItem(QString("A%1").arg(i), QVariant(i));
+            if (i == selected) {
+                box->setCurrentIndex(i);
+            }
+        }
+    }
+
+    return box;
+}
+
 /*!
     Create an input box for selecting a cursor (only active cursors are
     shown in the box).
@@ -83,6 +106,30 @@ QComboBox* InputHelper::createActiveCursorsBox(QWidget* parent, int selected)
     return box;
 }
 
+/*!
+    Replace the items in \a box with the active cursors. The first item,
+    \a noCursorText, means that no cursor is selected. The selected cursor
+    is kept if it is still active.
+*/
+void InputHelper::fillActiveCursorsBox(QComboBox* box, const QString &noCursorText)
+{
+    int selected = UiCursor::NoCursor;
+    if (box->count() > 0) {
+        selected = intValue(box);
+    }
+    box->clear();
+
+    box->addItem(noCursorText, QVariant(UiCursor::NoCursor));
+
+    QMap<UiCursor::CursorId, QString> map = CursorManager::instance().activeCursors();
+    QList<UiCursor::CursorId> keys = map.keys();
+    for (int i = 0; i < keys.size(); i++) {
+        box->addItem(map.value(keys.at(i)), QVariant(keys.at(i)));
+    }
+
+    setInt(box, selected);
+}
+
 /*!
     Return integer value associated with specified \a box.
 */
@@ -355,5 +402,114 @@ QComboBox* InputHelper::createSpiEnableModeBox(QWidget* parent, Types::SpiEnable
     }
 
 
+    return box;
+}
+
+/*!
+    Create an input box for specifying the number of signals in a parallel
+    bus.
+*/
+QComboBox* InputHelper::createBusWidthBox(QWidget* parent, int selectedWidth)
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QComboBox* box = new QComboBox(parent);
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+
+    if (device != NULL) {
+
+        for (int i = 1; i <= device->maxNumDigitalSignals(); i++) {
+            box->addItem(QString("%1").arg(i), QVariant(i));
+            if (i == selectedWidth) {
+                box->setCurrentIndex(i-1);
+            }
+        }
+    }
+
+    return box;
+}
+
+/*!
+    Create an input box for selecting the clock signal of a parallel bus.
+    The first item, "None", has the value -1 and means that the bus isn't
+    clocked.
+*/
+QComboBox* InputHelper::createBusClockBox(QWidget* parent, int selected)
+{
+    QComboBox* box = createSignalBox(parent, selected);
+
+    box->insertItem(0, "None", QVariant(-1));
+    if (selected == -1) {
+        box->setCurrentIndex(0);
+    }
+
+    return box;
+}
+
+/*!
+    Create an input box for specifying the clock edge of a parallel bus.
+*/
+QComboBox* InputHelper::createBusClockEdgeBox(QWidget* parent, Types::BusClockEdge edge)
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QComboBox* box = new QComboBox(parent);
+
+    box->addItem("Rising edge", QVariant(Types::BusClockRising));
+    box->addItem("Falling edge", QVariant(Types::BusClockFalling));
+
+
+    for (int i = 0; i < box->count(); i++) {
+
+        if (box->itemData(i).toInt() == edge) {
+            box->setCurrentIndex(i);
+        }
+    }
+
+
+    return box;
+}
+
+/*!
+    Create an input box for specifying the window function used for
+    spectrum analysis.
+*/
+QComboBox* InputHelper::createFftWindowBox(QWidget* parent, Types::FftWindow window)
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QComboBox* box = new QComboBox(parent);
+
+    box->addItem("Rectangular", QVariant(Types::FftWindowRectangular));
+    box->addItem("Hann", QVariant(Types::FftWindowHann));
+    box->addItem("Blackman", QVariant(Types::FftWindowBlackman));
+    box->addItem("Flat top", QVariant(Types::FftWindowFlatTop));
+
+
+    for (int i = 0; i < box->count(); i++) {
+
+        if (box->itemData(i).toInt() == window) {
+            box->setCurrentIndex(i);
+        }
+    }
+
+
+    return box;
+}
+
+/*!
+    Create an input box for specifying the FFT size (number of samples
+    per transform) used for spectrum analysis.
+*/
+QComboBox* InputHelper::createFftSizeBox(QWidget* parent, int selectedSize)
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QComboBox* box = new QComboBox(parent);
+
+    for (int size = 256; size <= 65536; size *= 2) {
+        box->addItem(QString("%1").arg(size), QVariant(size));
+        if (size == selectedSize) {
+            box->setCurrentIndex(box->count()-1);
+        }
+    }
+
     return box;
 }
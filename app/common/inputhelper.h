@@ -32,7 +32,9 @@ public:
     static void setInt(QComboBox* box, int value);
 
     static QComboBox* createSignalBox(QWidget* parent, int selected);
+    static QComboBox* createAnalogSignalBox(QWidget* parent, int selected);
     static QComboBox* createActiveCursorsBox(QWidget* parent, int selected);
+    static void fillActiveCursorsBox(QComboBox* box, const QString &noCursorText);
     static QComboBox* createFormatBox(QWidget* parent, Types::DataFormat selectedFormat);
 
     static QLineEdit* createUartBaudRateBox(QWidget* parent, int rate);
@@ -47,6 +49,13 @@ public:
     static QComboBox* createSpiModeBox(QWidget* parent, Types::SpiMode mode);
     static QComboBox* createSpiDataBitsBox(QWidget* parent, int selectedBits);
     static QComboBox* createSpiEnableModeBox(QWidget* parent, Types::SpiEnable mode);
+
+    static QComboBox* createBusWidthBox(QWidget* parent, int selectedWidth);
+    static QComboBox* createBusClockBox(QWidget* parent, int selected);
+    static QComboBox* createBusClockEdgeBox(QWidget* parent, Types::BusClockEdge edge);
+
+    static QComboBox* createFftWindowBox(QWidget* parent, Types::FftWindow window);
+    static QComboBox* createFftSizeBox(QWidget* parent, int selectedSize);
     
 private:
     explicit InputHelper();
@@ -0,0 +1,275 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "instrumentation.h"
+
+#include <QMutexLocker>
+
+/*!
+    \class Instrumentation
+    \brief Collects timings and other measurements per capture.
+
+    \ingroup Common
+
+    The Instrumentation class answers where the time goes between a
+    trigger and the signals on the screen. Code that is worth measuring
+    uses an InstrumentationTimer, or \ref addTime and \ref addValue, from
+    any thread. The measurements are kept in memory, one
+    InstrumentationRecord per capture for the last NumRecords captures,
+    and can be shown with UiInstrumentationDock or saved as JSON with
+    \ref toJson.
+
+    A new record is started by the capture device with \ref beginCapture
+    when signal data has been received. Work that is started for a capture
+    but finishes later, e.g. an analyzer decoding while the next capture
+    already is being received, adds its measurements to the record of the
+    capture it was started for.
+
+    Measuring costs a lock and a map lookup, so it is done per capture,
+    per channel or per paint and never per sample.
+*/
+
+/*!
+    Constructs the instrumentation with one record for everything measured
+    before the first capture.
+*/
+Instrumentation::Instrumentation()
+{
+    mClock.start();
+    mRecords.resize(NumRecords);
+    mNext = 0;
+    mCount = 0;
+    mCaptureCounter = 0;
+    beginCapture();
+}
+
+/*!
+    \fn static Instrumentation& Instrumentation::instance()
+
+    Returns the only instance of this class.
+*/
+
+/*!
+    Starts a new record. Measurements without a capture number are added
+    to it until the next call. The oldest record is thrown away when there
+    are NumRecords records.
+*/
+void Instrumentation::beginCapture()
+{
+    QMutexLocker locker(&mMutex);
+
+    InstrumentationRecord &r = mRecords[mNext];
+    r.capture = mCaptureCounter++;
+    r.startMs = mClock.elapsed();
+    r.entries.clear();
+
+    mNext = (mNext + 1) % NumRecords;
+    if (mCount < NumRecords) mCount++;
+}
+
+/*!
+    Returns the number of the current capture, which can be given to
+    \ref addTime and \ref addValue by work that finishes later.
+*/
+int Instrumentation::currentCapture()
+{
+    QMutexLocker locker(&mMutex);
+    return mCaptureCounter - 1;
+}
+
+/*!
+    Adds the time \a nsecs (in nanoseconds) measured for \a name to the
+    record of \a capture, or to the current record if \a capture is -1.
+    Nothing is added if the record has already been thrown away.
+*/
+void Instrumentation::addTime(const QString &name, qint64 nsecs, int capture)
+{
+    add(name, nsecs / 1000000.0, true, capture);
+}
+
+/*!
+    Adds the \a value measured for \a name, e.g. a throughput, to the
+    record of \a capture, or to the current record if \a capture is -1.
+*/
+void Instrumentation::addValue(const QString &name, double value, int capture)
+{
+    add(name, value, false, capture);
+}
+
+/*!
+    Removes all records and starts a new one.
+*/
+void Instrumentation::clear()
+{
+    {
+        QMutexLocker locker(&mMutex);
+        mCount = 0;
+    }
+    beginCapture();
+}
+
+/*!
+    Returns a copy of the records, the oldest first.
+*/
+QList<InstrumentationRecord> Instrumentation::records()
+{
+    QMutexLocker locker(&mMutex);
+
+    QList<InstrumentationRecord> list;
+    for (int i = 0; i < mCount; i++) {
+        list.append(mRecords.at((mNext - mCount + i + NumRecords) % NumRecords));
+    }
+
+    return list;
+}
+
+/*!
+    Returns the number of captures per second, based on when the records
+    were started. Mostly of interest in continuous mode.
+*/
+double Instrumentation::capturesPerSecond()
+{
+    return capturesPerSecond(records());
+}
+
+/*!
+    Returns all records as a JSON document.
+*/
+QString Instrumentation::toJson()
+{
+    QList<InstrumentationRecord> list = records();
+    QStringList recordList;
+
+    foreach(const InstrumentationRecord &r, list) {
+        QStringList entryList;
+
+        QMap<QString, InstrumentationEntry>::const_iterator it;
+        for (it = r.entries.constBegin(); it != r.entries.constEnd(); ++it) {
+            const InstrumentationEntry &e = it.value();
+            // the name is not passed to arg() as it may contain a '%'
+            entryList << "      " + jsonString(it.key())
+                         + QString(": {\"total\": %1, \"count\": %2, \"max\": %3, \"unit\": \"%4\"}")
+                           .arg(e.total, 0, 'g', 10)
+                           .arg(e.count)
+                           .arg(e.max, 0, 'g', 10)
+                           .arg(QString(e.isTime ? "ms" : ""));
+        }
+
+        recordList << QString("    {\"capture\": %1, \"startMs\": %2, \"entries\": {\n%3\n    }}")
+                      .arg(r.capture)
+                      .arg(r.startMs)
+                      .arg(entryList.join(",\n"));
+    }
+
+    return QString("{\n  \"capturesPerSecond\": %1,\n  \"records\": [\n%2\n  ]\n}\n")
+            .arg(capturesPerSecond(list), 0, 'g', 6)
+            .arg(recordList.join(",\n"));
+}
+
+/*!
+    Adds the \a value for \a name to the record of \a capture (or the
+    current one if -1). \a isTime is true if the value is a time in ms.
+*/
+void Instrumentation::add(const QString &name, double value, bool isTime, int capture)
+{
+    QMutexLocker locker(&mMutex);
+
+    if (capture == -1) {
+        capture = mCaptureCounter - 1;
+    }
+
+    // the records are numbered in order, so the record is found directly
+    int age = (mCaptureCounter - 1) - capture;
+    if (age < 0 || age >= mCount) return;
+
+    InstrumentationRecord &r = mRecords[(mNext - 1 - age + NumRecords) % NumRecords];
+
+    QMap<QString, InstrumentationEntry>::iterator it = r.entries.find(name);
+    if (it == r.entries.end()) {
+        InstrumentationEntry e;
+        e.total = value;
+        e.max = value;
+        e.count = 1;
+        e.isTime = isTime;
+        r.entries.insert(name, e);
+    }
+    else {
+        it.value().total += value;
+        it.value().max = qMax(it.value().max, value);
+        it.value().count++;
+    }
+}
+
+/*!
+    Returns the number of captures per second for the records in \a list.
+    The first record is only used as the start time.
+*/
+double Instrumentation::capturesPerSecond(const QList<InstrumentationRecord> &list)
+{
+    if (list.size() < 2) return 0;
+
+    qint64 ms = list.last().startMs - list.first().startMs;
+    if (ms <= 0) return 0;
+
+    return (list.size() - 1) * 1000.0 / ms;
+}
+
+/*!
+    Returns \a s as a quoted JSON string.
+*/
+QString Instrumentation::jsonString(const QString &s)
+{
+    QString str = s;
+    str.replace('\\', "\\\\");
+    str.replace('"', "\\\"");
+    return "\"" + str + "\"";
+}
+
+
+/*!
+    \class InstrumentationTimer
+    \brief Measures the time until it goes out of scope.
+
+    \ingroup Common
+
+    The time is measured with a monotonic clock from the construction to
+    the destruction of the timer and added to the record of the capture
+    that was current when the timer was constructed, see Instrumentation.
+
+    \code
+    {
+        InstrumentationTimer timer("Convert D0");
+        ...
+    }
+    \endcode
+*/
+
+/*!
+    Starts measuring the time for \a name.
+*/
+InstrumentationTimer::InstrumentationTimer(const QString &name) :
+    mName(name)
+{
+    mCapture = Instrumentation::instance().currentCapture();
+    mTimer.start();
+}
+
+/*!
+    Adds the measured time.
+*/
+InstrumentationTimer::~InstrumentationTimer()
+{
+    Instrumentation::instance().addTime(mName, mTimer.nsecsElapsed(), mCapture);
+}
@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <QVector>
+#include <QMutex>
+#include <QElapsedTimer>
+
+/*!
+    The measurements with the same name in one InstrumentationRecord.
+*/
+struct InstrumentationEntry
+{
+    double total;
+    double max;
+    int count;
+    bool isTime;
+};
+
+/*!
+    All measurements made while handling one capture.
+*/
+struct InstrumentationRecord
+{
+    int capture;
+    qint64 startMs;
+    QMap<QString, InstrumentationEntry> entries;
+};
+
+class Instrumentation
+{
+public:
+
+    static Instrumentation& instance()
+    {
+        static Instrumentation singleton;
+        return singleton;
+    }
+
+    void beginCapture();
+    int currentCapture();
+
+    void addTime(const QString &name, qint64 nsecs, int capture = -1);
+    void addValue(const QString &name, double value, int capture = -1);
+    void clear();
+
+    QList<InstrumentationRecord> records();
+    double capturesPerSecond();
+    QString toJson();
+
+private:
+
+    enum Constants {
+        NumRecords = 128
+    };
+
+    QMutex mMutex;
+    QElapsedTimer mClock;
+    QVector<InstrumentationRecord> mRecords;
+    int mNext;
+    int mCount;
+    int mCaptureCounter;
+
+    Instrumentation();
+    void add(const QString &name, double value, bool isTime, int capture);
+    double capturesPerSecond(const QList<InstrumentationRecord> &list);
+    static QString jsonString(const QString &s);
+};
+
+class InstrumentationTimer
+{
+public:
+    explicit InstrumentationTimer(const QString &name);
+    ~InstrumentationTimer();
+
+private:
+    QString mName;
+    int mCapture;
+    QElapsedTimer mTimer;
+};
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,151 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "sampletime.h"
+
+#include <cmath>
+
+/*!
+    \typedef SampleIndex
+
+    The index of a sample in a capture. It is 64 bits wide so that a
+    capture can hold more than 2^31 samples, which is only about 21 s at
+    100 MHz.
+*/
+
+/*!
+    \class SampleTime
+    \brief A point in time given as a sample index and a sample rate.
+
+    \ingroup Common
+
+    The SampleTime class keeps a time as the rational number
+    \a sample / \a rate instead of as seconds in a double. The conversion
+    to seconds is only done where a double is needed, e.g. to place
+    something on the UiTimeAxis, and splits the index in whole seconds and
+    a remainder. The split is exact, so the result is only off by the
+    rounding of the final double (about one unit in its last place)
+    instead of an error that grows with the index.
+
+    The difference between two times with the same rate, e.g. between the
+    trigger and a cursor, is computed on the indices and is therefore
+    exact.
+*/
+
+/*!
+    Constructs an invalid time.
+*/
+SampleTime::SampleTime() :
+    mSample(0),
+    mRate(0)
+{
+}
+
+/*!
+    Constructs the time of sample \a sample when sampling at \a rate Hz.
+*/
+SampleTime::SampleTime(SampleIndex sample, int rate) :
+    mSample(sample),
+    mRate(rate)
+{
+}
+
+/*!
+    \fn SampleIndex SampleTime::sample() const
+
+    Returns the sample index.
+*/
+
+/*!
+    \fn int SampleTime::rate() const
+
+    Returns the sample rate in Hz.
+*/
+
+/*!
+    \fn bool SampleTime::isValid() const
+
+    Returns true if the time has a sample rate.
+*/
+
+/*!
+    Returns the time in seconds from the first sample.
+*/
+double SampleTime::toSeconds() const
+{
+    return toSeconds(mSample, mRate);
+}
+
+/*!
+    Returns the time in seconds from this time to the \a other time. The
+    result is exact (apart from the final division) when both times have
+    the same rate.
+*/
+double SampleTime::secondsTo(const SampleTime &other) const
+{
+    if (mRate == other.mRate) {
+        return toSeconds(other.mSample - mSample, mRate);
+    }
+    return other.toSeconds() - toSeconds();
+}
+
+/*!
+    Returns the time in seconds of sample \a sample when sampling at
+    \a rate Hz. Returns 0 if \a rate is not positive.
+
+    The result is exact up to the rounding of the final double.
+*/
+double SampleTime::toSeconds(SampleIndex sample, int rate)
+{
+    if (rate <= 0) return 0;
+
+    // the split is exact, only the fraction and the sum are rounded
+    SampleIndex whole = sample / rate;
+    SampleIndex rest = sample % rate;
+
+    return (double)whole + (double)rest / rate;
+}
+
+/*!
+    Returns the index of the sample at or before the time \a seconds when
+    sampling at \a rate Hz. Returns 0 if \a rate is not positive.
+*/
+SampleIndex SampleTime::fromSeconds(double seconds, int rate)
+{
+    if (rate <= 0) return 0;
+    return clampToIndex(std::floor(seconds * rate));
+}
+
+/*!
+    Returns the index of the sample closest to the time \a seconds when
+    sampling at \a rate Hz. Returns 0 if \a rate is not positive.
+*/
+SampleIndex SampleTime::nearestSample(double seconds, int rate)
+{
+    if (rate <= 0) return 0;
+    return clampToIndex(std::floor(seconds * rate + 0.5));
+}
+
+/*!
+    Returns \a value as a SampleIndex, limited to what the type can hold.
+*/
+SampleIndex SampleTime::clampToIndex(double value)
+{
+    // 2^62, well inside the range of a qint64 and exact as a double
+    const double limit = 4611686018427387904.0;
+
+    if (value != value) return 0; // NaN
+    return (SampleIndex)qBound(-limit, value, limit);
+}
@@ -0,0 +1,47 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SAMPLETIME_H
+#define SAMPLETIME_H
+
+#include <QtGlobal>
+
+typedef qint64 SampleIndex;
+
+class SampleTime
+{
+public:
+    SampleTime();
+    SampleTime(SampleIndex sample, int rate);
+
+    SampleIndex sample() const {return mSample;}
+    int rate() const {return mRate;}
+    bool isValid() const {return mRate > 0;}
+
+    double toSeconds() const;
+    double secondsTo(const SampleTime &other) const;
+
+    static double toSeconds(SampleIndex sample, int rate);
+    static SampleIndex fromSeconds(double seconds, int rate);
+    static SampleIndex nearestSample(double seconds, int rate);
+
+private:
+    SampleIndex mSample;
+    int mRate;
+
+    static SampleIndex clampToIndex(double value);
+};
+
+#endif // SAMPLETIME_H
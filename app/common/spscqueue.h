@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QAtomicInt>
+
+#include "common/atomichelper.h"
+
+/*!
+    \class SpscQueue
+    \brief A lock-free queue with one producer thread and one consumer thread.
+
+    \ingroup Common
+
+    The SpscQueue class is a ring buffer holding at most \a Size - 1 items.
+    One thread may call \ref push and one other thread may call \ref pop
+    without any locking. The producer only writes the tail index and the
+    consumer only writes the head index, each published with release
+    semantics after the item itself has been written or read.
+*/
+template <typename T, int Size>
+class SpscQueue
+{
+public:
+    SpscQueue() : mHead(0), mTail(0) {}
+
+    /*!
+        Adds \a item to the end of the queue. Returns false if the queue is
+        full. Must only be called by the producer thread.
+    */
+    bool push(const T &item)
+    {
+        int tail = AtomicHelper::load(mTail);
+        int next = (tail + 1) % Size;
+        if (next == AtomicHelper::loadAcquire(mHead)) {
+            return false;
+        }
+        mItems[tail] = item;
+        AtomicHelper::storeRelease(mTail, next);
+        return true;
+    }
+
+    /*!
+        Removes the first item in the queue and stores it in \a item.
+        Returns false if the queue is empty. Must only be called by the
+        consumer thread.
+    */
+    bool pop(T* item)
+    {
+        int head = AtomicHelper::load(mHead);
+        if (head == AtomicHelper::loadAcquire(mTail)) {
+            return false;
+        }
+        *item = mItems[head];
+        AtomicHelper::storeRelease(mHead, (head + 1) % Size);
+        return true;
+    }
+
+private:
+    T mItems[Size];
+    QAtomicInt mHead;
+    QAtomicInt mTail;
+};
+
+#endif // SPSCQUEUE_H
@@ -108,6 +108,36 @@
     Enable is active high
 */
 
+/*!
+    \enum Types::BusClockEdge
+
+    This enum describes on which clock edge a parallel bus is sampled.
+
+    \var Types::BusClockEdge Types::BusClockRising
+    Sampled on the rising edge
+
+    \var Types::BusClockEdge Types::BusClockFalling
+    Sampled on the falling edge
+*/
+
+/*!
+    \enum Types::FftWindow
+
+    This enum describes the window functions used for spectrum analysis.
+
+    \var Types::FftWindow Types::FftWindowRectangular
+    No window
+
+    \var Types::FftWindow Types::FftWindowHann
+    Hann window, a general purpose window
+
+    \var Types::FftWindow Types::FftWindowBlackman
+    Blackman window, lower leakage than Hann
+
+    \var Types::FftWindow Types::FftWindowFlatTop
+    Flat top window, accurate amplitudes
+*/
+
 
 
 /*!
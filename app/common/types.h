@@ -68,6 +68,28 @@ public:
         SpiEnableNum // must be last
     };
 
+    /*
+     * P A R A L L E L   B U S ##############################
+     */
+
+    enum BusClockEdge {
+        BusClockRising,
+        BusClockFalling,
+        BusClockNum // must be last
+    };
+
+    /*
+     * S P E C T R U M ##############################
+     */
+
+    enum FftWindow {
+        FftWindowRectangular,
+        FftWindowHann,
+        FftWindowBlackman,
+        FftWindowFlatTop,
+        FftWindowNum // must be last
+    };
+
     Types();
 };
 
@@ -0,0 +1,199 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uiinstrumentationdock.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFile>
+#include <QMessageBox>
+
+#include "instrumentation.h"
+
+/*!
+    \class UiInstrumentationDock
+    \brief A dock widget showing the measurements collected by Instrumentation.
+
+    \ingroup Common
+
+    The UiInstrumentationDock shows one row per measurement, e.g.
+    "USB transfer", "Convert D0" or "Paint I2C", with the value for the
+    last capture that has it and the average and maximum over all kept
+    captures. Times are in ms. The dock is refreshed every RefreshInterval
+    ms while it is visible and costs nothing while it is hidden.
+
+    The records can be saved as JSON to compare the pipeline before and
+    after a change.
+*/
+
+/*!
+    Constructs a new dock widget with the given \a parent.
+*/
+UiInstrumentationDock::UiInstrumentationDock(QWidget *parent) :
+    QDockWidget(tr("Performance"), parent)
+{
+    setObjectName(QString::fromUtf8("instrumentationDock"));
+
+    QWidget* widget = new QWidget(this);
+    QVBoxLayout* verticalLayout = new QVBoxLayout(widget);
+
+    mSummary = new QLabel(widget);
+    verticalLayout->addWidget(mSummary);
+
+    mTable = new QTableWidget(0, NumColumns, widget);
+    mTable->setHorizontalHeaderLabels(QStringList()
+                                      << tr("Measurement")
+                                      << tr("Last")
+                                      << tr("Average")
+                                      << tr("Max")
+                                      << tr("Count"));
+    mTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    mTable->setSelectionMode(QAbstractItemView::NoSelection);
+    mTable->verticalHeader()->setVisible(false);
+    mTable->horizontalHeader()->setStretchLastSection(true);
+    verticalLayout->addWidget(mTable);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    QPushButton* clearButton = new QPushButton(tr("Clear"), widget);
+    QPushButton* saveButton = new QPushButton(tr("Save as JSON..."), widget);
+    buttonLayout->addWidget(clearButton);
+    buttonLayout->addWidget(saveButton);
+    buttonLayout->addStretch();
+    verticalLayout->addLayout(buttonLayout);
+
+    connect(clearButton, SIGNAL(clicked()), this, SLOT(clear()));
+    connect(saveButton, SIGNAL(clicked()), this, SLOT(saveAsJson()));
+
+    setWidget(widget);
+
+    mRefreshTimer.setInterval(RefreshInterval);
+    connect(&mRefreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+/*!
+    Updates the table with the current records.
+*/
+void UiInstrumentationDock::refresh()
+{
+    QList<InstrumentationRecord> records = Instrumentation::instance().records();
+
+    // last value, sum, max and count per measurement
+    QMap<QString, InstrumentationEntry> last;
+    QMap<QString, InstrumentationEntry> all;
+
+    foreach(const InstrumentationRecord &r, records) {
+        QMap<QString, InstrumentationEntry>::const_iterator it;
+        for (it = r.entries.constBegin(); it != r.entries.constEnd(); ++it) {
+            last.insert(it.key(), it.value());
+
+            QMap<QString, InstrumentationEntry>::iterator a = all.find(it.key());
+            if (a == all.end()) {
+                all.insert(it.key(), it.value());
+            }
+            else {
+                a.value().total += it.value().total;
+                a.value().max = qMax(a.value().max, it.value().max);
+                a.value().count += it.value().count;
+            }
+        }
+    }
+
+    mTable->setRowCount(all.size());
+
+    int row = 0;
+    QMap<QString, InstrumentationEntry>::const_iterator it;
+    for (it = all.constBegin(); it != all.constEnd(); ++it, ++row) {
+        const InstrumentationEntry &e = it.value();
+        const InstrumentationEntry &l = last.value(it.key());
+        QString unit = e.isTime ? tr(" ms") : QString();
+
+        setCell(row, ColumnName, it.key());
+        setCell(row, ColumnLast, QString::number(l.total / l.count, 'f', 3) + unit);
+        setCell(row, ColumnAverage, QString::number(e.total / e.count, 'f', 3) + unit);
+        setCell(row, ColumnMax, QString::number(e.max, 'f', 3) + unit);
+        setCell(row, ColumnCount, QString::number(e.count));
+    }
+
+    mSummary->setText(tr("Records: %1  Captures/s: %2")
+                      .arg(records.size())
+                      .arg(Instrumentation::instance().capturesPerSecond(), 0, 'f', 2));
+}
+
+/*!
+    Starts refreshing the dock when it is shown.
+*/
+void UiInstrumentationDock::showEvent(QShowEvent *event)
+{
+    refresh();
+    mRefreshTimer.start();
+    QDockWidget::showEvent(event);
+}
+
+/*!
+    Stops refreshing the dock when it is hidden.
+*/
+void UiInstrumentationDock::hideEvent(QHideEvent *event)
+{
+    mRefreshTimer.stop();
+    QDockWidget::hideEvent(event);
+}
+
+/*!
+    Removes all records.
+*/
+void UiInstrumentationDock::clear()
+{
+    Instrumentation::instance().clear();
+    refresh();
+}
+
+/*!
+    Asks for a file name and saves the records as JSON.
+*/
+void UiInstrumentationDock::saveAsJson()
+{
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    tr("Save measurements"),
+                                                    QString(),
+                                                    tr("JSON files (*.json)"));
+    if (fileName.isEmpty()) return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::warning(this, tr("Save failed"),
+                             tr("Failed to open %1").arg(fileName));
+        return;
+    }
+
+    file.write(Instrumentation::instance().toJson().toUtf8());
+    file.close();
+}
+
+/*!
+    Sets the \a text of the cell at \a row and \a column.
+*/
+void UiInstrumentationDock::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem* item = mTable->item(row, column);
+    if (item == NULL) {
+        // Deallocation: the table takes ownership of the item
+        item = new QTableWidgetItem();
+        mTable->setItem(row, column, item);
+    }
+    item->setText(text);
+}
@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIINSTRUMENTATIONDOCK_H
+#define UIINSTRUMENTATIONDOCK_H
+
+#include <QDockWidget>
+#include <QTableWidget>
+#include <QLabel>
+#include <QTimer>
+
+class UiInstrumentationDock : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit UiInstrumentationDock(QWidget *parent = 0);
+
+signals:
+
+public slots:
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent* event);
+    void hideEvent(QHideEvent* event);
+
+private slots:
+    void clear();
+    void saveAsJson();
+
+private:
+
+    enum Constants {
+        RefreshInterval = 500
+    };
+
+    enum Columns {
+        ColumnName,
+        ColumnLast,
+        ColumnAverage,
+        ColumnMax,
+        ColumnCount,
+        NumColumns
+    };
+
+    QTableWidget* mTable;
+    QLabel* mSummary;
+    QTimer mRefreshTimer;
+
+    void setCell(int row, int column, const QString &text);
+};
+
+#endif // UIINSTRUMENTATIONDOCK_H
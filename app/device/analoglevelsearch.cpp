@@ -0,0 +1,283 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analoglevelsearch.h"
+
+/*!
+    \class AnalogLevelSearch
+    \brief Finds where an analog signal crosses a level.
+
+    \ingroup Device
+
+    A crossing is searched for with hysteresis: a falling edge is a sample
+    above the high level followed by a sample at or below the low level,
+    and a rising edge a sample below the low level followed by a sample at
+    or above the high level. A search for AnyEdge finds both. Samples
+    between the levels (noise around the level) don't make or break a
+    crossing. The position of a crossing is the middle between the last
+    sample beyond the level it started at and the first sample that
+    reached the other level, which is where a slow signal actually
+    crosses. With equal levels it is the first sample that reached the
+    level.
+
+    The minimum and maximum value of each block of BlockSize samples are
+    calculated once by setData(). A search then steps over all blocks that
+    can't contain what it is looking for, which is most of them, so finding
+    a crossing in a long capture only looks at the samples around it.
+
+    The data and block summaries are implicitly shared, so copying an
+    AnalogLevelSearch is cheap.
+*/
+
+/*!
+    Constructs an AnalogLevelSearch without data.
+*/
+AnalogLevelSearch::AnalogLevelSearch()
+{
+}
+
+/*!
+    Constructs an AnalogLevelSearch for the samples in \a data.
+*/
+AnalogLevelSearch::AnalogLevelSearch(const QVector<double> &data)
+{
+    setData(data);
+}
+
+/*!
+    Sets the samples to search to \a data and calculates the block
+    summaries.
+*/
+void AnalogLevelSearch::setData(const QVector<double> &data)
+{
+    mData = data;
+
+    int numBlocks = (data.size() + BlockSize - 1) / BlockSize;
+    mBlockMin.resize(numBlocks);
+    mBlockMax.resize(numBlocks);
+
+    const double* d = data.constData();
+    for (int b = 0; b < numBlocks; b++) {
+        int from = b*BlockSize;
+        int to = qMin(from + (int)BlockSize, data.size());
+
+        double min = d[from];
+        double max = min;
+        for (int i = from+1; i < to; i++) {
+            if (d[i] < min) min = d[i];
+            if (d[i] > max) max = d[i];
+        }
+
+        mBlockMin[b] = min;
+        mBlockMax[b] = max;
+    }
+}
+
+/*!
+    \fn SampleIndex AnalogLevelSearch::numSamples() const
+
+    Returns the number of samples.
+*/
+
+/*!
+    Returns the position of the \a n:th crossing of the given \a edge that
+    starts at or after the sample \a fromIdx, with the hysteresis levels
+    \a lowLevel and \a highLevel. Returns -1 if there isn't one.
+*/
+SampleIndex AnalogLevelSearch::next(Edge edge, double lowLevel, double highLevel,
+                                    SampleIndex fromIdx, int n) const
+{
+    SampleIndex idx = qMax(fromIdx, (SampleIndex)0);
+    SampleIndex crossing = -1;
+
+    if (edge == AnyEdge) {
+        Band rising(RisingEdge, lowLevel, highLevel);
+        Band falling(FallingEdge, lowLevel, highLevel);
+
+        for (int i = 0; i < n; i++) {
+            SampleIndex risingIdx = idx;
+            SampleIndex fallingIdx = idx;
+            SampleIndex risingCrossing = -1;
+            SampleIndex fallingCrossing = -1;
+            bool foundRising = findNext(rising, risingIdx, risingCrossing);
+            bool foundFalling = findNext(falling, fallingIdx, fallingCrossing);
+
+            if (foundRising && (!foundFalling || risingCrossing < fallingCrossing)) {
+                idx = risingIdx;
+                crossing = risingCrossing;
+            }
+            else if (foundFalling) {
+                idx = fallingIdx;
+                crossing = fallingCrossing;
+            }
+            else {
+                return -1;
+            }
+        }
+
+        return crossing;
+    }
+
+    Band band(edge, lowLevel, highLevel);
+
+    for (int i = 0; i < n; i++) {
+        if (!findNext(band, idx, crossing)) return -1;
+    }
+
+    return crossing;
+}
+
+/*!
+    Returns the position of the last crossing of the given \a edge that
+    has reached the other level at or before the sample \a fromIdx, with
+    the hysteresis levels \a lowLevel and \a highLevel. Returns -1 if there
+    isn't one.
+*/
+SampleIndex AnalogLevelSearch::previous(Edge edge, double lowLevel, double highLevel,
+                                        SampleIndex fromIdx) const
+{
+    if (edge == AnyEdge) {
+        return qMax(previous(RisingEdge, lowLevel, highLevel, fromIdx),
+                    previous(FallingEdge, lowLevel, highLevel, fromIdx));
+    }
+
+    Band band(edge, lowLevel, highLevel);
+    const double* d = mData.constData();
+
+    int i = (int)qMin(fromIdx, (SampleIndex)mData.size()-1);
+
+    // last sample that has reached the other level
+    while (i >= 0) {
+        if ((i & BlockMask) == BlockMask) {
+            int b = i >> BlockShift;
+            if (!band.anyFired(mBlockMin.at(b), mBlockMax.at(b))) {
+                i -= BlockSize;
+                continue;
+            }
+        }
+
+        if (band.fired(d[i])) break;
+        i--;
+    }
+    if (i < 0) return -1;
+
+    // go back to the last sample beyond the start level, keeping track of
+    // the first sample that reached the other level
+    int first = i;
+    for (i = i-1; i >= 0; i--) {
+        if ((i & BlockMask) == BlockMask) {
+            int b = i >> BlockShift;
+            if (!band.anyArmed(mBlockMin.at(b), mBlockMax.at(b))) {
+                if (band.anyFired(mBlockMin.at(b), mBlockMax.at(b))) {
+                    int j = i - BlockMask;
+                    while (!band.fired(d[j])) j++;
+                    first = j;
+                }
+                i -= BlockMask;
+                continue;
+            }
+        }
+
+        if (band.armed(d[i])) {
+            return (i + 1 + first) / 2;
+        }
+        if (band.fired(d[i])) {
+            first = i;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+    Finds the first crossing that starts at or after the sample \a idx
+    for \a band. Sets \a crossing to its position and \a idx to the
+    sample that reached the other level and returns true, or returns false
+    if there isn't one. That sample can start a crossing of the opposite
+    edge but not another one of the same edge.
+*/
+bool AnalogLevelSearch::findNext(const Band &band, SampleIndex &idx, SampleIndex &crossing) const
+{
+    const double* d = mData.constData();
+    const int size = mData.size();
+
+    int i = (int)idx;
+
+    // first sample beyond the start level
+    while (i < size) {
+        if ((i & BlockMask) == 0) {
+            int b = i >> BlockShift;
+            if (!band.anyArmed(mBlockMin.at(b), mBlockMax.at(b))) {
+                i += BlockSize;
+                continue;
+            }
+        }
+
+        if (band.armed(d[i])) break;
+        i++;
+    }
+    if (i >= size) return false;
+
+    // first sample that reaches the other level, keeping track of the
+    // last sample beyond the start level
+    int last = i;
+    for (i = i+1; i < size; i++) {
+        if ((i & BlockMask) == 0) {
+            int b = i >> BlockShift;
+            if (!band.anyFired(mBlockMin.at(b), mBlockMax.at(b))) {
+                if (band.anyArmed(mBlockMin.at(b), mBlockMax.at(b))) {
+                    int j = qMin(i + (int)BlockMask, size-1);
+                    while (!band.armed(d[j])) j--;
+                    last = j;
+                }
+                i += BlockMask;
+                continue;
+            }
+        }
+
+        if (band.fired(d[i])) {
+            crossing = (last + 1 + i) / 2;
+            idx = i;
+            return true;
+        }
+        if (band.armed(d[i])) {
+            last = i;
+        }
+    }
+
+    return false;
+}
+
+
+/*!
+    \class AnalogLevelSearch::Band
+    \brief The hysteresis band of a search.
+
+    \privatesection
+
+    Tells if a sample, or any sample in a block, is beyond the level a
+    crossing starts at (armed) or has reached the level it ends at (fired).
+*/
+
+/*!
+    Constructs a band for crossings of the given \a edge, which is
+    RisingEdge or FallingEdge, between \a lowLevel and \a highLevel.
+*/
+AnalogLevelSearch::Band::Band(Edge edge, double lowLevel, double highLevel)
+{
+    mFalling = (edge == FallingEdge);
+    mLow = lowLevel;
+    mHigh = highLevel;
+}
@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALOGLEVELSEARCH_H
+#define ANALOGLEVELSEARCH_H
+
+#include <QVector>
+
+#include "common/sampletime.h"
+
+class AnalogLevelSearch
+{
+public:
+
+    enum Edge {
+        RisingEdge,
+        FallingEdge,
+        AnyEdge
+    };
+
+    AnalogLevelSearch();
+    explicit AnalogLevelSearch(const QVector<double> &data);
+
+    void setData(const QVector<double> &data);
+    SampleIndex numSamples() const {return mData.size();}
+
+    SampleIndex next(Edge edge, double lowLevel, double highLevel,
+                     SampleIndex fromIdx, int n = 1) const;
+    SampleIndex previous(Edge edge, double lowLevel, double highLevel,
+                         SampleIndex fromIdx) const;
+
+private:
+
+    enum Constants {
+        BlockShift = 12,
+        BlockSize = 1 << BlockShift,
+        BlockMask = BlockSize - 1
+    };
+
+    class Band
+    {
+    public:
+        Band(Edge edge, double lowLevel, double highLevel);
+
+        bool armed(double v) const {return mFalling ? v > mHigh : v < mLow;}
+        bool fired(double v) const {return mFalling ? v <= mLow : v >= mHigh;}
+        bool anyArmed(double min, double max) const {return mFalling ? max > mHigh : min < mLow;}
+        bool anyFired(double min, double max) const {return mFalling ? min <= mLow : max >= mHigh;}
+
+    private:
+        bool mFalling;
+        double mLow;
+        double mHigh;
+    };
+
+    QVector<double> mData;
+    QVector<double> mBlockMin;
+    QVector<double> mBlockMax;
+
+    bool findNext(const Band &band, SampleIndex &idx, SampleIndex &crossing) const;
+};
+
+#endif // ANALOGLEVELSEARCH_H
@@ -34,6 +34,9 @@
     \var AnalogSignal::Constants AnalogSignal::InvalidAnalogId
     Represents an invalid analog ID
 
+    \var AnalogSignal::Constants AnalogSignal::MaxArbitraryPoints
+    Maximum number of points kept for an arbitrary waveform
+
 */
 
 /*!
@@ -89,6 +92,9 @@
 
     \var AnalogSignal::AnalogWaveform AnalogSignal::WaveformTriangle
     Generate a triangle waveform.
+
+    \var AnalogSignal::AnalogWaveform AnalogSignal::WaveformArbitrary
+    Generate a waveform with a user supplied shape, see setArbitraryData().
 */
 
 
@@ -151,7 +157,8 @@ bool AnalogSignal::operator==(const AnalogSignal &other)
             mTriggerLevel == other.mTriggerLevel &&
             mFrequency == other.mFrequency &&
             mWaveform == other.mWaveform &&
-            mAmplitude == other.mAmplitude);
+            mAmplitude == other.mAmplitude &&
+            mArbitraryData == other.mArbitraryData);
 
 }
 
@@ -178,6 +185,7 @@ AnalogSignal& AnalogSignal::operator=(const AnalogSignal &other)
     mFrequency = other.mFrequency;
     mWaveform = other.mWaveform;
     mAmplitude = other.mAmplitude;
+    mArbitraryData = other.mArbitraryData;
     mUsage = other.mUsage;
     mReconfigureListener = other.mReconfigureListener;
 
@@ -332,6 +340,47 @@ void AnalogSignal::setTriggerLevel(double l)
    Sets the amplitude for this signal to \a amp.
 */
 
+/*!
+    \fn QVector<double> AnalogSignal::arbitraryData() const
+
+   Returns the shape of one period of the arbitrary waveform. The values
+   are normalized to the -1..1 range and scaled with amplitude() when
+   generated.
+*/
+
+/*!
+   Sets the shape of the arbitrary waveform to one period of \a data, given
+   in Volts. The data is normalized to the -1..1 range and the amplitude is
+   set to the largest absolute value found in \a data. If \a data has more
+   than MaxArbitraryPoints values it is reduced by picking evenly spaced
+   values.
+*/
+void AnalogSignal::setArbitraryData(const QVector<double> &data)
+{
+    mArbitraryData.clear();
+
+    if (data.isEmpty()) return;
+
+    int n = data.size();
+    int points = qMin(n, (int)MaxArbitraryPoints);
+    double peak = 0;
+
+    mArbitraryData.reserve(points);
+    for (int i = 0; i < points; i++) {
+        double v = data.at((int)(((qint64)i * n) / points));
+        mArbitraryData.append(v);
+        peak = qMax(peak, qAbs(v));
+    }
+
+    if (peak > 0) {
+        for (int i = 0; i < mArbitraryData.size(); i++) {
+            mArbitraryData[i] /= peak;
+        }
+    }
+
+    mAmplitude = peak;
+}
+
 
 /*!
     Returns a string representation of this analog signal. This is typically
@@ -348,7 +397,10 @@ QString AnalogSignal::toSettingsString()
     // vPerDiv;triggerState;triggerLevel;coupling
 
     // -- generate fields
-    // waveform;frequency;amplitude
+    // waveform;frequency;amplitude;arbitraryData
+    //
+    // arbitraryData is a comma separated list that is only
+    // present for the arbitrary waveform
 
 
     QString str;
@@ -367,6 +419,14 @@ QString AnalogSignal::toSettingsString()
         str.append(QString("%1;").arg(mWaveform));
         str.append(QString("%1;").arg(mFrequency));
         str.append(QString("%1").arg(mAmplitude));
+
+        if (mWaveform == WaveformArbitrary && !mArbitraryData.isEmpty()) {
+            QStringList values;
+            foreach(double v, mArbitraryData) {
+                values.append(QString::number(v));
+            }
+            str.append(";").append(values.join(","));
+        }
     }
 
 
@@ -396,7 +456,7 @@ AnalogSignal AnalogSignal::fromSettingsString(QString& s)
         // vPerDiv;triggerState;triggerLevel;coupling
 
         // -- generate fields
-        // waveform;frequency;amplitude
+        // waveform;frequency;amplitude;arbitraryData
 
         QStringList list = s.split(';');
         if (list.size() < 7) break;
@@ -475,12 +535,24 @@ AnalogSignal AnalogSignal::fromSettingsString(QString& s)
             double amp = list.at(6).toDouble(&ok);
             if (!ok) break;
 
+            // --- arbitrary data (optional)
+            QVector<double> shape;
+            if (list.size() > 7 && !list.at(7).isEmpty()) {
+                foreach(QString v, list.at(7).split(',')) {
+                    shape.append(v.toDouble(&ok));
+                    if (!ok) break;
+                }
+                if (!ok) break;
+                if (shape.size() > MaxArbitraryPoints) break;
+            }
+
             tmp.mUsage = usage;
             tmp.mId = id;
             tmp.mName = name;
             tmp.mWaveform = waveform;
             tmp.mFrequency = freq;
             tmp.mAmplitude = amp;
+            tmp.mArbitraryData = shape;
         }
 
 
@@ -17,6 +17,7 @@
 #define ANALOGSIGNAL_H
 
 #include <QString>
+#include <QVector>
 #include <QMetaType>
 
 #include "reconfigurelistener.h"
@@ -26,7 +27,8 @@ class AnalogSignal
 public:
 
     enum Constants {
-        InvalidAnalogId = -1
+        InvalidAnalogId = -1,
+        MaxArbitraryPoints = 2000
     };
 
     enum AnalogUsage {
@@ -51,6 +53,7 @@ public:
         WaveformSine,
         WaveformSquare,
         WaveformTriangle,
+        WaveformArbitrary,
         WaveformNum // must be last
     };
 
@@ -89,6 +92,9 @@ public:
     double amplitude() const {return mAmplitude;}
     void setAmplitude(double amp) {mAmplitude = amp;}
 
+    QVector<double> arbitraryData() const {return mArbitraryData;}
+    void setArbitraryData(const QVector<double> &data);
+
     QString toSettingsString();
     static AnalogSignal fromSettingsString(QString& settings);
 
@@ -116,6 +122,7 @@ private:
     AnalogWaveform mWaveform;
     int mFrequency;
     double mAmplitude;
+    QVector<double> mArbitraryData;
 
     
 };
@@ -102,6 +102,25 @@ QList<double> CaptureDevice::supportedVPerDiv()
     after a capture has finished.
 */
 
+/*!
+    \fn virtual bool CaptureDevice::supportsPipelinedCapture()
+
+    Returns true if the capture device starts the next capture by itself
+    in continuous mode (see \ref setContinuous), as soon as the data of
+    the previous one has been received. The host then handles capture N
+    while the device acquires capture N+1 and no new start request must
+    be issued after a capture has finished. A device that does this may
+    drop captures if the host can't keep up.
+*/
+
+/*!
+    \fn virtual void CaptureDevice::setContinuous(bool continuous)
+
+    Called with \a continuous set to true before the first start request
+    of a continuous capture and with false when it ends. Only needed by
+    devices that support pipelined capture.
+*/
+
 /*!
     \fn virtual void CaptureDevice::configureBeforeStart(QWidget* parent)
 
@@ -147,6 +166,21 @@ QList<double> CaptureDevice::supportedVPerDiv()
 
 */
 
+/*!
+    \fn virtual void CaptureDevice::showDiagnostics(QWidget* parent)
+
+    If a capture device can report how well it keeps up with the sample rate
+    (e.g. interrupt and transfer statistics) this virtual function must be
+    overriden in a subclass.
+
+    A dialog window can be presented to the user by using \a parent as Ui
+    context.
+
+    Reimplement this function in a CaptureDevice subclass. By default a message
+    dialog is shown to indicate that there isn't any diagnostics for the device.
+
+*/
+
 /*!
     \fn virtual void CaptureDevice::start(int sampleRate) = 0
 
@@ -191,12 +225,18 @@ QList<double> CaptureDevice::supportedVPerDiv()
 */
 
 /*!
-    \fn virtual int CaptureDevice::lastSampleIndex() = 0
+    \fn virtual SampleIndex CaptureDevice::lastSampleIndex() = 0
 
     Returns the last valid index for the latest capture
     request. If a 1000 samples were performed this function should return 999.
 */
 
+/*!
+    \fn SampleTime CaptureDevice::sampleTime(SampleIndex idx)
+
+    Returns the time of the sample with index \a idx in the latest capture.
+*/
+
 /*!
     Create and add a digital signal with \a id to the list of digital signals
     that should be including in the next capture.
@@ -445,17 +485,24 @@ QList<int> CaptureDevice::unusedAnalogIds()
 */
 
 /*!
-    \fn virtual int CaptureDevice::digitalTriggerIndex() = 0
+    \fn virtual SampleIndex CaptureDevice::digitalTriggerIndex() = 0
 
     Returns the sample index where the trigger occured.
 */
 
 /*!
-    \fn virtual void CaptureDevice::setDigitalTriggerIndex(int idx) = 0
+    \fn virtual void CaptureDevice::setDigitalTriggerIndex(SampleIndex idx) = 0
 
     Sets the sample index where the trigger occured to \a idx.
 */
 
+/*!
+    \fn SampleTime CaptureDevice::triggerTime()
+
+    Returns the time of the sample where the trigger occured. Use
+    SampleTime::secondsTo to get a time relative to the trigger.
+*/
+
 /*!
     Get a list with digital transitions for the digital signal with ID
     \a signalId. The first position in the list \a list will contain the
@@ -466,13 +513,25 @@ QList<int> CaptureDevice::unusedAnalogIds()
     The last position contains the last sample index of the data even if there
     wasn't a transition at that index.
 */
-void CaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+void CaptureDevice::digitalTransitions(int signalId, QVector<SampleIndex> &list)
 {
-
     QVector<int>* data = digitalData(signalId);
-    if (data != NULL && data->size() > 0) {
+    if (data != NULL) {
+        transitions(*data, list);
+    }
+}
 
-        int val = data->at(0);
+/*!
+    Appends the transitions of the digital signal \a data to \a list in the
+    format described for digitalTransitions(). The function only looks at
+    \a data, so it can be used on another thread with a copy of the data of
+    a signal.
+*/
+void CaptureDevice::transitions(const QVector<int> &data, QVector<SampleIndex> &list)
+{
+    if (data.size() > 0) {
+
+        int val = data.at(0);
 
         //
         //  Index 0 always contains the logic level of the data at first
@@ -481,10 +540,10 @@ void CaptureDevice::digitalTransitions(int signalId, QList<int> &list)
         list.append(val);
 
 
-        for (int i = 1; i < data->size(); i++) {
-            if (data->at(i) != val) {
+        for (int i = 1; i < data.size(); i++) {
+            if (data.at(i) != val) {
                 list.append(i);
-                val = data->at(i);
+                val = data.at(i);
             }
         }
 
@@ -492,8 +551,53 @@ void CaptureDevice::digitalTransitions(int signalId, QList<int> &list)
         //  The last index of the transition list always contains the "size",
         //  i.e., the last sample time of the data list
         //
-        list.append(data->size()-1);
+        list.append(data.size()-1);
+
+    }
+}
+
+/*!
+    Sets \a search to search the analog signal with ID \a signalId for
+    level crossings. The search is empty if there isn't any data for the
+    signal. A sub-class should reimplement this function if it keeps the
+    search between calls, since setting it up reads all samples.
+
+    Used by the crossing searches in the context menu of UiAnalogSignal.
+*/
+void CaptureDevice::analogLevelSearch(int signalId, AnalogLevelSearch &search)
+{
+    QVector<double>* data = analogData(signalId);
+    search.setData(data != NULL ? *data : QVector<double>());
+}
+
+/*!
+    Returns the time, in seconds, of the first sample of the analog signal
+    with ID \a signalId relative to the first digital sample.
+
+    The analog and digital signals are sampled by different parts of the
+    hardware and they seldom start at exactly the same time. Instead of
+    moving the signal data the difference is kept as an offset which
+    must be added to the time of each analog sample. The offset can be
+    a fraction of a sample period.
+*/
+double CaptureDevice::analogTimeOffset(int signalId)
+{
+    return mAnalogTimeOffsets.value(signalId, 0.0);
+}
+
+/*!
+    Sets the time of the first sample of the analog signal with ID
+    \a signalId to \a offset seconds relative to the first digital sample.
 
+    \sa analogTimeOffset()
+*/
+void CaptureDevice::setAnalogTimeOffset(int signalId, double offset)
+{
+    if (offset == 0.0) {
+        mAnalogTimeOffsets.remove(signalId);
+    }
+    else {
+        mAnalogTimeOffsets.insert(signalId, offset);
     }
 }
 
@@ -524,3 +628,11 @@ void CaptureDevice::digitalTransitions(int signalId, QList<int> &list)
     List of analog signals that will be used during capture.
 */
 
+/*!
+    \fn QMap<int, double> CaptureDevice::mAnalogTimeOffsets
+
+    Time offsets, in seconds, for analog signals that don't start at the
+    same time as the digital signals. Signals without an entry have no
+    offset.
+*/
+
@@ -19,11 +19,15 @@
 #include <QDebug>
 #include <QObject>
 #include <QList>
+#include <QVector>
+#include <QMap>
 #include <QMessageBox>
 
 #include "digitalsignal.h"
 #include "analogsignal.h"
 #include "reconfigurelistener.h"
+#include "analoglevelsearch.h"
+#include "common/sampletime.h"
 
 class CaptureDevice : public QObject, public ReconfigureListener
 {
@@ -38,6 +42,8 @@ public:
     virtual int maxNumAnalogSignals() = 0;
     virtual QList<double> supportedVPerDiv();
     virtual bool supportsContinuousCapture() {return false;}
+    virtual bool supportsPipelinedCapture() {return false;}
+    virtual void setContinuous(bool continuous) {(void)continuous;}
 
     virtual void configureBeforeStart(QWidget* parent) {(void)parent;/* do nothing by default */}
     virtual void configureTrigger(QWidget* parent)
@@ -54,13 +60,21 @@ public:
                     tr("No settings"),
                     tr("No calibration settings for this device"));
     }
+    virtual void showDiagnostics(QWidget* parent)
+    {
+        QMessageBox::warning(
+                    parent,
+                    tr("No diagnostics"),
+                    tr("No diagnostics for this device"));
+    }
 
     virtual void start(int sampleRate) = 0;
     virtual void stop() = 0;
 
     virtual int usedSampleRate() {return mUsedSampleRate;}
     virtual void setUsedSampleRate(int sampleRate) {mUsedSampleRate = sampleRate;}
-    virtual int lastSampleIndex() = 0;
+    virtual SampleIndex lastSampleIndex() = 0;
+    SampleTime sampleTime(SampleIndex idx) {return SampleTime(idx, usedSampleRate());}
 
     DigitalSignal* addDigitalSignal(int id);
     void removeDigitalSignal(DigitalSignal* s);
@@ -79,12 +93,18 @@ public:
     virtual QVector<double>* analogData(int signalId) = 0;
     virtual void setAnalogData(int signalId, QVector<double> data) = 0;
 
+    double analogTimeOffset(int signalId);
+    void setAnalogTimeOffset(int signalId, double offset);
+
     virtual void clearSignalData() = 0;
 
-    virtual int digitalTriggerIndex() = 0;
-    virtual void setDigitalTriggerIndex(int idx) = 0;
+    virtual SampleIndex digitalTriggerIndex() = 0;
+    virtual void setDigitalTriggerIndex(SampleIndex idx) = 0;
+    SampleTime triggerTime() {return sampleTime(digitalTriggerIndex());}
 
-    virtual void digitalTransitions(int signalId, QList<int> &list);
+    virtual void digitalTransitions(int signalId, QVector<SampleIndex> &list);
+    static void transitions(const QVector<int> &data, QVector<SampleIndex> &list);
+    virtual void analogLevelSearch(int signalId, AnalogLevelSearch &search);
 
 
 signals:
@@ -97,6 +117,7 @@ protected:
     int mUsedSampleRate;
     QList<DigitalSignal*> mDigitalSignalList;
     QList<AnalogSignal*> mAnalogSignalList;
+    QMap<int, double> mAnalogTimeOffsets;
 
 
     
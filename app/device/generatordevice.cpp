@@ -116,7 +116,7 @@ GeneratorDevice::~GeneratorDevice()
     by this device.
 
     Reimplement this function in a GeneratorDevice subclass. By default
-    all waveforms supported by the application are returned.
+    the sine, square and triangle waveforms are returned.
 
 */
 QList<AnalogSignal::AnalogWaveform> GeneratorDevice::supportedAnalogWaveforms()
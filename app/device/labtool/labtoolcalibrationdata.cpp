@@ -26,7 +26,8 @@
     The LabToolCalibrationData class calculates the scaling factors based
     on the raw calibration data from the LabTool Hardware. The scaling factors
     are used to convert the captured data samples into correctly calibrated
-    floating point values in Volts.
+    floating point values in Volts and to convert wanted output levels into
+    values for the DAC.
 */
 
 /*!
@@ -75,6 +76,60 @@ LabToolCalibrationData::LabToolCalibrationData(const quint8 *data)
             }
         }
     }
+
+    // Calculate calibration factors for the analog outputs, the same
+    // way as it is done in the firmware:
+    //
+    //   A = (Vout1 - Vout2*hex1/hex2) / (1 - hex1/hex2)
+    //   B = (Vout2 - A) / hex2
+    //
+    // with hex being the 10-bit value written to the DAC
+
+    for (int ch = 0; ch < 2; ch++)
+    {
+        // convert mV to V
+        double vout1 = mRawResult.userOut[ch][0] / 1000.0;
+        double vout2 = mRawResult.userOut[ch][2] / 1000.0;
+        double hex1 = mRawResult.dacValOut[0];
+        double hex2 = mRawResult.dacValOut[2];
+
+        mCalibOutA[ch] = (vout1 - (vout2*hex1/hex2)) / (1 - (hex1/hex2));
+        mCalibOutB[ch] = (vout2 - mCalibOutA[ch]) / hex2;
+    }
+}
+
+/*!
+    Returns a table with the calibrated value in Volts of each of the
+    AnalogLevels 12-bit sample values for channel \a ch at the V/div
+    setting with index \a voltsPerDivIndex. The table holds
+    A + B * sample, so looking a sample up gives exactly the same value as
+    calculating it.
+
+    A table is calculated the first time it is needed and is then kept
+    for as long as the calibration data, which is replaced when the
+    device is calibrated again. Returns NULL if \a ch or
+    \a voltsPerDivIndex is out of range.
+*/
+const double* LabToolCalibrationData::analogLookupTable(int ch, int voltsPerDivIndex)
+{
+    if (ch < 0 || ch >= NumAnalogChannels
+            || voltsPerDivIndex < 0 || voltsPerDivIndex >= NumVoltsPerDiv) {
+        return NULL;
+    }
+
+    QVector<double> &table = mAnalogTables[ch][voltsPerDivIndex];
+
+    if (table.isEmpty()) {
+        double a = mCalibA[ch][voltsPerDivIndex];
+        double b = mCalibB[ch][voltsPerDivIndex];
+
+        table.resize(AnalogLevels);
+        for (int i = 0; i < AnalogLevels; i++) {
+            table[i] = a + b * i;
+        }
+    }
+
+    return table.constData();
 }
 
 /*!
@@ -150,6 +205,20 @@ void LabToolCalibrationData::printCalibrationInfo()
     it's Volt/div setting \a voltsPerDivIndex
 */
 
+/*!
+    \fn double LabToolCalibrationData::analogOutFactorA()
+
+    Returns the A factor for the analog output \a ch. The value to write
+    to the DAC for a wanted output level is (Vout - A) / B.
+*/
+
+/*!
+    \fn double LabToolCalibrationData::analogOutFactorB()
+
+    Returns the B factor for the analog output \a ch. The value to write
+    to the DAC for a wanted output level is (Vout - A) / B.
+*/
+
 /*!
     \fn const quint8* LabToolCalibrationData::rawCalibrationData()
 
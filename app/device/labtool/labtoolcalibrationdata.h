@@ -18,6 +18,7 @@
 
 #include <qglobal.h>
 #include <QString>
+#include <QVector>
 
 class LabToolCalibrationData
 {
@@ -45,16 +46,31 @@ private:
 
     double mCalibA[2][8];
     double mCalibB[2][8];
+    double mCalibOutA[2];
+    double mCalibOutB[2];
     calib_result mRawResult;
     bool mReasonableData;
 
+    QVector<double> mAnalogTables[2][8];
+
 public:
+
+    enum Constants {
+        AnalogLevels = 4096,
+        NumAnalogChannels = 2,
+        NumVoltsPerDiv = 8
+    };
+
     LabToolCalibrationData(const quint8* data);
 
     static int rawDataByteSize() { return sizeof(calib_result); }
 
     double analogFactorA(int ch, int voltsPerDivIndex) { return mCalibA[ch][voltsPerDivIndex]; }
     double analogFactorB(int ch, int voltsPerDivIndex) { return mCalibB[ch][voltsPerDivIndex]; }
+    const double* analogLookupTable(int ch, int voltsPerDivIndex);
+
+    double analogOutFactorA(int ch) { return mCalibOutA[ch]; }
+    double analogOutFactorB(int ch) { return mCalibOutB[ch]; }
 
     const quint8* rawCalibrationData() { return (const quint8*)&mRawResult; }
 
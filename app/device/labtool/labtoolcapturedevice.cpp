@@ -20,6 +20,8 @@
 #include <QTimer>
 
 #include "labtoolcalibrationwizard.h"
+#include "common/instrumentation.h"
+#include "capture_vadc_pack.h"
 
 
 /*! @brief Configuration for digital signal capture.
@@ -228,16 +230,32 @@ LabToolCaptureDevice::LabToolCaptureDevice(QObject *parent) :
     mTriggerConfig = new UiLabToolTriggerConfig();
     mConfigMustBeUpdated = true;
 
+    // Deallocation: Destructor is responsible (created in showDiagnostics),
+    //   unless its parent has already deleted it
+    mDiagnostics = NULL;
+
     mDeviceComm = NULL;
     mEndSampleIdx = 0;
     mTriggerIndex = 0;
     mReconfigTimer = NULL;
     mRunningCapture = false;
+    mContinuous = false;
+    mDroppedCaptures = 0;
     mReconfigurationRequested = false;
     mWarnUncalibrated = true;
     mRequestedSampleRate = -1;
     mLastUsedSampleRate = -2;
 
+    // the order is the V/div index used by the hardware and calibration
+    mSupportedVPerDiv << 0.02
+                      << 0.05
+                      << 0.1
+                      << 0.2
+                      << 0.5
+                      << 1
+                      << 2
+                      << 5;
+
     for (int i = 0; i < MaxDigitalSignals; i++) {
         mDigitalSignals[i] = NULL;
         mDigitalSignalTransitions[i] = NULL;
@@ -246,6 +264,7 @@ LabToolCaptureDevice::LabToolCaptureDevice(QObject *parent) :
     for (int i = 0; i < MaxAnalogSignals; i++) {
         mAnalogSignals[i] = NULL;
         mAnalogSignalData[i] = NULL;
+        mAnalogLevelSearches[i] = NULL;
     }
 }
 
@@ -269,6 +288,9 @@ LabToolCaptureDevice::~LabToolCaptureDevice()
         if (mAnalogSignalData[i] != NULL) {
             delete mAnalogSignalData[i];
         }
+        if (mAnalogLevelSearches[i] != NULL) {
+            delete mAnalogLevelSearches[i];
+        }
     }
 
     for (int i = 0; i < MaxDigitalSignals; i++) {
@@ -281,6 +303,10 @@ LabToolCaptureDevice::~LabToolCaptureDevice()
     }
 
     delete mTriggerConfig;
+
+    if (!mDiagnostics.isNull()) {
+        delete mDiagnostics;
+    }
 }
 
 QList<int> LabToolCaptureDevice::supportedSampleRates()
@@ -328,17 +354,6 @@ int LabToolCaptureDevice::maxNumAnalogSignals()
 
 QList<double> LabToolCaptureDevice::supportedVPerDiv()
 {
-    if (mSupportedVPerDiv.size() == 0) {
-        mSupportedVPerDiv << 0.02
-                          << 0.05
-                          << 0.1
-                          << 0.2
-                          << 0.5
-                          << 1
-                          << 2
-                          << 5;
-    }
-
     return mSupportedVPerDiv;
 }
 
@@ -389,6 +404,33 @@ void LabToolCaptureDevice::calibrate(QWidget *parent)
     }
 }
 
+/*!
+    Opens the \ref UiLabToolDiagnostics dialog with the performance counters
+    of the LabTool Hardware. The dialog is not modal and is refreshed after
+    each capture until it is closed.
+*/
+void LabToolCaptureDevice::showDiagnostics(QWidget *parent)
+{
+    if (mDiagnostics.isNull()) {
+        mDiagnostics = new UiLabToolDiagnostics(parent);
+    }
+    mDiagnostics->setComm(mDeviceComm);
+    mDiagnostics->refresh();
+    mDiagnostics->show();
+    mDiagnostics->raise();
+    mDiagnostics->activateWindow();
+}
+
+/*!
+    Returns the index of the V/div setting of \a signal in the list of
+    supported V/div settings, which is the index used by the hardware and
+    the calibration data, or -1 if it isn't supported.
+*/
+int LabToolCaptureDevice::voltsPerDivIndex(const AnalogSignal* signal) const
+{
+    return mSupportedVPerDiv.indexOf(signal->vPerDiv());
+}
+
 /*!
     Scans the list of digital samples and locates the first entry with the correct
     level and returns it's index. The parameter \a s is the list of digital
@@ -431,296 +473,34 @@ int LabToolCaptureDevice::locatePreviousLevel(QVector<int> *s, int level, int of
 
 
 /*!
-    Scans the list of calibrated (double format) analog samples specified
-    by the \a s parameter starting at \a offset, looking
-    for the position where the value goes from above \a highLevel to below
-    \a lowLevel.
-
-    In cases where the sample rate is much higher than the frequency of
-    the sampled signal a lot of samples will have about the same value
-    and the returned index is calculated as the middle point between the
-    last value above \a highLevel and the first value below \a lowLevel.
+    Searches the analog samples in \a search for the crossing of the given
+    \a edge, with the hysteresis levels \a lowLevel and \a highLevel,
+    closest to the sample \a analogTrigSample where the hardware detected
+    the trigger. Returns 0 if there isn't one.
+
+    Both the first crossing after and the last crossing before the trigger
+    sample are located, with a margin of 20 samples, and the one before is
+    preferred unless the one after is less than half as far away.
 */
-int LabToolCaptureDevice::locateAnalogHighLowTransition(QVector<double> *s, double lowLevel, double highLevel, int offset)
+int LabToolCaptureDevice::locateAnalogTransition(const AnalogLevelSearch &search, AnalogLevelSearch::Edge edge, double lowLevel, double highLevel, int analogTrigSample)
 {
-    int numSamples = s->size();
-
-    if (highLevel != lowLevel) {
-
-//        qDebug("dlocateAnalogHighLowTransition(trigLevel %f, offset %d", trigLevel, offset);
-//        qDebug("lowLevel %f, highLevel %f, looking for High->Low", lowLevel, highLevel);
+    int trigIdx = 0;
 
-        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
-            if (s->at(i) > highLevel) {
-LocateAnalogHighLowTransition_restart_comp:
-//                qDebug("s[%d]: %f above %f, restart", i, s->at(i), highLevel);
-                int lastAbove = i;
-                while ((lastAbove < numSamples) && (s->at(lastAbove) > highLevel)) {
-//                    qDebug("s[%d]: %f still above %f", lastAbove, s->at(lastAbove), highLevel);
-                    lastAbove++;
-                }
-                if (lastAbove < numSamples) {
-//                    qDebug("s[%d]: %f broke while with > %f", lastAbove, s->at(lastAbove), highLevel);
-                } else {
-//                    qDebug("s[%d]: broke while as \"out of bounds\"", lastAbove);
-                    break;
-                }
-
-                // found first value above level, now find equal to or below level
-                for (i = lastAbove; i < numSamples; i++) {
-                    if (s->at(i) <= lowLevel) {
-//                        qDebug("s[%d]: %f <= %f, done returning %d", i, s->at(i), lowLevel, (i+lastAbove)/2);
-                        // found transition
-                        return (i+lastAbove)/2;
-                    }
-                    if (s->at(i) > highLevel) {
-                        goto LocateAnalogHighLowTransition_restart_comp;
-                    }
-//                    qDebug("s[%d]: %f between %f and %f", i, s->at(i), lowLevel, highLevel);
-                }
-                break;
-            }
-            else {
-//                qDebug("s[%d]: %f  not above %f", i, s->at(i), highLevel);
-            }
-        }
-    } else {
-        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
-            if (s->at(i) > highLevel) {
-                // found first value above level, now find equal to or below level
-                for (i = i+1; i < numSamples; i++) {
-                    if (s->at(i) <= lowLevel) {
-                        // found transition
-                        return i;
-                    }
-                }
-                break;
-            }
-        }
+    int pos = (int)search.next(edge, lowLevel, highLevel, analogTrigSample-20);
+    if (pos != -1) {
+        // found first possible trigger past the analogTrigSample location
+        trigIdx = pos;
     }
-
-    return -1;
-}
-
-/*!
-    Scans the list of calibrated (double format) analog samples specified
-    by the \a s parameter backwards, starting at \a offset, looking
-    for the position where the value goes from above \a highLevel to below
-    \a lowLevel.
-
-    As the list is searched backwards the search starts with the low level
-    and then the high level - the opposite of the forward search.
-
-    In cases where the sample rate is much higher than the frequency of
-    the sampled signal a lot of samples will have about the same value
-    and the returned index is calculated as the middle point between the
-    last value above \a highLevel and the first value below \a lowLevel.
-*/
-int LabToolCaptureDevice::locatePreviousAnalogHighLowTransition(QVector<double> *s, double lowLevel, double highLevel, int offset)
-{
-    int numSamples = s->size();
-
-    if (highLevel != lowLevel) {
-
-//        qDebug("dlocatePreviousAnalogHighLowTransition(trigLevel %f, offset %d", trigLevel, offset);
-//        qDebug("lowLevel %f, highLevel %f, looking for High->Low", lowLevel, highLevel);
-
-        for (int i = (offset >= numSamples ? numSamples-1 : offset); i >= 0; i--) {
-            if (s->at(i) < lowLevel) {
-LocatePreviousAnalogHighLowTransition_restart_comp:
-//                qDebug("s[%d]: %f below %f, restart", i, s->at(i), lowLevel);
-                int lastBelow = i;
-                while ((lastBelow >= 0) && (s->at(lastBelow) < lowLevel)) {
-//                    qDebug("s[%d]: %f still below %f", lastBelow, s->at(lastBelow), lowLevel);
-                    lastBelow--;
-                }
-
-                if (lastBelow >= 0) {
-//                    qDebug("s[%d]: %f broke while with < %f", lastBelow, s->at(lastBelow), lowLevel);
-                } else {
-//                    qDebug("s[%d]: broke while as \"out of bounds\"", lastBelow);
-                    break;
-                }
-
-                // found first value above low level, now find equal to or above high level
-                for (i = lastBelow; i >= 0; i--) {
-                    if (s->at(i) >= highLevel) {
-//                        qDebug("s[%d]: %f >= %f, done returning %d", i, s->at(i), highLevel, (i+lastBelow)/2);
-                        // found transition
-                        return (i+lastBelow)/2;
-                    }
-                    if (s->at(i) < lowLevel) {
-                        goto LocatePreviousAnalogHighLowTransition_restart_comp;
-                    }
-//                    qDebug("s[%d]: %f between %f and %f", i, s->at(i), lowLevel, highLevel);
-                }
-                break;
-            }
-            else {
-//                qDebug("s[%d]: %f  not below %f", i, s->at(i), lowLevel);
-            }
-        }
-    } else {
-        for (int i = (offset >= numSamples ? numSamples-1 : offset); i >= 0; i--) {
-            if (s->at(i) < lowLevel) {
-                // found first value below level, now find equal to or above level
-                for (i = i-1; i >= 0; i--) {
-                    if (s->at(i) >= highLevel) {
-                        // found transition
-                        return i+1;
-                    }
-                }
-                break;
-            }
+    pos = (int)search.previous(edge, lowLevel, highLevel, analogTrigSample+20);
+    if (pos != -1) {
+        // found last trigger before the analogTrigSample location
+        if (abs(pos-analogTrigSample) < 2*abs(trigIdx-analogTrigSample)) { //*2 as we prefer to find the one prior to the analogTrigSample
+            // this trigger is the closest one to the analogTrigSample location
+            trigIdx = pos;
         }
     }
 
-    return -1;
-}
-
-/*!
-    Scans the list of calibrated (double format) analog samples specified
-    by the \a s parameter starting at \a offset, looking
-    for the position where the value goes from below \a lowLevel to above
-    \a highLevel.
-
-    In cases where the sample rate is much higher than the frequency of
-    the sampled signal a lot of samples will have about the same value
-    and the returned index is calculated as the middle point between the
-    last value below \a lowLevel and the first value above \a highLevel.
-*/
-int LabToolCaptureDevice::locateAnalogLowHighTransition(QVector<double> *s, double lowLevel, double highLevel, int offset)
-{
-    int numSamples = s->size();
-
-    if (highLevel != lowLevel) {
-
-//        qDebug("dlocateAnalogLowHighTransition(trigLevel %f, offset %d", trigLevel, offset);
-//        qDebug("lowLevel %f, highLevel %f, looking for High->Low", lowLevel, highLevel);
-
-        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
-            if (s->at(i) < lowLevel) {
-LocateAnalogLowHighTransition_restart_comp:
-//                qDebug("s[%d]: %f below %f, restart", i, s->at(i), lowLevel);
-                int lastBelow = i;
-                while ((lastBelow < numSamples) && (s->at(lastBelow) < lowLevel)) {
-//                    qDebug("s[%d]: %f still below %f", lastBelow, s->at(lastBelow), lowLevel);
-                    lastBelow++;
-                }
-                if (lastBelow < numSamples) {
-//                    qDebug("s[%d]: %f broke while with < %f", lastBelow, s->at(lastBelow), lowLevel);
-                } else {
-//                    qDebug("s[%d]: broke while as \"out of bounds\"", lastBelow);
-                    break;
-                }
-
-                // found first value below level, now find equal to or above level
-                for (i = lastBelow; i < numSamples; i++) {
-                    if (s->at(i) >= highLevel) {
-//                        qDebug("s[%d]: %f <= %f, done returning %d", i, s->at(i), highLevel, (i+lastBelow)/2);
-                        // found transition
-                        return (i+lastBelow)/2;
-                    }
-                    if (s->at(i) < lowLevel) {
-                        goto LocateAnalogLowHighTransition_restart_comp;
-                    }
-//                    qDebug("s[%d]: %f between %f and %f", i, s->at(i), lowLevel, highLevel);
-                }
-                break;
-            }
-            else {
-//                qDebug("s[%d]: %f  not below %f", i, s->at(i), lowLevel);
-            }
-        }
-    } else {
-        for (int i = (offset < 0 ? 0 : offset); i < numSamples; i++) {
-            if (s->at(i) < lowLevel) {
-                // found first value below level, now find equal to or above level
-                for (i = i+1; i < numSamples; i++) {
-                    if (s->at(i) >= highLevel) {
-                        // found transition
-                        return i;
-                    }
-                }
-                break;
-            }
-        }
-    }
-
-    return -1;
-}
-
-/*!
-    Scans the list of calibrated (double format) analog samples specified
-    by the \a s parameter backwards, starting at \a offset, looking
-    for the position where the value goes from below \a lowLevel to above
-    \a highLevel.
-
-    In cases where the sample rate is much higher than the frequency of
-    the sampled signal a lot of samples will have about the same value
-    and the returned index is calculated as the middle point between the
-    last value below \a lowLevel and the first value above \a highLevel.
-*/
-int LabToolCaptureDevice::locatePreviousAnalogLowHighTransition(QVector<double> *s, double lowLevel, double highLevel, int offset)
-{
-    int numSamples = s->size();
-
-    if (highLevel != lowLevel) {
-
-//        qDebug("dlocatePreviousAnalogLowHighTransition(trigLevel %f, offset %d", trigLevel, offset);
-//        qDebug("lowLevel %f, highLevel %f, looking for High->Low", lowLevel, highLevel);
-
-        for (int i = (offset >= numSamples ? numSamples-1 : offset); i >= 0; i--) {
-            if (s->at(i) > highLevel) {
-LocatePreviousAnalogLowHighTransition_restart_comp:
-//                qDebug("s[%d]: %f above %f, restart", i, s->at(i), highLevel);
-                int lastAbove = i;
-                while ((lastAbove >= 0) && (s->at(lastAbove) > highLevel)) {
-//                    qDebug("s[%d]: %f still above %f", lastAbove, s->at(lastAbove), highLevel);
-                    lastAbove--;
-                }
-
-                if (lastAbove >= 0) {
-//                    qDebug("s[%d]: %f broke while with > %f", lastAbove, s->at(lastAbove), highLevel);
-                } else {
-//                    qDebug("s[%d]: broke while as \"out of bounds\"", lastAbove);
-                    break;
-                }
-
-                // found first value below high level, now find equal to or below low level
-                for (i = lastAbove; i >= 0; i--) {
-                    if (s->at(i) <= lowLevel) {
-//                        qDebug("s[%d]: %f <= %f, done returning %d", i, s->at(i), lowLevel, (i+lastAbove)/2);
-                        // found transition
-                        return (i+lastAbove)/2;
-                    }
-                    if (s->at(i) > highLevel) {
-                        goto LocatePreviousAnalogLowHighTransition_restart_comp;
-                    }
-//                    qDebug("s[%d]: %f between %f and %f", i, s->at(i), lowLevel, highLevel);
-                }
-                break;
-            }
-            else {
-//                qDebug("s[%d]: %f  not above %f", i, s->at(i), highLevel);
-            }
-        }
-    } else {
-        for (int i = (offset >= numSamples ? numSamples-1 : offset); i >= 0; i--) {
-            if (s->at(i) > highLevel) {
-                // found first value above level, now find equal to or below level
-                for (i = i-1; i >= 0; i--) {
-                    if (s->at(i) <= lowLevel) {
-                        // found transition
-                        return i+1;
-                    }
-                }
-                break;
-            }
-        }
-    }
-
-    return -1;
+    return trigIdx;
 }
 
 /*!
@@ -751,38 +531,21 @@ LocatePreviousAnalogLowHighTransition_restart_comp:
 
     The \a trig parameter holds the id of the channel that caused the trigger.
 
-    The \a digitalTrigSample and \a analogTrigSample parameters holds the current
-    sample index at the time of triggering. They exist regardless of what caused
-    the trigger (analog or digital) and are used to synchronize the signals in
-    time. Example: \a digitalTrigSample is 500 and \a analogTrigSample is 600.
-    The set of digital signals will be truncated and the last 100 samples removed.
-    The set of analog signals will have the first 100 samples removed. The result
-    is that both sets will be better aligned.
+    The \a digitalTrigSample parameter holds the current sample index at the
+    time of triggering and is used to locate the trigger point in the data. The
+    \a analogTrigSample parameter is only used when converting analog data (see
+    \ref convertAnalogInput). The digital data is never moved, it is the
+    reference for the time of all other signals.
 */
 void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size, quint32 activeChannels, quint32 trig, int digitalTrigSample, int analogTrigSample)
 {
+    (void)analogTrigSample; // the digital data is the time reference
     quint32* samples = (quint32*)pData;
     int signalsInInput = activeChannels >> 16;
 
-    int samplePointDiff = analogTrigSample - digitalTrigSample;
-    if (analogTrigSample == 0) {
-        // no analog signals to adjust to. data only contains digital signals
-        samplePointDiff = 0;
-    }
-    if (samplePointDiff > 0) {
-        // need to remove samples from the start of the analog data
-        // and remove samples from the end of the digital data
-        // to align the two
-    } else if (samplePointDiff < 0){
-        // need to remove samples from the start of the digital data
-        // and remove samples from the end of the analog data
-        // to align the two
-        digitalTrigSample += samplePointDiff; // move trigger point
-        //qDebug("D: Diff %d, reduced digitalTrigSample to %d", samplePointDiff, digitalTrigSample);
-    }
-
     foreach(DigitalSignal* signal, mDigitalSignalList) {
         int id = signal->id();
+        InstrumentationTimer timer(QString("Convert D%1").arg(id));
 
         if (id >= MaxDigitalSignals) continue;
         int slice = id;//GetSliceForId(id, activeChannels);
@@ -803,30 +566,6 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
             }
         }
 
-        if (samplePointDiff > 0) {
-            // need to remove samples from the start of the analog data
-            // and remove samples from the end of the digital data
-            // to align the two
-            if (s->size() >= samplePointDiff) {
-                s->remove(s->size()-samplePointDiff-1, samplePointDiff);
-                //qDebug("D: Diff %d, removed %d samples from the end of the digital data", samplePointDiff, samplePointDiff);
-            } else {
-                //qDebug("D: Diff %d, removed all %d samples from the digital data", samplePointDiff, s->size());
-                s->clear();
-            }
-        } else if (samplePointDiff < 0){
-            // need to remove samples from the start of the digital data
-            // and remove samples from the end of the analog data
-            // to align the two
-            if (s->size() >= -samplePointDiff) {
-                s->remove(0, -samplePointDiff);
-                //qDebug("D: Diff %d, removed %d samples from the start of the digital data", samplePointDiff, -samplePointDiff);
-            } else {
-                //qDebug("D: Diff %d, removed all %d samples from the digital data", samplePointDiff, s->size());
-                s->clear();
-            }
-        }
-
 
         if (((int)trig) == id)
         {
@@ -854,7 +593,7 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
                         //qDebug("Found High->Low at %d, (%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
 
                         // found last trigger before the digitalTrigSample location
-                        if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
+                        if (qAbs(pos-digitalTrigSample) < qAbs(mTriggerIndex-digitalTrigSample)) {
                             // this trigger is the closest one to the digitalTrigSample location
                             mTriggerIndex = pos;
                         }
@@ -881,7 +620,7 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
                         //qDebug("Found Low->High at %d, (%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
 
                         // found last trigger before the digitalTrigSample location
-                        if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
+                        if (qAbs(pos-digitalTrigSample) < qAbs(mTriggerIndex-digitalTrigSample)) {
                             // this trigger is the closest one to the digitalTrigSample location
                             mTriggerIndex = pos;
                         }
@@ -900,7 +639,7 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
                 pos = locatePreviousLevel(s, 1, digitalTrigSample+20);
                 if (pos != -1) {
                     // found last trigger before the digitalTrigSample location
-                    if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
+                    if (qAbs(pos-digitalTrigSample) < qAbs(mTriggerIndex-digitalTrigSample)) {
                         // this trigger is the closest one to the digitalTrigSample location
                         mTriggerIndex = pos;
                     }
@@ -917,7 +656,7 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
                 pos = locatePreviousLevel(s, 0, digitalTrigSample+20);
                 if (pos != -1) {
                     // found last trigger before the digitalTrigSample location
-                    if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
+                    if (qAbs(pos-digitalTrigSample) < qAbs(mTriggerIndex-digitalTrigSample)) {
                         // this trigger is the closest one to the digitalTrigSample location
                         mTriggerIndex = pos;
                     }
@@ -951,14 +690,14 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
     \dot
      digraph structs {
          node [shape=record];
-         start [label="A0 | A1 | A0 | ..."];
+         start [label="Header | A0 A1 | A0 A1 | ... | Header | A0 A1 | ..."];
      }
      \enddot
 
-    Each box is a 16-bit value containing one analog samples for that channel.
-    If only one channel is enabled then only that channel's data will be present.
-    Each 16-bit value is also marked with information about which channel
-    the data is for.
+    The 12-bit samples are packed in blocks, two samples in three bytes,
+    and the header of each block tells which channel the first sample
+    belongs to. If only one channel is enabled then only that channel's data
+    will be present. See capture_vadc_pack.h for a description of the format.
 
     The \a pData parameter is a pointer to the data, \a size is the number of
     bytes of data.
@@ -967,8 +706,6 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
     the number of channels with values in the data, the 16 LSB holds a bitmask
     where each channel with valid data has a bit set.
 
-    \todo Remove the \a activeChannels part of the protocol for analog signals?
-
     At high sample rates the analog signal data can get corrupted. This is only
     visible in the data when both analog channels are enabled and it will look
     like this:
@@ -980,7 +717,8 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
      }
      \enddot
 
-     This function detects the double values and inserts a value for the
+     The firmware detects the double values, starts a new block and marks it
+     as having a skipped sample. This function then inserts a value for the
      missing channel. In the example above channel A1 would get an extra value
      inserted. The reason for inserting extra value(s) is to at least keep the
      signals identical in length.
@@ -990,8 +728,6 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
 */
 void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels)
 {
-    quint16* samples = (quint16*)pData;//PACKED
-
     for (int i = 0; i < MaxAnalogSignals; i++) {
         if (mAnalogSignalData[i] != NULL) {
             delete mAnalogSignalData[i];
@@ -999,15 +735,6 @@ void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size,
         mAnalogSignalData[i] = NULL;
     }
 
-#define A0_CH_ID  (0)  // Mapping of A0 to the VADC channel number in fw
-#define A1_CH_ID  (1)  // Mapping of A1 to the VADC channel number in fw
-
-    // This is adjusted unpacking of the data. If an EMPTY marker is found, it is not treated
-    // as data and is instead discarded. If two channels are sampled and two consecutive
-    // samples for the same channel is found then an additional sample is inserted in the other
-    // channel to make up for the missing one. The id bits of each sample is also read to make
-    // sure that the samples end up on the correct signal's vector (prevents signal swapping).
-
     // Deallocation:
     //   QVector will be deallocated either by this function or by deleteSignals,
     //   unpackAnalogInput or the destructor as a part of deallocating mAnalogSignalData
@@ -1017,57 +744,25 @@ void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size,
     //   unpackAnalogInput or the destructor as a part of deallocating mAnalogSignalData
     QVector<quint16> *s1 = new QVector<quint16>();
     int numChannels = mAnalogSignalList.size();
-    int lastId = -1;
-    int numSamples = size/2;
     (void)activeChannels; // To avoid warning
 
-    // Sometimes the absolute first sample is invalid (channel id 0). If that is the
-    // case then discard that sample
-//    if (((*samples & 0x7000)>>12) == 0) {
-//        numSamples--;
-//        samples++;
-//    }
-
-    for (int i = 0; i < numSamples; i++)
-    {
-        int id = (*samples & 0x7000)>>12;
-        int empty = (*samples & 0x8000)>>15;
-        if (empty)
-        {
-            qDebug("Empty marker for i=%d", i);
-        }
-        else
-        {
-            if (id == lastId && numChannels>1)
-            {
-                // found a skip i.e. two consecutive samples for the same channel, add an extra sample for the other channel
-                if (id == A1_CH_ID)
-                {
-                    s0->append(s0->isEmpty() ? 0 : s0->last());
-                }
-                else
-                {
-                    s1->append(s1->isEmpty() ? 0 : s1->last());
-                }
-                qDebug("Skip at i=%d", i);
-            }
+    // Each channel can get at most all values (2 per 3 bytes) plus one
+    // value per block for skipped samples, size is more than enough
+    s0->resize(size);
+    s1->resize(size);
 
-            if (id == A1_CH_ID)
-            {
-                quint16 val = *samples;//PACKED
-                val = val & 0xfff;
-                s1->append(val);
-            }
-            else
-            {
-                quint16 val = *samples;//PACKED
-                val = val & 0xfff;
-                s0->append(val);
-            }
-            lastId = id;
-        }
-        samples++;
+    uint16_t* values[2] = {s0->data(), s1->data()};
+    uint32_t numValues[2] = {0, 0};
+    uint32_t numSkips = 0;
+    if (cap_vadc_pack_Unpack(pData, size, numChannels, values, numValues, size, &numSkips) != 0) {
+        qDebug("Malformed analog data");
     }
+    if (numSkips > 0) {
+        qDebug("Found %u skipped analog samples", numSkips);
+    }
+
+    s0->resize(numValues[0]);
+    s1->resize(numValues[1]);
 
     // Make sure that the same amount of samples have been received for both channels.
     // This difference can only happen when two channels have been sampled and the
@@ -1104,12 +799,13 @@ void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size,
             percent = 5;
         }
 
+        // the compensated values are kept within the 12-bit range
         s0prim->append(s0->at(0));
-        s1prim->append(s1->at(0) - (percent*(s0->at(0) - 2048))/100);
+        s1prim->append(qBound(0, s1->at(0) - (percent*(s0->at(0) - 2048))/100, 4095));
         for (int i = 1; i < s1->size(); i++)
         {
-            s0prim->append(s0->at(i) - (percent*(s1->at(i-1) - 2048))/100);
-            s1prim->append(s1->at(i) - (percent*(s0->at(i) - 2048))/100);
+            s0prim->append(qBound(0, s0->at(i) - (percent*(s1->at(i-1) - 2048))/100, 4095));
+            s1prim->append(qBound(0, s1->at(i) - (percent*(s0->at(i) - 2048))/100, 4095));
         }
 
         delete s0;
@@ -1145,9 +841,12 @@ void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size,
     sample index at the time of triggering. They exist regardless of what caused
     the trigger (analog or digital) and are used to synchronize the signals in
     time. Example: \a digitalTrigSample is 500 and \a analogTrigSample is 600.
-    The set of digital signals will be truncated and the last 100 samples removed.
-    The set of analog signals will have the first 100 samples removed. The result
-    is that both sets will be better aligned.
+    The first analog sample was then taken 100 sample periods before the first
+    digital sample. The signal data is left as it is and the difference is
+    stored as a time offset for each analog signal, see
+    CaptureDevice::analogTimeOffset(). When both channels are enabled they are
+    converted one after the other, so the second channel gets an additional
+    offset of half a sample period.
 */
 void LabToolCaptureDevice::convertAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels, quint32 trig, int analogTrigSample, int digitalTrigSample)
 {
@@ -1156,71 +855,60 @@ void LabToolCaptureDevice::convertAnalogInput(const quint8 *pData, quint32 size,
         // nothing to do
         return;
     }
-    unpackAnalogInput(pData, size, activeChannels);
+    {
+        InstrumentationTimer timer("Unpack analog");
+        unpackAnalogInput(pData, size, activeChannels);
+    }
 
-    int samplePointDiff = analogTrigSample - digitalTrigSample;
+    // number of sample periods from the first digital sample to the
+    // first analog sample
+    int samplePointDiff = digitalTrigSample - analogTrigSample;
     if (digitalTrigSample == 0) {
         // no digital signals to adjust to. data only contains analog signals
         samplePointDiff = 0;
     }
-    if (samplePointDiff > 0) {
-        // need to remove samples from the start of the analog data
-        // and remove samples from the end of the digital data
-        // to align the two
-        analogTrigSample -= samplePointDiff; // move trigger point
-        //qDebug("A: Diff %d, reduced analogTrigSample to %d", samplePointDiff, analogTrigSample);
-    } else if (samplePointDiff < 0){
-        // need to remove samples from the start of the digital data
-        // and remove samples from the end of the analog data
-        // to align the two
-    }
+    int numChannels = (activeChannels >> 16);
 
     LabToolCalibrationData* calib = mDeviceComm->storedCalibrationData();
 
     foreach(AnalogSignal* signal, mAnalogSignalList) {
         int id = signal->id();
-        int voltsPerDivIndex = supportedVPerDiv().indexOf(signal->vPerDiv());
-        double a = calib->analogFactorA(id, voltsPerDivIndex);
-        double b = calib->analogFactorB(id, voltsPerDivIndex);
-
+        InstrumentationTimer timer(QString("Convert A%1").arg(id));
         if (mAnalogSignalData[id] == NULL) continue;
 
-        if (samplePointDiff > 0) {
-            // need to remove samples from the start of the analog data
-            // and remove samples from the end of the digital data
-            // to align the two
-            analogTrigSample -= samplePointDiff; // move trigger point
-            if (mAnalogSignalData[id]->size() >= samplePointDiff) {
-                mAnalogSignalData[id]->remove(0, samplePointDiff);
-                //qDebug("A: Diff %d, removed %d samples from the start of the analog data", samplePointDiff, samplePointDiff);
-            } else {
-                //qDebug("A: Diff %d, removed all %d samples from the analog data", samplePointDiff, mAnalogSignalData[id]->size());
-                mAnalogSignalData[id]->clear();
-            }
-        } else if (samplePointDiff < 0){
-            // need to remove samples from the start of the digital data
-            // and remove samples from the end of the analog data
-            // to align the two
-            if (mAnalogSignalData[id]->size() >= -samplePointDiff) {
-                mAnalogSignalData[id]->remove(mAnalogSignalData[id]->size()+samplePointDiff-1, -samplePointDiff);
-                //qDebug("A: Diff %d, removed %d samples from the end of the analog data", samplePointDiff, -samplePointDiff);
-            } else {
-                //qDebug("A: Diff %d, removed all %d samples from the analog data", samplePointDiff, mAnalogSignalData[id]->size());
-                mAnalogSignalData[id]->clear();
-            }
+        // not a supported V/div setting, see updateAnalogConfigData
+        int vPerDivIdx = voltsPerDivIndex(signal);
+        const double* table = calib->analogLookupTable(id, vPerDivIdx);
+        if (table == NULL) continue;
+
+        double b = calib->analogFactorB(id, vPerDivIdx);
+
+        // the second channel is converted half a sample period after
+        // the first one
+        double sampleOffset = samplePointDiff;
+        if (numChannels > 1 && id == 1) {
+            sampleOffset += 0.5;
         }
+        setAnalogTimeOffset(id, sampleOffset / mUsedSampleRate);
 
         // Deallocation:
         //   QVector will be deallocated either by this function or the destructor
         //   as a part of deallocating mAnalogSignals
-        QVector<double> *s = new QVector<double>();
+        QVector<double> *s = new QVector<double>(mAnalogSignalData[id]->size());
 
-        for (int j = 0; j < mAnalogSignalData[id]->size(); j++)
+        // the samples are 12-bit values, so the calibration is a table lookup
+        const quint16* raw = mAnalogSignalData[id]->constData();
+        double* volts = s->data();
+        for (int j = 0; j < s->size(); j++)
         {
-            double dval = a + b * mAnalogSignalData[id]->at(j);
-            s->append(dval);
+            volts[j] = table[raw[j] & (LabToolCalibrationData::AnalogLevels-1)];
         }
 
+        // Deallocation:
+        //   Deleted by deleteSignals, setAnalogData or the destructor as a
+        //   part of deallocating mAnalogLevelSearches
+        AnalogLevelSearch* search = new AnalogLevelSearch(*s);
+
         if (signal->triggerState() != AnalogSignal::AnalogTriggerNone)
         {
             double trigLevel = signal->triggerLevel();
@@ -1236,85 +924,22 @@ void LabToolCaptureDevice::convertAnalogInput(const quint8 *pData, quint32 size,
                 highLevel = trigLevel + b * mTriggerConfig->noiseFilter12BitLevel();
             }
 
-            int pos;
-            switch(signal->triggerState()) {
-            // Falling edge
-            case AnalogSignal::AnalogTriggerHighLow:
-                pos = locateAnalogHighLowTransition(s, lowLevel, highLevel, analogTrigSample-20);
-                if (pos != -1) {
-                    // found first possible trigger past the analogTrigSample location
-                    //qDebug("Found High->Low at %d, (+%d from %d)", pos, pos - analogTrigSample, analogTrigSample);
-                    mTriggerIndex = pos;
-                }
-                pos = locatePreviousAnalogHighLowTransition(s, lowLevel, highLevel, analogTrigSample+20);
-                if (pos != -1) {
-                    // found last trigger before the analogTrigSample location
-                    //qDebug("Found High->Low at %d, (%d from %d)", pos, pos - analogTrigSample, analogTrigSample);
-                    if (abs(pos-analogTrigSample) < 2*abs(mTriggerIndex-analogTrigSample)) { //*2 as we prefer to find the one prior to the analogTrigSample
-                        // this trigger is the closest one to the analogTrigSample location
-                        mTriggerIndex = pos;
-                    }
-                }
-                if (mTriggerIndex == 0) {
-                    // Could not find any trigger point after filtering. Try with the unfiltered search.
-                    pos = locateAnalogHighLowTransition(s, trigLevel, trigLevel, analogTrigSample-20);
-                    if (pos != -1) {
-                        // found first possible trigger past the analogTrigSample location
-                        //qDebug("Found unfiltered High->Low at %d, (+%d from %d)", pos, pos - analogTrigSample, analogTrigSample);
-                        mTriggerIndex = pos;
-                    }
-                    pos = locatePreviousAnalogHighLowTransition(s, trigLevel, trigLevel, analogTrigSample+20);
-                    if (pos != -1) {
-                        // found last trigger before the analogTrigSample location
-                        //qDebug("Found unfiltered High->Low at %d, (%d from %d)", pos, pos - analogTrigSample, analogTrigSample);
-                        if (abs(pos-analogTrigSample) < 2*abs(mTriggerIndex-analogTrigSample)) { //*2 as we prefer to find the one prior to the analogTrigSample
-                            // this trigger is the closest one to the analogTrigSample location
-                            mTriggerIndex = pos;
-                        }
-                    }
-                }
-                break;
+            AnalogLevelSearch::Edge edge = AnalogLevelSearch::RisingEdge;
+            if (signal->triggerState() == AnalogSignal::AnalogTriggerHighLow) {
+                edge = AnalogLevelSearch::FallingEdge;
+            }
 
-                // Rising edge
-            case AnalogSignal::AnalogTriggerLowHigh:
-                pos = locateAnalogLowHighTransition(s, lowLevel, highLevel, analogTrigSample-20);
-                if (pos != -1) {
-                    // found first possible trigger past the analogTrigSample location
-                    //qDebug("Found Low->High at %d, (+%d from %d)", pos, pos - analogTrigSample, analogTrigSample);
-                    mTriggerIndex = pos;
-                }
-                pos = locatePreviousAnalogLowHighTransition(s, lowLevel, highLevel, analogTrigSample+20);
-                if (pos != -1) {
-                    // found last trigger before the analogTrigSample location
-                    //qDebug("Found Low->High at %d, (%d from %d)", pos, pos - analogTrigSample, analogTrigSample);
-                    if (abs(pos-analogTrigSample) < 2*abs(mTriggerIndex-analogTrigSample)) { //*2 as we prefer to find the one prior to the analogTrigSample
-                        // this trigger is the closest one to the analogTrigSample location
-                        mTriggerIndex = pos;
-                    }
-                }
-                if (mTriggerIndex == 0) {
-                    // Could not find any trigger point after filtering. Try with the unfiltered search.
-                    pos = locateAnalogLowHighTransition(s, trigLevel, trigLevel, analogTrigSample-20);
-                    if (pos != -1) {
-                        // found first possible trigger past the analogTrigSample location
-                        //qDebug("Found unfiltered Low->High at %d, (+%d from %d)", pos, pos - analogTrigSample, analogTrigSample);
-                        mTriggerIndex = pos;
-                    }
-                    pos = locatePreviousAnalogLowHighTransition(s, trigLevel, trigLevel, analogTrigSample+20);
-                    if (pos != -1) {
-                        // found last trigger before the analogTrigSample location
-                        //qDebug("Found unfiltered Low->High at %d, (%d from %d)", pos, pos - analogTrigSample, analogTrigSample);
-                        if (abs(pos-analogTrigSample) < 2*abs(mTriggerIndex-analogTrigSample)) { //*2 as we prefer to find the one prior to the analogTrigSample
-                            // this trigger is the closest one to the analogTrigSample location
-                            mTriggerIndex = pos;
-                        }
-                    }
-                }
-                break;
+            // index of the trigger in the analog data
+            int trigIdx = locateAnalogTransition(*search, edge, lowLevel, highLevel, analogTrigSample);
+            if (trigIdx == 0) {
+                // Could not find any trigger point after filtering. Try with the unfiltered search.
+                trigIdx = locateAnalogTransition(*search, edge, trigLevel, trigLevel, analogTrigSample);
+            }
 
-                // Not a trigger
-            default:
-                break;
+            if (trigIdx != 0) {
+                // the trigger index is relative to the digital data
+                trigIdx += samplePointDiff;
+                mTriggerIndex = qMax(0, trigIdx);
             }
         }
 
@@ -1323,7 +948,16 @@ void LabToolCaptureDevice::convertAnalogInput(const quint8 *pData, quint32 size,
         }
 
         mAnalogSignals[id] = s;
-        mEndSampleIdx = s->size()-1;
+
+        if (mAnalogLevelSearches[id] != NULL) {
+            delete mAnalogLevelSearches[id];
+        }
+
+        mAnalogLevelSearches[id] = search;
+
+        // the capture ends with the last digital or analog sample,
+        // whichever comes last
+        mEndSampleIdx = qMax(mEndSampleIdx, (SampleIndex)(s->size()-1+samplePointDiff));
         //qDebug("A%d: %d samples", id, s->size());
     }
 }
@@ -1353,6 +987,7 @@ void LabToolCaptureDevice::start(int sampleRate)
     qDebug() << "LabToolCaptureDevice::start";
 
     mRunningCapture = true;
+    mDeviceComm->setAutoRearm(mContinuous);
     if (hasConfigChanged()) {
         qDebug("Configuration has changed and will be pushed to target");
         mDeviceComm->configureCapture(configSize(), configData());
@@ -1362,6 +997,22 @@ void LabToolCaptureDevice::start(int sampleRate)
     }
 }
 
+/*!
+    Turns \a continuous mode on or off. In continuous mode the
+    LabToolDeviceComm starts the next capture as soon as the signal data
+    of the previous one has been received, see
+    LabToolDeviceComm::setAutoRearm().
+*/
+void LabToolCaptureDevice::setContinuous(bool continuous)
+{
+    mContinuous = continuous;
+    mDroppedCaptures = 0;
+
+    if (!continuous && mDeviceComm != NULL) {
+        mDeviceComm->setAutoRearm(false);
+    }
+}
+
 void LabToolCaptureDevice::stop()
 {
     qDebug() << "LabToolCaptureDevice::stop";
@@ -1370,7 +1021,7 @@ void LabToolCaptureDevice::stop()
     mDeviceComm->stopCapture();
 }
 
-int LabToolCaptureDevice::lastSampleIndex()
+SampleIndex LabToolCaptureDevice::lastSampleIndex()
 {
     return mEndSampleIdx;
 }
@@ -1427,6 +1078,11 @@ void LabToolCaptureDevice::setAnalogData(int signalId, QVector<double> data)
             mAnalogSignals[signalId] = NULL;
         }
 
+        if (mAnalogLevelSearches[signalId] != NULL) {
+            delete mAnalogLevelSearches[signalId];
+            mAnalogLevelSearches[signalId] = NULL;
+        }
+
         if (data.size() > 0) {
             mEndSampleIdx = data.size()-1;
 
@@ -1443,17 +1099,17 @@ void LabToolCaptureDevice::clearSignalData()
     deleteSignals();
 }
 
-int LabToolCaptureDevice::digitalTriggerIndex()
+SampleIndex LabToolCaptureDevice::digitalTriggerIndex()
 {
     return mTriggerIndex;
 }
 
-void LabToolCaptureDevice::setDigitalTriggerIndex(int idx)
+void LabToolCaptureDevice::setDigitalTriggerIndex(SampleIndex idx)
 {
     mTriggerIndex = idx;
 }
 
-void LabToolCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+void LabToolCaptureDevice::digitalTransitions(int signalId, QVector<SampleIndex> &list)
 {
     if (signalId >= MaxDigitalSignals) return;
     if (mDigitalSignals[signalId] == NULL) return;
@@ -1463,7 +1119,7 @@ void LabToolCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
         // Deallocation:
         //   QList will be deallocated by the destructor
         //   as a part of deallocating mDigitalSignalTransitions
-        QList<int>* l = new QList<int>();
+        QVector<SampleIndex>* l = new QVector<SampleIndex>();
         CaptureDevice::digitalTransitions(signalId, *l);
         mDigitalSignalTransitions[signalId] = l;
     }
@@ -1471,6 +1127,22 @@ void LabToolCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
     list = *mDigitalSignalTransitions[signalId];
 }
 
+void LabToolCaptureDevice::analogLevelSearch(int signalId, AnalogLevelSearch &search)
+{
+    if (signalId >= MaxAnalogSignals) return;
+    if (mAnalogSignals[signalId] == NULL) return;
+
+    // Not in cache. Set up the block summaries
+    if (mAnalogLevelSearches[signalId] == NULL) {
+        // Deallocation:
+        //   Deleted by the destructor as a part of deallocating
+        //   mAnalogLevelSearches
+        mAnalogLevelSearches[signalId] = new AnalogLevelSearch(*mAnalogSignals[signalId]);
+    }
+
+    search = *mAnalogLevelSearches[signalId];
+}
+
 void LabToolCaptureDevice::reconfigure(int sampleRate)
 {
     // Ignore if there is no ongoing capture as the reconfiguration
@@ -1482,7 +1154,6 @@ void LabToolCaptureDevice::reconfigure(int sampleRate)
     if (mReconfigTimer == NULL) {
         // Deallocation: Destructor is responsible
         mReconfigTimer = new QTimer();
-        mReconfigTimer->setInterval(200);
         mReconfigTimer->setSingleShot(true);
         QObject::connect(mReconfigTimer, SIGNAL(timeout()), this, SLOT(handleReconfigurationTimer()));
     }
@@ -1491,11 +1162,26 @@ void LabToolCaptureDevice::reconfigure(int sampleRate)
         mRequestedSampleRate = sampleRate;
     }
 
-    // Start (or restart if already running) the timer to gather consecutive
-    // changes (e.g. a slider will create events continuously as long as the
-    // user moves it). This way we at least get only one event every 200ms
     mReconfigurationRequested = true;
-    mReconfigTimer->start();
+
+    // Consecutive changes (e.g. a slider will create events continuously as
+    // long as the user moves it) are gathered so that there is at most one
+    // restart every ReconfigureInterval ms. The first change is applied at
+    // once and the following ones when the interval has passed. An already
+    // running timer is not restarted as that would delay the change for as
+    // long as the user keeps moving the slider.
+    if (mReconfigTimer->isActive()) {
+        return;
+    }
+    qint64 elapsed = ReconfigureInterval;
+    if (mLastReconfiguration.isValid()) {
+        elapsed = mLastReconfiguration.elapsed();
+    }
+    if (elapsed >= ReconfigureInterval) {
+        handleReconfigurationTimer();
+    } else {
+        mReconfigTimer->start(ReconfigureInterval - (int)elapsed);
+    }
 }
 
 /*!
@@ -1513,6 +1199,10 @@ void LabToolCaptureDevice::setDeviceComm(LabToolDeviceComm* comm)
         mRunningCapture = false;
     }
     mDeviceComm = comm;
+
+    if (!mDiagnostics.isNull()) {
+        mDiagnostics->setComm(comm);
+    }
 }
 
 /*!
@@ -1543,7 +1233,14 @@ void LabToolCaptureDevice::deleteSignals()
             delete mAnalogSignalData[i];
             mAnalogSignalData[i] = NULL;
         }
+
+        if (mAnalogLevelSearches[i] != NULL) {
+            delete mAnalogLevelSearches[i];
+            mAnalogLevelSearches[i] = NULL;
+        }
     }
+
+    mAnalogTimeOffsets.clear();
 }
 
 /*!
@@ -1593,6 +1290,47 @@ void LabToolCaptureDevice::handleConfigurationFailure(const char *msg)
     emit captureFinished(false, msg);
 }
 
+/*!
+    A report that the LabTool Hardware has captured signal data. Takes all
+    completed captures queued by the LabToolDeviceComm and handles the
+    newest one with \ref handleReceivedSamples. Older captures are only
+    queued in continuous mode when the previous capture took too long to
+    show, and are dropped as they would be replaced at once anyway.
+*/
+void LabToolCaptureDevice::handleSamplesAvailable()
+{
+    LabToolCaptureResult r;
+    LabToolCaptureResult newest;
+    bool found = false;
+
+    if (mDeviceComm == NULL) {
+        return;
+    }
+
+    // Deallocation:
+    //   dropped transfers are deleted here, handleReceivedSamples takes
+    //   ownership of the newest one
+    while (mDeviceComm->takeCaptureResult(&r)) {
+        if (found) {
+            delete newest.transfer;
+            mDroppedCaptures++;
+        }
+        newest = r;
+        found = true;
+    }
+
+    if (found) {
+        Instrumentation::instance().beginCapture();
+        Instrumentation::instance().addTime("USB transfer", newest.transferTime);
+        if (newest.transferTime > 0) {
+            Instrumentation::instance().addValue("USB throughput (MB/s)", newest.size * 1000.0 / newest.transferTime);
+        }
+        Instrumentation::instance().addValue("Dropped captures", mDroppedCaptures);
+
+        handleReceivedSamples(newest.transfer, newest.size, newest.trigger, newest.digitalTrigSample, newest.analogTrigSample, newest.digitalChannelInfo, newest.analogChannelInfo);
+    }
+}
+
 /*!
     A report that the LabTool Hardware has successfully captured the requested
     signal data.
@@ -1612,12 +1350,17 @@ void LabToolCaptureDevice::handleReceivedSamples(LabToolDeviceTransfer* transfer
 
         mUsedSampleRate = mRequestedSampleRate;
         mTriggerIndex = 0;
+        mEndSampleIdx = 0;
         convertDigitalInput(transfer->data(), size-analogSize, digitalChannelInfo, trigger, digitalTrigSample, analogTrigSample);
         convertAnalogInput(transfer->data()+analogOffset, analogSize, analogChannelInfo, trigger, analogTrigSample, digitalTrigSample);
         qDebug() << "Got " << size << "bytes with samples";
         //qDebug() << "Digital trigger at " << digitalTrigSample << ", analog at " << analogTrigSample;
 
-        mRunningCapture = false;
+        // in continuous mode the next capture has already been started
+        mRunningCapture = mContinuous;
+        if (!mDiagnostics.isNull() && mDiagnostics->isVisible()) {
+            mDiagnostics->refresh();
+        }
         emit captureFinished(true, "");
     }
     delete transfer;
@@ -1631,11 +1374,19 @@ void LabToolCaptureDevice::handleReceivedSamples(LabToolDeviceTransfer* transfer
 void LabToolCaptureDevice::handleFailedCapture(const char *msg)
 {
     mRunningCapture = false;
+    mContinuous = false;
+    if (mDeviceComm != NULL) {
+        mDeviceComm->setAutoRearm(false);
+    }
+    if (!mDiagnostics.isNull() && mDiagnostics->isVisible()) {
+        mDiagnostics->refresh();
+    }
     emit captureFinished(false, msg);
 }
 
 /*!
-    Called by the reconfiguration timer. If a capture is still
+    Called by the reconfiguration timer, or directly from \ref reconfigure
+    when no reconfiguration has been made for a while. If a capture is still
     running and the configuration has changed then the capture
     will be stopped here and \ref handleStopped will start it
     again.
@@ -1654,6 +1405,7 @@ void LabToolCaptureDevice::handleReconfigurationTimer()
     // anymore.
     if (hasConfigChanged()) {
         qDebug("Reconfiguration timer causes stop");
+        mLastReconfiguration.start();
         mRunningCapture = false;
         mDeviceComm->stopCapture();
     } else {
@@ -1667,15 +1419,18 @@ void LabToolCaptureDevice::handleReconfigurationTimer()
     the -5..5 range into a integer value in the 0..4096 range suitable for
     comparisons with the analog sample data retrieved from the LabTool Hardware.
     The conversion is based on the calibration data from the hardware.
+    Returns 0 if the V/div setting of the signal isn't supported.
 */
 qint16 LabToolCaptureDevice::analog12BitTriggerLevel(const AnalogSignal *signal)
 {
     LabToolCalibrationData* calib = mDeviceComm->storedCalibrationData();
 
     int id = signal->id();
-    int voltsPerDivIndex = supportedVPerDiv().indexOf(signal->vPerDiv());
-    double a = calib->analogFactorA(id, voltsPerDivIndex);
-    double b = calib->analogFactorB(id, voltsPerDivIndex);
+    int vPerDivIdx = voltsPerDivIndex(signal);
+    if (vPerDivIdx == -1) return 0;
+
+    double a = calib->analogFactorA(id, vPerDivIdx);
+    double b = calib->analogFactorB(id, vPerDivIdx);
 
     // Convert trigger level in volts to the 0..4096 range used by the hardware
 
@@ -1891,10 +1646,9 @@ void LabToolCaptureDevice::updateAnalogConfigData()
         }
 
         // Specify volt per div
-        double vdiv = signal->vPerDiv();
-        int idx = supportedVPerDiv().indexOf(vdiv);
+        int idx = voltsPerDivIndex(signal);
         if (idx == -1) {
-            qCritical("Volts per div %f is not one of the supported values", vdiv);
+            qCritical("Volts per div %f is not one of the supported values", signal->vPerDiv());
             header->voltPerDiv |= 0xf<<(id*4);//TODO: Report error as this case is invalid
         } else {
             header->voltPerDiv |= (idx & 0xf)<<(id*4);
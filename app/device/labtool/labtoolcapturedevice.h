@@ -18,10 +18,13 @@
 
 #include <QObject>
 #include <QList>
+#include <QElapsedTimer>
+#include <QPointer>
 
 #include "device/capturedevice.h"
 #include "labtooldevicecomm.h"
 #include "uilabtooltriggerconfig.h"
+#include "uilabtooldiagnostics.h"
 
 class LabToolCaptureDevice : public CaptureDevice
 {
@@ -35,13 +38,16 @@ public:
     int maxNumAnalogSignals();
     QList<double> supportedVPerDiv();
     bool supportsContinuousCapture() {return true;}
+    bool supportsPipelinedCapture() {return true;}
+    void setContinuous(bool continuous);
 
     void configureTrigger(QWidget* parent);
     void calibrate(QWidget* parent);
+    void showDiagnostics(QWidget* parent);
     void start(int sampleRate);
     void stop();
 
-    int lastSampleIndex();
+    SampleIndex lastSampleIndex();
     QVector<int>* digitalData(int signalId);
     void setDigitalData(int signalId, QVector<int> data);
     QVector<double>* analogData(int signalId);
@@ -49,9 +55,10 @@ public:
 
     void clearSignalData();
 
-    int digitalTriggerIndex();
-    void setDigitalTriggerIndex(int idx);
-    void digitalTransitions(int signalId, QList<int> &list);
+    SampleIndex digitalTriggerIndex();
+    void setDigitalTriggerIndex(SampleIndex idx);
+    void digitalTransitions(int signalId, QVector<SampleIndex> &list);
+    void analogLevelSearch(int signalId, AnalogLevelSearch &search);
 
     void reconfigure(int sampleRate = -1);
 
@@ -63,7 +70,7 @@ private slots:
     void handleStopped();
     void handleConfigurationDone();
     void handleConfigurationFailure(const char* msg);
-    void handleReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int digitalChannelInfo, unsigned int analogChannelInfo);
+    void handleSamplesAvailable();
     void handleFailedCapture(const char* msg);
     void handleReconfigurationTimer();
 
@@ -71,17 +78,21 @@ private:
 
     enum Constants {
         MaxDigitalSignals = 11,
-        MaxAnalogSignals = 2
+        MaxAnalogSignals = 2,
+        ReconfigureInterval = 200
     };
 
     UiLabToolTriggerConfig* mTriggerConfig;
+    QPointer<UiLabToolDiagnostics> mDiagnostics;
     LabToolDeviceComm*  mDeviceComm;
 
-    int mEndSampleIdx;
-    int mTriggerIndex;
+    SampleIndex mEndSampleIdx;
+    SampleIndex mTriggerIndex;
     int mRequestedSampleRate;
     bool mConfigMustBeUpdated;
     bool mRunningCapture;
+    bool mContinuous;
+    int mDroppedCaptures;
     bool mReconfigurationRequested;
     bool mWarnUncalibrated;
     quint8* mData;
@@ -92,21 +103,23 @@ private:
     QVector<int>* mDigitalSignals[MaxDigitalSignals];
     QVector<double>* mAnalogSignals[MaxAnalogSignals];
     QVector<quint16>* mAnalogSignalData[MaxAnalogSignals];
-    QList<int>* mDigitalSignalTransitions[MaxDigitalSignals];
+    QVector<SampleIndex>* mDigitalSignalTransitions[MaxDigitalSignals];
+    AnalogLevelSearch* mAnalogLevelSearches[MaxAnalogSignals];
 
     QList<double> mSupportedVPerDiv;
 
     QTimer* mReconfigTimer;
+    QElapsedTimer mLastReconfiguration;
+
+    int voltsPerDivIndex(const AnalogSignal* signal) const;
 
     int locateFirstLevel(QVector<int> *s, int level, int offset);
     int locatePreviousLevel(QVector<int> *s, int level, int offset);
 
-    int locateAnalogHighLowTransition(QVector<double> *s, double lowLevel, double highLevel, int offset);
-    int locatePreviousAnalogHighLowTransition(QVector<double> *s, double lowLevel, double highLevel, int offset);
-    int locateAnalogLowHighTransition(QVector<double> *s, double lowLevel, double highLevel, int offset);
-    int locatePreviousAnalogLowHighTransition(QVector<double> *s, double lowLevel, double highLevel, int offset);
+    int locateAnalogTransition(const AnalogLevelSearch &search, AnalogLevelSearch::Edge edge, double lowLevel, double highLevel, int analogTrigSample);
 
     bool detectAnalogSignalFrequency(int id, quint16 trigLevel, bool fallingEdge);
+    void handleReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int digitalChannelInfo, unsigned int analogChannelInfo);
     void convertDigitalInput(const quint8* pData, quint32 size, quint32 activeChannels, quint32 trig, int digitalTrigSample, int analogTrigSample);
     void unpackAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels);
     void convertHiddenAnalogInput(const quint8 *pData, quint32 size);
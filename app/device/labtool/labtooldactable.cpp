@@ -0,0 +1,196 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtooldactable.h"
+
+#include <qmath.h>
+
+/*!
+    \class LabToolDacTable
+    \brief Builds the lookup tables used by the analog outputs of the LabTool Hardware.
+
+    \ingroup Device
+
+    The LabToolDacTable class calculates the values that the LabTool Hardware
+    writes to the DAC for one period of an analog waveform. The tables are
+    calibrated and packed on the host and then sent as part of the generator
+    configuration, so that the hardware only has to copy them.
+
+    All functions are static and have no dependencies on the hardware or the
+    user interface.
+*/
+
+/*!
+    Returns the number of entries to use in the lookup table for a signal
+    with the given \a frequency when \a numChannels analog outputs are in use.
+
+    The DAC update rate is shared between the outputs, so the largest table
+    that can still be played back at \a frequency is used. The result is
+    limited to the MinTableSize..MaxTableSize range.
+*/
+int LabToolDacTable::tableSize(int frequency, int numChannels)
+{
+    if (frequency <= 0) {
+        return MaxTableSize;
+    }
+    if (numChannels < 1) {
+        numChannels = 1;
+    }
+
+    int size = (MaxDacRate / numChannels) / frequency;
+
+    if (size > MaxTableSize) {
+        size = MaxTableSize;
+    }
+    if (size < MinTableSize) {
+        size = MinTableSize;
+    }
+
+    return size;
+}
+
+/*!
+    Returns \a size output levels (in Volts) for one period of the waveform
+    \a form with the given \a amplitude.
+
+    For AnalogSignal::WaveformArbitrary the normalized \a shape (-1..1) is
+    resampled to \a size points and scaled by \a amplitude. The \a shape
+    is ignored for all other waveforms.
+
+    The built-in waveforms use the same formulas as the firmware so that
+    the generated signal does not change when the table is built on the host.
+*/
+QVector<double> LabToolDacTable::waveformLevels(AnalogSignal::AnalogWaveform form,
+                                                double amplitude,
+                                                const QVector<double> &shape,
+                                                int size)
+{
+    QVector<double> levels;
+
+    if (size <= 0) {
+        return levels;
+    }
+
+    levels.resize(size);
+
+    switch (form) {
+    case AnalogSignal::WaveformSine:
+        for (int i = 0; i < size; i++) {
+            levels[i] = amplitude * qSin((2 * M_PI * i) / size);
+        }
+        break;
+
+    case AnalogSignal::WaveformSquare:
+        for (int i = 0; i < size; i++) {
+            levels[i] = (i < size/2) ? amplitude : -amplitude;
+        }
+        break;
+
+    case AnalogSignal::WaveformTriangle:
+        // x(t) = ABS( 2 * (t - FLOOR( t + 1/2 )) ), moved from 0..1 to -1..1
+        for (int i = 0; i < size; i++) {
+            double t = i / (double)size;
+            double x = qAbs(2 * (t - qFloor(t + 0.5)));
+            levels[i] = (x - 0.5) * 2 * amplitude;
+        }
+        break;
+
+    case AnalogSignal::WaveformArbitrary:
+        levels = resample(shape, size);
+        for (int i = 0; i < levels.size(); i++) {
+            levels[i] *= amplitude;
+        }
+        break;
+
+    default:
+        levels.clear();
+        break;
+    }
+
+    return levels;
+}
+
+/*!
+    Returns \a samples linearly resampled to \a size points. The \a samples
+    are treated as one full period so the last returned point is located
+    just before the start of the next period.
+*/
+QVector<double> LabToolDacTable::resample(const QVector<double> &samples, int size)
+{
+    QVector<double> out;
+
+    if (samples.isEmpty() || size <= 0) {
+        return out;
+    }
+
+    out.resize(size);
+
+    int n = samples.size();
+    for (int i = 0; i < size; i++) {
+        double pos = (i * (double)n) / size;
+        int idx = (int)pos;
+        double frac = pos - idx;
+        int next = (idx + 1 < n) ? idx + 1 : 0; // wrap to start of period
+
+        out[i] = samples.at(idx) + frac * (samples.at(next) - samples.at(idx));
+    }
+
+    return out;
+}
+
+/*!
+    Returns the value to send to the DAC to get \a volts on the analog
+    output \a channel. The calibration factors \a a and \a b comes from
+    LabToolCalibrationData::analogOutFactorA() and
+    LabToolCalibrationData::analogOutFactorB().
+
+    The 10-bit DAC value is clamped to the valid range and packed the same
+    way as the SPI_DAC_VALUE macro in the firmware.
+*/
+quint16 LabToolDacTable::pack(int channel, double volts, double a, double b)
+{
+    // Vout = A + B * hex  => hex = (Vout - A) / B
+    int val = 0;
+    if (b != 0) {
+        val = qRound((volts - a) / b);
+    }
+
+    if (val < 0) {
+        val = 0;
+    }
+    if (val > MaxDacValue) {
+        val = MaxDacValue;
+    }
+
+    // move the 10 value bits into the upper 10-bits of a 12-bit value
+    val = val << 2;
+
+    return ((channel & 1) << 14) | (1 << 12) | (val & 0xffc);
+}
+
+/*!
+    Packs all \a levels for the analog output \a channel and appends them
+    to \a out.
+
+    \sa pack()
+*/
+void LabToolDacTable::pack(int channel, const QVector<double> &levels,
+                           double a, double b, QVector<quint16> &out)
+{
+    out.reserve(out.size() + levels.size());
+    for (int i = 0; i < levels.size(); i++) {
+        out.append(pack(channel, levels.at(i), a, b));
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLDACTABLE_H
+#define LABTOOLDACTABLE_H
+
+#include <QVector>
+
+#include "device/analogsignal.h"
+
+class LabToolDacTable
+{
+public:
+
+    enum Constants {
+        MaxTableSize = 2000,   // GEN_DAC_MAX_LUT_SIZE in the firmware
+        MinTableSize = 2,
+        MaxDacRate   = 300000, // MAX_DAC_FREQ in the firmware
+        MaxDacValue  = 1023    // 10-bit DAC
+    };
+
+    static int tableSize(int frequency, int numChannels);
+
+    static QVector<double> waveformLevels(AnalogSignal::AnalogWaveform form,
+                                          double amplitude,
+                                          const QVector<double> &shape,
+                                          int size);
+    static QVector<double> resample(const QVector<double> &samples, int size);
+
+    static quint16 pack(int channel, double volts, double a, double b);
+    static void pack(int channel, const QVector<double> &levels,
+                     double a, double b, QVector<quint16> &out);
+
+private:
+    LabToolDacTable() {}
+};
+
+#endif // LABTOOLDACTABLE_H
@@ -15,18 +15,8 @@
  */
 #include "labtooldevicecomm.h"
 
+#include "common/atomichelper.h"
 
-/*!
-    The Vendor Identifier (VID) of the LabTool Hardware
-    Used when detecting if the hardware is connected to the computer or not.
-*/
-#define VENDORID                0x1fc9
-
-/*!
-    The Product Identifier (PID) of the LabTool Hardware.
-    Used when detecting if the hardware is connected to the computer or not.
-*/
-#define PRODUCTID               0x0018
 
 /*!
     The number of the USB interface to use on the LabTool Hardware. As the hardware
@@ -44,7 +34,8 @@ typedef enum
   REQ_Ping               = 2, /*!< Ping to indicate active line */
   REQ_StopCapture        = 3, /*!< Request to stop ongoing signal capture */
   REQ_StopGenerator      = 4, /*!< Request to stop ongoing signal generation */
-  REQ_GetStoredCalibData = 5  /*!< Request for the ongoing calibration's data */
+  REQ_GetStoredCalibData = 5, /*!< Request for the ongoing calibration's data */
+  REQ_GetTelemetry       = 6  /*!< Request for the performance counters */
 } control_requests_t;
 
 
@@ -52,7 +43,7 @@ typedef enum
  * This is the header for the data containing the captured samples.
  *
  * This information will be saved until after the response to CMD_CAP_DATA_ONLY has been
- * received at which time it will be used to fill the \ref captureReceivedSamples signal.
+ * received at which time it will be used to fill the \ref LabToolCaptureResult.
  *
  * \private
  */
@@ -145,7 +136,7 @@ void LIBUSB_CALL CallbackForSend(struct libusb_transfer* transfer)
         } else {
             ddt->setupForResponse(ddt->deviceComm()->inEndpoint(), CallbackForResponse, 2000);
         }
-        int ret = libusb_submit_transfer(ddt->transfer());
+        int ret = ddt->deviceComm()->submitTransfer(ddt);
         if (ret != LIBUSB_SUCCESS) {
             ddt->deviceComm()->transferFailed(ddt, ret);
         }
@@ -154,6 +145,28 @@ void LIBUSB_CALL CallbackForSend(struct libusb_transfer* transfer)
     }
 }
 
+/*!
+    A callback used for the asynchronous control requests to the LabTool
+    Hardware. This callback is only used for the REQ_GetTelemetry request.
+
+    The \a transfer parameter is checked and acts according to the result:
+    - Calls \ref transferSuccess if the transfer was completed
+    - Calls \ref transferFailed if the transfer failed (e.g. was stalled)
+
+    This function cannot be a part of the LabToolDeviceComm class as the
+    libusbx requires function pointer and that cannot (simply at least)
+    be created from class instances.
+*/
+void LIBUSB_CALL CallbackForControl(struct libusb_transfer* transfer)
+{
+    LabToolDeviceTransfer* ddt = ((LabToolDeviceTransfer*)transfer->user_data);
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+        ddt->deviceComm()->transferSuccess(ddt);
+    } else {
+        ddt->deviceComm()->transferFailed(ddt);
+    }
+}
+
 
 /*!
     \class LabToolDeviceComm
@@ -165,7 +178,9 @@ void LIBUSB_CALL CallbackForSend(struct libusb_transfer* transfer)
     with the LabTool Hardware.
 
     The communication with LabTool Hardware is based on USB and uses
-    the libusbx library (see http://libusbx.sourceforge.net/).
+    the libusbx library (see http://libusbx.sourceforge.net/). All calls
+    to libusbx go through a LabToolTransport, which can also be a virtual
+    device (see LabToolVirtualTransport) when there is no hardware.
 
     This application is the USB host and the LabTool Hardware is the
     device. All communication is initiated from the host.
@@ -184,6 +199,7 @@ void LIBUSB_CALL CallbackForSend(struct libusb_transfer* transfer)
     REQ_Ping          | Control Request | See if the hardware is alive
     REQ_StopCapture   | Control Request | Abort signal generation
     REQ_StopGenerator | Control Request | Stop signal generation
+    REQ_GetTelemetry  | Control Request | Read the performance counters
 
     The Async Transfer type is as the name suggests an asynchronous request
     meaning that it can be aborted. The reason for using the asynchronous
@@ -196,39 +212,52 @@ void LIBUSB_CALL CallbackForSend(struct libusb_transfer* transfer)
     The Control Request type is for very short requests and runs in parallel
     with the Async transfer. The Control Request is used to stop the ongoing
     activity on the LabTool Hardware as that only requires setting a flag.
+    REQ_GetTelemetry is also a Control Request but it is submitted
+    asynchronously, like the Async Transfers, as it is sent after every
+    capture while the diagnostics dialog is open.
 */
 
 /*!
-    Constructs a communication instance with the given \a parent.
+    Constructs a communication instance with the given \a parent. All
+    communication goes through the \a transport which is owned by this
+    instance from now on.
 */
-LabToolDeviceComm::LabToolDeviceComm(QObject *parent) :
-    QObject(parent)
+LabToolDeviceComm::LabToolDeviceComm(LabToolTransport *transport, QObject *parent) :
+    QObject(parent),
+    mRearmMutex(QMutex::Recursive)
 {
-    this->mContext = NULL;
-    this->mDeviceHandle = NULL;
+    this->mTransport = transport;
     this->mRunningTransfer = NULL;
     this->mConnected = false;
     this->mActiveCalibrationData = NULL;
+    this->mCaptureResultsSignalled = 0;
+    this->mPendingCaptures = 0;
+    this->mAutoRearm = false;
+    this->mRearmPaused = false;
+    this->mHasTelemetry = false;
 }
 
 /*!
     Disconnects from the LabTool Hardware and closes down
-    the USB library.
+    the transport.
 */
 LabToolDeviceComm::~LabToolDeviceComm()
 {
+    LabToolCaptureResult result;
+
     disconnectFromDevice();
-    if (this->mContext != NULL)
-    {
-        libusb_exit(this->mContext);
-        this->mContext = NULL;
+    delete mTransport;
+
+    // Deallocation:
+    //   Results that were never taken still own their transfers
+    while (mCaptureResults.pop(&result)) {
+        delete result.transfer;
     }
 }
 
 /*!
-    Attempts to connect to a LabTool Hardware through the libusbx
-    library. The \a quiet parameter controls how much is printed in
-    the log.
+    Attempts to connect to a LabTool Hardware through the transport.
+    The \a quiet parameter controls how much is printed in the log.
     Returns true if the connection was made or if alreay connected.
 */
 bool LabToolDeviceComm::connectToDevice(bool quiet)
@@ -238,41 +267,11 @@ bool LabToolDeviceComm::connectToDevice(bool quiet)
         return true;
     }
 
-    if (!quiet)
-    {
-        const struct libusb_version* version = libusb_get_version();
-        qDebug("Using libusbx v%d.%d.%d.%d", version->major, version->minor, version->micro, version->nano);
-        qDebug("Initializing library...");
-    }
-
-    int r = libusb_init(&this->mContext);
-    if (r != LIBUSB_SUCCESS)
+    if (!mTransport->open(quiet))
     {
-        qDebug("Failed to initialize libusb, got error %s", libusb_error_name(r));
         return false;
     }
 
-    this->mDeviceHandle = libusb_open_device_with_vid_pid(NULL, VENDORID, PRODUCTID);
-    if (this->mDeviceHandle == NULL) {
-        if (!quiet)
-        {
-            qDebug("Failed to open device %04X:%04X", VENDORID, PRODUCTID);
-        }
-        return false;
-    }
-
-    int ret = libusb_claim_interface(this->mDeviceHandle, INTERFACENUM);
-    if (ret != LIBUSB_SUCCESS) {
-        if (!quiet)
-        {
-            qDebug("Failed to claim device %04X:%04X, got error %s", VENDORID, PRODUCTID, libusb_error_name(ret));
-        }
-        libusb_close(this->mDeviceHandle);
-        this->mDeviceHandle = NULL;
-        return false;
-    }
-
-    qDebug("Opened device %04X:%04X", VENDORID, PRODUCTID);
     mConnected = true;
 
     probe();
@@ -281,8 +280,8 @@ bool LabToolDeviceComm::connectToDevice(bool quiet)
 }
 
 /*!
-    Disconnects from the LabTool Hardware by closing the USB
-    connection. The libusbx remains initialized.
+    Disconnects from the LabTool Hardware by closing the
+    transport.
 */
 void LabToolDeviceComm::disconnectFromDevice()
 {
@@ -291,23 +290,131 @@ void LabToolDeviceComm::disconnectFromDevice()
         return;
     }
     mConnected = false;
-    if (mDeviceHandle != NULL)
-    {
-        /* make sure other programs can still access this device */
-        /* release the interface and close the device */
-        //qDebug("Releasing interface %d...", INTERFACENUM);
-        libusb_release_interface(mDeviceHandle, INTERFACENUM);
-        qDebug("Closing device...");
-        libusb_close(mDeviceHandle);
-        mDeviceHandle = NULL;
-    }
-    this->mRunningTransfer = NULL;
+    mTransport->close();
+    clearRunningTransfer(NULL);
     if (this->mActiveCalibrationData != NULL) {
         delete this->mActiveCalibrationData;
         this->mActiveCalibrationData = NULL;
     }
 }
 
+/*!
+    Submits the asynchronous \a transfer through the transport.
+    Returns LIBUSB_SUCCESS or a libusbx error code.
+*/
+int LabToolDeviceComm::submitTransfer(LabToolDeviceTransfer *transfer)
+{
+    return mTransport->submitTransfer(transfer->transfer());
+}
+
+/*!
+    Lets the transport complete transfers, waiting at most \a timeout
+    milliseconds. See LabToolTransport::handleEvents().
+*/
+int LabToolDeviceComm::handleEvents(int timeout)
+{
+    return mTransport->handleEvents(timeout);
+}
+
+/*!
+    Ends an ongoing \ref handleEvents call, if any, without waiting for
+    its timeout. Can be called from any thread.
+*/
+void LabToolDeviceComm::wakeUp()
+{
+    mTransport->wakeUp();
+}
+
+/*!
+    Takes the oldest completed capture from the queue and stores it in
+    \a result. Returns false if there are no more captures. The caller
+    becomes the owner of the result's transfer.
+
+    Must only be called from one thread, normally as a response to the
+    \ref captureSamplesAvailable signal.
+*/
+bool LabToolDeviceComm::takeCaptureResult(LabToolCaptureResult *result)
+{
+    bool taken = mCaptureResults.pop(result);
+
+    if (!taken) {
+        // The queue is empty so a new signal is needed for the next result. A
+        // result pushed before the flag was cleared would not get a signal so
+        // look once more.
+        mCaptureResultsSignalled.fetchAndStoreOrdered(0);
+        taken = mCaptureResults.pop(result);
+    }
+
+    if (taken) {
+        mPendingCaptures.deref();
+
+        // there is room for another capture if the re-arming was paused
+        rearmCapture(true);
+    }
+
+    return taken;
+}
+
+/*!
+    Lets the communication thread start a new capture as soon as the data
+    of the previous one has been received if \a enable is true. This is
+    used in continuous mode so that the LabTool Hardware captures the next
+    signal data while the host handles the previous one.
+
+    The re-arming pauses while MaxPendingCaptures captures are waiting to be
+    taken with \ref takeCaptureResult and continues when one has been
+    taken, so a slow host makes the hardware wait instead of filling the
+    queue. \ref stopCapture turns the re-arming off.
+*/
+void LabToolDeviceComm::setAutoRearm(bool enable)
+{
+    QMutexLocker locker(&mRearmMutex);
+    mAutoRearm = enable;
+    mRearmPaused = false;
+}
+
+/*!
+    Starts a new capture if re-arming is enabled and not too many captures
+    are waiting, otherwise pauses the re-arming. If \a onlyIfPaused is true
+    nothing is done unless the re-arming has been paused.
+
+    The lock makes sure that no capture is started after \ref setAutoRearm
+    has turned the re-arming off, as that is followed by \ref stopCapture
+    which can only cancel a capture that has already been started.
+*/
+void LabToolDeviceComm::rearmCapture(bool onlyIfPaused)
+{
+    QMutexLocker locker(&mRearmMutex);
+
+    if (!mAutoRearm || (onlyIfPaused && !mRearmPaused)) {
+        return;
+    }
+
+    if (AtomicHelper::load(mPendingCaptures) >= MaxPendingCaptures) {
+        mRearmPaused = true;
+        return;
+    }
+
+    mRearmPaused = false;
+    runCapture();
+}
+
+/*!
+    Forgets the running capture transfer if it is \a transfer, or
+    unconditionally if \a transfer is NULL. The transfer callbacks run in
+    the comm thread while \ref stopCapture runs in the GUI thread, so
+    mRunningTransfer is only accessed with mRearmMutex held.
+*/
+void LabToolDeviceComm::clearRunningTransfer(LabToolDeviceTransfer *transfer)
+{
+    QMutexLocker locker(&mRearmMutex);
+
+    if (transfer == NULL || mRunningTransfer == transfer)
+    {
+        mRunningTransfer = NULL;
+    }
+}
+
 /*!
     Sends a request to the LabTool Hardware to prepare it for the calibration process.
 
@@ -340,9 +447,9 @@ void LabToolDeviceComm::calibrateInit()
     }
 
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
-    ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAL_INIT, mEndpointOut, mDeviceHandle, CallbackForResponse, 2000);
+    ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAL_INIT, outEndpoint(), CallbackForResponse, 2000);
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -390,14 +497,13 @@ void LabToolDeviceComm::calibrateAnalogOut(quint32 level)
 
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAL_ANALOG_OUT,
-                         mEndpointOut,
-                         mDeviceHandle,
+                         outEndpoint(),
                          CallbackForSend,
                          2000,
                          sizeof(data),
                          (unsigned char*)data);
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -448,14 +554,13 @@ void LabToolDeviceComm::calibrateAnalogIn(double a0[], double a1[], int levels[]
 
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAL_ANALOG_IN,
-                         mEndpointOut,
-                         mDeviceHandle,
+                         outEndpoint(),
                          CallbackForSend,
                          2000,
                          sizeof(data),
                          (unsigned char*)data);
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -493,14 +598,13 @@ void LabToolDeviceComm::calibrationSaveData(LabToolCalibrationData *data)
 {
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAL_STORE,
-                         mEndpointOut,
-                         mDeviceHandle,
+                         outEndpoint(),
                          CallbackForSend,
                          2000,
                          LabToolCalibrationData::rawDataByteSize(),
                          data->rawCalibrationData());
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -538,12 +642,11 @@ void LabToolDeviceComm::calibrationRestoreDefaults()
 {
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAL_ERASE,
-                         mEndpointOut,
-                         mDeviceHandle,
+                         outEndpoint(),
                          CallbackForSend,
                          2000);
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -581,12 +684,11 @@ void LabToolDeviceComm::calibrationEnd()
 {
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAL_END,
-                         mEndpointOut,
-                         mDeviceHandle,
+                         outEndpoint(),
                          CallbackForSend,
                          2000);
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -609,7 +711,7 @@ LabToolCalibrationData *LabToolDeviceComm::storedCalibrationData(bool forceReloa
         // Load calibration information
         int size = LabToolCalibrationData::rawDataByteSize();
         unsigned char buff[size];
-        int r = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+        int r = mTransport->controlTransfer(LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
                 REQ_GetStoredCalibData, 0, INTERFACENUM, buff, size, 1000);
         if (r == size) {
             if (this->mActiveCalibrationData != NULL) {
@@ -625,10 +727,51 @@ LabToolCalibrationData *LabToolDeviceComm::storedCalibrationData(bool forceReloa
 }
 
 /*!
-    \fn libusb_context* LabToolDeviceComm::usbContext()
+    Sends a request to the LabTool Hardware for the performance counters.
+    The counters describe the last capture, including the transfer of the
+    samples, and can be used to find out if a failed capture was limited by
+    the interrupt handlers, the DMA or the USB transfer.
+
+    The request is a Control Request but, unlike the others, it is sent
+    asynchronously so that it is answered in the communication thread. A
+    \ref telemetryReceived signal is sent when the answer has arrived and
+    the counters can then be read with \ref telemetry.
+*/
+int LabToolDeviceComm::requestTelemetry()
+{
+    if (!mConnected) {
+        return -1;
+    }
 
-    Returns the current libusbx context.
+    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+    ddt->setupForControlRequest(LabToolDeviceTransfer::CMD_GET_TELEMETRY,
+                                REQ_GetTelemetry,
+                                INTERFACENUM,
+                                CallbackForControl,
+                                1000,
+                                MaxTelemetrySize);
+
+    int ret = submitTransfer(ddt);
+    if (ret != LIBUSB_SUCCESS) {
+        transferFailed(ddt, ret);
+    }
+
+    return ret;
+}
+
+/*!
+    Copies the last counters received after a call to \ref requestTelemetry
+    into \a telemetry. Returns false if no counters have been received.
 */
+bool LabToolDeviceComm::telemetry(LabToolTelemetry *telemetry)
+{
+    QMutexLocker locker(&mTelemetryMutex);
+    if (!mHasTelemetry) {
+        return false;
+    }
+    *telemetry = mTelemetry;
+    return true;
+}
 
 /*!
     \fn quint8 LabToolDeviceComm::inEndpoint()
@@ -662,15 +805,12 @@ LabToolCalibrationData *LabToolDeviceComm::storedCalibrationData(bool forceReloa
 */
 
 /*!
-    \fn void LabToolDeviceComm::captureReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int activeDigital, unsigned int activeAnalog)
-
-    Sent to notify that captured signal data has been received.
-    The \a transfer parameter holds the data, \a size is the size of the data (in bytes),
-    \a trigger is information about what caused the trigger, \a digitalTrigSample is the
-    digital sample at the time of the trigger, \a analogTrigSample is the analog sample
-    at the time of the trigger, \a activeDigital is
-    information about what the digital signal data contains, \a activeAnalog is
-    information about what the analog signal data contains.
+    \fn void LabToolDeviceComm::captureSamplesAvailable()
+
+    Sent to notify that captured signal data has been received and can be
+    collected with \ref takeCaptureResult. The signal is only sent when the
+    queue goes from empty to not empty, so the receiver must take all
+    results each time.
 */
 
 /*!
@@ -726,6 +866,13 @@ LabToolCalibrationData *LabToolDeviceComm::storedCalibrationData(bool forceReloa
     The \a msg parameter contains an error description.
 */
 
+/*!
+    \fn void LabToolDeviceComm::telemetryReceived(bool ok)
+
+    Sent to notify that the answer to \ref requestTelemetry has arrived. The
+    \a ok parameter is false if the counters could not be read.
+*/
+
 /*!
     \fn void LabToolDeviceComm::calibrationSuccess(LabToolCalibrationData* data)
 
@@ -737,7 +884,8 @@ LabToolCalibrationData *LabToolDeviceComm::storedCalibrationData(bool forceReloa
 
 /*!
     Retrieves various pieces of information from the connected LabTool Hardware
-    and writes it to the log.
+    and writes it to the log. The USB descriptors are logged by the
+    LabToolUsbTransport when opening the device.
 
     This purpose of this function is to show some ways of getting device information.
     It can easily be extended to gather more informaion in the future. Perhaps
@@ -746,131 +894,16 @@ LabToolCalibrationData *LabToolDeviceComm::storedCalibrationData(bool forceReloa
 void LabToolDeviceComm::probe()
 {
     static bool alreadyProbed = false; // prevents printing everyting everytime
-    libusb_device *dev;
-    struct libusb_config_descriptor *conf_desc;
-    const struct libusb_endpoint_descriptor *endpoint;
-    const struct libusb_interface_descriptor *altsetting;
-    int i, j, k, r;
-    int nb_ifaces;
-    uint8_t string_index[3];         // indexes of the string descriptors
-    mEndpointIn = mEndpointOut = 0;  // default IN and OUT endpoints
+    int r;
 
     if (!mConnected) {
         return;
     }
 
-    dev = libusb_get_device(this->mDeviceHandle);
-    if (!alreadyProbed) {
-        uint8_t bus, port_path[8];
-        struct libusb_device_descriptor dev_desc;
-        const char* speed_name[5] = { "Unknown", "1.5 Mbit/s (USB LowSpeed)", "12 Mbit/s (USB FullSpeed)",
-            "480 Mbit/s (USB HighSpeed)", "5000 Mbit/s (USB SuperSpeed)"};
-
-        bus = libusb_get_bus_number(dev);
-        r = libusb_get_port_path(NULL, dev, port_path, sizeof(port_path));
-        if (r > 0) {
-            qDebug("[Probe] bus: %d, port path from HCD: %d", bus, port_path[0]);
-            for (i=1; i<r; i++) {
-                qDebug("->%d", port_path[i]);
-            }
-        }
-        r = libusb_get_device_speed(dev);
-        if ((r<0) || (r>4)) r=0;
-        qDebug("[Probe] speed: %s", speed_name[r]);
-
-        qDebug("\n[Probe] Reading device descriptor:");
-        r = libusb_get_device_descriptor(dev, &dev_desc);
-        if (r != LIBUSB_SUCCESS) {
-            qCritical("Failed to get device descriptor, got error %s", libusb_error_name(r));
-            return;
-        }
-        qDebug("[Probe]             length: %d", dev_desc.bLength);
-        qDebug("[Probe]       device class: %d", dev_desc.bDeviceClass);
-        qDebug("[Probe]                S/N: %d", dev_desc.iSerialNumber);
-        qDebug("[Probe]            VID:PID: %04X:%04X", dev_desc.idVendor, dev_desc.idProduct);
-        qDebug("[Probe]          bcdDevice: %04X", dev_desc.bcdDevice);
-        qDebug("[Probe]    iMan:iProd:iSer: %d:%d:%d", dev_desc.iManufacturer, dev_desc.iProduct, dev_desc.iSerialNumber);
-        qDebug("[Probe]           nb confs: %d", dev_desc.bNumConfigurations);
-
-        // Copy the string descriptors for easier parsing
-        string_index[0] = dev_desc.iManufacturer;
-        string_index[1] = dev_desc.iProduct;
-        string_index[2] = dev_desc.iSerialNumber;
-
-        qDebug("\n[Probe] Reading configuration descriptors:");
-    }
-
-    r = libusb_get_config_descriptor(dev, 0, &conf_desc);
-    if (r != LIBUSB_SUCCESS) {
-        qCritical("[Probe] Failed to get device descriptor, got error %s", libusb_error_name(r));
-        return;
-    }
-    nb_ifaces = conf_desc->bNumInterfaces;
-    if (!alreadyProbed) {
-        qDebug("[Probe]              nb interfaces: %d", nb_ifaces);
-    }
-    for (i=0; i<nb_ifaces; i++) {
-        if (!alreadyProbed) {
-            qDebug("[Probe]               interface[%d]: id = %d", i,
-                conf_desc->interface[i].altsetting[0].bInterfaceNumber);
-        }
-        for (j=0; j<conf_desc->interface[i].num_altsetting; j++) {
-            altsetting = &conf_desc->interface[i].altsetting[j];
-            if (!alreadyProbed) {
-                qDebug("[Probe] interface[%d].altsetting[%d]: num endpoints = %d",
-                    i, j, altsetting->bNumEndpoints);
-                qDebug("[Probe]    Class.SubClass.Protocol: %02X.%02X.%02X",
-                    altsetting->bInterfaceClass,
-                    altsetting->bInterfaceSubClass,
-                    altsetting->bInterfaceProtocol);
-            }
-            for (k=0; k<altsetting->bNumEndpoints; k++) {
-                endpoint = &altsetting->endpoint[k];
-                if (!alreadyProbed) {
-                    qDebug("[Probe]        endpoint[%d].address: %02X", k, endpoint->bEndpointAddress);
-                }
-
-                // Use the first interrupt or bulk IN/OUT endpoints as default for testing
-                if ((endpoint->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) & (LIBUSB_TRANSFER_TYPE_BULK | LIBUSB_TRANSFER_TYPE_INTERRUPT)) {
-                    if (endpoint->bEndpointAddress & LIBUSB_ENDPOINT_IN) {
-                        if (!mEndpointIn) {
-                            mEndpointIn = endpoint->bEndpointAddress;
-                        }
-                    } else {
-                        if (!mEndpointOut) {
-                            mEndpointOut = endpoint->bEndpointAddress;
-                        }
-                    }
-                }
-                if (!alreadyProbed) {
-                    qDebug("[Probe]            max packet size: %04X", endpoint->wMaxPacketSize);
-                    qDebug("[Probe]           polling interval: %02X", endpoint->bInterval);
-                }
-            }
-        }
-    }
-    libusb_free_config_descriptor(conf_desc);
-
     if (!alreadyProbed) {
-        char string[128];
-        qDebug("\n[Probe] Reading string descriptors:");
-        for (i=0; i<3; i++) {
-            if (string_index[i] == 0) {
-                continue;
-            }
-            if (libusb_get_string_descriptor_ascii(this->mDeviceHandle, string_index[i], (unsigned char*)string, 128) >= 0) {
-                qDebug("[Probe]    String (0x%02X): \"%s\"", string_index[i], string);
-            }
-        }
-        // Read the OS String Descriptor
-        if (libusb_get_string_descriptor_ascii(this->mDeviceHandle, 0xEE, (unsigned char*)string, 128) >= 0) {
-            qDebug("[Probe]    String (0x%02X): \"%s\"", 0xEE, string);
-        }
-
-
         // Get some info from target. This is just an example
         quint32 speed = 0;
-        r = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+        r = mTransport->controlTransfer(LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
                 REQ_GetPll1Speed, 0, INTERFACENUM, (unsigned char*)&speed, sizeof(speed), 100);
         if (r == sizeof(speed)) {
             qDebug("[Probe] MCU PLL is running at %u MHz", speed/1000000);
@@ -884,7 +917,7 @@ void LabToolDeviceComm::probe()
     // Load calibration information
     int size = LabToolCalibrationData::rawDataByteSize();
     unsigned char buff[size];
-    r = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+    r = mTransport->controlTransfer(LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
             REQ_GetStoredCalibData, 0, INTERFACENUM, buff, size, 1000);
     if (r == size) {
         if (this->mActiveCalibrationData != NULL) {
@@ -907,27 +940,34 @@ void LabToolDeviceComm::probe()
 */
 int LabToolDeviceComm::stopCapture()
 {
+    setAutoRearm(false);
+
     LabToolDeviceTransfer::invalidateOldTransfers();
 
     if (!mConnected)
     {
-        mRunningTransfer = NULL;
+        clearRunningTransfer(NULL);
         return -1;
     }
 
     // Synchronous request to make sure HW will not send more data
-    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+    int ret = mTransport->controlTransfer(LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
             REQ_StopCapture, 0, INTERFACENUM, NULL, 0, 1000);
 //    if (ret != LIBUSB_SUCCESS) {
 //        return -1;//emit connectionStatus(false);
 //    }
 
-    if (mRunningTransfer != NULL)
     {
-        if (libusb_cancel_transfer(mRunningTransfer->transfer()) != LIBUSB_SUCCESS)
+        // the comm thread clears mRunningTransfer when the transfer completes
+        QMutexLocker locker(&mRearmMutex);
+
+        if (mRunningTransfer != NULL)
         {
-            // a successful transfer cancellation will always get a callback which will delete it
-            mRunningTransfer = NULL;
+            if (mTransport->cancelTransfer(mRunningTransfer->transfer()) != LIBUSB_SUCCESS)
+            {
+                // a successful transfer cancellation will always get a callback which will delete it
+                mRunningTransfer = NULL;
+            }
         }
     }
 
@@ -935,7 +975,7 @@ int LabToolDeviceComm::stopCapture()
 //    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
 //    ddt->SetupForCommand(LabToolDeviceTransfer::CMD_STOP, m_EndpointOut, m_DeviceHandle, CallbackForSend, 2000);
 
-//    int ret = libusb_submit_transfer(ddt->transfer());
+//    int ret = submitTransfer(ddt);
 //    if (ret != LIBUSB_SUCCESS) {
 //        TransferFailed(ddt, ret);
 //    }
@@ -956,7 +996,7 @@ int LabToolDeviceComm::stopCapture()
     CMD_CAP_CONFIGURE  | Done, success reported with captureConfigurationDone signal
     CMD_CAP_RUN        | Now running, send CMD_CAP_SAMPLES to wait for captured data header
     CMD_CAP_SAMPLES    | Got header, send CMD_CAP_DATA_ONLY to get for captured data
-    CMD_CAP_DATA_ONLY  | Done, success reported with captureReceivedSamples signal
+    CMD_CAP_DATA_ONLY  | Done, result queued and captureSamplesAvailable signal sent, next capture started if re-arming (see \ref setAutoRearm)
     CMD_CAL_INIT       | Done, success reported with calibrationSuccess signal
     CMD_CAL_ANALOG_OUT | Done, success reported with calibrationSuccess signal
     CMD_CAL_ANALOG_IN  | Calibration running, send CMD_CAL_RESULT to get result
@@ -964,12 +1004,14 @@ int LabToolDeviceComm::stopCapture()
     CMD_CAL_STORE      | Done, success reported with calibrationSuccess signal
     CMD_CAL_ERASE      | Done, success reported with calibrationSuccess signal
     CMD_CAL_END        | Done, success reported with calibrationSuccess signal
+    CMD_GET_TELEMETRY  | Done, counters stored and reported with telemetryReceived signal
 */
 void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
 {
     // This is to keep information while retrieving the samples
     static logic_samples_header sampleHeader;
 
+    LabToolCaptureResult result;
     int ret;
 
 //    qDebug("%s: Success", transfer->CommandString());
@@ -988,8 +1030,8 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
 
     case LabToolDeviceTransfer::CMD_CAP_RUN:
         // target is now running, time to wait for samples
-        transfer->setupForIncomingCommand(LabToolDeviceTransfer::CMD_CAP_SAMPLES, mEndpointIn, mDeviceHandle, CallbackForResponse, 0xffffffff, sizeof(logic_samples_header));
-        ret = libusb_submit_transfer(transfer->transfer());
+        transfer->setupForIncomingCommand(LabToolDeviceTransfer::CMD_CAP_SAMPLES, inEndpoint(), CallbackForResponse, 0xffffffff, sizeof(logic_samples_header));
+        ret = submitTransfer(transfer);
         if (ret == LIBUSB_SUCCESS) {
             // must return to avoid the deletion of this transfer
             return;
@@ -1001,8 +1043,8 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
         // target has sent the header for the samples, investigate and get actual samples
         memcpy(&sampleHeader, transfer->data(), sizeof(logic_samples_header));
 //        qDebug("Got samples. Headers: %#x, %#x, %#x, %#x", sampleHeader.cmd, sampleHeader.bufferSize, sampleHeader.triggerInfo, sampleHeader.channelInfo);
-        transfer->setupForIncomingData(mEndpointIn, mDeviceHandle, CallbackForData, 2000, sampleHeader.digitalBufferSize, sampleHeader.analogBufferSize);
-        ret = libusb_submit_transfer(transfer->transfer());
+        transfer->setupForIncomingData(inEndpoint(), CallbackForData, 2000, sampleHeader.digitalBufferSize, sampleHeader.analogBufferSize);
+        ret = submitTransfer(transfer);
         if (ret == LIBUSB_SUCCESS) {
             // must return to avoid the deletion of this transfer
             return;
@@ -1013,11 +1055,27 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
     case LabToolDeviceTransfer::CMD_CAP_DATA_ONLY:
         // actual sample data
         // give sampleHeader and transfer) to LabToolDevice to forward to UI
-        emit captureReceivedSamples(transfer, sampleHeader.digitalBufferSize + sampleHeader.analogBufferSize, sampleHeader.triggerInfo, sampleHeader.digitalTrigSample, sampleHeader.analogTrigSample, sampleHeader.digitalChannelInfo, sampleHeader.analogChannelInfo);
-        if (mRunningTransfer == transfer)
-        {
-            mRunningTransfer = NULL;
+        result.transfer = transfer;
+        result.size = sampleHeader.digitalBufferSize + sampleHeader.analogBufferSize;
+        result.trigger = sampleHeader.triggerInfo;
+        result.digitalTrigSample = sampleHeader.digitalTrigSample;
+        result.analogTrigSample = sampleHeader.analogTrigSample;
+        result.digitalChannelInfo = sampleHeader.digitalChannelInfo;
+        result.analogChannelInfo = sampleHeader.analogChannelInfo;
+        result.transferTime = transfer->nsecsSinceSetup();
+        if (!mCaptureResults.push(result)) {
+            qDebug("Discarding captured data as the previous captures have not been handled");
+            delete transfer;
+        } else {
+            mPendingCaptures.ref();
+            if (mCaptureResultsSignalled.testAndSetOrdered(0, 1)) {
+                emit captureSamplesAvailable();
+            }
         }
+        clearRunningTransfer(transfer);
+
+        // in continuous mode the next capture starts while this one is handled
+        rearmCapture(false);
         // must return to avoid the deletion of this transfer
         return;
 
@@ -1032,8 +1090,8 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
 
     case LabToolDeviceTransfer::CMD_CAL_ANALOG_IN:
         // target is now calibrating, time to wait up to 10 seconds for the result
-        transfer->setupForIncomingCommand(LabToolDeviceTransfer::CMD_CAL_RESULT, mEndpointIn, mDeviceHandle, CallbackForResponse, 10000, LabToolCalibrationData::rawDataByteSize());
-        ret = libusb_submit_transfer(transfer->transfer());
+        transfer->setupForIncomingCommand(LabToolDeviceTransfer::CMD_CAL_RESULT, inEndpoint(), CallbackForResponse, 10000, LabToolCalibrationData::rawDataByteSize());
+        ret = submitTransfer(transfer);
         if (ret == LIBUSB_SUCCESS) {
             // must return to avoid the deletion of this transfer
             return;
@@ -1053,12 +1111,28 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
     case LabToolDeviceTransfer::CMD_CAL_END:
         emit calibrationSuccess(NULL);
         break;
-    }
 
-    if (mRunningTransfer == transfer)
-    {
-        mRunningTransfer = NULL;
+    case LabToolDeviceTransfer::CMD_GET_TELEMETRY:
+        // A newer firmware may send more counters than this version knows about
+        if (transfer->controlDataSize() < (int)sizeof(LabToolTelemetry)) {
+            qDebug("Failed to read telemetry, got %d bytes", transfer->controlDataSize());
+            emit telemetryReceived(false);
+        } else {
+            // The counters are sent as little endian 32-bit words
+            const quint8* buff = transfer->controlData();
+            QMutexLocker locker(&mTelemetryMutex);
+            quint32* p = (quint32*)&mTelemetry;
+            for (unsigned int i = 0; i < sizeof(LabToolTelemetry)/4; i++) {
+                p[i] = buff[i*4] | (buff[i*4+1] << 8) | (buff[i*4+2] << 16) | ((quint32)buff[i*4+3] << 24);
+            }
+            mHasTelemetry = true;
+            locker.unlock();
+            emit telemetryReceived(true);
+        }
+        break;
     }
+
+    clearRunningTransfer(transfer);
     delete transfer;
 }
 
@@ -1113,12 +1187,13 @@ void LabToolDeviceComm::transferSuccessErrorResponse(LabToolDeviceTransfer *tran
     case LabToolDeviceTransfer::CMD_CAL_END:
         emit captureFailed(transfer->statusErrorString());
         break;
-    }
 
-    if (mRunningTransfer == transfer)
-    {
-        mRunningTransfer = NULL;
+    case LabToolDeviceTransfer::CMD_GET_TELEMETRY:
+        emit telemetryReceived(false);
+        break;
     }
+
+    clearRunningTransfer(transfer);
     delete transfer;
 }
 
@@ -1138,12 +1213,17 @@ void LabToolDeviceComm::transferSuccessErrorResponse(LabToolDeviceTransfer *tran
 */
 void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libusb_error)
 {
+    if (transfer->command() == LabToolDeviceTransfer::CMD_GET_TELEMETRY) {
+        // A firmware without the counters stalls the request, which is
+        // no reason to reconnect
+        qDebug("Failed to read telemetry, error %s", transfer->transferErrorString());
+        emit telemetryReceived(false);
+        delete transfer;
+        return;
+    }
     if (!transfer->validSequenceNumber()) {
         //qDebug("Discarding out-of-order transfer");
-        if (mRunningTransfer == transfer)
-        {
-            mRunningTransfer = NULL;
-        }
+        clearRunningTransfer(transfer);
         delete transfer;
         return;
     }
@@ -1224,10 +1304,7 @@ void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libu
         }
     }
 
-    if (mRunningTransfer == transfer)
-    {
-        mRunningTransfer = NULL;
-    }
+    clearRunningTransfer(transfer);
 
     // Don't reconnect on cancelled transfers (which occur when pressing STOP during a capture)
     if (transfer->transfer()->status != LIBUSB_TRANSFER_CANCELLED) {
@@ -1273,14 +1350,13 @@ int LabToolDeviceComm::configureCapture(int cfgSize, quint8 * cfgData)
 
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAP_CONFIGURE,
-                         mEndpointOut,
-                         mDeviceHandle,
+                         outEndpoint(),
                          CallbackForSend,
                          2000,
                          cfgSize,
                          cfgData);
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -1313,7 +1389,7 @@ int LabToolDeviceComm::configureCapture(int cfgSize, quint8 * cfgData)
         usb -> comm [ label="7. CallbackForResponse()" ];
         comm -> usb [ label="8. libusb_submit_transfer(CMD_CAP_DATA_ONLY)" ];
         usb -> comm [ label="9. CallbackForData()" ];
-        comm -> dev [ label="10. emit captureReceivedSamples()" ];
+        comm -> dev [ label="10. emit captureSamplesAvailable()" ];
     }
     \enddot
 */
@@ -1325,10 +1401,13 @@ int LabToolDeviceComm::runCapture()
     }
 
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
-    ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAP_RUN, mEndpointOut, mDeviceHandle, CallbackForSend, 2000);
-    mRunningTransfer = ddt;
+    ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAP_RUN, outEndpoint(), CallbackForSend, 2000);
+    {
+        QMutexLocker locker(&mRearmMutex);
+        mRunningTransfer = ddt;
+    }
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -1351,7 +1430,7 @@ int LabToolDeviceComm::stopGenerator()
     }
 
     // Synchronous request
-    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+    int ret = mTransport->controlTransfer(LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
             REQ_StopGenerator, 0, INTERFACENUM, NULL, 0, 1000);
 
     emit generatorStopped();
@@ -1395,14 +1474,13 @@ int LabToolDeviceComm::configureGenerator(int cfgSize, quint8* cfgData)
 
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_GEN_CONFIGURE,
-                         mEndpointOut,
-                         mDeviceHandle,
+                         outEndpoint(),
                          CallbackForSend,
                          2000,
                          cfgSize,
                          cfgData);
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -1444,12 +1522,11 @@ int LabToolDeviceComm::runGenerator()
 
     LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
     ddt->setupForCommand(LabToolDeviceTransfer::CMD_GEN_RUN,
-                         mEndpointOut,
-                         mDeviceHandle,
+                         outEndpoint(),
                          CallbackForSend,
                          2000);
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    int ret = submitTransfer(ddt);
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -1472,7 +1549,7 @@ int LabToolDeviceComm::ping()
         return -1;
     }
 
-    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+    int ret = mTransport->controlTransfer(LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
             REQ_Ping, 0, INTERFACENUM, NULL, 0, 100);
     if (ret != LIBUSB_SUCCESS) {
         emit connectionStatus(false);
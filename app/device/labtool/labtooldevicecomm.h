@@ -17,28 +17,83 @@
 #define LABTOOLDEVICECOMM_H
 
 #include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
+#include "common/spscqueue.h"
 #include "labtooldevicecommthread.h"
 #include "labtooldevicetransfer.h"
 #include "labtoolcalibrationdata.h"
+#include "labtooltransport.h"
 
 #include "libusbx/include/libusbx-1.0/libusb.h"
 
 class LabToolDeviceTransfer;
 
+/*!
+    Performance counters of the LabTool Hardware, in the same order as
+    telemetry_counters_t in the firmware's telemetry.h.
+*/
+struct LabToolTelemetry
+{
+    quint32 coreClock;
+    quint32 captures;
+    quint32 sgpioIrqCount;
+    quint32 sgpioIrqMaxCycles;
+    quint32 dmaTcIrqCount;
+    quint32 dmaIrqMaxCycles;
+    quint32 vadcSkippedSamples;
+    quint32 vadcEmptyMarkers;
+    quint32 usbBytesSent;
+    quint32 usbRetries;
+    quint32 usbFailures;
+};
+
+/*!
+    A completed capture, handed from the communication thread to the
+    LabToolCaptureDevice. The \a transfer holds the sample data and the
+    rest of the fields come from the sample header.
+*/
+struct LabToolCaptureResult
+{
+    LabToolDeviceTransfer* transfer;
+    unsigned int size;
+    unsigned int trigger;
+    unsigned int digitalTrigSample;
+    unsigned int analogTrigSample;
+    unsigned int digitalChannelInfo;
+    unsigned int analogChannelInfo;
+    qint64 transferTime;
+};
+
 class LabToolDeviceComm : public QObject
 {
     Q_OBJECT
 private:
-    libusb_context*          mContext;
-    libusb_device_handle*    mDeviceHandle;
+    enum Constants {
+        MaxQueuedCaptures = 8,
+        MaxPendingCaptures = 2,
+        MaxTelemetrySize = 256
+    };
+
+    LabToolTransport*        mTransport;
     LabToolDeviceTransfer*  mRunningTransfer;
     bool                     mConnected;
-    quint8                   mEndpointIn;
-    quint8                   mEndpointOut;
     LabToolCalibrationData* mActiveCalibrationData;
+    SpscQueue<LabToolCaptureResult, MaxQueuedCaptures> mCaptureResults;
+    QAtomicInt               mCaptureResultsSignalled;
+    QAtomicInt               mPendingCaptures;
+    QMutex                   mRearmMutex;
+    bool                     mAutoRearm;
+    bool                     mRearmPaused;
+    QMutex                   mTelemetryMutex;
+    LabToolTelemetry         mTelemetry;
+    bool                     mHasTelemetry;
+
+    void rearmCapture(bool onlyIfPaused);
+    void clearRunningTransfer(LabToolDeviceTransfer* transfer);
 
 public:
-    explicit LabToolDeviceComm(QObject *parent = 0);
+    explicit LabToolDeviceComm(LabToolTransport* transport, QObject *parent = 0);
     ~LabToolDeviceComm();
 
     void probe();
@@ -46,6 +101,7 @@ public:
     int stopCapture();
     int configureCapture(int cfgSize, quint8 * cfgData);
     int runCapture();
+    void setAutoRearm(bool enable);
 
     int stopGenerator();
     int configureGenerator(int cfgSize, quint8* cfgData);
@@ -60,9 +116,14 @@ public:
     bool connectToDevice(bool quiet=true);
     void disconnectFromDevice();
 
-    libusb_context* usbContext() { return mContext; }
-    quint8          inEndpoint() { return mEndpointIn; }
-    quint8          outEndpoint() { return mEndpointOut; }
+    int submitTransfer(LabToolDeviceTransfer* transfer);
+    int handleEvents(int timeout);
+    void wakeUp();
+
+    bool takeCaptureResult(LabToolCaptureResult* result);
+
+    quint8          inEndpoint() { return mTransport->inEndpoint(); }
+    quint8          outEndpoint() { return mTransport->outEndpoint(); }
 
     void calibrateInit();
     void calibrateAnalogOut(quint32 level);
@@ -72,12 +133,15 @@ public:
     void calibrationEnd();
     LabToolCalibrationData* storedCalibrationData(bool forceReload=false);
 
+    int requestTelemetry();
+    bool telemetry(LabToolTelemetry* telemetry);
+
 signals:
     void connectionStatus(bool connected);
 
     void captureStopped();
     void captureConfigurationDone();
-    void captureReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int activeDigital, unsigned int activeAnalog);
+    void captureSamplesAvailable();
     void captureFailed(const char* msg);
     void captureConfigurationFailed(const char* msg);
 
@@ -90,6 +154,8 @@ signals:
     void calibrationFailed(const char* msg);
     void calibrationSuccess(LabToolCalibrationData* data);
 
+    void telemetryReceived(bool ok);
+
 public slots:
 
 private slots:
@@ -16,7 +16,8 @@
 #include "labtooldevicecommthread.h"
 #include <time.h>
 #include <QFile>
-#include <QTime>
+#include <QElapsedTimer>
+#include <QMutexLocker>
 #include <stdio.h>
 
 /*!
@@ -26,15 +27,22 @@
     \ingroup Device
 
     As long as there is a connection established with the LabTool Hardware
-    this thread will drive the libusbx by continuously calling \a libusb_handle_events_timeout.
+    this thread will drive the libusbx by continuously calling
+    LabToolDeviceComm::handleEvents(). The call only returns when a transfer
+    has completed, when it is time to \a ping the hardware to detect that it
+    has been disconnected, or when \ref stop or \ref reconnectToTarget ends
+    the wait through LabToolDeviceComm::wakeUp(). That way a stop or a
+    reconnect is handled immediately instead of after a fixed timeout.
 
     As long as there is no connection established with the LabTool Hardware
     this thread will attempt to make one by:
+    -# Creates the LabToolTransport to use, see LabToolTransport::createTransport().
     -# Run the dfu-util-static.exe tool from http://dfu-util.gnumonks.org/
         to attempt to download the firmware to a matching LPC-DFU device.
         If the LabTool Hardware is not connected or not in DFU mode nothing
         happens. If the firmware is downloaded then the LabTool Hardware
-        will be rebooted into LabTool-mode.
+        will be rebooted into LabTool-mode. This step is skipped for the
+        virtual device.
     -# Creates an instance of the \ref LabToolDeviceComm and uses it to
         communicate with the LabTool Hardware. If communication works then
         the \ref connectionChanged signal is sent.
@@ -46,7 +54,6 @@
 LabToolDeviceCommThread::LabToolDeviceCommThread(QObject *parent) :
     QThread(parent)
 {
-    mContext = NULL;
     mRun = true;
     mReconnect = false;
     mConnected = false;
@@ -60,17 +67,17 @@ LabToolDeviceCommThread::LabToolDeviceCommThread(QObject *parent) :
 void LabToolDeviceCommThread::run()
 {
     int err;
-    timeval tv;
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
-    QTime time;
-    time.start();
+    int timeout;
+    LabToolDeviceComm* comm;
+    QElapsedTimer lastPing;
+    lastPing.start();
 
     // Deallocation:
     //   By connecting finished to deleteLater, this object should be deleted
     //   when the run() function exits
     //QObject::connect(this, SIGNAL(finished()), this, SLOT(deleteLater()));
 
+    mMutex.lock();
     while (mRun) {
         if (mReconnect) {
             if (mDeviceComm != NULL) {
@@ -82,23 +89,40 @@ void LabToolDeviceCommThread::run()
             mReconnect = false;
         }
         if (!mConnected) {
-            QThread::msleep(1000);
-            runDFU();
-            mConnected = connectToDevice();
+            if (!mFirstConnectAttempt) {
+                mWakeUp.wait(&mMutex, ReconnectInterval);
+                if (!mRun || mReconnect) {
+                    continue;
+                }
+            }
+            mMutex.unlock();
+            bool connected = connectToDevice();
+            mMutex.lock();
+            mConnected = connected;
+            lastPing.restart();
+            continue;
         }
-        if (mConnected) {
-            err = libusb_handle_events_timeout(mContext, &tv);
+
+        // The comm instance is only replaced by this thread so it is safe
+        // to use it without holding the mutex
+        comm = mDeviceComm;
+        timeout = PingInterval - (int)lastPing.elapsed();
+        mMutex.unlock();
+
+        if (timeout > 0) {
+            err = comm->handleEvents(timeout);
             if (err != LIBUSB_SUCCESS) {
                 qDebug("...CommThread: got error %s", libusb_error_name(err));
             }
+        }
 
-            if (time.elapsed() >= 3000) {
-                mDeviceComm->ping();
-                time.restart();
-            }
+        if (lastPing.elapsed() >= PingInterval) {
+            comm->ping();
+            lastPing.restart();
         }
+        mMutex.lock();
     }
-
+    mMutex.unlock();
 }
 
 /*!
@@ -106,7 +130,9 @@ void LabToolDeviceCommThread::run()
 */
 void LabToolDeviceCommThread::stop()
 {
+    QMutexLocker locker(&mMutex);
     mRun = false;
+    wakeUp();
 }
 
 /*!
@@ -115,7 +141,21 @@ void LabToolDeviceCommThread::stop()
 */
 void LabToolDeviceCommThread::reconnectToTarget()
 {
+    QMutexLocker locker(&mMutex);
     mReconnect = true;
+    wakeUp();
+}
+
+/*!
+    Ends the wait in the \ref run() loop, both while waiting to reconnect
+    and while waiting for USB events. Must be called with the mutex locked.
+*/
+void LabToolDeviceCommThread::wakeUp()
+{
+    mWakeUp.wakeAll();
+    if (mDeviceComm != NULL) {
+        mDeviceComm->wakeUp();
+    }
 }
 
 /*!
@@ -248,7 +288,8 @@ void LabToolDeviceCommThread::runDFU()
 }
 
 /*!
-    Attempts to connect to the LabTool Hardware. A successfull connection will be
+    Attempts to connect to the LabTool Hardware, or to the virtual device if
+    it has been enabled. A successfull connection will be
     result in the \ref connectionChanged signal.
 */
 bool LabToolDeviceCommThread::connectToDevice()
@@ -256,14 +297,22 @@ bool LabToolDeviceCommThread::connectToDevice()
     bool first = mFirstConnectAttempt;
     mFirstConnectAttempt = false;
 
+    // Deallocation:
+    //   LabToolTransport will be deallocated by the LabToolDeviceComm
+    LabToolTransport* transport = LabToolTransport::createTransport();
+    if (!transport->isVirtual()) {
+        runDFU();
+    }
+
     // Deallocation:
     //   LabToolDeviceComm will be deallocated by the LabToolDevice
     //   or this function
-    LabToolDeviceComm* pComm = new LabToolDeviceComm();
+    LabToolDeviceComm* pComm = new LabToolDeviceComm(transport);
     if (pComm->connectToDevice(!first)) {
+        mMutex.lock();
         mDeviceComm = pComm;
-        mContext = pComm->usbContext();
-        emit connectionChanged(mDeviceComm);
+        mMutex.unlock();
+        emit connectionChanged(pComm);
         return true;
     } else {
         delete pComm;
@@ -18,6 +18,8 @@
 
 #include <QProcess>
 #include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
 #include "labtooldevicecomm.h"
 #include "libusbx/include/libusbx-1.0/libusb.h"
 
@@ -37,17 +39,24 @@ signals:
     void connectionChanged(LabToolDeviceComm* newComm);
 
 private:
+    enum Constants {
+        ReconnectInterval = 1000,
+        PingInterval = 3000
+    };
+
     void prepareDfuImage();
     void runDFU();
     bool connectToDevice();
+    void wakeUp();
 
-    libusb_context*     mContext;
     bool                mRun;
     bool                mReconnect;
     bool                mConnected;
     bool                mFirstConnectAttempt;
     QString             mPreparedImage;
     LabToolDeviceComm* mDeviceComm;
+    QMutex              mMutex;
+    QWaitCondition      mWakeUp;
 };
 
 #endif // LABTOOLDEVICECOMMTHREAD_H
@@ -128,6 +128,11 @@ LabToolDeviceTransfer::~LabToolDeviceTransfer()
     \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_CAL_END
     Sent to end the calibration sequence
 */
+/*!
+    \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_GET_TELEMETRY
+    Internal command, never sent to the LabTool Hardware, but
+    used to mark the control transfer reading the performance counters
+*/
 
 
 /*!
@@ -142,8 +147,7 @@ LabToolDeviceTransfer::~LabToolDeviceTransfer()
     CMD_CAP_CONFIGURE |   OUT    | CallbackForSend     |   Yes
     CMD_CAP_RUN       |   OUT    | CallbackForSend     |   No
 
-    The \a deviceHandle parameter is needed by libusbx, \a timeout specifies in milliseconds
-    when a transfer should be aborted.
+    The \a timeout parameter specifies in milliseconds when a transfer should be aborted.
 
     The transferred data will be 4 bytes formatted like this:
 
@@ -156,7 +160,7 @@ LabToolDeviceTransfer::~LabToolDeviceTransfer()
 
     Note that only the size of the payload is sent in this first transfer, not the actual payload.
 */
-void LabToolDeviceTransfer::setupForCommand(Commands cmd, unsigned char endpoint, libusb_device_handle *deviceHandle, libusb_transfer_cb_fn callback, unsigned int timeout, int payloadSize, const unsigned char *payload)
+void LabToolDeviceTransfer::setupForCommand(Commands cmd, unsigned char endpoint, libusb_transfer_cb_fn callback, unsigned int timeout, int payloadSize, const unsigned char *payload)
 {
 //    qDebug("[Trace] Setup for command %d: comm %#x, mTransfer=%#x, this=%#x", cmd, (uint32_t)mDeviceComm, (uint32_t)mTransfer, (uint32_t)this);
     mData.resize(4 + payloadSize);
@@ -177,7 +181,7 @@ void LabToolDeviceTransfer::setupForCommand(Commands cmd, unsigned char endpoint
     mCmd = cmd;
 
     libusb_fill_bulk_transfer(mTransfer,
-                              deviceHandle,
+                              NULL, // assigned by the LabToolTransport
                               endpoint,
                               mData.data(),
                               4,
@@ -268,8 +272,7 @@ void LabToolDeviceTransfer::setupForResponse(unsigned char endpoint, libusb_tran
     ----------------- | :------: | ------------------- | :-----:
     CMD_CAP_SAMPLES   |   IN     | CallbackForResponse |   Yes
 
-    The \a deviceHandle parameter is needed by libusbx, \a timeout specifies in milliseconds
-    when a transfer should be aborted.
+    The \a timeout parameter specifies in milliseconds when a transfer should be aborted.
 
     The received data will be formatted like this:
 
@@ -289,7 +292,7 @@ void LabToolDeviceTransfer::setupForResponse(unsigned char endpoint, libusb_tran
      }
     \enddot
 */
-void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char endpoint, libusb_device_handle *deviceHandle, libusb_transfer_cb_fn callback, unsigned int timeout, int payloadSize)
+void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char endpoint, libusb_transfer_cb_fn callback, unsigned int timeout, int payloadSize)
 {
 //    qDebug("[Trace] Setup for incomming cmd %d: comm %#x, mTransfer=%#x, this=%#x", cmd, (uint32_t)mDeviceComm, (uint32_t)mTransfer, (uint32_t)this);
     mData.clear();
@@ -298,7 +301,7 @@ void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char
     mCmd = cmd;
 
     libusb_fill_bulk_transfer(mTransfer,
-                              deviceHandle,
+                              NULL, // assigned by the LabToolTransport
                               endpoint,
                               mData.data(),
                               mData.size(),
@@ -314,8 +317,7 @@ void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char
 
     The \a endpoint parameter should be the IN endpoint to use.
 
-    The \a deviceHandle parameter is needed by libusbx, \a timeout specifies in milliseconds
-    when a transfer should be aborted.
+    The \a timeout parameter specifies in milliseconds when a transfer should be aborted.
 
     The \a callback parameter should always be the CallbackForData function.
 
@@ -331,7 +333,7 @@ void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char
     }
     \enddot
 */
-void LabToolDeviceTransfer::setupForIncomingData(unsigned char endpoint, libusb_device_handle *deviceHandle, libusb_transfer_cb_fn callback, unsigned int timeout, int digitalPayloadSize, int analogPayloadSize)
+void LabToolDeviceTransfer::setupForIncomingData(unsigned char endpoint, libusb_transfer_cb_fn callback, unsigned int timeout, int digitalPayloadSize, int analogPayloadSize)
 {
 //    qDebug("[Trace] Setup for incoming data: comm %#x, mTransfer=%#x, this=%#x", (uint32_t)mDeviceComm, (uint32_t)mTransfer, (uint32_t)this);
     mData.clear();
@@ -341,8 +343,11 @@ void LabToolDeviceTransfer::setupForIncomingData(unsigned char endpoint, libusb_
 
     mCmd = CMD_CAP_DATA_ONLY;
 
+    // the data is sent as soon as the transfer is submitted
+    mSetupTimer.start();
+
     libusb_fill_bulk_transfer(mTransfer,
-                              deviceHandle,
+                              NULL, // assigned by the LabToolTransport
                               endpoint,
                               mData.data(),
                               mData.size(),
@@ -351,6 +356,44 @@ void LabToolDeviceTransfer::setupForIncomingData(unsigned char endpoint, libusb_
                               timeout * TIMEOUT_MULTIPLIER);
 }
 
+/*!
+    Modifies this transfer into a vendor specific control request that reads
+    at most \a length bytes from the LabTool Hardware. Unlike the other
+    transfers this one goes to the control endpoint, just like the synchronous
+    requests made with LabToolTransport::controlTransfer().
+
+    The \a cmd parameter is only used to mark the transfer so that the
+    callback knows what to do with the answer.
+
+    The \a request and \a index parameters are the bRequest and wIndex
+    fields of the setup packet.
+
+    The \a timeout parameter specifies in milliseconds when a transfer should be aborted.
+
+    The received data is available with \ref controlData and its size with
+    \ref controlDataSize once the transfer has completed.
+*/
+void LabToolDeviceTransfer::setupForControlRequest(Commands cmd, quint8 request, quint16 index, libusb_transfer_cb_fn callback, unsigned int timeout, int length)
+{
+    mData.clear();
+    mData.resize(LIBUSB_CONTROL_SETUP_SIZE + length);
+
+    mCmd = cmd;
+
+    libusb_fill_control_setup(mData.data(),
+                              LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+                              request,
+                              0,
+                              index,
+                              length);
+    libusb_fill_control_transfer(mTransfer,
+                                 NULL, // assigned by the LabToolTransport
+                                 mData.data(),
+                                 callback,
+                                 this,
+                                 timeout * TIMEOUT_MULTIPLIER);
+}
+
 /*!
     Verifies that the first received byte is 0xEA and that the Command byte corresponds
     to the Command that this transfer is configured for.
@@ -454,6 +497,7 @@ const char *LabToolDeviceTransfer::statusErrorString()
         case 28: return "CMD_STATUS_ERR_GEN_INVALID_RUN_COUNTER";
         case 29: return "CMD_STATUS_ERR_GEN_INVALID_NUMBER_OF_STATES";
         case 30: return "CMD_STATUS_ERR_GEN_INVALID_AMPLITUDE";
+        case 31: return "CMD_STATUS_ERR_GEN_INVALID_PATTERN";
 
         /* Related to I2C monitoring */
         case 40: return "CMD_STATUS_ERR_MON_I2C_PCA95555_FAILED";
@@ -485,6 +529,7 @@ const char *LabToolDeviceTransfer::commandString()
     case CMD_CAP_RUN:       return "CMD_CAP_RUN";
     case CMD_CAP_SAMPLES:   return "CMD_CAP_SAMPLES";
     case CMD_CAP_DATA_ONLY: return "CMD_CAP_DATA_ONLY";
+    case CMD_GET_TELEMETRY: return "CMD_GET_TELEMETRY";
     default:                return "Unknown command";
     }
 }
@@ -559,3 +604,9 @@ const char *LabToolDeviceTransfer::commandString()
 
     Returns this transfer's sequence number.
 */
+/*!
+    \fn qint64 LabToolDeviceTransfer::nsecsSinceSetup()
+
+    Returns the time in nanoseconds since \ref setupForIncomingData was
+    called. Used to measure how long the samples took to transfer.
+*/
@@ -17,6 +17,7 @@
 #define LABTOOLDEVICETRANSFER_H
 
 #include "QVector"
+#include <QElapsedTimer>
 #include "labtooldevicecomm.h"
 
 #include "libusbx/include/libusbx-1.0/libusb.h"
@@ -43,12 +44,13 @@ public:
         CMD_CAL_RESULT     = 10,
         CMD_CAL_STORE      = 11,
         CMD_CAL_ERASE      = 12,
-        CMD_CAL_END        = 13
+        CMD_CAL_END        = 13,
+
+        CMD_GET_TELEMETRY  = 14
     };
 
     void setupForCommand(Commands cmd,
                          unsigned char endpoint,
-                         libusb_device_handle* deviceHandle,
                          libusb_transfer_cb_fn callback,
                          unsigned int timeout,
                          int payloadSize=0,
@@ -63,16 +65,20 @@ public:
 
     void setupForIncomingCommand(Commands cmd,
                                  unsigned char endpoint,
-                                 libusb_device_handle* deviceHandle,
                                  libusb_transfer_cb_fn callback,
                                  unsigned int timeout,
                                  int payloadSize);
     void setupForIncomingData(unsigned char endpoint,
-                              libusb_device_handle* deviceHandle,
                               libusb_transfer_cb_fn callback,
                               unsigned int timeout,
                               int digitalPayloadSize,
                               int analogPayloadSize);
+    void setupForControlRequest(Commands cmd,
+                                quint8 request,
+                                quint16 index,
+                                libusb_transfer_cb_fn callback,
+                                unsigned int timeout,
+                                int length);
 
     bool isValidResponse();
     bool successful();
@@ -88,6 +94,8 @@ public:
     bool hasPayload() { return mHasPayload; }
     int analogDataOffset() { return mAnalogDataOffset; }
     int analogDataSize() { return mAnalogDataSize; }
+    const quint8* controlData() { return mData.constData() + LIBUSB_CONTROL_SETUP_SIZE; }
+    int controlDataSize() { return mTransfer->actual_length; }
 
     struct libusb_transfer* transfer() { return mTransfer; }
     LabToolDeviceComm* deviceComm() { return mDeviceComm; }
@@ -96,6 +104,7 @@ public:
     static void invalidateOldTransfers() { minValidSeqNr = sequenceCounter; }
     bool validSequenceNumber() { return mSequenceNumber >= minValidSeqNr; }
     int sequenceNumber() { return mSequenceNumber; }
+    qint64 nsecsSinceSetup() { return mSetupTimer.nsecsElapsed(); }
 
 
 private:
@@ -112,6 +121,8 @@ private:
 
     LabToolDeviceComm* mDeviceComm;
     Commands mCmd;
+
+    QElapsedTimer mSetupTimer;
 };
 
 #endif // LABTOOLDEVICETRANSFER_H
@@ -17,18 +17,27 @@
 
 #include <QDebug>
 
+#include "labtooldactable.h"
+#include "generator_pattern.h"
+
+/*! Waveform type used when the lookup table is built by the application */
+#define GEN_DAC_CFG_WAVE_ARBITRARY  6
+
 /*!
     @brief Configuration of the digital signal(s) to generate.
 
     The \a enabledChannels bit mask represents DIO0..DIO9 and DIO_CLK.
+    Longer sequences of states are sent as a compressed pattern stream,
+    see generator_pattern.h, and then the \a patterns are ignored.
     \private
  */
 typedef struct
 {
   uint32_t enabledChannels; /*!< using bits 0-10, a 1 means enabled */
   uint32_t frequency;       /*!< Frequency of generated signal */
-  uint32_t numStates;       /*!< Bits per channel 1..256 */
+  uint32_t numStates;       /*!< Bits per channel 1..256, or more if encoded */
   uint32_t patterns[8][11];  /*!< Up to 8*32 states for up to 11 channels */
+  uint32_t encodedSize;     /*!< Number of 16-bit words in the pattern stream, 0 if not used */
 } gen_sgpio_cfg_t;
 
 
@@ -48,11 +57,13 @@ typedef struct
    *   3   | Sawtooth
    *   4   | Reverse (or inverse) Sawtooth
    *   5   | Level (outputs DC offset, ignores amplitude)
+   *   6   | Arbitrary (lookup table supplied by the application)
    */
   uint32_t waveform;
   uint32_t frequency; /*!< Frequency in Hz */
   uint32_t amplitude; /*!< Amplitude in mV, 0..5000 */
   int32_t  dcOffset;  /*!< DC offset in mV, -5000..5000 */
+  uint32_t lutSize;   /*!< Number of lookup table entries, only for arbitrary */
 } gen_dac_one_ch_cfg_t;
 
 /*!
@@ -70,7 +81,9 @@ typedef struct
 
     This is the structure that the application sends to
     the LabTool Hardware to configure generation of analog
-    and/or digital signals.
+    and/or digital signals. It is followed by the compressed
+    pattern stream for the digital signals (if needed) and then
+    the lookup tables for the analog signals, see \ref LabToolDacTable.
 
     \private
  */
@@ -101,6 +114,7 @@ LabToolGeneratorDevice::LabToolGeneratorDevice(QObject *parent) :
 {
     mDeviceComm = NULL;
     mData = NULL;
+    mDataSize = 0;
     mContinuousRun = false;
     mDigitalRate = 1;
 
@@ -127,10 +141,33 @@ void LabToolGeneratorDevice::start(int digitalRate, bool loop)
     mContinuousRun = loop;
     mDigitalRate = digitalRate;
 
+    if (isDigitalGeneratorEnabled() && !digitalSignals().empty())
+    {
+        int numStates = digitalSignals().at(0)->numStates();
+        if (numStates > MaxUnencodedStates
+                && numDmaBuffers(numStates, loop) > MaxDmaBuffers)
+        {
+            emit generateFinished(false, tr("In continuous mode the LabTool Hardware repeats the "
+                                            "%1 states until they fill a whole number of 32-bit "
+                                            "words. That needs room for %2 states but only %3 fit.\n\n"
+                                            "Use a number of states that is a multiple of 32.")
+                                  .arg(numStates)
+                                  .arg(numDmaBuffers(numStates, loop)*32)
+                                  .arg(MaxDmaBuffers*32));
+            return;
+        }
+    }
+
     if (hasConfigChanged())
     {
-        mDeviceComm->configureGenerator(configSize(),
-                                        configData(digitalRate));
+        // the size depends on the lookup tables so configData must be first
+        quint8* data = configData(digitalRate);
+        if (data == NULL) {
+            emit generateFinished(false, tr("The signals do not fit in the LabTool Hardware.\n\n"
+                                            "Reduce the number of digital states or make them more regular."));
+            return;
+        }
+        mDeviceComm->configureGenerator(configSize(), data);
     }
     else
     {
@@ -138,6 +175,41 @@ void LabToolGeneratorDevice::start(int digitalRate, bool loop)
     }
 }
 
+/*!
+    Returns the number of DMA buffers that the LabTool Hardware needs to
+    generate a compressed sequence of \a numStates states. Each buffer holds
+    32 states.
+
+    In continuous mode (\a loop is true) the sequence is repeated until it
+    fills a whole number of buffers, so an odd \a numStates needs
+    \a numStates buffers. A single run needs an extra buffer for the end
+    data. This mirrors gen_sgpio_PrepareEncodedData() in the firmware.
+*/
+int LabToolGeneratorDevice::numDmaBuffers(int numStates, bool loop)
+{
+    if (!loop) {
+        return (numStates + 31)/32 + 1;
+    }
+
+    // first multiple of numStates that goes evenly into 32-bit words
+    int mult = 1;
+    while (((numStates * mult) % 32) > 0) {
+        mult++;
+    }
+
+    return (numStates * mult)/32;
+}
+
+/*!
+    Returns the supported analog waveforms. As the lookup tables are
+    built by the application any shape can be generated.
+*/
+QList<AnalogSignal::AnalogWaveform> LabToolGeneratorDevice::supportedAnalogWaveforms()
+{
+    return GeneratorDevice::supportedAnalogWaveforms()
+            << AnalogSignal::WaveformArbitrary;
+}
+
 void LabToolGeneratorDevice::stop()
 {
     mDeviceComm->stopGenerator();
@@ -230,10 +302,11 @@ void LabToolGeneratorDevice::handleRunningFailure(const char *msg)
 
 /*!
     Number of bytes in the configuration data to send to the LabTool Hardware.
+    Only valid after a call to \ref configData.
 */
 unsigned int LabToolGeneratorDevice::configSize()
 {
-    return sizeof(generator_cfg_t);
+    return mDataSize;
 }
 
 /*!
@@ -242,9 +315,13 @@ unsigned int LabToolGeneratorDevice::configSize()
     is no need to cache the changes.
 
     The data is returned as a byte array, but is actually one \a generator_cfg_t
-    structure. The signal independant information is filled in here and then
-    \ref updateDigitalConfigData and \ref updateAnalogConfigData are called
-    to fill in the signal specific parts.
+    structure followed by the pattern stream for the digital signals and the
+    lookup tables for the analog signals. The signal independant information
+    is filled in here and then \ref updateDigitalConfigData and
+    \ref updateAnalogConfigData are called to fill in the signal specific parts.
+
+    Returns NULL if the configuration is too large to send to the LabTool
+    Hardware.
 */
 quint8* LabToolGeneratorDevice::configData(int digitalRate)
 {
@@ -253,6 +330,9 @@ quint8* LabToolGeneratorDevice::configData(int digitalRate)
     }
 
     memset(mData, 0, sizeof(generator_cfg_t));
+    mDataSize = sizeof(generator_cfg_t);
+    mPatternStream.clear();
+    mDacTables.clear();
 
     // Configure common parts
     generator_cfg_t* common_header = (generator_cfg_t*)mData;
@@ -263,7 +343,9 @@ quint8* LabToolGeneratorDevice::configData(int digitalRate)
     if (isDigitalGeneratorEnabled() && !digitalSignals().empty())
     {
         common_header->available |= (1<<0);
-        updateDigitalConfigData(digitalRate);
+        if (!updateDigitalConfigData(digitalRate)) {
+            return NULL;
+        }
     }
     if (isAnalogGeneratorEnabled() && !analogSignals().empty())
     {
@@ -271,14 +353,40 @@ quint8* LabToolGeneratorDevice::configData(int digitalRate)
         updateAnalogConfigData();
     }
 
+    int numExtra = mPatternStream.size() + mDacTables.size();
+    if (numExtra > 0)
+    {
+        mDataSize = sizeof(generator_cfg_t) + numExtra*sizeof(quint16);
+        if (mDataSize > (unsigned int)MaxConfigSize) {
+            qWarning("Generator configuration too large, %u bytes", mDataSize);
+            mDataSize = 0;
+            return NULL;
+        }
+
+        // Deallocation: Destructor is responsible
+        mData = (uchar*)realloc(mData, mDataSize);
+
+        // the pattern stream must come before the lookup tables
+        quint8* p = mData + sizeof(generator_cfg_t);
+        memcpy(p, mPatternStream.constData(), mPatternStream.size()*sizeof(quint16));
+        p += mPatternStream.size()*sizeof(quint16);
+        memcpy(p, mDacTables.constData(), mDacTables.size()*sizeof(quint16));
+    }
+
     return mData;
 }
 
 /*!
     Fills in the configuration of the digital signals in the \a gen_sgpio_cfg_t
     part of the \a generator_cfg_t to send to the LabTool Hardware.
+
+    Up to MaxUnencodedStates states are packed into the \a patterns. Longer
+    sequences are compressed with gen_pattern_Encode() into a pattern stream
+    that \ref configData appends to the configuration.
+
+    Returns false if the compressed sequence is too large.
 */
-void LabToolGeneratorDevice::updateDigitalConfigData(int digitalRate)
+bool LabToolGeneratorDevice::updateDigitalConfigData(int digitalRate)
 {
     generator_cfg_t* common_header = (generator_cfg_t*)mData;
     gen_sgpio_cfg_t* digital_header = &common_header->sgpio;
@@ -286,6 +394,41 @@ void LabToolGeneratorDevice::updateDigitalConfigData(int digitalRate)
     digital_header->frequency = digitalRate;
 
     QList<DigitalSignal*> signalList = digitalSignals();
+
+    if (signalList.at(0)->numStates() > MaxUnencodedStates)
+    {
+        // All signals have the same number of states
+        int numStates = signalList.at(0)->numStates();
+        QVector<quint16> states(numStates, 0);
+
+        foreach(DigitalSignal* s, signalList)
+        {
+            int ch = s->id();
+            digital_header->enabledChannels |= (1 << ch);
+            QVector<bool> data = s->data();
+            for (int i = 0; i < numStates && i < data.size(); i++)
+            {
+                if (data.at(i)) {
+                    states[i] |= (1 << ch);
+                }
+            }
+        }
+
+        mPatternStream.resize((MaxConfigSize - sizeof(generator_cfg_t))/sizeof(quint16));
+        int numWords = gen_pattern_Encode(states.constData(), numStates,
+                                          mPatternStream.data(), mPatternStream.size());
+        if (numWords < 0) {
+            qWarning("Digital pattern with %d states does not fit", numStates);
+            mPatternStream.clear();
+            return false;
+        }
+        mPatternStream.resize(numWords);
+
+        digital_header->numStates = numStates;
+        digital_header->encodedSize = numWords;
+        return true;
+    }
+
     foreach(DigitalSignal* s, signalList)
     {
         int ch = s->id();
@@ -320,17 +463,31 @@ void LabToolGeneratorDevice::updateDigitalConfigData(int digitalRate)
         }
         digital_header->numStates = numStates;
     }
+
+    return true;
 }
 
 /*!
     Fills in the configuration of the analog signals in the \a gen_dac_cfg_t
     part of the \a generator_cfg_t to send to the LabTool Hardware.
+
+    The lookup tables for all analog signals are calculated and calibrated
+    here using \ref LabToolDacTable so that the LabTool Hardware only has to
+    copy them. The tables are stored in channel order, as expected by the
+    LabTool Hardware, and appended to the configuration by \ref configData.
 */
 void LabToolGeneratorDevice::updateAnalogConfigData()
 {
     generator_cfg_t* common_header = (generator_cfg_t*)mData;
     gen_dac_cfg_t* analog_header = &common_header->dac;
 
+    LabToolCalibrationData* calib = NULL;
+    if (mDeviceComm != NULL) {
+        calib = mDeviceComm->storedCalibrationData();
+    }
+
+    AnalogSignal* signalsById[2] = {NULL, NULL};
+
     QList<AnalogSignal*> signalList = analogSignals();
     foreach(AnalogSignal* s, signalList)
     {
@@ -340,10 +497,48 @@ void LabToolGeneratorDevice::updateAnalogConfigData()
 
             analog_header->ch[id].amplitude = s->amplitude()*1000;
             analog_header->ch[id].frequency = s->frequency();
-            analog_header->ch[id].waveform = s->waveform();
             analog_header->ch[id].dcOffset = 0; /*! \todo Add DC Offset to GUI */
+            if (s->waveform() == AnalogSignal::WaveformArbitrary) {
+                analog_header->ch[id].waveform = GEN_DAC_CFG_WAVE_ARBITRARY;
+            } else {
+                analog_header->ch[id].waveform = s->waveform();
+            }
+
+            signalsById[id] = s;
         }
     }
+
+    if (calib == NULL) {
+        // Without calibration data the tables cannot be built here, let the
+        // LabTool Hardware build them for the waveforms that it knows about
+        qWarning("No calibration data, lookup tables will be built by the hardware");
+        return;
+    }
+
+    int numChannels = (signalsById[0] != NULL) + (signalsById[1] != NULL);
+
+    for (int id = 0; id < 2; id++)
+    {
+        AnalogSignal* s = signalsById[id];
+        if (s == NULL) continue;
+
+        int size = LabToolDacTable::tableSize(s->frequency(), numChannels);
+        QVector<double> levels = LabToolDacTable::waveformLevels(
+                    s->waveform(), s->amplitude(), s->arbitraryData(), size);
+        if (levels.isEmpty()) {
+            // e.g. an arbitrary waveform without any data, leave it for
+            // the hardware to reject
+            continue;
+        }
+
+        LabToolDacTable::pack(id, levels,
+                              calib->analogOutFactorA(id),
+                              calib->analogOutFactorB(id),
+                              mDacTables);
+
+        analog_header->ch[id].waveform = GEN_DAC_CFG_WAVE_ARBITRARY;
+        analog_header->ch[id].lutSize = levels.size();
+    }
 }
 
 /*!
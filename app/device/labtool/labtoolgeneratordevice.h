@@ -17,6 +17,7 @@
 #define LABTOOLGENERATORDEVICE_H
 
 #include <QObject>
+#include <QVector>
 #include "device/generatordevice.h"
 #include "labtooldevicecomm.h"
 
@@ -30,12 +31,16 @@ public:
     int maxNumDigitalSignals() const {return 11;}
     int maxNumAnalogSignals() const {return 2;}
 
-    // maximum number of digital states per supported signal
-    int maxNumDigitalStates() const {return 256;}
+    // maximum number of digital states per supported signal,
+    // GEN_SGPIO_MAX_STATES in the firmware. In continuous mode the
+    // limit also depends on the number of states, see start().
+    int maxNumDigitalStates() const {return 19808;}
 
     int maxDigitalRate() const {return 100000000;} // limit to 100MHz for now
     int minDigitalRate() const {return 20;}
 
+    QList<AnalogSignal::AnalogWaveform> supportedAnalogWaveforms();
+
     void start(int digitalRate, bool loop);
     void stop();
 
@@ -54,10 +59,17 @@ private slots:
 
 private:
 
+    enum Constants {
+        MaxConfigSize      = 8704, // DATA_MAX_LEN in the firmware
+        MaxUnencodedStates = 256,  // size of gen_sgpio_cfg_t's patterns
+        MaxDmaBuffers      = 620   // MAX_DMA_BUFFERS in the firmware
+    };
+
+    static int numDmaBuffers(int numStates, bool loop);
 
     unsigned int configSize();
     quint8* configData(int digitalRate);
-    void updateDigitalConfigData(int digitalRate);
+    bool updateDigitalConfigData(int digitalRate);
     void updateAnalogConfigData();
 
     bool hasConfigChanged();
@@ -66,6 +78,9 @@ private:
 
     LabToolDeviceComm*  mDeviceComm;
     quint8* mData;
+    unsigned int mDataSize;
+    QVector<quint16> mPatternStream;
+    QVector<quint16> mDacTables;
     bool mContinuousRun;
     int mDigitalRate;
 
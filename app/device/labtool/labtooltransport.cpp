@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtooltransport.h"
+#include "labtoolusbtransport.h"
+#include "labtoolvirtualtransport.h"
+
+#include <QByteArray>
+
+/*!
+    \class LabToolTransport
+    \brief Interface for the link between LabToolDeviceComm and the LabTool Hardware
+
+    \ingroup Device
+
+    The LabToolTransport class is what LabToolDeviceComm uses instead of
+    calling libusbx directly. There are two implementations:
+
+    - LabToolUsbTransport talks to the LabTool Hardware through libusbx.
+    - LabToolVirtualTransport is an in-process device speaking the same
+      protocol as the firmware, which allows the whole capture pipeline to
+      be run without any hardware.
+
+    The libusbx \a libusb_transfer structure is used to describe the
+    asynchronous transfers for both implementations and all functions
+    return libusbx error codes. This way LabToolDeviceTransfer and the
+    callbacks in LabToolDeviceComm work the same regardless of which
+    transport that is used.
+*/
+
+/*!
+    \fn bool LabToolTransport::open(bool quiet)
+
+    Opens the connection to the LabTool Hardware. The \a quiet parameter
+    controls how much is printed in the log. Returns true on success.
+*/
+
+/*!
+    \fn void LabToolTransport::close()
+
+    Closes the connection to the LabTool Hardware.
+*/
+
+/*!
+    \fn bool LabToolTransport::isVirtual()
+
+    Returns true if there is no real hardware behind this transport.
+*/
+
+/*!
+    \fn quint8 LabToolTransport::inEndpoint()
+
+    Returns the IN endpoint of the connection.
+*/
+
+/*!
+    \fn quint8 LabToolTransport::outEndpoint()
+
+    Returns the OUT endpoint of the connection.
+*/
+
+/*!
+    \fn int LabToolTransport::submitTransfer(libusb_transfer* transfer)
+
+    Submits the asynchronous \a transfer. The transfer's callback will be
+    called from \ref handleEvents when the transfer has completed, failed
+    or been cancelled. Returns LIBUSB_SUCCESS or a libusbx error code.
+*/
+
+/*!
+    \fn int LabToolTransport::cancelTransfer(libusb_transfer* transfer)
+
+    Cancels the previously submitted \a transfer. A successful cancellation
+    will result in a call to the transfer's callback with the status
+    LIBUSB_TRANSFER_CANCELLED.
+*/
+
+/*!
+    \fn int LabToolTransport::controlTransfer(quint8 requestType, quint8 request, quint16 value, quint16 index, unsigned char* data, quint16 length, unsigned int timeout)
+
+    Performs a synchronous control transfer with the same parameters as
+    \a libusb_control_transfer. The \a requestType, \a request, \a value and
+    \a index parameters form the setup packet. The \a data buffer of \a length
+    bytes is either sent or filled depending on the direction in \a requestType.
+    The \a timeout is in milliseconds.
+
+    Returns the number of transferred bytes or a libusbx error code.
+*/
+
+/*!
+    \fn int LabToolTransport::handleEvents(int timeout)
+
+    Handles pending events, waiting at most \a timeout milliseconds for
+    something to happen. All transfer callbacks are called from this function
+    so it must be called continuously from the thread that drives the
+    communication (see LabToolDeviceCommThread).
+
+    The wait ends as soon as a transfer completes or \ref wakeUp is called,
+    so a long \a timeout does not delay anything.
+*/
+
+/*!
+    \fn void LabToolTransport::wakeUp()
+
+    Makes a thread that is waiting in \ref handleEvents return as soon as
+    possible. Can be called from any thread.
+*/
+
+/*!
+    Creates the transport to use.
+
+    The virtual device is used if the \a LABTOOL_VIRTUAL_DEVICE environment
+    variable is set. The value is the number of captures per second that the
+    virtual device will deliver. A value of 0 makes it deliver the captures as
+    fast as possible. Without the variable a LabToolUsbTransport is created.
+*/
+LabToolTransport *LabToolTransport::createTransport()
+{
+    QByteArray rate = qgetenv("LABTOOL_VIRTUAL_DEVICE");
+    if (!rate.isEmpty()) {
+        return new LabToolVirtualTransport(rate.toDouble());
+    }
+
+    return new LabToolUsbTransport();
+}
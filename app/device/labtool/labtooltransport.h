@@ -0,0 +1,46 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLTRANSPORT_H
+#define LABTOOLTRANSPORT_H
+
+#include <QtGlobal>
+
+#include "libusbx/include/libusbx-1.0/libusb.h"
+
+class LabToolTransport
+{
+public:
+    virtual ~LabToolTransport() {}
+
+    virtual bool open(bool quiet) = 0;
+    virtual void close() = 0;
+
+    virtual bool isVirtual() = 0;
+    virtual quint8 inEndpoint() = 0;
+    virtual quint8 outEndpoint() = 0;
+
+    virtual int submitTransfer(libusb_transfer* transfer) = 0;
+    virtual int cancelTransfer(libusb_transfer* transfer) = 0;
+    virtual int controlTransfer(quint8 requestType, quint8 request, quint16 value,
+                                quint16 index, unsigned char* data, quint16 length,
+                                unsigned int timeout) = 0;
+    virtual int handleEvents(int timeout) = 0;
+    virtual void wakeUp() = 0;
+
+    static LabToolTransport* createTransport();
+};
+
+#endif // LABTOOLTRANSPORT_H
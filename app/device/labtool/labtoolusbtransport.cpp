@@ -0,0 +1,440 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtoolusbtransport.h"
+
+#include <QtDebug>
+#include <QVarLengthArray>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+/*!
+    The Vendor Identifier (VID) of the LabTool Hardware
+    Used when detecting if the hardware is connected to the computer or not.
+*/
+#define VENDORID                0x1fc9
+
+/*!
+    The Product Identifier (PID) of the LabTool Hardware.
+    Used when detecting if the hardware is connected to the computer or not.
+*/
+#define PRODUCTID               0x0018
+
+/*!
+    The number of the USB interface to use on the LabTool Hardware. As the hardware
+    only uses one interface this value is always 0.
+*/
+#define INTERFACENUM             0
+
+/*!
+    \class LabToolUsbTransport
+    \brief Connects to the LabTool Hardware using libusbx
+
+    \ingroup Device
+
+    The LabToolUsbTransport class is the LabToolTransport used when
+    talking to real LabTool Hardware. It is a thin layer on top of the
+    libusbx library (see http://libusbx.sourceforge.net/).
+
+    On Linux and Mac OS X the file descriptors of libusbx are polled
+    together with a wake-up pipe, see \ref handleEvents. On Windows the
+    file descriptors are emulated by libusbx and cannot be polled, so there
+    the wait in \ref handleEvents is limited to a short time instead.
+*/
+
+/*!
+    Constructs a transport that is not yet connected.
+*/
+LabToolUsbTransport::LabToolUsbTransport()
+{
+    mContext = NULL;
+    mDeviceHandle = NULL;
+    mEndpointIn = 0;
+    mEndpointOut = 0;
+
+#ifdef Q_OS_UNIX
+    if (::pipe(mWakeUpPipe) == 0) {
+        ::fcntl(mWakeUpPipe[0], F_SETFL, O_NONBLOCK);
+        ::fcntl(mWakeUpPipe[1], F_SETFL, O_NONBLOCK);
+    } else {
+        mWakeUpPipe[0] = -1;
+        mWakeUpPipe[1] = -1;
+    }
+#endif
+}
+
+/*!
+    Closes the connection and closes down the USB library.
+*/
+LabToolUsbTransport::~LabToolUsbTransport()
+{
+    close();
+    if (mContext != NULL)
+    {
+        libusb_exit(mContext);
+        mContext = NULL;
+    }
+
+#ifdef Q_OS_UNIX
+    if (mWakeUpPipe[0] != -1) {
+        ::close(mWakeUpPipe[0]);
+        ::close(mWakeUpPipe[1]);
+    }
+#endif
+}
+
+/*!
+    Attempts to open a LabTool Hardware through the libusbx
+    library. The \a quiet parameter controls how much is printed in
+    the log.
+    Returns true if the device was opened or if already open.
+*/
+bool LabToolUsbTransport::open(bool quiet)
+{
+    if (mDeviceHandle != NULL)
+    {
+        return true;
+    }
+
+    if (!quiet)
+    {
+        const struct libusb_version* version = libusb_get_version();
+        qDebug("Using libusbx v%d.%d.%d.%d", version->major, version->minor, version->micro, version->nano);
+        qDebug("Initializing library...");
+    }
+
+    if (mContext == NULL)
+    {
+        int r = libusb_init(&mContext);
+        if (r != LIBUSB_SUCCESS)
+        {
+            qDebug("Failed to initialize libusb, got error %s", libusb_error_name(r));
+            mContext = NULL;
+            return false;
+        }
+    }
+
+    mDeviceHandle = libusb_open_device_with_vid_pid(mContext, VENDORID, PRODUCTID);
+    if (mDeviceHandle == NULL) {
+        if (!quiet)
+        {
+            qDebug("Failed to open device %04X:%04X", VENDORID, PRODUCTID);
+        }
+        return false;
+    }
+
+    int ret = libusb_claim_interface(mDeviceHandle, INTERFACENUM);
+    if (ret != LIBUSB_SUCCESS) {
+        if (!quiet)
+        {
+            qDebug("Failed to claim device %04X:%04X, got error %s", VENDORID, PRODUCTID, libusb_error_name(ret));
+        }
+        libusb_close(mDeviceHandle);
+        mDeviceHandle = NULL;
+        return false;
+    }
+
+    qDebug("Opened device %04X:%04X", VENDORID, PRODUCTID);
+
+    probe();
+
+    return true;
+}
+
+/*!
+    Closes the USB connection. The libusbx remains initialized.
+*/
+void LabToolUsbTransport::close()
+{
+    if (mDeviceHandle != NULL)
+    {
+        /* make sure other programs can still access this device */
+        /* release the interface and close the device */
+        //qDebug("Releasing interface %d...", INTERFACENUM);
+        libusb_release_interface(mDeviceHandle, INTERFACENUM);
+        qDebug("Closing device...");
+        libusb_close(mDeviceHandle);
+        mDeviceHandle = NULL;
+    }
+}
+
+/*!
+    Submits the \a transfer to libusbx after assigning it to the opened device.
+*/
+int LabToolUsbTransport::submitTransfer(libusb_transfer *transfer)
+{
+    if (mDeviceHandle == NULL)
+    {
+        return LIBUSB_ERROR_NO_DEVICE;
+    }
+    transfer->dev_handle = mDeviceHandle;
+    return libusb_submit_transfer(transfer);
+}
+
+/*!
+    Asks libusbx to cancel the \a transfer.
+*/
+int LabToolUsbTransport::cancelTransfer(libusb_transfer *transfer)
+{
+    return libusb_cancel_transfer(transfer);
+}
+
+/*!
+    Performs a synchronous control transfer, see \a libusb_control_transfer
+    for a description of the \a requestType, \a request, \a value, \a index,
+    \a data, \a length and \a timeout parameters.
+*/
+int LabToolUsbTransport::controlTransfer(quint8 requestType, quint8 request, quint16 value, quint16 index, unsigned char *data, quint16 length, unsigned int timeout)
+{
+    if (mDeviceHandle == NULL)
+    {
+        return LIBUSB_ERROR_NO_DEVICE;
+    }
+    return libusb_control_transfer(mDeviceHandle, requestType, request, value, index, data, length, timeout);
+}
+
+/*!
+    Drives libusbx, waiting at most \a timeout milliseconds for an event.
+
+    On Linux and Mac OS X this thread takes the libusbx event lock and polls
+    the file descriptors of libusbx together with the wake-up pipe (see
+    \ref wakeUp). The events are then handled with a zero timeout. If another
+    thread is already handling events (e.g. a synchronous control transfer
+    from the UI thread) this thread waits for that thread to finish instead.
+
+    On Windows \a libusb_handle_events_timeout is used, but never with a
+    timeout longer than MaxEventWait milliseconds.
+*/
+int LabToolUsbTransport::handleEvents(int timeout)
+{
+    timeval tv;
+
+#ifdef Q_OS_UNIX
+    if (mWakeUpPipe[0] != -1) {
+        if (libusb_try_lock_events(mContext) != 0) {
+            // Another thread is handling the events
+            tv.tv_sec = timeout / 1000;
+            tv.tv_usec = (timeout % 1000) * 1000;
+            libusb_lock_event_waiters(mContext);
+            if (libusb_event_handler_active(mContext)) {
+                libusb_wait_for_event(mContext, &tv);
+            }
+            libusb_unlock_event_waiters(mContext);
+            return LIBUSB_SUCCESS;
+        }
+
+        if (!libusb_event_handling_ok(mContext)) {
+            // A device is being closed
+            libusb_unlock_events(mContext);
+            return LIBUSB_SUCCESS;
+        }
+
+        QVarLengthArray<pollfd, 8> fds;
+        pollfd wake;
+        wake.fd = mWakeUpPipe[0];
+        wake.events = POLLIN;
+        wake.revents = 0;
+        fds.append(wake);
+
+        const libusb_pollfd** usbfds = libusb_get_pollfds(mContext);
+        if (usbfds != NULL) {
+            for (int i = 0; usbfds[i] != NULL; i++) {
+                pollfd fd;
+                fd.fd = usbfds[i]->fd;
+                fd.events = usbfds[i]->events;
+                fd.revents = 0;
+                fds.append(fd);
+            }
+            free((void*)usbfds);
+        }
+
+        // Transfer timeouts are handled by libusbx, but only if it gets
+        // the chance to (not needed if it uses a timerfd)
+        if (libusb_get_next_timeout(mContext, &tv) == 1) {
+            timeout = qMin(timeout, (int)(tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000));
+        }
+
+        ::poll(fds.data(), fds.size(), timeout);
+
+        if (fds[0].revents & POLLIN) {
+            char buf[16];
+            while (::read(mWakeUpPipe[0], buf, sizeof(buf)) > 0) {
+            }
+        }
+
+        tv.tv_sec = 0;
+        tv.tv_usec = 0;
+        int r = libusb_handle_events_locked(mContext, &tv);
+        libusb_unlock_events(mContext);
+        return r;
+    }
+#endif
+
+    timeout = qMin(timeout, (int)MaxEventWait);
+    tv.tv_sec = timeout / 1000;
+    tv.tv_usec = (timeout % 1000) * 1000;
+
+    return libusb_handle_events_timeout(mContext, &tv);
+}
+
+/*!
+    Makes the thread waiting in \ref handleEvents return. On Windows this
+    does nothing as the wait there is short anyway.
+*/
+void LabToolUsbTransport::wakeUp()
+{
+#ifdef Q_OS_UNIX
+    if (mWakeUpPipe[1] != -1) {
+        char c = 0;
+        if (::write(mWakeUpPipe[1], &c, 1) < 0) {
+            // The pipe is full which means that a wake-up is already pending
+        }
+    }
+#endif
+}
+
+/*!
+    Retrieves the USB descriptors from the connected LabTool Hardware and
+    writes them to the log. The endpoints to use are taken from the
+    configuration descriptor.
+*/
+void LabToolUsbTransport::probe()
+{
+    static bool alreadyProbed = false; // prevents printing everyting everytime
+    libusb_device *dev;
+    struct libusb_config_descriptor *conf_desc;
+    const struct libusb_endpoint_descriptor *endpoint;
+    const struct libusb_interface_descriptor *altsetting;
+    int i, j, k, r;
+    int nb_ifaces;
+    uint8_t string_index[3];         // indexes of the string descriptors
+    mEndpointIn = mEndpointOut = 0;  // default IN and OUT endpoints
+
+    dev = libusb_get_device(mDeviceHandle);
+    if (!alreadyProbed) {
+        uint8_t bus, port_path[8];
+        struct libusb_device_descriptor dev_desc;
+        const char* speed_name[5] = { "Unknown", "1.5 Mbit/s (USB LowSpeed)", "12 Mbit/s (USB FullSpeed)",
+            "480 Mbit/s (USB HighSpeed)", "5000 Mbit/s (USB SuperSpeed)"};
+
+        bus = libusb_get_bus_number(dev);
+        r = libusb_get_port_path(NULL, dev, port_path, sizeof(port_path));
+        if (r > 0) {
+            qDebug("[Probe] bus: %d, port path from HCD: %d", bus, port_path[0]);
+            for (i=1; i<r; i++) {
+                qDebug("->%d", port_path[i]);
+            }
+        }
+        r = libusb_get_device_speed(dev);
+        if ((r<0) || (r>4)) r=0;
+        qDebug("[Probe] speed: %s", speed_name[r]);
+
+        qDebug("\n[Probe] Reading device descriptor:");
+        r = libusb_get_device_descriptor(dev, &dev_desc);
+        if (r != LIBUSB_SUCCESS) {
+            qCritical("Failed to get device descriptor, got error %s", libusb_error_name(r));
+            return;
+        }
+        qDebug("[Probe]             length: %d", dev_desc.bLength);
+        qDebug("[Probe]       device class: %d", dev_desc.bDeviceClass);
+        qDebug("[Probe]                S/N: %d", dev_desc.iSerialNumber);
+        qDebug("[Probe]            VID:PID: %04X:%04X", dev_desc.idVendor, dev_desc.idProduct);
+        qDebug("[Probe]          bcdDevice: %04X", dev_desc.bcdDevice);
+        qDebug("[Probe]    iMan:iProd:iSer: %d:%d:%d", dev_desc.iManufacturer, dev_desc.iProduct, dev_desc.iSerialNumber);
+        qDebug("[Probe]           nb confs: %d", dev_desc.bNumConfigurations);
+
+        // Copy the string descriptors for easier parsing
+        string_index[0] = dev_desc.iManufacturer;
+        string_index[1] = dev_desc.iProduct;
+        string_index[2] = dev_desc.iSerialNumber;
+
+        qDebug("\n[Probe] Reading configuration descriptors:");
+    }
+
+    r = libusb_get_config_descriptor(dev, 0, &conf_desc);
+    if (r != LIBUSB_SUCCESS) {
+        qCritical("[Probe] Failed to get device descriptor, got error %s", libusb_error_name(r));
+        return;
+    }
+    nb_ifaces = conf_desc->bNumInterfaces;
+    if (!alreadyProbed) {
+        qDebug("[Probe]              nb interfaces: %d", nb_ifaces);
+    }
+    for (i=0; i<nb_ifaces; i++) {
+        if (!alreadyProbed) {
+            qDebug("[Probe]               interface[%d]: id = %d", i,
+                conf_desc->interface[i].altsetting[0].bInterfaceNumber);
+        }
+        for (j=0; j<conf_desc->interface[i].num_altsetting; j++) {
+            altsetting = &conf_desc->interface[i].altsetting[j];
+            if (!alreadyProbed) {
+                qDebug("[Probe] interface[%d].altsetting[%d]: num endpoints = %d",
+                    i, j, altsetting->bNumEndpoints);
+                qDebug("[Probe]    Class.SubClass.Protocol: %02X.%02X.%02X",
+                    altsetting->bInterfaceClass,
+                    altsetting->bInterfaceSubClass,
+                    altsetting->bInterfaceProtocol);
+            }
+            for (k=0; k<altsetting->bNumEndpoints; k++) {
+                endpoint = &altsetting->endpoint[k];
+                if (!alreadyProbed) {
+                    qDebug("[Probe]        endpoint[%d].address: %02X", k, endpoint->bEndpointAddress);
+                }
+
+                // Use the first interrupt or bulk IN/OUT endpoints as default for testing
+                if ((endpoint->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) & (LIBUSB_TRANSFER_TYPE_BULK | LIBUSB_TRANSFER_TYPE_INTERRUPT)) {
+                    if (endpoint->bEndpointAddress & LIBUSB_ENDPOINT_IN) {
+                        if (!mEndpointIn) {
+                            mEndpointIn = endpoint->bEndpointAddress;
+                        }
+                    } else {
+                        if (!mEndpointOut) {
+                            mEndpointOut = endpoint->bEndpointAddress;
+                        }
+                    }
+                }
+                if (!alreadyProbed) {
+                    qDebug("[Probe]            max packet size: %04X", endpoint->wMaxPacketSize);
+                    qDebug("[Probe]           polling interval: %02X", endpoint->bInterval);
+                }
+            }
+        }
+    }
+    libusb_free_config_descriptor(conf_desc);
+
+    if (!alreadyProbed) {
+        char string[128];
+        qDebug("\n[Probe] Reading string descriptors:");
+        for (i=0; i<3; i++) {
+            if (string_index[i] == 0) {
+                continue;
+            }
+            if (libusb_get_string_descriptor_ascii(mDeviceHandle, string_index[i], (unsigned char*)string, 128) >= 0) {
+                qDebug("[Probe]    String (0x%02X): \"%s\"", string_index[i], string);
+            }
+        }
+        // Read the OS String Descriptor
+        if (libusb_get_string_descriptor_ascii(mDeviceHandle, 0xEE, (unsigned char*)string, 128) >= 0) {
+            qDebug("[Probe]    String (0x%02X): \"%s\"", 0xEE, string);
+        }
+
+        alreadyProbed = true;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLUSBTRANSPORT_H
+#define LABTOOLUSBTRANSPORT_H
+
+#include "labtooltransport.h"
+
+class LabToolUsbTransport : public LabToolTransport
+{
+    enum Constants {
+        MaxEventWait = 50
+    };
+
+public:
+    LabToolUsbTransport();
+    ~LabToolUsbTransport();
+
+    bool open(bool quiet);
+    void close();
+
+    bool isVirtual() { return false; }
+    quint8 inEndpoint() { return mEndpointIn; }
+    quint8 outEndpoint() { return mEndpointOut; }
+
+    int submitTransfer(libusb_transfer* transfer);
+    int cancelTransfer(libusb_transfer* transfer);
+    int controlTransfer(quint8 requestType, quint8 request, quint16 value,
+                        quint16 index, unsigned char* data, quint16 length,
+                        unsigned int timeout);
+    int handleEvents(int timeout);
+    void wakeUp();
+
+private:
+    void probe();
+
+    libusb_context*       mContext;
+    libusb_device_handle* mDeviceHandle;
+    quint8                mEndpointIn;
+    quint8                mEndpointOut;
+#ifdef Q_OS_UNIX
+    int                   mWakeUpPipe[2];
+#endif
+};
+
+#endif // LABTOOLUSBTRANSPORT_H
@@ -0,0 +1,778 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtoolvirtualtransport.h"
+#include "labtooldevicetransfer.h"
+#include "capture_vadc_pack.h"
+
+#include <QtDebug>
+#include <QMutexLocker>
+#include <qmath.h>
+
+/*!
+    Commands sent as USB Control Requests. Same values as
+    \a control_requests_t in labtooldevicecomm.cpp.
+    \private
+*/
+typedef enum
+{
+  VREQ_GetPll1Speed       = 1,
+  VREQ_Ping               = 2,
+  VREQ_StopCapture        = 3,
+  VREQ_StopGenerator      = 4,
+  VREQ_GetStoredCalibData = 5,
+  VREQ_GetTelemetry       = 6
+} virtual_control_requests_t;
+
+/*!
+    Status codes from the firmware's error_codes.h that the virtual
+    device can report.
+    \private
+*/
+typedef enum
+{
+  VSTATUS_OK                          = 0,
+  VSTATUS_ERR                         = 1,
+  VSTATUS_ERR_UNSUPPORTED_SAMPLE_RATE = 2,
+  VSTATUS_ERR_CFG_NO_CHANNELS_ENABLED = 11
+} virtual_status_t;
+
+/*!
+    The default calibration data from the firmware (see calibrate.c),
+    in the same order as the \a calib_result structure in
+    LabToolCalibrationData. The first word is replaced by the protocol
+    marker when sent.
+    \private
+*/
+static const int DefaultCalibration[] = {
+    0, 0x00dead00, 0x00dead00,
+    256, 512, 768,
+    2500, 0, -2500,
+    2500, 0, -2500,
+    -80, -200, -400, -800, -2000, -2500, -2500, -2500,
+     80,  200,  400,  800,  2000,  2500,  2500,  2500,
+    2700, 2900, 3050, 3250, 3050, 2700, 2400, 2200,
+    2500, 2900, 3000, 3150, 3050, 2700, 2400, 2200,
+    570, 830, 850, 830, 1000, 1400, 1700, 1900,
+    500, 750, 850, 840, 1000, 1400, 1700, 1900,
+};
+
+/*!
+    The samples of DIO_0 .. DIO_4 in one 32-bit word of digital data. They
+    are the same in all words as the lowest bits of the counter (see
+    \ref LabToolVirtualTransport::appendDigitalData) repeat every 32 samples.
+    \private
+*/
+static const quint32 LowBitPatterns[] = {
+    0xAAAAAAAA, 0xCCCCCCCC, 0xF0F0F0F0, 0xFF00FF00, 0xFFFF0000
+};
+
+static void appendWord(QByteArray &data, quint32 value)
+{
+    data.append((char)((value >>  0) & 0xff));
+    data.append((char)((value >>  8) & 0xff));
+    data.append((char)((value >> 16) & 0xff));
+    data.append((char)((value >> 24) & 0xff));
+}
+
+/*!
+    \class LabToolVirtualTransport
+    \brief An in-process LabTool Hardware
+
+    \ingroup Device
+
+    The LabToolVirtualTransport class replaces the USB connection with a
+    virtual device that implements the same protocol as the firmware. All
+    commands are framed the same way, the capture configuration is parsed
+    and each capture is answered with a \a CMD_CAP_SAMPLES header followed by
+    the digital and analog data in the formats produced by the SGPIO and VADC
+    in the firmware. This makes it possible to run (and measure) the complete
+    capture pipeline in LabToolDeviceComm and LabToolCaptureDevice without any
+    hardware.
+
+    The virtual device is enabled with the \a LABTOOL_VIRTUAL_DEVICE
+    environment variable, see LabToolTransport::createTransport().
+
+    The captured signals are:
+    - Digital: A binary counter that is 0 at the trigger, DIO_0 being the
+      least significant bit. All channels have a falling edge at the
+      trigger, except for those configured to trigger on a rising edge which
+      are inverted.
+    - Analog: A sine wave around the trigger level with a rising crossing
+      (or falling if configured so) at the trigger. A1 has twice the frequency
+      of A0.
+
+    The performance counters (see telemetry.h in the firmware) only count
+    the captures and the sent bytes as the virtual device has no interrupts
+    or USB buffers.
+
+    Each capture uses the sample buffers of the firmware, 128KB when only
+    digital or only analog signals are enabled and 64KB otherwise, so the
+    number of samples depends on the number of enabled signals.
+
+    The transfers are completed and their callbacks called from
+    \ref handleEvents, just like libusbx does, which means that the
+    thread calling \ref handleEvents (LabToolDeviceCommThread) behaves
+    the same for both real and virtual hardware.
+*/
+
+/*!
+    Constructs a virtual device that delivers at most \a capturesPerSecond
+    captures every second. A rate of 0 (or below) means as fast as possible.
+*/
+LabToolVirtualTransport::LabToolVirtualTransport(double capturesPerSecond)
+{
+    mOpen = false;
+    mCapturesPerSecond = capturesPerSecond;
+    mPayloadCommand = 0;
+    mPayloadSize = 0;
+    mLastCaptureTime = 0;
+    mWakeUpRequested = false;
+    mCaptures = 0;
+    mBytesSent = 0;
+
+    mConfigured = false;
+    mSampleRate = 0;
+    mPostFill = 0;
+    mDigitalChannels = 0;
+    mDigitalTriggers = 0;
+    mDigitalTriggerSetup = 0;
+    mAnalogChannels = 0;
+    mAnalogTriggers = 0;
+    mAnalogTriggerSetup = 0;
+
+    for (int i = 0; i < SineTableSize; i++) {
+        mSineTable[i] = qRound(2047 * qSin(2 * M_PI * i / SineTableSize));
+    }
+}
+
+/*!
+    Opens the virtual device. The \a quiet parameter is ignored as
+    the virtual device is always available.
+*/
+bool LabToolVirtualTransport::open(bool quiet)
+{
+    (void)quiet;
+
+    QMutexLocker locker(&mMutex);
+    if (!mOpen) {
+        mOpen = true;
+        mClock.start();
+        if (mCapturesPerSecond > 0) {
+            qDebug("Opened virtual device, %g captures/s", mCapturesPerSecond);
+        } else {
+            qDebug("Opened virtual device, captures as fast as possible");
+        }
+    }
+    return true;
+}
+
+/*!
+    Closes the virtual device and forgets all pending transfers.
+*/
+void LabToolVirtualTransport::close()
+{
+    QMutexLocker locker(&mMutex);
+    mOpen = false;
+    mPending.clear();
+    mPackets.clear();
+    mPayloadSize = 0;
+}
+
+/*!
+    Queues the \a transfer. It is completed by \ref handleEvents.
+*/
+int LabToolVirtualTransport::submitTransfer(libusb_transfer *transfer)
+{
+    QMutexLocker locker(&mMutex);
+    if (!mOpen) {
+        return LIBUSB_ERROR_NO_DEVICE;
+    }
+
+    PendingTransfer pending;
+    pending.transfer = transfer;
+    pending.submitted = mClock.elapsed();
+    pending.cancelled = false;
+    mPending.append(pending);
+
+    mWakeUp.wakeAll();
+    return LIBUSB_SUCCESS;
+}
+
+/*!
+    Cancels the \a transfer if it is still pending. The callback will
+    be called with the LIBUSB_TRANSFER_CANCELLED status from
+    \ref handleEvents.
+*/
+int LabToolVirtualTransport::cancelTransfer(libusb_transfer *transfer)
+{
+    QMutexLocker locker(&mMutex);
+    for (int i = 0; i < mPending.size(); i++) {
+        if (mPending.at(i).transfer == transfer && !mPending.at(i).cancelled) {
+            mPending[i].cancelled = true;
+            mWakeUp.wakeAll();
+            return LIBUSB_SUCCESS;
+        }
+    }
+    return LIBUSB_ERROR_NOT_FOUND;
+}
+
+/*!
+    Answers the vendor specific control request \a request. The \a requestType,
+    \a value and \a index parameters are ignored. The answer (if any) is written
+    to \a data which can hold \a length bytes. The \a timeout is ignored as the
+    request is answered directly.
+*/
+int LabToolVirtualTransport::controlTransfer(quint8 requestType, quint8 request, quint16 value, quint16 index, unsigned char *data, quint16 length, unsigned int timeout)
+{
+    (void)requestType;
+    (void)value;
+    (void)index;
+    (void)timeout;
+
+    QMutexLocker locker(&mMutex);
+    if (!mOpen) {
+        return LIBUSB_ERROR_NO_DEVICE;
+    }
+
+    return answerControlRequest(request, data, length);
+}
+
+/*!
+    Answers the vendor specific control request \a request by writing the
+    answer (if any) to \a data which can hold \a length bytes. Returns the
+    size of the answer or a libusbx error code. Must be called with the
+    lock held.
+*/
+int LabToolVirtualTransport::answerControlRequest(quint8 request, unsigned char *data, quint16 length)
+{
+    switch (request) {
+    case VREQ_GetPll1Speed:
+    {
+        QByteArray speed;
+        appendWord(speed, 204000000);
+        if (length < speed.size()) {
+            return LIBUSB_ERROR_OVERFLOW;
+        }
+        memcpy(data, speed.constData(), speed.size());
+        return speed.size();
+    }
+
+    case VREQ_Ping:
+    case VREQ_StopGenerator:
+        return LIBUSB_SUCCESS;
+
+    case VREQ_StopCapture:
+        // Throw away the captured samples that has not been read yet.
+        // The pending IN transfer will be cancelled by the caller.
+        mPackets.clear();
+        return LIBUSB_SUCCESS;
+
+    case VREQ_GetStoredCalibData:
+    {
+        QByteArray calib;
+        appendCalibrationData(calib);
+        if (length < calib.size()) {
+            return LIBUSB_ERROR_OVERFLOW;
+        }
+        memcpy(data, calib.constData(), calib.size());
+        return calib.size();
+    }
+
+    case VREQ_GetTelemetry:
+    {
+        QByteArray counters;
+        appendWord(counters, 204000000); // coreClock
+        appendWord(counters, mCaptures);
+        for (int i = 0; i < 6; i++) {
+            appendWord(counters, 0);     // interrupts and VADC
+        }
+        appendWord(counters, mBytesSent);
+        appendWord(counters, 0);         // usbRetries
+        appendWord(counters, 0);         // usbFailures
+        if (length < counters.size()) {
+            return LIBUSB_ERROR_OVERFLOW;
+        }
+        memcpy(data, counters.constData(), counters.size());
+        return counters.size();
+    }
+
+    default:
+        return LIBUSB_ERROR_PIPE;
+    }
+}
+
+/*!
+    Completes all transfers that are done and calls their callbacks. Waits up
+    to \a timeout milliseconds for at least one transfer to complete or for
+    a call to \ref wakeUp.
+
+    The callbacks are called without holding the lock so that they can
+    submit new transfers.
+*/
+int LabToolVirtualTransport::handleEvents(int timeout)
+{
+    QList<libusb_transfer*> done;
+
+    mMutex.lock();
+    qint64 deadline = mClock.elapsed() + timeout;
+    while (mOpen) {
+        qint64 now = mClock.elapsed();
+
+        // The IN transfers are served in the order they were submitted, as
+        // they are on the real hardware's single IN endpoint
+        bool firstIn = true;
+        for (int i = 0; i < mPending.size(); ) {
+            bool isIn = (mPending.at(i).transfer->endpoint & LIBUSB_ENDPOINT_IN) != 0;
+            if (completeTransfer(mPending[i], isIn && firstIn, now)) {
+                done.append(mPending.at(i).transfer);
+                mPending.removeAt(i);
+            } else {
+                if (isIn) {
+                    firstIn = false;
+                }
+                i++;
+            }
+        }
+
+        if (!done.isEmpty() || now >= deadline || mWakeUpRequested) {
+            break;
+        }
+
+        // Sleep until the next packet is ready, a transfer times out
+        // or something new is submitted
+        qint64 next = deadline;
+        if (!mPackets.isEmpty()) {
+            next = qMin(next, mPackets.first().readyTime);
+        }
+        foreach(PendingTransfer pending, mPending) {
+            if (pending.transfer->timeout != 0) {
+                next = qMin(next, pending.submitted + (qint64)pending.transfer->timeout);
+            }
+        }
+        mWakeUp.wait(&mMutex, (unsigned long)qMax((qint64)1, next - now));
+    }
+    mWakeUpRequested = false;
+    mMutex.unlock();
+
+    foreach(libusb_transfer* transfer, done) {
+        transfer->callback(transfer);
+    }
+
+    return mOpen ? LIBUSB_SUCCESS : LIBUSB_ERROR_NO_DEVICE;
+}
+
+/*!
+    Makes the thread waiting in \ref handleEvents return.
+*/
+void LabToolVirtualTransport::wakeUp()
+{
+    QMutexLocker locker(&mMutex);
+    mWakeUpRequested = true;
+    mWakeUp.wakeAll();
+}
+
+/*!
+    Attempts to complete the \a pending transfer at time \a now. The
+    \a firstIn parameter is true if this is the oldest pending IN transfer,
+    which is the only one that may receive data.
+
+    Returns true if the transfer is done, with the status and actual length
+    set in the transfer.
+*/
+bool LabToolVirtualTransport::completeTransfer(PendingTransfer &pending, bool firstIn, qint64 now)
+{
+    libusb_transfer* transfer = pending.transfer;
+
+    if (pending.cancelled) {
+        transfer->status = LIBUSB_TRANSFER_CANCELLED;
+        transfer->actual_length = 0;
+        return true;
+    }
+
+    if (transfer->type == LIBUSB_TRANSFER_TYPE_CONTROL) {
+        // Control requests are answered immediately, as in controlTransfer()
+        libusb_control_setup* setup = libusb_control_transfer_get_setup(transfer);
+        int r = answerControlRequest(setup->bRequest,
+                                     libusb_control_transfer_get_data(transfer),
+                                     libusb_le16_to_cpu(setup->wLength));
+        if (r < 0) {
+            transfer->status = LIBUSB_TRANSFER_STALL;
+            transfer->actual_length = 0;
+        } else {
+            transfer->status = LIBUSB_TRANSFER_COMPLETED;
+            transfer->actual_length = r;
+        }
+        return true;
+    }
+
+    if ((transfer->endpoint & LIBUSB_ENDPOINT_IN) == 0) {
+        // OUT transfers are received by the device immediately
+        handleOutData(transfer->buffer, transfer->length);
+        transfer->status = LIBUSB_TRANSFER_COMPLETED;
+        transfer->actual_length = transfer->length;
+        return true;
+    }
+
+    if (firstIn && !mPackets.isEmpty() && mPackets.first().readyTime <= now) {
+        Packet packet = mPackets.takeFirst();
+        int size = qMin(packet.data.size(), transfer->length);
+        memcpy(transfer->buffer, packet.data.constData(), size);
+        transfer->actual_length = size;
+        if (packet.data.size() > transfer->length) {
+            transfer->status = LIBUSB_TRANSFER_OVERFLOW;
+        } else {
+            transfer->status = LIBUSB_TRANSFER_COMPLETED;
+        }
+        return true;
+    }
+
+    if (transfer->timeout != 0 && now - pending.submitted >= (qint64)transfer->timeout) {
+        transfer->status = LIBUSB_TRANSFER_TIMED_OUT;
+        transfer->actual_length = 0;
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+    Handles \a size bytes of \a data sent by the host. It is either a command
+    header or the payload belonging to the previous command header.
+*/
+void LabToolVirtualTransport::handleOutData(const quint8 *data, int size)
+{
+    if (mPayloadSize > 0) {
+        int cmd = mPayloadCommand;
+        mPayloadSize = 0;
+        handleCommand(cmd, data, size);
+        return;
+    }
+
+    if (size < 4 || data[3] != 0xea) {
+        qDebug("Virtual device: Got invalid command header");
+        return;
+    }
+
+    int payloadSize = data[0] | (data[1] << 8);
+    if (payloadSize > 0) {
+        // wait for the payload
+        mPayloadCommand = data[2];
+        mPayloadSize = payloadSize;
+    } else {
+        handleCommand(data[2], NULL, 0);
+    }
+}
+
+/*!
+    Executes the command \a cmd with its \a payload of \a size bytes.
+*/
+void LabToolVirtualTransport::handleCommand(int cmd, const quint8 *payload, int size)
+{
+    switch (cmd) {
+    case LabToolDeviceTransfer::CMD_CAP_CONFIGURE:
+        sendResponse(cmd, configureCapture(payload, size));
+        break;
+
+    case LabToolDeviceTransfer::CMD_CAP_RUN:
+        if (!mConfigured) {
+            sendResponse(cmd, VSTATUS_ERR);
+            break;
+        }
+        sendResponse(cmd, VSTATUS_OK);
+        startCapture();
+        break;
+
+    case LabToolDeviceTransfer::CMD_CAL_ANALOG_IN:
+    {
+        sendResponse(cmd, VSTATUS_OK);
+
+        // the measured result is the default calibration data
+        QByteArray result;
+        appendCalibrationData(result);
+        sendPacket(result, mClock.elapsed());
+        break;
+    }
+
+    default:
+        // The generator and the rest of the calibration commands
+        // have no visible effect
+        sendResponse(cmd, VSTATUS_OK);
+        break;
+    }
+}
+
+/*!
+    Queues the \a data to be read by the host at \a readyTime
+    (in milliseconds since the device was opened).
+*/
+void LabToolVirtualTransport::sendPacket(const QByteArray &data, qint64 readyTime)
+{
+    Packet packet;
+    packet.data = data;
+    packet.readyTime = readyTime;
+    mPackets.append(packet);
+}
+
+/*!
+    Queues the response to the command \a cmd with the given \a status.
+*/
+void LabToolVirtualTransport::sendResponse(int cmd, int status)
+{
+    QByteArray response;
+    response.append((char)status);
+    response.append((char)0);
+    response.append((char)cmd);
+    response.append((char)0xea);
+    sendPacket(response, mClock.elapsed());
+}
+
+/*!
+    Parses the capture configuration in \a payload of \a size bytes. The
+    payload has the \a capture_cfg_t format, see LabToolCaptureDevice.
+
+    Returns the status code to send to the host.
+*/
+int LabToolVirtualTransport::configureCapture(const quint8 *payload, int size)
+{
+    quint32 cfg[13];
+
+    mConfigured = false;
+    if (payload == NULL || size < (int)sizeof(cfg)) {
+        return VSTATUS_ERR;
+    }
+    memcpy(cfg, payload, sizeof(cfg));
+
+    // numEnabledSGPIO, numEnabledVADC, sampleRate and postFill
+    // followed by the sgpio and vadc structures
+    mSampleRate          = cfg[2];
+    mPostFill            = cfg[3];
+    mDigitalChannels     = (cfg[0] > 0) ? cfg[4] : 0;
+    mDigitalTriggers     = cfg[5];
+    mDigitalTriggerSetup = cfg[6];
+    mAnalogChannels      = (cfg[1] > 0) ? (cfg[7] & 0x3) : 0;
+    mAnalogTriggers      = cfg[8];
+    mAnalogTriggerSetup  = cfg[9];
+
+    if (mDigitalChannels == 0 && mAnalogChannels == 0) {
+        return VSTATUS_ERR_CFG_NO_CHANNELS_ENABLED;
+    }
+    if (mSampleRate == 0) {
+        return VSTATUS_ERR_UNSUPPORTED_SAMPLE_RATE;
+    }
+    if ((mPostFill & 0xff) > 100) {
+        mPostFill = (mPostFill & ~0xff) | 100;
+    }
+
+    mConfigured = true;
+    return VSTATUS_OK;
+}
+
+/*!
+    Makes one capture and queues the \a CMD_CAP_SAMPLES header and the
+    sample data. The data becomes available when the capture would have
+    completed on the real hardware, but not before the configured number
+    of captures per second allows it.
+*/
+void LabToolVirtualTransport::startCapture()
+{
+    int channelsToCopy = 0;
+    for (int i = 0; i < 32; i++) {
+        if (mDigitalChannels & (1<<i)) {
+            channelsToCopy = i + 1;
+        }
+    }
+    int numAnalog = 0;
+    for (int i = 0; i < 2; i++) {
+        if (mAnalogChannels & (1<<i)) {
+            numAnalog++;
+        }
+    }
+
+    // The sample buffer is shared between the SGPIO (one bit per
+    // channel) and the VADC (16 bits per channel). Only the 64KB AHB SRAM
+    // is used when both are enabled.
+    int bufferSize = (channelsToCopy == 0 || numAnalog == 0) ? FullBufferSize : BufferSize;
+    int bitsPerSample = channelsToCopy + 16*numAnalog;
+    int numSamples = ((bufferSize * 8 / bitsPerSample) / 32) * 32;
+
+    // The trigger is placed so that postFill percent of the samples are
+    // after the trigger, limited by the maximum number of samples after it
+    int postSamples = (int)(((qint64)numSamples * (mPostFill & 0xff)) / 100);
+    int triggerSample = ((numSamples - postSamples) / 32) * 32;
+    int maxPostSamples = (int)(mPostFill >> 8);
+    if (maxPostSamples > 0 && numSamples - triggerSample > maxPostSamples) {
+        numSamples = triggerSample + ((maxPostSamples + 31) / 32) * 32;
+    }
+
+    int triggerInfo = 0;
+    for (int i = 0; i < 32; i++) {
+        if (mDigitalTriggers & (1<<i)) {
+            triggerInfo = i;
+            break;
+        }
+    }
+
+    QByteArray data;
+    data.reserve((numSamples / 32) * channelsToCopy * 4 + numSamples * numAnalog * 2);
+    appendDigitalData(data, numSamples, triggerSample, channelsToCopy);
+    int digitalSize = data.size();
+    appendAnalogData(data, numSamples, triggerSample);
+    int analogSize = data.size() - digitalSize;
+
+    QByteArray header;
+    appendWord(header, 0xEA000000 | (LabToolDeviceTransfer::CMD_CAP_SAMPLES<<16) | VSTATUS_OK);
+    appendWord(header, digitalSize);
+    appendWord(header, analogSize);
+    appendWord(header, triggerInfo);
+    appendWord(header, (channelsToCopy > 0) ? triggerSample : 0);
+    appendWord(header, (numAnalog > 0) ? triggerSample : 0);
+    appendWord(header, (channelsToCopy > 0) ? (mDigitalChannels | (channelsToCopy << 16)) : 0);
+    appendWord(header, (numAnalog > 0) ? (mAnalogChannels | (numAnalog << 16)) : 0);
+
+    qint64 now = mClock.elapsed();
+    qint64 readyTime = now;
+    if (mCapturesPerSecond > 0) {
+        readyTime = now + (qint64)((1000.0 * numSamples) / mSampleRate);
+        readyTime = qMax(readyTime, mLastCaptureTime + (qint64)(1000.0 / mCapturesPerSecond));
+    }
+    mLastCaptureTime = readyTime;
+
+    mCaptures++;
+    mBytesSent = header.size() + data.size();
+
+    sendPacket(header, readyTime);
+    sendPacket(data, readyTime);
+}
+
+/*!
+    Appends \a numSamples digital samples to \a data in the SGPIO format:
+    One 32-bit word with 32 samples for each of the \a channelsToCopy
+    channels, then the next 32 samples and so on.
+
+    The samples form a counter which is 0 at \a triggerSample. As the
+    trigger is a multiple of 32, bits 5 and up of the counter are constant
+    within a word.
+*/
+void LabToolVirtualTransport::appendDigitalData(QByteArray &data, int numSamples, int triggerSample, int channelsToCopy)
+{
+    if (channelsToCopy == 0) {
+        return;
+    }
+
+    // channels triggering on a rising edge are inverted
+    quint32 invert = 0;
+    for (int ch = 0; ch < channelsToCopy; ch++) {
+        if ((mDigitalTriggers & (1<<ch)) && ((mDigitalTriggerSetup >> (2*ch)) & 0x3) == 1) {
+            invert |= (1<<ch);
+        }
+    }
+
+    int offset = data.size();
+    data.resize(offset + (numSamples / 32) * channelsToCopy * 4);
+    quint32* p = (quint32*)(data.data() + offset);
+
+    for (int w = 0; w < numSamples / 32; w++) {
+        quint32 counter = (quint32)(w*32 - triggerSample);
+        for (int ch = 0; ch < channelsToCopy; ch++) {
+            quint32 val = 0;
+            if (mDigitalChannels & (1<<ch)) {
+                if (ch < 5) {
+                    val = LowBitPatterns[ch];
+                } else {
+                    val = ((counter >> ch) & 1) ? 0xffffffff : 0;
+                }
+                if (invert & (1<<ch)) {
+                    val = ~val;
+                }
+            }
+            *p++ = val;
+        }
+    }
+}
+
+/*!
+    Appends \a numSamples analog samples for each enabled channel to \a data
+    in the VADC format: One 16-bit word per sample with the channel number in
+    bits 12-14 and the 12-bit value in bits 0-11. The channels are interleaved.
+    The samples are then packed in the same way as the firmware does before
+    sending them, see capture_vadc_pack.h.
+
+    The signal crosses the trigger level at \a triggerSample.
+*/
+void LabToolVirtualTransport::appendAnalogData(QByteArray &data, int numSamples, int triggerSample)
+{
+    int center[2];
+    int amplitude[2];
+    int channels[2];
+    int numChannels = 0;
+
+    for (int ch = 0; ch < 2; ch++) {
+        if ((mAnalogChannels & (1<<ch)) == 0) continue;
+
+        int setup = (mAnalogTriggerSetup >> (16*ch)) & 0xffff;
+        center[ch] = 2048;
+        if (mAnalogTriggers & (1<<ch)) {
+            center[ch] = qBound(256, setup & 0xfff, 4095-256);
+        }
+        amplitude[ch] = (qMin(center[ch], 4095 - center[ch]) * 9) / 10;
+        if ((mAnalogTriggers & (1<<ch)) && ((setup >> 14) & 0x3) == 1) {
+            // falling edge
+            amplitude[ch] = -amplitude[ch];
+        }
+        channels[numChannels++] = ch;
+    }
+
+    if (numChannels == 0) {
+        return;
+    }
+
+    QVector<quint16> samples(numSamples * numChannels);
+    quint16* p = samples.data();
+
+    for (int i = 0; i < numSamples; i++) {
+        for (int j = 0; j < numChannels; j++) {
+            int ch = channels[j];
+            int idx = (int)(((quint32)(i - triggerSample) << ch) & (SineTableSize - 1));
+            int val = center[ch] + (amplitude[ch] * mSineTable[idx]) / 2047;
+            *p++ = (quint16)((ch << 12) | qBound(0, val, 4095));
+        }
+    }
+
+    int32_t lastChannel = -1;
+    uint32_t pos = 0;
+    while (pos < (uint32_t)samples.size()) {
+        int offset = data.size();
+        uint32_t consumed = 0;
+        data.resize(offset + VADC_PACK_MAX_BLOCK_SIZE);
+        uint32_t size = cap_vadc_pack_Block(samples.constData() + pos, samples.size() - pos,
+                                            numChannels, &lastChannel,
+                                            (uint8_t*)data.data() + offset, &consumed);
+        data.resize(offset + size);
+        pos += consumed;
+    }
+}
+
+/*!
+    Appends the default calibration data to \a data, preceded by the
+    \a CMD_CAL_RESULT marker.
+*/
+void LabToolVirtualTransport::appendCalibrationData(QByteArray &data)
+{
+    appendWord(data, 0xEA000000 | (LabToolDeviceTransfer::CMD_CAL_RESULT<<16) | VSTATUS_OK);
+    for (int i = 1; i < CalibrationWords; i++) {
+        appendWord(data, (quint32)DefaultCalibration[i]);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLVIRTUALTRANSPORT_H
+#define LABTOOLVIRTUALTRANSPORT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "labtooltransport.h"
+
+class LabToolVirtualTransport : public LabToolTransport
+{
+public:
+    explicit LabToolVirtualTransport(double capturesPerSecond);
+
+    bool open(bool quiet);
+    void close();
+
+    bool isVirtual() { return true; }
+    quint8 inEndpoint() { return EndpointIn; }
+    quint8 outEndpoint() { return EndpointOut; }
+
+    int submitTransfer(libusb_transfer* transfer);
+    int cancelTransfer(libusb_transfer* transfer);
+    int controlTransfer(quint8 requestType, quint8 request, quint16 value,
+                        quint16 index, unsigned char* data, quint16 length,
+                        unsigned int timeout);
+    int handleEvents(int timeout);
+    void wakeUp();
+
+private:
+
+    enum Constants {
+        EndpointIn = 0x81,
+        EndpointOut = 0x01,
+        BufferSize = 0x10000,
+        FullBufferSize = 0x20000,
+        SineTableSize = 1024,
+        CalibrationWords = 60
+    };
+
+    struct PendingTransfer {
+        libusb_transfer* transfer;
+        qint64 submitted;
+        bool cancelled;
+    };
+
+    struct Packet {
+        QByteArray data;
+        qint64 readyTime;
+    };
+
+    bool mOpen;
+    double mCapturesPerSecond;
+    QElapsedTimer mClock;
+    QMutex mMutex;
+    QWaitCondition mWakeUp;
+    QList<PendingTransfer> mPending;
+    bool mWakeUpRequested;
+
+    // state of the virtual device
+    QList<Packet> mPackets;
+    int mPayloadCommand;
+    int mPayloadSize;
+    qint64 mLastCaptureTime;
+    quint32 mCaptures;
+    quint32 mBytesSent;
+
+    bool mConfigured;
+    quint32 mSampleRate;
+    quint32 mPostFill;
+    quint32 mDigitalChannels;
+    quint32 mDigitalTriggers;
+    quint32 mDigitalTriggerSetup;
+    quint32 mAnalogChannels;
+    quint32 mAnalogTriggers;
+    quint32 mAnalogTriggerSetup;
+
+    int mSineTable[SineTableSize];
+
+    int answerControlRequest(quint8 request, unsigned char* data, quint16 length);
+    bool completeTransfer(PendingTransfer &pending, bool firstIn, qint64 now);
+    void handleOutData(const quint8* data, int size);
+    void handleCommand(int cmd, const quint8* payload, int size);
+    void sendPacket(const QByteArray &data, qint64 readyTime);
+    void sendResponse(int cmd, int status);
+    int configureCapture(const quint8* payload, int size);
+    void startCapture();
+    void appendDigitalData(QByteArray &data, int numSamples, int triggerSample, int channelsToCopy);
+    void appendAnalogData(QByteArray &data, int numSamples, int triggerSample);
+    void appendCalibrationData(QByteArray &data);
+};
+
+#endif // LABTOOLVIRTUALTRANSPORT_H
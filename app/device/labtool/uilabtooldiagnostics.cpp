@@ -0,0 +1,178 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uilabtooldiagnostics.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+
+/*!
+    \class UiLabToolDiagnostics
+    \brief A dialog showing the performance counters of the LabTool Hardware.
+
+    \ingroup Device
+
+    The UiLabToolDiagnostics dialog shows the counters read with
+    LabToolDeviceComm::requestTelemetry(). They describe the last capture and
+    are used to find out why a capture at a high sample rate failed:
+
+    - Interrupts
+
+        The number of SGPIO and DMA terminal count (TC) interrupts and the
+        longest time spent in each handler. A handler that runs longer than
+        the time between two interrupts loses samples. Only some of the DMA
+        linked list items raise a TC interrupt, so the DMA count is not the
+        number of completed transfers.
+
+    - VADC
+
+        Samples missing in the analog data and empty entries read from the
+        VADC's FIFO.
+
+    - USB
+
+        The number of sent bytes, the number of times the firmware had to
+        wait for the host to read the data and the number of failed writes.
+
+    The dialog is not modal. LabToolCaptureDevice refreshes it after each
+    capture while it is visible.
+*/
+
+/*!
+    Constructs a new diagnostics dialog with the given \a parent.
+*/
+UiLabToolDiagnostics::UiLabToolDiagnostics(QWidget *parent) :
+    QDialog(parent)
+{
+    mDeviceComm = NULL;
+
+    setWindowTitle(tr("Hardware Diagnostics"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    QFormLayout* formLayout = new QFormLayout;
+
+    mStatus = new QLabel(this);
+    formLayout->addRow(mStatus);
+
+    const char* names[NumCounters] = {
+        QT_TR_NOOP("Captures: "),
+        QT_TR_NOOP("SGPIO interrupts: "),
+        QT_TR_NOOP("Longest SGPIO interrupt: "),
+        QT_TR_NOOP("DMA TC interrupts: "),
+        QT_TR_NOOP("Longest DMA interrupt: "),
+        QT_TR_NOOP("Skipped analog samples: "),
+        QT_TR_NOOP("Empty analog FIFO entries: "),
+        QT_TR_NOOP("USB bytes sent: "),
+        QT_TR_NOOP("USB buffer full: "),
+        QT_TR_NOOP("USB failed writes: ")
+    };
+
+    for (int i = 0; i < NumCounters; i++) {
+        mValues[i] = new QLabel("-", this);
+        formLayout->addRow(tr(names[i]), mValues[i]);
+    }
+
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(
+                QDialogButtonBox::Close,
+                Qt::Horizontal,
+                this);
+    QPushButton* refreshButton = buttonBox->addButton(tr("Refresh"), QDialogButtonBox::ActionRole);
+    buttonBox->setCenterButtons(true);
+
+    connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
+    connect(refreshButton, SIGNAL(clicked()), this, SLOT(refresh()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(buttonBox);
+
+    setLayout(verticalLayout);
+}
+
+/*!
+    Sets the \a comm used to read the counters. Can be NULL when there is
+    no connected hardware.
+*/
+void UiLabToolDiagnostics::setComm(LabToolDeviceComm *comm)
+{
+    if (comm == mDeviceComm) {
+        return;
+    }
+
+    if (mDeviceComm != NULL) {
+        mDeviceComm->disconnect(this);
+    }
+    mDeviceComm = comm;
+    if (mDeviceComm != NULL) {
+        connect(mDeviceComm, SIGNAL(telemetryReceived(bool)),
+                this, SLOT(handleTelemetry(bool)));
+    }
+}
+
+/*!
+    Requests the counters from the hardware. The dialog is updated when
+    they have arrived, see \ref handleTelemetry.
+*/
+void UiLabToolDiagnostics::refresh()
+{
+    if (mDeviceComm == NULL) {
+        mStatus->setText(tr("There is no connected hardware."));
+        return;
+    }
+    if (mDeviceComm->requestTelemetry() != LIBUSB_SUCCESS) {
+        mStatus->setText(tr("Failed to read the counters from the hardware."));
+    }
+}
+
+/*!
+    Updates the dialog with the counters requested in \ref refresh. The
+    \a ok parameter is false if they could not be read.
+*/
+void UiLabToolDiagnostics::handleTelemetry(bool ok)
+{
+    LabToolTelemetry t;
+
+    if (!ok || mDeviceComm == NULL || !mDeviceComm->telemetry(&t)) {
+        mStatus->setText(tr("Failed to read the counters from the hardware."));
+        return;
+    }
+
+    mStatus->setText(tr("Counters for the last capture:"));
+    mValues[Captures]->setText(QString::number(t.captures));
+    mValues[SgpioInterrupts]->setText(QString::number(t.sgpioIrqCount));
+    mValues[SgpioLongest]->setText(cyclesToString(t.sgpioIrqMaxCycles, t.coreClock));
+    mValues[DmaTcInterrupts]->setText(QString::number(t.dmaTcIrqCount));
+    mValues[DmaLongest]->setText(cyclesToString(t.dmaIrqMaxCycles, t.coreClock));
+    mValues[VadcSkipped]->setText(QString::number(t.vadcSkippedSamples));
+    mValues[VadcEmpty]->setText(QString::number(t.vadcEmptyMarkers));
+    mValues[UsbBytes]->setText(QString::number(t.usbBytesSent));
+    mValues[UsbRetries]->setText(QString::number(t.usbRetries));
+    mValues[UsbFailures]->setText(QString::number(t.usbFailures));
+}
+
+/*!
+    Returns the \a cycles as text, both as cycles and as a time based on
+    the \a coreClock (in Hz).
+*/
+QString UiLabToolDiagnostics::cyclesToString(quint32 cycles, quint32 coreClock)
+{
+    if (coreClock == 0) {
+        return tr("%1 cycles").arg(cycles);
+    }
+    return tr("%1 cycles (%2 us)").arg(cycles).arg((cycles * 1000000.0) / coreClock, 0, 'f', 2);
+}
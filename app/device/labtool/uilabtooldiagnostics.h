@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UILABTOOLDIAGNOSTICS_H
+#define UILABTOOLDIAGNOSTICS_H
+
+#include <QWidget>
+#include <QDialog>
+#include <QLabel>
+
+#include "labtooldevicecomm.h"
+
+class UiLabToolDiagnostics : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiLabToolDiagnostics(QWidget *parent = 0);
+
+    void setComm(LabToolDeviceComm* comm);
+
+signals:
+
+public slots:
+    void refresh();
+
+private slots:
+    void handleTelemetry(bool ok);
+
+private:
+
+    enum Counters {
+        Captures,
+        SgpioInterrupts,
+        SgpioLongest,
+        DmaTcInterrupts,
+        DmaLongest,
+        VadcSkipped,
+        VadcEmpty,
+        UsbBytes,
+        UsbRetries,
+        UsbFailures,
+        NumCounters
+    };
+
+    LabToolDeviceComm* mDeviceComm;
+    QLabel* mStatus;
+    QLabel* mValues[NumCounters];
+
+    static QString cyclesToString(quint32 cycles, quint32 coreClock);
+};
+
+#endif // UILABTOOLDIAGNOSTICS_H
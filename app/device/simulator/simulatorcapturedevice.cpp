@@ -16,13 +16,18 @@
 #include "simulatorcapturedevice.h"
 
 #include <QDebug>
+#include <QDateTime>
 
 #include <QtGlobal>
 #include <qmath.h>
 
+#include <algorithm>
+
 #include "generator/i2cgenerator.h"
 #include "generator/uartgenerator.h"
 #include "generator/spigenerator.h"
+#include "generator/digitaledgelist.h"
+#include "common/instrumentation.h"
 
 /*!
     \class SimulatorCaptureDevice
@@ -30,6 +35,12 @@
 
     \ingroup Device
 
+    The simulator can generate large captures (see the number of samples
+    in UiSimulatorConfigDialog) on up to 32 digital signals to test how the
+    rest of the application handles production sized data. All random data
+    comes from a SimulatorRandom generator so a capture can be reproduced by
+    selecting the same seed. The simulator can also replay previously
+    captured or loaded signal data in continuous mode.
 */
 
 /*!
@@ -43,6 +54,16 @@ SimulatorCaptureDevice::SimulatorCaptureDevice(QObject *parent) :
     mEndSampleIdx = 0;
     mUsedSampleRate = 1;
     mTriggerIdx = 0;
+    mCaptureNumber = 0;
+
+    mReplayValid = false;
+    mReplayLength = 0;
+    mReplayPos = 0;
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mFinishTimer = new QTimer(this);
+    mFinishTimer->setSingleShot(true);
+    connect(mFinishTimer, SIGNAL(timeout()), this, SLOT(handleFinishTimer()));
 
     for (int i = 0; i < MaxDigitalSignals; i++) {
         mDigitalSignals[i] = NULL;
@@ -114,18 +135,41 @@ void SimulatorCaptureDevice::configureBeforeStart(QWidget* parent)
         mConfigDialog = new UiSimulatorConfigDialog(parent);
     }
 
+    mConfigDialog->setNumSignals(mDigitalSignalList.size(), mAnalogSignalList.size());
     mConfigDialog->exec();
+
+    // a new capture session with the same seed gives the same signals
+    mCaptureNumber = 0;
 }
 
 void SimulatorCaptureDevice::start(int sampleRate)
 {
+    int finishDelay = 0;
+
+    Instrumentation::instance().beginCapture();
+    InstrumentationTimer timer("Generate signals");
+
     mEndSampleIdx = 0;
 
-    if (mConfigDialog != NULL) {
+    if (mConfigDialog != NULL && mConfigDialog->digitalFunction()
+            == UiSimulatorConfigDialog::DigitalFunction_Replay) {
+
+        mUsedSampleRate = sampleRate;
+        replaySignals();
+
+        // the replay rate only makes sense in continuous mode, but it
+        // doesn't hurt to also delay a single capture
+        finishDelay = 1000 / mConfigDialog->replayRate();
+    }
+    else if (mConfigDialog != NULL) {
+
+        // the replay will start with the data available at that time
+        invalidateReplay();
 
         mEndSampleIdx = numberOfSamples() - 1;
         mUsedSampleRate = sampleRate;
 
+        seedRandom();
 
         switch(mConfigDialog->digitalFunction()) {
         case UiSimulatorConfigDialog::DigitalFunction_Random:
@@ -140,6 +184,9 @@ void SimulatorCaptureDevice::start(int sampleRate)
         case UiSimulatorConfigDialog::DigitalFunction_SPI:
             generateSpiDigitalSignals();
             break;
+        case UiSimulatorConfigDialog::DigitalFunction_Replay:
+            // handled above
+            break;
 
         }
 
@@ -171,15 +218,21 @@ void SimulatorCaptureDevice::start(int sampleRate)
     mTriggerIdx = 0;
 #endif
 
-    emit captureFinished(true, "");
+    mCaptureNumber++;
+
+    // Report the result from the event loop. In continuous mode the next
+    // capture is started when the result is reported and a direct signal
+    // would start it recursively.
+    mFinishTimer->start(finishDelay);
 }
 
 void SimulatorCaptureDevice::stop()
 {
+    mFinishTimer->stop();
     emit captureFinished(true, "");
 }
 
-int SimulatorCaptureDevice::lastSampleIndex()
+SampleIndex SimulatorCaptureDevice::lastSampleIndex()
 {
     return mEndSampleIdx;
 }
@@ -197,6 +250,8 @@ QVector<int>* SimulatorCaptureDevice::digitalData(int signalId)
 
 void SimulatorCaptureDevice::setDigitalData(int signalId, QVector<int> data)
 {
+    invalidateReplay();
+
     if (signalId < MaxDigitalSignals) {
 
         if (mDigitalSignals[signalId] != NULL) {
@@ -229,6 +284,8 @@ QVector<double>* SimulatorCaptureDevice::analogData(int signalId)
 
 void SimulatorCaptureDevice::setAnalogData(int signalId, QVector<double> data)
 {
+    invalidateReplay();
+
     if (signalId < MaxAnalogSignals) {
 
         if (mAnalogSignals[signalId] != NULL) {
@@ -250,20 +307,21 @@ void SimulatorCaptureDevice::setAnalogData(int signalId, QVector<double> data)
 
 void SimulatorCaptureDevice::clearSignalData()
 {
+    invalidateReplay();
     deleteSignalData();
 }
 
-int SimulatorCaptureDevice::digitalTriggerIndex()
+SampleIndex SimulatorCaptureDevice::digitalTriggerIndex()
 {
     return mTriggerIdx;
 }
 
-void SimulatorCaptureDevice::setDigitalTriggerIndex(int idx)
+void SimulatorCaptureDevice::setDigitalTriggerIndex(SampleIndex idx)
 {
     mTriggerIdx = idx;
 }
 
-void SimulatorCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+void SimulatorCaptureDevice::digitalTransitions(int signalId, QVector<SampleIndex> &list)
 {
 
     if (signalId >= MaxDigitalSignals) return;
@@ -275,7 +333,7 @@ void SimulatorCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
         // Deallocation:
         //    Deleted by deleteSignalData() which is called by destructor
         //    or clearSignalData()
-        QList<int>* l = new QList<int>();
+        QVector<SampleIndex>* l = new QVector<SampleIndex>();
 
         CaptureDevice::digitalTransitions(signalId, *l);
         mDigitalSignalTransitions[signalId] = l;
@@ -295,6 +353,10 @@ void SimulatorCaptureDevice::reconfigure(int sampleRate)
 */
 int SimulatorCaptureDevice::numberOfSamples()
 {
+    if (mConfigDialog != NULL && mConfigDialog->numSamples() > 0) {
+        return mConfigDialog->numSamples();
+    }
+
     // calculate number of samples based on number of digital signals
     // and a buffer of 256kB. Each digital signal requires 1 bit
     int sz = mDigitalSignalList.size();
@@ -304,63 +366,70 @@ int SimulatorCaptureDevice::numberOfSamples()
 }
 
 /*!
-    Generate random digital signal data
+    Seed the random number generator for the next capture. The seed
+    selected by the user is combined with the capture number so that
+    each capture in a continuous session is different but reproducible.
+*/
+void SimulatorCaptureDevice::seedRandom()
+{
+    quint64 seed = mConfigDialog->seed();
+
+    if (seed == 0) {
+        seed = (quint64)QDateTime::currentMSecsSinceEpoch();
+    }
+
+    mRandom.seed(seed + mCaptureNumber);
+}
+
+/*!
+    Generate random digital signal data. A signal either changes randomly
+    for each sample or has random levels lasting a random number of
+    samples.
 */
 void SimulatorCaptureDevice::generateRandomDigitalSignals()
 {
+    int maxNumSamples = numberOfSamples();
 
     foreach(DigitalSignal* signal, mDigitalSignalList) {
         int id = signal->id();
 
         if (id >= MaxDigitalSignals) continue;
 
-        int maxNumSamples = numberOfSamples();
-
-
         // Deallocation:
         //    Assigned to mDigitalSignals below which is deleted by
         //    deleteSignalData() which is called by destructor or
         //    clearSignalData()
-        QVector<int> *s = new QVector<int>();
-        bool fast = ((qrand() % 2) == 1);
+        QVector<int> *s = new QVector<int>(maxNumSamples);
+        int* p = s->data();
+        bool fast = (mRandom.bounded(2) == 1);
 
         if (fast) {
-            for(int j = 0; j < maxNumSamples; ++j) {
-                s->append(qrand() % 2);
+            // 64 samples for each random value
+            for(int j = 0; j < maxNumSamples; j += 64) {
+                quint64 bits = mRandom.next();
+                int n = qMin(64, maxNumSamples - j);
+
+                for (int k = 0; k < n; k++) {
+                    p[j+k] = (int)(bits & 1);
+                    bits >>= 1;
+                }
             }
         }
         else {
 
             for(int j = 0; j < maxNumSamples;) {
-                int level = qrand() % 2;
-                int parts = (qrand() % 1020) + 4;
-                int duration = qrand() % (maxNumSamples/parts);
-                duration = j+duration;
-                if (duration>maxNumSamples) {
-                    duration = maxNumSamples;
-                }
-
-                while(j < duration) {
-                    s->append(level);
-                    j++;
-                }
+                int level = mRandom.bounded(2);
+                int parts = mRandom.bounded(1020) + 4;
+                int duration = 1 + mRandom.bounded(maxNumSamples/parts);
+                duration = qMin(duration, maxNumSamples - j);
 
+                std::fill(p + j, p + j + duration, level);
+                j += duration;
             }
 
         }
 
-        int skips = qrand() % 5478;
-        for (int j = 0; j < skips; j++) qrand();
-
-        if (mDigitalSignals[id] != NULL) {
-            delete mDigitalSignals[id];
-        }
-        if (mDigitalSignalTransitions[id] != NULL) {
-            delete mDigitalSignalTransitions[id];
-            mDigitalSignalTransitions[id] = NULL;
-        }
-
-        mDigitalSignals[id] = s;
+        setDigitalSignalData(id, s);
 
     }
 }
@@ -378,46 +447,14 @@ void SimulatorCaptureDevice::generateI2CDigitalSignals()
     i2cGen.setI2CRate(mConfigDialog->i2cRate());
     i2cGen.generateFromString("D04,S,W060,A,X16,A,X00,A,X00,A,X00,A,X40,A,P,S,W060,A,X00,A,P,S,R060,A,X3F,N,P,S,W060,A,X01,A,P,S,R060,A,X7F,N,P");
 
-    double i2cSampleTime = (double)1/i2cGen.sampleRate();
-    QVector<int> sclData = i2cGen.sclData();
-    QVector<int> sdaData = i2cGen.sdaData();
-
-    if (sclData.size() < 2) return;
-
-    // Deallocation:
-    //    Deleted by deleteSignalData() which is called by destructor or
-    //    clearSignalData()
-    QVector<int> *scl = new QVector<int>();
-    QVector<int> *sda = new QVector<int>();
-
-
-    int maxNumSamples = numberOfSamples();
-    double sampleTime = (double)1/mUsedSampleRate;
-
-    int i2cPos = 0;
-    double nextI2CTime = i2cSampleTime;
+    if (i2cGen.sclEdges().length() < 2) return;
 
-    for (int i = 0; i < maxNumSamples; i++) {
+    QVector<DigitalEdgeList> edges;
+    edges << i2cGen.sclEdges() << i2cGen.sdaEdges();
+    generateBusTraffic(edges, i2cGen.sampleRate());
 
-        while (i*sampleTime >= nextI2CTime) {
-            i2cPos++;
-            nextI2CTime = (i2cPos+1)*i2cSampleTime;
-        }
-
-        if (i2cPos < sclData.size()) {
-            scl->append(sclData.at(i2cPos));
-            sda->append(sdaData.at(i2cPos));
-        }
-        else {
-            scl->append(scl->at(i-1));
-            sda->append(sda->at(i-1));
-        }
-
-
-    }
-
-    setDigitalSignalData(mConfigDialog->i2cSclSignalId(), scl);
-    setDigitalSignalData(mConfigDialog->i2cSdaSignalId(), sda);
+    setDigitalSignalData(mConfigDialog->i2cSclSignalId(), edges.at(0), i2cGen.sampleRate());
+    setDigitalSignalData(mConfigDialog->i2cSdaSignalId(), edges.at(1), i2cGen.sampleRate());
 
 }
 
@@ -438,41 +475,13 @@ void SimulatorCaptureDevice::generateUartDigitalSignals()
     QByteArray dataToGen = QString("Hello World abcde fghij klmno pqrst uvwxy z0123 45678 9").toLatin1();
     uartGen.generate(dataToGen);
 
-    double uartSampleTime = (double)1/uartGen.sampleRate();
-    QVector<int> uartData = uartGen.uartData();
-
-    if (uartData.size() < 2) return;
-
-    // Deallocation:
-    //    Deleted by deleteSignalData() which is called by destructor or
-    //    clearSignalData()
-    QVector<int> *data = new QVector<int>();
+    if (uartGen.uartEdges().length() < 2) return;
 
+    QVector<DigitalEdgeList> edges;
+    edges << uartGen.uartEdges();
+    generateBusTraffic(edges, uartGen.sampleRate());
 
-    int maxNumSamples = numberOfSamples();
-    double sampleTime = (double)1/mUsedSampleRate;
-
-    int pos = 0;
-    double nextTime = uartSampleTime;
-
-    for (int i = 0; i < maxNumSamples; i++) {
-
-        while (i*sampleTime >= nextTime) {
-            pos++;
-            nextTime = (pos+1)*uartSampleTime;
-        }
-
-        if (pos < uartData.size()) {
-            data->append(uartData.at(pos));
-        }
-        else {
-            data->append(data->at(i-1));
-        }
-
-
-    }
-
-    setDigitalSignalData(mConfigDialog->uartSignalId(), data);
+    setDigitalSignalData(mConfigDialog->uartSignalId(), edges.at(0), uartGen.sampleRate());
 }
 
 /*!
@@ -490,57 +499,169 @@ void SimulatorCaptureDevice::generateSpiDigitalSignals()
 
     spiGen.generateFromString("D04,E1,D03,XD1:00,XFF:19,XFF:00,D02,E0,D03,E1,D02,X91:00,XFF:64,XFF:18,D02,E0");
 
-    double spiSampleTime = (double)1/spiGen.sampleRate();
-    QVector<int> sckData = spiGen.sckData();
-    QVector<int> mosiData = spiGen.mosiData();
-    QVector<int> misoData = spiGen.misoData();
-    QVector<int> csData = spiGen.enableData();
+    if (spiGen.sckEdges().length() < 2) return;
 
-    if (sckData.size() < 2) return;
+    int rate = spiGen.sampleRate();
 
-    // Deallocation:
-    //    Deleted by deleteSignalData() which is called by destructor or
-    //    clearSignalData()
-    QVector<int> *sck = new QVector<int>();
-    QVector<int> *mosi = new QVector<int>();
-    QVector<int> *miso = new QVector<int>();
-    QVector<int> *cs = new QVector<int>();
+    QVector<DigitalEdgeList> edges;
+    edges << spiGen.sckEdges() << spiGen.mosiEdges()
+          << spiGen.misoEdges() << spiGen.enableEdges();
+    generateBusTraffic(edges, rate);
 
+    setDigitalSignalData(mConfigDialog->spiSckSignalId(), edges.at(0), rate);
+    setDigitalSignalData(mConfigDialog->spiMosiSignalId(), edges.at(1), rate);
+    setDigitalSignalData(mConfigDialog->spiMisoSignalId(), edges.at(2), rate);
+    setDigitalSignalData(mConfigDialog->spiEnableSignalId(), edges.at(3), rate);
+}
 
-    int maxNumSamples = numberOfSamples();
-    double sampleTime = (double)1/mUsedSampleRate;
+/*!
+    Repeat the transaction in \a edges, one list per bus signal generated
+    at \a stateRate, until it fills the capture. The transactions are
+    separated by idle periods of random length so that the bus is busy the
+    part of the time given by the bus density.
+*/
+void SimulatorCaptureDevice::generateBusTraffic(QVector<DigitalEdgeList> &edges,
+                                                int stateRate)
+{
+    if (edges.isEmpty()) return;
+
+    QVector<DigitalEdgeList> transaction = edges;
+    int txLength = 0;
+    for (int i = 0; i < transaction.size(); i++) {
+        txLength = qMax(txLength, transaction.at(i).length());
+    }
+    if (txLength <= 0) return;
+
+    // all signals must have the same length to stay aligned
+    for (int i = 0; i < transaction.size(); i++) {
+        DigitalEdgeList &tx = transaction[i];
+        tx.append(tx.level(), txLength - tx.length());
+    }
+
+    int numSamples = numberOfSamples();
+    qint64 needed = ((qint64)numSamples * stateRate) / mUsedSampleRate + 1;
+    if (needed > MaxBusStates / 2) {
+        needed = MaxBusStates / 2;
+    }
+
+    // the length must stay below MaxBusStates even after the last
+    // transaction and gap has been added
+    int density = mConfigDialog->busDensity();
+    qint64 meanGap = ((qint64)txLength * (100 - density)) / density;
+    if (meanGap > MaxBusStates / 8) {
+        meanGap = MaxBusStates / 8;
+    }
+    if (txLength > MaxBusStates / 8) return;
+
+    for (int i = 0; i < edges.size(); i++) {
+        edges[i].clear();
+    }
 
-    int pos = 0;
-    double nextTime = spiSampleTime;
+    // Stop when each sample could hold an edge as more transactions
+    // wouldn't be visible anyway at this sample rate
+    while (edges.at(0).length() < needed
+           && edges.at(0).edges().size() < numSamples) {
 
-    for (int i = 0; i < maxNumSamples; i++) {
+        int gap = (int)(meanGap/2) + mRandom.bounded((int)meanGap+1);
 
-        while (i*sampleTime >= nextTime) {
-            pos++;
-            nextTime = (pos+1)*spiSampleTime;
+        for (int i = 0; i < edges.size(); i++) {
+            edges[i].append(transaction.at(i));
+            edges[i].append(transaction.at(i).level(), gap);
         }
+    }
+}
 
-        if (pos < sckData.size()) {
-            sck->append(sckData.at(pos));
-            mosi->append(mosiData.at(pos));
-            miso->append(misoData.at(pos));
-            cs->append(csData.at(pos));
+/*!
+    Replay signal data recorded from an earlier capture. The signal data
+    available when the replay started (captured or loaded from a project)
+    is used as the recording and each capture gets the next part of it,
+    wrapping around at the end.
+*/
+void SimulatorCaptureDevice::replaySignals()
+{
+    if (!mReplayValid) {
+
+        // QVector is implicitly shared so this is a cheap copy
+        mReplayLength = 0;
+        for (int i = 0; i < MaxDigitalSignals; i++) {
+            mReplayDigital[i].clear();
+            if (mDigitalSignals[i] != NULL) {
+                mReplayDigital[i] = *mDigitalSignals[i];
+                mReplayLength = qMax(mReplayLength, mReplayDigital[i].size());
+            }
+        }
+        for (int i = 0; i < MaxAnalogSignals; i++) {
+            mReplayAnalog[i].clear();
+            if (mAnalogSignals[i] != NULL) {
+                mReplayAnalog[i] = *mAnalogSignals[i];
+                mReplayLength = qMax(mReplayLength, mReplayAnalog[i].size());
+            }
         }
-        else {
-            sck->append(sck->at(i-1));
-            mosi->append(mosi->at(i-1));
-            miso->append(miso->at(i-1));
-            cs->append(cs->at(i-1));
 
+        mReplayPos = 0;
+        mReplayValid = true;
+    }
+
+    if (mReplayLength == 0) return;
+
+    int numSamples = mReplayLength;
+    if (mConfigDialog->numSamples() > 0) {
+        numSamples = mConfigDialog->numSamples();
+    }
+
+    foreach(DigitalSignal* signal, mDigitalSignalList) {
+        int id = signal->id();
+        if (id >= MaxDigitalSignals) continue;
+
+        const QVector<int> &rec = mReplayDigital[id];
+        if (rec.isEmpty()) continue;
+
+        // Deallocation:
+        //    Deleted by deleteSignalData() which is called by destructor or
+        //    clearSignalData()
+        QVector<int> *s = new QVector<int>(numSamples);
+        int* p = s->data();
+        int pos = mReplayPos % rec.size();
+
+        for (int j = 0; j < numSamples;) {
+            int n = qMin(numSamples - j, rec.size() - pos);
+            std::copy(rec.constData() + pos, rec.constData() + pos + n, p + j);
+            j += n;
+            pos = 0;
         }
 
+        setDigitalSignalData(id, s);
+    }
+
+    foreach(AnalogSignal* signal, mAnalogSignalList) {
+        int id = signal->id();
+        if (id >= MaxAnalogSignals) continue;
+
+        const QVector<double> &rec = mReplayAnalog[id];
+        if (rec.isEmpty()) continue;
+
+        // Deallocation:
+        //    Deleted by deleteSignalData() which is called by destructor or
+        //    clearSignalData()
+        QVector<double> *s = new QVector<double>(numSamples);
+        double* p = s->data();
+        int pos = mReplayPos % rec.size();
+
+        for (int j = 0; j < numSamples;) {
+            int n = qMin(numSamples - j, rec.size() - pos);
+            std::copy(rec.constData() + pos, rec.constData() + pos + n, p + j);
+            j += n;
+            pos = 0;
+        }
 
+        if (mAnalogSignals[id] != NULL) {
+            delete mAnalogSignals[id];
+        }
+        mAnalogSignals[id] = s;
     }
 
-    setDigitalSignalData(mConfigDialog->spiSckSignalId(), sck);
-    setDigitalSignalData(mConfigDialog->spiMosiSignalId(), mosi);
-    setDigitalSignalData(mConfigDialog->spiMisoSignalId(), miso);
-    setDigitalSignalData(mConfigDialog->spiEnableSignalId(), cs);
+    mEndSampleIdx = numSamples - 1;
+    mReplayPos = (int)(((qint64)mReplayPos + numSamples) % mReplayLength);
 }
 
 /*!
@@ -558,21 +679,15 @@ void SimulatorCaptureDevice::generateRandomAnalogSignals()
         // Deallocation:
         //    Deleted by deleteSignalData() which is called by destructor or
         //    clearSignalData()
-        QVector<double> *s = new QVector<double>();
+        QVector<double> *s = new QVector<double>(maxNumSamples);
+        double* p = s->data();
 
         for(int j = 0; j < maxNumSamples; ++j) {
 
             // random number between -5.0 and +5.0
-            double val = qrand() % 1000;
-            val -= 500;
-            val /= 100.0;
-
-            s->append(val);
+            p[j] = (mRandom.bounded(1000) - 500) / 100.0;
         }
 
-        int skips = qrand() % 5478;
-        for (int j = 0; j < skips; j++) qrand();
-
         if (mAnalogSignals[id] != NULL) {
             delete mAnalogSignals[id];
         }
@@ -598,19 +713,16 @@ void SimulatorCaptureDevice::generateSineAnalogSignals()
         // Deallocation:
         //    Deleted by deleteSignalData() which is called by destructor or
         //    clearSignalData()
-        QVector<double> *s = new QVector<double>();
+        QVector<double> *s = new QVector<double>(maxNumSamples);
+        double* p = s->data();
 
-        double amp = qrand() % 1000;
-        amp -= 500;
-        amp /= 100.0;
+        double amp = (mRandom.bounded(1000) - 500) / 100.0;
 
-        int per = (qrand() % (maxNumSamples/32));
+        int per = mRandom.bounded(maxNumSamples/32);
+        if (per < 1) per = 1;
 
         for(int j = 0; j < maxNumSamples; j++) {
-
-            double val = amp*qSin(2*pi*j/per);
-
-            s->append(val);
+            p[j] = amp*qSin(2*pi*j/per);
         }
 
         if (mAnalogSignals[id] != NULL) {
@@ -644,6 +756,7 @@ void SimulatorCaptureDevice::deleteSignalData()
             mAnalogSignals[i] = NULL;
         }
     }
+    mAnalogTimeOffsets.clear();
 }
 
 /*!
@@ -660,3 +773,57 @@ void SimulatorCaptureDevice::setDigitalSignalData(int id, QVector<int>* data)
     }
     mDigitalSignals[id] = data;
 }
+
+/*!
+    Set digital signal data for signal with given \a id by expanding the
+    \a edges, generated at \a stateRate, to the used sample rate.
+
+    The transitions are taken directly from the \a edges so that
+    the expanded data doesn't have to be searched for them.
+*/
+void SimulatorCaptureDevice::setDigitalSignalData(int id, const DigitalEdgeList &edges,
+                                                  int stateRate)
+{
+    int numSamples = numberOfSamples();
+
+    // Deallocation:
+    //    Deleted by deleteSignalData() which is called by destructor or
+    //    clearSignalData()
+    QVector<int> *data = new QVector<int>();
+    edges.expand(*data, numSamples, mUsedSampleRate, stateRate);
+
+    setDigitalSignalData(id, data);
+
+    // Deallocation:
+    //    Deleted by deleteSignalData() which is called by destructor
+    //    or clearSignalData()
+    QVector<SampleIndex>* l = new QVector<SampleIndex>();
+    edges.transitions(*l, numSamples, mUsedSampleRate, stateRate);
+    mDigitalSignalTransitions[id] = l;
+}
+
+/*!
+    Forget the recording used when replaying signal data. The next replay
+    will use the signal data available at that time.
+*/
+void SimulatorCaptureDevice::invalidateReplay()
+{
+    mReplayValid = false;
+    mReplayLength = 0;
+    mReplayPos = 0;
+
+    for (int i = 0; i < MaxDigitalSignals; i++) {
+        mReplayDigital[i].clear();
+    }
+    for (int i = 0; i < MaxAnalogSignals; i++) {
+        mReplayAnalog[i].clear();
+    }
+}
+
+/*!
+    Called when it is time to report that the capture has finished.
+*/
+void SimulatorCaptureDevice::handleFinishTimer()
+{
+    emit captureFinished(true, "");
+}
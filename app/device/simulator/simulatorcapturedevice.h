@@ -18,8 +18,12 @@
 
 #include <QObject>
 #include <QVector>
+#include <QTimer>
 #include "device/capturedevice.h"
 #include "uisimulatorconfigdialog.h"
+#include "simulatorrandom.h"
+
+class DigitalEdgeList;
 
 class SimulatorCaptureDevice : public CaptureDevice
 {
@@ -27,6 +31,8 @@ class SimulatorCaptureDevice : public CaptureDevice
 public:
     explicit SimulatorCaptureDevice(QObject *parent = 0);
     ~SimulatorCaptureDevice();
+
+    bool supportsContinuousCapture() {return true;}
     
     QList<int> supportedSampleRates();
     int maxNumDigitalSignals();
@@ -37,7 +43,7 @@ public:
     void start(int sampleRate);
     void stop();
 
-    int lastSampleIndex();
+    SampleIndex lastSampleIndex();
     QVector<int>* digitalData(int signalId);
     void setDigitalData(int signalId, QVector<int> data);
 
@@ -46,9 +52,9 @@ public:
 
     void clearSignalData();
 
-    int digitalTriggerIndex();
-    void setDigitalTriggerIndex(int idx);
-    void digitalTransitions(int signalId, QList<int> &list);
+    SampleIndex digitalTriggerIndex();
+    void setDigitalTriggerIndex(SampleIndex idx);
+    void digitalTransitions(int signalId, QVector<SampleIndex> &list);
 
     void reconfigure(int sampleRate = -1);
 
@@ -56,36 +62,55 @@ signals:
     
 public slots:
 
+private slots:
+    void handleFinishTimer();
+
 private:
 
     enum Constants {
-        MaxDigitalSignals = 8,
-        MaxAnalogSignals = 2
+        MaxDigitalSignals = 32,
+        MaxAnalogSignals = 2,
+        MaxBusStates = 0x40000000
     };
 
 
     UiSimulatorConfigDialog* mConfigDialog;
 
-    int mEndSampleIdx;
+    SampleIndex mEndSampleIdx;
     QVector<int>* mDigitalSignals[MaxDigitalSignals];
     QVector<double>* mAnalogSignals[MaxAnalogSignals];
-    QList<int>* mDigitalSignalTransitions[MaxDigitalSignals];
+    QVector<SampleIndex>* mDigitalSignalTransitions[MaxDigitalSignals];
 
     QList<double> mSupportedVPerDiv;
 
-    int mTriggerIdx;
+    SampleIndex mTriggerIdx;
+
+    SimulatorRandom mRandom;
+    int mCaptureNumber;
+    QTimer* mFinishTimer;
+
+    bool mReplayValid;
+    int mReplayLength;
+    int mReplayPos;
+    QVector<int> mReplayDigital[MaxDigitalSignals];
+    QVector<double> mReplayAnalog[MaxAnalogSignals];
 
 
     int numberOfSamples();
+    void seedRandom();
     void generateRandomDigitalSignals();
     void generateI2CDigitalSignals();
     void generateUartDigitalSignals();
     void generateSpiDigitalSignals();
+    void generateBusTraffic(QVector<DigitalEdgeList> &edges, int stateRate);
+    void replaySignals();
 
     void generateRandomAnalogSignals();
     void generateSineAnalogSignals();
     void deleteSignalData();
     void setDigitalSignalData(int id, QVector<int>* data);
+    void setDigitalSignalData(int id, const DigitalEdgeList &edges, int stateRate);
+    void invalidateReplay();
     
 };
 
@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "simulatorrandom.h"
+
+/*!
+    \class SimulatorRandom
+    \brief A fast pseudo random number generator for the simulator.
+
+    \ingroup Device
+
+    The SimulatorRandom class implements the xoshiro256** generator. It is
+    much faster than qrand() and gives 64 random bits per call, which lets
+    the simulator generate random digital data 64 samples at a time.
+
+    The generator is completely determined by its seed, so the same seed
+    always gives the same simulated signals.
+*/
+
+/*!
+    \fn quint64 SimulatorRandom::next()
+
+    Returns the next 64-bit random value.
+*/
+
+/*!
+    \fn int SimulatorRandom::bounded(int n)
+
+    Returns a random value in the range 0 to \a n - 1.
+*/
+
+/*!
+    \fn double SimulatorRandom::uniform()
+
+    Returns a random value in the range 0.0 (inclusive) to 1.0 (exclusive).
+*/
+
+/*!
+    Constructs a generator initialized with \a seed.
+*/
+SimulatorRandom::SimulatorRandom(quint64 seed)
+{
+    this->seed(seed);
+}
+
+/*!
+    Initializes the generator with \a seed.
+*/
+void SimulatorRandom::seed(quint64 seed)
+{
+    // The state is filled with splitmix64 as the state of xoshiro256**
+    // must not be all zeros and should be well mixed.
+    quint64 x = seed;
+    for (int i = 0; i < 4; i++) {
+        quint64 z = (x += Q_UINT64_C(0x9E3779B97F4A7C15));
+        z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+        z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+        mState[i] = z ^ (z >> 31);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SIMULATORRANDOM_H
+#define SIMULATORRANDOM_H
+
+#include <QtGlobal>
+
+class SimulatorRandom
+{
+public:
+    explicit SimulatorRandom(quint64 seed = 0);
+
+    void seed(quint64 seed);
+
+    // xoshiro256**
+    inline quint64 next()
+    {
+        const quint64 result = rotl(mState[1] * 5, 7) * 9;
+        const quint64 t = mState[1] << 17;
+
+        mState[2] ^= mState[0];
+        mState[3] ^= mState[1];
+        mState[1] ^= mState[2];
+        mState[0] ^= mState[3];
+
+        mState[2] ^= t;
+        mState[3] = rotl(mState[3], 45);
+
+        return result;
+    }
+
+    // uniform value in the range 0..n-1
+    inline int bounded(int n)
+    {
+        if (n <= 1) return 0;
+        return (int)(((next() >> 32) * (quint64)n) >> 32);
+    }
+
+    // uniform value in the range [0, 1)
+    inline double uniform()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    quint64 mState[4];
+
+    static inline quint64 rotl(const quint64 x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+#endif // SIMULATORRANDOM_H
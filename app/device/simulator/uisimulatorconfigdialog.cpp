@@ -51,6 +51,9 @@
 
     \var UiSimulatorConfigDialog::DigitalFunction UiSimulatorConfigDialog::DigitalFunction_SPI
     SPI signal data
+
+    \var UiSimulatorConfigDialog::DigitalFunction UiSimulatorConfigDialog::DigitalFunction_Replay
+    Replay of previously captured (or loaded) signal data
 */
 
 /*!
@@ -93,6 +96,7 @@ UiSimulatorConfigDialog::UiSimulatorConfigDialog(QWidget *parent) :
     mDigFuncBox->addItem("I2C", QVariant(UiSimulatorConfigDialog::DigitalFunction_I2C));
     mDigFuncBox->addItem("UART", QVariant(UiSimulatorConfigDialog::DigitalFunction_UART));
     mDigFuncBox->addItem("SPI", QVariant(UiSimulatorConfigDialog::DigitalFunction_SPI));
+    mDigFuncBox->addItem("Replay", QVariant(UiSimulatorConfigDialog::DigitalFunction_Replay));
 
     formLayout->addRow(tr("Digital: "), mDigFuncBox);
 
@@ -107,6 +111,38 @@ UiSimulatorConfigDialog::UiSimulatorConfigDialog(QWidget *parent) :
 
     formLayout->addRow(tr("Analog: "), mAnFuncBox);
 
+    // number of samples, 0 means that it depends on the number of signals
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSamplesBox = new QSpinBox(this);
+    mSamplesBox->setRange(0, MaxSamples);
+    mSamplesBox->setSingleStep(1000000);
+    mSamplesBox->setSpecialValueText(tr("Automatic"));
+    mSamplesBox->setToolTip(tr("Number of samples per signal and capture"));
+    formLayout->addRow(tr("Samples: "), mSamplesBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSamplesLimitLabel = new QLabel(this);
+    formLayout->addRow("", mSamplesLimitLabel);
+    setNumSignals(1, 0);
+
+    // seed, 0 means that a new seed is used for each capture
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSeedBox = new QSpinBox(this);
+    mSeedBox->setRange(0, 0x7fffffff);
+    mSeedBox->setSpecialValueText(tr("Random"));
+    mSeedBox->setToolTip(tr("Use the same seed to get the same signals"));
+    formLayout->addRow(tr("Seed: "), mSeedBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mDensityBox = new QSpinBox(this);
+    mDensityBox->setRange(1, 100);
+    mDensityBox->setValue(100);
+    mDensityBox->setSuffix(" %");
+    mDensityBox->setToolTip(tr("How much of the time the I2C, UART or SPI bus is busy"));
+    formLayout->addRow(tr("Bus density: "), mDensityBox);
+
     // Deallocation:
     //   Ownership is transfered to UiSimulatorConfigDialog when calling
     //   setLayout below.
@@ -137,6 +173,10 @@ UiSimulatorConfigDialog::UiSimulatorConfigDialog(QWidget *parent) :
     mSpiSettings = createSpiSettings();
     verticalLayout->addWidget(mSpiSettings);
 
+    // --- Replay settings
+    mReplaySettings = createReplaySettings();
+    verticalLayout->addWidget(mReplaySettings);
+
 
     verticalLayout->addWidget(bottonBox);
 
@@ -164,6 +204,64 @@ UiSimulatorConfigDialog::AnalogFunction UiSimulatorConfigDialog::analogFunction(
     return (UiSimulatorConfigDialog::AnalogFunction)func;
 }
 
+/*!
+    Returns the number of samples per signal selected by the user or 0
+    if the simulator should decide.
+*/
+int UiSimulatorConfigDialog::numSamples()
+{
+    return mSamplesBox->value();
+}
+
+/*!
+    Limits the number of samples that the user can select so that the data
+    for \a numDigital digital signals and \a numAnalog analog signals fits
+    in MaxSampleMemory bytes. A digital sample is stored as an int and an
+    analog sample as a double, like for all capture devices, so with all 32
+    digital signals a capture is limited to about 4M samples.
+*/
+void UiSimulatorConfigDialog::setNumSignals(int numDigital, int numAnalog)
+{
+    qint64 bytesPerSample = qMax(numDigital, 0)*sizeof(int)
+            + qMax(numAnalog, 0)*sizeof(double);
+    if (bytesPerSample <= 0) {
+        bytesPerSample = sizeof(int);
+    }
+
+    int max = (int)qMin((qint64)MaxSamples, (qint64)MaxSampleMemory/bytesPerSample);
+
+    // the value is adjusted if it is larger than the new maximum
+    mSamplesBox->setMaximum(max);
+    mSamplesLimitLabel->setText(tr("At most %1 samples with %2 digital and %3 analog signals")
+                                .arg(max).arg(numDigital).arg(numAnalog));
+}
+
+/*!
+    Returns the seed for the random number generator or 0 if a new seed
+    should be used for each capture.
+*/
+quint64 UiSimulatorConfigDialog::seed()
+{
+    return mSeedBox->value();
+}
+
+/*!
+    Returns how much of the time (in percent) that the I2C, UART and SPI
+    busses are busy.
+*/
+int UiSimulatorConfigDialog::busDensity()
+{
+    return mDensityBox->value();
+}
+
+/*!
+    Returns the number of captures per second when replaying signal data.
+*/
+int UiSimulatorConfigDialog::replayRate()
+{
+    return mReplayRateBox->value();
+}
+
 /*!
     Returns signal ID to use for the UART signal.
 */
@@ -312,6 +410,7 @@ void UiSimulatorConfigDialog::handleDigitalFunctionChange(int idx)
     mUartSettings->hide();
     mI2cSettings->hide();
     mSpiSettings->hide();
+    mReplaySettings->hide();
 
     switch (idx) {
     case UiSimulatorConfigDialog::DigitalFunction_I2C:
@@ -323,6 +422,9 @@ void UiSimulatorConfigDialog::handleDigitalFunctionChange(int idx)
     case UiSimulatorConfigDialog::DigitalFunction_SPI:
         mSpiSettings->show();
         break;
+    case UiSimulatorConfigDialog::DigitalFunction_Replay:
+        mReplaySettings->show();
+        break;
     default:
         break;
     }
@@ -440,6 +542,33 @@ QWidget* UiSimulatorConfigDialog::createSpiSettings()
     return w;
 }
 
+/*!
+    Create widget with replay settings.
+*/
+QWidget* UiSimulatorConfigDialog::createReplaySettings()
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QFrame* w = new QFrame(this);
+    w->setFrameShape(QFrame::StyledPanel);
+
+    // Deallocation:
+    //    w->setLayout takes ownership of formLayout
+    QFormLayout* formLayout = new QFormLayout;
 
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QLabel* info = new QLabel(tr("Replays the signal data that was available\n"
+                                 "when replay was selected, e.g. from a project."), w);
+    formLayout->addRow(info);
 
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mReplayRateBox = new QSpinBox(w);
+    mReplayRateBox->setRange(1, 100);
+    mReplayRateBox->setValue(10);
+    mReplayRateBox->setToolTip(tr("Number of captures per second in continuous mode"));
+    formLayout->addRow(tr("Captures per second: "), mReplayRateBox);
 
+    w->hide();
+    w->setLayout(formLayout);
+
+    return w;
+}
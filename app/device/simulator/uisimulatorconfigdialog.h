@@ -20,6 +20,8 @@
 #include <QDialog>
 #include <QComboBox>
 #include <QLineEdit>
+#include <QSpinBox>
+#include <QLabel>
 
 #include "common/types.h"
 
@@ -33,7 +35,8 @@ public:
         DigitalFunction_Random,
         DigitalFunction_I2C,
         DigitalFunction_UART,
-        DigitalFunction_SPI
+        DigitalFunction_SPI,
+        DigitalFunction_Replay
     };
 
     enum AnalogFunction {
@@ -47,6 +50,12 @@ public:
     DigitalFunction digitalFunction();
     AnalogFunction analogFunction();
 
+    int numSamples();
+    void setNumSignals(int numDigital, int numAnalog);
+    quint64 seed();
+    int busDensity();
+    int replayRate();
+
     int uartSignalId();
     int uartDataBits();
     int uartStopBits();
@@ -76,9 +85,23 @@ private slots:
 
 private:
 
+    enum Constants {
+        MaxSamples = 200000000,
+        MaxSampleMemory = 0x20000000 // 512 MB for the generated signal data
+    };
+
     QComboBox* mDigFuncBox;
     QComboBox* mAnFuncBox;
 
+    QSpinBox* mSamplesBox;
+    QLabel* mSamplesLimitLabel;
+    QSpinBox* mSeedBox;
+    QSpinBox* mDensityBox;
+
+    QWidget* mReplaySettings;
+
+    QSpinBox* mReplayRateBox;
+
     QWidget* mUartSettings;
 
     QComboBox* mUartSignalBox;
@@ -108,6 +131,7 @@ private:
     QWidget* createUartSettings();
     QWidget* createI2cSettings();
     QWidget* createSpiSettings();
+    QWidget* createReplaySettings();
     
 };
 
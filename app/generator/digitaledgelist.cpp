@@ -0,0 +1,241 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "digitaledgelist.h"
+
+#include <algorithm>
+
+/*!
+    \class DigitalEdgeList
+    \brief A digital signal stored as a list of edges.
+
+    \ingroup Generator
+
+    The DigitalEdgeList class is used by the protocol generators
+    (I2CGenerator, SpiGenerator and UartGenerator) to describe a signal
+    as a number of states, where each state lasts one period of the
+    generator's rate. Only the state indexes where the level changes are
+    stored, so long delays and idle periods cost nothing.
+
+    The list is converted to sample data with \ref expand, which fills
+    whole runs of samples at a time, and to the transition list format
+    used by CaptureDevice::digitalTransitions() with \ref transitions.
+*/
+
+/*!
+    Constructs an empty edge list.
+*/
+DigitalEdgeList::DigitalEdgeList()
+{
+    clear();
+}
+
+/*!
+    Removes all states from the list.
+*/
+void DigitalEdgeList::clear()
+{
+    mInitialLevel = 0;
+    mLevel = 0;
+    mLength = 0;
+    mEdges.clear();
+}
+
+/*!
+    Appends \a numStates states with the logical \a level to the end of
+    the signal.
+*/
+void DigitalEdgeList::append(int level, int numStates)
+{
+    if (numStates <= 0) return;
+
+    level = (level != 0) ? 1 : 0;
+
+    if (mLength == 0) {
+        mInitialLevel = level;
+    }
+    else if (level != mLevel) {
+        mEdges.append(mLength);
+    }
+
+    mLevel = level;
+    mLength += numStates;
+}
+
+/*!
+    Appends all states in the \a other list to the end of the signal.
+*/
+void DigitalEdgeList::append(const DigitalEdgeList &other)
+{
+    int level = other.mInitialLevel;
+    int start = 0;
+
+    for (int i = 0; i < other.mEdges.size(); i++) {
+        append(level, other.mEdges.at(i) - start);
+        start = other.mEdges.at(i);
+        level ^= 1;
+    }
+
+    append(level, other.mLength - start);
+}
+
+/*!
+    \fn bool DigitalEdgeList::isEmpty() const
+
+    Returns true if the list doesn't contain any states.
+*/
+
+/*!
+    \fn int DigitalEdgeList::length() const
+
+    Returns the number of states in the list.
+*/
+
+/*!
+    \fn int DigitalEdgeList::initialLevel() const
+
+    Returns the logical level of the first state.
+*/
+
+/*!
+    \fn int DigitalEdgeList::level() const
+
+    Returns the logical level of the last state.
+*/
+
+/*!
+    \fn const QVector<int> &DigitalEdgeList::edges() const
+
+    Returns the indexes of the states where the level changes.
+*/
+
+/*!
+    Returns the logical level of the given \a state. States after the end
+    of the list have the level of the last state.
+*/
+int DigitalEdgeList::levelAt(int state) const
+{
+    // number of edges at or before the state
+    int n = std::upper_bound(mEdges.constBegin(), mEdges.constEnd(), state)
+            - mEdges.constBegin();
+
+    return mInitialLevel ^ (n & 1);
+}
+
+/*!
+    Returns the list as one value per state.
+*/
+QVector<int> DigitalEdgeList::states() const
+{
+    QVector<int> data;
+    expand(data, mLength, 1, 1);
+    return data;
+}
+
+/*!
+    Fills \a data with \a numSamples samples of the signal when sampled at
+    \a sampleRate. The states are generated at \a stateRate. Samples after
+    the end of the list get the level of the last state.
+
+    Each run of samples between two edges is filled in one operation.
+*/
+void DigitalEdgeList::expand(QVector<int> &data, int numSamples,
+                             int sampleRate, int stateRate) const
+{
+    data.resize(numSamples);
+    if (numSamples <= 0 || mLength == 0) {
+        data.fill(mInitialLevel);
+        return;
+    }
+
+    int* p = data.data();
+    int level = mInitialLevel;
+    int start = 0;
+
+    for (int i = 0; i < mEdges.size() && start < numSamples; i++) {
+        int end = qMin(firstSample(mEdges.at(i), sampleRate, stateRate), numSamples);
+        if (end > start) {
+            std::fill(p + start, p + end, level);
+            start = end;
+        }
+        level ^= 1;
+    }
+
+    if (start < numSamples) {
+        std::fill(p + start, p + numSamples, level);
+    }
+}
+
+/*!
+    Fills \a list with the transitions of the signal in the same format as
+    CaptureDevice::digitalTransitions() when it is expanded with the same
+    \a numSamples, \a sampleRate and \a stateRate as for \ref expand.
+    This way the sample data doesn't have to be searched for transitions.
+*/
+void DigitalEdgeList::transitions(QVector<SampleIndex> &list, int numSamples,
+                                  int sampleRate, int stateRate) const
+{
+    if (numSamples <= 0) return;
+
+    int level = mInitialLevel;
+    int sampleLevel = mInitialLevel;
+    int sample = 0;
+
+    // index 0 is the level of the first sample, which is not known
+    // until all edges mapping to sample 0 have been handled
+    list.append(mInitialLevel);
+
+    for (int i = 0; i < mEdges.size(); i++) {
+        int s = firstSample(mEdges.at(i), sampleRate, stateRate);
+        if (s >= numSamples) break;
+
+        // Several edges can end up at the same sample, the last one wins
+        if (s != sample) {
+            if (level != sampleLevel) {
+                if (sample == 0) {
+                    list[0] = level;
+                }
+                else {
+                    list.append(sample);
+                }
+                sampleLevel = level;
+            }
+            sample = s;
+        }
+        level ^= 1;
+    }
+
+    if (level != sampleLevel) {
+        if (sample == 0) {
+            list[0] = level;
+        }
+        else {
+            list.append(sample);
+        }
+    }
+
+    list.append(numSamples-1);
+}
+
+/*!
+    Returns the index of the first sample, at \a sampleRate, that belongs to
+    \a state when the states are generated at \a stateRate.
+*/
+int DigitalEdgeList::firstSample(int state, int sampleRate, int stateRate)
+{
+    // smallest sample index i where i/sampleRate >= state/stateRate
+    qint64 n = (qint64)state * sampleRate;
+    return (int)((n + stateRate - 1) / stateRate);
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DIGITALEDGELIST_H
+#define DIGITALEDGELIST_H
+
+#include <QVector>
+
+#include "common/sampletime.h"
+
+class DigitalEdgeList
+{
+public:
+    DigitalEdgeList();
+
+    void clear();
+    void append(int level, int numStates = 1);
+    void append(const DigitalEdgeList &other);
+
+    bool isEmpty() const {return mLength == 0;}
+    int length() const {return mLength;}
+    int initialLevel() const {return mInitialLevel;}
+    int level() const {return mLevel;}
+    const QVector<int> &edges() const {return mEdges;}
+
+    int levelAt(int state) const;
+    QVector<int> states() const;
+
+    void expand(QVector<int> &data, int numSamples,
+                int sampleRate, int stateRate) const;
+    void transitions(QVector<SampleIndex> &list, int numSamples,
+                     int sampleRate, int stateRate) const;
+
+private:
+    int mInitialLevel;
+    int mLevel;
+    int mLength;
+    QVector<int> mEdges;
+
+    static int firstSample(int state, int sampleRate, int stateRate);
+};
+
+#endif // DIGITALEDGELIST_H
@@ -25,6 +25,9 @@
 
     \ingroup Generator
 
+    The signals are stored as DigitalEdgeList objects with one state for
+    each half clock cycle, see \ref sampleRate.
+
 */
 
 /*!
@@ -88,8 +91,8 @@ bool I2CGenerator::generateFromString(QString s)
     bool success = true;
 
     // reset data
-    mSclData.clear();
-    mSdaData.clear();
+    mScl.clear();
+    mSda.clear();
 
     mTransfer = false;
 
@@ -135,17 +138,17 @@ bool I2CGenerator::generateFromString(QString s)
 /*!
     Get I2C SCL (clock) signal data.
 */
-QVector<int> I2CGenerator::sclData()
+DigitalEdgeList I2CGenerator::sclEdges()
 {
-    return mSclData;
+    return mScl;
 }
 
 /*!
     Get I2C SDA (data) signal data.
 */
-QVector<int> I2CGenerator::sdaData()
+DigitalEdgeList I2CGenerator::sdaEdges()
 {
-    return mSdaData;
+    return mSda;
 }
 
 /*!
@@ -156,25 +159,25 @@ bool I2CGenerator::addStart()
     // start condition: SDA high-low transition while SCL is high
 
     // SDA is low, must set it to high so a transition can take place
-    if (mSdaData.size() > 1 && mSdaData.at(mSdaData.size()-1) == 0) {
+    if (mSda.length() > 1 && mSda.level() == 0) {
 
 
-        if (mSclData.at(mSclData.size()-1) == 1) {
-            mSclData.append(0);
-            mSdaData.append(1);
+        if (mScl.level() == 1) {
+            mScl.append(0);
+            mSda.append(1);
 
-            mSclData.append(1);
-            mSdaData.append(1);
+            mScl.append(1);
+            mSda.append(1);
         }
         else {
-            mSclData.append(1);
-            mSdaData.append(1);
+            mScl.append(1);
+            mSda.append(1);
         }
     }
 
 
-    mSdaData.append(0);
-    mSclData.append(1);
+    mSda.append(0);
+    mScl.append(1);
 
     return true;
 }
@@ -187,30 +190,30 @@ bool I2CGenerator::addStop()
     // stop condition: an SDA low-high transition while SCL is high
 
     // SDA is high, must set it low so a transition can take place
-    if (mSdaData.size() > 1 && mSdaData.at(mSdaData.size()-1) == 1) {
+    if (mSda.length() > 1 && mSda.level() == 1) {
 
         // the transition must take place when SCL is high (not during SCL
         // transition)
 
 
-        if (mSclData.at(mSclData.size()-1) == 1) {
+        if (mScl.level() == 1) {
 
             // add one clock cycle where SDA is LOW
 
-            mSclData.append(0);
-            mSdaData.append(0);
+            mScl.append(0);
+            mSda.append(0);
 
-            mSclData.append(1);
-            mSdaData.append(0);
+            mScl.append(1);
+            mSda.append(0);
         }
         else {
-            mSclData.append(1);
-            mSdaData.append(0);
+            mScl.append(1);
+            mSda.append(0);
         }
     }
 
-    mSdaData.append(1);
-    mSclData.append(1);
+    mSda.append(1);
+    mScl.append(1);
 
     return true;
 }
@@ -221,11 +224,10 @@ bool I2CGenerator::addStop()
 bool I2CGenerator::addAck()
 {
     // ACK: keep SDA low during a clock cycle
-    mSclData.append(0);
-    mSclData.append(1);
+    mScl.append(0);
+    mScl.append(1);
 
-    mSdaData.append(0);
-    mSdaData.append(0);
+    mSda.append(0, 2);
 
     return true;
 }
@@ -237,11 +239,10 @@ bool I2CGenerator::addNack()
 {
 
     // ACK: keep SDA high during a clock cycle
-    mSclData.append(0);
-    mSclData.append(1);
+    mScl.append(0);
+    mScl.append(1);
 
-    mSdaData.append(1);
-    mSdaData.append(1);
+    mSda.append(1, 2);
 
     return true;
 }
@@ -360,18 +361,15 @@ bool I2CGenerator::addDelay(QString value)
 
         if (!success) break;
 
-        for (int i = 0; i < samples; i++) {
-
-            // SCL is high when there isn't any active transfer; otherwise 0
-            if (mTransfer) {
-                mSclData.append(0);
-            } else {
-                mSclData.append(1);
-            }
-
-            // always keep SDA high
-            mSdaData.append(1);
+        // SCL is high when there isn't any active transfer; otherwise 0
+        if (mTransfer) {
+            mScl.append(0, samples);
+        } else {
+            mScl.append(1, samples);
         }
+
+        // always keep SDA high
+        mSda.append(1, samples);
     } while(0);
 
     return success;
@@ -392,11 +390,10 @@ bool I2CGenerator::add8Bits(int value)
         }
 
         // clock cycle
-        mSclData.append(0);
-        mSclData.append(1);
+        mScl.append(0);
+        mScl.append(1);
 
-        mSdaData.append(level);
-        mSdaData.append(level);
+        mSda.append(level, 2);
 
         mask >>= 1;
     }
@@ -20,6 +20,7 @@
 #include <QVector>
 
 #include "common/types.h"
+#include "digitaledgelist.h"
 
 class I2CGenerator : public QObject
 {
@@ -32,8 +33,8 @@ public:
     void setI2CRate(int rate);
     int sampleRate();
     bool generateFromString(QString s);
-    QVector<int> sclData();
-    QVector<int> sdaData();
+    DigitalEdgeList sclEdges();
+    DigitalEdgeList sdaEdges();
 
     
 signals:
@@ -43,8 +44,8 @@ public slots:
 private:
     Types::I2CAddress mAddressType;
     int mI2CRate;
-    QVector<int> mSclData;
-    QVector<int> mSdaData;
+    DigitalEdgeList mScl;
+    DigitalEdgeList mSda;
     bool mTransfer;
 
     bool addStart();
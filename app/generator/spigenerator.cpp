@@ -24,6 +24,9 @@
 
     \ingroup Generator
 
+    The signals are stored as DigitalEdgeList objects with one state for
+    each half clock cycle, see \ref sampleRate.
+
 */
 
 /*!
@@ -90,10 +93,10 @@ bool SpiGenerator::generateFromString(QString s)
     bool success = true;
 
     // reset data
-    mSckData.clear();
-    mMosiData.clear();
-    mMisoData.clear();
-    mCsData.clear();
+    mSck.clear();
+    mMosi.clear();
+    mMiso.clear();
+    mCs.clear();
     mEnableOn = false;
 
 
@@ -126,35 +129,62 @@ bool SpiGenerator::generateFromString(QString s)
 */
 
 /*!
-    \fn QVector<int> SpiGenerator::sckData()
+    \fn DigitalEdgeList SpiGenerator::sckEdges()
 
     Returns the SCK signal data.
 */
 
 /*!
-    \fn QVector<int> SpiGenerator::mosiData()
+    \fn DigitalEdgeList SpiGenerator::mosiEdges()
 
     Returns the MOSI signal data.
 */
 
 /*!
-    \fn QVector<int> SpiGenerator::misoData()
+    \fn DigitalEdgeList SpiGenerator::misoEdges()
 
     Returns the MISO signal data.
 */
 
 /*!
-    \fn QVector<int> SpiGenerator::enableData()
+    \fn DigitalEdgeList SpiGenerator::enableEdges()
 
     Returns the SPI signal data.
 */
 
+/*!
+    Returns the level of the enable signal for the current enable state.
+*/
+int SpiGenerator::enableLevel()
+{
+    // active low
+    if ((mEnableOn && mEnable == Types::SpiEnableLow)
+            || (!mEnableOn && mEnable == Types::SpiEnableHigh)) {
+        return 0;
+    }
+
+    // active high
+    return 1;
+}
+
+/*!
+    Returns the level of the clock signal when it is idle.
+*/
+int SpiGenerator::idleClockLevel()
+{
+    if (mMode == Types::SpiMode_0 || mMode == Types::SpiMode_1) {
+        // CPOL == 0
+        return 0;
+    }
+
+    // CPOL == 1
+    return 1;
+}
 
 /*!
-    Add enable state with \a value. The parameter \a onlyEnable is
-    set to true of only the enable signal should be affected.
+    Add enable state with \a value.
 */
-bool SpiGenerator::addEnable(QString value, bool onlyEnable)
+bool SpiGenerator::addEnable(QString value)
 {
     bool success = true;
 
@@ -169,31 +199,10 @@ bool SpiGenerator::addEnable(QString value, bool onlyEnable)
 
         mEnableOn = (e == 1);
 
-        // active low
-        if ((mEnableOn && mEnable == Types::SpiEnableLow)
-                || (!mEnableOn && mEnable == Types::SpiEnableHigh)) {
-            mCsData.append(0);
-        }
-
-        // active high
-        else {
-            mCsData.append(1);
-        }
-
-        if (!onlyEnable) {
-            mMosiData.append(0);
-            mMisoData.append(0);
-
-            if (mMode == Types::SpiMode_0 || mMode == Types::SpiMode_1) {
-                // CPOL == 0
-                mSckData.append(0);
-            }
-            else {
-                // CPOL == 1
-                mSckData.append(1);
-            }
-
-        }
+        mCs.append(enableLevel());
+        mMosi.append(0);
+        mMiso.append(0);
+        mSck.append(idleClockLevel());
 
 
     } while(0);
@@ -248,28 +257,10 @@ bool SpiGenerator::addDelay(QString value)
 
         if (!success) break;
 
-        for (int i = 0; i < samples; i++) {
-
-
-            if (mMode == Types::SpiMode_0 || mMode == Types::SpiMode_1) {
-                mSckData.append(0);
-            }
-            else {
-                mSckData.append(1);
-            }
-
-
-            mMosiData.append(0);
-            mMisoData.append(0);
-
-            if (mEnableOn) {
-                addEnable("1", true);
-            }
-            else {
-                addEnable("0", true);
-            }
-
-        }
+        mSck.append(idleClockLevel(), samples);
+        mMosi.append(0, samples);
+        mMiso.append(0, samples);
+        mCs.append(enableLevel(), samples);
     } while(0);
 
     return success;
@@ -298,52 +289,46 @@ void SpiGenerator::addBits(int mosi, int miso)
 #if 0
         // clock cycle
         if (mMode == Types::SpiMode_0 || mMode == Types::SpiMode_1) {
-            mSckData.append(1);
-            mSckData.append(0);
+            mSck.append(1);
+            mSck.append(0);
         }
         else {
-            mSckData.append(0);
-            mSckData.append(1);
+            mSck.append(0);
+            mSck.append(1);
         }
 
-        mMosiData.append(mosiLevel);
-        mMosiData.append(mosiLevel);
-
-        mMisoData.append(misoLevel);
-        mMisoData.append(misoLevel);
+        mMosi.append(mosiLevel, 2);
+        mMiso.append(misoLevel, 2);
 #endif
 
         switch(mMode) {
         case Types::SpiMode_0: // CPOL=0, CPHA=0
-            mSckData.append(0);
-            mSckData.append(1);
+            mSck.append(0);
+            mSck.append(1);
             break;
         case Types::SpiMode_1: // CPOL=0, CPHA=1
-            mSckData.append(1);
-            mSckData.append(0);
+            mSck.append(1);
+            mSck.append(0);
             break;
         case Types::SpiMode_2: // CPOL=1, CPHA=0
-            mSckData.append(1);
-            mSckData.append(0);
+            mSck.append(1);
+            mSck.append(0);
             break;
         case Types::SpiMode_3: // CPOL=1, CPHA=1
-            mSckData.append(0);
-            mSckData.append(1);
+            mSck.append(0);
+            mSck.append(1);
             break;
         default:
             break;
         }
 
 
-        mMosiData.append(mosiLevel);
-        mMosiData.append(mosiLevel);
-
-        mMisoData.append(misoLevel);
-        mMisoData.append(misoLevel);
+        mMosi.append(mosiLevel, 2);
+        mMiso.append(misoLevel, 2);
 
         // CS enable
-        addEnable("1", true);
-        addEnable("1", true);
+        mEnableOn = true;
+        mCs.append(enableLevel(), 2);
 
         mask >>= 1;
 
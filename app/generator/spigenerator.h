@@ -20,6 +20,7 @@
 #include <QVector>
 
 #include "common/types.h"
+#include "digitaledgelist.h"
 
 class SpiGenerator : public QObject
 {
@@ -35,10 +36,10 @@ public:
     bool generateFromString(QString s);
 
     int sampleRate() {return mRate*2;}
-    QVector<int> sckData() {return mSckData;}
-    QVector<int> mosiData() {return mMosiData;}
-    QVector<int> misoData() {return mMisoData;}
-    QVector<int> enableData() {return mCsData;}
+    DigitalEdgeList sckEdges() {return mSck;}
+    DigitalEdgeList mosiEdges() {return mMosi;}
+    DigitalEdgeList misoEdges() {return mMiso;}
+    DigitalEdgeList enableEdges() {return mCs;}
     
 signals:
     
@@ -50,14 +51,16 @@ private:
     Types::SpiMode mMode;
     Types::SpiEnable mEnable;
 
-    QVector<int> mSckData;
-    QVector<int> mMosiData;
-    QVector<int> mMisoData;
-    QVector<int> mCsData;
+    DigitalEdgeList mSck;
+    DigitalEdgeList mMosi;
+    DigitalEdgeList mMiso;
+    DigitalEdgeList mCs;
 
     bool mEnableOn;
 
-    bool addEnable(QString value, bool onlyEnable=false);
+    int enableLevel();
+    int idleClockLevel();
+    bool addEnable(QString value);
     bool addData(QString value);
     bool addDelay(QString value);
     void addBits(int mosi, int miso);
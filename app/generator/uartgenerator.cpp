@@ -22,6 +22,8 @@
 
     \ingroup Generator
 
+    The signal is stored as a DigitalEdgeList with one state for each bit.
+
 */
 
 /*!
@@ -75,15 +77,15 @@ bool UartGenerator::generate(QByteArray &data)
 {
     int numOnes = 0;
 
-    mUartData.clear();
+    mUart.clear();
 
     // idle line -> high
-    mUartData.append(1);
+    mUart.append(1);
 
     for (int i = 0; i < data.size(); i++) {
 
         // start bit
-        mUartData.append(0);
+        mUart.append(0);
 
         // data
         numOnes = addData(data.at(i));
@@ -92,14 +94,12 @@ bool UartGenerator::generate(QByteArray &data)
         addParity(numOnes);
 
         // stop bit(s)
-        for (int j = 0; j < mNumStopBits; j++) {
-            mUartData.append(1);
-        }
+        mUart.append(1, mNumStopBits);
 
     }
 
     // idle line -> high
-    mUartData.append(1);
+    mUart.append(1);
 
     return true;
 }
@@ -107,9 +107,9 @@ bool UartGenerator::generate(QByteArray &data)
 /*!
     Returns UART signal data.
 */
-QVector<int> UartGenerator::uartData()
+DigitalEdgeList UartGenerator::uartEdges()
 {
-    return mUartData;
+    return mUart;
 }
 
 /*!
@@ -132,23 +132,23 @@ void UartGenerator::addParity(int numOnes)
         break;
     case Types::ParityOdd:
         if ((numOnes % 2) == 0) {
-            mUartData.append(1);
+            mUart.append(1);
         } else {
-            mUartData.append(0);
+            mUart.append(0);
         }
         break;
     case Types::ParityEven:
         if ((numOnes % 2) == 0) {
-            mUartData.append(0);
+            mUart.append(0);
         } else {
-            mUartData.append(1);
+            mUart.append(1);
         }
         break;
     case Types::ParityMark:
-        mUartData.append(1);
+        mUart.append(1);
         break;
     case Types::ParitySpace:
-        mUartData.append(0);
+        mUart.append(0);
         break;
     default:
         break;
@@ -165,11 +165,11 @@ int UartGenerator::addData(char data)
     // LSB first (do we also need to support MSB first)
     for (int i = 0; i < mNumDataBits; i++) {
         if ( (data & (1<<i)) != 0) {
-            mUartData.append(1);
+            mUart.append(1);
             numOnes++;
         }
         else {
-            mUartData.append(0);
+            mUart.append(0);
         }
     }
 
@@ -20,6 +20,7 @@
 #include <QVector>
 
 #include "common/types.h"
+#include "digitaledgelist.h"
 
 class UartGenerator : public QObject
 {
@@ -34,7 +35,7 @@ public:
     void setParity(Types::UartParity parity);
 
     bool generate(QByteArray &data);
-    QVector<int> uartData();
+    DigitalEdgeList uartEdges();
     int sampleRate();
 
     
@@ -48,7 +49,7 @@ private:
     int mNumStopBits;
     Types::UartParity mParity;
 
-    QVector<int> mUartData;
+    DigitalEdgeList mUart;
 
     void addParity(int numOnes);
     int addData(char data);
@@ -51,6 +51,16 @@ void UiAnalogShape::setWaveform(AnalogSignal::AnalogWaveform form)
     update();
 }
 
+/*!
+    Set the normalized (-1..1) shape used when painting an arbitrary
+    waveform to \a data.
+*/
+void UiAnalogShape::setArbitraryData(const QVector<double> &data)
+{
+    mArbitraryData = data;
+    update();
+}
+
 /*!
     Paint event handler responsible for painting this widget.
 */
@@ -80,6 +90,9 @@ void UiAnalogShape::paintEvent(QPaintEvent *event)
     case AnalogSignal::WaveformTriangle:
         paintTriangle(&painter, w, h);
         break;
+    case AnalogSignal::WaveformArbitrary:
+        paintArbitrary(&painter, w, h);
+        break;
     default:
         break;
     }
@@ -190,3 +203,38 @@ void UiAnalogShape::paintTriangle(QPainter* painter, int w, int h)
 
     painter->restore();
 }
+
+/*!
+    Paint an arbitrary analog waveform.
+*/
+void UiAnalogShape::paintArbitrary(QPainter* painter, int w, int h)
+{
+    int n = mArbitraryData.size();
+    if (n == 0) return;
+
+    QPainterPath path;
+
+    for (int i = 0; i < w; i++) {
+        int idx = (int)(((qint64)i * n) / w);
+
+        double y = (h/2) - (h/2)*mArbitraryData.at(idx);
+        if (i == 0) {
+            path.moveTo(i, y);
+        } else {
+            path.lineTo(i, y);
+        }
+    }
+
+    painter->save();
+
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    QPen pen = painter->pen();
+    pen.setWidth(2);
+    pen.setColor(Qt::blue);
+    painter->setPen(pen);
+
+    painter->drawPath(path);
+
+    painter->restore();
+}
@@ -55,7 +55,8 @@ UiDigitalGenerator::UiDigitalGenerator(DigitalSignals* digitalSignals,
     GeneratorDevice* device = DeviceManager::instance().activeDevice()
             ->generatorDevice();
     if (device != NULL) {
-        defaultStates = device->maxNumDigitalStates();
+        defaultStates = qMin(device->maxNumDigitalStates(),
+                             (int)MaxDefaultStates);
     }
 
     // Deallocation: ownership changed when calling setLayout
@@ -139,7 +140,7 @@ void UiDigitalGenerator::handleDeviceChanged()
 
     // ### selected number of states
 
-    int states = device->maxNumDigitalStates();
+    int states = qMin(device->maxNumDigitalStates(), (int)MaxDefaultStates);
     if (digitalSignals.size() > 0) {
         // Use num states for the first digital
         // signal as num states. All signals have the same size.
@@ -45,6 +45,12 @@ public slots:
 
 private:
 
+    enum Constants {
+        // Number of states to start with, devices can support
+        // many more but they are hard to edit in the table
+        MaxDefaultStates = 256
+    };
+
     QTableView *mTable;
     DigitalSignals* mSignals;
 
@@ -17,6 +17,12 @@
 
 #include <QHBoxLayout>
 #include <QFormLayout>
+#include <QFile>
+#include <QFileDialog>
+#include <QMenu>
+#include <QMessageBox>
+#include <QRegExp>
+#include <QTextStream>
 
 #include "common/stringutil.h"
 #include "device/devicemanager.h"
@@ -53,6 +59,7 @@ UiEditAnalog::UiEditAnalog(AnalogSignal *signal, QWidget *parent) :
 
     // Deallocation: "Qt Object trees" (See UiMainWindow)
     mShape = new UiAnalogShape(this);
+    mShape->setArbitraryData(mSignal->arbitraryData());
     mShape->setWaveform(mSignal->waveform());
 
     mWaveBox = createWaveformBox(mSignal->waveform());
@@ -66,6 +73,10 @@ UiEditAnalog::UiEditAnalog(AnalogSignal *signal, QWidget *parent) :
     mAmpBox->setValue(mSignal->amplitude());
     settingsLayout->addRow(tr("Amplitude:"), mAmpBox);
 
+    mLoadButton = createLoadButton();
+    mLoadButton->setEnabled(mSignal->waveform() == AnalogSignal::WaveformArbitrary);
+    settingsLayout->addRow(tr("Shape:"), mLoadButton);
+
     layout->addLayout(settingsLayout);
     layout->addWidget(mShape);
 
@@ -109,6 +120,10 @@ QComboBox* UiEditAnalog::createWaveformBox(
                 box->addItem("Triangle",
                              QVariant(AnalogSignal::WaveformTriangle));
                 break;
+            case AnalogSignal::WaveformArbitrary:
+                box->addItem("Arbitrary",
+                             QVariant(AnalogSignal::WaveformArbitrary));
+                break;
             default:
                 break;
             }
@@ -170,6 +185,117 @@ QDoubleSpinBox* UiEditAnalog::createAmplitudeBox()
     return box;
 }
 
+/*!
+    Creates and returns a button used to load the shape of an arbitrary
+    waveform.
+*/
+QPushButton* UiEditAnalog::createLoadButton()
+{
+    // Deallocation: ownership changed when calling setLayout
+    QPushButton* button = new QPushButton(tr("Load..."), this);
+    button->setToolTip(tr("Load one period of the waveform from a file "
+                          "or from a captured analog signal"));
+
+    connect(button, SIGNAL(clicked()), this, SLOT(loadArbitraryData()));
+
+    return button;
+}
+
+/*!
+    Reads the values of an arbitrary waveform from the text file \a path
+    into \a values. Each line holds one value in Volts. If a line has
+    several comma, semicolon or white space separated columns (e.g. a file
+    exported from the capture window) the last column is used. Lines that
+    cannot be parsed, such as headers, are skipped.
+
+    Returns false if no values could be read.
+*/
+bool UiEditAnalog::readArbitraryFile(const QString &path, QVector<double> &values)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QRegExp separators("[,;\\s]+");
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QStringList fields = in.readLine().trimmed().split(separators,
+                                                           QString::SkipEmptyParts);
+        if (fields.isEmpty()) continue;
+
+        bool ok = false;
+        double v = fields.last().toDouble(&ok);
+        if (ok) {
+            values.append(v);
+        }
+    }
+
+    return !values.isEmpty();
+}
+
+/*!
+    Uses \a values (in Volts) as one period of the arbitrary waveform.
+*/
+void UiEditAnalog::setArbitraryData(const QVector<double> &values)
+{
+    mSignal->setArbitraryData(values);
+    mShape->setArbitraryData(mSignal->arbitraryData());
+    mAmpBox->setValue(mSignal->amplitude());
+}
+
+/*!
+    This function is called when the user wants to load the shape of an
+    arbitrary waveform. The shape can either be read from a file or
+    be copied from a captured analog signal.
+*/
+void UiEditAnalog::loadArbitraryData()
+{
+    QMenu menu(this);
+    QAction* fileAction = menu.addAction(tr("From file..."));
+
+    CaptureDevice* capture = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (capture != NULL) {
+        foreach(AnalogSignal* s, capture->analogSignals()) {
+            if (capture->analogData(s->id()) == NULL) continue;
+
+            QAction* a = menu.addAction(tr("From captured %1").arg(s->name()));
+            a->setData(QVariant(s->id()));
+        }
+    }
+
+    QAction* selected = menu.exec(mLoadButton->mapToGlobal(
+                                      QPoint(0, mLoadButton->height())));
+    if (selected == NULL) return;
+
+    QVector<double> values;
+
+    if (selected == fileAction) {
+        QString path = QFileDialog::getOpenFileName(
+                    this,
+                    tr("Load Waveform"),
+                    QDir::currentPath(),
+                    "Comma Separated values (*.csv);;All files (*)");
+
+        if (path.isNull() || path.isEmpty()) return;
+
+        if (!readArbitraryFile(path, values)) {
+            QMessageBox::warning(this, tr("Load Waveform"),
+                                 tr("Could not find any values in %1").arg(path));
+            return;
+        }
+    }
+    else {
+        QVector<double>* data = capture->analogData(selected->data().toInt());
+        if (data == NULL) return;
+
+        values = *data;
+    }
+
+    setArbitraryData(values);
+}
+
 /*!
     This function is called when the name of the signal is changed.
 */
@@ -235,6 +361,7 @@ void UiEditAnalog::changeWaveform(int selectedIdx)
 
     mShape->setWaveform(static_cast<AnalogSignal::AnalogWaveform>(w));
     mSignal->setWaveform(static_cast<AnalogSignal::AnalogWaveform>(w));
+    mLoadButton->setEnabled(w == AnalogSignal::WaveformArbitrary);
 }
 
 /*!
@@ -20,6 +20,7 @@
 #include <QComboBox>
 #include <QLineEdit>
 #include <QDoubleSpinBox>
+#include <QPushButton>
 
 #include "device/analogsignal.h"
 
@@ -44,17 +45,23 @@ private:
     QString mLastRateText;
     QComboBox* mWaveBox;
     QDoubleSpinBox* mAmpBox;
+    QPushButton* mLoadButton;
     UiAnalogShape* mShape;
 
     QComboBox* createWaveformBox(AnalogSignal::AnalogWaveform selected = AnalogSignal::WaveformSine);
     QLineEdit* createFrequencyBox();
     QDoubleSpinBox *createAmplitudeBox();
+    QPushButton* createLoadButton();
+
+    bool readArbitraryFile(const QString &path, QVector<double> &values);
+    void setArbitraryData(const QVector<double> &values);
 
 private slots:
     void handleNameEdited();
     void updateRate();
     void changeWaveform(int selectedIdx);
     void amplitudeChanged(double v);
+    void loadArbitraryData();
     
 };
 
@@ -0,0 +1,17 @@
+QT += testlib
+QT -= gui
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_analoglevelsearch
+
+SOURCES += \
+    tst_analoglevelsearch.cpp \
+    ../../device/analoglevelsearch.cpp
+
+HEADERS += \
+    ../../device/analoglevelsearch.h \
+    ../../common/sampletime.h
+
+INCLUDEPATH += ../..
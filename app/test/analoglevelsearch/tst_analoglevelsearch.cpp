@@ -0,0 +1,303 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QtTest>
+
+#include "device/analoglevelsearch.h"
+
+Q_DECLARE_METATYPE(AnalogLevelSearch::Edge)
+
+/*
+    Checks the crossings found by AnalogLevelSearch in short hand made
+    signals and, in a long noisy signal, compares them with a search that
+    looks at every sample instead of using the block summaries.
+*/
+class TestAnalogLevelSearch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void equalLevels();
+    void hysteresis();
+    void nthCrossing();
+    void bufferEnds();
+    void startOnLevel();
+    void longSignal_data();
+    void longSignal();
+
+private:
+
+    enum Constants {
+        // many blocks of AnalogLevelSearch
+        NumSamples = 100000
+    };
+
+    static QVector<double> samples(const double* values, int n);
+    static SampleIndex slowNext(const QVector<double> &data, AnalogLevelSearch::Edge edge,
+                                double low, double high, SampleIndex fromIdx);
+    static SampleIndex slowPrevious(const QVector<double> &data, AnalogLevelSearch::Edge edge,
+                                    double low, double high, SampleIndex fromIdx);
+};
+
+QVector<double> TestAnalogLevelSearch::samples(const double* values, int n)
+{
+    QVector<double> data;
+    for (int i = 0; i < n; i++) {
+        data.append(values[i]);
+    }
+    return data;
+}
+
+/*
+    Returns the next crossing in the same way as AnalogLevelSearch::next()
+    but looks at every sample.
+*/
+SampleIndex TestAnalogLevelSearch::slowNext(const QVector<double> &data,
+                                            AnalogLevelSearch::Edge edge,
+                                            double low, double high, SampleIndex fromIdx)
+{
+    if (edge == AnalogLevelSearch::AnyEdge) {
+        SampleIndex rising = slowNext(data, AnalogLevelSearch::RisingEdge, low, high, fromIdx);
+        SampleIndex falling = slowNext(data, AnalogLevelSearch::FallingEdge, low, high, fromIdx);
+        if (rising == -1) return falling;
+        if (falling == -1) return rising;
+        return qMin(rising, falling);
+    }
+
+    bool falling = (edge == AnalogLevelSearch::FallingEdge);
+    int last = -1;
+    for (int i = (int)qMax(fromIdx, (SampleIndex)0); i < data.size(); i++) {
+        double v = data.at(i);
+        if (falling ? v > high : v < low) {
+            last = i;
+        }
+        else if (last != -1 && (falling ? v <= low : v >= high)) {
+            return (last + 1 + i) / 2;
+        }
+    }
+
+    return -1;
+}
+
+/*
+    Returns the previous crossing in the same way as
+    AnalogLevelSearch::previous() but looks at every sample.
+*/
+SampleIndex TestAnalogLevelSearch::slowPrevious(const QVector<double> &data,
+                                                AnalogLevelSearch::Edge edge,
+                                                double low, double high, SampleIndex fromIdx)
+{
+    if (edge == AnalogLevelSearch::AnyEdge) {
+        return qMax(slowPrevious(data, AnalogLevelSearch::RisingEdge, low, high, fromIdx),
+                    slowPrevious(data, AnalogLevelSearch::FallingEdge, low, high, fromIdx));
+    }
+
+    bool falling = (edge == AnalogLevelSearch::FallingEdge);
+    int first = -1;
+    for (int i = (int)qMin(fromIdx, (SampleIndex)data.size()-1); i >= 0; i--) {
+        double v = data.at(i);
+        if (falling ? v <= low : v >= high) {
+            first = i;
+        }
+        else if (first != -1 && (falling ? v > high : v < low)) {
+            return (i + 1 + first) / 2;
+        }
+    }
+
+    return -1;
+}
+
+void TestAnalogLevelSearch::equalLevels()
+{
+    const double values[] = {0, 0, 1, 1, 0, 0, 1, 1};
+    AnalogLevelSearch search(samples(values, 8));
+
+    // the first sample that reached the level
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 0), (SampleIndex)2);
+    QCOMPARE(search.next(AnalogLevelSearch::FallingEdge, 0.5, 0.5, 0), (SampleIndex)4);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 0), (SampleIndex)2);
+
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 3), (SampleIndex)6);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 3), (SampleIndex)4);
+
+    QCOMPARE(search.previous(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 5), (SampleIndex)2);
+    QCOMPARE(search.previous(AnalogLevelSearch::FallingEdge, 0.5, 0.5, 5), (SampleIndex)4);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 5), (SampleIndex)4);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 3), (SampleIndex)2);
+}
+
+void TestAnalogLevelSearch::hysteresis()
+{
+    // noise within the band doesn't make a crossing
+    const double values[] = {0, 0.45, 0.55, 0.45, 0.55, 1, 1, 0.45, 0.55, 0, 0.5};
+    AnalogLevelSearch search(samples(values, 11));
+
+    // in the middle of the last sample below the band and the first
+    // sample above it
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.4, 0.6, 0), (SampleIndex)3);
+    QCOMPARE(search.next(AnalogLevelSearch::FallingEdge, 0.4, 0.6, 0), (SampleIndex)8);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.4, 0.6, 0), (SampleIndex)3);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.4, 0.6, 0, 2), (SampleIndex)8);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.4, 0.6, 0, 3), (SampleIndex)-1);
+
+    QCOMPARE(search.previous(AnalogLevelSearch::RisingEdge, 0.4, 0.6, 10), (SampleIndex)3);
+    QCOMPARE(search.previous(AnalogLevelSearch::FallingEdge, 0.4, 0.6, 10), (SampleIndex)8);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.4, 0.6, 10), (SampleIndex)8);
+
+    // the falling crossing hasn't reached the low level at sample 8
+    QCOMPARE(search.previous(AnalogLevelSearch::FallingEdge, 0.4, 0.6, 8), (SampleIndex)-1);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.4, 0.6, 8), (SampleIndex)3);
+}
+
+void TestAnalogLevelSearch::nthCrossing()
+{
+    // a pulse train, one sample low and one sample high
+    QVector<double> data;
+    for (int i = 0; i < 20; i++) {
+        data.append(i & 1);
+    }
+    AnalogLevelSearch search(data);
+
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 0, 1), (SampleIndex)1);
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 0, 3), (SampleIndex)5);
+    QCOMPARE(search.next(AnalogLevelSearch::FallingEdge, 0.5, 0.5, 0, 3), (SampleIndex)6);
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 0, 10), (SampleIndex)19);
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 0, 11), (SampleIndex)-1);
+
+    // every sample after the first is a crossing
+    for (int n = 1; n < 20; n++) {
+        QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 0, n), (SampleIndex)n);
+    }
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 0, 20), (SampleIndex)-1);
+}
+
+void TestAnalogLevelSearch::bufferEnds()
+{
+    // crossings at the first and last sample
+    const double values[] = {1, 0, 0, 0, 0, 1};
+    AnalogLevelSearch search(samples(values, 6));
+    QCOMPARE(search.numSamples(), (SampleIndex)6);
+
+    QCOMPARE(search.next(AnalogLevelSearch::FallingEdge, 0.5, 0.5, 0), (SampleIndex)1);
+    QCOMPARE(search.next(AnalogLevelSearch::FallingEdge, 0.5, 0.5, -10), (SampleIndex)1);
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 0), (SampleIndex)5);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 2, 2), (SampleIndex)-1);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 5), (SampleIndex)-1);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 6), (SampleIndex)-1);
+
+    QCOMPARE(search.previous(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 5), (SampleIndex)5);
+    QCOMPARE(search.previous(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 100), (SampleIndex)5);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 4), (SampleIndex)1);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 0), (SampleIndex)-1);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.5, 0.5, -1), (SampleIndex)-1);
+
+    AnalogLevelSearch empty;
+    QCOMPARE(empty.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 0), (SampleIndex)-1);
+    QCOMPARE(empty.previous(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 0), (SampleIndex)-1);
+}
+
+void TestAnalogLevelSearch::startOnLevel()
+{
+    const double values[] = {1, 1, 0.5, 0, 0, 0.5, 1};
+    AnalogLevelSearch search(samples(values, 7));
+
+    // the falling crossing at sample 2 started before it
+    QCOMPARE(search.next(AnalogLevelSearch::FallingEdge, 0.5, 0.5, 0), (SampleIndex)2);
+    QCOMPARE(search.next(AnalogLevelSearch::FallingEdge, 0.5, 0.5, 2), (SampleIndex)-1);
+    QCOMPARE(search.next(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 2), (SampleIndex)5);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 2), (SampleIndex)5);
+    QCOMPARE(search.next(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 5), (SampleIndex)-1);
+
+    // but it has reached the level at sample 2
+    QCOMPARE(search.previous(AnalogLevelSearch::FallingEdge, 0.5, 0.5, 2), (SampleIndex)2);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 2), (SampleIndex)2);
+    QCOMPARE(search.previous(AnalogLevelSearch::RisingEdge, 0.5, 0.5, 4), (SampleIndex)-1);
+    QCOMPARE(search.previous(AnalogLevelSearch::AnyEdge, 0.5, 0.5, 5), (SampleIndex)5);
+}
+
+void TestAnalogLevelSearch::longSignal_data()
+{
+    QTest::addColumn<AnalogLevelSearch::Edge>("edge");
+
+    QTest::newRow("rising") << AnalogLevelSearch::RisingEdge;
+    QTest::newRow("falling") << AnalogLevelSearch::FallingEdge;
+    QTest::newRow("any") << AnalogLevelSearch::AnyEdge;
+}
+
+void TestAnalogLevelSearch::longSignal()
+{
+    QFETCH(AnalogLevelSearch::Edge, edge);
+
+    const double low = 0.9;
+    const double high = 1.1;
+
+    // noise around 0 with pulses of random length at random intervals,
+    // some of them with slow edges and noise around the level
+    QVector<double> data(NumSamples);
+    quint32 random = 12345;
+    int i = 0;
+    while (i < NumSamples) {
+        random = random*1103515245 + 12345;
+        int idle = (random >> 16) % 20000;
+        for (int j = 0; j < idle && i < NumSamples; j++, i++) {
+            random = random*1103515245 + 12345;
+            data[i] = ((random >> 16) % 100) / 1000.0;
+        }
+
+        random = random*1103515245 + 12345;
+        int ramp = (random >> 16) % 50;
+        for (int j = 0; j < ramp && i < NumSamples; j++, i++) {
+            random = random*1103515245 + 12345;
+            data[i] = 2.0*j/ramp + ((random >> 16) % 100) / 500.0 - 0.1;
+        }
+
+        random = random*1103515245 + 12345;
+        int width = 1 + (random >> 16) % 5000;
+        for (int j = 0; j < width && i < NumSamples; j++, i++) {
+            data[i] = 2;
+        }
+    }
+
+    AnalogLevelSearch search(data);
+
+    // from the start of the capture, crossing by crossing; a search that
+    // starts at a crossing finds the next one
+    SampleIndex idx = 0;
+    int count = 0;
+    SampleIndex crossing = slowNext(data, edge, low, high, 0);
+    while (crossing != -1) {
+        count++;
+        QCOMPARE(search.next(edge, low, high, 0, count), crossing);
+        QCOMPARE(search.next(edge, low, high, idx), crossing);
+
+        idx = crossing;
+        crossing = slowNext(data, edge, low, high, idx);
+    }
+    QVERIFY(count > 5);
+    QCOMPARE(search.next(edge, low, high, 0, count + 1), (SampleIndex)-1);
+
+    // from the end of the capture and from positions all over it
+    QCOMPARE(search.previous(edge, low, high, NumSamples - 1),
+             slowPrevious(data, edge, low, high, NumSamples - 1));
+    for (SampleIndex from = 0; from < NumSamples; from += 997) {
+        QCOMPARE(search.next(edge, low, high, from), slowNext(data, edge, low, high, from));
+        QCOMPARE(search.previous(edge, low, high, from),
+                 slowPrevious(data, edge, low, high, from));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestAnalogLevelSearch)
+
+#include "tst_analoglevelsearch.moc"
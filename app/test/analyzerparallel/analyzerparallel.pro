@@ -0,0 +1,38 @@
+QT += testlib
+QT -= gui
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_analyzerparallel
+
+SOURCES += \
+    tst_analyzerparallel.cpp \
+    ../../analyzer/analyzerjob.cpp \
+    ../../analyzer/analyzerannotations.cpp \
+    ../../analyzer/uart/uartdecoder.cpp \
+    ../../analyzer/spi/spidecoder.cpp \
+    ../../analyzer/i2c/i2cdecoder.cpp \
+    ../../generator/uartgenerator.cpp \
+    ../../generator/spigenerator.cpp \
+    ../../generator/i2cgenerator.cpp \
+    ../../generator/digitaledgelist.cpp \
+    ../../common/instrumentation.cpp \
+    ../../common/sampletime.cpp
+
+HEADERS += \
+    ../../analyzer/analyzerjob.h \
+    ../../analyzer/analyzerdecoder.h \
+    ../../analyzer/analyzerannotations.h \
+    ../../analyzer/uart/uartdecoder.h \
+    ../../analyzer/spi/spidecoder.h \
+    ../../analyzer/i2c/i2cdecoder.h \
+    ../../generator/uartgenerator.h \
+    ../../generator/spigenerator.h \
+    ../../generator/i2cgenerator.h \
+    ../../generator/digitaledgelist.h \
+    ../../common/atomichelper.h \
+    ../../common/instrumentation.h \
+    ../../common/sampletime.h
+
+INCLUDEPATH += ../..
@@ -0,0 +1,257 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QtTest>
+#include <QThreadPool>
+
+#include "analyzer/analyzerjob.h"
+#include "analyzer/uart/uartdecoder.h"
+#include "analyzer/spi/spidecoder.h"
+#include "analyzer/i2c/i2cdecoder.h"
+#include "generator/uartgenerator.h"
+#include "generator/spigenerator.h"
+#include "generator/i2cgenerator.h"
+#include "generator/digitaledgelist.h"
+
+/*
+    Checks that AnalyzerDecoderJob's parallel decoding gives the same
+    result as a serial decoding of traffic from the signal generators.
+    The traffic is repeated with random idle periods, like the simulator
+    does, so that the parts decoded on different threads start at all
+    kinds of positions.
+*/
+class TestAnalyzerParallel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void uart_data();
+    void uart();
+    void spi_data();
+    void spi();
+    void i2c_data();
+    void i2c();
+
+private:
+
+    enum Constants {
+        // large enough to be split in NumThreads parts
+        NumSamples = 4500000,
+        NumThreads = 4,
+        Oversampling = 4
+    };
+
+    int mMaxThreadCount;
+
+    static void addDensityRows();
+    static QVector<QVector<int> > busTraffic(QVector<DigitalEdgeList> transaction,
+                                             int density, int oversampling);
+
+    template <typename Core>
+    void compareWithSerial(const Core &core);
+};
+
+void TestAnalyzerParallel::initTestCase()
+{
+    // the decoding is only split in parts if the pool has several threads
+    mMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(NumThreads);
+}
+
+void TestAnalyzerParallel::cleanupTestCase()
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(mMaxThreadCount);
+}
+
+void TestAnalyzerParallel::addDensityRows()
+{
+    QTest::addColumn<int>("density");
+
+    QTest::newRow("busy") << 100;
+    QTest::newRow("half") << 50;
+    QTest::newRow("sparse") << 2;
+}
+
+/*
+    Repeats the \a transaction, one edge list per signal, separated by idle
+    periods so that the bus is busy \a density percent of the time. Returns
+    NumSamples samples per signal, each state lasting \a oversampling
+    samples.
+*/
+QVector<QVector<int> > TestAnalyzerParallel::busTraffic(QVector<DigitalEdgeList> transaction,
+                                                        int density, int oversampling)
+{
+    int txLength = 0;
+    for (int i = 0; i < transaction.size(); i++) {
+        txLength = qMax(txLength, transaction.at(i).length());
+    }
+
+    // all signals must have the same length to stay aligned
+    for (int i = 0; i < transaction.size(); i++) {
+        DigitalEdgeList &tx = transaction[i];
+        tx.append(tx.level(), txLength - tx.length());
+    }
+
+    int meanGap = (txLength * (100 - density)) / density;
+    int numStates = NumSamples / oversampling + 1;
+
+    // the same traffic for every run
+    qsrand(4711 + density);
+
+    QVector<DigitalEdgeList> edges(transaction.size());
+    while (edges.at(0).length() < numStates) {
+        int gap = meanGap/2 + (qrand() % (meanGap + 1));
+        for (int i = 0; i < edges.size(); i++) {
+            edges[i].append(transaction.at(i));
+            edges[i].append(transaction.at(i).level(), gap);
+        }
+    }
+
+    QVector<QVector<int> > data(edges.size());
+    for (int i = 0; i < edges.size(); i++) {
+        edges.at(i).expand(data[i], NumSamples, oversampling, 1);
+    }
+    return data;
+}
+
+template <typename Core>
+void TestAnalyzerParallel::compareWithSerial(const Core &core)
+{
+    QVERIFY(core.isValid());
+
+    AnalyzerDecoder<typename Core::State> serial;
+    serial.start(core.initialState(0), false);
+    serial.decode(&core, core.numSamples());
+    const AnalyzerAnnotations &expected = serial.items();
+
+    AnalyzerDecoderJob<Core> job(core, 0, 0, 0);
+    job.run();
+    QVERIFY(job.isDone());
+    QCOMPARE(job.progress(), 100);
+
+    AnalyzerAnnotations actual = job.results();
+
+    QVERIFY(expected.size() > 0);
+    QCOMPARE(actual.size(), expected.size());
+
+    for (int i = 0; i < expected.size(); i++) {
+        if (expected.startIdx(i) != actual.startIdx(i)
+                || expected.type(i) != actual.type(i)
+                || expected.value(i) != actual.value(i)) {
+            QFAIL(qPrintable(QString("Item %1 of %2 differs").arg(i).arg(expected.size())));
+        }
+    }
+    QVERIFY(actual == expected);
+}
+
+void TestAnalyzerParallel::uart_data()
+{
+    addDensityRows();
+}
+
+void TestAnalyzerParallel::uart()
+{
+    QFETCH(int, density);
+
+    const int baudRate = 115200;
+
+    UartGenerator gen;
+    gen.setBaudRate(baudRate);
+    gen.setDataBits(8);
+    gen.setStopBits(1);
+    gen.setParity(Types::ParityNone);
+
+    QByteArray text = QString("Hello World abcde fghij klmno pqrst uvwxy z0123 45678 9").toLatin1();
+    QVERIFY(gen.generate(text));
+
+    QVector<DigitalEdgeList> transaction;
+    transaction << gen.uartEdges();
+
+    // UART is sampled much faster than the baud rate
+    const int oversampling = 16;
+    QVector<QVector<int> > data = busTraffic(transaction, density, oversampling);
+
+    UartDecoder core;
+    core.setData(data.at(0), baudRate * oversampling);
+    core.setBaudRate(baudRate);
+    core.setDataBits(8);
+    core.setStopBits(1);
+    core.setParity(Types::ParityNone);
+
+    compareWithSerial(core);
+}
+
+void TestAnalyzerParallel::spi_data()
+{
+    addDensityRows();
+}
+
+void TestAnalyzerParallel::spi()
+{
+    QFETCH(int, density);
+
+    SpiGenerator gen;
+    gen.setSpiMode(Types::SpiMode_0);
+    gen.setSpiRate(1000000);
+    gen.setDataBits(8);
+    gen.setEnableMode(Types::SpiEnableLow);
+    QVERIFY(gen.generateFromString("D04,E1,D03,XD1:00,XFF:19,XFF:00,D02,E0,D03,E1,D02,X91:00,XFF:64,XFF:18,D02,E0"));
+
+    QVector<DigitalEdgeList> transaction;
+    transaction << gen.sckEdges() << gen.mosiEdges()
+                << gen.misoEdges() << gen.enableEdges();
+
+    QVector<QVector<int> > data = busTraffic(transaction, density, Oversampling);
+
+    SpiDecoder core;
+    core.setData(data.at(0), data.at(1), data.at(2), data.at(3));
+    core.setDataBits(8);
+    core.setMode(Types::SpiMode_0);
+    core.setEnableMode(Types::SpiEnableLow);
+
+    compareWithSerial(core);
+}
+
+void TestAnalyzerParallel::i2c_data()
+{
+    addDensityRows();
+}
+
+void TestAnalyzerParallel::i2c()
+{
+    QFETCH(int, density);
+
+    I2CGenerator gen;
+    gen.setAddressType(Types::I2CAddress_7bit);
+    gen.setI2CRate(100000);
+    QVERIFY(gen.generateFromString("D04,S,W060,A,X16,A,X00,A,X00,A,X00,A,X40,A,P,S,W060,A,X00,A,P,S,R060,A,X3F,N,P,S,W060,A,X01,A,P,S,R060,A,X7F,N,P"));
+
+    QVector<DigitalEdgeList> transaction;
+    transaction << gen.sclEdges() << gen.sdaEdges();
+
+    QVector<QVector<int> > data = busTraffic(transaction, density, Oversampling);
+
+    I2CDecoder core;
+    core.setData(data.at(0), data.at(1));
+
+    compareWithSerial(core);
+}
+
+QTEST_APPLESS_MAIN(TestAnalyzerParallel)
+
+#include "tst_analyzerparallel.moc"
@@ -0,0 +1,16 @@
+QT += testlib
+QT -= gui
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_labtooldactable
+
+SOURCES += \
+    tst_labtooldactable.cpp \
+    ../../device/labtool/labtooldactable.cpp
+
+HEADERS += \
+    ../../device/labtool/labtooldactable.h
+
+INCLUDEPATH += ../..
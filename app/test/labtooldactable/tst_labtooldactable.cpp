@@ -0,0 +1,176 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QtTest>
+
+#include "device/labtool/labtooldactable.h"
+
+class TestLabToolDacTable : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void tableSize();
+    void sineLevels();
+    void squareLevels();
+    void triangleLevels();
+    void arbitraryLevels();
+    void resample();
+    void packValue();
+    void packClamp();
+    void packTable();
+
+private:
+    void compareLevels(const QVector<double> &actual, const double* expected, int n);
+};
+
+void TestLabToolDacTable::compareLevels(const QVector<double> &actual, const double* expected, int n)
+{
+    QCOMPARE(actual.size(), n);
+    for (int i = 0; i < n; i++) {
+        QVERIFY2(qAbs(actual.at(i) - expected[i]) < 1e-9,
+                 qPrintable(QString("level %1 is %2, expected %3")
+                            .arg(i).arg(actual.at(i)).arg(expected[i])));
+    }
+}
+
+void TestLabToolDacTable::tableSize()
+{
+    QCOMPARE(LabToolDacTable::tableSize(1000, 1), 300);
+    QCOMPARE(LabToolDacTable::tableSize(1000, 2), 150);
+
+    // the DAC rate is shared, an invalid channel count means one channel
+    QCOMPARE(LabToolDacTable::tableSize(1000, 0), 300);
+
+    // limited to the size of the lookup table in the firmware
+    QCOMPARE(LabToolDacTable::tableSize(100, 1), (int)LabToolDacTable::MaxTableSize);
+    QCOMPARE(LabToolDacTable::tableSize(0, 1), (int)LabToolDacTable::MaxTableSize);
+
+    // too fast for the DAC, use the smallest possible table
+    QCOMPARE(LabToolDacTable::tableSize(200000, 2), (int)LabToolDacTable::MinTableSize);
+}
+
+void TestLabToolDacTable::sineLevels()
+{
+    const double expected[] = {0, 2, 0, -2};
+    QVector<double> levels = LabToolDacTable::waveformLevels(
+                AnalogSignal::WaveformSine, 2, QVector<double>(), 4);
+    compareLevels(levels, expected, 4);
+}
+
+void TestLabToolDacTable::squareLevels()
+{
+    const double expected[] = {1.5, 1.5, 1.5, -1.5, -1.5, -1.5};
+    QVector<double> levels = LabToolDacTable::waveformLevels(
+                AnalogSignal::WaveformSquare, 1.5, QVector<double>(), 6);
+    compareLevels(levels, expected, 6);
+}
+
+void TestLabToolDacTable::triangleLevels()
+{
+    const double expected[] = {-1, 0, 1, 0};
+    QVector<double> levels = LabToolDacTable::waveformLevels(
+                AnalogSignal::WaveformTriangle, 1, QVector<double>(), 4);
+    compareLevels(levels, expected, 4);
+}
+
+void TestLabToolDacTable::arbitraryLevels()
+{
+    QVector<double> shape;
+    shape << 0 << 1;
+
+    const double expected[] = {0, 1, 2, 1};
+    QVector<double> levels = LabToolDacTable::waveformLevels(
+                AnalogSignal::WaveformArbitrary, 2, shape, 4);
+    compareLevels(levels, expected, 4);
+
+    // the shape is only used by the arbitrary waveform
+    QVERIFY(LabToolDacTable::waveformLevels(
+                AnalogSignal::WaveformArbitrary, 2, QVector<double>(), 4).isEmpty());
+    QVERIFY(LabToolDacTable::waveformLevels(
+                AnalogSignal::WaveformSine, 2, shape, 0).isEmpty());
+}
+
+void TestLabToolDacTable::resample()
+{
+    QVector<double> samples;
+    samples << 0 << 4 << 8 << 4;
+
+    // downsampling picks every other point
+    const double half[] = {0, 8};
+    compareLevels(LabToolDacTable::resample(samples, 2), half, 2);
+
+    // upsampling interpolates and wraps to the start of the period
+    const double twice[] = {0, 2, 4, 6, 8, 6, 4, 2};
+    compareLevels(LabToolDacTable::resample(samples, 8), twice, 8);
+
+    // same size is unchanged
+    QCOMPARE(LabToolDacTable::resample(samples, 4), samples);
+
+    QVERIFY(LabToolDacTable::resample(QVector<double>(), 4).isEmpty());
+    QVERIFY(LabToolDacTable::resample(samples, 0).isEmpty());
+}
+
+void TestLabToolDacTable::packValue()
+{
+    // Vout = A + B * hex
+    const double a = -5.0;
+    const double b = 10.0 / LabToolDacTable::MaxDacValue;
+
+    // channel bit 14, bit 12 always set, 10 value bits in bits 2..11
+    QCOMPARE(LabToolDacTable::pack(0, a, a, b), (quint16)0x1000);
+    QCOMPARE(LabToolDacTable::pack(1, a, a, b), (quint16)0x5000);
+    QCOMPARE(LabToolDacTable::pack(0, a + 5 * b, a, b), (quint16)(0x1000 | (5 << 2)));
+    QCOMPARE(LabToolDacTable::pack(1, 5.0, a, b), (quint16)0x5ffc);
+
+    // rounds to the nearest DAC value
+    QCOMPARE(LabToolDacTable::pack(0, a + 5.4 * b, a, b), (quint16)(0x1000 | (5 << 2)));
+    QCOMPARE(LabToolDacTable::pack(0, a + 5.6 * b, a, b), (quint16)(0x1000 | (6 << 2)));
+}
+
+void TestLabToolDacTable::packClamp()
+{
+    const double a = -5.0;
+    const double b = 10.0 / LabToolDacTable::MaxDacValue;
+
+    QCOMPARE(LabToolDacTable::pack(0, -100.0, a, b), (quint16)0x1000);
+    QCOMPARE(LabToolDacTable::pack(0, 100.0, a, b), (quint16)0x1ffc);
+
+    // invalid calibration data gives the lowest level
+    QCOMPARE(LabToolDacTable::pack(0, 1.0, a, 0), (quint16)0x1000);
+}
+
+void TestLabToolDacTable::packTable()
+{
+    const double a = 0;
+    const double b = 0.01;
+
+    QVector<double> levels;
+    levels << 0 << 0.01 << 10.23;
+
+    QVector<quint16> out;
+    out << 0x1234;
+    LabToolDacTable::pack(1, levels, a, b, out);
+
+    QCOMPARE(out.size(), 4);
+    QCOMPARE(out.at(0), (quint16)0x1234); // existing entries are kept
+    QCOMPARE(out.at(1), (quint16)0x5000);
+    QCOMPARE(out.at(2), (quint16)0x5004);
+    QCOMPARE(out.at(3), (quint16)0x5ffc);
+}
+
+QTEST_APPLESS_MAIN(TestLabToolDacTable)
+
+#include "tst_labtooldactable.moc"
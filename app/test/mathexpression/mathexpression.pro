@@ -0,0 +1,25 @@
+QT += testlib
+QT -= gui
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_mathexpression
+
+SOURCES += \
+    tst_mathexpression.cpp \
+    ../../capture/mathexpression.cpp \
+    ../../capture/mathchannel.cpp \
+    ../../common/backgroundjob.cpp \
+    ../../common/instrumentation.cpp \
+    ../../common/sampletime.cpp
+
+HEADERS += \
+    ../../capture/mathexpression.h \
+    ../../capture/mathchannel.h \
+    ../../common/atomichelper.h \
+    ../../common/backgroundjob.h \
+    ../../common/instrumentation.h \
+    ../../common/sampletime.h
+
+INCLUDEPATH += ../..
@@ -0,0 +1,303 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QtTest>
+#include <qmath.h>
+
+#include "capture/mathexpression.h"
+#include "capture/mathchannel.h"
+
+/*
+    Checks the parser of MathExpression and that MathChannel, which
+    evaluates an expression one chunk at a time and keeps the block ranges
+    of the chunks, gives the same samples and ranges as an evaluation of
+    the whole capture at once.
+*/
+class TestMathExpression : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parse_data();
+    void parse();
+    void constant_data();
+    void constant();
+    void inputs();
+    void chunks_data();
+    void chunks();
+
+private:
+
+    enum Constants {
+        SampleRate = 1000000,
+        // several chunks of MathChannel, the last one not full
+        NumSamples = 200000,
+        // MathChannel::RangeBlockSize
+        BlockSize = 1024
+    };
+
+    static QVector<double> testSignal(int n, double freq);
+    static void minMax(const QVector<double> &data, SampleIndex fromIdx, SampleIndex toIdx,
+                       double &min, double &max);
+};
+
+/*
+    Returns \a n samples of a sine with the frequency \a freq (in samples)
+    with a spike every 5000 samples and a little saw tooth noise.
+*/
+QVector<double> TestMathExpression::testSignal(int n, double freq)
+{
+    QVector<double> data(n);
+    for (int i = 0; i < n; i++) {
+        data[i] = qSin(2*M_PI*freq*i) + (i % 5000 == 0 ? 3 : 0) + (i % 7)*0.01;
+    }
+    return data;
+}
+
+/*
+    Sets \a min and \a max to the minimum and maximum of \a data from
+    \a fromIdx up to, but not including, \a toIdx.
+*/
+void TestMathExpression::minMax(const QVector<double> &data, SampleIndex fromIdx,
+                                SampleIndex toIdx, double &min, double &max)
+{
+    min = data.at((int)fromIdx);
+    max = min;
+    for (int i = (int)fromIdx+1; i < toIdx; i++) {
+        min = qMin(min, data.at(i));
+        max = qMax(max, data.at(i));
+    }
+}
+
+void TestMathExpression::parse_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<bool>("valid");
+
+    QTest::newRow("input") << "A0" << true;
+    QTest::newRow("difference") << "A0 - A1" << true;
+    QTest::newRow("average") << "avg(A0*A1, 16)" << true;
+    QTest::newRow("lowpass") << "lowpass(A0, 2M)" << true;
+    QTest::newRow("fir") << "fir(deriv(A1), 500k, 63)" << true;
+    QTest::newRow("nested") << "-(abs(A0) + 1.5e3) / (A1 - 2m)" << true;
+    QTest::newRow("upper case") << "ABS(a0)" << true;
+
+    QTest::newRow("empty") << "" << false;
+    QTest::newRow("missing operand") << "A0 +" << false;
+    QTest::newRow("missing parenthesis") << "(A0 - A1" << false;
+    QTest::newRow("trailing text") << "A0 A1" << false;
+    QTest::newRow("invalid character") << "A0 $ A1" << false;
+    QTest::newRow("unknown function") << "sqrt(A0)" << false;
+    QTest::newRow("too few arguments") << "avg(A0)" << false;
+    QTest::newRow("too many arguments") << "fir(A0, 1k, 31, 2)" << false;
+    QTest::newRow("expression argument") << "avg(A0, A1)" << false;
+    QTest::newRow("zero average") << "avg(A0, 0)" << false;
+    QTest::newRow("zero cut-off") << "lowpass(A0, 0)" << false;
+    QTest::newRow("too many taps") << "fir(A0, 1k, 5000)" << false;
+}
+
+void TestMathExpression::parse()
+{
+    QFETCH(QString, text);
+    QFETCH(bool, valid);
+
+    MathExpression expression;
+    QCOMPARE(expression.parse(text), valid);
+    QCOMPARE(expression.isValid(), valid);
+    QCOMPARE(expression.errorString().isEmpty(), valid);
+    QCOMPARE(expression.text(), text);
+}
+
+void TestMathExpression::constant_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<double>("expected");
+
+    QTest::newRow("integer") << "42" << 42.0;
+    QTest::newRow("decimal") << "0.25" << 0.25;
+    QTest::newRow("exponent") << "1.5e3" << 1500.0;
+    QTest::newRow("negative exponent") << "2e-3" << 0.002;
+
+    QTest::newRow("pico") << "5p" << 5e-12;
+    QTest::newRow("nano") << "4n" << 4e-9;
+    QTest::newRow("micro") << "10u" << 10e-6;
+    QTest::newRow("milli") << "3m" << 0.003;
+    QTest::newRow("kilo") << "1k" << 1000.0;
+    QTest::newRow("mega") << "2.5M" << 2.5e6;
+    QTest::newRow("giga") << "1G" << 1e9;
+    QTest::newRow("suffix and exponent") << "1e3k" << 1e6;
+
+    QTest::newRow("product first") << "1 + 2*3" << 7.0;
+    QTest::newRow("quotient first") << "10 - 6/3" << 8.0;
+    QTest::newRow("parentheses") << "(1 + 2)*3" << 9.0;
+    QTest::newRow("left to right sum") << "1 - 2 - 3" << -4.0;
+    QTest::newRow("left to right product") << "8/4/2" << 1.0;
+    QTest::newRow("unary minus") << "-2*3" << -6.0;
+    QTest::newRow("unary minus operand") << "2*-3" << -6.0;
+    QTest::newRow("suffix in sum") << "1k - 1" << 999.0;
+    QTest::newRow("absolute value") << "abs(1 - 3)" << 2.0;
+    QTest::newRow("division by zero") << "1/0" << 0.0;
+}
+
+void TestMathExpression::constant()
+{
+    QFETCH(QString, text);
+    QFETCH(double, expected);
+
+    MathExpression expression;
+    QVERIFY(expression.parse(text));
+    QVERIFY(expression.inputs().isEmpty());
+
+    QVector<double> out;
+    expression.evaluate(0, 3, out);
+    QCOMPARE(out.size(), 3);
+    for (int i = 0; i < out.size(); i++) {
+        QCOMPARE(out.at(i), expected);
+    }
+}
+
+void TestMathExpression::inputs()
+{
+    QVector<double> a0;
+    QVector<double> a3;
+    for (int i = 0; i < 10; i++) {
+        a0.append(i);
+        a3.append(100 + i);
+    }
+    a3.append(0);
+
+    MathExpression expression;
+    QVERIFY(expression.parse("A3 - 2*a0"));
+    QCOMPARE(expression.inputs(), QList<int>() << 3 << 0);
+    QCOMPARE(expression.numSamples(), (SampleIndex)0);
+
+    expression.setInput(0, a0);
+    expression.setInput(3, a3);
+    QCOMPARE(expression.numSamples(), (SampleIndex)a0.size());
+
+    QVector<double> out;
+    expression.evaluate(2, 7, out);
+    QCOMPARE(out.size(), 5);
+    for (int i = 0; i < out.size(); i++) {
+        QCOMPARE(out.at(i), 100.0 - (2 + i));
+    }
+
+    expression.evaluate(7, 7, out);
+    QVERIFY(out.isEmpty());
+}
+
+void TestMathExpression::chunks_data()
+{
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("arithmetic") << "A0*2 - A1/3";
+    QTest::newRow("average") << "avg(A0, 1000)";
+    QTest::newRow("lowpass") << "lowpass(A0, 10k)";
+    QTest::newRow("fir") << "fir(A0, 20k, 63)";
+    QTest::newRow("derivative") << "deriv(A1 - A0)/1M";
+    QTest::newRow("filter chain") << "abs(lowpass(fir(A0 - A1, 50k), 20k)) + avg(deriv(A0), 100)/1M";
+}
+
+void TestMathExpression::chunks()
+{
+    QFETCH(QString, text);
+
+    // the low-pass filter restarts a little before each chunk, see
+    // MathNode::history()
+    const double tolerance = 1e-5;
+
+    QVector<double> a0 = testSignal(NumSamples, 0.0001);
+    QVector<double> a1 = testSignal(NumSamples + 100, 0.00037);
+
+    MathExpression whole;
+    QVERIFY(whole.parse(text));
+    whole.setSampleRate(SampleRate);
+    whole.setInput(0, a0);
+    whole.setInput(1, a1);
+    QCOMPARE(whole.numSamples(), (SampleIndex)NumSamples);
+
+    QVector<double> expected;
+    whole.evaluate(0, NumSamples, expected);
+    QCOMPARE(expected.size(), (int)NumSamples);
+
+    MathChannel channel;
+    channel.setSampleRate(SampleRate);
+    channel.setInput(0, a0);
+    channel.setInput(1, a1);
+    QVERIFY(channel.setExpression(text));
+    QCOMPARE(channel.numSamples(), (SampleIndex)NumSamples);
+
+    // a zoomed out range needs block ranges, which are calculated by a job
+    double min;
+    double max;
+    QVERIFY(!channel.range(0, NumSamples, min, max));
+    QList<int> chunks = channel.takeMissingChunks();
+    QVERIFY(chunks.size() > 1);
+
+    MathRangeJob job(channel, chunks);
+    job.run();
+    channel.addRanges(job.generation(), job.ranges());
+    QCOMPARE(job.ranges().size(), chunks.size());
+
+    for (SampleIndex from = 0; from < NumSamples; from += 12345) {
+        SampleIndex to = qMin(from + 5000, (SampleIndex)NumSamples);
+
+        // the range is within the blocks overlapping the samples
+        double exactMin;
+        double exactMax;
+        double blockMin;
+        double blockMax;
+        minMax(expected, from, to, exactMin, exactMax);
+        minMax(expected, from / BlockSize * BlockSize,
+               qMin((to + BlockSize - 1) / BlockSize * BlockSize, (SampleIndex)NumSamples),
+               blockMin, blockMax);
+
+        QVERIFY(channel.range(from, to, min, max));
+        QVERIFY(min <= exactMin + tolerance);
+        QVERIFY(max >= exactMax - tolerance);
+        QVERIFY(min >= blockMin - tolerance);
+        QVERIFY(max <= blockMax + tolerance);
+    }
+    QVERIFY(channel.takeMissingChunks().isEmpty());
+
+    // the samples, calculated a chunk at a time
+    for (int i = 0; i < NumSamples; i++) {
+        double v = channel.value(i);
+        if (qAbs(v - expected.at(i)) > tolerance) {
+            QFAIL(qPrintable(QString("Sample %1 is %2, expected %3")
+                             .arg(i).arg(v).arg(expected.at(i))));
+        }
+    }
+
+    // a range shorter than a block uses the samples
+    for (SampleIndex from = 100; from < NumSamples; from += 23456) {
+        double exactMin;
+        double exactMax;
+        minMax(expected, from, from + 500, exactMin, exactMax);
+
+        QVERIFY(channel.range(from, from + 500, min, max));
+        QVERIFY(qAbs(min - exactMin) <= tolerance);
+        QVERIFY(qAbs(max - exactMax) <= tolerance);
+    }
+
+    // the result of a job is dropped if the channel has been cleared
+    channel.clear();
+    channel.addRanges(job.generation(), job.ranges());
+    QVERIFY(!channel.range(0, NumSamples, min, max));
+}
+
+QTEST_APPLESS_MAIN(TestMathExpression)
+
+#include "tst_mathexpression.moc"
@@ -0,0 +1,13 @@
+# Unit tests for the parts of the application that do not need the
+# hardware or the user interface.
+#
+# Build and run all tests with:
+#   qmake test.pro && make && make check
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    labtooldactable \
+    analyzerparallel \
+    mathexpression \
+    analoglevelsearch
@@ -83,6 +83,11 @@ UiMainWindow::UiMainWindow(QWidget *parent) :
     mGenerator = new GeneratorApp(this, this);
     mCapture = new CaptureApp(this, this);
 
+    mInstrumentationDock = new UiInstrumentationDock(this);
+    mInstrumentationDock->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::RightDockWidgetArea);
+    addDockWidget(Qt::BottomDockWidgetArea, mInstrumentationDock);
+    mInstrumentationDock->hide();
+
     createMenubar();
     createToolbar();
     createCentralWidget();
@@ -294,6 +299,16 @@ void UiMainWindow::createOptionMenu()
     }
 
     schemeGroup->setExclusive(true);
+
+    //
+    // Performance measurements of the capture pipeline
+    //
+
+    menu->addSeparator();
+
+    QAction* hudAction = mInstrumentationDock->toggleViewAction();
+    hudAction->setText(tr("Performance HUD"));
+    menu->addAction(hudAction);
 }
 
 /*!
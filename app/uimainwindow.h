@@ -23,6 +23,7 @@
 #include "generator/generatorapp.h"
 
 #include "capture/captureapp.h"
+#include "common/uiinstrumentationdock.h"
 
 class UiMainWindow : public QMainWindow
 {
@@ -54,6 +55,7 @@ private:
 
     GeneratorApp* mGenerator;
     CaptureApp* mCapture;
+    UiInstrumentationDock* mInstrumentationDock;
 
     QMenu* mDeviceMenu;
     QMenu* mColorSchemeMenu;
@@ -0,0 +1,94 @@
+/*!
+ * @file
+ * @brief     Packing of captured analog samples for transfer to the client
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __CAPTURE_VADC_PACK_H
+#define __CAPTURE_VADC_PACK_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+/* Only standard types are used so that the same code can be built for the
+ * client software which unpacks the samples. */
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! @brief Format of the packed analog samples.
+ *
+ * The VADC stores each sample as a 16-bit word with the channel number in
+ * bits 12-14, an "empty" marker in bit 15 and the value in bits 0-11. On
+ * the wire only the 12-bit values are sent, two values in three bytes:
+ *
+ * Byte | Content
+ * :--: | -------
+ *   0  | Bits 0-7 of the first value
+ *   1  | Bits 8-11 of the first value in bits 0-3, bits 0-3 of the second value in bits 4-7
+ *   2  | Bits 4-11 of the second value
+ *
+ * The values are sent in blocks, each starting with a 4 byte header:
+ *
+ * Byte | Content
+ * :--: | -------
+ *  0-1 | Number of values in the block (little endian)
+ *   2  | Channel of the first value. With two channels the values alternate.
+ *   3  | Flags, see \ref VADC_PACK_FLAG_SKIP
+ *
+ * If the number of values is odd the last value takes two bytes, with
+ * bits 8-11 in the lower half of the second byte.
+ *
+ * Empty markers are never sent. A new block is started when two values in
+ * a row belong to the same channel (i.e. a value for the other channel
+ * was skipped by the VADC), so the channel order is always given by the
+ * block header.
+ */
+#define VADC_PACK_HEADER_SIZE     4
+
+/*! Largest number of values in one block */
+#define VADC_PACK_MAX_VALUES      1024
+
+/*! Largest size of one block in bytes */
+#define VADC_PACK_MAX_BLOCK_SIZE  (VADC_PACK_HEADER_SIZE + (VADC_PACK_MAX_VALUES * 3) / 2)
+
+/*! A value for the other channel is missing right before the first value
+ *  in the block. Only used when two channels are sampled. */
+#define VADC_PACK_FLAG_SKIP       0x01
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+uint32_t cap_vadc_pack_Block(const uint16_t* pSamples, uint32_t numSamples, uint32_t numChannels,
+                             int32_t* pLastChannel, uint8_t* pBlock, uint32_t* pConsumed);
+int32_t cap_vadc_pack_Unpack(const uint8_t* pData, uint32_t size, uint32_t numChannels,
+                             uint16_t* pValues[2], uint32_t numValues[2], uint32_t maxValues,
+                             uint32_t* pNumSkips);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __CAPTURE_VADC_PACK_H */
@@ -31,23 +31,42 @@
  * Typedefs and defines
  *****************************************************************************/
 
+/*! @brief The maximum number of memory regions a circular buffer can span */
+#define CIRCBUFF_MAX_SEGMENTS  3
+
+/*! @brief One memory region (segment) of a circular buffer. */
+typedef struct
+{
+  uint8_t* data;     /*!< Start of the segment. Never changed. */
+  uint32_t size;     /*!< Current size of the segment */
+  uint32_t maxSize;  /*!< Maximum size of the segment. Never changed. */
+} circbuff_segment_t;
+
 /*! @brief A circular buffer.
  *
- * The \a data and \a maxSize determines the memory area available to
+ * The buffer is made up of one or more segments, each being a contiguous
+ * memory area. The segments are used in order, so that the buffer has one
+ * continuous offset space from 0 to \a size where the first segment
+ * starts at offset 0, the second segment starts where the first one ends
+ * and so on. After the last segment the buffer wraps to the first one.
+ *
+ * The sum of the segments' \a maxSize determines the memory available to
  * the circular buffer. The user of the buffer can further reduce the
- * size (e.g. to get an even multiple of samples to fit) and that only
- * affects the \a size member.
+ * size of each segment (e.g. to get an even multiple of samples to fit)
+ * and that only affects the \a size members.
  *
- * The \a last member is the offset from \a data where the next byte
- * should be written.
+ * The \a last member is the offset where the next byte should be written.
+ * The \a data member is the start of the first segment.
  */
 typedef struct
 {
-  uint8_t* data;     /*!< Start of the data. Never changed. */
-  uint32_t size;     /*!< Current size */
-  uint32_t maxSize;  /*!< Maximum size of data. Never changed. */
+  uint8_t* data;     /*!< Start of the first segment. Never changed. */
+  uint32_t size;     /*!< Current size, sum of all segments */
+  uint32_t maxSize;  /*!< Maximum size of data, sum of all segments. */
   uint32_t last;     /*!< Offset to next byte to write. */
   Bool empty;        /*!< True if the buffer has not been filled yet. */
+  uint32_t numSegments;                               /*!< Number of used segments */
+  circbuff_segment_t segments[CIRCBUFF_MAX_SEGMENTS]; /*!< The memory regions */
 } circbuff_t;
 
 
@@ -60,14 +79,19 @@ typedef struct
  *****************************************************************************/
 
 void circbuff_Init(circbuff_t* pBuff, uint32_t addr, uint32_t maxSize);
-void circbuff_Resize(circbuff_t* pBuff, uint32_t actualSize);
+Bool circbuff_AddSegment(circbuff_t* pBuff, uint32_t addr, uint32_t maxSize);
+uint32_t circbuff_ResizeToMultipleOf(circbuff_t* pBuff, uint32_t unitSize);
 void circbuff_Reset(circbuff_t* pBuff);
 uint32_t circbuff_NextPos(circbuff_t* pBuff, uint32_t incrInBytes);
 uint32_t circbuff_GetFirstAddr(const circbuff_t * const pBuff);
 
 uint32_t circbuff_GetUsedSize(const circbuff_t * const pBuff);
 
+uint32_t circbuff_OffsetToAddress(const circbuff_t * const pBuff, uint32_t offset);
+uint32_t circbuff_AddressToOffset(const circbuff_t * const pBuff, uint32_t addrInBuff);
+uint32_t circbuff_ConvertOffset(const circbuff_t * const pBuff, uint32_t offset);
 uint32_t circbuff_ConvertAddress(const circbuff_t * const pBuff, uint32_t addrInBuff);
+uint32_t circbuff_GetContiguous(const circbuff_t * const pBuff, uint32_t pos, uint32_t* pAddr);
 
 #endif /* end __CIRCBUFF_H */
 
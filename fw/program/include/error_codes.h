@@ -58,6 +58,7 @@ typedef enum
   CMD_STATUS_ERR_GEN_INVALID_RUN_COUNTER,
   CMD_STATUS_ERR_GEN_INVALID_NUMBER_OF_STATES,
   CMD_STATUS_ERR_GEN_INVALID_AMPLITUDE,
+  CMD_STATUS_ERR_GEN_INVALID_PATTERN,
 
   /* Related to I2C monitoring */
   CMD_STATUS_ERR_MON_I2C_PCA95555_FAILED = 40,
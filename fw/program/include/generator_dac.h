@@ -41,8 +41,13 @@
 #define GEN_DAC_CFG_WAVE_SAWTOOTH      3
 #define GEN_DAC_CFG_WAVE_INV_SAWTOOTH  4
 #define GEN_DAC_CFG_WAVE_LEVEL         5
+#define GEN_DAC_CFG_WAVE_ARBITRARY     6
 /* \} */
 
+/*! Maximum number of entries in a lookup table, also the largest
+ *  allowed \a lutSize for a \ref GEN_DAC_CFG_WAVE_ARBITRARY waveform */
+#define GEN_DAC_MAX_LUT_SIZE  2000
+
 /*! @brief Configuration of one analog signal to generate.
  */
 typedef struct
@@ -57,11 +62,20 @@ typedef struct
    *   3   | Sawtooth
    *   4   | Reverse (or inverse) Sawtooth
    *   5   | Level (outputs DC offset, ignores amplitude)
+   *   6   | Arbitrary (lookup table supplied by the client)
    */
   uint32_t waveform;
   uint32_t frequency; /*!< Frequency in Hz */
   uint32_t amplitude; /*!< Amplitude in mV, 0..5000 */
   int32_t  dcOffset;  /*!< DC offset in mV, -5000..5000 */
+
+  /*! @brief Number of lookup table entries supplied by the client.
+   *
+   * Only used for the arbitrary waveform. The entries are already calibrated
+   * and packed with \ref SPI_DAC_VALUE and follow the configuration structure
+   * in the payload, one table per enabled arbitrary channel in channel order.
+   */
+  uint32_t lutSize;
 } gen_dac_one_ch_cfg_t;
 
 /*! @brief Configuration of the analog signal(s) to generate.
@@ -81,7 +95,7 @@ typedef struct
  *****************************************************************************/
 
 void gen_dac_Init(void);
-cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg);
+cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg, const uint16_t* pLUT, uint32_t numLUTValues);
 cmd_status_t gen_dac_Start(void);
 void gen_dac_Stop(void);
 
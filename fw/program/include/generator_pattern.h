@@ -0,0 +1,94 @@
+/*!
+ * @file
+ * @brief     Compression of long digital patterns for the signal generator
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __GENERATOR_PATTERN_H
+#define __GENERATOR_PATTERN_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+/* Only standard types are used so that the same code can be built for the
+ * client software which compresses the patterns. */
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! @brief Record types in a compressed pattern stream.
+ *
+ * A stream is a sequence of 16-bit words. Each record starts with a header
+ * word where bits 14-15 is the record type and bits 0-13 is the count.
+ * A state is one 16-bit word with bit n representing DIO n.
+ *
+ * Type | Record
+ * :--: | ------
+ *   0  | Literal: \a count states follows
+ *   1  | Run: one state follows, it is repeated \a count times
+ *   2  | Repeat: the block length (in words) and the block follows, the block is played \a count times
+ *
+ * The block in a repeat record is made up of other records, so repeat
+ * records can be nested up to \ref GEN_PATTERN_MAX_DEPTH levels.
+ */
+#define GEN_PATTERN_REC_LITERAL  0
+#define GEN_PATTERN_REC_RUN      1
+#define GEN_PATTERN_REC_REPEAT   2
+
+#define GEN_PATTERN_REC_TYPE(__hdr)     (((__hdr) >> 14) & 0x3)
+#define GEN_PATTERN_REC_COUNT(__hdr)    ((__hdr) & 0x3fff)
+#define GEN_PATTERN_REC(__type, __cnt)  ((uint16_t)(((__type) << 14) | ((__cnt) & 0x3fff)))
+
+/*! Largest count that fits in a record header */
+#define GEN_PATTERN_MAX_COUNT   0x3fff
+
+/*! Maximum nesting of repeat records */
+#define GEN_PATTERN_MAX_DEPTH   4
+
+/*! Longest block (in states) that the encoder looks for repetitions of */
+#define GEN_PATTERN_MAX_BLOCK   64
+
+/*! @brief Called by \ref gen_pattern_Decode for each decoded state.
+ *
+ * @param [in] ctx    The context given to \ref gen_pattern_Decode
+ * @param [in] state  The state with bit n representing DIO n
+ * @param [in] count  Number of times (>= 1) in a row that \a state occurs
+ */
+typedef void (*gen_pattern_sink_t)(void* ctx, uint16_t state, uint32_t count);
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+int32_t gen_pattern_Encode(const uint16_t* pStates, uint32_t numStates,
+                           uint16_t* pStream, uint32_t maxWords);
+int32_t gen_pattern_Decode(const uint16_t* pStream, uint32_t numWords, uint32_t maxStates,
+                           gen_pattern_sink_t sink, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __GENERATOR_PATTERN_H */
+
@@ -34,15 +34,24 @@
 
 /*! @brief Configuration of the digital signal(s) to generate.
  * The \a enabledChannels bit mask represents DIO0..DIO9 and DIO_CLK.
+ *
+ * Longer sequences of states are sent as a compressed pattern stream (see
+ * generator_pattern.h) after the configuration. The \a patterns are then
+ * ignored and \a encodedSize is the size of the stream.
  */
 typedef struct
 {
   uint32_t enabledChannels; /*!< using bits 0-10, a 1 means enabled */
   uint32_t frequency;       /*!< Frequency of generated signal */
-  uint32_t numStates;       /*!< Bits per channel 1..256 */
+  uint32_t numStates;       /*!< Bits per channel 1..256, or 1..GEN_SGPIO_MAX_STATES if encoded */
   uint32_t patterns[8][11];  /*!< Up to 8*32 states for up to 11 channels */
+  uint32_t encodedSize;     /*!< Number of 16-bit words in the pattern stream, 0 if not used */
 } gen_sgpio_cfg_t;
 
+/*! Maximum number of states in a compressed pattern stream. The DMA buffers
+ *  can hold 620*32 states but one buffer is needed for the end data. */
+#define GEN_SGPIO_MAX_STATES  (619*32)
+
 /******************************************************************************
  * Global Variables
  *****************************************************************************/
@@ -52,7 +61,7 @@ typedef struct
  *****************************************************************************/
 
 void gen_sgpio_Init(void);
-cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, uint32_t shiftClockPreset, uint32_t runCounter);
+cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, const uint16_t* pStream, uint32_t shiftClockPreset, uint32_t runCounter);
 cmd_status_t gen_sgpio_Start(void);
 void gen_sgpio_Stop(void);
 
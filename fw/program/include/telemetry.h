@@ -0,0 +1,96 @@
+/*!
+ * @file
+ * @brief     Performance counters for signal capturing and USB transfers
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "LPC43xx.h"
+#include "lpc_types.h"
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! @brief Performance counters.
+ *
+ * All fields are 32-bit words sent in this order to the client as the answer
+ * to the REQ_GetTelemetry control request. New fields must be added at the
+ * end.
+ *
+ * All counters except \a coreClock and \a captures are reset each time a
+ * capture is armed so that they describe the last capture, including the
+ * transfer of its samples.
+ */
+typedef struct
+{
+  uint32_t coreClock;          /*!< CPU clock in Hz, converts cycles into time */
+  uint32_t captures;           /*!< Number of armed captures since reset */
+  uint32_t sgpioIrqCount;      /*!< Number of SGPIO interrupts */
+  uint32_t sgpioIrqMaxCycles;  /*!< Longest time spent in the SGPIO interrupt handler */
+  uint32_t dmaTcIrqCount;      /*!< Number of VADC DMA terminal count interrupts, not all LLIs give one */
+  uint32_t dmaIrqMaxCycles;    /*!< Longest time spent in the DMA interrupt handler */
+  uint32_t vadcSkippedSamples; /*!< Number of VADC samples missing in the sent data */
+  uint32_t vadcEmptyMarkers;   /*!< Number of VADC FIFO entries without a sample */
+  uint32_t usbBytesSent;       /*!< Number of bytes sent on the USB bulk endpoint */
+  uint32_t usbRetries;         /*!< Number of writes continued after the USB buffer was full */
+  uint32_t usbFailures;        /*!< Number of writes that failed, e.g. timed out */
+} telemetry_counters_t;
+
+/*! @brief Number of 32-bit words in \ref telemetry_counters_t */
+#define TELEMETRY_NUM_WORDS  (sizeof(telemetry_counters_t)/4)
+
+/*! @brief Current value of the DWT cycle counter.
+ *
+ * Save the value at the start of an interrupt handler and pass it to
+ * \ref TELEMETRY_IRQ_DONE at the end of it.
+ */
+#define TELEMETRY_CYCLES()  (DWT->CYCCNT)
+
+/*! @brief Counts one interrupt and updates the longest time spent in it.
+ *
+ * @param __count  The counter to increment
+ * @param __max    The longest time (in cycles) so far
+ * @param __start  Value of \ref TELEMETRY_CYCLES at the start of the handler
+ */
+#define TELEMETRY_IRQ_DONE(__count, __max, __start)  do { \
+    uint32_t __cycles = DWT->CYCCNT - (__start);             \
+    (__count)++;                                             \
+    if (__cycles > (__max)) { (__max) = __cycles; }          \
+  } while(0)
+
+/******************************************************************************
+ * Global Variables
+ *****************************************************************************/
+
+extern volatile telemetry_counters_t telemetry;
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void telemetry_Init(void);
+void telemetry_Reset(void);
+
+#endif /* end __TELEMETRY_H */
+
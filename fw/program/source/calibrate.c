@@ -583,6 +583,9 @@ void calibrate_ProcessResult(cmd_status_t status, circbuff_t* buff)
   uint16_t  ch;
   uint16_t  tmp;
   int       numSamples;
+  uint32_t  pos = 0;
+  uint32_t  addr;
+  uint32_t  len;
 
   if ((status != CMD_STATUS_OK) || (buff == NULL))
   {
@@ -594,55 +597,12 @@ void calibrate_ProcessResult(cmd_status_t status, circbuff_t* buff)
   memset(stats, 0, sizeof(uint32_t)*2*NUMBER_OF_STATS);
   stats[0][STATS_MIN] = stats[1][STATS_MIN] = 0xffffff; // way above any valid value
 
-  // case where the circular buffer hasn't wrapped yet
-  if (buff->empty)
+  // walk through the straightened out circular buffer, one contiguous part at a time
+  while ((len = circbuff_GetContiguous(buff, pos, &addr)) > 0)
   {
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    while (--numSamples > 0)
-    {
-      ch = (*pSamples & 0x7000)>>12;
-      tmp = *pSamples & 0x0fff;
-
-      stats[ch][STATS_NUM]++;
-      stats[ch][STATS_SUM] += tmp;
-      if (tmp < stats[ch][STATS_MIN])
-      {
-        stats[ch][STATS_MIN] = tmp;
-      }
-      if (tmp > stats[ch][STATS_MAX])
-      {
-        stats[ch][STATS_MAX] = tmp;
-      }
-
-      pSamples++;
-    }
-  }
-  else
-  {
-    numSamples = (buff->size - buff->last)/2; //size is in bytes
-    pSamples = (uint16_t*)circbuff_GetFirstAddr(buff);
-    while (--numSamples > 0)
-    {
-      ch = (*pSamples & 0x7000)>>12;
-      tmp = *pSamples & 0x0fff;
-
-      stats[ch][STATS_NUM]++;
-      stats[ch][STATS_SUM] += tmp;
-      if (tmp < stats[ch][STATS_MIN])
-      {
-        stats[ch][STATS_MIN] = tmp;
-      }
-      if (tmp > stats[ch][STATS_MAX])
-      {
-        stats[ch][STATS_MAX] = tmp;
-      }
-
-      pSamples++;
-    }
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    while (--numSamples > 0)
+    numSamples = len/2; //len is in bytes
+    pSamples = (uint16_t*)addr;
+    while (numSamples-- > 0)
     {
       ch = (*pSamples & 0x7000)>>12;
       tmp = *pSamples & 0x0fff;
@@ -660,6 +620,7 @@ void calibrate_ProcessResult(cmd_status_t status, circbuff_t* buff)
 
       pSamples++;
     }
+    pos += len;
   }
 
   for (ch = 0; ch < 2; ch++)
@@ -41,6 +41,7 @@
 #include "usb_handler.h"
 #include "statemachine.h"
 #include "sgpio_cfg.h"
+#include "telemetry.h"
 
 /******************************************************************************
  * Typedefs and defines
@@ -52,6 +53,18 @@
 /*! Offset in the \ref RATECONFIG table to where the SGPIO only value start. */
 #define SGPIO_ONLY_OFFSET  25
 
+/*! The 64KB AHB SRAM, used only for capture buffers */
+#define CAPTURE_BUFF_AHB_START     0x20000000
+#define CAPTURE_BUFF_AHB_SIZE      0x10000
+
+/*! The upper 32KB of the 128KB local SRAM, not used by the firmware (see IRAM1 in the project) */
+#define CAPTURE_BUFF_LOCAL1_START  0x10018000
+#define CAPTURE_BUFF_LOCAL1_SIZE   0x8000
+
+/*! The upper 32KB of the 72KB local SRAM, after the signal generator's memory region */
+#define CAPTURE_BUFF_LOCAL2_START  0x1008A000
+#define CAPTURE_BUFF_LOCAL2_SIZE   0x8000
+
 /*! @brief Configuration for one sample rate. Used in the \ref RATECONFIG table. */
 typedef struct
 {
@@ -334,12 +347,30 @@ static cmd_status_t capture_SetSampleRate(uint32_t wantedRate, int numVADC)
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Lets one capture buffer use all of the available memory.
+ *
+ * The AHB SRAM is the first segment as that is where a capture buffer is
+ * placed when only the AHB SRAM is used, see \ref capture_Init.
+ *
+ * @param [in] buff  The capture buffer
+ *
+ *****************************************************************************/
+static void capture_InitFullBuffer(circbuff_t* buff)
+{
+  circbuff_Init(buff, CAPTURE_BUFF_AHB_START, CAPTURE_BUFF_AHB_SIZE);
+  circbuff_AddSegment(buff, CAPTURE_BUFF_LOCAL1_START, CAPTURE_BUFF_LOCAL1_SIZE);
+  circbuff_AddSegment(buff, CAPTURE_BUFF_LOCAL2_START, CAPTURE_BUFF_LOCAL2_SIZE);
+}
+
 /**************************************************************************//**
  *
  * @brief  Configures the capture buffers to be optimally used.
  *
  * When only analog or only digital signals are enabled then the entire
- * available address space (0x20000000 - 0x20010000) is used as one buffer.
+ * AHB SRAM (0x20000000 - 0x20010000) and the unused parts of the two local
+ * SRAM banks are used as one buffer with three segments.
  *
  * When a combination of analog and digital signals is selected then two separate
  * buffers will be created and the size of those buffers are adjusted so that
@@ -357,12 +388,12 @@ static cmd_status_t capture_ConfigureCaptureBuffers(const capture_cfg_t * const
   if (cap_cfg->numEnabledVADC == 0)
   {
     // Only digital capture
-    circbuff_Init(&sampleBufferSGPIO, 0x20000000, 0x10000);
+    capture_InitFullBuffer(&sampleBufferSGPIO);
   }
   else if (cap_cfg->numEnabledSGPIO == 0)
   {
     // Only analog capture
-    circbuff_Init(&sampleBufferVADC, 0x20000000, 0x10000);
+    capture_InitFullBuffer(&sampleBufferVADC);
   }
   else
   {
@@ -651,6 +682,7 @@ cmd_status_t capture_Arm(void)
   LED_TRIG_OFF();
 
   memset(&capturedSamples, 0, sizeof(captured_samples_t));
+  telemetry_Reset();
 
   CAP_PREFILL_SET_AS_NEEDED();
 
@@ -40,6 +40,7 @@
 #include "capture_vadc.h"
 #include "sgpio_cfg.h"
 #include "meas.h"
+#include "telemetry.h"
 
 /******************************************************************************
  * Typedefs and defines
@@ -59,6 +60,7 @@ volatile uint32_t  circbuff_sample_limit;
 volatile uint32_t  circbuff_num_samples;
 volatile uint32_t  circbuff_last_sample;
 volatile uint32_t  circbuff_last_addr;
+volatile uint32_t  circbuff_segment;
 volatile uint32_t  circbuff_post_fill;
 volatile uint32_t  triggered_pos;
 
@@ -116,6 +118,8 @@ static sgpio_concat_t concatenation = SGPIO_CONCAT_NONE;
  *****************************************************************************/
 void SGPIO_IRQHandler(void)
 {
+  uint32_t start = TELEMETRY_CYCLES();
+
   SET_MEAS_PIN_1();
 
   // Capture Interrupt - Triggered when a slice swap occurs
@@ -285,17 +289,30 @@ void SGPIO_IRQHandler(void)
 
     if ((uint32_t)circbuff_addr >= circbuff_last_addr)
     {
-      circbuff_addr = (uint32_t*)pSampleBuffer->data;
-      if (!CAP_PREFILL_IS_SGPIO_DONE())
+      if (++circbuff_segment < pSampleBuffer->numSegments)
+      {
+        // End of the current segment, continue in the next one
+        circbuff_addr = (uint32_t*)pSampleBuffer->segments[circbuff_segment].data;
+        circbuff_last_addr = (uint32_t)circbuff_addr + pSampleBuffer->segments[circbuff_segment].size;
+      }
+      else
       {
-        CAP_PREFILL_MARK_SGPIO_DONE();
+        // End of the last segment, wrap to the first one
+        circbuff_segment = 0;
+        circbuff_addr = (uint32_t*)pSampleBuffer->data;
+        circbuff_last_addr = (uint32_t)circbuff_addr + pSampleBuffer->segments[0].size;
 
-        // If no triggers are selected then use forced triggering, i.e. fill the
-        // capture buffer once and return that to the UI
-        if (forcedTrigger)
+        if (!CAP_PREFILL_IS_SGPIO_DONE())
         {
-          circbuff_last_sample = circbuff_num_samples + circbuff_sample_limit - 1;
-          triggered_pos = circbuff_num_samples + 1;
+          CAP_PREFILL_MARK_SGPIO_DONE();
+
+          // If no triggers are selected then use forced triggering, i.e. fill the
+          // capture buffer once and return that to the UI
+          if (forcedTrigger)
+          {
+            circbuff_last_sample = circbuff_num_samples + circbuff_sample_limit - 1;
+            triggered_pos = circbuff_num_samples + 1;
+          }
         }
       }
     }
@@ -309,12 +326,12 @@ void SGPIO_IRQHandler(void)
       pSampleBuffer->empty = (circbuff_num_samples < circbuff_sample_limit)?TRUE:FALSE;
       pSampleBuffer->last = (circbuff_num_samples % circbuff_sample_limit) * (virtualChannelsToCopy * 4);// * concatenation);
 
-      // Convert the sample position into an address in the circular buffer
+      // Convert the sample position into an offset in the circular buffer
       triggered_pos = (triggered_pos % circbuff_sample_limit) * (virtualChannelsToCopy * 4);
 
-      // Convert the address into a relative address that it will have after straightening out the
+      // Convert the offset into a relative address that it will have after straightening out the
       // circular buffer
-      triggered_pos = circbuff_ConvertAddress(pSampleBuffer, ((uint32_t)pSampleBuffer->data) + triggered_pos);
+      triggered_pos = circbuff_ConvertOffset(pSampleBuffer, triggered_pos);
 
       // Convert the relative address into a sample number that the client can use after converting all
       // samples into arrays, one per channel.
@@ -370,6 +387,7 @@ void SGPIO_IRQHandler(void)
       //CLR_MEAS_PIN_2();
     }
   }
+  TELEMETRY_IRQ_DONE(telemetry.sgpioIrqCount, telemetry.sgpioIrqMaxCycles, start);
   CLR_MEAS_PIN_1();
 }
 
@@ -629,17 +647,18 @@ cmd_status_t cap_sgpio_Configure(circbuff_t* buff,
       break;
     }
 
-    // Configure the circular buffer data for use by the interrupt handler
-    circbuff_addr = (uint32_t*)pSampleBuffer->data;
-    circbuff_sample_limit = pSampleBuffer->maxSize/(virtualChannelsToCopy * 4);// * concatenation);
+    // Trim the size of each segment of the circular buffer to be an even
+    // multiple of the number of channels in this capture, so that the
+    // interrupt handler only has to check for the end of a segment once
+    // per sample
+    circbuff_sample_limit = circbuff_ResizeToMultipleOf(pSampleBuffer, virtualChannelsToCopy * 4) / (virtualChannelsToCopy * 4);
 
     log_i("Actual %2d, Virtual %2d, Sample Limit %4d\r\n", actualChannelsToCopy, virtualChannelsToCopy, circbuff_sample_limit);
 
-    // Trim the size of the circular buffer to be an even multiple of the number
-    // of channels in this capture
-    circbuff_Resize(pSampleBuffer, circbuff_sample_limit * virtualChannelsToCopy * 4);// * concatenation);
-
-    circbuff_last_addr = (uint32_t)pSampleBuffer->data + pSampleBuffer->size;
+    // Configure the circular buffer data for use by the interrupt handler
+    circbuff_segment = 0;
+    circbuff_addr = (uint32_t*)pSampleBuffer->data;
+    circbuff_last_addr = (uint32_t)pSampleBuffer->data + pSampleBuffer->segments[0].size;
 
     // Determine how much of the buffer should be used for PRE- resp POST-trigger samples
     result = cap_sgpio_CalculatePostFill(postFill);
@@ -674,7 +693,9 @@ cmd_status_t cap_sgpio_PrepareToArm(void)
     return CMD_STATUS_ERR;
   }
 
+  circbuff_segment = 0;
   circbuff_addr = (uint32_t*)pSampleBuffer->data;
+  circbuff_last_addr = (uint32_t)pSampleBuffer->data + pSampleBuffer->segments[0].size;
   circbuff_num_samples = 0;
   circbuff_last_sample = 0xffffffff;
   triggered_pos = 0xffffffff;
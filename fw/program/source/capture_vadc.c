@@ -40,6 +40,7 @@
 #include "capture_vadc.h"
 #include "capture_sgpio.h"
 #include "meas.h"
+#include "telemetry.h"
 #include "spi_control.h"
 
 #include <string.h>
@@ -154,7 +155,6 @@ static volatile Bool     started = FALSE;
 static volatile uint32_t* circbuff_addr;
 static volatile uint32_t  circbuff_sample_limit;
 static volatile uint32_t  circbuff_num_samples;
-static volatile uint32_t  circbuff_last_addr;
 static volatile uint32_t  triggeredSampleAddr = 0;
 
 static uint32_t noiseReductionEnabled = 0;
@@ -211,6 +211,8 @@ static uint32_t post_fill_llis = 0;
  *****************************************************************************/
 void DMA_IRQHandler (void)
 {
+  uint32_t start = TELEMETRY_CYCLES();
+
   SET_MEAS_PIN_3();
   if (LPC_GPDMA->INTTCSTAT & 1)
   {
@@ -240,7 +242,7 @@ void DMA_IRQHandler (void)
 
         // update sample buffer with correct positions
         //pSampleBuffer->empty = (circbuff_num_samples < circbuff_sample_limit)?TRUE:FALSE;
-        pSampleBuffer->last = LPC_GPDMA->C0DESTADDR - ((uint32_t)circbuff_addr) + 4; //+4 as the DMA address is already used
+        pSampleBuffer->last = circbuff_AddressToOffset(pSampleBuffer, LPC_GPDMA->C0DESTADDR) + 4; //+4 as the DMA address is already used
 
         if (activeCfg.forcedTrigger)
         {
@@ -277,6 +279,7 @@ void DMA_IRQHandler (void)
       }
       pSampleBuffer->empty = FALSE;
     }
+    TELEMETRY_IRQ_DONE(telemetry.dmaTcIrqCount, telemetry.dmaIrqMaxCycles, start);
   }
   CLR_MEAS_PIN_3();
 }
@@ -452,8 +455,10 @@ void VADC_IRQHandler_NoiseReduction(void)
  * VADC sampling uses DMA channel 0 to copy the samples from the VADC FIFO into
  * the circular capture buffer. The transfers are done under DMA's flow control
  * and by using a linked list of dma items (LLI). To setup the LLIs the available
- * capture buffer is divided into DMA_NUM_LLI_TO_USE chunks (the last chunk has
- * a slightly larger/smaller size to make sure the entire capture buffer is 
+ * capture buffer is divided into DMA_NUM_LLI_TO_USE chunks. The chunks are
+ * spread over the buffer's segments in proportion to the segment sizes so that
+ * no chunk crosses a segment boundary (the last chunk in each segment has
+ * a slightly larger/smaller size to make sure the entire segment is 
  * utilized). Each LLI is then assigned a chunk and is linked to the next LLI.
  * The last LLI is linked to the first one to create a circular buffer. The last
  * LLI is also the only LLI setup to cause a terminal count (TC) interrupt when
@@ -467,7 +472,10 @@ void VADC_IRQHandler_NoiseReduction(void)
  *****************************************************************************/
 static void VADC_SetupDMA(void)
 {
-  int i;
+  uint32_t i;
+  uint32_t lli;
+  uint32_t seg;
+  uint32_t numLLIs;
   uint32_t defaultTransferSize;
 
   NVIC_DisableIRQ(DMA_IRQn);
@@ -486,34 +494,51 @@ static void VADC_SetupDMA(void)
   LPC_GPDMA->CONFIG = 0x01;  /* Enable DMA channels, little endian */
   while ( !(LPC_GPDMA->CONFIG & 0x01) );
 
-  // The size of the transfer is in multiples of 32bit copies (hence the /4)
-  // and must be even multiples of FIFO_SIZE.
-  defaultTransferSize = pSampleBuffer->size / (FIFO_SIZE * DMA_NUM_LLI_TO_USE);
-  defaultTransferSize = (defaultTransferSize * FIFO_SIZE) / 4;
-
-  for (i = 0; i < DMA_NUM_LLI_TO_USE; i++)
+  lli = 0;
+  for (seg = 0; seg < pSampleBuffer->numSegments; seg++)
   {
-    uint32_t transSize = defaultTransferSize;
-    if (i == (DMA_NUM_LLI_TO_USE - 1))
+    const circbuff_segment_t* pSeg = &pSampleBuffer->segments[seg];
+
+    if (seg == (pSampleBuffer->numSegments - 1))
+    {
+      // The last segment gets the LLIs that are left
+      numLLIs = DMA_NUM_LLI_TO_USE - lli;
+    }
+    else
+    {
+      numLLIs = (pSeg->size * DMA_NUM_LLI_TO_USE) / pSampleBuffer->size;
+      numLLIs = MAX(numLLIs, 1);
+    }
+
+    // The size of the transfer is in multiples of 32bit copies (hence the /4)
+    // and must be even multiples of FIFO_SIZE.
+    defaultTransferSize = pSeg->size / (FIFO_SIZE * numLLIs);
+    defaultTransferSize = (defaultTransferSize * FIFO_SIZE) / 4;
+
+    for (i = 0; i < numLLIs; i++, lli++)
     {
-      // Add the leftover (due to the need for the transfer size to be an even
-      // multiple of FIFO_SIZE) to the last LLI
-      transSize += (pSampleBuffer->size % (defaultTransferSize*4))/4;
+      uint32_t transSize = defaultTransferSize;
+      if (i == (numLLIs - 1))
+      {
+        // Add the leftover (due to the need for the transfer size to be an even
+        // multiple of FIFO_SIZE) to the last LLI in the segment
+        transSize += (pSeg->size - defaultTransferSize*4*numLLIs)/4;
+      }
+      DMA_Stuff[lli].SrcAddr = VADC_DMA_READ_SRC;
+      DMA_Stuff[lli].DstAddr = ((uint32_t)pSeg->data) + defaultTransferSize*4*i;
+      DMA_Stuff[lli].NextLLI = (uint32_t)(&DMA_Stuff[(lli+1)%DMA_NUM_LLI_TO_USE]);
+      DMA_Stuff[lli].Control = (transSize << 0) |      // Transfersize (does not matter when flow control is handled by peripheral)
+                               (0x2 << 12)  |          // Source Burst Size
+                               (0x2 << 15)  |          // Destination Burst Size
+                               (0x2 << 18)  |          // Source width // 32 bit width
+                               (0x2 << 21)  |          // Destination width   // 32 bits
+                               (0x1 << 24)  |          // Source AHB master 0 / 1
+                               (0x1 << 25)  |          // Dest AHB master 0 / 1
+                               (0x0 << 26)  |          // Source increment(LAST Sample)
+                               (0x1 << 27)  |          // Destination increment
+                               (0x0UL << 31);          // Terminal count interrupt disabled
+      //log_i("DMA_Stuff[%d] on address %#x, destination %#x, transfer size %#x (%d)\r\n", lli, (uint32_t)&DMA_Stuff[lli], DMA_Stuff[lli].DstAddr, transSize, transSize);
     }
-    DMA_Stuff[i].SrcAddr = VADC_DMA_READ_SRC;
-    DMA_Stuff[i].DstAddr = ((uint32_t)circbuff_addr) + defaultTransferSize*4*i;
-    DMA_Stuff[i].NextLLI = (uint32_t)(&DMA_Stuff[(i+1)%DMA_NUM_LLI_TO_USE]);
-    DMA_Stuff[i].Control = (transSize << 0) |      // Transfersize (does not matter when flow control is handled by peripheral)
-                           (0x2 << 12)  |          // Source Burst Size
-                           (0x2 << 15)  |          // Destination Burst Size
-                           (0x2 << 18)  |          // Source width // 32 bit width
-                           (0x2 << 21)  |          // Destination width   // 32 bits
-                           (0x1 << 24)  |          // Source AHB master 0 / 1
-                           (0x1 << 25)  |          // Dest AHB master 0 / 1
-                           (0x0 << 26)  |          // Source increment(LAST Sample)
-                           (0x1 << 27)  |          // Destination increment
-                           (0x0UL << 31);          // Terminal count interrupt disabled
-    //log_i("DMA_Stuff[%d] on address %#x, destination %#x, transfer size %#x (%d)\r\n", i, (uint32_t)&DMA_Stuff[i], DMA_Stuff[i].DstAddr, transSize, transSize);
   }
 //   log_i("Post FILL (%d LLIs)will be between %d (%%%d) and %d (%%%d) samples\r\n",
 //         post_fill_llis,
@@ -1212,13 +1237,10 @@ cmd_status_t cap_vadc_Configure(circbuff_t* buff, cap_vadc_cfg_t* cfg, uint32_t
     // 2 bytes per sample per channel
     activeCfg.sample_size = activeCfg.numEnabledChannels * 2;
 
-    circbuff_sample_limit = pSampleBuffer->maxSize/activeCfg.sample_size;
-
-    // Trim the size of the circular buffer to be an even multiple of the number
-    // of channels in this capture
-    circbuff_Resize(pSampleBuffer, circbuff_sample_limit * activeCfg.sample_size);
-
-    circbuff_last_addr = (uint32_t)pSampleBuffer->data + pSampleBuffer->size;
+    // Trim the size of each segment of the circular buffer to be an even
+    // multiple of the DMA's 32-bit copies, which is also an even multiple of
+    // the sample size
+    circbuff_sample_limit = circbuff_ResizeToMultipleOf(pSampleBuffer, 4) / activeCfg.sample_size;
 
     // Determine how much of the buffer should be used for PRE- resp POST-trigger samples
     result = VADC_CalculatePreAndPostFill(postFill);
@@ -0,0 +1,281 @@
+/*!
+ * @file
+ * @brief   Packing of captured analog samples for transfer to the client
+ * @ingroup FUNC_CAP
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * This file is also built as part of the client software (which does the
+ * unpacking) so it must not depend on anything but the standard headers.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_vadc_pack.h"
+
+#include <stddef.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Bit 15 of a VADC sample is set if the sample is an empty marker */
+#define SAMPLE_IS_EMPTY(__s)    (((__s) & 0x8000) != 0)
+
+/*! Bits 12-14 of a VADC sample is the channel */
+#define SAMPLE_CHANNEL(__s)     (((__s) >> 12) & 0x7)
+
+/*! Bits 0-11 of a VADC sample is the value */
+#define SAMPLE_VALUE(__s)       ((__s) & 0x0fff)
+
+/******************************************************************************
+ * Global variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Forward Declarations of Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * External method
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Packs VADC samples into one block
+ *
+ * Samples are consumed from \a pSamples until the block is full, a skipped
+ * sample is found or all samples have been consumed. Call the function
+ * repeatedly, with the same \a pLastChannel, until all samples have been
+ * consumed.
+ *
+ * With \a pBlock set to NULL nothing is written, which is used to find out
+ * the total size of the packed data before sending it.
+ *
+ * @param [in]     pSamples      The samples as stored by the VADC
+ * @param [in]     numSamples    Number of samples in \a pSamples
+ * @param [in]     numChannels   Number of sampled channels (1 or 2)
+ * @param [in,out] pLastChannel  Channel of the last packed value, -1 at the start
+ * @param [out]    pBlock        Where to put the block, at least \ref VADC_PACK_MAX_BLOCK_SIZE bytes, or NULL
+ * @param [out]    pConsumed     Number of samples consumed from \a pSamples
+ *
+ * @return The size of the block in bytes or 0 if it is empty
+ *
+ *****************************************************************************/
+uint32_t cap_vadc_pack_Block(const uint16_t* pSamples, uint32_t numSamples, uint32_t numChannels,
+                             int32_t* pLastChannel, uint8_t* pBlock, uint32_t* pConsumed)
+{
+  uint32_t i;
+  uint32_t n = 0;
+  uint8_t  first = 0;
+  uint8_t  flags = 0;
+  uint8_t* p = NULL;
+
+  if (pBlock != NULL)
+  {
+    p = pBlock + VADC_PACK_HEADER_SIZE;
+  }
+
+  for (i = 0; (i < numSamples) && (n < VADC_PACK_MAX_VALUES); i++)
+  {
+    uint16_t s = pSamples[i];
+    int32_t ch;
+
+    if (SAMPLE_IS_EMPTY(s))
+    {
+      // not a sample, drop it
+      continue;
+    }
+
+    ch = SAMPLE_CHANNEL(s);
+    if ((numChannels > 1) && (ch == *pLastChannel))
+    {
+      if (n > 0)
+      {
+        // End the block here and let the next block start with the skip
+        break;
+      }
+      flags |= VADC_PACK_FLAG_SKIP;
+    }
+    if (n == 0)
+    {
+      first = (uint8_t)ch;
+    }
+
+    if (p != NULL)
+    {
+      if ((n & 1) == 0)
+      {
+        p[0] = (uint8_t)(SAMPLE_VALUE(s) & 0xff);
+        p[1] = (uint8_t)(SAMPLE_VALUE(s) >> 8);
+      }
+      else
+      {
+        p[1] |= (uint8_t)((SAMPLE_VALUE(s) & 0xf) << 4);
+        p[2] = (uint8_t)(SAMPLE_VALUE(s) >> 4);
+        p += 3;
+      }
+    }
+
+    *pLastChannel = ch;
+    n++;
+  }
+
+  *pConsumed = i;
+
+  if (n == 0)
+  {
+    return 0;
+  }
+
+  if (pBlock != NULL)
+  {
+    pBlock[0] = (uint8_t)(n & 0xff);
+    pBlock[1] = (uint8_t)(n >> 8);
+    pBlock[2] = first;
+    pBlock[3] = flags;
+  }
+
+  return VADC_PACK_HEADER_SIZE + (n / 2) * 3 + (n & 1) * 2;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Unpacks analog samples packed with \ref cap_vadc_pack_Block
+ *
+ * The values are stored per channel in \a pValues. For each skipped sample
+ * the previous value for that channel (or 0) is inserted to keep the
+ * channels aligned in time.
+ *
+ * Within a block the channel of each value is given by its position, so
+ * the values are unpacked two at a time (three bytes) without looking at
+ * them.
+ *
+ * @param [in]     pData        The packed data
+ * @param [in]     size         Size of \a pData in bytes
+ * @param [in]     numChannels  Number of sampled channels (1 or 2)
+ * @param [out]    pValues      Where to put the values, indexed by channel (0 or 1)
+ * @param [in,out] numValues    Number of values in each of \a pValues, updated
+ * @param [in]     maxValues    Size of each of \a pValues
+ * @param [out]    pNumSkips    Number of skipped samples, or NULL
+ *
+ * @retval 0   If all data was unpacked
+ * @retval -1  If the data is malformed or does not fit in \a pValues
+ *
+ *****************************************************************************/
+int32_t cap_vadc_pack_Unpack(const uint8_t* pData, uint32_t size, uint32_t numChannels,
+                             uint16_t* pValues[2], uint32_t numValues[2], uint32_t maxValues,
+                             uint32_t* pNumSkips)
+{
+  const uint8_t* pEnd = pData + size;
+  uint32_t skips = 0;
+
+  while ((pEnd - pData) >= VADC_PACK_HEADER_SIZE)
+  {
+    uint32_t n     = pData[0] | (pData[1] << 8);
+    uint32_t first = pData[2];
+    uint32_t other = first ^ 1;
+    uint32_t flags = pData[3];
+    uint32_t pairs = n / 2;
+    uint32_t i;
+    uint16_t* a;
+    uint16_t* b;
+
+    pData += VADC_PACK_HEADER_SIZE;
+
+    if ((first > 1) || ((uint32_t)(pEnd - pData) < (pairs * 3 + (n & 1) * 2)))
+    {
+      return -1;
+    }
+
+    if ((flags & VADC_PACK_FLAG_SKIP) && (numChannels > 1))
+    {
+      // repeat the last value of the channel that was skipped
+      if (numValues[other] >= maxValues)
+      {
+        return -1;
+      }
+      pValues[other][numValues[other]] = (numValues[other] > 0) ? pValues[other][numValues[other] - 1] : 0;
+      numValues[other]++;
+      skips++;
+    }
+
+    if (numChannels > 1)
+    {
+      // the values alternate between the channels, starting with first
+      if (((numValues[first] + (n + 1) / 2) > maxValues) || ((numValues[other] + pairs) > maxValues))
+      {
+        return -1;
+      }
+      a = pValues[first] + numValues[first];
+      b = pValues[other] + numValues[other];
+      for (i = 0; i < pairs; i++)
+      {
+        a[i] = (uint16_t)(pData[0] | ((pData[1] & 0x0f) << 8));
+        b[i] = (uint16_t)((pData[1] >> 4) | (pData[2] << 4));
+        pData += 3;
+      }
+      numValues[first] += pairs;
+      numValues[other] += pairs;
+    }
+    else
+    {
+      // all values belong to the same channel
+      if ((numValues[first] + n) > maxValues)
+      {
+        return -1;
+      }
+      a = pValues[first] + numValues[first];
+      for (i = 0; i < pairs; i++)
+      {
+        a[2*i]     = (uint16_t)(pData[0] | ((pData[1] & 0x0f) << 8));
+        a[2*i + 1] = (uint16_t)((pData[1] >> 4) | (pData[2] << 4));
+        pData += 3;
+      }
+      numValues[first] += pairs * 2;
+    }
+
+    if (n & 1)
+    {
+      pValues[first][numValues[first]++] = (uint16_t)(pData[0] | ((pData[1] & 0x0f) << 8));
+      pData += 2;
+    }
+  }
+
+  if (pNumSkips != NULL)
+  {
+    *pNumSkips = skips;
+  }
+
+  return (pData == pEnd) ? 0 : -1;
+}
@@ -25,7 +25,6 @@
  * Includes
  *****************************************************************************/
 
-#include "log.h"
 #include "circbuff.h"
 #include <string.h>
 
@@ -65,7 +64,9 @@
 
 /**************************************************************************//**
  *
- * @brief  Initializes the circular buffer
+ * @brief  Initializes the circular buffer with one segment
+ *
+ * More segments can be added with \ref circbuff_AddSegment.
  *
  * @param [in,out] pBuff  The buffer to initialize
  * @param [in]     addr   The address to start the buffer at
@@ -74,30 +75,80 @@
  *****************************************************************************/
 void circbuff_Init(circbuff_t* pBuff, uint32_t addr, uint32_t size)
 {
-  pBuff->data    = (uint8_t*) addr;
-  pBuff->size    = size;
-  pBuff->maxSize = size;
-  pBuff->last    = 0;
-  pBuff->empty   = TRUE;
+  pBuff->data        = (uint8_t*) addr;
+  pBuff->size        = 0;
+  pBuff->maxSize     = 0;
+  pBuff->last        = 0;
+  pBuff->empty       = TRUE;
+  pBuff->numSegments = 0;
+
+  circbuff_AddSegment(pBuff, addr, size);
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Extends the circular buffer with another memory region
+ *
+ * The new segment is placed after the existing ones, i.e. samples are
+ * written to it when the previous segment is full and the buffer wraps
+ * to the first segment when the new segment is full.
+ *
+ * @param [in,out] pBuff  The buffer to extend
+ * @param [in]     addr   The address to start the segment at
+ * @param [in]     size   The size of the segment in bytes
+ *
+ * @retval TRUE   If the segment was added
+ * @retval FALSE  If the buffer already has \ref CIRCBUFF_MAX_SEGMENTS segments
+ *
+ *****************************************************************************/
+Bool circbuff_AddSegment(circbuff_t* pBuff, uint32_t addr, uint32_t size)
+{
+  circbuff_segment_t* pSeg;
+
+  if (pBuff->numSegments >= CIRCBUFF_MAX_SEGMENTS)
+  {
+    return FALSE;
+  }
+
+  pSeg = &pBuff->segments[pBuff->numSegments++];
+  pSeg->data    = (uint8_t*) addr;
+  pSeg->size    = size;
+  pSeg->maxSize = size;
+
+  pBuff->size    += size;
+  pBuff->maxSize += size;
 
   /* To help troubleshooting the entire buffer is filled to see what is
      actually copied and what is leftovers. */
-  //memset(pBuff->data, 0x00, 0x10000);
-//  memset((uint8_t*)0x20000000, 0x00, 0x10000);
-  memset(pBuff->data, 0xea, size);
+  memset(pSeg->data, 0xea, size);
+  return TRUE;
 }
 
 /**************************************************************************//**
  *
- * @brief  Changes the size of the buffer
+ * @brief  Trims each segment to hold an even multiple of \a unitSize bytes
+ *
+ * As no unit (e.g. a set of samples) is split between two segments the
+ * offset space of the buffer stays continuous.
  *
- * @param [in,out] pBuff       The buffer to resize
- * @param [in]     actualSize  The new size
+ * @param [in,out] pBuff     The buffer to resize
+ * @param [in]     unitSize  The size of one unit in bytes
+ *
+ * @return The new size of the buffer in bytes
  *
  *****************************************************************************/
-void circbuff_Resize(circbuff_t* pBuff, uint32_t actualSize)
+uint32_t circbuff_ResizeToMultipleOf(circbuff_t* pBuff, uint32_t unitSize)
 {
-  pBuff->size = MIN(pBuff->maxSize, actualSize);
+  uint32_t i;
+
+  pBuff->size = 0;
+  for (i = 0; i < pBuff->numSegments; i++)
+  {
+    circbuff_segment_t* pSeg = &pBuff->segments[i];
+    pSeg->size = (pSeg->maxSize / unitSize) * unitSize;
+    pBuff->size += pSeg->size;
+  }
+  return pBuff->size;
 }
 
 /**************************************************************************//**
@@ -109,14 +160,17 @@ void circbuff_Resize(circbuff_t* pBuff, uint32_t actualSize)
  *****************************************************************************/
 void circbuff_Reset(circbuff_t* pBuff)
 {
+  uint32_t i;
+
   pBuff->last  = 0;
   pBuff->empty = TRUE;
 
   /* To help troubleshooting the entire buffer is filled to see what is
      actually copied and what is leftovers. */
-  //memset(pBuff->data, 0x00, 0x10000);
-//  memset((uint8_t*)0x20000000, 0x00, 0x10000);
-  memset(pBuff->data, 0xea, pBuff->size);
+  for (i = 0; i < pBuff->numSegments; i++)
+  {
+    memset(pBuff->segments[i].data, 0xea, pBuff->segments[i].size);
+  }
 }
 
 /**************************************************************************//**
@@ -124,7 +178,9 @@ void circbuff_Reset(circbuff_t* pBuff)
  * @brief  Returns the next position in the buffer that can hold \a incrInBytes bytes
  *
  * This operation moves the buffer's cursor effectively reserving the specified
- * number of bytes.
+ * number of bytes. The reserved bytes never span two segments, so if there
+ * is not enough room left in the current segment the cursor continues at
+ * the start of the next one.
  *
  * @param [in,out] pBuff        The buffer
  * @param [in]     incrInBytes  Number of bytes that will be reserved
@@ -134,20 +190,33 @@ void circbuff_Reset(circbuff_t* pBuff)
  *****************************************************************************/
 uint32_t circbuff_NextPos(circbuff_t* pBuff, uint32_t incrInBytes)
 {
+  uint32_t i;
   uint32_t addr;
+  uint32_t segStart = 0;
+  uint32_t segEnd;
 
-  if ((pBuff->last + incrInBytes) > pBuff->size)
+  for (i = 0; i < pBuff->numSegments; i++)
   {
-    pBuff->empty = FALSE;
-    pBuff->last = incrInBytes;
-    addr = ((uint32_t)pBuff->data);
-  }
-  else
-  {
-    addr = ((uint32_t)pBuff->data) + pBuff->last;
-    pBuff->last += incrInBytes;
+    segEnd = segStart + pBuff->segments[i].size;
+    if (pBuff->last < segEnd)
+    {
+      if ((pBuff->last + incrInBytes) <= segEnd)
+      {
+        addr = ((uint32_t)pBuff->segments[i].data) + (pBuff->last - segStart);
+        pBuff->last += incrInBytes;
+        return addr;
+      }
+
+      // Not enough room left in this segment, continue in the next one
+      pBuff->last = segEnd;
+    }
+    segStart = segEnd;
   }
-  return addr;
+
+  // Reached the end of the last segment, wrap to the first one
+  pBuff->empty = FALSE;
+  pBuff->last = incrInBytes;
+  return ((uint32_t)pBuff->data);
 }
 
 /**************************************************************************//**
@@ -167,7 +236,7 @@ uint32_t circbuff_GetFirstAddr(const circbuff_t * const pBuff)
   }
   else
   {
-    return ((uint32_t)pBuff->data) + (pBuff->last % pBuff->size);
+    return circbuff_OffsetToAddress(pBuff, pBuff->last % pBuff->size);
   }
 }
 
@@ -196,6 +265,98 @@ uint32_t circbuff_GetUsedSize(const circbuff_t * const pBuff)
   }
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Returns the address of the byte at \a offset in the buffer
+ *
+ * @param [in] pBuff   The buffer
+ * @param [in] offset  Offset in the buffer, 0 to size-1
+ *
+ * @return The address or 0 if \a offset is outside of the buffer
+ *
+ *****************************************************************************/
+uint32_t circbuff_OffsetToAddress(const circbuff_t * const pBuff, uint32_t offset)
+{
+  uint32_t i;
+  uint32_t segStart = 0;
+
+  for (i = 0; i < pBuff->numSegments; i++)
+  {
+    if (offset < (segStart + pBuff->segments[i].size))
+    {
+      return ((uint32_t)pBuff->segments[i].data) + (offset - segStart);
+    }
+    segStart += pBuff->segments[i].size;
+  }
+  return 0;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the offset in the buffer that \a addrInBuff corresponds to
+ *
+ * The address just after the end of a segment is accepted and gives the
+ * offset where the next segment starts.
+ *
+ * @param [in] pBuff       The buffer
+ * @param [in] addrInBuff  The address in the buffer
+ *
+ * @return The offset or 0 if \a addrInBuff is outside of the buffer
+ *
+ *****************************************************************************/
+uint32_t circbuff_AddressToOffset(const circbuff_t * const pBuff, uint32_t addrInBuff)
+{
+  uint32_t i;
+  uint32_t segStart = 0;
+
+  for (i = 0; i < pBuff->numSegments; i++)
+  {
+    uint32_t data = (uint32_t)pBuff->segments[i].data;
+    if ((addrInBuff >= data) && (addrInBuff <= (data + pBuff->segments[i].size)))
+    {
+      return segStart + (addrInBuff - data);
+    }
+    segStart += pBuff->segments[i].size;
+  }
+  return 0;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Finds which position \a offset will get when the circular buffer is straightened
+ *
+ * @param [in] pBuff   The buffer
+ * @param [in] offset  The offset in the buffer
+ *
+ * @return The corresponding position after the buffer has been straightened out
+ *
+ *****************************************************************************/
+uint32_t circbuff_ConvertOffset(const circbuff_t * const pBuff, uint32_t offset)
+{
+  uint32_t first;
+
+  if (pBuff == NULL)
+  {
+    return 0;
+  }
+  if (pBuff->empty)
+  {
+    return offset;
+  }
+
+  first = pBuff->last % pBuff->size;
+  if (offset >= first)
+  {
+    // offset is in the first part of a wrapped buffer
+    return offset - first;
+  }
+  else
+  {
+    // offset is in the second half of a wrapped buffer, add size of first half
+    return offset + pBuff->size - first;
+  }
+}
+
 /**************************************************************************//**
  *
  * @brief  Finds which address \a addrInBuff will get when the circular buffer is straightened
@@ -212,18 +373,55 @@ uint32_t circbuff_ConvertAddress(const circbuff_t * const pBuff, uint32_t addrIn
   {
     return 0;
   }
-  else
+  return circbuff_ConvertOffset(pBuff, circbuff_AddressToOffset(pBuff, addrInBuff));
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Locates a contiguous part of the straightened out circular buffer
+ *
+ * Used to walk through all bytes in the buffer, oldest first, without
+ * copying them:
+ *
+ * @code
+ *   uint32_t pos = 0, addr, len;
+ *   while ((len = circbuff_GetContiguous(pBuff, pos, &addr)) > 0)
+ *   {
+ *     // process len bytes at addr
+ *     pos += len;
+ *   }
+ * @endcode
+ *
+ * @param [in]  pBuff  The buffer
+ * @param [in]  pos    Position in the straightened out buffer
+ * @param [out] pAddr  The address of the byte at \a pos
+ *
+ * @return The number of bytes, starting at \a pos, that are stored after
+ *         each other in memory or 0 if \a pos is past the used part
+ *
+ *****************************************************************************/
+uint32_t circbuff_GetContiguous(const circbuff_t * const pBuff, uint32_t pos, uint32_t* pAddr)
+{
+  uint32_t i;
+  uint32_t used = circbuff_GetUsedSize(pBuff);
+  uint32_t offset;
+  uint32_t segStart = 0;
+
+  if (pos >= used)
   {
-    uint32_t first = circbuff_GetFirstAddr(pBuff);
-    if (addrInBuff >= first)
-    {
-      // addrInBuff is either in an non-filled buffer or in the first part of a wrapped buffer
-      return addrInBuff - first;
-    }
-    else
+    return 0;
+  }
+
+  offset = pBuff->empty ? pos : ((pBuff->last + pos) % pBuff->size);
+  for (i = 0; i < pBuff->numSegments; i++)
+  {
+    uint32_t segEnd = segStart + pBuff->segments[i].size;
+    if (offset < segEnd)
     {
-      // addrInBuff is in the second half of a wrapped buffer, add size of first half
-      return addrInBuff - ((uint32_t)pBuff->data) + pBuff->size - pBuff->last;
+      *pAddr = ((uint32_t)pBuff->segments[i].data) + (offset - segStart);
+      return MIN(segEnd - offset, used - pos);
     }
+    segStart = segEnd;
   }
+  return 0;
 }
@@ -55,7 +55,10 @@
 
 /*! @brief Configuration for signal generation.
  * This is the structure that the client software must send to configure
- * generation of analog and/or digital signals.
+ * generation of analog and/or digital signals. It is followed by the
+ * compressed pattern stream for the digital signals (if any) and then the
+ * lookup tables for any channels using the \ref GEN_DAC_CFG_WAVE_ARBITRARY
+ * waveform.
  */
 typedef struct
 {
@@ -325,8 +328,8 @@ cmd_status_t generator_Stop(void)
  *
  * @brief  Applies the configuration data (comes from the client).
  *
- * @param [in] cfg   Configuration from client (must be of type generator_cfg_t)
- * @param [in] size  Size of configuration from client
+ * @param [in] cfg   Configuration from client (must start with a generator_cfg_t)
+ * @param [in] size  Size of configuration from client, including pattern stream and lookup tables
  *
  * @retval CMD_STATUS_OK      If successfully configured
  * @retval CMD_STATUS_ERR_*   When the configuration could not be applied
@@ -335,6 +338,9 @@ cmd_status_t generator_Stop(void)
 cmd_status_t generator_Configure(uint8_t* cfg, uint32_t size)
 {
   generator_cfg_t* gen_cfg = (generator_cfg_t*)cfg;
+  const uint16_t* pExtra = (const uint16_t*)(cfg + sizeof(generator_cfg_t));
+  uint32_t numExtra;
+  uint32_t numEncoded = 0;
   cmd_status_t result;
 
   do
@@ -342,6 +348,24 @@ cmd_status_t generator_Configure(uint8_t* cfg, uint32_t size)
     SGPIO_GenerationEnabled = FALSE;
     DAC_GenerationEnabled = FALSE;
 
+    if (size < sizeof(generator_cfg_t))
+    {
+      result = CMD_STATUS_ERR;
+      break;
+    }
+
+    // the pattern stream comes first, then the lookup tables
+    numExtra = (size - sizeof(generator_cfg_t)) / sizeof(uint16_t);
+    if (gen_cfg->available & GEN_CFG_SGPIO_AVAILABLE)
+    {
+      numEncoded = gen_cfg->sgpio.encodedSize;
+      if (numEncoded > numExtra)
+      {
+        result = CMD_STATUS_ERR_GEN_INVALID_PATTERN;
+        break;
+      }
+    }
+
     result = statemachine_RequestState(STATE_GENERATING);
     if (result != CMD_STATUS_OK)
     {
@@ -360,7 +384,7 @@ cmd_status_t generator_Configure(uint8_t* cfg, uint32_t size)
         break;
       }
 
-      result = gen_sgpio_Configure(&gen_cfg->sgpio, currentSampleRate.counter, gen_cfg->runCounter);
+      result = gen_sgpio_Configure(&gen_cfg->sgpio, pExtra, currentSampleRate.counter, gen_cfg->runCounter);
       if (result != CMD_STATUS_OK)
       {
         break;
@@ -369,7 +393,7 @@ cmd_status_t generator_Configure(uint8_t* cfg, uint32_t size)
 
     if (gen_cfg->available & GEN_CFG_DAC_AVAILABLE)
     {
-      result = gen_dac_Configure(&gen_cfg->dac);
+      result = gen_dac_Configure(&gen_cfg->dac, pExtra + numEncoded, numExtra - numEncoded);
       if (result != CMD_STATUS_OK)
       {
         break;
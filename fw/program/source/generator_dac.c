@@ -49,7 +49,7 @@
  *****************************************************************************/
 
 /*! Size of lookup table for waveform data */
-#define MAX_LUT_SIZE  2000
+#define MAX_LUT_SIZE  GEN_DAC_MAX_LUT_SIZE
 
 /*! Smallest allowed LUT size */
 #define MIN_LUT_SIZE (MAX_DAC_FREQ / MAX_FREQ)
@@ -148,7 +148,7 @@ static dac_setup_t channels[MAX_SUPPORTED_CHANNELS] = {
 static Bool validConfiguration = FALSE;
 
 /*! String representation of the GEN_DAC_CFG_WAVE_* defines in generator_dac.h */
-static const char* const WAVEFORMS[6] = { "Sinus", "Square", "Triangular", "Sawtooth", "Inv Sawtooth", "Level" };
+static const char* const WAVEFORMS[7] = { "Sinus", "Square", "Triangular", "Sawtooth", "Inv Sawtooth", "Level", "Arbitrary" };
 
 /******************************************************************************
  * Forward Declarations of Local Functions
@@ -301,6 +301,81 @@ static cmd_status_t gen_dac_FindFrequency(uint32_t frequency,
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Finds the timer prescale value for a lookup table of fixed size.
+ *
+ * Used for the arbitrary waveform where the client has already decided the
+ * number of entries in the lookup table. Only the DAC update rate can be
+ * changed so the prescale value is selected to get as close as possible to
+ * the wanted frequency without exceeding \ref MAX_DAC_FREQ.
+ *
+ * @param [in] frequency        The wanted frequency in Hz
+ * @param [in] lutSize          The number of entries in the lookup table
+ * @param [in] numChannels      The number of enabled channels
+ * @param [out] pPrescaleValue  The timer's prescale value
+ *
+ * @retval CMD_STATUS_OK                         If the value was found
+ * @retval CMD_STATUS_ERR_GEN_INVALID_FREQUENCY  If the frequency is impossible
+ *
+ *****************************************************************************/
+static cmd_status_t gen_dac_FindPrescaler(uint32_t frequency,
+                                          uint32_t lutSize,
+                                          uint32_t numChannels,
+                                          uint32_t* pPrescaleValue)
+{
+  uint32_t pclk = CGU_GetPCLKFrequency(CGU_PERIPHERAL_TIMER1);
+  uint32_t max_dac_freq = MAX_DAC_FREQ / numChannels;
+  uint32_t pre;
+
+  // round to nearest instead of truncating to keep the error down
+  pre = (pclk + (lutSize * frequency)/2) / (lutSize * frequency);
+  if (pre == 0)
+  {
+    pre = 1;
+  }
+  if ((pclk/pre) > max_dac_freq)
+  {
+    pre++; // rounding error
+    if ((pclk/pre) > max_dac_freq)
+    {
+      return CMD_STATUS_ERR_GEN_INVALID_FREQUENCY;
+    }
+  }
+
+  *pPrescaleValue = pre;
+  log_i("Configured for %dHz as LUT size %d, prescale %d, PCLK %dMHz\r\n", frequency, lutSize, pre, pclk/1000000);
+  return CMD_STATUS_OK;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Fills the lookup table with data supplied by the client.
+ *
+ * The client has already applied the calibration and packed each entry
+ * in the \ref SPI_DAC_VALUE format, so no floating point math is needed.
+ * The control bits are forced to match \a ch to make sure that a bad
+ * table cannot drive the other output.
+ *
+ * @param [in]  pLUT     Lookup table from the client
+ * @param [in]  lutSize  Number of entries in the lookup table
+ * @param [in]  ch       The configuration to update (local)
+ *
+ *****************************************************************************/
+static void gen_dac_CopyLUT(const uint16_t* pLUT, uint32_t lutSize, int ch)
+{
+  uint32_t i;
+  dac_setup_t* dacSetup = &(channels[ch]);
+
+  for (i = 0; i < lutSize; i++)
+  {
+    dacSetup->LUT_BUFFER[i] = SPI_DAC_VALUE(ch, pLUT[i] & 0xffc);
+  }
+  dacSetup->numLUTEntries = lutSize;
+
+  log_i("LUT with %u entries for %s waveform\r\n", dacSetup->numLUTEntries, WAVEFORMS[GEN_DAC_CFG_WAVE_ARBITRARY]);
+}
+
 /**************************************************************************//**
  *
  * @brief  Fills the lookup table with data for the requested waveform.
@@ -529,13 +604,18 @@ void gen_dac_Init(void)
  * The "force trigger mode" means that no trigger is used and instead the entire
  * capture buffer should be filled and then returned to the client.
  *
+ * Channels using the arbitrary waveform take their lookup tables from
+ * \a pLUT, in channel order, with \a lutSize entries each.
+ *
  * @param [in] cfg               Configuration to apply
+ * @param [in] pLUT              Lookup tables for arbitrary waveforms, can be NULL
+ * @param [in] numLUTValues      Number of entries available in \a pLUT
  *
  * @retval CMD_STATUS_OK      If successfully configured
  * @retval CMD_STATUS_ERR_*   When the configuration could not be applied
  *
  *****************************************************************************/
-cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg)
+cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg, const uint16_t* pLUT, uint32_t numLUTValues)
 {
   cmd_status_t result;
   uint32_t lutSize = 0;
@@ -565,6 +645,7 @@ cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg)
       numChannels = 1;
     }
 
+    result = CMD_STATUS_OK;
     for (i = 0; i < MAX_SUPPORTED_CHANNELS; i++)
     {
       if (cfg->available & (1<<i))
@@ -592,6 +673,27 @@ cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg)
             break;
           }
         }
+        else if (cfg->ch[i].waveform == GEN_DAC_CFG_WAVE_ARBITRARY)
+        {
+          lutSize = cfg->ch[i].lutSize;
+          if ((lutSize < 2) || (lutSize > MAX_LUT_SIZE) || (pLUT == NULL) || (lutSize > numLUTValues))
+          {
+            result = CMD_STATUS_ERR_GEN_INVALID_WAVEFORM;
+            break;
+          }
+
+          result = gen_dac_FindPrescaler(cfg->ch[i].frequency, lutSize, numChannels, &prescaler);
+          if (result != CMD_STATUS_OK)
+          {
+            break;
+          }
+
+          gen_dac_CopyLUT(pLUT, lutSize, i);
+          pLUT += lutSize;
+          numLUTValues -= lutSize;
+
+          gen_dac_SetupTimer(prescaler, channels[i].timer);
+        }
         else
         {
           result = gen_dac_FindFrequency(cfg->ch[i].frequency, numChannels, &lutSize, &prescaler);
@@ -612,6 +714,10 @@ cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg)
         channels[i].enabled = TRUE;
       }
     }
+    if (result != CMD_STATUS_OK)
+    {
+      break;
+    }
 
     validConfiguration = TRUE;
 
@@ -0,0 +1,408 @@
+/*!
+ * @file
+ * @brief   Compression of long digital patterns for the signal generator
+ * @ingroup FUNC_GEN
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * This file is also built as part of the client software (which does the
+ * encoding) so it must not depend on anything but the standard headers.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "generator_pattern.h"
+
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Minimum number of words that must be saved to leave a literal record */
+#define MIN_GAIN  2
+
+/******************************************************************************
+ * Global variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Forward Declarations of Local Functions
+ *****************************************************************************/
+
+static int32_t gen_pattern_EncodeBlock(const uint16_t* pStates, uint32_t numStates,
+                                       uint16_t* pStream, uint32_t maxWords, int depth);
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the number of identical states at the start of \a pStates.
+ *
+ * @param [in] pStates    The states
+ * @param [in] numStates  Number of states in \a pStates
+ *
+ * @return The length of the run, at most \ref GEN_PATTERN_MAX_COUNT
+ *
+ *****************************************************************************/
+static uint32_t gen_pattern_RunLength(const uint16_t* pStates, uint32_t numStates)
+{
+  uint32_t len = 1;
+
+  while ((len < numStates) && (len < GEN_PATTERN_MAX_COUNT) && (pStates[len] == pStates[0]))
+  {
+    len++;
+  }
+  return len;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Finds the block that covers the most states when repeated.
+ *
+ * Looks for a block of 2..\ref GEN_PATTERN_MAX_BLOCK states at the start of
+ * \a pStates that is immediately followed by at least one copy of itself.
+ * If several blocks cover the same number of states then the shortest one
+ * is used as it will have the most repetitions.
+ *
+ * @param [in]  pStates    The states
+ * @param [in]  numStates  Number of states in \a pStates
+ * @param [out] pReps      Number of times the block is repeated
+ *
+ * @return The length of the block or 0 if no repeated block was found
+ *
+ *****************************************************************************/
+static uint32_t gen_pattern_FindBlock(const uint16_t* pStates, uint32_t numStates, uint32_t* pReps)
+{
+  uint32_t len, reps;
+  uint32_t bestLen = 0;
+  uint32_t bestReps = 0;
+
+  for (len = 2; (len <= GEN_PATTERN_MAX_BLOCK) && (2*len <= numStates); len++)
+  {
+    reps = 1;
+    while ((reps < GEN_PATTERN_MAX_COUNT) &&
+           ((reps + 1) * len <= numStates) &&
+           (memcmp(pStates, pStates + reps * len, len * sizeof(uint16_t)) == 0))
+    {
+      reps++;
+    }
+
+    if ((reps > 1) && (reps * len > bestReps * bestLen))
+    {
+      bestLen = len;
+      bestReps = reps;
+    }
+  }
+
+  *pReps = bestReps;
+  return bestLen;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Writes a literal record for \a numStates states.
+ *
+ * @param [in]  pStates    The states
+ * @param [in]  numStates  Number of states, 0..\ref GEN_PATTERN_MAX_COUNT
+ * @param [out] pStream    Where to write the record
+ * @param [in]  maxWords   Space left in \a pStream
+ *
+ * @return Number of words written or -1 if there is not enough space
+ *
+ *****************************************************************************/
+static int32_t gen_pattern_PutLiteral(const uint16_t* pStates, uint32_t numStates,
+                                      uint16_t* pStream, uint32_t maxWords)
+{
+  if (numStates == 0)
+  {
+    return 0;
+  }
+  if (numStates + 1 > maxWords)
+  {
+    return -1;
+  }
+  pStream[0] = GEN_PATTERN_REC(GEN_PATTERN_REC_LITERAL, numStates);
+  memcpy(pStream + 1, pStates, numStates * sizeof(uint16_t));
+  return numStates + 1;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Encodes \a numStates states, see \ref gen_pattern_Encode.
+ *
+ * The encoder is greedy. At each position it compares a run record and a
+ * repeat record (with the block encoded recursively) and uses the one that
+ * saves the most words compared to leaving the states in a literal record.
+ *
+ * @param [in]  pStates    The states
+ * @param [in]  numStates  Number of states in \a pStates
+ * @param [out] pStream    The encoded stream
+ * @param [in]  maxWords   Size of \a pStream in words
+ * @param [in]  depth      The nesting level of repeat records
+ *
+ * @return Number of words written or -1 if there is not enough space
+ *
+ *****************************************************************************/
+static int32_t gen_pattern_EncodeBlock(const uint16_t* pStates, uint32_t numStates,
+                                       uint16_t* pStream, uint32_t maxWords, int depth)
+{
+  uint16_t block[GEN_PATTERN_MAX_BLOCK + 1];
+  uint32_t pos = 0;
+  uint32_t out = 0;
+  uint32_t litStart = 0;
+  int32_t blockWords = 0;
+  int32_t runGain, blockGain, written;
+  uint32_t run, blockLen;
+  uint32_t blockReps = 0;
+
+  while (pos < numStates)
+  {
+    run = gen_pattern_RunLength(pStates + pos, numStates - pos);
+    runGain = (int32_t)run - 2;
+
+    blockGain = 0;
+    blockLen = 0;
+    if (depth < GEN_PATTERN_MAX_DEPTH)
+    {
+      blockLen = gen_pattern_FindBlock(pStates + pos, numStates - pos, &blockReps);
+      if ((blockLen > 0) && (blockLen * blockReps > run))
+      {
+        // a block is never larger than a literal record with all its states
+        blockWords = gen_pattern_EncodeBlock(pStates + pos, blockLen, block, sizeof(block)/sizeof(uint16_t), depth + 1);
+        if (blockWords > 0)
+        {
+          blockGain = (int32_t)(blockLen * blockReps) - (2 + blockWords);
+        }
+      }
+    }
+
+    if ((runGain < MIN_GAIN) && (blockGain < MIN_GAIN))
+    {
+      // keep in the literal record, which must be split if it is too long
+      pos++;
+      if ((pos - litStart) == GEN_PATTERN_MAX_COUNT)
+      {
+        written = gen_pattern_PutLiteral(pStates + litStart, pos - litStart, pStream + out, maxWords - out);
+        if (written < 0)
+        {
+          return -1;
+        }
+        out += written;
+        litStart = pos;
+      }
+      continue;
+    }
+
+    written = gen_pattern_PutLiteral(pStates + litStart, pos - litStart, pStream + out, maxWords - out);
+    if (written < 0)
+    {
+      return -1;
+    }
+    out += written;
+
+    if (runGain >= blockGain)
+    {
+      if (out + 2 > maxWords)
+      {
+        return -1;
+      }
+      pStream[out++] = GEN_PATTERN_REC(GEN_PATTERN_REC_RUN, run);
+      pStream[out++] = pStates[pos];
+      pos += run;
+    }
+    else
+    {
+      if (out + 2 + blockWords > maxWords)
+      {
+        return -1;
+      }
+      pStream[out++] = GEN_PATTERN_REC(GEN_PATTERN_REC_REPEAT, blockReps);
+      pStream[out++] = (uint16_t)blockWords;
+      memcpy(pStream + out, block, blockWords * sizeof(uint16_t));
+      out += blockWords;
+      pos += blockLen * blockReps;
+    }
+    litStart = pos;
+  }
+
+  written = gen_pattern_PutLiteral(pStates + litStart, pos - litStart, pStream + out, maxWords - out);
+  if (written < 0)
+  {
+    return -1;
+  }
+  return out + written;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Decodes \a numWords words, see \ref gen_pattern_Decode.
+ *
+ * @param [in] pStream    The encoded stream
+ * @param [in] numWords   Number of words in \a pStream
+ * @param [in] maxStates  Maximum number of states to decode
+ * @param [in] sink       Function to pass the states to, can be NULL
+ * @param [in] ctx        Passed to \a sink
+ * @param [in] depth      The nesting level of repeat records
+ *
+ * @return Number of decoded states or -1 if the stream is invalid
+ *
+ *****************************************************************************/
+static int32_t gen_pattern_DecodeBlock(const uint16_t* pStream, uint32_t numWords, uint32_t maxStates,
+                                       gen_pattern_sink_t sink, void* ctx, int depth)
+{
+  uint32_t pos = 0;
+  uint32_t total = 0;
+  uint32_t count, len, i;
+  int32_t decoded;
+  uint16_t hdr;
+
+  while (pos < numWords)
+  {
+    hdr = pStream[pos++];
+    count = GEN_PATTERN_REC_COUNT(hdr);
+    if (count == 0)
+    {
+      return -1;
+    }
+
+    switch (GEN_PATTERN_REC_TYPE(hdr))
+    {
+      case GEN_PATTERN_REC_LITERAL:
+        if ((count > (numWords - pos)) || (count > (maxStates - total)))
+        {
+          return -1;
+        }
+        if (sink != NULL)
+        {
+          for (i = 0; i < count; i++)
+          {
+            sink(ctx, pStream[pos + i], 1);
+          }
+        }
+        pos += count;
+        total += count;
+        break;
+
+      case GEN_PATTERN_REC_RUN:
+        if ((pos >= numWords) || (count > (maxStates - total)))
+        {
+          return -1;
+        }
+        if (sink != NULL)
+        {
+          sink(ctx, pStream[pos], count);
+        }
+        pos++;
+        total += count;
+        break;
+
+      case GEN_PATTERN_REC_REPEAT:
+        if ((depth >= GEN_PATTERN_MAX_DEPTH) || (pos >= numWords))
+        {
+          return -1;
+        }
+        len = pStream[pos++];
+        if ((len == 0) || (len > (numWords - pos)))
+        {
+          return -1;
+        }
+        for (i = 0; i < count; i++)
+        {
+          decoded = gen_pattern_DecodeBlock(pStream + pos, len, maxStates - total, sink, ctx, depth + 1);
+          if (decoded < 0)
+          {
+            return -1;
+          }
+          total += decoded;
+        }
+        pos += len;
+        break;
+
+      default:
+        return -1;
+    }
+  }
+
+  return total;
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Compresses a sequence of states into a pattern stream.
+ *
+ * @param [in]  pStates    The states, bit n in each state represents DIO n
+ * @param [in]  numStates  Number of states in \a pStates
+ * @param [out] pStream    The encoded stream
+ * @param [in]  maxWords   Size of \a pStream in words
+ *
+ * @return Number of words in \a pStream or -1 if it is too small
+ *
+ *****************************************************************************/
+int32_t gen_pattern_Encode(const uint16_t* pStates, uint32_t numStates,
+                           uint16_t* pStream, uint32_t maxWords)
+{
+  return gen_pattern_EncodeBlock(pStates, numStates, pStream, maxWords, 0);
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Expands a pattern stream.
+ *
+ * The complete stream is validated, but \a sink may have been called for
+ * some of the states before an error is detected. Call this function with
+ * \a sink set to NULL first to validate the stream and to get the number
+ * of states in it.
+ *
+ * @param [in] pStream    The encoded stream
+ * @param [in] numWords   Number of words in \a pStream
+ * @param [in] maxStates  Maximum number of states that the stream may contain
+ * @param [in] sink       Function to pass the states to, can be NULL
+ * @param [in] ctx        Passed to \a sink
+ *
+ * @return Number of decoded states or -1 if the stream is invalid or has
+ *         more than \a maxStates states
+ *
+ *****************************************************************************/
+int32_t gen_pattern_Decode(const uint16_t* pStream, uint32_t numWords, uint32_t maxStates,
+                           gen_pattern_sink_t sink, void* ctx)
+{
+  if (maxStates > 0x7fffffff)
+  {
+    maxStates = 0x7fffffff;
+  }
+  return gen_pattern_DecodeBlock(pStream, numWords, maxStates, sink, ctx, 0);
+}
+
@@ -38,6 +38,7 @@
 #include "led.h"
 #include "log.h"
 #include "generator_sgpio.h"
+#include "generator_pattern.h"
 #include "sgpio_cfg.h"
 #include "meas.h"
 
@@ -70,6 +71,9 @@ typedef struct
  */
 #define TMP_SRC_MEM   ((uint32_t*) 0x10089B00)
 
+/*! Number of DMA buffers that fit before the temporary buffers */
+#define MAX_DMA_BUFFERS  ((0x10089B00 - 0x10080000) / sizeof(dma_copy_set_t))
+
 /******************************************************************************
  * Global variables
  *****************************************************************************/
@@ -449,6 +453,126 @@ static cmd_status_t gen_sgpio_PrepareOneShotData(gen_sgpio_cfg_t* cfg)
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Sets \a count consecutive states for a slice to 1.
+ *
+ * The DMA buffers must have been cleared before the first call.
+ *
+ * @param [in] slice  The slice
+ * @param [in] first  Index of the first state to set
+ * @param [in] count  Number of states to set
+ *
+ *****************************************************************************/
+static void gen_sgpio_SetStates(int slice, uint32_t first, uint32_t count)
+{
+  uint32_t buff = first / 32;
+  uint32_t bit = first % 32;
+  uint32_t n;
+
+  while (count > 0)
+  {
+    n = 32 - bit;
+    if (n > count)
+    {
+      n = count;
+    }
+    if (n == 32)
+    {
+      DMA_MEM[buff].REG_SS_data[slice] = 0xffffffff;
+    }
+    else
+    {
+      DMA_MEM[buff].REG_SS_data[slice] |= ((1UL << n) - 1) << bit;
+    }
+    count -= n;
+    bit = 0;
+    buff++;
+  }
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Places decoded states in the DMA buffers.
+ *
+ * Called by gen_pattern_Decode() for each state in the pattern stream.
+ *
+ * @param [in,out] ctx    Pointer to the index of the next state
+ * @param [in]     state  The state, bit n representing DIO n
+ * @param [in]     count  Number of times in a row that \a state occurs
+ *
+ *****************************************************************************/
+static void gen_sgpio_ExpandStates(void* ctx, uint16_t state, uint32_t count)
+{
+  uint32_t* pPos = (uint32_t*)ctx;
+  int slice;
+
+  for (slice = 0; slice < MAX_NUM_SLICES; slice++)
+  {
+    if (config[slice].enabled && (state & (1 << config[slice].dio)))
+    {
+      gen_sgpio_SetStates(slice, *pPos, count);
+    }
+  }
+  *pPos += count;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Expands a compressed pattern stream into the DMA buffers.
+ *
+ * For continuous mode the sequence is repeated until it fills a whole
+ * number of DMA buffers. For one shot mode an extra buffer with end
+ * data is added.
+ *
+ * @param [in] cfg      Configuration to apply
+ * @param [in] pStream  The pattern stream of \a cfg->encodedSize words
+ *
+ * @retval CMD_STATUS_OK      If successfully expanded
+ * @retval CMD_STATUS_ERR_*   If the stream is invalid or too long
+ *
+ *****************************************************************************/
+static cmd_status_t gen_sgpio_PrepareEncodedData(gen_sgpio_cfg_t* cfg, const uint16_t* pStream)
+{
+  int32_t numStates;
+  uint32_t mult = 1;
+  uint32_t pos = 0;
+  uint32_t i;
+
+  numStates = gen_pattern_Decode(pStream, cfg->encodedSize, GEN_SGPIO_MAX_STATES, NULL, NULL);
+  if ((numStates <= 0) || ((uint32_t)numStates != cfg->numStates))
+  {
+    return CMD_STATUS_ERR_GEN_INVALID_PATTERN;
+  }
+
+  if (singleShot)
+  {
+    numDmaBuffers = (numStates + 31)/32 + 1;
+  }
+  else
+  {
+    // Find first multiple of numStates that goes evenly into 32bit chunks
+    for (mult = 1; ((numStates * mult) % 32) > 0; mult++)
+    {
+    }
+    numDmaBuffers = (numStates * mult)/32;
+  }
+  if (numDmaBuffers > MAX_DMA_BUFFERS)
+  {
+    return CMD_STATUS_ERR_GEN_INVALID_NUMBER_OF_STATES;
+  }
+
+  // disabled slices and the end data are all zeros
+  memset(DMA_MEM, 0, numDmaBuffers * sizeof(dma_copy_set_t));
+
+  for (i = 0; i < mult; i++)
+  {
+    gen_pattern_Decode(pStream, cfg->encodedSize, GEN_SGPIO_MAX_STATES, gen_sgpio_ExpandStates, &pos);
+  }
+
+  return CMD_STATUS_OK;
+}
+
 /******************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -483,6 +607,8 @@ void gen_sgpio_Init(void)
  * capture buffer should be filled and then returned to the client.
  *
  * @param [in] cfg               Configuration to apply
+ * @param [in] pStream           Compressed pattern stream, only used if
+ *                               cfg->encodedSize is not 0
  * @param [in] shiftClockPreset  Clocking information
  * @param [in] runCounter        0 for continuous signal, 1 for one shot
  *
@@ -490,7 +616,7 @@ void gen_sgpio_Init(void)
  * @retval CMD_STATUS_ERR_*   When the configuration could not be applied
  *
  *****************************************************************************/
-cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, uint32_t shiftClockPreset, uint32_t runCounter)
+cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, const uint16_t* pStream, uint32_t shiftClockPreset, uint32_t runCounter)
 {
   int i;
   cmd_status_t result;
@@ -520,14 +646,17 @@ cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, uint32_t shiftClockPreset
       break;
     }
 
-    if (runCounter == 1)
+    singleShot = (runCounter == 1) ? TRUE : FALSE;
+    if (cfg->encodedSize > 0)
+    {
+      result = gen_sgpio_PrepareEncodedData(cfg, pStream);
+    }
+    else if (singleShot)
     {
-      singleShot = TRUE;
       result = gen_sgpio_PrepareOneShotData(cfg);
     }
     else
     {
-      singleShot = FALSE;
       result = gen_sgpio_PrepareContinuousData(cfg);
     }
     if (result != CMD_STATUS_OK)
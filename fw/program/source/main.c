@@ -45,6 +45,7 @@
 #include "labtool_config.h"
 #include "statemachine.h"
 #include "experiments.h"
+#include "telemetry.h"
 
 /******************************************************************************
  * Typedefs and defines
@@ -418,6 +419,8 @@ int main (void)
 
   statemachine_Init();
 
+  telemetry_Init();
+
   usb_handler_InitUSB(capture_Disarm, capture_Configure, capture_Arm,
                       generator_Stop, generator_Configure, generator_Start);
   statemachine_RequestState(STATE_IDLE);
@@ -0,0 +1,101 @@
+/*!
+ * @file
+ * @brief     Performance counters for signal capturing and USB transfers
+ * @ingroup   FUNC_COMM
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "telemetry.h"
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Global variables
+ *****************************************************************************/
+
+/*! @brief The counters, updated directly by the interrupt handlers */
+volatile telemetry_counters_t telemetry;
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Forward Declarations of Local Functions
+ *****************************************************************************/
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * External method
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Starts the DWT cycle counter and clears all counters
+ *
+ * The cycle counter is part of the debug block but it runs without a
+ * debugger attached once the trace block has been enabled.
+ *
+ *****************************************************************************/
+void telemetry_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  memset((void*)&telemetry, 0, sizeof(telemetry_counters_t));
+  telemetry.coreClock = SystemCoreClock;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Clears the counters before a new capture
+ *
+ * Called when a capture is armed. The \a captures counter is incremented
+ * instead of being cleared.
+ *
+ *****************************************************************************/
+void telemetry_Reset(void)
+{
+  uint32_t captures = telemetry.captures;
+
+  memset((void*)&telemetry, 0, sizeof(telemetry_counters_t));
+  telemetry.coreClock = SystemCoreClock;
+  telemetry.captures = captures + 1;
+}
+
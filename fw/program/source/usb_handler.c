@@ -27,6 +27,8 @@
  *****************************************************************************/
 
 #include "usb_handler.h"
+#include "capture_vadc_pack.h"
+#include "telemetry.h"
 #include "lpc43xx_cgu.h"
 #include "lpc43xx_timer.h"
 #include "lpc43xx_wwdt.h"
@@ -46,11 +48,17 @@
 
 #define CMD_MAX_LEN     4
 
+/*! @brief Size of one packet on the USB bulk endpoint */
+#define DATA_PACKET_LEN  512
+
 /*! @brief Maximum size of a received block of data
+ *
+ * Large enough for a generator configuration followed by two full lookup
+ * tables for the arbitrary analog waveform (2 x 2000 x 16 bits).
+ *
  * @see LabTool_ReadData
- * @todo Remove 512 byte limitation of received data?
  */
-#define DATA_MAX_LEN  512
+#define DATA_MAX_LEN  (17 * DATA_PACKET_LEN)
 
 #define HEADER_IDX_SIZE_LSB  0
 #define HEADER_IDX_SIZE_MSB  1
@@ -118,6 +126,7 @@ typedef enum
   REQ_StopCapture   = 3, /*!< Request to stop ongoing signal capture */
   REQ_StopGenerator = 4, /*!< Request to stop ongoing signal generation */
   REQ_GetCalibData  = 5, /*!< Request for the persistent calibration data */
+  REQ_GetTelemetry  = 6, /*!< Request for the performance counters */
 } control_requests_t;
 
 /******************************************************************************
@@ -139,6 +148,9 @@ static callbacks_t callbacks;
 static sample_data_t samples = {CMD_STATUS_ERR,NULL,0,0};
 static Bool haveSamplesToSend = FALSE;
 
+// One block of packed analog samples, see LabTool_SendPackedAnalog
+static uint8_t analogPackBuff[VADC_PACK_MAX_BLOCK_SIZE];
+
 // Calibration result to send back to PC
 static calibration_data_t calibration;
 static Bool haveCalibrationResultToSend = FALSE;
@@ -215,17 +227,18 @@ static Bool LabTool_ReadCommand(uint8_t* pCmd, uint16_t* pSize)
  *
  * @brief  Reads up data on the USB bulk endpoint
  *
- * A maximum of 512 bytes can be read like this.
+ * A maximum of \ref DATA_MAX_LEN bytes can be read like this. The data
+ * arrives in packets of 512 bytes which are read one at a time.
  *
  * If no data is available when the function is called, then the function will
  * block waiting for the data. The function will wakeup every 10ms to see if
- * anything has arrived. A maximum of 5 seconds will be spent retrying before
- * giving up.
+ * anything has arrived. A maximum of 5 seconds will be spent retrying for
+ * each packet before giving up.
  *
  * @todo Investigate if this delay causes disconnects between client and device
  *
  * @param [in,out] pBuff  The buffer to store read data in
- * @param [in]     size   The number of bytes to read, max 512 bytes
+ * @param [in]     size   The number of bytes to read, max \ref DATA_MAX_LEN bytes
  *
  * @retval TRUE  If the data was successfully read
  * @retval FALSE If the data was not read
@@ -233,24 +246,33 @@ static Bool LabTool_ReadCommand(uint8_t* pCmd, uint16_t* pSize)
  *****************************************************************************/
 static Bool LabTool_ReadData(uint8_t* pBuff, uint16_t size)
 {
-  int retry = 500;
+  int retry;
+  uint16_t chunk;
 
   if (size > DATA_MAX_LEN)
   {
     return FALSE;
   }
-  do
+  while (size > 0)
   {
-    if (Endpoint_IsOUTReceived())
+    chunk = (size > DATA_PACKET_LEN) ? DATA_PACKET_LEN : size;
+    retry = 500;
+    while (!Endpoint_IsOUTReceived())
     {
-      Endpoint_Read_Stream_LE(pBuff, size, NULL);
-      Endpoint_ClearOUT();
-      return TRUE;
+      if (--retry == 0)
+      {
+        return FALSE;
+      }
+      TIM_Waitms(10);
     }
-    TIM_Waitms(10);
-  } while (--retry > 0);
+    Endpoint_Read_Stream_LE(pBuff, chunk, NULL);
+    Endpoint_ClearOUT();
+
+    pBuff += chunk;
+    size -= chunk;
+  }
 
-  return FALSE;
+  return TRUE;
 }
 
 /**************************************************************************//**
@@ -458,6 +480,8 @@ static void LabTool_ProcessCommand(void)
  * @brief  Sends a chunk of data
  *
  * The function blocks until either all data is sent or an error occurs.
+ * The number of sent bytes, retries and failures are counted in the
+ * \ref telemetry counters.
  *
  * @param [in] pData  The data to send
  * @param [in] off    The offset from \a pData to start sending from
@@ -483,6 +507,7 @@ static Bool LabTool_SendData(const uint8_t* const pData, uint32_t off, uint32_t
     res = Endpoint_Write_Stream_LE(pData+pos, chunk, &sent);
     if (res == ENDPOINT_RWSTREAM_NoError)
     {
+      telemetry.usbBytesSent += sent;
       if (left == chunk)
       {
         // done
@@ -500,6 +525,8 @@ static Bool LabTool_SendData(const uint8_t* const pData, uint32_t off, uint32_t
     else if (res == ENDPOINT_RWSTREAM_IncompleteTransfer)
     {
       // sent some more data, but the buffer got filled before all could be sent
+      telemetry.usbBytesSent += sent;
+      telemetry.usbRetries++;
       Endpoint_ClearIN();
       left -= sent;
       pos += sent;
@@ -507,6 +534,7 @@ static Bool LabTool_SendData(const uint8_t* const pData, uint32_t off, uint32_t
     else
     {
       log_i("Failed to send samples\r\n");
+      telemetry.usbFailures++;
 
 //       // If the failure is because the line went down then clearing IN will
 //       // cause all to hang as the EP is "primed"
@@ -532,7 +560,8 @@ static Bool LabTool_SendData(const uint8_t* const pData, uint32_t off, uint32_t
  * @brief  Sends the content of the circular buffer over USB
  *
  * The circular buffer is first straightened out to make it appear as one
- * continuous set of samples.
+ * continuous set of samples. Each part of the buffer that is stored after
+ * each other in memory is sent in one go.
  *
  * @param [in] buff  The data to send
  *
@@ -542,40 +571,132 @@ static Bool LabTool_SendData(const uint8_t* const pData, uint32_t off, uint32_t
  *****************************************************************************/
 static Bool LabTool_SendBuffer(const circbuff_t * const buff)
 {
-  Bool success = FALSE;
+  uint32_t pos = 0;
+  uint32_t addr;
+  uint32_t len;
+
   if (buff == NULL)
   {
-    success = TRUE;
+    return TRUE;
   }
-  else
+
+  while ((len = circbuff_GetContiguous(buff, pos, &addr)) > 0)
   {
-    if (buff->empty)
+    if (!LabTool_SendData((uint8_t*)addr, 0, len))
     {
-      if (LabTool_SendData(buff->data, 0, buff->last))
-      {
-        success = TRUE;
-      }
+      return FALSE;
     }
-    else
+    log_i("Sent %d (0x%x) bytes from 0x%08x\r\n", len, len, addr);
+    pos += len;
+  }
+  log_i("Circbuff {data 0x%08x, size %d (0x%x), last %d (0x%x), segments %d}\r\n", (uint32_t)buff->data, buff->size, buff->size, buff->last, buff->last, buff->numSegments);
+  return TRUE;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Calculates the size of the analog samples after packing
+ *
+ * The samples are packed as described in capture_vadc_pack.h, but nothing is
+ * written. The size is needed in the header which is sent before the samples.
+ *
+ * @param [in] buff  The analog samples or NULL
+ *
+ * @return The size of the packed samples in bytes
+ *
+ *****************************************************************************/
+static uint32_t LabTool_PackedAnalogSize(const circbuff_t * const buff)
+{
+  uint32_t numChannels = (samples.cap.vadcActiveChannels >> 16);
+  uint32_t size = 0;
+  uint32_t pos = 0;
+  uint32_t addr;
+  uint32_t len;
+  uint32_t consumed;
+  int32_t  lastChannel = -1;
+
+  if (buff == NULL)
+  {
+    return 0;
+  }
+
+  while ((len = circbuff_GetContiguous(buff, pos, &addr)) > 0)
+  {
+    const uint16_t* pSamples = (const uint16_t*)addr;
+    uint32_t numSamples = len/2; //len is in bytes
+    while (numSamples > 0)
     {
-      if (LabTool_SendData((uint8_t*)circbuff_GetFirstAddr(buff), 0, buff->size - buff->last))
+      size += cap_vadc_pack_Block(pSamples, numSamples, numChannels, &lastChannel, NULL, &consumed);
+      pSamples += consumed;
+      numSamples -= consumed;
+    }
+    pos += len;
+  }
+  return size;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Packs and sends the analog samples over USB
+ *
+ * The samples are packed one block at a time into a small buffer which is
+ * then sent. This reduces the amount of data to send by 25% compared to
+ * sending the 16-bit samples as they are stored by the VADC.
+ *
+ * The skipped samples and empty FIFO entries found while packing are
+ * counted in the \ref telemetry counters.
+ *
+ * @param [in] buff  The analog samples or NULL
+ *
+ * @retval TRUE  If the data was successfully sent
+ * @retval FALSE If the data was not sent
+ *
+ *****************************************************************************/
+static Bool LabTool_SendPackedAnalog(const circbuff_t * const buff)
+{
+  uint32_t numChannels = (samples.cap.vadcActiveChannels >> 16);
+  uint32_t pos = 0;
+  uint32_t addr;
+  uint32_t len;
+  uint32_t size;
+  uint32_t consumed;
+  int32_t  lastChannel = -1;
+
+  if (buff == NULL)
+  {
+    return TRUE;
+  }
+
+  while ((len = circbuff_GetContiguous(buff, pos, &addr)) > 0)
+  {
+    const uint16_t* pSamples = (const uint16_t*)addr;
+    uint32_t numSamples = len/2; //len is in bytes
+    while (numSamples > 0)
+    {
+      size = cap_vadc_pack_Block(pSamples, numSamples, numChannels, &lastChannel, analogPackBuff, &consumed);
+      if (size == 0)
       {
-        if (LabTool_SendData(buff->data, 0, buff->last))
+        telemetry.vadcEmptyMarkers += consumed;
+      }
+      else
+      {
+        // The block header has the number of values and the flags
+        telemetry.vadcEmptyMarkers += consumed - (analogPackBuff[0] | (analogPackBuff[1] << 8));
+        if (analogPackBuff[3] & VADC_PACK_FLAG_SKIP)
+        {
+          telemetry.vadcSkippedSamples++;
+        }
+        if (!LabTool_SendData(analogPackBuff, 0, size))
         {
-          success = TRUE;
-          log_i("Sent %d (0x%x) bytes from 0x%08x followed by %d (0x%x) bytes from 0x%08x\r\n",
-                buff->size - buff->last,
-                buff->size - buff->last,
-                circbuff_GetFirstAddr(buff),
-                buff->last,
-                buff->last,
-                buff->data);
-          log_i("Circbuff {data 0x%08x, size %d (0x%x), last %d (0x%x)}\r\n", (uint32_t)buff->data, buff->size, buff->size, buff->last, buff->last);
+          return FALSE;
         }
       }
+      pSamples += consumed;
+      numSamples -= consumed;
     }
+    pos += len;
   }
-  return success;
+  return TRUE;
 }
 
 /**************************************************************************//**
@@ -592,7 +713,7 @@ static Bool LabTool_SendBuffer(const circbuff_t * const buff)
  *      message [label="START | Digital Size | Analog Size | Trigger | Digital Trig Sample | Analog Trig Sample | Active Digital Channels | Active Analog Channels | Digital Data | Analog Data"];
  *  }
  *  \enddot
- * Where each part is 32 bits and \a START is divided into four bytes like this:
+ * Where each part is 32 bits (except for the data) and \a START is divided into four bytes like this:
  * \dot
  *  digraph structs {
  *      node [shape=record];
@@ -619,17 +740,20 @@ static Bool LabTool_SendBuffer(const circbuff_t * const buff)
  * \dot
  *  digraph structs {
  *      node [shape=record];
- *      message [label="{START|0xEA050000} | {Digital Size|0x00000000} | {Analog Size|0x00010000} | {Trigger|0x00000000} | {Digital Trig Sample|0x00000000} | {Analog Trig Sample|0x00001034} | {Active Digital Channels|0x00000000} | {Active Analog Channels|0x00000003} | {Analog Data|0x10000 bytes of samples}"];
+ *      message [label="{START|0xEA050000} | {Digital Size|0x00000000} | {Analog Size|0x0000C080} | {Trigger|0x00000000} | {Digital Trig Sample|0x00000000} | {Analog Trig Sample|0x00001034} | {Active Digital Channels|0x00000000} | {Active Analog Channels|0x00000003} | {Analog Data|0xC080 bytes of packed samples}"];
  *  }
  *  \enddot
  * Example 4: Successful sampling of \a DIO_0 .. \a DIO_7 and both analog channels:
  * \dot
  *  digraph structs {
  *      node [shape=record];
- *      message [label="{START|0xEA050000} | {Digital Size|0x00003200} | {Analog Size|0x0000C800} | {Trigger|0x00000000} | {Digital Trig Sample|0x000000e4} | {Analog Trig Sample|0x00000102} | {Active Digital Channels|0x000000ff} | {Active Analog Channels|0x00000003} | {Digital Data|0x3200 bytes of samples} | {Analog Data|0xC800 bytes of samples}"];
+ *      message [label="{START|0xEA050000} | {Digital Size|0x00003200} | {Analog Size|0x00009664} | {Trigger|0x00000000} | {Digital Trig Sample|0x000000e4} | {Analog Trig Sample|0x00000102} | {Active Digital Channels|0x000000ff} | {Active Analog Channels|0x00000003} | {Digital Data|0x3200 bytes of samples} | {Analog Data|0x9664 bytes of packed samples}"];
  *  }
  *  \enddot
  *
+ * The digital data is sent as it is stored by the SGPIO and the analog
+ * data is packed as described in capture_vadc_pack.h.
+ *
  *****************************************************************************/
 static void LabTool_SendSamples(void)
 {
@@ -655,7 +779,7 @@ static void LabTool_SendSamples(void)
     return;
   }
   Endpoint_Write_32_LE(circbuff_GetUsedSize(samples.cap.sgpio_samples));
-  Endpoint_Write_32_LE(circbuff_GetUsedSize(samples.cap.vadc_samples));
+  Endpoint_Write_32_LE(LabTool_PackedAnalogSize(samples.cap.vadc_samples));
   Endpoint_Write_32_LE(samples.cap.trigpoint);
   Endpoint_Write_32_LE(samples.cap.sgpioTrigSample);
   Endpoint_Write_32_LE(samples.cap.vadcTrigSample);
@@ -667,7 +791,7 @@ static void LabTool_SendSamples(void)
   success = LabTool_SendBuffer(samples.cap.sgpio_samples);
   if (success)
   {
-    success = LabTool_SendBuffer(samples.cap.vadc_samples);
+    success = LabTool_SendPackedAnalog(samples.cap.vadc_samples);
   }
 
   if (success)
@@ -698,7 +822,7 @@ static void LabTool_SendSamples(void)
  *      message [label="START | Calibration data (\ref calib_result_t)"];
  *  }
  *  \enddot
- * Where each part is 32 bits and \a START is divided into four bytes like this:
+ * Where each part is 32 bits (except for the data) and \a START is divided into four bytes like this:
  * \dot
  *  digraph structs {
  *      node [shape=record];
@@ -758,6 +882,9 @@ static void LabTool_CreateHistogram(void)
   int numSamples;
   uint16_t* data;
   uint16_t val;
+  uint32_t pos = 0;
+  uint32_t addr;
+  uint32_t len;
 #define HIST_ACCED
 #ifdef HIST_ACCED
   static int lastNumChannels = -1;
@@ -792,27 +919,32 @@ static void LabTool_CreateHistogram(void)
 
   if (samples.cap.vadc_samples != NULL)
   {
-    data = (uint16_t*)samples.cap.vadc_samples->data;
+    // walk through the circular buffer, one contiguous part at a time
+    while ((len = circbuff_GetContiguous(samples.cap.vadc_samples, pos, &addr)) > 0)
+    {
+      data = (uint16_t*)addr;
 
-    // 2 bytes per sample
-    numSamples = circbuff_GetUsedSize(samples.cap.vadc_samples) / 2;
+      // 2 bytes per sample
+      numSamples = len / 2;
 
-    for (i = 0; i < numSamples; i++)
-    {
-      val = data[i] & 0xfff; // remove channel information
-      ch = ((data[i] >> 12) & 0x7);
-      if (val < HIST_LOW_LEVEL)
-      {
-        histBuff[ch][HIST_BELOW_IDX]++;
-      }
-      else if (val > HIST_HIGH_LEVEL)
+      for (i = 0; i < numSamples; i++)
       {
-        histBuff[ch][HIST_ABOVE_IDX]++;
-      }
-      else
-      {
-        histBuff[ch][val - HIST_LOW_LEVEL]++;
+        val = data[i] & 0xfff; // remove channel information
+        ch = ((data[i] >> 12) & 0x7);
+        if (val < HIST_LOW_LEVEL)
+        {
+          histBuff[ch][HIST_BELOW_IDX]++;
+        }
+        else if (val > HIST_HIGH_LEVEL)
+        {
+          histBuff[ch][HIST_ABOVE_IDX]++;
+        }
+        else
+        {
+          histBuff[ch][val - HIST_LOW_LEVEL]++;
+        }
       }
+      pos += len;
     }
 
     // show histogram
@@ -896,6 +1028,9 @@ static void LabTool_FindSkippedSamples(void)
   uint16_t  tmp;
   int       numSkipped = 0;
   int       numSamples;
+  uint32_t  pos = 0;
+  uint32_t  addr;
+  uint32_t  len;
   circbuff_t* buff = samples.cap.vadc_samples;
 
   if ((samples.status != CMD_STATUS_OK) || (samples.cap.vadc_samples == NULL))
@@ -909,15 +1044,14 @@ static void LabTool_FindSkippedSamples(void)
     return;
   }
 
-  // case where the circular buffer hasn't wrapped yet
-  if (buff->empty)
+  // walk through the straightened out circular buffer, one contiguous part at a time
+  lastChannel = 0xffff;
+  while ((len = circbuff_GetContiguous(buff, pos, &addr)) > 0)
   {
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    lastChannel = *pSamples & 0x7000;
-    while (--numSamples > 0)
+    numSamples = len/2; //len is in bytes
+    pSamples = (uint16_t*)addr;
+    while (numSamples-- > 0)
     {
-      pSamples++;
       tmp = *pSamples & 0x7000;
       if (tmp == lastChannel)
       {
@@ -925,38 +1059,9 @@ static void LabTool_FindSkippedSamples(void)
         numSkipped++;
       }
       lastChannel = tmp;
-    }
-  }
-  else
-  {
-    numSamples = (buff->size - buff->last)/2; //size is in bytes
-    pSamples = (uint16_t*)circbuff_GetFirstAddr(buff);
-    lastChannel = *pSamples & 0x7000;
-    while (--numSamples > 0)
-    {
       pSamples++;
-      tmp = *pSamples & 0x7000;
-      if (tmp == lastChannel)
-      {
-        log_i("Skipped one or more samples at addr %#x, found 2 for channel %d in a row\r\n", (uint32_t)pSamples, tmp>>12);
-        numSkipped++;
-      }
-      lastChannel = tmp;
-    }
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    lastChannel = *pSamples & 0x7000;
-    while (--numSamples > 0)
-    {
-      pSamples++;
-      tmp = *pSamples & 0x7000;
-      if (tmp == lastChannel)
-      {
-        log_i("Skipped one or more samples at addr %#x, found 2 for channel %d in a row\r\n", (uint32_t)pSamples, tmp>>12);
-        numSkipped++;
-      }
-      lastChannel = tmp;
     }
+    pos += len;
   }
 
   log_i("Found a total of %d skipped samples\r\n", numSkipped);
@@ -980,6 +1085,9 @@ static void LabTool_Stats(void)
   uint16_t  ch;
   uint16_t  tmp;
   int       numSamples;
+  uint32_t  pos = 0;
+  uint32_t  addr;
+  uint32_t  len;
   circbuff_t* buff = samples.cap.vadc_samples;
 
   if ((samples.status != CMD_STATUS_OK) || (samples.cap.vadc_samples == NULL))
@@ -996,55 +1104,12 @@ static void LabTool_Stats(void)
   memset(stats, 0, sizeof(uint32_t)*2*NUMBER_OF_STATS);
   stats[0][STATS_MIN] = stats[1][STATS_MIN] = 0xffffff; // way above any valid value
 
-  // case where the circular buffer hasn't wrapped yet
-  if (buff->empty)
+  // walk through the straightened out circular buffer, one contiguous part at a time
+  while ((len = circbuff_GetContiguous(buff, pos, &addr)) > 0)
   {
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    while (--numSamples > 0)
-    {
-      ch = (*pSamples & 0x7000)>>12;
-      tmp = *pSamples & 0x0fff;
-
-      stats[ch][STATS_NUM]++;
-      stats[ch][STATS_SUM] += tmp;
-      if (tmp < stats[ch][STATS_MIN])
-      {
-        stats[ch][STATS_MIN] = tmp;
-      }
-      if (tmp > stats[ch][STATS_MAX])
-      {
-        stats[ch][STATS_MAX] = tmp;
-      }
-
-      pSamples++;
-    }
-  }
-  else
-  {
-    numSamples = (buff->size - buff->last)/2; //size is in bytes
-    pSamples = (uint16_t*)circbuff_GetFirstAddr(buff);
-    while (--numSamples > 0)
-    {
-      ch = (*pSamples & 0x7000)>>12;
-      tmp = *pSamples & 0x0fff;
-
-      stats[ch][STATS_NUM]++;
-      stats[ch][STATS_SUM] += tmp;
-      if (tmp < stats[ch][STATS_MIN])
-      {
-        stats[ch][STATS_MIN] = tmp;
-      }
-      if (tmp > stats[ch][STATS_MAX])
-      {
-        stats[ch][STATS_MAX] = tmp;
-      }
-
-      pSamples++;
-    }
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    while (--numSamples > 0)
+    numSamples = len/2; //len is in bytes
+    pSamples = (uint16_t*)addr;
+    while (numSamples-- > 0)
     {
       ch = (*pSamples & 0x7000)>>12;
       tmp = *pSamples & 0x0fff;
@@ -1062,6 +1127,7 @@ static void LabTool_Stats(void)
 
       pSamples++;
     }
+    pos += len;
   }
 
   for (ch = 0; ch < 2; ch++)
@@ -1191,6 +1257,16 @@ void EVENT_USB_Device_ControlRequest(void)
           Endpoint_ClearIN();
           Endpoint_ClearStatusStage();
           break;
+
+        case REQ_GetTelemetry:
+          Endpoint_ClearSETUP();
+          for (i = 0; i < TELEMETRY_NUM_WORDS; i++)
+          {
+            Endpoint_Write_32_LE(((volatile uint32_t*)&telemetry)[i]);
+          }
+          Endpoint_ClearIN();
+          Endpoint_ClearStatusStage();
+          break;
       }
     }
     else if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_INTERFACE))
@@ -0,0 +1,283 @@
+/*!
+ * @file
+ * @brief   Unit tests for the analog sample packing in capture_vadc_pack.c
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_vadc_pack.h"
+#include "unit_test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+#define MAX_SAMPLES  (2 * 4096 + 64)
+#define MAX_PACKED   ((MAX_SAMPLES / VADC_PACK_MAX_VALUES + 2) * VADC_PACK_MAX_BLOCK_SIZE)
+
+/*! A VADC sample with value \a __v for channel \a __ch */
+#define SAMPLE(__ch, __v)  ((uint16_t)(((__ch) << 12) | ((__v) & 0x0fff)))
+
+/*! A VADC "empty" marker */
+#define EMPTY              ((uint16_t)0x8000)
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+UNIT_TEST_DEFINE;
+
+static uint16_t samples[MAX_SAMPLES];
+static uint8_t  packed[MAX_PACKED];
+static uint16_t values0[MAX_SAMPLES];
+static uint16_t values1[MAX_SAMPLES];
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/*
+ * Packs the first numSamples entries in samples into packed, one block at
+ * a time like usb_handler.c does, and checks that the size-only pass gives
+ * the same size. Returns the size of the packed data.
+ */
+static uint32_t packAll(uint32_t numSamples, uint32_t numChannels)
+{
+  int32_t lastChannel = -1;
+  uint32_t pos = 0;
+  uint32_t size = 0;
+  uint32_t consumed;
+
+  while (pos < numSamples)
+  {
+    size += cap_vadc_pack_Block(samples + pos, numSamples - pos, numChannels,
+                                &lastChannel, packed + size, &consumed);
+    CHECK(consumed > 0);
+    if (consumed == 0)
+    {
+      break;
+    }
+    pos += consumed;
+  }
+
+  // the size-only pass must agree, it is sent before the data
+  {
+    uint32_t sizeOnly = 0;
+
+    lastChannel = -1;
+    pos = 0;
+    while (pos < numSamples)
+    {
+      sizeOnly += cap_vadc_pack_Block(samples + pos, numSamples - pos, numChannels,
+                                      &lastChannel, NULL, &consumed);
+      if (consumed == 0)
+      {
+        break;
+      }
+      pos += consumed;
+    }
+    CHECK_EQUAL(size, sizeOnly);
+  }
+
+  return size;
+}
+
+/*
+ * Unpacks size bytes of packed into values0/values1. Returns the result
+ * of cap_vadc_pack_Unpack.
+ */
+static int32_t unpackAll(uint32_t size, uint32_t numChannels, uint32_t numValues[2],
+                         uint32_t maxValues, uint32_t* pNumSkips)
+{
+  uint16_t* pValues[2] = { values0, values1 };
+
+  numValues[0] = 0;
+  numValues[1] = 0;
+  return cap_vadc_pack_Unpack(packed, size, numChannels, pValues, numValues,
+                              maxValues, pNumSkips);
+}
+
+static void test_OneChannelAllValues(void)
+{
+  static const uint32_t lengths[] = { 1, 2, 3, 1023, 1024, 1025, 2047, 4095, 4096 };
+  uint32_t l;
+
+  for (l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+  {
+    uint32_t num = lengths[l];
+    uint32_t numValues[2];
+    uint32_t skips = 1;
+    uint32_t i;
+    int same = 1;
+
+    // all 12-bit values (in a scrambled order) when the length allows it
+    for (i = 0; i < num; i++)
+    {
+      samples[i] = SAMPLE(0, (i * 2741) & 0x0fff);
+    }
+
+    CHECK_EQUAL(0, unpackAll(packAll(num, 1), 1, numValues, MAX_SAMPLES, &skips));
+    CHECK_EQUAL(num, numValues[0]);
+    CHECK_EQUAL(0, numValues[1]);
+    CHECK_EQUAL(0, skips);
+
+    for (i = 0; i < num && i < numValues[0]; i++)
+    {
+      same &= (values0[i] == ((i * 2741) & 0x0fff));
+    }
+    CHECK(same);
+  }
+}
+
+static void test_TwoChannelsAllValues(void)
+{
+  static const uint32_t lengths[] = { 1, 3, 2047, 2049, 8191, 8192 };
+  uint32_t l;
+
+  for (l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+  {
+    uint32_t num = lengths[l];
+    uint32_t numValues[2];
+    uint32_t skips = 1;
+    uint32_t i;
+    int same = 1;
+
+    // channel 0 counts up and channel 1 down through all 12-bit values
+    for (i = 0; i < num; i++)
+    {
+      samples[i] = (i & 1) ? SAMPLE(1, 4095 - i / 2) : SAMPLE(0, i / 2);
+    }
+
+    CHECK_EQUAL(0, unpackAll(packAll(num, 2), 2, numValues, MAX_SAMPLES, &skips));
+    CHECK_EQUAL((num + 1) / 2, numValues[0]);
+    CHECK_EQUAL(num / 2, numValues[1]);
+    CHECK_EQUAL(0, skips);
+
+    for (i = 0; i < numValues[0]; i++)
+    {
+      same &= (values0[i] == (i & 0x0fff));
+    }
+    for (i = 0; i < numValues[1]; i++)
+    {
+      same &= (values1[i] == ((4095 - i) & 0x0fff));
+    }
+    CHECK(same);
+  }
+}
+
+static void test_EmptyMarkersDropped(void)
+{
+  uint32_t numValues[2];
+  uint32_t num = 0;
+  uint32_t i;
+  int same = 1;
+
+  for (i = 0; i < 1501; i++)
+  {
+    if ((i % 7) == 3)
+    {
+      samples[num++] = EMPTY | (uint16_t)i;
+    }
+    samples[num++] = SAMPLE(0, i);
+  }
+  samples[num++] = EMPTY;
+
+  CHECK_EQUAL(0, unpackAll(packAll(num, 1), 1, numValues, MAX_SAMPLES, NULL));
+  CHECK_EQUAL(1501, numValues[0]);
+  for (i = 0; i < numValues[0]; i++)
+  {
+    same &= (values0[i] == i);
+  }
+  CHECK(same);
+
+  // only empty markers give no data at all
+  samples[0] = EMPTY;
+  samples[1] = EMPTY;
+  CHECK_EQUAL(0, packAll(2, 1));
+}
+
+static void test_SkippedSample(void)
+{
+  uint32_t numValues[2];
+  uint32_t skips = 0;
+
+  // channel 1 misses a sample between 0x102 and 0x103
+  samples[0] = SAMPLE(0, 0x101);
+  samples[1] = SAMPLE(1, 0x201);
+  samples[2] = SAMPLE(0, 0x102);
+  samples[3] = SAMPLE(0, 0x103);
+  samples[4] = SAMPLE(1, 0x203);
+  samples[5] = SAMPLE(0, 0x104);
+
+  CHECK_EQUAL(0, unpackAll(packAll(6, 2), 2, numValues, MAX_SAMPLES, &skips));
+  CHECK_EQUAL(1, skips);
+  CHECK_EQUAL(4, numValues[0]);
+  CHECK_EQUAL(3, numValues[1]);
+  CHECK_EQUAL(0x101, values0[0]);
+  CHECK_EQUAL(0x104, values0[3]);
+  CHECK_EQUAL(0x201, values1[0]);
+  CHECK_EQUAL(0x201, values1[1]); // repeated to keep the channels aligned
+  CHECK_EQUAL(0x203, values1[2]);
+}
+
+static void test_Malformed(void)
+{
+  uint32_t numValues[2];
+  uint32_t size;
+  uint32_t i;
+
+  for (i = 0; i < 101; i++)
+  {
+    samples[i] = SAMPLE(0, i);
+  }
+  size = packAll(101, 1);
+
+  // truncated data
+  CHECK(unpackAll(size - 1, 1, numValues, MAX_SAMPLES, NULL) < 0);
+  CHECK(unpackAll(2, 1, numValues, MAX_SAMPLES, NULL) < 0);
+
+  // too small destination
+  CHECK(unpackAll(size, 1, numValues, 100, NULL) < 0);
+  CHECK_EQUAL(0, unpackAll(size, 1, numValues, 101, NULL));
+
+  // invalid channel in the header
+  packed[2] = 2;
+  CHECK(unpackAll(size, 1, numValues, MAX_SAMPLES, NULL) < 0);
+}
+
+/******************************************************************************
+ * Main
+ *****************************************************************************/
+
+int main(void)
+{
+  UNIT_TEST_RUN(test_OneChannelAllValues);
+  UNIT_TEST_RUN(test_TwoChannelsAllValues);
+  UNIT_TEST_RUN(test_EmptyMarkersDropped);
+  UNIT_TEST_RUN(test_SkippedSample);
+  UNIT_TEST_RUN(test_Malformed);
+
+  return UNIT_TEST_RESULT();
+}
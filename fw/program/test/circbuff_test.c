@@ -0,0 +1,325 @@
+/*!
+ * @file
+ * @brief   Unit tests for the segmented circular buffer in circbuff.c
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/* for MAP_ANONYMOUS */
+#define _DEFAULT_SOURCE
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "circbuff.h"
+#include "unit_test.h"
+
+#include <string.h>
+#include <sys/mman.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/* The segments are placed in this order in memory to make sure that
+ * nothing depends on them being in increasing address order. */
+#define SEG0_OFFSET  0x3000
+#define SEG1_OFFSET  0x0000
+#define SEG2_OFFSET  0x1800
+
+#define SEG0_SIZE    1000
+#define SEG1_SIZE    604
+#define SEG2_SIZE    400
+
+/* Size of one set of samples, does not go evenly into the segments */
+#define UNIT_SIZE    12
+
+#define MEM_SIZE     0x4000
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+UNIT_TEST_DEFINE;
+
+static uint32_t mem;
+static circbuff_t buff;
+
+static const uint32_t segOffsets[] = { SEG0_OFFSET, SEG1_OFFSET, SEG2_OFFSET };
+static const uint32_t segSizes[]   = { SEG0_SIZE, SEG1_SIZE, SEG2_SIZE };
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/*
+ * The buffer stores addresses as uint32_t, just like on the LPC4370, so
+ * the memory must be below 4GB when the test runs on a 64-bit host.
+ */
+static int allocMemory(void)
+{
+  void* p = mmap((void*)0x10000000, MEM_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if ((p == MAP_FAILED) || ((uintptr_t)p > (0xffffffffu - MEM_SIZE)))
+  {
+    printf("Failed to allocate memory below 4GB\n");
+    return 0;
+  }
+  mem = (uint32_t)(uintptr_t)p;
+  return 1;
+}
+
+static void setup(void)
+{
+  uint32_t i;
+
+  circbuff_Init(&buff, mem + segOffsets[0], segSizes[0]);
+  for (i = 1; i < CIRCBUFF_MAX_SEGMENTS; i++)
+  {
+    CHECK(circbuff_AddSegment(&buff, mem + segOffsets[i], segSizes[i]));
+  }
+  circbuff_ResizeToMultipleOf(&buff, UNIT_SIZE);
+}
+
+/* Returns the segment that addr is in or -1 */
+static int segmentOf(uint32_t addr)
+{
+  int i;
+  for (i = 0; i < CIRCBUFF_MAX_SEGMENTS; i++)
+  {
+    if ((addr >= mem + segOffsets[i]) && (addr < mem + segOffsets[i] + buff.segments[i].size))
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Reserves numUnits units and writes the unit number in the first word of each */
+static void fill(uint32_t numUnits)
+{
+  uint32_t i;
+  for (i = 0; i < numUnits; i++)
+  {
+    uint32_t addr = circbuff_NextPos(&buff, UNIT_SIZE);
+    memcpy((void*)(uintptr_t)addr, &i, sizeof(i));
+  }
+}
+
+static void test_Segments(void)
+{
+  setup();
+
+  // the sizes are trimmed to whole units
+  CHECK_EQUAL(996, buff.segments[0].size);
+  CHECK_EQUAL(600, buff.segments[1].size);
+  CHECK_EQUAL(396, buff.segments[2].size);
+  CHECK_EQUAL(996 + 600 + 396, buff.size);
+  CHECK_EQUAL(SEG0_SIZE + SEG1_SIZE + SEG2_SIZE, buff.maxSize);
+
+  // no more segments fit
+  CHECK(!circbuff_AddSegment(&buff, mem, 4));
+}
+
+static void test_NextPos(void)
+{
+  uint32_t units;
+  uint32_t expected;
+  uint32_t addr;
+  uint32_t i;
+  int seg = 0;
+
+  setup();
+  units = buff.size / UNIT_SIZE;
+
+  expected = mem + segOffsets[0];
+  for (i = 0; i < units; i++)
+  {
+    addr = circbuff_NextPos(&buff, UNIT_SIZE);
+    CHECK_EQUAL(expected, addr);
+
+    // never split between segments
+    CHECK_EQUAL(segmentOf(addr), segmentOf(addr + UNIT_SIZE - 1));
+    CHECK(buff.empty);
+
+    expected = addr + UNIT_SIZE;
+    if ((expected - (mem + segOffsets[seg])) >= buff.segments[seg].size)
+    {
+      seg++;
+      expected = (seg < CIRCBUFF_MAX_SEGMENTS) ? (mem + segOffsets[seg]) : 0;
+    }
+  }
+  CHECK_EQUAL(CIRCBUFF_MAX_SEGMENTS, seg);
+  CHECK_EQUAL(buff.size, circbuff_GetUsedSize(&buff));
+
+  // wraps to the first segment
+  addr = circbuff_NextPos(&buff, UNIT_SIZE);
+  CHECK_EQUAL(mem + segOffsets[0], addr);
+  CHECK(!buff.empty);
+  CHECK_EQUAL(UNIT_SIZE, buff.last);
+  CHECK_EQUAL(buff.size, circbuff_GetUsedSize(&buff));
+}
+
+static void test_NextPosSkipsSegmentEnd(void)
+{
+  uint32_t addr;
+  uint32_t i;
+
+  setup();
+
+  // 996 bytes in the first segment, 20 byte units leave 16 unused bytes
+  for (i = 0; i < 49; i++)
+  {
+    circbuff_NextPos(&buff, 20);
+  }
+  addr = circbuff_NextPos(&buff, 20);
+  CHECK_EQUAL(mem + segOffsets[1], addr);
+  CHECK_EQUAL(996 + 20, buff.last);
+}
+
+/*
+ * Walks the straightened out buffer with circbuff_GetContiguous and checks
+ * that the units come oldest first. Returns the number of units found.
+ */
+static uint32_t walk(uint32_t firstUnit)
+{
+  uint32_t pos = 0;
+  uint32_t addr;
+  uint32_t len;
+  uint32_t unit = firstUnit;
+  uint32_t parts = 0;
+
+  while ((len = circbuff_GetContiguous(&buff, pos, &addr)) > 0)
+  {
+    uint32_t i;
+    int seg = segmentOf(addr);
+
+    CHECK(seg >= 0);
+    CHECK_EQUAL(seg, segmentOf(addr + len - 1));
+    CHECK_EQUAL(0, len % UNIT_SIZE);
+
+    for (i = 0; i < len; i += UNIT_SIZE)
+    {
+      uint32_t val;
+      memcpy(&val, (void*)(uintptr_t)(addr + i), sizeof(val));
+      CHECK_EQUAL(unit, val);
+      unit++;
+    }
+    pos += len;
+    parts++;
+    CHECK(parts <= CIRCBUFF_MAX_SEGMENTS + 1);
+    if (parts > CIRCBUFF_MAX_SEGMENTS + 1)
+    {
+      break;
+    }
+  }
+  CHECK_EQUAL(circbuff_GetUsedSize(&buff), pos);
+  return unit - firstUnit;
+}
+
+static void test_GetContiguous(void)
+{
+  uint32_t units;
+  uint32_t addr;
+  uint32_t n;
+
+  setup();
+  units = buff.size / UNIT_SIZE;
+
+  // empty
+  CHECK_EQUAL(0, circbuff_GetContiguous(&buff, 0, &addr));
+
+  // not wrapped, ends in the second segment
+  fill(100);
+  CHECK_EQUAL(100, walk(0));
+  CHECK_EQUAL(996, circbuff_GetContiguous(&buff, 0, &addr));
+  CHECK_EQUAL(mem + segOffsets[0], addr);
+  CHECK_EQUAL(100*UNIT_SIZE - 996, circbuff_GetContiguous(&buff, 996, &addr));
+  CHECK_EQUAL(mem + segOffsets[1], addr);
+  CHECK_EQUAL(0, circbuff_GetContiguous(&buff, 100*UNIT_SIZE, &addr));
+
+  // wrapped with the oldest unit in each of the segments and just at the
+  // start of each segment
+  for (n = units + 1; n < 3*units; n += 7)
+  {
+    setup();
+    fill(n);
+    CHECK(!buff.empty);
+    CHECK_EQUAL(units, walk(n - units));
+  }
+}
+
+static void test_ConvertAddress(void)
+{
+  uint32_t units;
+  uint32_t n;
+  int seg;
+
+  setup();
+  units = buff.size / UNIT_SIZE;
+
+  // not wrapped, the offset is the position
+  fill(10);
+  CHECK_EQUAL(5*UNIT_SIZE, circbuff_ConvertAddress(&buff, mem + segOffsets[0] + 5*UNIT_SIZE));
+
+  // a trigger point in each segment, for a write position in each segment
+  for (n = units + 3; n < 2*units; n += 31)
+  {
+    setup();
+    fill(n);
+
+    for (seg = 0; seg < CIRCBUFF_MAX_SEGMENTS; seg++)
+    {
+      uint32_t trigger = mem + segOffsets[seg] + 5*UNIT_SIZE + 3;
+      uint32_t pos = circbuff_ConvertAddress(&buff, trigger);
+      uint32_t addr;
+
+      // the straightened out position must map back to the same address
+      CHECK(circbuff_GetContiguous(&buff, pos, &addr) > 0);
+      CHECK_EQUAL(trigger, addr);
+      CHECK(pos < buff.size);
+    }
+
+    // the address just after a segment is the start of the next one
+    CHECK_EQUAL(circbuff_ConvertAddress(&buff, mem + segOffsets[1]),
+                circbuff_ConvertAddress(&buff, mem + segOffsets[0] + buff.segments[0].size));
+  }
+
+  // addresses outside of the buffer are treated as offset 0
+  CHECK_EQUAL(circbuff_ConvertOffset(&buff, 0), circbuff_ConvertAddress(&buff, mem + 0x2f00));
+}
+
+/******************************************************************************
+ * Main
+ *****************************************************************************/
+
+int main(void)
+{
+  if (!allocMemory())
+  {
+    return 1;
+  }
+
+  UNIT_TEST_RUN(test_Segments);
+  UNIT_TEST_RUN(test_NextPos);
+  UNIT_TEST_RUN(test_NextPosSkipsSegmentEnd);
+  UNIT_TEST_RUN(test_GetContiguous);
+  UNIT_TEST_RUN(test_ConvertAddress);
+
+  return UNIT_TEST_RESULT();
+}
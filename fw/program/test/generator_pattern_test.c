@@ -0,0 +1,294 @@
+/*!
+ * @file
+ * @brief   Unit tests for the pattern compression in generator_pattern.c
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "generator_pattern.h"
+#include "unit_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+#define MAX_STATES  (619*32)  /* GEN_SGPIO_MAX_STATES */
+#define MAX_WORDS   4300      /* the pattern stream part of DATA_MAX_LEN */
+
+/*! @brief Destination for the decoded states */
+typedef struct
+{
+  uint16_t states[MAX_STATES];
+  uint32_t num;
+  int overflow;
+} decoded_t;
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+UNIT_TEST_DEFINE;
+
+static uint16_t states[MAX_STATES];
+static uint16_t stream[MAX_WORDS];
+static decoded_t decoded;
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+static void sink(void* ctx, uint16_t state, uint32_t count)
+{
+  decoded_t* d = (decoded_t*)ctx;
+
+  if (count == 0 || count > (MAX_STATES - d->num))
+  {
+    d->overflow = 1;
+    return;
+  }
+  while (count-- > 0)
+  {
+    d->states[d->num++] = state;
+  }
+}
+
+/*
+ * Encodes the first numStates entries in states, decodes the result and
+ * checks that the same states come back. Returns the size of the stream.
+ */
+static int32_t roundTrip(uint32_t numStates)
+{
+  int32_t words;
+  int32_t n;
+
+  words = gen_pattern_Encode(states, numStates, stream, MAX_WORDS);
+  CHECK(words > 0);
+  if (words <= 0)
+  {
+    return words;
+  }
+
+  // validate only
+  n = gen_pattern_Decode(stream, words, MAX_STATES, NULL, NULL);
+  CHECK_EQUAL(numStates, n);
+
+  memset(&decoded, 0, sizeof(decoded));
+  n = gen_pattern_Decode(stream, words, MAX_STATES, sink, &decoded);
+  CHECK_EQUAL(numStates, n);
+  CHECK_EQUAL(numStates, decoded.num);
+  CHECK(!decoded.overflow);
+  CHECK(memcmp(states, decoded.states, numStates * sizeof(uint16_t)) == 0);
+
+  return words;
+}
+
+static void test_Literal(void)
+{
+  uint32_t i;
+
+  // no repetitions at all
+  for (i = 0; i < 300; i++)
+  {
+    states[i] = (uint16_t)(i * 7919);
+  }
+  CHECK_EQUAL(301, roundTrip(300));
+
+  CHECK_EQUAL(2, roundTrip(1));
+}
+
+static void test_Run(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < MAX_STATES; i++)
+  {
+    states[i] = 0x0412;
+  }
+  CHECK_EQUAL(2, roundTrip(1000));
+
+  // longer than the largest count in a record
+  CHECK(roundTrip(MAX_STATES) <= 6);
+
+  // a short run is not worth a record of its own
+  states[0] = 1;
+  states[1] = 2;
+  states[2] = 2;
+  states[3] = 3;
+  roundTrip(4);
+}
+
+static void test_Repeat(void)
+{
+  uint32_t i;
+
+  // a clock on DIO0
+  for (i = 0; i < MAX_STATES; i++)
+  {
+    states[i] = (uint16_t)(i & 1);
+  }
+  CHECK(roundTrip(1001) < 10);
+  CHECK(roundTrip(MAX_STATES) < 20);
+
+  // a clock with a period that is not a power of two
+  for (i = 0; i < MAX_STATES; i++)
+  {
+    states[i] = ((i % 37) < 11) ? 0x7ff : 0;
+  }
+  CHECK(roundTrip(MAX_STATES) < 40);
+
+  // UART frames, each bit 8 states long. The frames repeat every 320
+  // states, which is longer than GEN_PATTERN_MAX_BLOCK, so only the runs
+  // can be compressed.
+  for (i = 0; i < MAX_STATES; i++)
+  {
+    uint32_t bit = (i / 8) % 10;
+    uint32_t frame = (i / 80) % 4;
+    uint16_t data = (uint16_t)(0x55 + frame);
+    if (bit == 0)
+    {
+      states[i] = 0;
+    }
+    else if (bit == 9)
+    {
+      states[i] = 1;
+    }
+    else
+    {
+      states[i] = (data >> (bit - 1)) & 1;
+    }
+  }
+  CHECK(roundTrip(MAX_STATES) < (MAX_STATES / 8));
+}
+
+static void test_Random(void)
+{
+  uint32_t i;
+  uint32_t n;
+
+  srand(4711);
+  for (n = 1; n < 2000; n += 97)
+  {
+    // random runs of random states
+    for (i = 0; i < n; i++)
+    {
+      if ((i == 0) || ((rand() % 4) == 0))
+      {
+        states[i] = (uint16_t)(rand() & 0x7ff);
+      }
+      else
+      {
+        states[i] = states[i - 1];
+      }
+    }
+    roundTrip(n);
+  }
+}
+
+static void test_StreamTooSmall(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < 300; i++)
+  {
+    states[i] = (uint16_t)(i * 7919);
+  }
+  CHECK(gen_pattern_Encode(states, 300, stream, 300) < 0);
+  CHECK_EQUAL(301, gen_pattern_Encode(states, 300, stream, 301));
+}
+
+static void test_InvalidStreams(void)
+{
+  // a count of 0 is never valid
+  stream[0] = GEN_PATTERN_REC(GEN_PATTERN_REC_LITERAL, 0);
+  CHECK(gen_pattern_Decode(stream, 1, MAX_STATES, NULL, NULL) < 0);
+
+  // the literal states are missing
+  stream[0] = GEN_PATTERN_REC(GEN_PATTERN_REC_LITERAL, 3);
+  stream[1] = 1;
+  stream[2] = 2;
+  CHECK(gen_pattern_Decode(stream, 3, MAX_STATES, NULL, NULL) < 0);
+
+  // the run state is missing
+  stream[0] = GEN_PATTERN_REC(GEN_PATTERN_REC_RUN, 3);
+  CHECK(gen_pattern_Decode(stream, 1, MAX_STATES, NULL, NULL) < 0);
+
+  // unknown record type
+  stream[0] = GEN_PATTERN_REC(3, 1);
+  stream[1] = 0;
+  CHECK(gen_pattern_Decode(stream, 2, MAX_STATES, NULL, NULL) < 0);
+
+  // block longer than the stream
+  stream[0] = GEN_PATTERN_REC(GEN_PATTERN_REC_REPEAT, 2);
+  stream[1] = 3;
+  stream[2] = GEN_PATTERN_REC(GEN_PATTERN_REC_RUN, 1);
+  stream[3] = 0;
+  CHECK(gen_pattern_Decode(stream, 4, MAX_STATES, NULL, NULL) < 0);
+  stream[1] = 2;
+  CHECK_EQUAL(2, gen_pattern_Decode(stream, 4, MAX_STATES, NULL, NULL));
+
+  // more states than allowed
+  stream[0] = GEN_PATTERN_REC(GEN_PATTERN_REC_RUN, 100);
+  stream[1] = 0;
+  CHECK_EQUAL(100, gen_pattern_Decode(stream, 2, 100, NULL, NULL));
+  CHECK(gen_pattern_Decode(stream, 2, 99, NULL, NULL) < 0);
+}
+
+static void test_NestingLimit(void)
+{
+  uint32_t depth;
+  uint32_t pos = 0;
+
+  // GEN_PATTERN_MAX_DEPTH repeat records inside each other are allowed
+  for (depth = 0; depth < GEN_PATTERN_MAX_DEPTH; depth++)
+  {
+    stream[pos++] = GEN_PATTERN_REC(GEN_PATTERN_REC_REPEAT, 2);
+    stream[pos++] = (uint16_t)(2 * (GEN_PATTERN_MAX_DEPTH - depth - 1) + 2);
+  }
+  stream[pos++] = GEN_PATTERN_REC(GEN_PATTERN_REC_RUN, 1);
+  stream[pos++] = 1;
+  CHECK_EQUAL(1 << GEN_PATTERN_MAX_DEPTH, gen_pattern_Decode(stream, pos, MAX_STATES, NULL, NULL));
+
+  // but not one more
+  memmove(stream + 2, stream, pos * sizeof(uint16_t));
+  stream[0] = GEN_PATTERN_REC(GEN_PATTERN_REC_REPEAT, 2);
+  stream[1] = (uint16_t)pos;
+  CHECK(gen_pattern_Decode(stream, pos + 2, MAX_STATES, NULL, NULL) < 0);
+}
+
+/******************************************************************************
+ * Main
+ *****************************************************************************/
+
+int main(void)
+{
+  UNIT_TEST_RUN(test_Literal);
+  UNIT_TEST_RUN(test_Run);
+  UNIT_TEST_RUN(test_Repeat);
+  UNIT_TEST_RUN(test_Random);
+  UNIT_TEST_RUN(test_StreamTooSmall);
+  UNIT_TEST_RUN(test_InvalidStreams);
+  UNIT_TEST_RUN(test_NestingLimit);
+
+  return UNIT_TEST_RESULT();
+}
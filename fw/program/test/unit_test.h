@@ -0,0 +1,81 @@
+/*!
+ * @file
+ * @brief   Minimal support for the host based firmware unit tests
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __UNIT_TEST_H
+#define __UNIT_TEST_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <stdio.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*
+ * Minimal test support for the parts of the firmware that can be built on
+ * the host. Each test program defines the counters with UNIT_TEST_DEFINE,
+ * runs its test functions with UNIT_TEST_RUN and returns UNIT_TEST_RESULT
+ * from main().
+ */
+
+#define UNIT_TEST_DEFINE \
+  int unit_test_checks = 0; \
+  int unit_test_failures = 0
+
+extern int unit_test_checks;
+extern int unit_test_failures;
+
+/*! Checks that \a __cond is true, reports the failure and continues if not */
+#define CHECK(__cond) \
+  do { \
+    unit_test_checks++; \
+    if (!(__cond)) { \
+      unit_test_failures++; \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #__cond); \
+    } \
+  } while (0)
+
+/*! Checks that the two integers are equal */
+#define CHECK_EQUAL(__expected, __actual) \
+  do { \
+    long __e = (long)(__expected); \
+    long __a = (long)(__actual); \
+    unit_test_checks++; \
+    if (__e != __a) { \
+      unit_test_failures++; \
+      printf("%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #__actual, __a, __e); \
+    } \
+  } while (0)
+
+#define UNIT_TEST_RUN(__func) \
+  do { \
+    int __before = unit_test_failures; \
+    __func(); \
+    printf("%-40s %s\n", #__func, (unit_test_failures == __before) ? "ok" : "FAILED"); \
+  } while (0)
+
+#define UNIT_TEST_RESULT() \
+  (printf("%d checks, %d failures\n", unit_test_checks, unit_test_failures), \
+   (unit_test_failures == 0) ? 0 : 1)
+
+#endif /* end __UNIT_TEST_H */